@@ -78,4 +78,13 @@
 
 #define WEAVE_CONFIG_MAX_SOFTWARE_VERSION_LENGTH 128
 
+// Detect duplicates among messages reordered by up to 63 positions.
+#define WEAVE_CONFIG_MSG_COUNTER_WINDOW_SIZE 64
+
+// Coalesce pending WRMP acks into Ack List messages, so that TestWRMP exercises it.
+#define WEAVE_CONFIG_WRMP_MAX_ACK_LIST_ENTRIES 16
+
+// Run two session establishments at once, so that TestPASE exercises concurrent handshakes.
+#define WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES 2
+
 #endif /* WEAVEPROJECTCONFIG_H */
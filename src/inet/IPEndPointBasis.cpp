@@ -760,47 +760,47 @@ INET_ERROR IPEndPointBasis::BindInterface(IPAddressType aAddressType, InterfaceI
     return (lRetval);
 }
 
-INET_ERROR IPEndPointBasis::SendMsg(const IPPacketInfo *aPktInfo, Weave::System::PacketBuffer *aBuffer, uint16_t aSendFlags)
+// Fill in a sendmsg() message header for sending the contents of a packet buffer as described by
+// a packet info object.
+static INET_ERROR PrepareMsgHeader(IPAddressType aAddrType, InterfaceId aBoundIntfId, const IPPacketInfo *aPktInfo,
+                                   Weave::System::PacketBuffer *aBuffer, PeerSockAddr &aPeerSockAddr, struct iovec &aMsgIOV,
+                                   uint8_t *aControlData, size_t aControlDataSize, struct msghdr &aMsgHeader)
 {
     INET_ERROR     res = INET_NO_ERROR;
-    PeerSockAddr   peerSockAddr;
-    struct iovec   msgIOV;
-    uint8_t        controlData[256];
-    struct msghdr  msgHeader;
-    InterfaceId    intfId = aPktInfo->Interface;
+    InterfaceId    lIntfId = aPktInfo->Interface;
 
     // Ensure the destination address type is compatible with the endpoint address type.
-    VerifyOrExit(mAddrType == aPktInfo->DestAddress.Type(), res = INET_ERROR_BAD_ARGS);
+    VerifyOrExit(aAddrType == aPktInfo->DestAddress.Type(), res = INET_ERROR_BAD_ARGS);
 
     // For now the entire message must fit within a single buffer.
     VerifyOrExit(aBuffer->Next() == NULL, res = INET_ERROR_MESSAGE_TOO_LONG);
 
-    memset(&msgHeader, 0, sizeof (msgHeader));
+    memset(&aMsgHeader, 0, sizeof (aMsgHeader));
 
-    msgIOV.iov_base      = aBuffer->Start();
-    msgIOV.iov_len       = aBuffer->DataLength();
-    msgHeader.msg_iov    = &msgIOV;
-    msgHeader.msg_iovlen = 1;
+    aMsgIOV.iov_base      = aBuffer->Start();
+    aMsgIOV.iov_len       = aBuffer->DataLength();
+    aMsgHeader.msg_iov    = &aMsgIOV;
+    aMsgHeader.msg_iovlen = 1;
 
     // Construct a sockaddr_in/sockaddr_in6 structure containing the destination information.
-    memset(&peerSockAddr, 0, sizeof (peerSockAddr));
-    msgHeader.msg_name = &peerSockAddr;
-    if (mAddrType == kIPAddressType_IPv6)
+    memset(&aPeerSockAddr, 0, sizeof (aPeerSockAddr));
+    aMsgHeader.msg_name = &aPeerSockAddr;
+    if (aAddrType == kIPAddressType_IPv6)
     {
-        peerSockAddr.in6.sin6_family    = AF_INET6;
-        peerSockAddr.in6.sin6_port      = htons(aPktInfo->DestPort);
-        peerSockAddr.in6.sin6_flowinfo  = 0;
-        peerSockAddr.in6.sin6_addr      = aPktInfo->DestAddress.ToIPv6();
-        peerSockAddr.in6.sin6_scope_id  = aPktInfo->Interface;
-        msgHeader.msg_namelen           = sizeof(sockaddr_in6);
+        aPeerSockAddr.in6.sin6_family    = AF_INET6;
+        aPeerSockAddr.in6.sin6_port      = htons(aPktInfo->DestPort);
+        aPeerSockAddr.in6.sin6_flowinfo  = 0;
+        aPeerSockAddr.in6.sin6_addr      = aPktInfo->DestAddress.ToIPv6();
+        aPeerSockAddr.in6.sin6_scope_id  = aPktInfo->Interface;
+        aMsgHeader.msg_namelen           = sizeof(sockaddr_in6);
     }
 #if INET_CONFIG_ENABLE_IPV4
     else
     {
-        peerSockAddr.in.sin_family      = AF_INET;
-        peerSockAddr.in.sin_port        = htons(aPktInfo->DestPort);
-        peerSockAddr.in.sin_addr        = aPktInfo->DestAddress.ToIPv4();
-        msgHeader.msg_namelen           = sizeof(sockaddr_in);
+        aPeerSockAddr.in.sin_family      = AF_INET;
+        aPeerSockAddr.in.sin_port        = htons(aPktInfo->DestPort);
+        aPeerSockAddr.in.sin_addr        = aPktInfo->DestAddress.ToIPv4();
+        aMsgHeader.msg_namelen           = sizeof(sockaddr_in);
     }
 #endif // INET_CONFIG_ENABLE_IPV4
 
@@ -810,25 +810,25 @@ INET_ERROR IPEndPointBasis::SendMsg(const IPPacketInfo *aPktInfo, Weave::System:
     // for messages to multicast addresses, which under Linux
     // don't seem to get sent out the correct interface, despite
     // the socket being bound.
-    if (intfId == INET_NULL_INTERFACEID)
-        intfId = mBoundIntfId;
+    if (lIntfId == INET_NULL_INTERFACEID)
+        lIntfId = aBoundIntfId;
 
     // If the packet should be sent over a specific interface, or with a specific source
     // address, construct an IP_PKTINFO/IPV6_PKTINFO "control message" to that effect
     // add add it to the message header.  If the local OS doesn't support IP_PKTINFO/IPV6_PKTINFO
     // fail with an error.
-    if (intfId != INET_NULL_INTERFACEID || aPktInfo->SrcAddress.Type() != kIPAddressType_Any)
+    if (lIntfId != INET_NULL_INTERFACEID || aPktInfo->SrcAddress.Type() != kIPAddressType_Any)
     {
 #if defined(IP_PKTINFO) || defined(IPV6_PKTINFO)
-        memset(controlData, 0, sizeof(controlData));
-        msgHeader.msg_control = controlData;
-        msgHeader.msg_controllen = sizeof(controlData);
+        memset(aControlData, 0, aControlDataSize);
+        aMsgHeader.msg_control = aControlData;
+        aMsgHeader.msg_controllen = aControlDataSize;
 
-        struct cmsghdr *controlHdr = CMSG_FIRSTHDR(&msgHeader);
+        struct cmsghdr *controlHdr = CMSG_FIRSTHDR(&aMsgHeader);
 
 #if INET_CONFIG_ENABLE_IPV4
 
-        if (mAddrType == kIPAddressType_IPv4)
+        if (aAddrType == kIPAddressType_IPv4)
         {
 #if defined(IP_PKTINFO)
             controlHdr->cmsg_level = IPPROTO_IP;
@@ -836,10 +836,10 @@ INET_ERROR IPEndPointBasis::SendMsg(const IPPacketInfo *aPktInfo, Weave::System:
             controlHdr->cmsg_len   = CMSG_LEN(sizeof(in_pktinfo));
 
             struct in_pktinfo *pktInfo = (struct in_pktinfo *)CMSG_DATA(controlHdr);
-            pktInfo->ipi_ifindex = intfId;
+            pktInfo->ipi_ifindex = lIntfId;
             pktInfo->ipi_spec_dst = aPktInfo->SrcAddress.ToIPv4();
 
-            msgHeader.msg_controllen = CMSG_SPACE(sizeof(in_pktinfo));
+            aMsgHeader.msg_controllen = CMSG_SPACE(sizeof(in_pktinfo));
 #else // !defined(IP_PKTINFO)
             ExitNow(res = INET_ERROR_NOT_SUPPORTED);
 #endif // !defined(IP_PKTINFO)
@@ -847,7 +847,7 @@ INET_ERROR IPEndPointBasis::SendMsg(const IPPacketInfo *aPktInfo, Weave::System:
 
 #endif // INET_CONFIG_ENABLE_IPV4
 
-        if (mAddrType == kIPAddressType_IPv6)
+        if (aAddrType == kIPAddressType_IPv6)
         {
 #if defined(IPV6_PKTINFO)
             controlHdr->cmsg_level = IPPROTO_IPV6;
@@ -855,10 +855,10 @@ INET_ERROR IPEndPointBasis::SendMsg(const IPPacketInfo *aPktInfo, Weave::System:
             controlHdr->cmsg_len   = CMSG_LEN(sizeof(in6_pktinfo));
 
             struct in6_pktinfo *pktInfo = (struct in6_pktinfo *)CMSG_DATA(controlHdr);
-            pktInfo->ipi6_ifindex = intfId;
+            pktInfo->ipi6_ifindex = lIntfId;
             pktInfo->ipi6_addr = aPktInfo->SrcAddress.ToIPv6();
 
-            msgHeader.msg_controllen = CMSG_SPACE(sizeof(in6_pktinfo));
+            aMsgHeader.msg_controllen = CMSG_SPACE(sizeof(in6_pktinfo));
 #else // !defined(IPV6_PKTINFO)
             ExitNow(res = INET_ERROR_NOT_SUPPORTED);
 #endif // !defined(IPV6_PKTINFO)
@@ -871,6 +871,21 @@ INET_ERROR IPEndPointBasis::SendMsg(const IPPacketInfo *aPktInfo, Weave::System:
 #endif // !(defined(IP_PKTINFO) && defined(IPV6_PKTINFO))
     }
 
+exit:
+    return (res);
+}
+
+INET_ERROR IPEndPointBasis::SendMsg(const IPPacketInfo *aPktInfo, Weave::System::PacketBuffer *aBuffer, uint16_t aSendFlags)
+{
+    INET_ERROR     res = INET_NO_ERROR;
+    PeerSockAddr   peerSockAddr;
+    struct iovec   msgIOV;
+    uint8_t        controlData[256];
+    struct msghdr  msgHeader;
+
+    res = PrepareMsgHeader(mAddrType, mBoundIntfId, aPktInfo, aBuffer, peerSockAddr, msgIOV, controlData, sizeof(controlData), msgHeader);
+    SuccessOrExit(res);
+
     // Send IP packet.
     {
         const ssize_t lenSent = sendmsg(mSocket, &msgHeader, 0);
@@ -884,6 +899,104 @@ exit:
     return (res);
 }
 
+/**
+ *  Send a number of IP packets, each to its own destination.
+ *
+ *  Where the operating system provides sendmmsg(), up to #INET_CONFIG_UDP_SEND_BATCH_SIZE
+ *  packets are handed over per system call.  Otherwise the packets are sent one at a time.
+ *
+ *  @param[in]  aPktInfos   The destination of each packet.
+ *  @param[in]  aBuffers    The packets to send.  Each must be contained in a single buffer.
+ *  @param[in]  aCount      The number of packets.
+ *  @param[out] aResults    If not NULL, receives the outcome of sending each packet.
+ *
+ *  @return The first error encountered, or INET_NO_ERROR if all packets were sent.
+ */
+INET_ERROR IPEndPointBasis::SendMsgBatch(const IPPacketInfo *aPktInfos, Weave::System::PacketBuffer * const *aBuffers,
+                                         uint16_t aCount, INET_ERROR *aResults)
+{
+    INET_ERROR res = INET_NO_ERROR;
+
+#if HAVE_SENDMMSG
+    PeerSockAddr   peerSockAddrs[INET_CONFIG_UDP_SEND_BATCH_SIZE];
+    struct iovec   msgIOVs[INET_CONFIG_UDP_SEND_BATCH_SIZE];
+    uint8_t        controlData[INET_CONFIG_UDP_SEND_BATCH_SIZE][64];
+    struct mmsghdr msgHeaders[INET_CONFIG_UDP_SEND_BATCH_SIZE];
+    uint16_t       msgIndexes[INET_CONFIG_UDP_SEND_BATCH_SIZE];
+    uint16_t       next = 0;
+
+    while (next < aCount)
+    {
+        uint16_t batchCount = 0;
+        int sentCount;
+
+        // Prepare the message headers of the next batch.  Packets that cannot be described
+        // fail individually.
+        for (; next < aCount && batchCount < INET_CONFIG_UDP_SEND_BATCH_SIZE; next++)
+        {
+            INET_ERROR err = PrepareMsgHeader(mAddrType, mBoundIntfId, &aPktInfos[next], aBuffers[next], peerSockAddrs[batchCount],
+                                              msgIOVs[batchCount], controlData[batchCount], sizeof(controlData[batchCount]),
+                                              msgHeaders[batchCount].msg_hdr);
+            if (aResults != NULL)
+                aResults[next] = err;
+            if (err != INET_NO_ERROR)
+            {
+                if (res == INET_NO_ERROR)
+                    res = err;
+                continue;
+            }
+            msgIndexes[batchCount++] = next;
+        }
+
+        // Send the batch.  On a partial send, sendmmsg() returns the number of packets sent; the
+        // packet that failed is retried alone so that its error is reported.
+        for (uint16_t i = 0; i < batchCount; i += static_cast<uint16_t>(sentCount))
+        {
+            sentCount = sendmmsg(mSocket, &msgHeaders[i], batchCount - i, 0);
+
+            for (int j = 0; j < sentCount; j++)
+            {
+                const uint16_t index = msgIndexes[i + j];
+
+                if (msgHeaders[i + j].msg_len != aBuffers[index]->DataLength())
+                {
+                    if (aResults != NULL)
+                        aResults[index] = INET_ERROR_OUTBOUND_MESSAGE_TRUNCATED;
+                    if (res == INET_NO_ERROR)
+                        res = INET_ERROR_OUTBOUND_MESSAGE_TRUNCATED;
+                }
+            }
+
+            if (sentCount <= 0)
+            {
+                const INET_ERROR err = (sentCount == -1) ? Weave::System::MapErrorPOSIX(errno) : INET_ERROR_OUTBOUND_MESSAGE_TRUNCATED;
+
+                if (aResults != NULL)
+                    aResults[msgIndexes[i]] = err;
+                if (res == INET_NO_ERROR)
+                    res = err;
+                sentCount = 1;
+            }
+        }
+    }
+
+#else // !HAVE_SENDMMSG
+
+    for (uint16_t i = 0; i < aCount; i++)
+    {
+        INET_ERROR err = SendMsg(&aPktInfos[i], aBuffers[i], 0);
+
+        if (aResults != NULL)
+            aResults[i] = err;
+        if (res == INET_NO_ERROR)
+            res = err;
+    }
+
+#endif // !HAVE_SENDMMSG
+
+    return (res);
+}
+
 INET_ERROR IPEndPointBasis::GetSocket(IPAddressType aAddressType, int aType, int aProtocol)
 {
     INET_ERROR res = INET_NO_ERROR;
@@ -273,6 +273,21 @@
 #define INET_CONFIG_NUM_UDP_ENDPOINTS                       64
 #endif // INET_CONFIG_NUM_UDP_ENDPOINTS
 
+/**
+ *  @def INET_CONFIG_UDP_SEND_BATCH_SIZE
+ *
+ *  @brief
+ *    The maximum number of UDP messages handed to the operating system
+ *    in a single system call by UDPEndPoint::SendMsgBatch().
+ *
+ *    The value bounds the per-call stack usage of the batch send.  It
+ *    only has effect on sockets-based systems that provide sendmmsg().
+ *
+ */
+#ifndef INET_CONFIG_UDP_SEND_BATCH_SIZE
+#define INET_CONFIG_UDP_SEND_BATCH_SIZE                     16
+#endif // INET_CONFIG_UDP_SEND_BATCH_SIZE
+
 /**
  *  @def INET_CONFIG_NUM_TUN_ENDPOINTS
  *
@@ -667,6 +667,73 @@ exit:
     return res;
 }
 
+/**
+ * @brief   Send a number of UDP messages, each to its own destination.
+ *
+ * @param[in]   pktInfos    source and destination information for each UDP message
+ * @param[in]   msgs        packet buffers containing the UDP messages
+ * @param[in]   count       the number of messages
+ * @param[out]  results     if not NULL, receives the outcome of sending each message
+ * @param[in]   sendFlags   optional transmit option flags
+ *
+ * @return  The first error encountered while sending the messages, or
+ *          INET_NO_ERROR if all messages were queued for transmit.  The
+ *          errors are those of SendMsg().
+ *
+ * @details
+ *      All destinations must be of the address type of the endpoint.  On
+ *      sockets-based systems that provide \c sendmmsg(), the messages are
+ *      handed to the operating system in batches of up to
+ *      #INET_CONFIG_UDP_SEND_BATCH_SIZE, rather than with one system call
+ *      per message.  Elsewhere, the messages are sent one at a time with
+ *      SendMsg().
+ *
+ *      Unless <tt>(sendFlags & kSendFlag_RetainBuffer) != 0</tt>, calls
+ *      <tt>Weave::System::PacketBuffer::Free</tt> on each message buffer
+ *      on behalf of the caller.
+ */
+INET_ERROR UDPEndPoint::SendMsgBatch(const IPPacketInfo *pktInfos, PacketBuffer * const *msgs, uint16_t count, INET_ERROR *results, uint16_t sendFlags)
+{
+    INET_ERROR res = INET_NO_ERROR;
+
+    VerifyOrExit(count > 0, );
+
+#if WEAVE_SYSTEM_CONFIG_USE_SOCKETS
+
+    res = GetSocket(pktInfos[0].DestAddress.Type());
+    if (res != INET_NO_ERROR)
+    {
+        if (results != NULL)
+            for (uint16_t i = 0; i < count; i++)
+                results[i] = res;
+    }
+    else
+    {
+        res = IPEndPointBasis::SendMsgBatch(pktInfos, msgs, count, results);
+    }
+
+    if ((sendFlags & kSendFlag_RetainBuffer) == 0)
+        for (uint16_t i = 0; i < count; i++)
+            PacketBuffer::Free(msgs[i]);
+
+#else // !WEAVE_SYSTEM_CONFIG_USE_SOCKETS
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        INET_ERROR err = SendMsg(&pktInfos[i], msgs[i], sendFlags);
+
+        if (results != NULL)
+            results[i] = err;
+        if (res == INET_NO_ERROR)
+            res = err;
+    }
+
+#endif // !WEAVE_SYSTEM_CONFIG_USE_SOCKETS
+
+exit:
+    return res;
+}
+
 /**
  * @brief   Bind the endpoint to a network interface.
  *
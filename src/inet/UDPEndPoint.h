@@ -61,6 +61,8 @@ public:
     INET_ERROR SendTo(IPAddress addr, uint16_t port, Weave::System::PacketBuffer *msg, uint16_t sendFlags = 0);
     INET_ERROR SendTo(IPAddress addr, uint16_t port, InterfaceId intfId, Weave::System::PacketBuffer *msg, uint16_t sendFlags = 0);
     INET_ERROR SendMsg(const IPPacketInfo *pktInfo, Weave::System::PacketBuffer *msg, uint16_t sendFlags = 0);
+    INET_ERROR SendMsgBatch(const IPPacketInfo *pktInfos, Weave::System::PacketBuffer * const *msgs, uint16_t count,
+                            INET_ERROR *results, uint16_t sendFlags = 0);
     void Close(void);
     void Free(void);
 
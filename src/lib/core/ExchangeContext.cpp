@@ -66,6 +66,7 @@ enum {
     kFlagAutoReleaseKey         = 0x0100, /// Automatically release the message encryption key when the exchange context is freed.
     kFlagAutoReleaseConnection  = 0x0200, /// Automatically release the associated WeaveConnection when the exchange context is freed.
     kFlagUseEphemeralUDPPort    = 0x0400, /// When set, use the local ephemeral UDP port as the source port for outbound messages.
+    kFlagAdaptiveRetrans        = 0x0800, /// When set, derive WRMP retransmission timeouts from the measured round-trip time to the peer.
 };
 
 /**
@@ -187,6 +188,20 @@ void ExchangeContext::SetMsgRcvdFromPeer(bool inMsgRcvdFromPeer)
 void ExchangeContext::SetAckPending(bool inAckPending)
 {
     SetFlag(mFlags, static_cast<uint16_t>(kFlagAckPending), inAckPending);
+
+    // Acks held for a Selective Ack message are only meaningful while an ack is pending.
+    if (!inAckPending)
+    {
+        mWRMPExtraAckCount = 0;
+    }
+
+    // Keep the exchange manager's pending ack list, which drives the sending
+    // of solitary acks, in sync with the flag.
+    ExchangeMgr->WRMPRemovePendingAck(this);
+    if (inAckPending)
+    {
+        ExchangeMgr->WRMPAddPendingAck(this);
+    }
 }
 
 /**
@@ -235,7 +250,9 @@ static inline bool IsWRMPControlMessage(uint32_t profileId, uint8_t msgType)
 {
     return (profileId == nl::Weave::Profiles::kWeaveProfile_Common &&
             (msgType == nl::Weave::Profiles::Common::kMsgType_WRMP_Throttle_Flow ||
-             msgType == nl::Weave::Profiles::Common::kMsgType_WRMP_Delayed_Delivery));
+             msgType == nl::Weave::Profiles::Common::kMsgType_WRMP_Delayed_Delivery ||
+             msgType == nl::Weave::Profiles::Common::kMsgType_WRMP_Selective_Ack ||
+             msgType == nl::Weave::Profiles::Common::kMsgType_WRMP_Ack_List));
 }
 #endif // WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
 
@@ -452,7 +469,11 @@ WEAVE_ERROR ExchangeContext::SendMessage(uint32_t profileId, uint8_t msgType, Pa
     }
 
     // Abort early if Throttle is already set;
-    VerifyOrExit(mWRMPThrottleTimeout == 0, err = WEAVE_ERROR_SEND_THROTTLED);
+    VerifyOrExit(!WRMPIsThrottled(), err = WEAVE_ERROR_SEND_THROTTLED);
+
+    // Abort early if the send window is in use and already full;
+    VerifyOrExit(mWRMPSendWindow == 0 || (sendFlags & kSendFlag_RequestAck) == 0 || mWRMPUnackedCount < mWRMPSendWindow,
+                 err = WEAVE_ERROR_WRMP_SEND_WINDOW_FULL);
 
 #else // WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
 
@@ -519,6 +540,13 @@ WEAVE_ERROR ExchangeContext::SendMessage(uint32_t profileId, uint8_t msgType, Pa
         }
     }
 
+    // Make room for all of the headers up front, so that encoding them moves the payload at most once,
+    // and not at all when the buffer was allocated with GetHeaderReserveSize().
+    if ((sendFlags & kSendFlag_AlreadyEncoded) == 0)
+    {
+        VerifyOrExit(msgBuf->EnsureReservedSize(PredictHeaderLength(msgInfo, sendFlags)), err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+    }
+
     // Add the exchange header to the message buffer.
     WeaveExchangeHeader exchangeHeader;
     memset(&exchangeHeader, 0, sizeof(exchangeHeader));
@@ -594,12 +622,18 @@ WEAVE_ERROR ExchangeContext::SendMessage(uint32_t profileId, uint8_t msgType, Pa
             SuccessOrExit(err);
             msgBuf = NULL;
 
+            //The message now holds its place in the sequence; retransmissions reuse the encoded header
+            if (exchangeHeader.Flags & kWeaveExchangeFlag_SequenceNum)
+            {
+                mWRMPSendSeqNum++;
+            }
+
             err = ExchangeMgr->SendFromRetransTable(entry);
             sendCalled = true;
             SuccessOrExit(err);
 
             WEAVE_FAULT_INJECT(FaultInjection::kFault_WRMDoubleTx,
-                               entry->nextRetransTime = 0;
+                               ExchangeMgr->WRMPScheduleRetrans(entry, ExchangeMgr->mWRMPCurrentTick);
                                ExchangeMgr->WRMPStartTimer()
                                );
 
@@ -675,7 +709,7 @@ WEAVE_ERROR ExchangeContext::SendCommonNullMessage(void)
     PacketBuffer *msgBuf = NULL;
 
     // Allocate a buffer for the null message
-    msgBuf = PacketBuffer::NewWithAvailableSize(0);
+    msgBuf = PacketBuffer::NewWithAvailableSize(GetHeaderReserveSize(kSendFlag_NoAutoRequestAck), 0);
     VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
     // Send the null message
@@ -700,6 +734,70 @@ exit:
     return err;
 }
 
+/**
+ *  Get the number of bytes to reserve ahead of the payload of a message that will be sent on this
+ *  exchange.
+ *
+ *  The size covers the exchange and message headers that will be encoded for the current peer,
+ *  key and transport, plus any lower layer headers of the platform.  Allocating message buffers
+ *  with this reservation, e.g. with PacketBuffer::NewWithAvailableSize(), allows the headers to be
+ *  encoded without moving the payload.
+ *
+ *  @param[in]    sendFlags     The flags with which the message will be sent.
+ *
+ *  @return  the number of bytes to reserve.
+ *
+ */
+uint16_t ExchangeContext::GetHeaderReserveSize(uint16_t sendFlags)
+{
+    WeaveMessageInfo msgInfo;
+    msgInfo.Clear();
+    msgInfo.DestNodeId = PeerNodeId;
+    msgInfo.EncryptionType = EncryptionType;
+    msgInfo.KeyId = KeyId;
+
+    return (WEAVE_SYSTEM_CONFIG_HEADER_RESERVE_SIZE - WEAVE_SYSTEM_HEADER_RESERVE_SIZE) + PredictHeaderLength(&msgInfo, sendFlags);
+}
+
+/**
+ *  Predict the combined length of the exchange and message headers of a message sent on this
+ *  exchange.  Optional exchange header fields that may be added at send time are assumed present.
+ */
+uint16_t ExchangeContext::PredictHeaderLength(const WeaveMessageInfo *msgInfo, uint16_t sendFlags)
+{
+    // Version/Flags + Msg Type + Exch Id + Profile Id
+    uint16_t headLen = 8;
+
+#if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+    if (Con == NULL && mMsgProtocolVersion != kWeaveMessageVersion_V1)
+    {
+        // A pending acknowledgment may be piggybacked on any V2 message.
+        headLen += 4;
+
+        if ((mFlags & kFlagAutoRequestAck) != 0 && (sendFlags & kSendFlag_NoAutoRequestAck) == 0)
+        {
+            sendFlags |= kSendFlag_RequestAck;
+        }
+
+        if (mWRMPSendWindow != 0 && (sendFlags & kSendFlag_RequestAck) != 0)
+        {
+            headLen += 2;
+        }
+    }
+#endif // WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+
+    if (Con != NULL)
+    {
+        headLen += Con->PredictMessageHeaderLength(msgInfo);
+    }
+    else
+    {
+        headLen += ExchangeMgr->MessageLayer->PredictMessageHeaderLength(PeerAddr, msgInfo);
+    }
+
+    return headLen;
+}
+
 /**
  *  Encode the exchange header into a message buffer.
  *
@@ -750,8 +848,16 @@ WEAVE_ERROR ExchangeContext::EncodeExchHeader(WeaveExchangeHeader *exchangeHeade
             exchangeHeader->Flags |= kWeaveExchangeFlag_AckId;
             exchangeHeader->AckMsgId = mPendingPeerAckId;
 
-            //Set AckPending flag to false after setting the Ack flag;
-            SetAckPending(false);
+            //Any older acks held for a Selective Ack message remain pending;
+            //otherwise set AckPending flag to false after setting the Ack flag;
+            if (mWRMPExtraAckCount > 0)
+            {
+                mPendingPeerAckId = mWRMPExtraAckIds[--mWRMPExtraAckCount];
+            }
+            else
+            {
+                SetAckPending(false);
+            }
 
             // Schedule next physical wakeup
             ExchangeMgr->WRMPStartTimer();
@@ -766,6 +872,13 @@ WEAVE_ERROR ExchangeContext::EncodeExchHeader(WeaveExchangeHeader *exchangeHeade
         if ((sendFlags & kSendFlag_RequestAck) && !IsWRMPControlMessage(profileId, msgType))
         {
             exchangeHeader->Flags |= kWeaveExchangeFlag_NeedsAck;
+
+            //Number the message for in-order delivery when the send window is in use
+            if (mWRMPSendWindow != 0)
+            {
+                exchangeHeader->Flags |= kWeaveExchangeFlag_SequenceNum;
+                exchangeHeader->SequenceNum = mWRMPSendSeqNum;
+            }
         }
 #endif // WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
     }
@@ -824,6 +937,9 @@ void ExchangeContext::DoClose(bool clearRetransTable)
         ExchangeMgr->ClearRetransmitTable(this);
     }
 
+    // Drop any messages held for in-order delivery
+    ExchangeMgr->WRMPFreeHeldMessages(this);
+
     // Schedule next physical wakeup
     ExchangeMgr->WRMPStartTimer();
 #endif
@@ -903,6 +1019,12 @@ void ExchangeContext::Release(void)
         }
 
         DoClose(false);
+
+#if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+        // Drop any ack that could not be flushed so the context leaves the pending ack list.
+        SetAckPending(false);
+#endif
+
         mRefCount = 0;
         ExchangeMgr = NULL;
 
@@ -1161,6 +1283,28 @@ void ExchangeContext::HandleResponseTimeout(System::Layer* aSystemLayer, void* a
 }
 
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+/**
+ *  Determine whether sending on this exchange is currently paused by a
+ *  Throttle Flow message received from the peer.
+ *
+ *  @return Returns 'true' if the throttle period has not yet elapsed, else 'false'.
+ */
+bool ExchangeContext::WRMPIsThrottled(void)
+{
+    if (mWRMPThrottleTimeout != 0)
+    {
+        // Expire any virtual ticks that have expired so the throttle check reflects the current time
+        ExchangeMgr->WRMPExpireTicks();
+
+        if (WeaveExchangeManager::IsWRMPTickDue(mWRMPThrottleTimeout, ExchangeMgr->mWRMPCurrentTick))
+        {
+            mWRMPThrottleTimeout = 0;
+        }
+    }
+
+    return mWRMPThrottleTimeout != 0;
+}
+
 bool ExchangeContext::WRMPCheckAndRemRetransTable(uint32_t ackMsgId, void **rCtxt)
 {
     bool res = false;
@@ -1173,6 +1317,19 @@ bool ExchangeContext::WRMPCheckAndRemRetransTable(uint32_t ackMsgId, void **rCtx
             //Return context value
             *rCtxt = ExchangeMgr->RetransTable[i].msgCtxt;
 
+#if WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE > 0
+            // Sample the round-trip time only if the message was sent exactly once, since the
+            // ack of a retransmitted message cannot be matched to a particular transmission
+            // (Karn's algorithm).  Standalone acks are sampled too, although the peer may have
+            // held them for up to its ack piggyback timeout; excluding them would leave only
+            // piggybacked acks, whose delay includes the peer's application processing time.
+            if (ExchangeMgr->RetransTable[i].sendCount == 1)
+            {
+                uint32_t now = static_cast<uint32_t>(System::Timer::GetCurrentEpoch());
+                ExchangeMgr->WRMPUpdatePeerRTT(PeerNodeId, now - ExchangeMgr->RetransTable[i].sentTime);
+            }
+#endif
+
             //Clear the entry from the retransmision table.
             ExchangeMgr->ClearRetransmitTable(ExchangeMgr->RetransTable[i]);
 
@@ -1199,8 +1356,8 @@ WEAVE_ERROR ExchangeContext::WRMPFlushAcks(void)
 
     if (IsAckPending())
     {
-        //Send the acknowledgment as a Common::Null message
-        err = SendCommonNullMessage();
+        //Send the acknowledgments as a Common::Null or Selective Ack message
+        err = WRMPSendAcks();
 
         if (err == WEAVE_NO_ERROR)
         {
@@ -1223,8 +1380,100 @@ WEAVE_ERROR ExchangeContext::WRMPFlushAcks(void)
  */
 uint32_t ExchangeContext::GetCurrentRetransmitTimeout(void)
 {
-  return (HasRcvdMsgFromPeer() ? mWRMPConfig.mActiveRetransTimeout :
-                                 mWRMPConfig.mInitialRetransTimeout);
+    uint32_t timeout = (HasRcvdMsgFromPeer() ? mWRMPConfig.mActiveRetransTimeout :
+                                               mWRMPConfig.mInitialRetransTimeout);
+
+#if WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE > 0
+    // If enabled, and a round-trip time estimate exists for the peer, it replaces the configured timeout.
+    if (IsAdaptiveRetransEnabled())
+    {
+        ExchangeMgr->WRMPGetPeerRetransTimeout(PeerNodeId, timeout);
+    }
+#endif
+
+    return timeout;
+}
+
+/**
+ *  Determine whether WRMP retransmission timeouts on this exchange are derived
+ *  from the round-trip time measured to the peer.
+ *
+ *  @return Returns 'true' if adaptive retransmission timeouts are enabled, else 'false'.
+ */
+bool ExchangeContext::IsAdaptiveRetransEnabled(void) const
+{
+    return GetFlag(mFlags, static_cast<uint16_t>(kFlagAdaptiveRetrans));
+}
+
+/**
+ *  Set whether WRMP retransmission timeouts on this exchange are derived from
+ *  the round-trip time measured to the peer.
+ *
+ *  When enabled, and once a round-trip time estimate is available for the peer,
+ *  the estimated retransmission timeout replaces the initial and active timeouts
+ *  in mWRMPConfig, and is doubled on each successive retransmission of a message
+ *  (bounded by #WEAVE_CONFIG_WRMP_MAX_RETRANS_TIMEOUT).  Until an estimate is
+ *  available, the configured timeouts are used.
+ *
+ *  @param[in]  inAdaptiveRetrans  A Boolean indicating whether (true) or not
+ *                                 (false) adaptive retransmission timeouts
+ *                                 should be used.
+ */
+void ExchangeContext::SetAdaptiveRetransEnabled(bool inAdaptiveRetrans)
+{
+    SetFlag(mFlags, static_cast<uint16_t>(kFlagAdaptiveRetrans), inAdaptiveRetrans);
+}
+
+/**
+ *  Get the WRMP send window of the exchange.
+ *
+ *  @return the maximum number of unacknowledged reliable messages, or 0 if
+ *  windowing is disabled.
+ */
+uint8_t ExchangeContext::GetWRMPSendWindow(void) const
+{
+    return mWRMPSendWindow;
+}
+
+/**
+ *  Set the WRMP send window of the exchange.
+ *
+ *  With a window of N, up to N messages sent with #kSendFlag_RequestAck may
+ *  await acknowledgment at the same time; sending a further one fails with
+ *  #WEAVE_ERROR_WRMP_SEND_WINDOW_FULL until an acknowledgment arrives (see
+ *  OnAckRcvd).  Each such message carries a sequence number in its exchange
+ *  header, which the peer uses to deliver the messages to its application in
+ *  order and to acknowledge several of them in one Selective Ack message.
+ *
+ *  No version or capability is negotiated for sequenced exchange headers: a
+ *  peer that does not support them does not ignore the sequence number but
+ *  misreads it as part of the payload.  A window should therefore only be set
+ *  on an exchange with a peer that is known, by other means, to support them.
+ *  A node only sends Selective Ack messages in reply to sequenced messages, so
+ *  they only reach peers that support them.
+ *
+ *  The peer holds back messages that follow a lost one, so if a message of the
+ *  window fails (see OnSendError) the exchange should be aborted.
+ *
+ *  A window of 0, the default, disables windowing: messages are not sequenced
+ *  and the number of unacknowledged messages is only bounded by the
+ *  retransmission table.
+ *
+ *  @param[in]  windowSize  The maximum number of unacknowledged reliable messages.
+ *
+ *  @retval  #WEAVE_ERROR_INVALID_ARGUMENT  If windowSize exceeds #WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW.
+ *  @retval  #WEAVE_NO_ERROR                On success.
+ */
+WEAVE_ERROR ExchangeContext::SetWRMPSendWindow(uint8_t windowSize)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    VerifyOrExit(windowSize <= WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    mWRMPSendWindow = windowSize;
+
+exit:
+    return err;
 }
 
 /**
@@ -1257,7 +1506,7 @@ WEAVE_ERROR ExchangeContext::WRMPSendThrottleFlow(uint32_t pauseTimeMillis)
     uint8_t      *p      = NULL;
     uint8_t      msgLen  = sizeof(pauseTimeMillis);
 
-    msgBuf = PacketBuffer::NewWithAvailableSize(msgLen);
+    msgBuf = PacketBuffer::NewWithAvailableSize(GetHeaderReserveSize(kSendFlag_NoAutoRequestAck), msgLen);
     VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
     p = msgBuf->Start();
@@ -1313,7 +1562,7 @@ WEAVE_ERROR ExchangeContext::WRMPSendDelayedDelivery(uint32_t pauseTimeMillis, u
     uint8_t      *p      = NULL;
     uint8_t      msgLen  = sizeof(pauseTimeMillis) + sizeof(delayedNodeId);
 
-    msgBuf = PacketBuffer::NewWithAvailableSize(msgLen);
+    msgBuf = PacketBuffer::NewWithAvailableSize(GetHeaderReserveSize(kSendFlag_NoAutoRequestAck), msgLen);
     VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
     p = msgBuf->Start();
@@ -1352,16 +1601,30 @@ exit:
  *
  */
 WEAVE_ERROR ExchangeContext::WRMPHandleRcvdAck(const WeaveExchangeHeader *exchHeader, const WeaveMessageInfo *msgInfo)
+{
+    return WRMPHandleRcvdAck(exchHeader->AckMsgId);
+}
+
+/**
+ *  Process an acknowledgment for the message with the given identifier.
+ *
+ *  @param[in]    ackMsgId           The identifier of the acknowledged message.
+ *
+ *  @retval  #WEAVE_ERROR_INVALID_ACK_ID                 if the msgId of received Ack is not in the RetransTable.
+ *  @retval  #WEAVE_NO_ERROR                             if the context was removed.
+ *
+ */
+WEAVE_ERROR ExchangeContext::WRMPHandleRcvdAck(uint32_t ackMsgId)
 {
     void         *msgCtxt  = NULL;
     WEAVE_ERROR  err     = WEAVE_NO_ERROR;
 
     //Msg is an Ack; Check Retrans Table and remove message context
-    if (!WRMPCheckAndRemRetransTable(exchHeader->AckMsgId, &msgCtxt))
+    if (!WRMPCheckAndRemRetransTable(ackMsgId, &msgCtxt))
     {
 #if defined(DEBUG)
         WeaveLogError(ExchangeManager, "Weave MsgId:%08" PRIX32" not in RetransTable",
-                      exchHeader->AckMsgId);
+                      ackMsgId);
 #endif
         err = WEAVE_ERROR_INVALID_ACK_ID;
         //Optionally call an application callback with this error.
@@ -1380,14 +1643,106 @@ WEAVE_ERROR ExchangeContext::WRMPHandleRcvdAck(const WeaveExchangeHeader *exchHe
         }
 #if defined(DEBUG)
         WeaveLogProgress(ExchangeManager, "Removed Weave MsgId:%08" PRIX32 " from RetransTable",
-                         exchHeader->AckMsgId);
+                         ackMsgId);
 #endif
     }
 
     return err;
 }
 
-WEAVE_ERROR ExchangeContext::WRMPHandleNeedsAck(const WeaveMessageInfo *msgInfo)
+/**
+ *  Process a received Selective Ack message.  The payload lists, as 32-bit
+ *  little-endian values, the identifiers of acknowledged messages in addition
+ *  to the one carried in the exchange header.
+ *
+ *  @note
+ *    This message is part of the Weave Reliable Messaging protocol.
+ *
+ *  @param[in]    msgBuf             A pointer to the PacketBuffer holding the message payload.
+ *
+ *  @retval  #WEAVE_ERROR_INVALID_MESSAGE_LENGTH         if the payload is not a whole number of message identifiers.
+ *  @retval  #WEAVE_NO_ERROR                             if the acknowledgments were processed.
+ *
+ */
+WEAVE_ERROR ExchangeContext::WRMPHandleSelectiveAck(PacketBuffer *msgBuf)
+{
+    WEAVE_ERROR   err = WEAVE_NO_ERROR;
+    const uint8_t *p  = msgBuf->Start();
+    uint16_t      len = msgBuf->DataLength();
+
+    VerifyOrExit((len % 4) == 0, err = WEAVE_ERROR_INVALID_MESSAGE_LENGTH);
+
+    for (; len > 0; len -= 4)
+    {
+        // Acks for messages that are no longer outstanding are ignored.
+        WRMPHandleRcvdAck(LittleEndian::Read32(p));
+    }
+
+exit:
+    return err;
+}
+
+/**
+ *  Send all pending acknowledgments.  A single pending acknowledgment is sent
+ *  in a Common::Null message; when acknowledgments have been accumulated for
+ *  sequenced messages, the most recent is carried in the exchange header of a
+ *  Selective Ack message and the others in its payload.
+ *
+ *  @note
+ *    This message is part of the Weave Reliable Messaging protocol.
+ *
+ *  @retval  #WEAVE_ERROR_NO_MEMORY   If no available PacketBuffers.
+ *  @retval  #WEAVE_NO_ERROR          If the method succeeded or the error wasn't critical.
+ *  @retval  other                    Another critical error returned by SendMessage().
+ *
+ */
+WEAVE_ERROR ExchangeContext::WRMPSendAcks(void)
+{
+    WEAVE_ERROR  err     = WEAVE_NO_ERROR;
+    PacketBuffer *msgBuf = NULL;
+    uint8_t      *p      = NULL;
+    uint16_t     len     = mWRMPExtraAckCount * 4;
+
+    if (mWRMPExtraAckCount == 0)
+    {
+        return SendCommonNullMessage();
+    }
+
+    msgBuf = PacketBuffer::NewWithAvailableSize(GetHeaderReserveSize(kSendFlag_NoAutoRequestAck), len);
+    VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+    p = msgBuf->Start();
+    for (uint8_t i = 0; i < mWRMPExtraAckCount; i++)
+    {
+        LittleEndian::Write32(p, mWRMPExtraAckIds[i]);
+    }
+    msgBuf->SetDataLength(len);
+
+    // The payload now carries the older acks; the exchange header carries mPendingPeerAckId.
+    // Extra acks are only held for sequenced messages, so the peer supports Selective Acks.
+    mWRMPExtraAckCount = 0;
+
+    err = SendMessage(Profiles::kWeaveProfile_Common, Profiles::Common::kMsgType_WRMP_Selective_Ack,
+                      msgBuf, kSendFlag_NoAutoRequestAck);
+    msgBuf = NULL;
+
+exit:
+    if (WeaveMessageLayer::IsSendErrorNonCritical(err))
+    {
+        WeaveLogError(ExchangeManager, "Non-crit err %ld sending selective ack",
+                      long(err));
+        err = WEAVE_NO_ERROR;
+    }
+    if (err != WEAVE_NO_ERROR)
+    {
+        WeaveLogError(ExchangeManager, "Failed to send Selective ack for MsgId:%08" PRIX32 " to Peer %016" PRIX64 ":%ld",
+                      mPendingPeerAckId, PeerNodeId, (long)err);
+    }
+
+    return err;
+}
+
+WEAVE_ERROR ExchangeContext::WRMPHandleNeedsAck(const WeaveMessageInfo *msgInfo, bool isSequenced)
 {
     WEAVE_ERROR  err = WEAVE_NO_ERROR;
 
@@ -1401,6 +1756,13 @@ WEAVE_ERROR ExchangeContext::WRMPHandleNeedsAck(const WeaveMessageInfo *msgInfo)
             WeaveLogProgress(ExchangeManager, "Forcing tx of solitary ack for duplicate MsgId:%08" PRIX32,
                              msgInfo->MessageId);
 #endif
+        // Send any acks held for a Selective Ack message first, leaving at most one pending.
+        if (mWRMPExtraAckCount > 0)
+        {
+            err = WRMPSendAcks();
+            SuccessOrExit(err);
+        }
+
         // Is there pending ack for a different message id.
         bool wasAckPending = IsAckPending() && mPendingPeerAckId != msgInfo->MessageId;
 
@@ -1426,20 +1788,29 @@ WEAVE_ERROR ExchangeContext::WRMPHandleNeedsAck(const WeaveMessageInfo *msgInfo)
     // Otherwise, the message IS NOT a duplicate.
     else
     {
+        // Acks for sequenced messages accumulate, up to the largest send window, and keep
+        // the deadline of the oldest one.
+        if (IsAckPending() && isSequenced && mWRMPExtraAckCount < WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW)
+        {
+            mWRMPExtraAckIds[mWRMPExtraAckCount++] = mPendingPeerAckId;
+            mPendingPeerAckId = msgInfo->MessageId;
+            ExitNow();
+        }
+
         if (IsAckPending())
         {
 #if defined(DEBUG)
             WeaveLogProgress(ExchangeManager, "Pending ack queue full; forcing tx of solitary ack for MsgId:%08" PRIX32,
                              mPendingPeerAckId);
 #endif
-            // Send the Ack for the currently pending Ack in a Common::Null message.
-            err = SendCommonNullMessage();
+            // Send the currently pending Acks in a Common::Null or Selective Ack message.
+            err = WRMPSendAcks();
             SuccessOrExit(err);
         }
 
         // Replace the Pending ack id.
         mPendingPeerAckId = msgInfo->MessageId;
-        mWRMPNextAckTime = ExchangeMgr->GetTickCounterFromTimeDelta(mWRMPConfig.mAckPiggybackTimeout + System::Timer::GetCurrentEpoch(), ExchangeMgr->mWRMPTimeStampBase);
+        mWRMPNextAckTime = ExchangeMgr->WRMPTickFromNow(mWRMPConfig.mAckPiggybackTimeout);
         SetAckPending(true);
     }
 
@@ -1459,8 +1830,7 @@ WEAVE_ERROR ExchangeContext::HandleThrottleFlow(uint32_t PauseTimeMillis)
 
     if (0 != PauseTimeMillis)
     {
-        mWRMPThrottleTimeout = ExchangeMgr->GetTickCounterFromTimeDelta((System::Timer::GetCurrentEpoch() + PauseTimeMillis),
-                                                                        ExchangeMgr->mWRMPTimeStampBase);
+        mWRMPThrottleTimeout = ExchangeMgr->WRMPTickFromNow(PauseTimeMillis);
     }
     else
     {
@@ -1478,14 +1848,14 @@ WEAVE_ERROR ExchangeContext::HandleThrottleFlow(uint32_t PauseTimeMillis)
             // Adjust the retrans timer value to account for throttling.
             if (0 != PauseTimeMillis)
             {
-                ExchangeMgr->RetransTable[i].nextRetransTime += PauseTimeMillis / ExchangeMgr->mWRMPTimerInterval;
+                ExchangeMgr->WRMPScheduleRetrans(&ExchangeMgr->RetransTable[i],
+                                                 ExchangeMgr->RetransTable[i].nextRetransTime + PauseTimeMillis / ExchangeMgr->mWRMPTimerInterval);
             }
             // UnThrottle when PauseTimeMillis is set to 0
             else
             {
-                ExchangeMgr->RetransTable[i].nextRetransTime = 0;
+                ExchangeMgr->WRMPScheduleRetrans(&ExchangeMgr->RetransTable[i], ExchangeMgr->mWRMPCurrentTick);
             }
-            break;
         }
     }
     // Call OnThrottleRcvd application callback
@@ -1539,8 +1909,8 @@ WEAVE_ERROR ExchangeContext::HandleMessage(WeaveMessageInfo *msgInfo, const Weav
 {
     WEAVE_ERROR   err = WEAVE_NO_ERROR;
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
-    const uint8_t *p  = NULL;
-    uint32_t      PauseTimeMillis = 0;
+    bool          isSequenced = false;
+    int16_t       seqDelta = 0;
 #endif
 
     // We hold a reference to the ExchangeContext here to
@@ -1556,6 +1926,60 @@ WEAVE_ERROR ExchangeContext::HandleMessage(WeaveMessageInfo *msgInfo, const Weav
         {
             err = WRMPHandleRcvdAck(exchHeader, msgInfo);
         }
+        if (exchHeader->ProfileId == nl::Weave::Profiles::kWeaveProfile_Common &&
+            exchHeader->MessageType == nl::Weave::Profiles::Common::kMsgType_WRMP_Selective_Ack)
+        {
+            err = WRMPHandleSelectiveAck(msgBuf);
+        }
+
+        // Sequenced messages are delivered in order; one that arrives ahead of its
+        // predecessors is held back until they have been delivered.
+        //
+        // For a sequenced message, the sequence number rather than the message layer's
+        // duplicate detection decides whether it is new: the message layer records the id
+        // of a message even if it is dropped below without an ack, so its retransmission
+        // arrives marked as a duplicate. An exchange is only ever created by the first
+        // sequenced message sent on it (see WeaveExchangeManager::DispatchMessage()), so
+        // every message behind the window has been delivered.
+        if (exchHeader->Flags & kWeaveExchangeFlag_SequenceNum)
+        {
+            isSequenced = true;
+            seqDelta = static_cast<int16_t>(exchHeader->SequenceNum - mWRMPRcvSeqNum);
+
+            if (seqDelta < 0)
+            {
+                // Already delivered; acknowledge it again and drop it like any duplicate.
+                msgInfo->Flags |= kWeaveMessageFlag_DuplicateMessage;
+            }
+            else if (seqDelta == 0)
+            {
+                // Not delivered yet, whatever the message layer concluded, unless this
+                // exchange was just created for it.
+                if (umhandler == NULL)
+                {
+                    msgInfo->Flags &= ~kWeaveMessageFlag_DuplicateMessage;
+                }
+            }
+            else if (ExchangeMgr->WRMPFindHeldMessage(this, exchHeader->SequenceNum) != NULL)
+            {
+                // Already held; acknowledge it again and drop it like any duplicate.
+                msgInfo->Flags |= kWeaveMessageFlag_DuplicateMessage;
+            }
+            else
+            {
+                msgInfo->Flags &= ~kWeaveMessageFlag_DuplicateMessage;
+
+                // A message that is too far ahead, or that cannot be held, is dropped
+                // without an ack, so that the peer retransmits it later.
+                if (seqDelta >= WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW ||
+                    ExchangeMgr->WRMPHoldMessage(this, msgInfo, exchHeader, msgBuf) != WEAVE_NO_ERROR)
+                {
+                    ExitNow(err = WEAVE_NO_ERROR);
+                }
+                msgBuf = NULL;
+            }
+        }
+
         if (exchHeader->Flags & kWeaveExchangeFlag_NeedsAck)
         {
             //Set the flag in message header indicating an ack requested by peer;
@@ -1566,9 +1990,15 @@ WEAVE_ERROR ExchangeContext::HandleMessage(WeaveMessageInfo *msgInfo, const Weav
 
             if (!ShouldDropAck())
             {
-                err = WRMPHandleNeedsAck(msgInfo);
+                err = WRMPHandleNeedsAck(msgInfo, isSequenced);
             }
         }
+
+        // A held message is delivered after its predecessors.
+        if (isSequenced && seqDelta > 0)
+        {
+            ExitNow(err = WEAVE_NO_ERROR);
+        }
 #endif
     }
 
@@ -1578,6 +2008,60 @@ WEAVE_ERROR ExchangeContext::HandleMessage(WeaveMessageInfo *msgInfo, const Weav
         ExitNow(err = WEAVE_NO_ERROR);
     }
 
+#if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+    if (isSequenced && seqDelta == 0)
+    {
+        mWRMPRcvSeqNum++;
+    }
+#endif
+
+    DeliverMessage(msgInfo, exchHeader, msgBuf, umhandler);
+    msgBuf = NULL;
+
+#if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+    // Deliver any held messages that are now in order.
+    if (isSequenced && seqDelta == 0)
+    {
+        WRMPDeliverHeldMessages();
+    }
+#endif
+
+exit:
+
+    // Release the reference to the ExchangeContext that was held at the beginning of this function.
+    // This call should also do the needful of closing the ExchangeContext if the application has
+    // already made a prior call to Close().
+    Release();
+
+    if (msgBuf != NULL)
+    {
+        PacketBuffer::Free(msgBuf);
+    }
+
+    return err;
+}
+
+/**
+ * Deliver a message received on the exchange: process WRMP control messages and
+ * pass any other message to the application.
+ *
+ * @param[in] msgInfo       General Weave message information for the incoming message.
+ * @param[in] exchHeader    Weave exchange information for the incoming message.
+ * @param[in] msgBuf        PacketBuffer containing the payload of the incoming message;
+ *                          ownership of the buffer passes to this method.
+ * @param[in] umhandler     Pointer to a message receive callback function; if this function
+ *                          is not NULL it will be used in place of the OnMessageReceived function
+ *                          installed in the ExchangeContext.
+ *
+ */
+void ExchangeContext::DeliverMessage(WeaveMessageInfo *msgInfo, const WeaveExchangeHeader *exchHeader, PacketBuffer *msgBuf,
+                                     ExchangeContext::MessageReceiveFunct umhandler)
+{
+#if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+    const uint8_t *p  = NULL;
+    uint32_t      PauseTimeMillis = 0;
+#endif
+
     //Received Flow Throttle
     if (exchHeader->ProfileId == nl::Weave::Profiles::kWeaveProfile_Common &&
         exchHeader->MessageType == nl::Weave::Profiles::Common::kMsgType_WRMP_Throttle_Flow)
@@ -1587,14 +2071,14 @@ WEAVE_ERROR ExchangeContext::HandleMessage(WeaveMessageInfo *msgInfo, const Weav
         p = msgBuf->Start();
         PauseTimeMillis = LittleEndian::Read32(p);
         HandleThrottleFlow(PauseTimeMillis);
-        ExitNow(err = WEAVE_NO_ERROR);
 #endif
     }
-    //Return and not pass this to Application if Common::Null Msg Type
+    //Return and not pass this to Application if Common::Null, Selective Ack or Ack List Msg Type
     else if ((exchHeader->ProfileId == nl::Weave::Profiles::kWeaveProfile_Common) &&
-        (exchHeader->MessageType == nl::Weave::Profiles::Common::kMsgType_Null))
+        (exchHeader->MessageType == nl::Weave::Profiles::Common::kMsgType_Null ||
+         exchHeader->MessageType == nl::Weave::Profiles::Common::kMsgType_WRMP_Selective_Ack ||
+         exchHeader->MessageType == nl::Weave::Profiles::Common::kMsgType_WRMP_Ack_List))
     {
-        ExitNow(err = WEAVE_NO_ERROR);
     }
     else
     {
@@ -1626,20 +2110,46 @@ WEAVE_ERROR ExchangeContext::HandleMessage(WeaveMessageInfo *msgInfo, const Weav
         }
     }
 
-exit:
-
-    // Release the reference to the ExchangeContext that was held at the beginning of this function.
-    // This call should also do the needful of closing the ExchangeContext if the application has
-    // already made a prior call to Close().
-    Release();
-
     if (msgBuf != NULL)
     {
         PacketBuffer::Free(msgBuf);
     }
+}
 
-    return err;
+#if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+/**
+ * Deliver, in sequence, the held messages that follow the last sequenced message
+ * delivered on the exchange.
+ *
+ */
+void ExchangeContext::WRMPDeliverHeldMessages(void)
+{
+    WeaveExchangeManager::ReorderEntry *entry = NULL;
+    WeaveMessageInfo msgInfo;
+    WeaveExchangeHeader exchHeader;
+    IPPacketInfo pktInfo;
+    PacketBuffer *msgBuf = NULL;
+
+    while ((entry = ExchangeMgr->WRMPFindHeldMessage(this, mWRMPRcvSeqNum)) != NULL)
+    {
+        // Take the message out of the pool first, as the application may close the exchange.
+        msgInfo = entry->msgInfo;
+        exchHeader = entry->exchHeader;
+        msgBuf = entry->msgBuf;
+        if (msgInfo.InPacketInfo != NULL)
+        {
+            pktInfo = entry->pktInfo;
+            msgInfo.InPacketInfo = &pktInfo;
+        }
+        entry->msgBuf = NULL;
+        entry->exchContext = NULL;
+
+        mWRMPRcvSeqNum++;
+
+        DeliverMessage(&msgInfo, &exchHeader, msgBuf, NULL);
+    }
 }
+#endif // WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
 
 void ExchangeContext::HandleConnectionClosed(WEAVE_ERROR conErr)
 {
@@ -1440,7 +1440,33 @@ exit:
 
 uint32_t Binding::GetWeaveHeaderSize(void)
 {
-    return WEAVE_SYSTEM_CONFIG_HEADER_RESERVE_SIZE;
+    uint32_t headerSize = WEAVE_SYSTEM_CONFIG_HEADER_RESERVE_SIZE;
+
+    // Once the binding is ready its peer, key and transport are known, so only reserve room for the
+    // headers that will actually be encoded.
+    if (IsReady())
+    {
+        WeaveMessageInfo msgInfo;
+        msgInfo.Clear();
+        msgInfo.DestNodeId = mPeerNodeId;
+        msgInfo.EncryptionType = mEncType;
+        msgInfo.KeyId = static_cast<uint16_t>(mKeyId);
+
+        // Lower layer headers, plus Version/Flags + Msg Type + Exch Id + Profile Id of the exchange header.
+        headerSize = (WEAVE_SYSTEM_CONFIG_HEADER_RESERVE_SIZE - WEAVE_SYSTEM_HEADER_RESERVE_SIZE) + 8;
+
+        if (mCon != NULL)
+        {
+            headerSize += mCon->PredictMessageHeaderLength(&msgInfo);
+        }
+        else
+        {
+            // Allow for a piggybacked ack and a sequence number in the exchange header.
+            headerSize += 4 + 2 + mExchangeManager->MessageLayer->PredictMessageHeaderLength(mPeerAddress, &msgInfo);
+        }
+    }
+
+    return headerSize;
 }
 
 uint32_t Binding::GetWeaveTrailerSize(void)
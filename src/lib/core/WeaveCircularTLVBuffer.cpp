@@ -427,6 +427,7 @@ void CircularTLVWriter::Init(WeaveCircularTLVBuffer *buf)
     SetCloseContainerReserved(false);
 
     ImplicitProfileId = kProfileIdNotSpecified;
+    ProfileDictionary = NULL;
     GetNewBuffer = WeaveCircularTLVBuffer::GetNewBufferFunct;
     FinalizeBuffer = WeaveCircularTLVBuffer::FinalizeBufferFunct;
 
@@ -463,6 +464,7 @@ void CircularTLVReader::Init(WeaveCircularTLVBuffer *buf)
     mContainerType = kTLVType_NotSpecified;
     SetContainerOpen(false);
     ImplicitProfileId = kProfileIdNotSpecified;
+    ProfileDictionary = NULL;
     AppData = NULL;
 }
 
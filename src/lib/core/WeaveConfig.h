@@ -1013,6 +1013,48 @@
 #define WEAVE_CONFIG_MAX_PEER_NODES                         128
 #endif // WEAVE_CONFIG_MAX_PEER_NODES
 
+/**
+ *  @def WEAVE_CONFIG_PEER_TABLE_HASH_SIZE
+ *
+ *  @brief
+ *    The number of hash buckets used to look up peer nodes in the
+ *    peer state table.
+ *
+ *  The value must be a power of two.  Around half of
+ *  #WEAVE_CONFIG_MAX_PEER_NODES keeps the hash chains short.
+ *
+ */
+#ifndef WEAVE_CONFIG_PEER_TABLE_HASH_SIZE
+#define WEAVE_CONFIG_PEER_TABLE_HASH_SIZE                   64
+#endif // WEAVE_CONFIG_PEER_TABLE_HASH_SIZE
+
+#if (WEAVE_CONFIG_PEER_TABLE_HASH_SIZE & (WEAVE_CONFIG_PEER_TABLE_HASH_SIZE - 1)) != 0
+#error "WEAVE_CONFIG_PEER_TABLE_HASH_SIZE must be a power of two"
+#endif
+
+/**
+ *  @def WEAVE_CONFIG_MSG_COUNTER_WINDOW_SIZE
+ *
+ *  @brief
+ *    The width, in bits, of the state used to detect duplicate
+ *    messages received from a peer under a given key.
+ *
+ *  One bit records whether the message counter of the peer has been
+ *  synchronized; the others form a sliding window recording which of
+ *  the messages preceding the highest message id received have
+ *  arrived, so that messages reordered in the network by up to that
+ *  many positions are accepted exactly once.  Supported values are
+ *  16, 32 and 64.
+ *
+ *  The state is kept for each peer node and each session, so the
+ *  default of 16 keeps the original footprint; platforms with memory
+ *  to spare may widen the window.
+ *
+ */
+#ifndef WEAVE_CONFIG_MSG_COUNTER_WINDOW_SIZE
+#define WEAVE_CONFIG_MSG_COUNTER_WINDOW_SIZE                16
+#endif // WEAVE_CONFIG_MSG_COUNTER_WINDOW_SIZE
+
 /**
  *  @def WEAVE_CONFIG_MAX_CONNECTIONS
  *
@@ -1066,6 +1108,24 @@
 #define WEAVE_CONFIG_MAX_TUNNELS                            1
 #endif // WEAVE_CONFIG_MAX_TUNNELS
 
+/**
+ *  @def WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE
+ *
+ *  @brief
+ *    The number of peer nodes for which the message layer keeps traffic
+ *    statistics (messages, bytes, retransmissions, duplicates, decryption
+ *    failures and round-trip time).
+ *
+ *  Entries are created only for peers to which messages are sent, or from
+ *  which authenticated messages are received.  When the table is full, the
+ *  least recently active peer is evicted.  A value of (0) disables per-peer
+ *  traffic statistics.
+ *
+ */
+#ifndef WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE
+#define WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE          8
+#endif // WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE
+
 /**
  *  @def WEAVE_CONFIG_MAX_SESSION_KEYS
  *
@@ -1077,6 +1137,25 @@
 #define WEAVE_CONFIG_MAX_SESSION_KEYS                       WEAVE_CONFIG_MAX_CONNECTIONS
 #endif // WEAVE_CONFIG_MAX_SESSION_KEYS
 
+/**
+ *  @def WEAVE_CONFIG_SESSION_KEY_TABLE_HASH_SIZE
+ *
+ *  @brief
+ *    The number of hash buckets used to look up session keys by key
+ *    id in the session key table.
+ *
+ *  The value must be a power of two.  Around half of
+ *  #WEAVE_CONFIG_MAX_SESSION_KEYS keeps the hash chains short.
+ *
+ */
+#ifndef WEAVE_CONFIG_SESSION_KEY_TABLE_HASH_SIZE
+#define WEAVE_CONFIG_SESSION_KEY_TABLE_HASH_SIZE            16
+#endif // WEAVE_CONFIG_SESSION_KEY_TABLE_HASH_SIZE
+
+#if (WEAVE_CONFIG_SESSION_KEY_TABLE_HASH_SIZE & (WEAVE_CONFIG_SESSION_KEY_TABLE_HASH_SIZE - 1)) != 0
+#error "WEAVE_CONFIG_SESSION_KEY_TABLE_HASH_SIZE must be a power of two"
+#endif
+
 /**
  *  @def WEAVE_CONFIG_MAX_APPLICATION_EPOCH_KEYS
  *
@@ -1117,6 +1196,32 @@
 #define WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC         1
 #endif // WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC
 
+/**
+ *  @def WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME
+ *
+ *  @brief
+ *    The number of seconds before the start of the next application
+ *    epoch key at which the cached rotating message encryption keys
+ *    are derived for that epoch.
+ *
+ *  When a rotating application key is derived, a timer is armed that
+ *  derives the next-epoch keys of all cached groups shortly before
+ *  each epoch change.  Group messages sent with the new keys are then
+ *  decoded without waiting for a key derivation.  Prefetching needs
+ *  the platform to know the current UTC time, and adds entries to the
+ *  key cache, which should then be sized to hold two keys per group
+ *  (see #WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS).  A value of (0)
+ *  disables prefetching.
+ *
+ *  @note This configuration is only relevant when
+ *        #WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC is set and
+ *        ignored otherwise.
+ *
+ */
+#ifndef WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME
+#define WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME     0
+#endif // WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME
+
 /**
  *  @def WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS
  *
@@ -1132,6 +1237,9 @@
  *    It might be a good idea to allocate few more entries in the key
  *    cache for the corner cases, where application group is having
  *    simultaneous conversations using an 'old' and a 'new' epoch key.
+ *    When next-epoch keys are prefetched
+ *    (#WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME), allow for two
+ *    keys per application group.
  *
  *  @note This configuration is only relevant when
  *        #WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC is set and
@@ -1146,6 +1254,38 @@
 #error "Please set WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS to a value greater than zero and smaller than 256."
 #endif // !(WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS > 0 && WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS < 256)
 
+/**
+ *  @def WEAVE_CONFIG_MSG_ENC_APP_KEY_CACHE_SHARDS
+ *
+ *  @brief
+ *    The number of shards into which the message encryption application
+ *    key cache is divided.
+ *
+ *  Keys are assigned to shards by a hash of their key id, and each
+ *  shard is searched and replaced in least-recently-used order on its
+ *  own, so that a lookup only visits the entries of one shard.  The
+ *  value must be a power of two that divides
+ *  #WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS.
+ *
+ *  @note This configuration is only relevant when
+ *        #WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC is set and
+ *        ignored otherwise.
+ *
+ */
+#ifndef WEAVE_CONFIG_MSG_ENC_APP_KEY_CACHE_SHARDS
+#define WEAVE_CONFIG_MSG_ENC_APP_KEY_CACHE_SHARDS           1
+#endif // WEAVE_CONFIG_MSG_ENC_APP_KEY_CACHE_SHARDS
+
+#if (WEAVE_CONFIG_MSG_ENC_APP_KEY_CACHE_SHARDS & (WEAVE_CONFIG_MSG_ENC_APP_KEY_CACHE_SHARDS - 1)) != 0 || \
+    (WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS % WEAVE_CONFIG_MSG_ENC_APP_KEY_CACHE_SHARDS) != 0
+#error "WEAVE_CONFIG_MSG_ENC_APP_KEY_CACHE_SHARDS must be a power of two that divides WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS"
+#endif
+
+#if WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME > 0 && \
+    WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS < 2 * WEAVE_CONFIG_MSG_ENC_APP_KEY_CACHE_SHARDS
+#error "WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME requires at least two message encryption application key cache entries per shard"
+#endif
+
 /**
  *  @name Weave Encrypted Passcode Configuration
  *
@@ -1232,6 +1372,81 @@
 #define WEAVE_CONFIG_DEFAULT_SECURITY_SESSION_IDLE_TIMEOUT           15000
 #endif // WEAVE_CONFIG_DEFAULT_SECURITY_SESSION_IDLE_TIMEOUT
 
+/**
+ *  @def WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES
+ *
+ *  @brief
+ *    The maximum number of session establishments (CASE, PASE, TAKE)
+ *    and key exports that the security manager runs concurrently.
+ *
+ *  Each handshake has its own exchange, protocol engine and session
+ *  establishment timer.  Requests to start a handshake beyond this
+ *  limit fail with #WEAVE_ERROR_SECURITY_MANAGER_BUSY, unless they
+ *  arrive from a peer and can be held in the admission queue (see
+ *  #WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE).
+ *
+ *  @note Values greater than (1) require a security manager memory
+ *        allocator other than #WEAVE_CONFIG_SECURITY_MGR_MEMORY_MGMT_SIMPLE,
+ *        which only has room for the engine of a single handshake.
+ *
+ */
+#ifndef WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES
+#define WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES          1
+#endif // WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES
+
+#if WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES < 1
+#error "WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES must be at least 1"
+#endif
+
+#if WEAVE_CONFIG_SECURITY_MGR_MEMORY_MGMT_SIMPLE && WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES > 1
+#error "WEAVE_CONFIG_SECURITY_MGR_MEMORY_MGMT_SIMPLE supports only one concurrent handshake"
+#endif
+
+/**
+ *  @def WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE
+ *
+ *  @brief
+ *    The number of handshake requests from peers that the security
+ *    manager holds while all handshakes are in use.
+ *
+ *  Held requests are admitted in the order they arrived as handshakes
+ *  complete.  A peer may have only one request waiting at a time, and
+ *  a request that has waited longer than the session establishment
+ *  timeout is discarded.  Requests that find the queue full are
+ *  answered with a busy status report.  Each held request retains its
+ *  message buffer and exchange context.  A value of (0) disables the
+ *  queue.
+ *
+ */
+#ifndef WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE
+#define WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE               0
+#endif // WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE
+
+/**
+ *  @def WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS
+ *
+ *  @brief
+ *    The number of worker threads on which the Weave Security Manager
+ *    runs the public key operations of PASE and CASE session establishment.
+ *
+ *  With a value of (0), these operations run on the Weave thread, blocking
+ *  all other traffic while they take place.  Otherwise the handshake is
+ *  suspended while a worker thread performs the operation, and resumes on
+ *  the Weave thread once it is done.
+ *
+ *  Worker threads call into the CASE authentication delegates and the
+ *  Security Manager memory allocator, which must therefore be thread-safe.
+ *  Requires POSIX threads and #WEAVE_CONFIG_SECURITY_MGR_MEMORY_MGMT_MALLOC.
+ *
+ */
+#ifndef WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS
+#define WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS                     0
+#endif // WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS
+
+#if WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0 && !WEAVE_CONFIG_SECURITY_MGR_MEMORY_MGMT_MALLOC
+#error "WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS requires WEAVE_CONFIG_SECURITY_MGR_MEMORY_MGMT_MALLOC"
+#endif
+
 /**
  *  @def WEAVE_CONFIG_NUM_MESSAGE_BUFS
  *
@@ -1256,6 +1471,26 @@
 #define WEAVE_CONFIG_MAX_UNSOLICITED_MESSAGE_HANDLERS       32
 #endif // WEAVE_CONFIG_MAX_UNSOLICITED_MESSAGE_HANDLERS
 
+/**
+ *  @def WEAVE_CONFIG_UNSOLICITED_MESSAGE_HANDLER_HASH_SIZE
+ *
+ *  @brief
+ *    The number of hash buckets used to look up unsolicited message
+ *    handlers by profile id and message type.
+ *
+ *  The value must be a power of two.  Around half of
+ *  #WEAVE_CONFIG_MAX_UNSOLICITED_MESSAGE_HANDLERS keeps the hash chains
+ *  short.
+ *
+ */
+#ifndef WEAVE_CONFIG_UNSOLICITED_MESSAGE_HANDLER_HASH_SIZE
+#define WEAVE_CONFIG_UNSOLICITED_MESSAGE_HANDLER_HASH_SIZE  16
+#endif // WEAVE_CONFIG_UNSOLICITED_MESSAGE_HANDLER_HASH_SIZE
+
+#if (WEAVE_CONFIG_UNSOLICITED_MESSAGE_HANDLER_HASH_SIZE & (WEAVE_CONFIG_UNSOLICITED_MESSAGE_HANDLER_HASH_SIZE - 1)) != 0
+#error "WEAVE_CONFIG_UNSOLICITED_MESSAGE_HANDLER_HASH_SIZE must be a power of two"
+#endif
+
 /**
  *  @def WEAVE_CONFIG_MAX_EXCHANGE_CONTEXTS
  *
@@ -1334,6 +1569,7 @@
  *          2 -- Exchange Id
  *          4 -- Profile Id
  *          4 -- Acknowleged Message Id
+ *          2 -- Sequence Number (UDP only, so never alongside the Frame Length)
  *
  *    @note A number of these fields are optional or not presently used.
  *          So most headers will be considerably smaller than this.
@@ -1607,6 +1843,25 @@
 #endif
 #endif // WEAVE_CONFIG_DEFAULT_CASE_ALLOWED_CURVES
 
+/**
+ *  @def WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE
+ *
+ *  @brief
+ *    The number of peer nodes for which resumption secrets from earlier
+ *    CASE sessions are kept, so that a new session with the same peer can
+ *    be established without certificate validation or ECDH.
+ *
+ *  Each CASE session, full or resumed, leaves both nodes with a single-use
+ *  resumption id and secret derived from its session key.  When the cache
+ *  is full, the least recently used peer is evicted.  An initiator whose
+ *  resumption attempt is rejected falls back to a full CASE exchange.
+ *  A value of (0) disables session resumption.
+ *
+ */
+#ifndef WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE
+#define WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE             0
+#endif // WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE
+
 /**
  * @def WEAVE_CONFIG_LEGACY_CASE_AUTH_DELEGATE
  *
@@ -1810,6 +2065,21 @@
 #define WEAVE_CONFIG_ENABLE_PROVISIONING_BUNDLE_SUPPORT     1
 #endif // WEAVE_CONFIG_ENABLE_PROVISIONING_BUNDLE_SUPPORT
 
+/**
+ *  @def WEAVE_CONFIG_TLV_PUSH_PARSER_MAX_DEPTH
+ *
+ *  @brief
+ *    The maximum container nesting depth that can be tracked by a
+ *    nl::Weave::TLV::TLVPushParser.
+ *
+ *    Each level of nesting costs one byte of parser state.  Encodings
+ *    that nest containers more deeply than this are rejected.
+ *
+ */
+#ifndef WEAVE_CONFIG_TLV_PUSH_PARSER_MAX_DEPTH
+#define WEAVE_CONFIG_TLV_PUSH_PARSER_MAX_DEPTH              16
+#endif // WEAVE_CONFIG_TLV_PUSH_PARSER_MAX_DEPTH
+
 /**
  *  @def WEAVE_ERROR_LOGGING
  *
@@ -600,6 +600,32 @@ WEAVE_ERROR WeaveConnection::SendTunneledMessage (WeaveMessageInfo *msgInfo, Pac
 }
 #endif // WEAVE_CONFIG_ENABLE_TUNNELING
 
+/**
+ *  Predict the length of the headers that will be encoded ahead of the payload when a Weave
+ *  message is sent over this connection, including the frame length.
+ *
+ *  @param[in] msgInfo        A pointer to a WeaveMessageInfo object describing the message.
+ *
+ *  @return    the predicted length of the frame length and message header.
+ *
+ */
+uint16_t WeaveConnection::PredictMessageHeaderLength(const WeaveMessageInfo *msgInfo) const
+{
+    WeaveMessageInfo info = *msgInfo;
+
+    // Mirror the header flag selection in SendMessage().
+    if (SendSourceNodeId)
+        info.Flags |= kWeaveMessageFlag_SourceNodeId;
+
+    if ((info.Flags & kWeaveMessageFlag_DestNodeId) == 0 && info.DestNodeId == kNodeIdNotSpecified)
+        info.DestNodeId = PeerNodeId;
+
+    if (SendDestNodeId || info.DestNodeId != PeerNodeId)
+        info.Flags |= kWeaveMessageFlag_DestNodeId;
+
+    return 2 + WeaveMessageLayer::GetMessageHeaderLength(&info);
+}
+
 /**
  *  Send a Weave message over an established connection.
  *
@@ -1395,6 +1421,7 @@ void WeaveConnection::HandleDataReceived(TCPEndPoint *endPoint, PacketBuffer *da
         uint16_t            payloadLen;
         PacketBuffer*       payloadBuf = NULL;
         uint32_t            frameLen;
+        bool                haveFrameLen;
 
         packetInfo.Clear();
         con->GetPeerAddressInfo(packetInfo);
@@ -1403,71 +1430,47 @@ void WeaveConnection::HandleDataReceived(TCPEndPoint *endPoint, PacketBuffer *da
         msgInfo.InPacketInfo = &packetInfo;
         msgInfo.InCon = con;
 
-        // Attempt to parse an message from the head of the received queue.
-        err = msgLayer->DecodeMessageWithLength(data, con->PeerNodeId, con, &msgInfo, &payload, &payloadLen, &frameLen);
+        // Determine the length of the frame at the head of the received queue.  The frame may span
+        // any number of the buffers in the queue.
+        haveFrameLen = GetFrameLength(data, frameLen);
 
-        // If the initial buffer in the receive queue is not big enough to hold the entirety of
-        // the incoming message...
-        if (err == WEAVE_ERROR_MESSAGE_TOO_LONG)
-        {
-            // The Weave message decoding logic expects message data to be in contiguous memory.
-            // Therefore, if the packet buffer containing the initial portion of the message is
-            // not big enough to hold the entirety of the message, the data must be moved into
-            // a new buffer that is big enough.
-            //
-            // This situation can arise, for example, when when a TCP segment arrives containing
-            // part of a Weave message and the underlying network interface chooses to place the
-            // packet into a buffer that is smaller than the Weave message.
-            //
-            // Note that the logic here implies that when a system runs low on buffers, message
-            // reception can fail for lack of an appropriately sized buffer, resulting in the TCP
-            // connection being aborted.  The only way to avoid this is for the underlying network
-            // interface to always place packets into buffers that are big enough to hold the
-            // maximum size Weave message. If such a buffer is not available when a packet comes
-            // in, the network interface can simply discard the packet, resulting in the peer
-            // retransmitting it and the system recovering gracefully once the buffer pressure
-            // subsides.
-
-            // Attempt to allocate a buffer big enough to hold the entire message.  Fail with
-            // WEAVE_ERROR_MESSAGE_TOO_LONG if no such buffer is available.
-            PacketBuffer * newBuf = PacketBuffer::NewWithAvailableSize(0, frameLen);
-            if (newBuf == NULL)
-            {
-                break;
-            }
+        // Fail with WEAVE_ERROR_MESSAGE_TOO_LONG, closing the connection, if the frame could never be
+        // gathered into a single buffer.  Otherwise reception would stall waiting for a buffer that
+        // cannot be allocated.
+        if (haveFrameLen && frameLen > WEAVE_SYSTEM_CONFIG_PACKETBUFFER_CAPACITY_MAX)
+            err = WEAVE_ERROR_MESSAGE_TOO_LONG;
 
-            // Prepend the new buffer to the receive queue and copy the received message data into
-            // the new buffer, discarding the original buffer(s).
-            newBuf->AddToEnd(data);
-            data = newBuf;
-            data->CompactHead();
-
-            // Try again to decode the message.
-            continue;
-        }
-
-        // If the initial buffer in the receive queue contains only part of the next message...
-        if (err == WEAVE_ERROR_MESSAGE_INCOMPLETE)
+        else if (!haveFrameLen || data->TotalLength() < frameLen)
         {
-            // If there are more buffers in the queue, move as much data as possible into the head buffer
-            // and try again.
-            if (data->Next() != NULL)
-            {
-                data->CompactHead();
-                continue;
-            }
-
-            // Otherwise, we must wait for more data from the peer...
+            // If the queue contains only part of the next message, wait for more data from the peer,
+            // leaving the data that has already arrived where it is.
 
             // Open the receive window just enough to allow the remainder of the message to be received.
             // This is necessary in the case where the message size exceeds the TCP window size to ensure
             // the peer has enough window to send us the entire message.
-            uint16_t neededLen = frameLen - data->DataLength();
+            uint16_t neededLen = frameLen - data->TotalLength();
             err = endPoint->AckReceive(neededLen);
             if (err == WEAVE_NO_ERROR)
                 break;
         }
 
+        // The Weave message decoding logic expects message data to be in contiguous memory.  If the
+        // message spans buffers, gather it into the head buffer.
+        //
+        // Note that when a system runs low on buffers, message reception can fail for lack of an
+        // appropriately sized buffer to gather a message into.  In that case, the received data is
+        // kept and another attempt is made when more data arrives from the peer.
+        else
+        {
+            err = GatherFrame(data, static_cast<uint16_t>(frameLen));
+            if (err == WEAVE_ERROR_NO_MEMORY)
+                break;
+        }
+
+        // Parse the message at the head of the received queue.
+        if (err == WEAVE_NO_ERROR)
+            err = msgLayer->DecodeMessageWithLength(data, con->PeerNodeId, con, &msgInfo, &payload, &payloadLen, &frameLen);
+
         // If we successfully parsed a message, open the TCP receive window by the size of the message.
         if (err == WEAVE_NO_ERROR)
             err = endPoint->AckReceive(frameLen);
@@ -1479,35 +1482,9 @@ void WeaveConnection::HandleDataReceived(TCPEndPoint *endPoint, PacketBuffer *da
                 err = WEAVE_ERROR_INVALID_DESTINATION_NODE_ID;
         }
 
+        // Separate the payload of the message from any data that follows it.
         if (err == WEAVE_NO_ERROR)
-        {
-            // If there's no more data in the current buffer beyond the message that was just parsed,
-            // then avoid a copy by giving the buffer to the application layer.
-            if (data->DataLength() == 0)
-            {
-                // Detach the buffer from the data queue.
-                payloadBuf = data;
-                data = data->DetachTail();
-
-                // Adjust the buffer to point at the payload of the message.
-                payloadBuf->SetStart(payload);
-                payloadBuf->SetDataLength(payloadLen);
-            }
-
-            // Otherwise we need to keep the buffer so we can parse the remaining data, so copy the
-            // payload data into a new buffer and arrange to pass the new buffer to the application.
-            else
-            {
-                payloadBuf = PacketBuffer::New(0);
-                if (payloadBuf != NULL)
-                {
-                    memcpy(payloadBuf->Start(), payload, payloadLen);
-                    payloadBuf->SetDataLength(payloadLen);
-                }
-                else
-                    err = WEAVE_ERROR_NO_MEMORY;
-            }
-        }
+            err = DetachPayload(data, payload, payloadLen, payloadBuf);
 
         // Disconnect if an error occurred.
         if (err != WEAVE_NO_ERROR)
@@ -1607,6 +1584,162 @@ void WeaveConnection::HandleDataReceived(TCPEndPoint *endPoint, PacketBuffer *da
     }
 }
 
+/**
+ * Read the length of the frame at the head of a received data queue.
+ *
+ * @param[in]  data         The queue of received data.
+ * @param[out] frameLen     The length of the frame, including the message length field.  If the
+ *                          message length field itself has not been received, the minimum length
+ *                          of a frame.
+ *
+ * @return true if the message length field has been received.
+ */
+bool WeaveConnection::GetFrameLength(const PacketBuffer *data, uint32_t &frameLen)
+{
+    uint8_t lenField[2];
+    uint8_t fieldLen = 0;
+
+    // The message length field may be split across buffers.
+    for (; data != NULL && fieldLen < sizeof(lenField); data = data->Next())
+    {
+        const uint8_t *p = data->Start();
+        for (uint16_t i = 0; i < data->DataLength() && fieldLen < sizeof(lenField); i++)
+            lenField[fieldLen++] = p[i];
+    }
+
+    if (fieldLen < sizeof(lenField))
+    {
+        frameLen = 8; // Assume absolute minimum frame length.
+        return false;
+    }
+
+    // The frame length is the length of the message plus the length of the length field.
+    frameLen = static_cast<uint32_t>(Encoding::LittleEndian::Get16(lenField)) + 2;
+    return true;
+}
+
+/**
+ * Make the frame at the head of a received data queue contiguous in the head buffer.
+ *
+ * Only the bytes of the frame that are not already in the head buffer are copied, provided that
+ * they fit after the data in the head buffer.  Otherwise the frame is copied into a new buffer
+ * big enough to hold it.  Either way, each byte is copied at most once.
+ *
+ * @param[inout] data       The queue of received data, which must contain the entire frame.
+ * @param[in]    frameLen   The length of the frame.
+ *
+ * @retval #WEAVE_NO_ERROR          If the frame is contiguous in the head buffer of the queue.
+ * @retval #WEAVE_ERROR_NO_MEMORY   If a buffer big enough to hold the frame could not be allocated.
+ */
+WEAVE_ERROR WeaveConnection::GatherFrame(PacketBuffer *&data, uint16_t frameLen)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    PacketBuffer *rest;
+
+    // Nothing to do if the head buffer holds the entire frame, which is the usual case.
+    VerifyOrExit(data->DataLength() < frameLen, );
+
+    // If the remainder of the frame does not fit after the data in the head buffer, gather the frame
+    // into a new buffer placed in front of the queue.
+    if (data->AvailableDataLength() < frameLen - data->DataLength())
+    {
+        PacketBuffer *newBuf = PacketBuffer::NewWithAvailableSize(0, frameLen);
+        VerifyOrExit(newBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+        newBuf->AddToEnd(data);
+        data = newBuf;
+    }
+
+    // Move the remainder of the frame from the following buffers, releasing those that are emptied.
+    rest = data->DetachTail();
+    while (data->DataLength() < frameLen)
+    {
+        uint16_t copyLen = frameLen - data->DataLength();
+
+        // Release empty buffers, which Consume() would otherwise leave in place.
+        if (rest->DataLength() == 0)
+        {
+            rest = PacketBuffer::FreeHead(rest);
+            continue;
+        }
+
+        if (copyLen > rest->DataLength())
+            copyLen = rest->DataLength();
+
+        memcpy(data->Start() + data->DataLength(), rest->Start(), copyLen);
+        data->SetDataLength(data->DataLength() + copyLen);
+        rest = rest->Consume(copyLen);
+    }
+    if (rest != NULL)
+        data->AddToEnd(rest);
+
+exit:
+    return err;
+}
+
+/**
+ * Separate the payload of a message decoded in place from the received data that follows it.
+ *
+ * If no data follows the message, the head buffer itself is handed over.  Otherwise, whichever of
+ * the payload and the following data is shorter is copied to a new buffer, so that a large payload
+ * followed by the start of the next message is not copied in its entirety.
+ *
+ * @param[inout] data       The queue of received data, positioned after the decoded message.
+ * @param[in]    payload    The payload of the message, within the head buffer of the queue.
+ * @param[in]    payloadLen The length of the payload.
+ * @param[out]   payloadBuf A buffer containing only the payload.
+ */
+WEAVE_ERROR WeaveConnection::DetachPayload(PacketBuffer *&data, uint8_t *payload, uint16_t payloadLen, PacketBuffer *&payloadBuf)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    const uint16_t remainingLen = data->DataLength();
+
+    // If there's no more data in the current buffer beyond the message that was just parsed,
+    // then avoid a copy by giving the buffer to the application layer.
+    if (remainingLen == 0)
+    {
+        // Detach the buffer from the data queue.
+        payloadBuf = data;
+        data = data->DetachTail();
+    }
+
+    // If the data that follows the message is shorter than the payload, move it to a new buffer at
+    // the head of the queue and give the current buffer to the application layer.
+    else if (remainingLen < payloadLen)
+    {
+        PacketBuffer *remainingBuf = PacketBuffer::NewWithAvailableSize(0, remainingLen);
+        VerifyOrExit(remainingBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+        memcpy(remainingBuf->Start(), data->Start(), remainingLen);
+        remainingBuf->SetDataLength(remainingLen);
+
+        payloadBuf = data;
+        data = data->DetachTail();
+        if (data != NULL)
+            remainingBuf->AddToEnd(data);
+        data = remainingBuf;
+    }
+
+    // Otherwise we need to keep the buffer so we can parse the remaining data, so copy the
+    // payload data into a new buffer and arrange to pass the new buffer to the application.
+    else
+    {
+        payloadBuf = PacketBuffer::NewWithAvailableSize(0, payloadLen);
+        VerifyOrExit(payloadBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+        memcpy(payloadBuf->Start(), payload, payloadLen);
+        payloadBuf->SetDataLength(payloadLen);
+        ExitNow();
+    }
+
+    // Adjust the buffer to point at the payload of the message.
+    payloadBuf->SetStart(payload);
+    payloadBuf->SetDataLength(payloadLen);
+
+exit:
+    return err;
+}
+
 void WeaveConnection::HandleTcpConnectionClosed(TCPEndPoint *endPoint, INET_ERROR err)
 {
     WeaveConnection *con = (WeaveConnection *) endPoint->AppState;
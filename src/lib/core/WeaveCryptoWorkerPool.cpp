@@ -0,0 +1,345 @@
+/*
+ *
+ *    Copyright (c) 2019 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements a pool of worker threads that run time-consuming
+ *      cryptographic operations off the Weave thread.
+ *
+ */
+
+#ifndef __STDC_LIMIT_MACROS
+#define __STDC_LIMIT_MACROS
+#endif
+
+#include <Weave/Core/WeaveCore.h>
+#include <Weave/Core/WeaveCryptoWorkerPool.h>
+#include <Weave/Support/CodeUtils.h>
+#include <Weave/Support/ErrorStr.h>
+#include <Weave/Support/logging/WeaveLogging.h>
+
+#if WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
+
+#include <time.h>
+
+namespace nl {
+namespace Weave {
+
+CryptoWorkerPool::CryptoWorkerPool(void)
+{
+    mSystemLayer = NULL;
+    mWorkerCount = 0;
+}
+
+/**
+ * Start the worker threads.
+ *
+ * @param[in] systemLayer       The system layer on whose thread jobs are completed.
+ *
+ * @retval #WEAVE_NO_ERROR              On success.
+ * @retval #WEAVE_ERROR_INCORRECT_STATE If the pool is already running.
+ * @retval #WEAVE_ERROR_NO_MEMORY       If a worker thread could not be created.
+ */
+WEAVE_ERROR CryptoWorkerPool::Init(System::Layer &systemLayer)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    VerifyOrExit(mSystemLayer == NULL, err = WEAVE_ERROR_INCORRECT_STATE);
+
+    mQueueHead = mQueueTail = NULL;
+    mDoneHead = mDoneTail = NULL;
+    mCompletionScheduled = false;
+    mStopping = false;
+    mWorkerCount = 0;
+
+    pthread_mutex_init(&mLock, NULL);
+    pthread_cond_init(&mJobQueued, NULL);
+    pthread_cond_init(&mJobDone, NULL);
+
+    mSystemLayer = &systemLayer;
+
+    for (int i = 0; i < WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS; i++)
+    {
+        if (pthread_create(&mWorkers[i], NULL, WorkerMain, this) != 0)
+        {
+            Shutdown();
+            ExitNow(err = WEAVE_ERROR_NO_MEMORY);
+        }
+        mWorkerCount++;
+    }
+
+exit:
+    return err;
+}
+
+/**
+ * Stop the worker threads.
+ *
+ * Jobs that have not started are dropped without being completed.  Jobs that are running
+ * are allowed to finish, but are not completed either.
+ */
+WEAVE_ERROR CryptoWorkerPool::Shutdown(void)
+{
+    VerifyOrExit(mSystemLayer != NULL, );
+
+    pthread_mutex_lock(&mLock);
+    mStopping = true;
+    pthread_cond_broadcast(&mJobQueued);
+    pthread_cond_broadcast(&mJobDone);
+    pthread_mutex_unlock(&mLock);
+
+    for (uint8_t i = 0; i < mWorkerCount; i++)
+        pthread_join(mWorkers[i], NULL);
+    mWorkerCount = 0;
+
+    mSystemLayer->CancelTimer(HandleJobsDone, this);
+    mSystemLayer = NULL;
+
+    pthread_cond_destroy(&mJobDone);
+    pthread_cond_destroy(&mJobQueued);
+    pthread_mutex_destroy(&mLock);
+
+exit:
+    return WEAVE_NO_ERROR;
+}
+
+/**
+ * Queue a job to be run on a worker thread.
+ *
+ * The job object must remain valid until its OnComplete function has been called, or until
+ * it has been passed to Cancel().
+ */
+WEAVE_ERROR CryptoWorkerPool::Submit(CryptoJob *job)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    VerifyOrExit(mSystemLayer != NULL, err = WEAVE_ERROR_INCORRECT_STATE);
+    VerifyOrExit(job->Run != NULL && job->OnComplete != NULL, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    job->Result = WEAVE_NO_ERROR;
+
+    pthread_mutex_lock(&mLock);
+    job->mState = kJobState_Queued;
+    AppendJob(mQueueHead, mQueueTail, job);
+    pthread_cond_signal(&mJobQueued);
+    pthread_mutex_unlock(&mLock);
+
+exit:
+    return err;
+}
+
+/**
+ * Withdraw a submitted job, such that its OnComplete function will not be called.
+ *
+ * If a worker thread is running the job, this call blocks until the job's Run function
+ * returns.  On return, the pool holds no reference to the job.
+ */
+void CryptoWorkerPool::Cancel(CryptoJob *job)
+{
+    VerifyOrExit(mSystemLayer != NULL, );
+
+    pthread_mutex_lock(&mLock);
+
+    // Have the worker drop a running job rather than hand it back, and wait for it to do so.
+    if (job->mState == kJobState_Running)
+        job->mState = kJobState_Canceled;
+    while (job->mState == kJobState_Canceled)
+        pthread_cond_wait(&mJobDone, &mLock);
+
+    if (job->mState == kJobState_Queued)
+        RemoveJob(mQueueHead, mQueueTail, job);
+    else if (job->mState == kJobState_Done)
+        RemoveJob(mDoneHead, mDoneTail, job);
+
+    job->mState = kJobState_Idle;
+
+    pthread_mutex_unlock(&mLock);
+
+exit:
+    return;
+}
+
+void *CryptoWorkerPool::WorkerMain(void *arg)
+{
+    CryptoWorkerPool *pool = static_cast<CryptoWorkerPool *>(arg);
+
+    pthread_mutex_lock(&pool->mLock);
+
+    while (true)
+    {
+        CryptoJob *job;
+        WEAVE_ERROR result;
+        bool scheduleCompletion = false;
+
+        while (!pool->mStopping && pool->mQueueHead == NULL)
+            pthread_cond_wait(&pool->mJobQueued, &pool->mLock);
+
+        if (pool->mStopping)
+            break;
+
+        job = pool->mQueueHead;
+        RemoveJob(pool->mQueueHead, pool->mQueueTail, job);
+        job->mState = kJobState_Running;
+
+        pthread_mutex_unlock(&pool->mLock);
+
+        result = job->Run(job);
+
+        pthread_mutex_lock(&pool->mLock);
+
+        if (job->mState == kJobState_Canceled)
+        {
+            job->mState = kJobState_Idle;
+        }
+        else
+        {
+            job->Result = result;
+            job->mState = kJobState_Done;
+            AppendJob(pool->mDoneHead, pool->mDoneTail, job);
+
+            if (!pool->mCompletionScheduled && !pool->mStopping)
+            {
+                pool->mCompletionScheduled = true;
+                scheduleCompletion = true;
+            }
+        }
+
+        pthread_cond_broadcast(&pool->mJobDone);
+
+        if (scheduleCompletion)
+            ScheduleCompletion(pool);
+    }
+
+    pthread_mutex_unlock(&pool->mLock);
+
+    return NULL;
+}
+
+/**
+ * Arrange for HandleJobsDone() to run on the Weave thread.
+ *
+ * Called, and returns, with the pool lock held.  ScheduleWork() only fails when the system
+ * layer has no free timers, in which case the finished jobs would otherwise never be handed
+ * back; so keep retrying, backing off between attempts, until it succeeds or the pool stops.
+ * Other workers leave the done list to this one while mCompletionScheduled is set.
+ */
+void CryptoWorkerPool::ScheduleCompletion(CryptoWorkerPool *pool)
+{
+    uint32_t retryDelayMs = kScheduleRetryMinDelayMs;
+
+    while (true)
+    {
+        System::Error err;
+        struct timespec deadline;
+
+        pthread_mutex_unlock(&pool->mLock);
+
+        // ScheduleWork() may be called from any thread.
+        err = pool->mSystemLayer->ScheduleWork(HandleJobsDone, pool);
+
+        pthread_mutex_lock(&pool->mLock);
+
+        if (err == WEAVE_SYSTEM_NO_ERROR)
+            break;
+
+        if (pool->mStopping)
+        {
+            pool->mCompletionScheduled = false;
+            break;
+        }
+
+        if (retryDelayMs == kScheduleRetryMinDelayMs)
+            WeaveLogError(SecurityManager, "Failed to schedule crypto job completion: %s; retrying", ErrorStr(err));
+
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += retryDelayMs / 1000;
+        deadline.tv_nsec += (retryDelayMs % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        // Shutdown() broadcasts mJobDone, which cuts the wait short.
+        pthread_cond_timedwait(&pool->mJobDone, &pool->mLock, &deadline);
+
+        if (retryDelayMs < kScheduleRetryMaxDelayMs)
+            retryDelayMs = (retryDelayMs * 2 < kScheduleRetryMaxDelayMs) ? retryDelayMs * 2 : kScheduleRetryMaxDelayMs;
+    }
+}
+
+void CryptoWorkerPool::HandleJobsDone(System::Layer *systemLayer, void *appState, System::Error err)
+{
+    CryptoWorkerPool *pool = static_cast<CryptoWorkerPool *>(appState);
+
+    pthread_mutex_lock(&pool->mLock);
+    pool->mCompletionScheduled = false;
+
+    // Complete the jobs one at a time, so that a completion function can cancel other
+    // finished jobs before they are handed back.
+    while (pool->mDoneHead != NULL)
+    {
+        CryptoJob *job = pool->mDoneHead;
+
+        RemoveJob(pool->mDoneHead, pool->mDoneTail, job);
+        job->mState = kJobState_Idle;
+
+        pthread_mutex_unlock(&pool->mLock);
+        job->OnComplete(job);
+        pthread_mutex_lock(&pool->mLock);
+    }
+
+    pthread_mutex_unlock(&pool->mLock);
+}
+
+void CryptoWorkerPool::AppendJob(CryptoJob *&head, CryptoJob *&tail, CryptoJob *job)
+{
+    job->mNext = NULL;
+    if (tail != NULL)
+        tail->mNext = job;
+    else
+        head = job;
+    tail = job;
+}
+
+bool CryptoWorkerPool::RemoveJob(CryptoJob *&head, CryptoJob *&tail, CryptoJob *job)
+{
+    CryptoJob *prev = NULL;
+
+    for (CryptoJob *cur = head; cur != NULL; prev = cur, cur = cur->mNext)
+    {
+        if (cur == job)
+        {
+            if (prev != NULL)
+                prev->mNext = cur->mNext;
+            else
+                head = cur->mNext;
+            if (tail == cur)
+                tail = prev;
+            cur->mNext = NULL;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace Weave
+} // namespace nl
+
+#endif // WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
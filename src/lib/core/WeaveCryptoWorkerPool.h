@@ -0,0 +1,136 @@
+/*
+ *
+ *    Copyright (c) 2019 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file defines a pool of worker threads that run time-consuming
+ *      cryptographic operations off the Weave thread.
+ *
+ */
+
+#ifndef WEAVE_CRYPTO_WORKER_POOL_H_
+#define WEAVE_CRYPTO_WORKER_POOL_H_
+
+#include <Weave/Core/WeaveConfig.h>
+#include <Weave/Core/WeaveError.h>
+#include <SystemLayer/SystemLayer.h>
+
+#if WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
+
+#if !WEAVE_SYSTEM_CONFIG_POSIX_LOCKING
+#error "WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS requires WEAVE_SYSTEM_CONFIG_POSIX_LOCKING"
+#endif
+
+#include <pthread.h>
+
+namespace nl {
+namespace Weave {
+
+class CryptoWorkerPool;
+
+/**
+ *  @class CryptoJob
+ *
+ *  @brief
+ *    A unit of work submitted to a CryptoWorkerPool.
+ *
+ *  The Run function is called on a worker thread and must only touch state that is owned
+ *  by the job.  Its result is stored in Result, and the OnComplete function is then called
+ *  on the Weave thread.
+ */
+class CryptoJob
+{
+public:
+    typedef WEAVE_ERROR (*RunFunct)(CryptoJob *job);
+    typedef void (*CompleteFunct)(CryptoJob *job);
+
+    RunFunct Run;                               /**< Called on a worker thread to perform the operation. */
+    CompleteFunct OnComplete;                   /**< Called on the Weave thread once the operation is done. */
+    void *AppState;                             /**< Application-specific state for the job. */
+    WEAVE_ERROR Result;                         /**< The value returned by Run. */
+
+private:
+    friend class CryptoWorkerPool;
+
+    CryptoJob *mNext;
+    uint8_t mState;
+};
+
+/**
+ *  @class CryptoWorkerPool
+ *
+ *  @brief
+ *    A fixed set of worker threads that run CryptoJob objects in the order they were
+ *    submitted and hand them back to the Weave thread when they are done.
+ */
+class CryptoWorkerPool
+{
+public:
+    CryptoWorkerPool(void);
+
+    WEAVE_ERROR Init(System::Layer &systemLayer);
+    WEAVE_ERROR Shutdown(void);
+
+    bool IsRunning(void) const { return mSystemLayer != NULL; }
+
+    WEAVE_ERROR Submit(CryptoJob *job);
+    void Cancel(CryptoJob *job);
+
+private:
+    enum
+    {
+        kJobState_Idle                          = 0,
+        kJobState_Queued                        = 1,
+        kJobState_Running                       = 2,
+        kJobState_Done                          = 3,
+        kJobState_Canceled                      = 4,
+    };
+
+    enum
+    {
+        kScheduleRetryMinDelayMs                = 10,
+        kScheduleRetryMaxDelayMs                = 1000,
+    };
+
+    System::Layer *mSystemLayer;
+    pthread_t mWorkers[WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS];
+    pthread_mutex_t mLock;
+    pthread_cond_t mJobQueued;
+    pthread_cond_t mJobDone;
+    CryptoJob *mQueueHead;
+    CryptoJob *mQueueTail;
+    CryptoJob *mDoneHead;
+    CryptoJob *mDoneTail;
+    uint8_t mWorkerCount;
+    bool mCompletionScheduled;
+    bool mStopping;
+
+    static void *WorkerMain(void *arg);
+    static void ScheduleCompletion(CryptoWorkerPool *pool);
+    static void HandleJobsDone(System::Layer *systemLayer, void *appState, System::Error err);
+
+    static void AppendJob(CryptoJob *&head, CryptoJob *&tail, CryptoJob *job);
+    static bool RemoveJob(CryptoJob *&head, CryptoJob *&tail, CryptoJob *job);
+};
+
+} // namespace Weave
+} // namespace nl
+
+#endif // WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
+
+#endif // WEAVE_CRYPTO_WORKER_POOL_H_
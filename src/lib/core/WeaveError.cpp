@@ -232,6 +232,7 @@ bool FormatWeaveError(char * buf, uint16_t bufSize, int32_t err)
     case WEAVE_ERROR_SESSION_KEY_SUSPENDED                      : desc = "Session key suspended"; break;
     case WEAVE_ERROR_UNSUPPORTED_WIRELESS_REGULATORY_DOMAIN     : desc = "Unsupported wireless regulatory domain"; break;
     case WEAVE_ERROR_UNSUPPORTED_WIRELESS_OPERATING_LOCATION    : desc = "Unsupported wireless operating location"; break;
+    case WEAVE_ERROR_WRMP_SEND_WINDOW_FULL                      : desc = "WRMP send window is full on this Exchange"; break;
     }
 #endif // !WEAVE_CONFIG_SHORT_ERROR_STR
 
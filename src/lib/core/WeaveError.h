@@ -1757,6 +1757,16 @@ typedef WEAVE_CONFIG_ERROR_TYPE WEAVE_ERROR;
  */
 #define WEAVE_ERROR_UNSUPPORTED_WIRELESS_OPERATING_LOCATION      _WEAVE_ERROR(185)
 
+/**
+ *  @def WEAVE_ERROR_WRMP_SEND_WINDOW_FULL
+ *
+ *  @brief
+ *    The WRMP send window of the exchange is full; no further reliable
+ *    message can be sent until an outstanding one is acknowledged.
+ *
+ */
+#define WEAVE_ERROR_WRMP_SEND_WINDOW_FULL                        _WEAVE_ERROR(186)
+
 
 /**
  *  @}
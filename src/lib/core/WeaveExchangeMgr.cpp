@@ -49,6 +49,16 @@ namespace Weave {
 using namespace nl::Weave::Profiles;
 using namespace nl::Weave::Encoding;
 
+// Hash a profile id and message type (-1 for any message type) into an unsolicited message handler hash bucket.
+static inline uint32_t UMHHash(uint32_t profileId, int16_t msgType)
+{
+    uint32_t hash = (profileId * 0x9E3779B1UL) ^ static_cast<uint16_t>(msgType);
+
+    hash *= 0x9E3779B1UL;
+
+    return (hash ^ (hash >> 16)) & (WEAVE_CONFIG_UNSOLICITED_MESSAGE_HANDLER_HASH_SIZE - 1);
+}
+
 /**
  *  Constructor for the WeaveExchangeManager class.
  *  It sets the state to kState_NotInitialized.
@@ -92,6 +102,10 @@ WEAVE_ERROR WeaveExchangeManager::Init(WeaveMessageLayer *msgLayer)
     InitBindingPool();
 
     memset(UMHandlerPool, 0, sizeof(UMHandlerPool));
+    memset(UMHandlerHash, 0xFF, sizeof(UMHandlerHash));
+    for (int i = 0; i < WEAVE_CONFIG_MAX_UNSOLICITED_MESSAGE_HANDLERS; i++)
+        UMHandlerPool[i].HashNext = (i + 1 < WEAVE_CONFIG_MAX_UNSOLICITED_MESSAGE_HANDLERS) ? i + 1 : kUMHIndexNone;
+    UMHandlerFreeHead = 0;
     OnExchangeContextChanged = NULL;
 
     msgLayer->ExchangeMgr = this;
@@ -102,8 +116,32 @@ WEAVE_ERROR WeaveExchangeManager::Init(WeaveMessageLayer *msgLayer)
     mWRMPTimerInterval  = WEAVE_CONFIG_WRMP_TIMER_DEFAULT_PERIOD;       //WRMP Timer tick period
 
     memset(RetransTable, 0, sizeof(RetransTable));
+    memset(mWRMPRetransWheel, 0, sizeof(mWRMPRetransWheel));
+
+    // Chain all retransmission table entries into the free list.
+    mWRMPRetransFreeList = NULL;
+    for (int i = WEAVE_CONFIG_WRMP_RETRANS_TABLE_SIZE - 1; i >= 0; i--)
+    {
+        RetransTable[i].wheelNext = mWRMPRetransFreeList;
+        mWRMPRetransFreeList = &RetransTable[i];
+    }
+
+    mWRMPAckHead = NULL;
+    mWRMPAckTail = NULL;
+
+    for (int i = 0; i < WEAVE_CONFIG_WRMP_REORDER_POOL_SIZE; i++)
+    {
+        mWRMPReorderPool[i].exchContext = NULL;
+        mWRMPReorderPool[i].msgBuf = NULL;
+    }
+
+#if WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE > 0
+    memset(mWRMPPeerRTT, 0, sizeof(mWRMPPeerRTT));
+#endif
 
     mWRMPTimeStampBase = System::Timer::GetCurrentEpoch();
+    mWRMPCurrentTick = 0;
+    mWRMPWheelTick = 0;
 
     mWRMPCurrentTimerExpiry = 0;
 #endif
@@ -144,6 +182,9 @@ WEAVE_ERROR WeaveExchangeManager::Shutdown()
         {
             ClearRetransmitTable(RetransTable[i]);
         }
+
+        //Drop any messages held for in-order delivery
+        WRMPFreeHeldMessages(NULL);
 #endif
         MessageLayer = NULL;
     }
@@ -515,7 +556,7 @@ void WeaveExchangeManager::HandleConnectionClosed(WeaveConnection *con, WEAVE_ER
         if (umh->Handler != NULL && umh->Con == con)
         {
             SYSTEM_STATS_DECREMENT(nl::Weave::System::Stats::kExchangeMgr_NumUMHandlers);
-            umh->Handler = NULL;
+            FreeUMH(umh);
         }
 }
 
@@ -590,7 +631,7 @@ void WeaveExchangeManager::WRMPProcessDDMessage(uint32_t PauseTimeMillis, uint64
             {
 
                 //Paustime is specified in milliseconds; Update retrans values
-                RetransTable[i].nextRetransTime += (PauseTimeMillis / mWRMPTimerInterval);
+                WRMPScheduleRetrans(&RetransTable[i], RetransTable[i].nextRetransTime + (PauseTimeMillis / mWRMPTimerInterval));
 
                 //Call the application callback
                 if (RetransTable[i].exchContext->OnDDRcvd)
@@ -627,7 +668,6 @@ static void DefaultOnMessageReceived(ExchangeContext *ec, const IPPacketInfo *pk
 void WeaveExchangeManager::DispatchMessage(WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf)
 {
     WeaveExchangeHeader exchangeHeader;
-    UnsolicitedMessageHandler *umh         = NULL;
     UnsolicitedMessageHandler *matchingUMH = NULL;
     ExchangeContext *ec                    = NULL;
     WeaveConnection *msgCon                = NULL;
@@ -705,6 +745,15 @@ void WeaveExchangeManager::DispatchMessage(WeaveMessageInfo *msgInfo, PacketBuff
 #endif // WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC
 
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+    //Received Ack List Message: acknowledge the messages of the listed exchanges. The ack in the
+    //exchange header is processed by the matching exchange below.
+    if (msgInfo->MessageVersion == kWeaveMessageVersion_V2 &&
+        exchangeHeader.ProfileId == nl::Weave::Profiles::kWeaveProfile_Common &&
+        exchangeHeader.MessageType == nl::Weave::Profiles::Common::kMsgType_WRMP_Ack_List)
+    {
+        WRMPProcessAckList(msgInfo, msgBuf);
+    }
+
     //Received Delayed Delivery Message: Extend time for pending retrans objects
     if (exchangeHeader.ProfileId == nl::Weave::Profiles::kWeaveProfile_Common &&
         exchangeHeader.MessageType == nl::Weave::Profiles::Common::kMsgType_WRMP_Delayed_Delivery)
@@ -750,6 +799,18 @@ void WeaveExchangeManager::DispatchMessage(WeaveMessageInfo *msgInfo, PacketBuff
     }
 
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+    // Only the first sequenced message of an exchange opens it. A later one overtook the first,
+    // which was lost or delayed; it is dropped without an ack, so that the peer retransmits it
+    // once the first has opened the exchange. Its retransmission is then delivered in order even
+    // though the message layer marks it as a duplicate (see ExchangeContext::HandleMessage()).
+    // The same applies to a retransmission for an exchange that was closed here after the message
+    // was delivered and its ack was lost: the peer then reports a failure after its retransmissions,
+    // rather than a message that was never delivered being acknowledged.
+    if ((exchangeHeader.Flags & kWeaveExchangeFlag_SequenceNum) && exchangeHeader.SequenceNum != 0)
+    {
+        ExitNow(err = WEAVE_NO_ERROR);
+    }
+
     // Is message a duplicate that needs ack.
     msgNeedsAck = exchangeHeader.Flags & kWeaveExchangeFlag_NeedsAck;
     dupMsg = (msgInfo->Flags & kWeaveMessageFlag_DuplicateMessage);
@@ -760,25 +821,9 @@ void WeaveExchangeManager::DispatchMessage(WeaveMessageInfo *msgInfo, PacketBuff
     // unsolicited messages must be marked as being from an initiator.
     if (exchangeHeader.Flags & kWeaveExchangeFlag_Initiator)
     {
-        // Search for an unsolicited message handler that can handle the message. Prefer handlers that can explicitly
-        // handle the message type over handlers that handle all messages for a profile.
-        umh = (UnsolicitedMessageHandler *) UMHandlerPool;
-
-        matchingUMH = NULL;
-
-        for (int i = 0; i < WEAVE_CONFIG_MAX_UNSOLICITED_MESSAGE_HANDLERS; i++, umh++)
-            if (umh->Handler != NULL && umh->ProfileId == exchangeHeader.ProfileId && (umh->Con == NULL || umh->Con == msgCon)
-                && (!(msgInfo->Flags & kWeaveMessageFlag_DuplicateMessage) || umh->AllowDuplicateMsgs))
-            {
-                if (umh->MessageType == exchangeHeader.MessageType)
-                {
-                    matchingUMH = umh;
-                    break;
-                }
-
-                if (umh->MessageType == -1)
-                    matchingUMH = umh;
-            }
+        // Search for an unsolicited message handler that can handle the message.
+        matchingUMH = FindUMH(exchangeHeader.ProfileId, exchangeHeader.MessageType, msgCon,
+                              (msgInfo->Flags & kWeaveMessageFlag_DuplicateMessage) != 0);
     }
     // Discard the message if it isn't marked as being sent by an initiator and the message is not a duplicate
     // that needs to send ack to the peer.
@@ -898,6 +943,13 @@ void WeaveExchangeManager::DispatchMessage(WeaveMessageInfo *msgInfo, PacketBuff
         // Arrange to automatically release the encryption key when the exchange is freed.
         ec->SetAutoReleaseKey(true);
 
+#if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+        // An exchange created only to send an ack does not deliver the message, so its
+        // sequence number, if any, does not apply.
+        if (sendAckAndCloseExchange)
+            exchangeHeader.Flags &= ~kWeaveExchangeFlag_SequenceNum;
+#endif
+
         ec->HandleMessage(msgInfo, &exchangeHeader, msgBuf, umhandler);
         msgBuf = NULL;
 
@@ -925,16 +977,16 @@ exit:
 WEAVE_ERROR WeaveExchangeManager::RegisterUMH(uint32_t profileId, int16_t msgType, WeaveConnection *con, bool allowDups,
         ExchangeContext::MessageReceiveFunct handler, void *appState)
 {
-    UnsolicitedMessageHandler *umh = (UnsolicitedMessageHandler *) UMHandlerPool;
-    UnsolicitedMessageHandler *selected = NULL;
-    for (int i = 0; i < WEAVE_CONFIG_MAX_UNSOLICITED_MESSAGE_HANDLERS; i++, umh++)
+    UMHIndexType *link = &UMHandlerHash[UMHHash(profileId, msgType)];
+    UMHIndexType index;
+    UnsolicitedMessageHandler *selected;
+
+    // Replace the handler of an existing registration, if any.
+    for (index = *link; index != kUMHIndexNone; index = UMHandlerPool[index].HashNext)
     {
-        if (umh->Handler == NULL)
-        {
-            if (selected == NULL)
-                selected = umh;
-        }
-        else if (umh->ProfileId == profileId && umh->MessageType == msgType && umh->Con == con)
+        UnsolicitedMessageHandler *umh = &UMHandlerPool[index];
+
+        if (umh->ProfileId == profileId && umh->MessageType == msgType && umh->Con == con)
         {
             umh->Handler = handler;
             umh->AppState = appState;
@@ -942,9 +994,13 @@ WEAVE_ERROR WeaveExchangeManager::RegisterUMH(uint32_t profileId, int16_t msgTyp
         }
     }
 
-    if (selected == NULL)
+    if (UMHandlerFreeHead == kUMHIndexNone)
         return WEAVE_ERROR_TOO_MANY_UNSOLICITED_MESSAGE_HANDLERS;
 
+    index = UMHandlerFreeHead;
+    selected = &UMHandlerPool[index];
+    UMHandlerFreeHead = selected->HashNext;
+
     selected->Handler = handler;
     selected->AppState = appState;
     selected->ProfileId = profileId;
@@ -952,6 +1008,16 @@ WEAVE_ERROR WeaveExchangeManager::RegisterUMH(uint32_t profileId, int16_t msgTyp
     selected->MessageType = msgType;
     selected->AllowDuplicateMsgs = allowDups;
 
+    // Keep connection-specific handlers ahead of handlers for any connection, so that lookups find the
+    // most specific handler first.  Handlers for any connection stay in registration order.
+    if (con == NULL)
+    {
+        while (*link != kUMHIndexNone)
+            link = &UMHandlerPool[*link].HashNext;
+    }
+    selected->HashNext = *link;
+    *link = index;
+
     SYSTEM_STATS_INCREMENT(nl::Weave::System::Stats::kExchangeMgr_NumUMHandlers);
 
     return WEAVE_NO_ERROR;
@@ -959,12 +1025,15 @@ WEAVE_ERROR WeaveExchangeManager::RegisterUMH(uint32_t profileId, int16_t msgTyp
 
 WEAVE_ERROR WeaveExchangeManager::UnregisterUMH(uint32_t profileId, int16_t msgType, WeaveConnection *con)
 {
-    UnsolicitedMessageHandler *umh = (UnsolicitedMessageHandler *) UMHandlerPool;
-    for (int i = 0; i < WEAVE_CONFIG_MAX_UNSOLICITED_MESSAGE_HANDLERS; i++, umh++)
+    UMHIndexType index;
+
+    for (index = UMHandlerHash[UMHHash(profileId, msgType)]; index != kUMHIndexNone; index = UMHandlerPool[index].HashNext)
     {
-        if (umh->Handler != NULL && umh->ProfileId == profileId && umh->MessageType == msgType && umh->Con == con)
+        UnsolicitedMessageHandler *umh = &UMHandlerPool[index];
+
+        if (umh->ProfileId == profileId && umh->MessageType == msgType && umh->Con == con)
         {
-            umh->Handler = NULL;
+            FreeUMH(umh);
             SYSTEM_STATS_DECREMENT(nl::Weave::System::Stats::kExchangeMgr_NumUMHandlers);
             return WEAVE_NO_ERROR;
         }
@@ -972,6 +1041,56 @@ WEAVE_ERROR WeaveExchangeManager::UnregisterUMH(uint32_t profileId, int16_t msgT
     return WEAVE_ERROR_NO_UNSOLICITED_MESSAGE_HANDLER;
 }
 
+/**
+ *  Find the unsolicited message handler for a message.
+ *
+ *  Handlers registered for the message type are preferred over handlers for all messages of the
+ *  profile and, at each level, handlers registered for the connection over which the message
+ *  arrived are preferred over handlers for any connection.
+ */
+WeaveExchangeManager::UnsolicitedMessageHandler *WeaveExchangeManager::FindUMH(uint32_t profileId, uint8_t msgType,
+        WeaveConnection *msgCon, bool isDup)
+{
+    const int16_t keys[] = { static_cast<int16_t>(msgType), -1 };
+
+    for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++)
+    {
+        UMHIndexType index;
+
+        for (index = UMHandlerHash[UMHHash(profileId, keys[k])]; index != kUMHIndexNone; index = UMHandlerPool[index].HashNext)
+        {
+            UnsolicitedMessageHandler *umh = &UMHandlerPool[index];
+
+            if (umh->ProfileId == profileId && umh->MessageType == keys[k] && (umh->Con == NULL || umh->Con == msgCon) &&
+                (!isDup || umh->AllowDuplicateMsgs))
+            {
+                return umh;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ *  Remove an unsolicited message handler from its hash chain and return it to the free list.
+ */
+void WeaveExchangeManager::FreeUMH(UnsolicitedMessageHandler *umh)
+{
+    UMHIndexType index = static_cast<UMHIndexType>(umh - UMHandlerPool);
+    UMHIndexType *link = &UMHandlerHash[UMHHash(umh->ProfileId, umh->MessageType)];
+
+    while (*link != kUMHIndexNone && *link != index)
+        link = &UMHandlerPool[*link].HashNext;
+
+    if (*link == index)
+        *link = umh->HashNext;
+
+    umh->Handler = NULL;
+    umh->HashNext = UMHandlerFreeHead;
+    UMHandlerFreeHead = index;
+}
+
 void WeaveExchangeManager::HandleMessageReceived(WeaveMessageLayer *msgLayer, WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf)
 {
     msgLayer->ExchangeMgr->DispatchMessage(msgInfo, msgBuf);
@@ -988,10 +1107,6 @@ WEAVE_ERROR WeaveExchangeManager::PrependHeader(WeaveExchangeHeader *exchangeHea
     uint16_t headLen = 8; //Constant part: Version/Flags + Msg Type + Exch Id + Profile Id
     uint8_t *p = NULL;
 
-    // Make sure the buffer has a reserved size big enough to hold the full Weave header.
-    if (!buf->EnsureReservedSize(WEAVE_HEADER_RESERVE_SIZE))
-        ExitNow(err = WEAVE_ERROR_BUFFER_TOO_SMALL);
-
     // Verify the right application version is selected.
     if (exchangeHeader->Version != kWeaveExchangeVersion_V1)
         ExitNow(err = WEAVE_ERROR_UNSUPPORTED_EXCHANGE_VERSION);
@@ -1002,8 +1117,18 @@ WEAVE_ERROR WeaveExchangeManager::PrependHeader(WeaveExchangeHeader *exchangeHea
     {
         headLen += 4;
     }
+    if (exchangeHeader->Flags & kWeaveExchangeFlag_SequenceNum)
+    {
+        headLen += 2;
+    }
 #endif
 
+    // Make sure the buffer has enough room before the payload to hold the exchange header.  Space for the
+    // message header is ensured by the message layer, so a buffer reserved for the predicted headers is
+    // never moved here.
+    if (!buf->EnsureReservedSize(headLen))
+        ExitNow(err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
     p = buf->Start();
 
     //Move the buffer start pointer back by the size of the app header.
@@ -1023,6 +1148,10 @@ WEAVE_ERROR WeaveExchangeManager::PrependHeader(WeaveExchangeHeader *exchangeHea
     {
         LittleEndian::Write32(p, exchangeHeader->AckMsgId);
     }
+    if (exchangeHeader->Flags & kWeaveExchangeFlag_SequenceNum)
+    {
+        LittleEndian::Write16(p, exchangeHeader->SequenceNum);
+    }
 #endif
 
     WEAVE_FAULT_INJECT_MAX_ARG(FaultInjection::kFault_FuzzExchangeHeaderTx,
@@ -1085,6 +1214,12 @@ WEAVE_ERROR WeaveExchangeManager::DecodeHeader(WeaveExchangeHeader *exchangeHead
             ExitNow(err = WEAVE_ERROR_INVALID_MESSAGE_LENGTH);
         exchangeHeader->AckMsgId = LittleEndian::Read32(p);
     }
+    if ((exchangeHeader->Flags & kWeaveExchangeFlag_SequenceNum))
+    {
+        if ((p + 2) > msgEnd)
+            ExitNow(err = WEAVE_ERROR_INVALID_MESSAGE_LENGTH);
+        exchangeHeader->SequenceNum = LittleEndian::Read16(p);
+    }
 #endif
 
     buf->SetStart(p);
@@ -1155,13 +1290,16 @@ void WeaveExchangeManager::NotifyKeyFailed(uint64_t peerNodeId, uint16_t keyId,
  */
 void WeaveExchangeManager::NotifySecurityManagerAvailable()
 {
+    size_t start = mNextSecMgrAvailableBinding;
+
     // Notify each binding that the security manager is now available.
     //
-    // Note that this algorithm is unfair to bindings that are positioned later in the pool.
-    // In practice, however, this is unlikely to cause any problems.
-    for (int i = 0; i < WEAVE_CONFIG_MAX_BINDINGS; i++)
+    // Start with a different binding each time, so that bindings positioned later in the pool
+    // are not always beaten to the available session establishment slots by earlier ones.
+    mNextSecMgrAvailableBinding = (start + 1) % WEAVE_CONFIG_MAX_BINDINGS;
+    for (size_t i = 0; i < WEAVE_CONFIG_MAX_BINDINGS; i++)
     {
-        BindingPool[i].OnSecurityManagerAvailable();
+        BindingPool[(start + i) % WEAVE_CONFIG_MAX_BINDINGS].OnSecurityManagerAvailable();
     }
 }
 
@@ -1255,7 +1393,7 @@ void WeaveExchangeManager::TicklessDebugDumpRetransTable(const char *log)
      {
          if (RetransTable[i].exchContext)
          {
-             WeaveLogProgress(ExchangeManager, "EC:%04" PRIX16 " MsgId:%08" PRIX32 " NextRetransTimeCtr:%04" PRIX16,
+             WeaveLogProgress(ExchangeManager, "EC:%04" PRIX16 " MsgId:%08" PRIX32 " NextRetransTick:%08" PRIX32,
                               RetransTable[i].exchContext,
                               RetransTable[i].msgId,
                               RetransTable[i].nextRetransTime);
@@ -1267,113 +1405,478 @@ void WeaveExchangeManager::TicklessDebugDumpRetransTable(const char *log) { retu
 #endif // WRMP_TICKLESS_DEBUG
 
 /**
-* Iterate through active exchange contexts and retrans table entries.
-* If an action needs to be triggered by WRMP time facilities, execute
-* that action.
+ * Return the WRMP tick at which a timeout of the given duration, started
+ * now, expires.
+ *
+ * @param[in]  delayMillis    The timeout duration in milliseconds.
+ *
+ * @return The absolute WRMP tick of the timeout expiry.
+ */
+uint32_t WeaveExchangeManager::WRMPTickFromNow(uint32_t delayMillis)
+{
+    return mWRMPCurrentTick + GetTickCounterFromTimeDelta(System::Timer::GetCurrentEpoch() + delayMillis, mWRMPTimeStampBase);
+}
+
+/**
+ * Determine whether a WRMP tick has been reached. The comparison is
+ * performed modulo 2^32 so that it remains correct when the tick counter
+ * wraps.
+ *
+ * @param[in]  tick           The WRMP tick to be checked.
+ * @param[in]  now            The current WRMP tick.
+ *
+ * @return true if @a tick is at or before @a now, false otherwise.
+ */
+bool WeaveExchangeManager::IsWRMPTickDue(uint32_t tick, uint32_t now)
+{
+    return static_cast<int32_t>(now - tick) >= 0;
+}
+
+/**
+ * (Re)schedule the retransmission of a retransmission table entry.
+ * The entry is moved to the timer wheel slot corresponding to the
+ * specified tick. Ticks that lie before the earliest unprocessed wheel
+ * slot are clamped to that slot, so the entry is handled on the next
+ * timer expiry.
+ *
+ * @param[in]  entry          A pointer to an active retransmission table entry.
+ * @param[in]  tick           The WRMP tick at which the entry is due.
+ */
+void WeaveExchangeManager::WRMPScheduleRetrans(RetransTableEntry *entry, uint32_t tick)
+{
+    RetransTableEntry **slot;
+
+    WRMPUnscheduleRetrans(entry);
+
+    if (!IsWRMPTickDue(mWRMPWheelTick, tick))
+    {
+        tick = mWRMPWheelTick;
+    }
+
+    entry->nextRetransTime = tick;
+
+    slot = &mWRMPRetransWheel[tick & (WEAVE_CONFIG_WRMP_RETRANS_WHEEL_SIZE - 1)];
+    entry->wheelPrev = NULL;
+    entry->wheelNext = *slot;
+    if (*slot != NULL)
+    {
+        (*slot)->wheelPrev = entry;
+    }
+    *slot = entry;
+}
+
+/**
+ * Remove a retransmission table entry from the timer wheel. Calling
+ * this for an entry that is not on the wheel has no effect.
+ *
+ * @param[in]  entry          A pointer to a retransmission table entry.
+ */
+void WeaveExchangeManager::WRMPUnscheduleRetrans(RetransTableEntry *entry)
+{
+    RetransTableEntry **slot = &mWRMPRetransWheel[entry->nextRetransTime & (WEAVE_CONFIG_WRMP_RETRANS_WHEEL_SIZE - 1)];
+
+    if (entry->wheelPrev != NULL)
+    {
+        entry->wheelPrev->wheelNext = entry->wheelNext;
+    }
+    else if (*slot == entry)
+    {
+        *slot = entry->wheelNext;
+    }
+    else
+    {
+        return;
+    }
+
+    if (entry->wheelNext != NULL)
+    {
+        entry->wheelNext->wheelPrev = entry->wheelPrev;
+    }
+
+    // Keep an in-progress wheel walk valid if it was about to visit this entry.
+    if (mWRMPRetransCursor == entry)
+    {
+        mWRMPRetransCursor = entry->wheelNext;
+    }
+
+    entry->wheelNext = NULL;
+    entry->wheelPrev = NULL;
+}
+
+/**
+ * Add an ExchangeContext to the list of contexts with a pending
+ * acknowledgment. The list is kept ordered by ack time; as contexts
+ * generally share the same piggyback timeout, insertion normally
+ * happens at the tail.
+ *
+ * @param[in]  ec             A pointer to the ExchangeContext object.
+ */
+void WeaveExchangeManager::WRMPAddPendingAck(ExchangeContext *ec)
+{
+    ExchangeContext *prev = mWRMPAckTail;
+
+    while (prev != NULL && !IsWRMPTickDue(prev->mWRMPNextAckTime, ec->mWRMPNextAckTime))
+    {
+        prev = prev->mWRMPAckPrev;
+    }
+
+    ec->mWRMPAckPrev = prev;
+    ec->mWRMPAckNext = (prev != NULL) ? prev->mWRMPAckNext : mWRMPAckHead;
+
+    if (ec->mWRMPAckNext != NULL)
+        ec->mWRMPAckNext->mWRMPAckPrev = ec;
+    else
+        mWRMPAckTail = ec;
+
+    if (prev != NULL)
+        prev->mWRMPAckNext = ec;
+    else
+        mWRMPAckHead = ec;
+}
+
+/**
+ * Remove an ExchangeContext from the list of contexts with a pending
+ * acknowledgment. Calling this for a context that is not on the list
+ * has no effect.
+ *
+ * @param[in]  ec             A pointer to the ExchangeContext object.
+ */
+void WeaveExchangeManager::WRMPRemovePendingAck(ExchangeContext *ec)
+{
+    if (ec->mWRMPAckPrev != NULL)
+        ec->mWRMPAckPrev->mWRMPAckNext = ec->mWRMPAckNext;
+    else if (mWRMPAckHead == ec)
+        mWRMPAckHead = ec->mWRMPAckNext;
+    else
+        return;
+
+    if (ec->mWRMPAckNext != NULL)
+        ec->mWRMPAckNext->mWRMPAckPrev = ec->mWRMPAckPrev;
+    else
+        mWRMPAckTail = ec->mWRMPAckPrev;
+
+    ec->mWRMPAckNext = NULL;
+    ec->mWRMPAckPrev = NULL;
+}
+
+/**
+ * The size of an entry in the payload of an Ack List message: the exchange
+ * identifier (2 bytes), the exchange header flags of the acknowledging side
+ * of the exchange (1 byte) and the acknowledged message identifier (4 bytes).
+ */
+enum
+{
+    kWRMPAckListEntrySize = 7
+};
+
+/**
+ * Determine whether the pending acks of one exchange may be carried in an Ack
+ * List message sent on another: both exchanges must be reliable messaging
+ * exchanges over UDP with the same peer, sent from the same port and protected
+ * by the same key.
+ *
+ * @param[in]  ec             A pointer to the ExchangeContext sending the Ack List message.
+ *
+ * @param[in]  other          A pointer to the ExchangeContext whose acks would be carried.
+ *
+ * @return  true if the acks can be coalesced, false otherwise.
+ */
+bool WeaveExchangeManager::WRMPCanCoalesceAcks(const ExchangeContext *ec, const ExchangeContext *other)
+{
+    return other != ec &&
+           ec->Con == NULL && other->Con == NULL &&
+           other->mMsgProtocolVersion == kWeaveMessageVersion_V2 &&
+           other->PeerNodeId == ec->PeerNodeId &&
+           other->PeerAddr == ec->PeerAddr &&
+           other->PeerPort == ec->PeerPort &&
+           other->PeerIntf == ec->PeerIntf &&
+           other->EncryptionType == ec->EncryptionType &&
+           other->KeyId == ec->KeyId &&
+           other->UseEphemeralUDPPort() == ec->UseEphemeralUDPPort();
+}
+
+/**
+ * Send the pending acks of an exchange whose ack timeout has expired.  The
+ * pending acks of other exchanges that can be coalesced with it (see
+ * WRMPCanCoalesceAcks()) are sent early, in the payload of the same Ack List
+ * message, so that a peer with many active exchanges receives one message
+ * rather than one solitary ack per exchange.  If no other exchange has acks
+ * pending for the peer, the acks are sent in a Common::Null or Selective Ack
+ * message.
+ *
+ * @param[in]  ec             A pointer to the ExchangeContext whose acks are due.
+ */
+void WeaveExchangeManager::WRMPSendAckList(ExchangeContext *ec)
+{
+    WEAVE_ERROR err           = WEAVE_NO_ERROR;
+    PacketBuffer *msgBuf      = NULL;
+    ExchangeContext *other    = NULL;
+    ExchangeContext *next     = NULL;
+    uint8_t *p                = NULL;
+    uint16_t numEntries       = 0;
+
+#if WEAVE_CONFIG_WRMP_MAX_ACK_LIST_ENTRIES > 0
+    for (other = mWRMPAckHead; other != NULL; other = other->mWRMPAckNext)
+    {
+        if (WRMPCanCoalesceAcks(ec, other))
+            break;
+    }
+#endif
+
+    if (other == NULL)
+    {
+        ec->WRMPSendAcks();
+        ExitNow();
+    }
+
+    msgBuf = PacketBuffer::NewWithAvailableSize(ec->GetHeaderReserveSize(ExchangeContext::kSendFlag_NoAutoRequestAck),
+                                                WEAVE_CONFIG_WRMP_MAX_ACK_LIST_ENTRIES * kWRMPAckListEntrySize);
+    if (msgBuf == NULL)
+    {
+        ec->WRMPSendAcks();
+        ExitNow();
+    }
+
+    p = msgBuf->Start();
+
+    // The newest ack of the exchange is carried in the exchange header; any older ones go in the list.
+    while (ec->mWRMPExtraAckCount > 0 && numEntries < WEAVE_CONFIG_WRMP_MAX_ACK_LIST_ENTRIES)
+    {
+        LittleEndian::Write16(p, ec->ExchangeId);
+        Write8(p, ec->IsInitiator() ? kWeaveExchangeFlag_Initiator : 0);
+        LittleEndian::Write32(p, ec->mWRMPExtraAckIds[--ec->mWRMPExtraAckCount]);
+        numEntries++;
+    }
+
+    for (other = mWRMPAckHead; other != NULL; other = next)
+    {
+        next = other->mWRMPAckNext;
+
+        // Only take the acks of an exchange if all of them fit.
+        if (!WRMPCanCoalesceAcks(ec, other) ||
+            numEntries + 1 + other->mWRMPExtraAckCount > WEAVE_CONFIG_WRMP_MAX_ACK_LIST_ENTRIES)
+            continue;
+
+        LittleEndian::Write16(p, other->ExchangeId);
+        Write8(p, other->IsInitiator() ? kWeaveExchangeFlag_Initiator : 0);
+        LittleEndian::Write32(p, other->mPendingPeerAckId);
+        numEntries++;
+
+        for (uint8_t i = 0; i < other->mWRMPExtraAckCount; i++)
+        {
+            LittleEndian::Write16(p, other->ExchangeId);
+            Write8(p, other->IsInitiator() ? kWeaveExchangeFlag_Initiator : 0);
+            LittleEndian::Write32(p, other->mWRMPExtraAckIds[i]);
+            numEntries++;
+        }
+
+        other->SetAckPending(false);
+    }
+
+    msgBuf->SetDataLength(numEntries * kWRMPAckListEntrySize);
+
+#if defined(DEBUG)
+    WeaveLogProgress(ExchangeManager, "Sending %d coalesced acks with MsgId:%08" PRIX32 " to Peer %016" PRIX64,
+                     numEntries, ec->mPendingPeerAckId, ec->PeerNodeId);
+#endif
+
+    err = ec->SendMessage(nl::Weave::Profiles::kWeaveProfile_Common, nl::Weave::Profiles::Common::kMsgType_WRMP_Ack_List,
+                          msgBuf, ExchangeContext::kSendFlag_NoAutoRequestAck);
+    msgBuf = NULL;
+
+    if (err != WEAVE_NO_ERROR && !WeaveMessageLayer::IsSendErrorNonCritical(err))
+    {
+        WeaveLogError(ExchangeManager, "Failed to send Ack List to Peer %016" PRIX64 ":%ld",
+                      ec->PeerNodeId, (long)err);
+    }
+
+exit:
+    ec->SetAckPending(false);
+}
+
+/**
+ * Process the payload of a received Ack List message, acknowledging each
+ * listed message on its exchange.  An ack is only accepted by an exchange with
+ * the sender that is protected by the same key as the Ack List message.
+ *
+ * Each listed message is looked up by its id in the retransmission table,
+ * since only messages awaiting an ack can be acknowledged, so the cost is
+ * proportional to the number of entries times the retransmission table size.
+ *
+ * @param[in]  msgInfo        General Weave message information for the Ack List message.
+ *
+ * @param[in]  msgBuf         A pointer to the PacketBuffer holding the message payload.
+ */
+void WeaveExchangeManager::WRMPProcessAckList(const WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf)
+{
+    WeaveExchangeHeader entryHeader;
+    const uint8_t *p          = msgBuf->Start();
+    uint16_t len              = msgBuf->DataLength();
+    uint32_t ackMsgId         = 0;
+    ExchangeContext *ec       = NULL;
+
+    memset(&entryHeader, 0, sizeof(entryHeader));
+
+    for (; len >= kWRMPAckListEntrySize; len -= kWRMPAckListEntrySize)
+    {
+        entryHeader.ExchangeId = LittleEndian::Read16(p);
+        entryHeader.Flags = Read8(p);
+        ackMsgId = LittleEndian::Read32(p);
+
+        for (int i = 0; i < WEAVE_CONFIG_WRMP_RETRANS_TABLE_SIZE; i++)
+        {
+            ec = RetransTable[i].exchContext;
+
+            if (ec != NULL && RetransTable[i].msgId == ackMsgId &&
+                ec->MatchExchange(msgInfo->InCon, msgInfo, &entryHeader) &&
+                ec->EncryptionType == msgInfo->EncryptionType && ec->KeyId == msgInfo->KeyId)
+            {
+                ec->WRMPHandleRcvdAck(ackMsgId);
+                break;
+            }
+        }
+    }
+}
+
+/**
+* Execute the actions that are due on the current WRMP tick: send
+* solitary acks whose piggyback timeout has expired, and retransmit /
+* cancel retransmission table entries whose retrans timeout has expired.
+* Only the head of the pending ack list and the timer wheel slots for
+* the ticks elapsed since the last call are visited.
 *
 */
 void WeaveExchangeManager::WRMPExecuteActions(void)
 {
     ExchangeContext *ec               = NULL;
-
-    //Process Ack Tables for all ExchangeContexts
-    ec = (ExchangeContext *)ContextPool;
+    uint32_t tick                     = mWRMPWheelTick;
+    uint32_t lastTick                 = mWRMPCurrentTick;
 
 #if defined(WRMP_TICKLESS_DEBUG)
     WeaveLogProgress(ExchangeManager, "WRMPExecuteActions");
 #endif
 
-    for (int i = 0; i < WEAVE_CONFIG_MAX_EXCHANGE_CONTEXTS; i++, ec++)
+    //Process the pending acks that are due; the list is ordered by ack time
+    while (mWRMPAckHead != NULL && IsWRMPTickDue(mWRMPAckHead->mWRMPNextAckTime, lastTick))
     {
-        if (ec->ExchangeMgr != NULL && ec->IsAckPending())
-        {
-            if (0 == ec->mWRMPNextAckTime)
-            {
+        ec = mWRMPAckHead;
 #if defined(WRMP_TICKLESS_DEBUG)
-                WeaveLogProgress(ExchangeManager, "WRMPExecuteActions sending ACK");
+        WeaveLogProgress(ExchangeManager, "WRMPExecuteActions sending ACK");
 #endif
-                //Send the Ack in a Common::Null message
-                ec->SendCommonNullMessage();
-                ec->SetAckPending(false);
-            }
-        }
+        //Send the pending Acks, together with those of other exchanges with the same peer
+        WRMPSendAckList(ec);
     }
 
     TicklessDebugDumpRetransTable("WRMPExecuteActions Dumping RetransTable entries before processing");
 
-    // Retransmit / cancel anything in the retrans table whose retrans timeout
-    // has expired
-    for (int i = 0; i < WEAVE_CONFIG_WRMP_RETRANS_TABLE_SIZE; i++)
+    // If more than a full revolution of the wheel has elapsed, each slot need only be visited once.
+    if (lastTick - tick >= WEAVE_CONFIG_WRMP_RETRANS_WHEEL_SIZE)
     {
-        ec = RetransTable[i].exchContext;
-        if (ec)
+        tick = lastTick - (WEAVE_CONFIG_WRMP_RETRANS_WHEEL_SIZE - 1);
+    }
+
+    // Retransmit / cancel anything in the elapsed wheel slots whose retrans timeout
+    // has expired. Entries in these slots that belong to a later revolution of the
+    // wheel are left in place.
+    while (true)
+    {
+        mWRMPRetransCursor = mWRMPRetransWheel[tick & (WEAVE_CONFIG_WRMP_RETRANS_WHEEL_SIZE - 1)];
+
+        while (mWRMPRetransCursor != NULL)
         {
+            RetransTableEntry *entry = mWRMPRetransCursor;
             WEAVE_ERROR err = WEAVE_NO_ERROR;
 
-            if (0 == RetransTable[i].nextRetransTime)
+            mWRMPRetransCursor = entry->wheelNext;
+
+            if (!IsWRMPTickDue(entry->nextRetransTime, lastTick))
+                continue;
+
+            ec = entry->exchContext;
+
+            uint8_t sendCount = entry->sendCount;
+            void * msgCtxt = entry->msgCtxt;
+
+            if (sendCount > ec->mWRMPConfig.mMaxRetrans)
             {
-                uint8_t sendCount = RetransTable[i].sendCount;
-                void * msgCtxt = RetransTable[i].msgCtxt;
+                err = WEAVE_ERROR_MESSAGE_NOT_ACKNOWLEDGED;
 
-                if (sendCount > ec->mWRMPConfig.mMaxRetrans)
-                {
-                    err = WEAVE_ERROR_MESSAGE_NOT_ACKNOWLEDGED;
+                WeaveLogError(ExchangeManager, "Failed to Send Weave MsgId:%08" PRIX32 " sendCount: %" PRIu8 " max retries: %" PRIu8,
+                              entry->msgId, sendCount, ec->mWRMPConfig.mMaxRetrans);
 
-                    WeaveLogError(ExchangeManager, "Failed to Send Weave MsgId:%08" PRIX32 " sendCount: %" PRIu8 " max retries: %" PRIu8,
-                                  RetransTable[i].msgId, sendCount, ec->mWRMPConfig.mMaxRetrans);
+                // Remove from Table
+                ClearRetransmitTable(*entry);
+            }
 
-                    // Remove from Table
-                    ClearRetransmitTable(RetransTable[i]);
-                }
+            if (err == WEAVE_NO_ERROR)
+            {
+                // Resend from Table (if the operation fails, the entry is cleared)
+                err = SendFromRetransTable(entry);
+            }
+
+            if (err == WEAVE_NO_ERROR)
+            {
+                uint32_t retransTimeout = ec->GetCurrentRetransmitTimeout();
 
-                if (err == WEAVE_NO_ERROR)
+#if WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE > 0
+                // With adaptive timeouts, back off exponentially on each successive retransmission.
+                if (ec->IsAdaptiveRetransEnabled())
                 {
-                    // Resend from Table (if the operation fails, the entry is cleared)
-                    err = SendFromRetransTable(&(RetransTable[i]));
+                    for (uint8_t i = 1; i < entry->sendCount && retransTimeout < WEAVE_CONFIG_WRMP_MAX_RETRANS_TIMEOUT; i++)
+                    {
+                        retransTimeout <<= 1;
+                    }
+
+                    if (retransTimeout > WEAVE_CONFIG_WRMP_MAX_RETRANS_TIMEOUT)
+                    {
+                        retransTimeout = WEAVE_CONFIG_WRMP_MAX_RETRANS_TIMEOUT;
+                    }
                 }
+#endif
 
-                if (err == WEAVE_NO_ERROR)
-                {
-                    // If the retransmission was successful, update the passive timer
-                    RetransTable[i].nextRetransTime = ec->GetCurrentRetransmitTimeout() / mWRMPTimerInterval;
+                // If the retransmission was successful, update the passive timer
+                WRMPScheduleRetrans(entry, mWRMPCurrentTick + retransTimeout / mWRMPTimerInterval);
 #if defined(DEBUG)
-                    WeaveLogProgress(ExchangeManager, "Retransmit MsgId:%08" PRIX32 " Send Cnt %d",
-                            RetransTable[i].msgId, RetransTable[i].sendCount);
+                WeaveLogProgress(ExchangeManager, "Retransmit MsgId:%08" PRIX32 " Send Cnt %d",
+                        entry->msgId, entry->sendCount);
 #endif
-                }
+            }
 
-                if (err != WEAVE_NO_ERROR)
+            if (err != WEAVE_NO_ERROR)
+            {
+                if (ec->OnSendError)
                 {
-                    if (ec->OnSendError)
-                    {
-                        ec->OnSendError(ec, err, msgCtxt);
-                    }
+                    ec->OnSendError(ec, err, msgCtxt);
                 }
-            } //nextRetransTime = 0
+            }
         }
+
+        if (tick == lastTick)
+            break;
+
+        tick++;
     }
 
+    // All slots before the current tick have now been processed. The current slot is
+    // revisited on the next call since entries may still be scheduled for this tick.
+    mWRMPWheelTick = lastTick;
+
     TicklessDebugDumpRetransTable("WRMPExecuteActions Dumping RetransTable entries after processing");
 }
 
 /**
 * Calculate number of virtual WRMP ticks that have expired since we last
-* called this function. Iterate through active exchange contexts and
-* retrans table entries, subtracting expired virtual ticks to synchronize
-* wakeup times with the current system time. Do not perform any actions
-* beyond updating tick counts, actions will be performed by the physical
-* WRMP timer tick expiry.
+* called this function and advance the current WRMP tick accordingly.
+* All WRMP wakeup times are kept as absolute tick values, so no per-entry
+* bookkeeping is required. Do not perform any actions, these will be
+* performed by the physical WRMP timer tick expiry.
 *
 */
 void WeaveExchangeManager::WRMPExpireTicks(void)
 {
     uint64_t            now         = 0;
-    ExchangeContext*    ec          = NULL;
     uint32_t            deltaTicks;
 
-    //Process Ack Tables for all ExchangeContexts
-    ec = (ExchangeContext *)ContextPool;
-
     now = System::Timer::GetCurrentEpoch();
 
     // Number of full ticks elapsed since last timer processing.  We always round down
@@ -1383,69 +1886,11 @@ void WeaveExchangeManager::WRMPExpireTicks(void)
 
     deltaTicks = GetTickCounterFromTimeDelta(now, mWRMPTimeStampBase);
 
-    // Note on math involving deltaTicks: in the code below, deltaTicks, a
-    // 32-bit value, is being subtracted from 16-bit expiration times.  In each
-    // case, we compare the expiration time prior to subtraction to guard
-    // against underflow.
-
 #if defined(WRMP_TICKLESS_DEBUG)
     WeaveLogProgress(ExchangeManager, "WRMPExpireTicks at %" PRIu64 ", %" PRIu64 ", %u", now, mWRMPTimeStampBase, deltaTicks);
 #endif
 
-    for (int i = 0; i < WEAVE_CONFIG_MAX_EXCHANGE_CONTEXTS; i++, ec++)
-    {
-        if (ec->ExchangeMgr != NULL && ec->IsAckPending())
-        {
-            //Decrement counter of Ack timestamp by the elapsed timer ticks
-            if (ec->mWRMPNextAckTime >= deltaTicks)
-            {
-                ec->mWRMPNextAckTime -= deltaTicks;
-            }
-            else
-            {
-                ec->mWRMPNextAckTime = 0;
-            }
-#if defined(WRMP_TICKLESS_DEBUG)
-            WeaveLogProgress(ExchangeManager, "WRMPExpireTicks set mWRMPNextAckTime to %u", ec->mWRMPNextAckTime);
-#endif
-        }
-    }
-
-    //Process Throttle Time
-    //Check Throttle timeout stored in EC to set/unset Throttle flag
-    for (int i = 0; i < WEAVE_CONFIG_WRMP_RETRANS_TABLE_SIZE; i++)
-    {
-        ec = RetransTable[i].exchContext;
-        if (ec)
-        {
-            //Process Retransmit Table
-            //Decrement Throttle timeout by elapsed timeticks
-            if (ec->mWRMPThrottleTimeout >= deltaTicks)
-            {
-                ec->mWRMPThrottleTimeout -= deltaTicks;
-            }
-            else
-            {
-                ec->mWRMPThrottleTimeout = 0;
-            }
-#if defined(WRMP_TICKLESS_DEBUG)
-            WeaveLogProgress(ExchangeManager, "WRMPExpireTicks set mWRMPThrottleTimeout to %u", RetransTable[i].nextRetransTime);
-#endif
-
-            //Decrement Retransmit timeout by elapsed timeticks
-            if (RetransTable[i].nextRetransTime >= deltaTicks)
-            {
-                RetransTable[i].nextRetransTime -= deltaTicks;
-            }
-            else
-            {
-                RetransTable[i].nextRetransTime = 0;
-            }
-#if defined(WRMP_TICKLESS_DEBUG)
-            WeaveLogProgress(ExchangeManager, "WRMPExpireTicks set nextRetransTime to %u", RetransTable[i].nextRetransTime);
-#endif
-        } //ec entry is allocated
-    }
+    mWRMPCurrentTick += deltaTicks;
 
     // Re-Adjust the base time stamp to the most recent tick boundary
 
@@ -1477,6 +1922,9 @@ void WeaveExchangeManager::WRMPTimeout(System::Layer* aSystemLayer, void* aAppSt
     WeaveLogProgress(ExchangeManager, "WRMPTimeout\n");
 #endif
 
+    // The timer is no longer pending.
+    exchangeMgr->mWRMPCurrentTimerExpiry = 0;
+
     // Make sure all tick counts are sync'd to the current time
     exchangeMgr->WRMPExpireTicks();
 
@@ -1507,36 +1955,34 @@ void WeaveExchangeManager::WRMPTimeout(System::Layer* aSystemLayer, void* aAppSt
  */
 WEAVE_ERROR WeaveExchangeManager::AddToRetransTable(ExchangeContext *ec, PacketBuffer *msgBuf, uint32_t messageId, void *msgCtxt, RetransTableEntry **rEntry)
 {
-    bool added      = false;
     WEAVE_ERROR err = WEAVE_NO_ERROR;
+    RetransTableEntry *entry = mWRMPRetransFreeList;
 
-    for (int i = 0; i < WEAVE_CONFIG_WRMP_RETRANS_TABLE_SIZE; i++)
+    if (entry != NULL)
     {
-        //Check the exchContext pointer for finding an empty slot in Table
-        if (!RetransTable[i].exchContext)
-        {
-            // Expire any virtual ticks that have expired so all wakeup sources reflect the current time
-            WRMPExpireTicks();
-
-            RetransTable[i].exchContext = ec;
-            RetransTable[i].msgId = messageId;
-            RetransTable[i].msgBuf = msgBuf;
-            RetransTable[i].sendCount = 0;
-            RetransTable[i].nextRetransTime = GetTickCounterFromTimeDelta(ec->GetCurrentRetransmitTimeout() + System::Timer::GetCurrentEpoch(), mWRMPTimeStampBase);
-
-            RetransTable[i].msgCtxt = msgCtxt;
-            *rEntry = &RetransTable[i];
-            //Increment the reference count
-            ec->AddRef();
-            added = true;
+        mWRMPRetransFreeList = entry->wheelNext;
 
-            //Check if the timer needs to be started and start it.
-            WRMPStartTimer();
-            break;
-        }
-    }
+        // Expire any virtual ticks that have expired so all wakeup sources reflect the current time
+        WRMPExpireTicks();
 
-    if (!added)
+        entry->exchContext = ec;
+        entry->msgId = messageId;
+        entry->msgBuf = msgBuf;
+        entry->sendCount = 0;
+        entry->wheelNext = NULL;
+        entry->wheelPrev = NULL;
+        WRMPScheduleRetrans(entry, WRMPTickFromNow(ec->GetCurrentRetransmitTimeout()));
+
+        entry->msgCtxt = msgCtxt;
+        *rEntry = entry;
+        //Increment the reference count
+        ec->AddRef();
+        ec->mWRMPUnackedCount++;
+
+        //Check if the timer needs to be started and start it.
+        WRMPStartTimer();
+    }
+    else
     {
         WeaveLogError(ExchangeManager, "RetransTable Already Full");
         err = WEAVE_ERROR_RETRANS_TABLE_FULL;
@@ -1567,7 +2013,7 @@ WEAVE_ERROR WeaveExchangeManager::SendFromRetransTable(RetransTableEntry *entry)
 
     WEAVE_FAULT_INJECT(FaultInjection::kFault_WRMSendError,
                        entry->sendCount = (ec->mWRMPConfig.mMaxRetrans + 1);
-                       entry->nextRetransTime = 0;
+                       WRMPScheduleRetrans(entry, mWRMPCurrentTick);
                        WRMPStartTimer();
                        ExitNow());
 
@@ -1583,6 +2029,18 @@ WEAVE_ERROR WeaveExchangeManager::SendFromRetransTable(RetransTableEntry *entry)
         p = entry->msgBuf->Start();
         len = entry->msgBuf->DataLength();
 
+        //Record the time of the first transmission for round-trip time measurement
+        if (entry->sendCount == 0)
+        {
+            entry->sentTime = static_cast<uint32_t>(System::Timer::GetCurrentEpoch());
+        }
+#if WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
+        else
+        {
+            MessageLayer->RecordPeerRetransmission(ec->PeerNodeId, len);
+        }
+#endif
+
         //Send the message through
         err = MessageLayer->SendMessage(ec->PeerAddr, ec->PeerPort, ec->PeerIntf,
                                         entry->msgBuf,
@@ -1654,6 +2112,9 @@ void WeaveExchangeManager::ClearRetransmitTable(RetransTableEntry &rEntry)
         // Expire any virtual ticks that have expired so all wakeup sources reflect the current time
         WRMPExpireTicks();
 
+        WRMPUnscheduleRetrans(&rEntry);
+
+        rEntry.exchContext->mWRMPUnackedCount--;
         rEntry.exchContext->Release();
         rEntry.exchContext = NULL;
 
@@ -1663,8 +2124,10 @@ void WeaveExchangeManager::ClearRetransmitTable(RetransTableEntry &rEntry)
             rEntry.msgBuf = NULL;
         }
 
-        // Clear all other fields
+        // Clear all other fields and return the entry to the free list
         memset(&rEntry, 0, sizeof(rEntry));
+        rEntry.wheelNext = mWRMPRetransFreeList;
+        mWRMPRetransFreeList = &rEntry;
 
         // Schedule next physical wakeup
         WRMPStartTimer();
@@ -1699,53 +2162,133 @@ void WeaveExchangeManager::FailRetransmitTableEntries(ExchangeContext *ec, WEAVE
 }
 
 /**
-* Iterate through active exchange contexts and retrans table entries.
+ *  Hold a sequenced message that arrived ahead of its predecessors on an
+ *  exchange, so that it can be delivered once they have been received.
+ *
+ *  @param[in]    ec            A pointer to the ExchangeContext object.
+ *
+ *  @param[in]    msgInfo       General Weave message information for the message.
+ *
+ *  @param[in]    exchHeader    Weave exchange information for the message.
+ *
+ *  @param[in]    msgBuf        A pointer to the PacketBuffer holding the message payload. On
+ *                              success, ownership of the buffer passes to the reorder pool.
+ *
+ *  @retval  #WEAVE_ERROR_NO_MEMORY If the reorder pool is full.
+ *  @retval  #WEAVE_NO_ERROR On success.
+ *
+ */
+WEAVE_ERROR WeaveExchangeManager::WRMPHoldMessage(ExchangeContext *ec, const WeaveMessageInfo *msgInfo,
+                                                  const WeaveExchangeHeader *exchHeader, PacketBuffer *msgBuf)
+{
+    for (int i = 0; i < WEAVE_CONFIG_WRMP_REORDER_POOL_SIZE; i++)
+    {
+        ReorderEntry &entry = mWRMPReorderPool[i];
+
+        if (entry.exchContext == NULL)
+        {
+            entry.exchContext = ec;
+            entry.msgBuf = msgBuf;
+            entry.msgInfo = *msgInfo;
+            entry.exchHeader = *exchHeader;
+            if (msgInfo->InPacketInfo != NULL)
+            {
+                entry.pktInfo = *msgInfo->InPacketInfo;
+                entry.msgInfo.InPacketInfo = &entry.pktInfo;
+            }
+            return WEAVE_NO_ERROR;
+        }
+    }
+
+    WeaveLogError(ExchangeManager, "Reorder pool full; dropping MsgId:%08" PRIX32, msgInfo->MessageId);
+    return WEAVE_ERROR_NO_MEMORY;
+}
+
+/**
+ *  Find the held message with the given sequence number on an exchange.
+ *
+ *  @param[in]    ec            A pointer to the ExchangeContext object.
+ *
+ *  @param[in]    seqNum        The sequence number of the message.
+ *
+ *  @return  A pointer to the reorder pool entry, or NULL if no such message is held.
+ *
+ */
+WeaveExchangeManager::ReorderEntry *WeaveExchangeManager::WRMPFindHeldMessage(ExchangeContext *ec, uint16_t seqNum)
+{
+    for (int i = 0; i < WEAVE_CONFIG_WRMP_REORDER_POOL_SIZE; i++)
+    {
+        if (mWRMPReorderPool[i].exchContext == ec && mWRMPReorderPool[i].exchHeader.SequenceNum == seqNum)
+        {
+            return &mWRMPReorderPool[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ *  Drop the messages held for in-order delivery on an exchange.
+ *
+ *  @param[in]    ec            A pointer to the ExchangeContext object, or NULL to drop
+ *                              the messages held for all exchanges.
+ *
+ */
+void WeaveExchangeManager::WRMPFreeHeldMessages(ExchangeContext *ec)
+{
+    for (int i = 0; i < WEAVE_CONFIG_WRMP_REORDER_POOL_SIZE; i++)
+    {
+        ReorderEntry &entry = mWRMPReorderPool[i];
+
+        if (entry.exchContext != NULL && (ec == NULL || entry.exchContext == ec))
+        {
+            PacketBuffer::Free(entry.msgBuf);
+            entry.msgBuf = NULL;
+            entry.exchContext = NULL;
+        }
+    }
+}
+
+/**
 * Determine how many WRMP ticks we need to sleep before we need to physically
-* wake the CPU to perform an action.  Set a timer to go off when we
-* next need to wake the system.
+* wake the CPU to perform an action: the earliest of the head of the pending
+* ack list and the nearest occupied retransmission wheel slot.  Set a timer
+* to go off when we next need to wake the system.
 *
 */
 void WeaveExchangeManager::WRMPStartTimer()
 {
     WEAVE_ERROR res                   = WEAVE_NO_ERROR;
-    uint32_t nextWakeTime             = UINT32_MAX;
+    uint32_t nextWakeTick             = 0;
     bool foundWake                    = false;
-    ExchangeContext *ec               = NULL;
 
     // When do we need to next wake up to send an ACK?
-    ec = (ExchangeContext *)ContextPool;
-
-    for (int i = 0; i < WEAVE_CONFIG_MAX_EXCHANGE_CONTEXTS; i++, ec++)
+    if (mWRMPAckHead != NULL)
     {
-        if (ec->ExchangeMgr != NULL && ec->IsAckPending() && ec->mWRMPNextAckTime < nextWakeTime) {
-            nextWakeTime = ec->mWRMPNextAckTime;
-            foundWake = true;
+        nextWakeTick = mWRMPAckHead->mWRMPNextAckTime;
+        foundWake = true;
 #if defined(WRMP_TICKLESS_DEBUG)
-            WeaveLogProgress(ExchangeManager, "WRMPStartTimer next ACK time %u", nextWakeTime);
+        WeaveLogProgress(ExchangeManager, "WRMPStartTimer next ACK time %u", nextWakeTick);
 #endif
-        }
     }
 
-    for (int i = 0; i < WEAVE_CONFIG_WRMP_RETRANS_TABLE_SIZE; i++)
+    // When do we need to next wake up for WRMP retransmit?  Walk the wheel forward from
+    // the earliest unprocessed slot; once a slot at or beyond the earliest wakeup found
+    // so far is reached, no later slot can hold an earlier entry.
+    for (uint32_t slotTick = mWRMPWheelTick; slotTick != mWRMPWheelTick + WEAVE_CONFIG_WRMP_RETRANS_WHEEL_SIZE; slotTick++)
     {
-        ec = RetransTable[i].exchContext;
-        if (ec)
-        {
-            // When do we need to next wake up for throttle retransmission?
-            if (ec->mWRMPThrottleTimeout != 0 && ec->mWRMPThrottleTimeout < nextWakeTime) {
-                nextWakeTime = ec->mWRMPThrottleTimeout;
-                foundWake = true;
-#if defined(WRMP_TICKLESS_DEBUG)
-                WeaveLogProgress(ExchangeManager, "WRMPStartTimer throttle timeout %u", nextWakeTime);
-#endif
-            }
+        if (foundWake && IsWRMPTickDue(nextWakeTick, slotTick))
+            break;
 
-            // When do we need to next wake up for WRMP retransmit?
-            if (RetransTable[i].nextRetransTime < nextWakeTime) {
-                nextWakeTime = RetransTable[i].nextRetransTime;
+        for (RetransTableEntry *entry = mWRMPRetransWheel[slotTick & (WEAVE_CONFIG_WRMP_RETRANS_WHEEL_SIZE - 1)];
+             entry != NULL; entry = entry->wheelNext)
+        {
+            if (!foundWake || !IsWRMPTickDue(nextWakeTick, entry->nextRetransTime))
+            {
+                nextWakeTick = entry->nextRetransTime;
                 foundWake = true;
 #if defined(WRMP_TICKLESS_DEBUG)
-                WeaveLogProgress(ExchangeManager, "WRMPStartTimer RetransTime %u", nextWakeTime);
+                WeaveLogProgress(ExchangeManager, "WRMPStartTimer RetransTime %u", nextWakeTick);
 #endif
             }
         }
@@ -1754,13 +2297,17 @@ void WeaveExchangeManager::WRMPStartTimer()
     if (foundWake) {
         // Set timer for next tick boundary - subtract the elapsed time from the current tick
         System::Timer::Epoch currentTime = System::Timer::GetCurrentEpoch();
-        int32_t timerArmValue = nextWakeTime * mWRMPTimerInterval - (currentTime - mWRMPTimeStampBase);
+        int32_t wakeTicks = static_cast<int32_t>(nextWakeTick - mWRMPCurrentTick);
+        if (wakeTicks < 0) {
+            wakeTicks = 0;
+        }
+        int32_t timerArmValue = wakeTicks * mWRMPTimerInterval - (currentTime - mWRMPTimeStampBase);
         System::Timer::Epoch timerExpiryEpoch = currentTime + timerArmValue;
 
 #if defined(WRMP_TICKLESS_DEBUG)
         WeaveLogProgress(ExchangeManager, "WRMPStartTimer wake in %d ms (%" PRIu64" %u %" PRIu64 " %" PRIu64 ")",
                 timerArmValue,
-                timerExpiryEpoch, nextWakeTime, currentTime, mWRMPTimeStampBase);
+                timerExpiryEpoch, nextWakeTick, currentTime, mWRMPTimeStampBase);
 #endif
         if (timerExpiryEpoch != mWRMPCurrentTimerExpiry)
         {
@@ -1796,7 +2343,213 @@ void WeaveExchangeManager::WRMPStartTimer()
 void WeaveExchangeManager::WRMPStopTimer()
 {
     MessageLayer->SystemLayer->CancelTimer(WRMPTimeout, this);
+    mWRMPCurrentTimerExpiry = 0;
+}
+
+#if WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE > 0
+/**
+ *  Find the round-trip time estimate for a peer node.
+ *
+ *  @param[in]    peerNodeId    The node identifier of the peer.
+ *
+ *  @return  A pointer to the peer's entry, or NULL if there is no estimate for the peer.
+ *
+ */
+WeaveExchangeManager::PeerRTTEntry *WeaveExchangeManager::WRMPFindPeerRTT(uint64_t peerNodeId) const
+{
+    for (int i = 0; i < WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE; i++)
+    {
+        if (mWRMPPeerRTT[i].sampleCount != 0 && mWRMPPeerRTT[i].peerNodeId == peerNodeId)
+        {
+            return const_cast<PeerRTTEntry *>(&mWRMPPeerRTT[i]);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ *  Fold a round-trip time sample into the estimate for a peer node, using the
+ *  smoothing of RFC 6298.  If the peer has no estimate yet, an unused entry,
+ *  or else the least recently updated entry, is assigned to it.
+ *
+ *  @param[in]    peerNodeId    The node identifier of the peer.
+ *
+ *  @param[in]    rttMillis     The measured round-trip time, in milliseconds.
+ *
+ */
+void WeaveExchangeManager::WRMPUpdatePeerRTT(uint64_t peerNodeId, uint32_t rttMillis)
+{
+    PeerRTTEntry *entry = WRMPFindPeerRTT(peerNodeId);
+
+    if (entry == NULL)
+    {
+        entry = &mWRMPPeerRTT[0];
+
+        for (int i = 0; i < WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE && entry->sampleCount != 0; i++)
+        {
+            if (mWRMPPeerRTT[i].sampleCount == 0 ||
+                static_cast<int32_t>(mWRMPPeerRTT[i].lastUpdateTick - entry->lastUpdateTick) < 0)
+            {
+                entry = &mWRMPPeerRTT[i];
+            }
+        }
+
+        entry->peerNodeId = peerNodeId;
+        entry->sampleCount = 0;
+    }
+
+    // Keep the scaled values well clear of overflow.
+    if (rttMillis > WEAVE_CONFIG_WRMP_MAX_RETRANS_TIMEOUT)
+    {
+        rttMillis = WEAVE_CONFIG_WRMP_MAX_RETRANS_TIMEOUT;
+    }
+
+    if (entry->sampleCount == 0)
+    {
+        // SRTT = R, RTTVAR = R/2
+        entry->smoothedRTT = rttMillis << 3;
+        entry->rttVariation = rttMillis << 1;
+    }
+    else
+    {
+        // RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|, SRTT = 7/8 SRTT + 1/8 R
+        int32_t delta = static_cast<int32_t>(rttMillis) - static_cast<int32_t>(entry->smoothedRTT >> 3);
+
+        entry->smoothedRTT += delta;
+        if (delta < 0)
+        {
+            delta = -delta;
+        }
+        entry->rttVariation += delta - static_cast<int32_t>(entry->rttVariation >> 2);
+    }
+
+    if (entry->sampleCount != UINT32_MAX)
+    {
+        entry->sampleCount++;
+    }
+    entry->lastUpdateTick = mWRMPCurrentTick;
+
+#if WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
+    MessageLayer->RecordPeerRTT(peerNodeId, entry->smoothedRTT >> 3);
+#endif
+
+#if defined(DEBUG)
+    WeaveLogProgress(ExchangeManager, "RTT sample %" PRIu32 " ms for %016" PRIX64 ", RTO %" PRIu32 " ms",
+                     rttMillis, peerNodeId, WRMPComputeRetransTimeout(*entry));
+#endif
+}
+
+/**
+ *  Get the retransmission timeout derived from the round-trip time estimate for a peer node.
+ *
+ *  @param[in]    peerNodeId    The node identifier of the peer.
+ *
+ *  @param[out]   timeout       The retransmission timeout, in milliseconds.  Left unchanged
+ *                              if there is no estimate for the peer.
+ *
+ *  @return  true if an estimate exists for the peer, false otherwise.
+ *
+ */
+bool WeaveExchangeManager::WRMPGetPeerRetransTimeout(uint64_t peerNodeId, uint32_t &timeout) const
+{
+    const PeerRTTEntry *entry = WRMPFindPeerRTT(peerNodeId);
+
+    if (entry != NULL)
+    {
+        timeout = WRMPComputeRetransTimeout(*entry);
+    }
+
+    return (entry != NULL);
+}
+
+/**
+ *  Compute the retransmission timeout for a round-trip time estimate, as
+ *  RTO = SRTT + max(G, 4 * RTTVAR), with G the WRMP timer tick period, bounded
+ *  by #WEAVE_CONFIG_WRMP_MIN_RETRANS_TIMEOUT and #WEAVE_CONFIG_WRMP_MAX_RETRANS_TIMEOUT.
+ *
+ */
+uint32_t WeaveExchangeManager::WRMPComputeRetransTimeout(const PeerRTTEntry &entry)
+{
+    uint32_t variation = entry.rttVariation;
+    uint32_t timeout;
+
+    if (variation < WEAVE_CONFIG_WRMP_TIMER_DEFAULT_PERIOD)
+    {
+        variation = WEAVE_CONFIG_WRMP_TIMER_DEFAULT_PERIOD;
+    }
+
+    timeout = (entry.smoothedRTT >> 3) + variation;
+
+    if (timeout < WEAVE_CONFIG_WRMP_MIN_RETRANS_TIMEOUT)
+    {
+        timeout = WEAVE_CONFIG_WRMP_MIN_RETRANS_TIMEOUT;
+    }
+    else if (timeout > WEAVE_CONFIG_WRMP_MAX_RETRANS_TIMEOUT)
+    {
+        timeout = WEAVE_CONFIG_WRMP_MAX_RETRANS_TIMEOUT;
+    }
+
+    return timeout;
+}
+
+void WeaveExchangeManager::WRMPGetPeerRTTStats(const PeerRTTEntry &entry, WRMPPeerRTTStats &stats)
+{
+    stats.PeerNodeId = entry.peerNodeId;
+    stats.SmoothedRTT = entry.smoothedRTT >> 3;
+    stats.RTTVariation = entry.rttVariation >> 2;
+    stats.RetransTimeout = WRMPComputeRetransTimeout(entry);
+    stats.SampleCount = entry.sampleCount;
+}
+
+/**
+ *  Get the WRMP round-trip time statistics for a peer node.
+ *
+ *  @param[in]    peerNodeId    The node identifier of the peer.
+ *
+ *  @param[out]   stats         The round-trip time statistics for the peer.
+ *
+ *  @return  true if round-trip time samples have been taken for the peer, false otherwise.
+ *
+ */
+bool WeaveExchangeManager::GetPeerRTTStats(uint64_t peerNodeId, WRMPPeerRTTStats &stats) const
+{
+    const PeerRTTEntry *entry = WRMPFindPeerRTT(peerNodeId);
+
+    if (entry != NULL)
+    {
+        WRMPGetPeerRTTStats(*entry, stats);
+    }
+
+    return (entry != NULL);
+}
+
+/**
+ *  Get the WRMP round-trip time statistics for all peer nodes for which
+ *  an estimate is held.
+ *
+ *  @param[out]   stats         An array to be filled with the round-trip time statistics.
+ *
+ *  @param[in]    maxStats      The number of elements in the stats array.
+ *
+ *  @return  The number of elements filled in.
+ *
+ */
+size_t WeaveExchangeManager::GetPeerRTTStats(WRMPPeerRTTStats *stats, size_t maxStats) const
+{
+    size_t count = 0;
+
+    for (int i = 0; i < WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE && count < maxStats; i++)
+    {
+        if (mWRMPPeerRTT[i].sampleCount != 0)
+        {
+            WRMPGetPeerRTTStats(mWRMPPeerRTT[i], stats[count++]);
+        }
+    }
+
+    return count;
 }
+#endif // WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE > 0
 #endif // WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
 
 /**
@@ -1812,6 +2565,7 @@ void WeaveExchangeManager::InitBindingPool(void)
         BindingPool[i].mExchangeManager = this;
     }
     mBindingsInUse = 0;
+    mNextSecMgrAvailableBinding = 0;
 }
 
 /**
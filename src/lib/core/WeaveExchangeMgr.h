@@ -85,6 +85,8 @@ public:
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
     uint32_t AckMsgId;       /**< Optional; Message identifier being acknowledged.
                                   Specified when requiring acknowledgments. */
+    uint16_t SequenceNum;    /**< Optional; Position of the message in the reliable message stream of the exchange.
+                                  Specified when the sender has enabled a WRMP send window. */
 #endif
 };
 
@@ -105,9 +107,30 @@ typedef enum WeaveExchangeFlags
 {
     kWeaveExchangeFlag_Initiator     = 0x1,  /**< Set when current message is sent by the initiator of an exchange */
     kWeaveExchangeFlag_AckId         = 0x2,  /**< Set when current message is an acknowledgment for a previously received message */
-    kWeaveExchangeFlag_NeedsAck      = 0x4   /**< Set when current message is requesting an acknowledgment from the recipient. */
+    kWeaveExchangeFlag_NeedsAck      = 0x4,  /**< Set when current message is requesting an acknowledgment from the recipient. */
+    kWeaveExchangeFlag_SequenceNum   = 0x8   /**< Set when current message carries a sequence number for in-order delivery.
+                                                  Only sent to peers known to support it (see ExchangeContext::SetWRMPSendWindow()). */
 } WeaveExchangeFlags;
 
+#if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+/**
+ *  @class WRMPPeerRTTStats
+ *
+ *  @brief
+ *    Round-trip time statistics measured by the Weave Reliable Messaging
+ *    Protocol for a peer node.
+ */
+class WRMPPeerRTTStats
+{
+public:
+    uint64_t PeerNodeId;     /**< The node identifier of the peer. */
+    uint32_t SmoothedRTT;    /**< The smoothed round-trip time, in milliseconds. */
+    uint32_t RTTVariation;   /**< The round-trip time variation, in milliseconds. */
+    uint32_t RetransTimeout; /**< The retransmission timeout derived from the estimate, in milliseconds. */
+    uint32_t SampleCount;    /**< The number of round-trip time samples taken. */
+};
+#endif
+
 /**
  *  @class ExchangeContext
  *
@@ -179,6 +202,10 @@ public:
     void SetMsgRcvdFromPeer(bool inMsgRcvdFromPeer);
     WEAVE_ERROR WRMPFlushAcks(void);
     uint32_t GetCurrentRetransmitTimeout(void);
+    bool IsAdaptiveRetransEnabled(void) const;
+    void SetAdaptiveRetransEnabled(bool inAdaptiveRetrans);
+    uint8_t GetWRMPSendWindow(void) const;
+    WEAVE_ERROR SetWRMPSendWindow(uint8_t windowSize);
 #endif
     void SetResponseExpected(bool inResponseExpected);
     bool AutoRequestAck() const;
@@ -195,6 +222,7 @@ public:
     WEAVE_ERROR SendMessage(uint32_t profileId, uint8_t msgType, PacketBuffer *msgPayload, uint16_t sendFlags = 0, void *msgCtxt = 0);
     WEAVE_ERROR SendMessage(uint32_t profileId, uint8_t msgType, PacketBuffer *msgBuf, uint16_t sendFlags, WeaveMessageInfo * msgInfo, void *msgCtxt = 0);
     WEAVE_ERROR SendCommonNullMessage(void);
+    uint16_t GetHeaderReserveSize(uint16_t sendFlags = 0);
     WEAVE_ERROR EncodeExchHeader(WeaveExchangeHeader *exchangeHeader, uint32_t profileId, uint8_t msgType, PacketBuffer *msgBuf, uint16_t sendFlags);
     void TeardownTrickleRetransmit(void);
     WEAVE_ERROR SetupTrickleRetransmit(uint32_t retransInterval=WEAVE_TRICKLE_DEFAULT_PERIOD, uint8_t threshold=WEAVE_TRICKLE_DEFAULT_THRESHOLD, uint32_t timeout=0);
@@ -366,19 +394,35 @@ private:
 
     uint32_t mPendingPeerAckId;
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
-    uint16_t mWRMPNextAckTime;                  //Next time for triggering Solo Ack
-    uint16_t mWRMPThrottleTimeout;              //Timeout until when Throttle is On when WRMPThrottleEnabled is set
+    uint32_t mWRMPNextAckTime;                  //WRMP tick at which a Solo Ack is due
+    uint32_t mWRMPThrottleTimeout;              //WRMP tick until which Throttle is On when WRMPThrottleEnabled is set
+    ExchangeContext *mWRMPAckNext;              //Next context in the exchange manager's pending ack list
+    ExchangeContext *mWRMPAckPrev;              //Previous context in the exchange manager's pending ack list
+    uint32_t mWRMPExtraAckIds[WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW]; //Pending acks received before mPendingPeerAckId
+    uint16_t mWRMPSendSeqNum;                   //Sequence number of the next sequenced message sent on this exchange
+    uint16_t mWRMPRcvSeqNum;                    //Sequence number of the next sequenced message to deliver to the application
+    uint8_t mWRMPExtraAckCount;                 //Number of valid entries in mWRMPExtraAckIds
+    uint8_t mWRMPSendWindow;                    //Maximum number of unacknowledged reliable messages; 0 if windowing is disabled
+    uint8_t mWRMPUnackedCount;                  //Number of messages of this exchange in the retransmission table
 #endif
+    uint16_t PredictHeaderLength(const WeaveMessageInfo *msgInfo, uint16_t sendFlags);
     void DoClose(bool clearRetransTable);
     WEAVE_ERROR HandleMessage(WeaveMessageInfo *msgInfo, const WeaveExchangeHeader *exchHeader, PacketBuffer *msgBuf);
     WEAVE_ERROR HandleMessage(WeaveMessageInfo *msgInfo, const WeaveExchangeHeader *exchHeader, PacketBuffer *msgBuf,
                               ExchangeContext::MessageReceiveFunct umhandler);
+    void DeliverMessage(WeaveMessageInfo *msgInfo, const WeaveExchangeHeader *exchHeader, PacketBuffer *msgBuf,
+                        ExchangeContext::MessageReceiveFunct umhandler);
     void HandleConnectionClosed(WEAVE_ERROR conErr);
 
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+    bool WRMPIsThrottled(void);
     bool WRMPCheckAndRemRetransTable(uint32_t msgId, void **rCtxt);
     WEAVE_ERROR WRMPHandleRcvdAck(const WeaveExchangeHeader *exchHeader, const WeaveMessageInfo *msgInfo);
-    WEAVE_ERROR WRMPHandleNeedsAck(const WeaveMessageInfo *msgInfo);
+    WEAVE_ERROR WRMPHandleRcvdAck(uint32_t ackMsgId);
+    WEAVE_ERROR WRMPHandleSelectiveAck(PacketBuffer *msgBuf);
+    WEAVE_ERROR WRMPHandleNeedsAck(const WeaveMessageInfo *msgInfo, bool isSequenced);
+    WEAVE_ERROR WRMPSendAcks(void);
+    void WRMPDeliverHeldMessages(void);
     WEAVE_ERROR HandleThrottleFlow(uint32_t PauseTimeMillis);
 #endif
 
@@ -452,6 +496,10 @@ public:
 
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
     void ClearMsgCounterSyncReq(uint64_t peerNodeId);
+#if WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE > 0
+    bool GetPeerRTTStats(uint64_t peerNodeId, WRMPPeerRTTStats &stats) const;
+    size_t GetPeerRTTStats(WRMPPeerRTTStats *stats, size_t maxStats) const;
+#endif
 #endif
 
 private:
@@ -460,6 +508,8 @@ private:
     uint64_t mWRMPTimeStampBase;    //WRMP timer base value to add offsets to evaluate timeouts
     System::Timer::Epoch mWRMPCurrentTimerExpiry; //Tracks when the WRM timer will next expire
     uint16_t mWRMPTimerInterval;    //WRMP Timer tick period
+    uint32_t mWRMPCurrentTick;      //Number of WRMP ticks elapsed up to mWRMPTimeStampBase
+    uint32_t mWRMPWheelTick;        //Earliest WRMP tick whose retransmission wheel slot is still pending
     /**
      *  @class RetransTableEntry
      *
@@ -477,7 +527,10 @@ private:
        ExchangeContext      *exchContext;       /**< The ExchangeContext for the stored Weave message. */
        PacketBuffer         *msgBuf;            /**< A pointer to the PacketBuffer object holding the Weave message. */
        void                 *msgCtxt;           /**< A pointer to an application level context object associated with the message. */
-       uint16_t             nextRetransTime;    /**< A counter representing the next retransmission time for the message. */
+       RetransTableEntry    *wheelNext;         /**< Next entry in the same retransmission wheel slot, or in the free list. */
+       RetransTableEntry    *wheelPrev;         /**< Previous entry in the same retransmission wheel slot. */
+       uint32_t             nextRetransTime;    /**< The WRMP tick at which the message is next due for retransmission. */
+       uint32_t             sentTime;           /**< The time (in milliseconds) at which the message was first sent. */
        uint8_t              sendCount;          /**< A counter representing the number of times the message has been sent. */
     };
     void     WRMPExecuteActions(void);
@@ -487,8 +540,16 @@ private:
     void     WRMPProcessDDMessage(uint32_t PauseTimeMillis, uint64_t DelayedNodeId);
     uint32_t GetTickCounterFromTimeDelta (uint64_t newTime,
                                           uint64_t oldTime);
+    uint32_t WRMPTickFromNow(uint32_t delayMillis);
+    static bool IsWRMPTickDue(uint32_t tick, uint32_t now);
+    void     WRMPScheduleRetrans(RetransTableEntry *entry, uint32_t tick);
+    void     WRMPUnscheduleRetrans(RetransTableEntry *entry);
+    void     WRMPAddPendingAck(ExchangeContext *ec);
+    void     WRMPRemovePendingAck(ExchangeContext *ec);
+    void     WRMPSendAckList(ExchangeContext *ec);
+    void     WRMPProcessAckList(const WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf);
+    static bool WRMPCanCoalesceAcks(const ExchangeContext *ec, const ExchangeContext *other);
     static void WRMPTimeout(System::Layer* aSystemLayer, void* aAppState, System::Error aError);
-    static bool isLaterInWRMP(uint64_t t2, uint64_t t1);
     bool IsSendErrorCritical(WEAVE_ERROR err) const;
     WEAVE_ERROR AddToRetransTable(ExchangeContext *ec, PacketBuffer *inetBuff, uint32_t msgId, void *msgCtxt, RetransTableEntry **rEntry);
     WEAVE_ERROR SendFromRetransTable(RetransTableEntry *entry);
@@ -499,10 +560,81 @@ private:
 
     void TicklessDebugDumpRetransTable(const char *log);
 
+#if WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE > 0
+    /**
+     *  @class PeerRTTEntry
+     *
+     *  @brief
+     *    This class is part of the Weave Reliable Messaging Protocol and holds
+     *    the round-trip time estimate for a peer node, from which adaptive
+     *    retransmission timeouts are derived.
+     *
+     *    Entries are keyed by node identifier alone, so all paths to a peer,
+     *    whatever their transport or interface, share one estimate.
+     *
+     */
+    class PeerRTTEntry
+    {
+      public:
+       uint64_t             peerNodeId;         /**< The node identifier of the peer. */
+       uint32_t             smoothedRTT;        /**< The smoothed round-trip time, in units of 1/8 millisecond. */
+       uint32_t             rttVariation;       /**< The round-trip time variation, in units of 1/4 millisecond. */
+       uint32_t             sampleCount;        /**< The number of samples taken; zero marks an unused entry. */
+       uint32_t             lastUpdateTick;     /**< The WRMP tick at which the last sample was taken. */
+    };
+    PeerRTTEntry *WRMPFindPeerRTT(uint64_t peerNodeId) const;
+    void WRMPUpdatePeerRTT(uint64_t peerNodeId, uint32_t rttMillis);
+    bool WRMPGetPeerRetransTimeout(uint64_t peerNodeId, uint32_t &timeout) const;
+    static uint32_t WRMPComputeRetransTimeout(const PeerRTTEntry &entry);
+    static void WRMPGetPeerRTTStats(const PeerRTTEntry &entry, WRMPPeerRTTStats &stats);
+
+    PeerRTTEntry mWRMPPeerRTT[WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE];
+#endif // WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE > 0
+
+    /**
+     *  @class ReorderEntry
+     *
+     *  @brief
+     *    This class is part of the Weave Reliable Messaging Protocol and holds
+     *    a sequenced message that arrived ahead of its predecessors on the
+     *    exchange, until it can be delivered in order.
+     *
+     */
+    class ReorderEntry
+    {
+      public:
+       ExchangeContext      *exchContext;       /**< The ExchangeContext of the held message; NULL marks an unused entry. */
+       PacketBuffer         *msgBuf;            /**< A pointer to the PacketBuffer object holding the message payload. */
+       WeaveMessageInfo     msgInfo;            /**< The message information of the held message. */
+       IPPacketInfo         pktInfo;            /**< The IP addressing information of the held message. */
+       WeaveExchangeHeader  exchHeader;         /**< The exchange header of the held message. */
+    };
+    WEAVE_ERROR WRMPHoldMessage(ExchangeContext *ec, const WeaveMessageInfo *msgInfo, const WeaveExchangeHeader *exchHeader,
+                                PacketBuffer *msgBuf);
+    ReorderEntry *WRMPFindHeldMessage(ExchangeContext *ec, uint16_t seqNum);
+    void WRMPFreeHeldMessages(ExchangeContext *ec);
+
+    ReorderEntry mWRMPReorderPool[WEAVE_CONFIG_WRMP_REORDER_POOL_SIZE];
+
     //WRMP Global tables for timer context
     RetransTableEntry RetransTable[WEAVE_CONFIG_WRMP_RETRANS_TABLE_SIZE];
+    RetransTableEntry *mWRMPRetransFreeList;    //Unused retransmission table entries
+    RetransTableEntry *mWRMPRetransWheel[WEAVE_CONFIG_WRMP_RETRANS_WHEEL_SIZE]; //Active entries hashed by retransmission tick
+    RetransTableEntry *mWRMPRetransCursor;      //Next wheel entry to be visited by WRMPExecuteActions
+    ExchangeContext *mWRMPAckHead;              //Contexts with a pending ack, ordered by ack time
+    ExchangeContext *mWRMPAckTail;
 #endif // WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
 
+#if WEAVE_CONFIG_MAX_UNSOLICITED_MESSAGE_HANDLERS < UINT8_MAX
+    typedef uint8_t UMHIndexType;
+#elif WEAVE_CONFIG_MAX_UNSOLICITED_MESSAGE_HANDLERS < UINT16_MAX
+    typedef uint16_t UMHIndexType;
+#else
+#error "WEAVE_CONFIG_MAX_UNSOLICITED_MESSAGE_HANDLERS too large"
+#endif
+
+    static const UMHIndexType kUMHIndexNone = static_cast<UMHIndexType>(~0);
+
     class UnsolicitedMessageHandler
     {
     public:
@@ -512,6 +644,7 @@ private:
         WeaveConnection *Con; // NULL means any connection, or no connection (i.e. UDP)
         int16_t MessageType; // -1 represents any message type
         bool AllowDuplicateMsgs;
+        UMHIndexType HashNext; // Next handler with the same hash, or next free handler
     };
 
 
@@ -520,8 +653,11 @@ private:
 
     Binding BindingPool[WEAVE_CONFIG_MAX_BINDINGS];
     size_t mBindingsInUse;
+    size_t mNextSecMgrAvailableBinding;
 
     UnsolicitedMessageHandler UMHandlerPool[WEAVE_CONFIG_MAX_UNSOLICITED_MESSAGE_HANDLERS];
+    UMHIndexType UMHandlerHash[WEAVE_CONFIG_UNSOLICITED_MESSAGE_HANDLER_HASH_SIZE]; // Handlers by profile id and message type
+    UMHIndexType UMHandlerFreeHead;
     void (*OnExchangeContextChanged)(size_t numContextsInUse);
 
     ExchangeContext *AllocContext(void);
@@ -532,6 +668,8 @@ private:
     WEAVE_ERROR RegisterUMH(uint32_t profileId, int16_t msgType, WeaveConnection *con, bool allowDups,
             ExchangeContext::MessageReceiveFunct handler, void *appState);
     WEAVE_ERROR UnregisterUMH(uint32_t profileId, int16_t msgType, WeaveConnection *con);
+    UnsolicitedMessageHandler *FindUMH(uint32_t profileId, uint8_t msgType, WeaveConnection *msgCon, bool isDup);
+    void FreeUMH(UnsolicitedMessageHandler *umh);
 
     static void HandleAcceptError(WeaveMessageLayer *msgLayer, WEAVE_ERROR err);
     static void HandleMessageReceived(WeaveMessageLayer *msgLayer, WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf);
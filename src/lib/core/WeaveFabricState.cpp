@@ -65,6 +65,44 @@ using namespace nl::Weave::Profiles::FabricProvisioning;
 using namespace nl::Weave::Profiles::Security;
 using namespace nl::Weave::Profiles::Security::AppKeys;
 
+const WeaveSessionState::ReceiveFlagsType WeaveSessionState::kReceiveFlags_MessageIdSynchronized;
+const WeaveSessionState::ReceiveFlagsType WeaveSessionState::kReceiveFlags_MessageIdFlagsMask;
+const WeaveFabricState::PeerIndexType WeaveFabricState::kPeerIndexNone;
+
+// Returns the bucket in the peer state hash table for the given node id.  Node ids of peers frequently
+// differ only in a few low-order bits, so the folded id is scrambled with a multiplicative hash.
+static inline uint32_t PeerNodeIdHash(uint64_t peerNodeId)
+{
+    uint32_t hash = static_cast<uint32_t>(peerNodeId ^ (peerNodeId >> 32)) * 0x9E3779B1UL;
+
+    return (hash ^ (hash >> 16)) & (WEAVE_CONFIG_PEER_TABLE_HASH_SIZE - 1);
+}
+
+static inline uint32_t SessionKeyIdHash(uint16_t keyId)
+{
+    uint32_t hash = static_cast<uint32_t>(keyId) * 0x9E3779B1UL;
+
+    return (hash ^ (hash >> 16)) & (WEAVE_CONFIG_SESSION_KEY_TABLE_HASH_SIZE - 1);
+}
+
+// Converts message received flags to and from the 16-bit format of serialized sessions, in which the top bit
+// is the synchronized flag and the remaining bits cover the 15 messages prior to the max received message id.
+static inline uint16_t EncodeLegacyRcvFlags(WeaveSessionState::ReceiveFlagsType rcvFlags)
+{
+    if ((rcvFlags & WeaveSessionState::kReceiveFlags_MessageIdSynchronized) == 0)
+        return 0;
+
+    return static_cast<uint16_t>(0x8000 | (rcvFlags & 0x7FFF));
+}
+
+static inline WeaveSessionState::ReceiveFlagsType DecodeLegacyRcvFlags(uint16_t legacyRcvFlags)
+{
+    if ((legacyRcvFlags & 0x8000) == 0)
+        return 0;
+
+    return WeaveSessionState::kReceiveFlags_MessageIdSynchronized | (legacyRcvFlags & 0x7FFF);
+}
+
 #if WEAVE_CONFIG_SECURITY_TEST_MODE
 #pragma message "\n \
                  !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!\n \
@@ -134,6 +172,16 @@ void WeaveSessionKey::Clear(void)
     ClearSecretData((uint8_t *)&MsgEncKey.EncKey, sizeof(MsgEncKey.EncKey));
 }
 
+/**
+ * Reset a WeaveSessionResumption object.
+ */
+void WeaveSessionResumption::Clear(void)
+{
+    ClearSecretData((uint8_t *)this, sizeof(*this));
+    PeerNodeId = kNodeIdNotSpecified;
+    AuthMode = kWeaveAuthMode_NotSpecified;
+}
+
 void WeaveSessionKey::ComputeNextResumptionMsgIds(void)
 {
      // When calculating the resumption message ids, it needs to be ensured that the next resumption message id is always ahead of the current message ids.
@@ -259,7 +307,16 @@ WEAVE_ERROR WeaveFabricState::Init(GroupKeyStoreBase *groupKeyStore)
     NextUnencUDPMsgId.Init(GetRandU32());
     NextUnencTCPMsgId.Init(0);
     for (int i = 0; i < WEAVE_CONFIG_MAX_SESSION_KEYS; i++)
+    {
         SessionKeys[i].Init();
+        SessionKeyIndex.HashNext[i] = (i + 1 < WEAVE_CONFIG_MAX_SESSION_KEYS) ? i + 1 : kSessionKeyIndexNone;
+    }
+    memset(SessionKeyIndex.HashBuckets, 0xFF, sizeof(SessionKeyIndex.HashBuckets));
+    memset(SessionKeyIndex.IdleNext, 0xFF, sizeof(SessionKeyIndex.IdleNext));
+    memset(SessionKeyIndex.IdlePrev, 0xFF, sizeof(SessionKeyIndex.IdlePrev));
+    SessionKeyIndex.FreeHead = 0;
+    SessionKeyIndex.IdleHead = kSessionKeyIndexNone;
+    SessionKeyIndex.IdleTail = kSessionKeyIndexNone;
 #if WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC
     WEAVE_ERROR err = NextGroupKeyMsgId.Init(WEAVE_CONFIG_PERSISTED_STORAGE_ENC_MSG_CNTR_ID, WEAVE_CONFIG_PERSISTED_STORAGE_ENC_MSG_CNTR_EPOCH);
     if (err != WEAVE_NO_ERROR)
@@ -268,10 +325,19 @@ WEAVE_ERROR WeaveFabricState::Init(GroupKeyStoreBase *groupKeyStore)
     GroupKeyMsgIdFreshWindowStart = 0;
     MsgCounterSyncStatus = 0;
     AppKeyCache.Init();
+#if WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME > 0
+    AppKeyPrefetchTime = UINT32_MAX;
+#endif
 #endif
     memset(&PeerStates, 0, sizeof(PeerStates));
+    memset(PeerStates.HashBuckets, 0xFF, sizeof(PeerStates.HashBuckets));
+    PeerStates.MostRecentlyUsedHead = kPeerIndexNone;
+    PeerStates.MostRecentlyUsedTail = kPeerIndexNone;
     Delegate = NULL;
     memset(SharedSessionsNodes, 0, sizeof(SharedSessionsNodes));
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+    ClearSessionResumptions();
+#endif
 
 #if WEAVE_CONFIG_SECURITY_TEST_MODE
     DebugFabricId = 0;
@@ -310,13 +376,39 @@ WEAVE_ERROR WeaveFabricState::Shutdown()
     State = kState_NotInitialized;
 
 #if WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC
+#if WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME > 0
+    if (AppKeyPrefetchTime != UINT32_MAX && MessageLayer != NULL && MessageLayer->SystemLayer != NULL)
+        MessageLayer->SystemLayer->CancelTimer(HandleAppKeyPrefetchTimeout, this);
+    AppKeyPrefetchTime = UINT32_MAX;
+#endif
     AppKeyCache.Shutdown();
 #endif
 
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+    ClearSessionResumptions();
+#endif
+
     return WEAVE_NO_ERROR;
 }
 
-WEAVE_ERROR WeaveFabricState::AllocSessionKey(uint64_t peerNodeId, uint16_t keyId, WeaveConnection *boundCon, WeaveSessionKey *& sessionKey)
+/**
+ * Allocate an entry in the session key table for a session that is being established.
+ *
+ * @param[in]  peerNodeId       The id of the peer node.
+ * @param[in]  keyId            The session key id, or WeaveKeyId::kNone to choose a random one.
+ * @param[in]  boundCon         The connection to which the session is bound, or NULL.
+ * @param[out] sessionKey       A reference to a pointer to the allocated entry.
+ * @param[in]  evictIdle        Whether an idle session may be evicted if the table is full.  Only
+ *                              allocations made at the request of the local application or of an
+ *                              authenticated peer may evict, so that unauthenticated peers cannot
+ *                              push established sessions out of the table.
+ *
+ * @retval #WEAVE_ERROR_TOO_MANY_KEYS      If there is no free entry, and none could be made.
+ * @retval #WEAVE_ERROR_DUPLICATE_KEY_ID   If a session with the given key id and peer exists.
+ * @retval #WEAVE_NO_ERROR                 On success.
+ */
+WEAVE_ERROR WeaveFabricState::AllocSessionKey(uint64_t peerNodeId, uint16_t keyId, WeaveConnection *boundCon, WeaveSessionKey *& sessionKey,
+                                              bool evictIdle)
 {
     WEAVE_ERROR err;
     bool chooseRandomKeyId = (keyId == WeaveKeyId::kNone);
@@ -326,6 +418,8 @@ WEAVE_ERROR WeaveFabricState::AllocSessionKey(uint64_t peerNodeId, uint16_t keyI
         if (chooseRandomKeyId)
             keyId = WeaveKeyId::MakeSessionKeyId(GetRandU16());
         err = FindSessionKey(keyId, peerNodeId, true, sessionKey);
+        if (err == WEAVE_ERROR_TOO_MANY_KEYS && evictIdle && EvictIdleSessionKey())
+            continue;
         if (err != WEAVE_NO_ERROR)
             return err;
         if (!sessionKey->IsAllocated())
@@ -336,6 +430,7 @@ WEAVE_ERROR WeaveFabricState::AllocSessionKey(uint64_t peerNodeId, uint16_t keyI
 
     sessionKey->MsgEncKey.KeyId = keyId;
     sessionKey->NodeId = peerNodeId;
+    IndexSessionKey(sessionKey);
     sessionKey->MsgEncKey.EncType = kWeaveEncryptionType_None;
     sessionKey->NextMsgId.Init(UINT32_MAX);
     sessionKey->MaxRcvdMsgId = UINT32_MAX;
@@ -422,10 +517,102 @@ void WeaveFabricState::RemoveSessionKey(WeaveSessionKey *sessionKey, bool wasIdl
     WeaveLogDetail(MessageLayer, "Removing %ssession key: Id=%04" PRIX16 " Peer=%016" PRIX64,
             (wasIdle) ? "idle " : "", sessionKey->MsgEncKey.KeyId, sessionKey->NodeId);
 
+    SessionKeyIndexType keyIndex = static_cast<SessionKeyIndexType>(sessionKey - SessionKeys);
+    SessionKeyIndexType *link = &SessionKeyIndex.HashBuckets[SessionKeyIdHash(sessionKey->MsgEncKey.KeyId)];
+
     RemoveSharedSessionEndNodes(sessionKey);
+
+    // Unlink the entry from its hash chain and from the idle list, and return it to the free list.
+    while (*link != kSessionKeyIndexNone)
+    {
+        if (*link == keyIndex)
+        {
+            *link = SessionKeyIndex.HashNext[keyIndex];
+            break;
+        }
+        link = &SessionKeyIndex.HashNext[*link];
+    }
+    UnlinkSessionKeyIdle(keyIndex);
+    SessionKeyIndex.HashNext[keyIndex] = SessionKeyIndex.FreeHead;
+    SessionKeyIndex.FreeHead = keyIndex;
+
     sessionKey->Clear();
 }
 
+/**
+ * Add a newly allocated session key to the session key table index.
+ *
+ * The entry must be the one most recently returned by FindSessionKey() for creation, and
+ * its key id must have been set.
+ */
+void WeaveFabricState::IndexSessionKey(WeaveSessionKey *sessionKey)
+{
+    SessionKeyIndexType keyIndex = static_cast<SessionKeyIndexType>(sessionKey - SessionKeys);
+    SessionKeyIndexType * const bucket = &SessionKeyIndex.HashBuckets[SessionKeyIdHash(sessionKey->MsgEncKey.KeyId)];
+
+    VerifyOrDie(SessionKeyIndex.FreeHead == keyIndex);
+
+    SessionKeyIndex.FreeHead = SessionKeyIndex.HashNext[keyIndex];
+    SessionKeyIndex.HashNext[keyIndex] = *bucket;
+    *bucket = keyIndex;
+}
+
+/**
+ * Record that a session key is no longer reserved.
+ *
+ * Unreserved session keys are kept in a list ordered from most- to least- recently released,
+ * which RemoveIdleSessionKeys() walks instead of scanning the whole table, and from which
+ * FindSessionKey() evicts when the table is full.
+ *
+ * @param[in]  sessionKey       A pointer to the session key that was released.
+ */
+void WeaveFabricState::MarkSessionKeyIdle(WeaveSessionKey *sessionKey)
+{
+    SessionKeyIndexType keyIndex = static_cast<SessionKeyIndexType>(sessionKey - SessionKeys);
+
+    UnlinkSessionKeyIdle(keyIndex);
+
+    SessionKeyIndex.IdleNext[keyIndex] = SessionKeyIndex.IdleHead;
+    if (SessionKeyIndex.IdleHead != kSessionKeyIndexNone)
+        SessionKeyIndex.IdlePrev[SessionKeyIndex.IdleHead] = keyIndex;
+    else
+        SessionKeyIndex.IdleTail = keyIndex;
+    SessionKeyIndex.IdleHead = keyIndex;
+}
+
+/**
+ * Record that a session key has been reserved.
+ *
+ * @param[in]  sessionKey       A pointer to the session key that was reserved.
+ */
+void WeaveFabricState::ClearSessionKeyIdle(WeaveSessionKey *sessionKey)
+{
+    UnlinkSessionKeyIdle(static_cast<SessionKeyIndexType>(sessionKey - SessionKeys));
+}
+
+void WeaveFabricState::UnlinkSessionKeyIdle(SessionKeyIndexType keyIndex)
+{
+    SessionKeyIndexType next = SessionKeyIndex.IdleNext[keyIndex];
+    SessionKeyIndexType prev = SessionKeyIndex.IdlePrev[keyIndex];
+
+    // Ignore entries that are not in the list.
+    if (prev == kSessionKeyIndexNone && SessionKeyIndex.IdleHead != keyIndex)
+        return;
+
+    if (prev != kSessionKeyIndexNone)
+        SessionKeyIndex.IdleNext[prev] = next;
+    else
+        SessionKeyIndex.IdleHead = next;
+
+    if (next != kSessionKeyIndexNone)
+        SessionKeyIndex.IdlePrev[next] = prev;
+    else
+        SessionKeyIndex.IdleTail = prev;
+
+    SessionKeyIndex.IdleNext[keyIndex] = kSessionKeyIndexNone;
+    SessionKeyIndex.IdlePrev[keyIndex] = kSessionKeyIndexNone;
+}
+
 WEAVE_ERROR WeaveFabricState::GetSessionKey(uint16_t keyId, uint64_t peerNodeId, WeaveSessionKey *& outSessionKey)
 {
     return FindSessionKey(keyId, peerNodeId, false, outSessionKey);
@@ -638,6 +825,115 @@ void WeaveFabricState::RemoveSharedSessionEndNodes(const WeaveSessionKey *sessio
     }
 }
 
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+
+/**
+ * Save the resumption id and secret of a CASE session with a peer node.
+ *
+ * Any resumption secret previously saved for the peer is replaced.  If no entry is free,
+ * the least recently used entry is evicted.
+ *
+ * @param[in] peerNodeId        The id of the peer node.
+ * @param[in] authMode          The means by which the peer was authenticated.
+ * @param[in] resumptionId      The resumption id, WeaveSessionResumption::kResumptionIdLength bytes long.
+ * @param[in] secret            The resumption secret, WeaveSessionResumption::kSecretLength bytes long.
+ */
+void WeaveFabricState::SaveSessionResumption(uint64_t peerNodeId, WeaveAuthMode authMode, const uint8_t *resumptionId,
+                                             const uint8_t *secret)
+{
+    WeaveSessionResumption *resumption = FindSessionResumption(peerNodeId);
+    uint8_t index;
+
+    // If there is no entry for the peer, use a free entry or, failing that, the least recently used one.
+    if (resumption == NULL)
+    {
+        for (index = 0; index < WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE; index++)
+            if (!SessionResumptions[index].IsAllocated())
+                break;
+
+        if (index == WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE)
+            index = MostRecentlyUsedResumptions[WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE - 1];
+
+        resumption = &SessionResumptions[index];
+        TouchSessionResumption(index);
+    }
+
+    resumption->PeerNodeId = peerNodeId;
+    resumption->AuthMode = authMode;
+    memcpy(resumption->ResumptionId, resumptionId, WeaveSessionResumption::kResumptionIdLength);
+    memcpy(resumption->Secret, secret, WeaveSessionResumption::kSecretLength);
+}
+
+/**
+ * Find the resumption secret saved for a peer node.
+ *
+ * @return A pointer to the entry for the peer, or NULL if there is none.
+ */
+WeaveSessionResumption *WeaveFabricState::FindSessionResumption(uint64_t peerNodeId)
+{
+    for (uint8_t i = 0; i < WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE; i++)
+    {
+        if (SessionResumptions[i].IsAllocated() && SessionResumptions[i].PeerNodeId == peerNodeId)
+        {
+            TouchSessionResumption(i);
+            return &SessionResumptions[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Find the resumption secret saved for a peer node under a given resumption id.
+ *
+ * @return A pointer to the matching entry, or NULL if there is none.
+ */
+WeaveSessionResumption *WeaveFabricState::FindSessionResumption(uint64_t peerNodeId, const uint8_t *resumptionId)
+{
+    WeaveSessionResumption *resumption = FindSessionResumption(peerNodeId);
+
+    if (resumption != NULL &&
+        !ConstantTimeCompare(resumption->ResumptionId, resumptionId, WeaveSessionResumption::kResumptionIdLength))
+        resumption = NULL;
+
+    return resumption;
+}
+
+/**
+ * Remove a resumption secret from the cache.
+ */
+void WeaveFabricState::RemoveSessionResumption(WeaveSessionResumption *resumption)
+{
+    resumption->Clear();
+}
+
+/**
+ * Remove all resumption secrets from the cache.
+ */
+void WeaveFabricState::ClearSessionResumptions(void)
+{
+    for (uint8_t i = 0; i < WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE; i++)
+    {
+        SessionResumptions[i].Clear();
+        MostRecentlyUsedResumptions[i] = i;
+    }
+}
+
+// Move a resumption entry to the top of the most-recently used list.
+void WeaveFabricState::TouchSessionResumption(uint8_t index)
+{
+    uint8_t i;
+
+    for (i = 0; i < WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE - 1; i++)
+        if (MostRecentlyUsedResumptions[i] == index)
+            break;
+
+    memmove(&MostRecentlyUsedResumptions[1], &MostRecentlyUsedResumptions[0], i * sizeof(uint8_t));
+    MostRecentlyUsedResumptions[0] = index;
+}
+
+#endif // WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+
 /**
  * Suspend and serialize the state of an active Weave security session.
  *
@@ -681,7 +977,9 @@ WEAVE_ERROR WeaveFabricState::SuspendSession(uint16_t keyId, uint64_t peerNodeId
         SuccessOrExit(err);
         err = writer.Put(ContextTag(kTag_SerializedSession_MaxRcvdMessageId), sessionKey->MaxRcvdMsgId);
         SuccessOrExit(err);
-        err = writer.Put(ContextTag(kTag_SerializedSession_MessageRcvdFlags), sessionKey->RcvFlags);
+        // The message received flags are encoded in the original 16-bit format, which older implementations
+        // expect; a wider receive window may also be encoded in full at the end of the structure.
+        err = writer.Put(ContextTag(kTag_SerializedSession_MessageRcvdFlags), EncodeLegacyRcvFlags(sessionKey->RcvFlags));
         SuccessOrExit(err);
         err = writer.PutBoolean(ContextTag(kTag_SerializedSession_IsLocallyInitiated), sessionKey->IsLocallyInitiated());
         SuccessOrExit(err);
@@ -757,6 +1055,17 @@ WEAVE_ERROR WeaveFabricState::SuspendSession(uint16_t keyId, uint64_t peerNodeId
                                 sessionKey->IsUsedOverConnection());
         SuccessOrExit(err);
 
+#if WEAVE_CONFIG_MSG_COUNTER_WINDOW_SIZE > 16
+        // Older implementations reject any further element, so the full window is only encoded if it holds
+        // flags that the 16-bit format cannot.
+        if ((sessionKey->RcvFlags & WeaveSessionState::kReceiveFlags_MessageIdFlagsMask & ~static_cast<WeaveSessionState::ReceiveFlagsType>(0x7FFF)) != 0)
+        {
+            err = writer.Put(ContextTag(kTag_SerializedSession_ExtendedMessageRcvdFlags),
+                             static_cast<uint64_t>(sessionKey->RcvFlags & WeaveSessionState::kReceiveFlags_MessageIdFlagsMask));
+            SuccessOrExit(err);
+        }
+#endif
+
         // End the Security:SerializedSession TLV structure and finalize the encoding.
         err = writer.EndContainer(container);
         SuccessOrExit(err);
@@ -814,13 +1123,17 @@ WEAVE_ERROR WeaveFabricState::RestoreSession(uint8_t * serializedSession, uint16
     err = reader.Get(peerNodeId);
     SuccessOrExit(err);
 
-    // Look for / create a session key entry for the given key id and peer node.
+    // Look for / create a session key entry for the given key id and peer node, evicting an idle
+    // session if need be.
     err = FindSessionKey(keyId, peerNodeId, true, sessionKey);
+    if (err == WEAVE_ERROR_TOO_MANY_KEYS && EvictIdleSessionKey())
+        err = FindSessionKey(keyId, peerNodeId, true, sessionKey);
     SuccessOrExit(err);
     if (!sessionKey->IsAllocated())
     {
         sessionKey->MsgEncKey.KeyId = keyId;
         sessionKey->NodeId = peerNodeId;
+        IndexSessionKey(sessionKey);
         sessionKey->BoundCon = NULL;
         sessionKey->ReserveCount = 0;
         sessionKey->Flags = 0;
@@ -832,6 +1145,8 @@ WEAVE_ERROR WeaveFabricState::RestoreSession(uint8_t * serializedSession, uint16
     }
     sessionKey->SetRemoveOnIdle(true);
     sessionKey->MarkRecentlyActive();
+    if (sessionKey->ReserveCount == 0)
+        MarkSessionKeyIdle(sessionKey);
 
     // After this point, if an error occurs, remove the session key.
     removeSessionOnError = true;
@@ -856,10 +1171,14 @@ WEAVE_ERROR WeaveFabricState::RestoreSession(uint8_t * serializedSession, uint16
     SuccessOrExit(err);
     err = reader.Get(sessionKey->MaxRcvdMsgId);
     SuccessOrExit(err);
-    err = reader.Next(kTLVType_UnsignedInteger, ContextTag(kTag_SerializedSession_MessageRcvdFlags));
-    SuccessOrExit(err);
-    err = reader.Get(sessionKey->RcvFlags);
-    SuccessOrExit(err);
+    {
+        uint16_t legacyRcvFlags;
+        err = reader.Next(kTLVType_UnsignedInteger, ContextTag(kTag_SerializedSession_MessageRcvdFlags));
+        SuccessOrExit(err);
+        err = reader.Get(legacyRcvFlags);
+        SuccessOrExit(err);
+        sessionKey->RcvFlags = DecodeLegacyRcvFlags(legacyRcvFlags);
+    }
     {
         bool b;
         err = reader.Next(kTLVType_Boolean, ContextTag(kTag_SerializedSession_IsLocallyInitiated));
@@ -979,6 +1298,29 @@ WEAVE_ERROR WeaveFabricState::RestoreSession(uint8_t * serializedSession, uint16
 
     sessionKey->SetUsedOverConnection(usedOverConnection);
 
+    // If the session was serialized with a receive window wider than 16 messages, restore as much of the
+    // window as fits; the flags of older messages are dropped.
+    err = reader.Next();
+    if (err != WEAVE_END_OF_TLV)
+    {
+        uint64_t extendedRcvFlags;
+
+        SuccessOrExit(err);
+        VerifyOrExit(reader.GetTag() == ContextTag(kTag_SerializedSession_ExtendedMessageRcvdFlags), err = WEAVE_ERROR_UNEXPECTED_TLV_ELEMENT);
+        err = reader.Get(extendedRcvFlags);
+        SuccessOrExit(err);
+
+        if (sessionKey->RcvFlags & WeaveSessionState::kReceiveFlags_MessageIdSynchronized)
+        {
+            sessionKey->RcvFlags = WeaveSessionState::kReceiveFlags_MessageIdSynchronized |
+                (static_cast<WeaveSessionState::ReceiveFlagsType>(extendedRcvFlags) & WeaveSessionState::kReceiveFlags_MessageIdFlagsMask);
+        }
+
+        // Verify no other data in the serialized session structure.
+        err = reader.VerifyEndOfContainer();
+        SuccessOrExit(err);
+    }
+
     // If a connection object has been passed to be bound to a restored session,
     // ensure that the AuthMode is CASE and the resumed session was previously
     // used over a connection.
@@ -991,9 +1333,6 @@ WEAVE_ERROR WeaveFabricState::RestoreSession(uint8_t * serializedSession, uint16
         con->PeerNodeId = sessionKey->NodeId;
     }
 
-    // Verify no other data in the serialized session structure.
-    err = reader.VerifyEndOfContainer();
-    SuccessOrExit(err);
     err = reader.ExitContainer(container);
     SuccessOrExit(err);
 
@@ -1346,13 +1685,12 @@ exit:
  */
 bool WeaveFabricState::FindOrAllocPeerEntry(uint64_t peerNodeId, bool allocEntry, PeerIndexType& retPeerIndex)
 {
-    uint16_t i;
+    PeerIndexType * const bucket = &PeerStates.HashBuckets[PeerNodeIdHash(peerNodeId)];
     bool retVal = false;
 
     // Find peer entry in the peer state table.
-    for (i = 0; i < PeerCount; i++)
+    for (retPeerIndex = *bucket; retPeerIndex != kPeerIndexNone; retPeerIndex = PeerStates.HashNext[retPeerIndex])
     {
-        retPeerIndex = PeerStates.MostRecentlyUsedIndexes[i];
         if (PeerStates.NodeId[retPeerIndex] == peerNodeId)
         {
             retVal = true;
@@ -1360,8 +1698,14 @@ bool WeaveFabricState::FindOrAllocPeerEntry(uint64_t peerNodeId, bool allocEntry
         }
     }
 
+    // If found, unlink the entry from the most recently used list; it is relinked at the head below.
+    if (retVal)
+    {
+        UnlinkPeerEntry(retPeerIndex, false);
+    }
+
     // If peer entry is not found in the peer state table and allocation was requested.
-    if (!retVal && allocEntry)
+    else if (allocEntry)
     {
         // If PeerStates table is full then the least recently used entry is discarded
         // and allocated for the new peer node. The replacement algorithms tries to find
@@ -1370,33 +1714,31 @@ bool WeaveFabricState::FindOrAllocPeerEntry(uint64_t peerNodeId, bool allocEntry
         if (PeerCount == WEAVE_CONFIG_MAX_PEER_NODES)
         {
             // Choose the least recently used peer entry by default.
-            i = WEAVE_CONFIG_MAX_PEER_NODES - 1;
+            retPeerIndex = PeerStates.MostRecentlyUsedTail;
 
 #if WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC
             // Try to find the least recently used peer entry that didn't use encryption.
-            for (int j = WEAVE_CONFIG_MAX_PEER_NODES - 1; j >= 0; j--)
+            for (PeerIndexType peerInd = PeerStates.MostRecentlyUsedTail; peerInd != kPeerIndexNone; peerInd = PeerStates.MostRecentlyUsedPrev[peerInd])
             {
-                PeerIndexType peerInd = PeerStates.MostRecentlyUsedIndexes[j];
                 if ((PeerStates.GroupKeyRcvFlags[peerInd] & WeaveSessionState::kReceiveFlags_MessageIdSynchronized) == 0)
                 {
-                    i = j;
+                    retPeerIndex = peerInd;
                     break;
                 }
             }
 #endif
 
-            // The peer index chosen for replacement.
-            retPeerIndex = PeerStates.MostRecentlyUsedIndexes[i];
+            // Discard the peer entry chosen for replacement.
+            UnlinkPeerEntry(retPeerIndex, true);
         }
 
-        // If PeerStates table is not full then the next available entry is "i".
+        // If PeerStates table is not full then the next available entry is allocated.
         // Entries in the table are allocated sequentially and never discarded until
         // the table is full. Only when table is full the least recently used entry
         // is discarded and replaced with the new entry.
         else
         {
-            PeerCount++;
-            retPeerIndex = i;
+            retPeerIndex = PeerCount++;
         }
 
         PeerStates.NodeId[retPeerIndex] = peerNodeId;
@@ -1406,21 +1748,64 @@ bool WeaveFabricState::FindOrAllocPeerEntry(uint64_t peerNodeId, bool allocEntry
         PeerStates.GroupKeyRcvFlags[retPeerIndex] = 0;
 #endif
         PeerStates.UnencRcvFlags[retPeerIndex] = 0;
+
+        // Link the new entry into the hash chain for its node id.
+        PeerStates.HashNext[retPeerIndex] = *bucket;
+        *bucket = retPeerIndex;
+
         retVal = true;
     }
 
-    // Move the requested entry to the top of the most recently used indexes list.
+    // Move the requested entry to the head of the most recently used list.
     if (retVal)
     {
-        memmove(&PeerStates.MostRecentlyUsedIndexes[1],
-                &PeerStates.MostRecentlyUsedIndexes[0],
-                i * sizeof(PeerIndexType));
-        PeerStates.MostRecentlyUsedIndexes[0] = retPeerIndex;
+        PeerStates.MostRecentlyUsedPrev[retPeerIndex] = kPeerIndexNone;
+        PeerStates.MostRecentlyUsedNext[retPeerIndex] = PeerStates.MostRecentlyUsedHead;
+        if (PeerStates.MostRecentlyUsedHead != kPeerIndexNone)
+            PeerStates.MostRecentlyUsedPrev[PeerStates.MostRecentlyUsedHead] = retPeerIndex;
+        else
+            PeerStates.MostRecentlyUsedTail = retPeerIndex;
+        PeerStates.MostRecentlyUsedHead = retPeerIndex;
     }
 
     return retVal;
 }
 
+/**
+ * This method unlinks a peer entry from the most recently used list and, optionally, from the hash
+ * chain for its node id.
+ *
+ * @param[in]  peerIndex        Index to the peer entry in the peer state table.
+ * @param[in]  removeFromHash   Whether the entry should also be removed from its hash chain, e.g. because
+ *                              it is about to be reallocated for another peer.
+ *
+ */
+void WeaveFabricState::UnlinkPeerEntry(PeerIndexType peerIndex, bool removeFromHash)
+{
+    const PeerIndexType prev = PeerStates.MostRecentlyUsedPrev[peerIndex];
+    const PeerIndexType next = PeerStates.MostRecentlyUsedNext[peerIndex];
+
+    if (prev != kPeerIndexNone)
+        PeerStates.MostRecentlyUsedNext[prev] = next;
+    else
+        PeerStates.MostRecentlyUsedHead = next;
+
+    if (next != kPeerIndexNone)
+        PeerStates.MostRecentlyUsedPrev[next] = prev;
+    else
+        PeerStates.MostRecentlyUsedTail = prev;
+
+    if (removeFromHash)
+    {
+        PeerIndexType * link = &PeerStates.HashBuckets[PeerNodeIdHash(PeerStates.NodeId[peerIndex])];
+
+        while (*link != peerIndex)
+            link = &PeerStates.HashNext[*link];
+
+        *link = PeerStates.HashNext[peerIndex];
+    }
+}
+
 /*
  * This method is used by provisioning servers to register callbacks with the
  * WeaveFabricState to be notified when the current session is closed.
@@ -1559,6 +1944,11 @@ void WeaveFabricState::ClearFabricState()
     FabricId = kFabricIdNotSpecified;
     GroupKeyStore->Clear();
 
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+    // Sessions established within the old fabric must not be resumed.
+    ClearSessionResumptions();
+#endif
+
     if (oldFabricId != kFabricIdNotSpecified)
     {
         if (Delegate != NULL)
@@ -1891,8 +2281,8 @@ bool WeaveSessionState::IsDuplicateMessage(uint32_t msgId)
     {
         // Shift the message received flags by the delta (or simply set the flags to zero if the delta is larger
         // than the number of flags).
-        if (delta < kReceiveFlags_NumMessageIdFlags)
-            msgIdFlags = ((msgIdFlags << 1) | 1) << (delta - 1);
+        if (delta <= kReceiveFlags_NumMessageIdFlags)
+            msgIdFlags = (((msgIdFlags << 1) | 1) << (delta - 1)) & kReceiveFlags_MessageIdFlagsMask;
         else
             msgIdFlags = 0;
 
@@ -1914,7 +2304,7 @@ bool WeaveSessionState::IsDuplicateMessage(uint32_t msgId)
         // and check if the message has already been received. If not, set the corresponding flag.
         if (delta <= kReceiveFlags_NumMessageIdFlags)
         {
-            ReceiveFlagsType mask = 1 << (delta - 1);
+            ReceiveFlagsType mask = static_cast<ReceiveFlagsType>(1) << (delta - 1);
             if ((msgIdFlags & mask) == 0)
                 msgIdFlags |= mask;
             else {
@@ -1968,8 +2358,7 @@ exit:
  */
 WEAVE_ERROR WeaveFabricState::FindSessionKey(uint16_t keyId, uint64_t peerNodeId, bool create, WeaveSessionKey *& retRec)
 {
-    WeaveSessionKey *curRec = SessionKeys;
-    WeaveSessionKey *freeRec = NULL;
+    SessionKeyIndexType keyIndex;
 
     if (!WeaveKeyId::IsSessionKey(keyId))
         return WEAVE_ERROR_WRONG_KEY_TYPE;
@@ -1977,16 +2366,16 @@ WEAVE_ERROR WeaveFabricState::FindSessionKey(uint16_t keyId, uint64_t peerNodeId
     if (peerNodeId == kNodeIdNotSpecified || peerNodeId == kAnyNodeId)
         return WEAVE_ERROR_INVALID_ARGUMENT;
 
-    for (int i = 0; i < WEAVE_CONFIG_MAX_SESSION_KEYS; i++, curRec++)
+    // Search the hash chain for the key id.  The chain is keyed on the key id alone because a shared
+    // session also matches the ids of its alternate end nodes.
+    for (keyIndex = SessionKeyIndex.HashBuckets[SessionKeyIdHash(keyId)]; keyIndex != kSessionKeyIndexNone;
+         keyIndex = SessionKeyIndex.HashNext[keyIndex])
     {
-        if (!curRec->IsAllocated())
-        {
-            if (freeRec == NULL)
-                freeRec = curRec;
-        }
-        else if (curRec->MsgEncKey.KeyId == keyId &&
-                 (curRec->NodeId == peerNodeId ||
-                  (curRec->IsSharedSession() && FindSharedSessionEndNode(peerNodeId, curRec))))
+        WeaveSessionKey *curRec = &SessionKeys[keyIndex];
+
+        if (curRec->MsgEncKey.KeyId == keyId &&
+            (curRec->NodeId == peerNodeId ||
+             (curRec->IsSharedSession() && FindSharedSessionEndNode(peerNodeId, curRec))))
         {
             retRec = curRec;
             return WEAVE_NO_ERROR;
@@ -1996,14 +2385,37 @@ WEAVE_ERROR WeaveFabricState::FindSessionKey(uint16_t keyId, uint64_t peerNodeId
     if (!create)
         return WEAVE_ERROR_KEY_NOT_FOUND;
 
-    if (freeRec == NULL)
+    if (SessionKeyIndex.FreeHead == kSessionKeyIndexNone)
         return WEAVE_ERROR_TOO_MANY_KEYS;
 
-    retRec = freeRec;
+    retRec = &SessionKeys[SessionKeyIndex.FreeHead];
 
     return WEAVE_NO_ERROR;
 }
 
+/**
+ * Remove the least recently released session that would otherwise be removed once it goes idle,
+ * to make room in a full session key table.
+ *
+ * @return true if a session was removed.
+ */
+bool WeaveFabricState::EvictIdleSessionKey(void)
+{
+    for (SessionKeyIndexType keyIndex = SessionKeyIndex.IdleTail; keyIndex != kSessionKeyIndexNone;
+         keyIndex = SessionKeyIndex.IdlePrev[keyIndex])
+    {
+        WeaveSessionKey *curRec = &SessionKeys[keyIndex];
+
+        if (curRec->IsKeySet() && curRec->BoundCon == NULL && curRec->IsRemoveOnIdle() && curRec->ReserveCount == 0)
+        {
+            RemoveSessionKey(curRec, true);
+            return true;
+        }
+    }
+
+    return false;
+}
+
 #if WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC
 WEAVE_ERROR WeaveFabricState::FindMsgEncAppKey(uint16_t keyId, uint8_t encType, WeaveMsgEncryptionKey *& retRec)
 {
@@ -2028,12 +2440,159 @@ WEAVE_ERROR WeaveFabricState::FindMsgEncAppKey(uint16_t keyId, uint8_t encType,
             WeaveLogDetail(MessageLayer, "Message Encryption Key: Id=%04" PRIX16 " Type=GroupKey(%08" PRIX32 ") EncType=%02" PRIX8 " Key=%s", keyId, appGroupGlobalId, encType, keyString);
         }
 #endif
+
+#if WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME > 0
+        // Arrange for the key of the following epoch to be derived by the prefetch timer shortly
+        // before that epoch starts.
+        if (WeaveKeyId::IsAppRotatingKey(keyId))
+        {
+            uint32_t now = GetAppKeyPrefetchClock();
+            uint32_t nextPrefetchTime = UINT32_MAX;
+
+            PrefetchMsgEncAppKey(keyId, encType, now, nextPrefetchTime, false);
+            StartAppKeyPrefetchTimer(nextPrefetchTime, now);
+        }
+#endif
     }
 
 exit:
     return err;
 }
 
+#if WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME > 0
+
+// Returns the current UTC time in seconds, or 0 if it is not known.
+uint32_t WeaveFabricState::GetAppKeyPrefetchClock(void)
+{
+    uint32_t now;
+
+    if (GroupKeyStore->GetCurrentUTCTime(now) != WEAVE_NO_ERROR)
+        now = 0;
+
+    return now;
+}
+
+/**
+ * Derive and cache the message encryption key of the epoch that follows the epoch of a rotating
+ * application key, if that epoch starts within #WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME
+ * seconds.
+ *
+ * @param[in]    keyId              The rotating application key ID.
+ * @param[in]    encType            The message encryption type.
+ * @param[in]    now                The current UTC time, or 0 if it is not known.
+ * @param[inout] nextPrefetchTime   The UTC time at which keys should next be prefetched.  It is
+ *                                  lowered if this key needs to be revisited before then.
+ * @param[in]    deriveKey          Whether the key is derived if it is due, rather than only
+ *                                  accounted for in nextPrefetchTime.
+ */
+void WeaveFabricState::PrefetchMsgEncAppKey(uint16_t keyId, uint8_t encType, uint32_t now, uint32_t& nextPrefetchTime,
+                                            bool deriveKey)
+{
+    uint32_t nextEpochKeyId;
+    uint32_t nextStartTime;
+    uint32_t prefetchTime;
+
+    // Keys are only prefetched by the timer, which needs a clock.
+    if (now == 0)
+        return;
+
+    // Nothing to do if there is no later epoch key, or if it has already started.
+    if (GroupKeyStore->GetNextEpochKeyId(keyId, nextEpochKeyId, nextStartTime) != WEAVE_NO_ERROR)
+        return;
+    if (nextStartTime <= now)
+        return;
+
+    prefetchTime = (nextStartTime > WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME) ?
+                   nextStartTime - WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME : 0;
+
+    if (prefetchTime <= now && deriveKey)
+    {
+        uint16_t nextKeyId = static_cast<uint16_t>(WeaveKeyId::UpdateEpochKeyId(keyId, nextEpochKeyId));
+
+        if (!AppKeyCache.IsKeyCached(nextKeyId, encType))
+        {
+            WeaveMsgEncryptionKey appKey;
+            uint32_t appGroupGlobalId;
+
+            // Only take a cache entry once the key has been derived, so that a failed derivation
+            // does not displace a cached key.
+            if (DeriveMsgEncAppKey(nextKeyId, encType, appKey, appGroupGlobalId) == WEAVE_NO_ERROR)
+            {
+                *AppKeyCache.FindOrAllocateKeyEntry(nextKeyId, encType) = appKey;
+                WeaveLogDetail(MessageLayer, "Prefetched message encryption key: Id=%04" PRIX16, nextKeyId);
+            }
+
+            ClearSecretData(reinterpret_cast<uint8_t *>(&appKey.EncKey), sizeof(appKey.EncKey));
+        }
+
+        // Once the next epoch has started, its keys are the current ones, and the keys of the epoch
+        // after it can be prefetched.
+        prefetchTime = (nextStartTime != UINT32_MAX) ? nextStartTime + 1 : UINT32_MAX;
+    }
+
+    if (prefetchTime < nextPrefetchTime)
+        nextPrefetchTime = prefetchTime;
+}
+
+// Prefetch the next-epoch keys of all rotating application keys in the key cache.
+void WeaveFabricState::PrefetchMsgEncAppKeys(void)
+{
+    uint16_t keyIds[WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS];
+    uint8_t encTypes[WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS];
+    uint8_t keyCount = 0;
+    uint32_t now = GetAppKeyPrefetchClock();
+    uint32_t nextPrefetchTime = UINT32_MAX;
+
+    // Prefetching adds entries to the cache, so take a copy of the key ids to visit first.
+    for (uint8_t i = 0; i < WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS; i++)
+    {
+        const WeaveMsgEncryptionKey *keyEntry = AppKeyCache.GetKeyEntry(i);
+
+        if (WeaveKeyId::IsAppRotatingKey(keyEntry->KeyId))
+        {
+            keyIds[keyCount] = keyEntry->KeyId;
+            encTypes[keyCount] = keyEntry->EncType;
+            keyCount++;
+        }
+    }
+
+    for (uint8_t i = 0; i < keyCount; i++)
+        PrefetchMsgEncAppKey(keyIds[i], encTypes[i], now, nextPrefetchTime, true);
+
+    StartAppKeyPrefetchTimer(nextPrefetchTime, now);
+}
+
+// Arm the prefetch timer to expire at the specified UTC time, unless it is already due to expire sooner.
+void WeaveFabricState::StartAppKeyPrefetchTimer(uint32_t prefetchTime, uint32_t now)
+{
+    uint32_t delay;
+
+    // Without a clock or a system layer, keys are not prefetched.
+    VerifyOrExit(prefetchTime != UINT32_MAX && now != 0, );
+    VerifyOrExit(MessageLayer != NULL && MessageLayer->SystemLayer != NULL, );
+    VerifyOrExit(AppKeyPrefetchTime == UINT32_MAX || AppKeyPrefetchTime > prefetchTime, );
+
+    delay = (prefetchTime > now) ? prefetchTime - now : 0;
+    if (delay > UINT32_MAX / 1000)
+        delay = UINT32_MAX / 1000;
+
+    if (MessageLayer->SystemLayer->StartTimer(delay * 1000, HandleAppKeyPrefetchTimeout, this) == WEAVE_SYSTEM_NO_ERROR)
+        AppKeyPrefetchTime = prefetchTime;
+
+exit:
+    return;
+}
+
+void WeaveFabricState::HandleAppKeyPrefetchTimeout(System::Layer* aSystemLayer, void* aAppState, System::Error aError)
+{
+    WeaveFabricState* fabricState = reinterpret_cast<WeaveFabricState*>(aAppState);
+
+    fabricState->AppKeyPrefetchTime = UINT32_MAX;
+    fabricState->PrefetchMsgEncAppKeys();
+}
+
+#endif // WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME > 0
+
 /**
  * Derives message encryption application key.
  * Three types of message encryption application keys can be requested: current application
@@ -2104,45 +2663,47 @@ void WeaveFabricState::SetDelegate(FabricStateDelegate *aDelegate)
 
 bool WeaveFabricState::RemoveIdleSessionKeys()
 {
-    WeaveSessionKey *sessionKey;
+    SessionKeyIndexType keyIndex, nextIndex;
     bool potentialIdleSessionsExist = false;
 
-    // For each allocated session key...
-    sessionKey = SessionKeys;
-    for (int i = 0; i < WEAVE_CONFIG_MAX_SESSION_KEYS; i++, sessionKey++)
-        if (sessionKey->IsAllocated())
-        {
-            // Ignore the session if it is still in the process of being established.
-            if (!sessionKey->IsKeySet())
-                continue;
+    // For each unreserved session key...
+    for (keyIndex = SessionKeyIndex.IdleHead; keyIndex != kSessionKeyIndexNone; keyIndex = nextIndex)
+    {
+        WeaveSessionKey *sessionKey = &SessionKeys[keyIndex];
+
+        nextIndex = SessionKeyIndex.IdleNext[keyIndex];
+
+        // Ignore the session if it is still in the process of being established.
+        if (!sessionKey->IsKeySet())
+            continue;
 
-            // Capture and clear the recently active flag.
-            bool recentlyActive = sessionKey->IsRecentlyActive();
-            sessionKey->ClearRecentlyActive();
+        // Capture and clear the recently active flag.
+        bool recentlyActive = sessionKey->IsRecentlyActive();
+        sessionKey->ClearRecentlyActive();
 
-            // Ignore the session if it is bound to a connection. (Connection bound
-            // sessions persist until their connections close).
-            if (sessionKey->BoundCon != NULL)
-                continue;
+        // Ignore the session if it is bound to a connection. (Connection bound
+        // sessions persist until their connections close).
+        if (sessionKey->BoundCon != NULL)
+            continue;
 
-            // If the session is marked for remove-on-idle and is not currently reserved...
-            if (sessionKey->IsRemoveOnIdle() && sessionKey->ReserveCount == 0)
+        // If the session is marked for remove-on-idle...
+        if (sessionKey->IsRemoveOnIdle())
+        {
+            // Remove the session if it hasn't been active since the last time RemoveIdleSessionKeys()
+            // was called.
+            if (!recentlyActive)
             {
-                // Remove the session if it hasn't been active since the last time RemoveIdleSessionKeys()
-                // was called.
-                if (!recentlyActive)
-                {
-                    RemoveSessionKey(sessionKey, true);
-                }
+                RemoveSessionKey(sessionKey, true);
+            }
 
-                // Otherwise, tell the caller that unreserved, remove-on-idle sessions exist which may
-                // need to be removed on a future call to RemoveIdleSessionKeys().
-                else
-                {
-                    potentialIdleSessionsExist = true;
-                }
+            // Otherwise, tell the caller that unreserved, remove-on-idle sessions exist which may
+            // need to be removed on a future call to RemoveIdleSessionKeys().
+            else
+            {
+                potentialIdleSessionsExist = true;
             }
         }
+    }
 
     return potentialIdleSessionsExist;
 }
@@ -2166,8 +2727,10 @@ void WeaveMsgEncryptionKeyCache::Shutdown()
 void WeaveMsgEncryptionKeyCache::Reset()
 {
     for (uint8_t keyEntry = 0; keyEntry < WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS; keyEntry++)
+    {
         Clear(keyEntry);
-    memset(mMostRecentlyUsedKeyEntries, 0, sizeof(mMostRecentlyUsedKeyEntries));
+        mMostRecentlyUsedKeyEntries[keyEntry / kShardSize][keyEntry % kShardSize] = keyEntry;
+    }
 }
 
 // Clear key cache entry.
@@ -2178,50 +2741,72 @@ void WeaveMsgEncryptionKeyCache::Clear(uint8_t keyEntryIndex)
     mKeyCache[keyEntryIndex].EncType = kWeaveEncryptionType_None;
 }
 
+// Returns the shard that holds the specified key.
+uint8_t WeaveMsgEncryptionKeyCache::GetShard(uint16_t keyId)
+{
+    uint32_t hash = static_cast<uint32_t>(keyId) * 0x9E3779B1UL;
+
+    return static_cast<uint8_t>((hash ^ (hash >> 16)) & (WEAVE_CONFIG_MSG_ENC_APP_KEY_CACHE_SHARDS - 1));
+}
+
 // If the key is found in the cache then function returns pointer to the key.
 // If the key is not found in the cache then function allocates and returns pointer to the empty key entry in the cache.
 WeaveMsgEncryptionKey *WeaveMsgEncryptionKeyCache::FindOrAllocateKeyEntry(uint16_t keyId, uint8_t encType)
 {
-    WeaveMsgEncryptionKey *keyEntry;
-    uint8_t retKeyEntryIndex = WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS;
+    uint8_t * const mruList = mMostRecentlyUsedKeyEntries[GetShard(keyId)];
+    uint8_t retKeyEntryIndex;
+    uint8_t freeEntryPos = kShardSize;
     uint8_t i;
 
-    // Find if key is in the cache.
-    for (i = 0, keyEntry = mKeyCache; i < WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS; i++, keyEntry++)
+    // Find if key is in the cache shard.
+    for (i = 0; i < kShardSize; i++)
     {
+        WeaveMsgEncryptionKey *keyEntry = &mKeyCache[mruList[i]];
+
         if (keyEntry->KeyId == keyId && keyEntry->EncType == encType)
-        {
-            retKeyEntryIndex = i;
             break;
-        }
-        else if (retKeyEntryIndex == WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS && keyEntry->KeyId == WeaveKeyId::kNone)
-        {
-            retKeyEntryIndex = i;
-        }
+        else if (freeEntryPos == kShardSize && keyEntry->KeyId == WeaveKeyId::kNone)
+            freeEntryPos = i;
     }
 
-    // If cache is full and specified key was not found in the cache then replace the least-recently used key entry.
-    if (retKeyEntryIndex == WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS)
+    // If the key was not found then use an empty entry in the shard.
+    if (i == kShardSize)
+        i = freeEntryPos;
+
+    // If shard is full and specified key was not found in the cache then replace the least-recently used key entry.
+    if (i == kShardSize)
     {
-        // Chose the least-recently used entry in the key cache.
-        retKeyEntryIndex = mMostRecentlyUsedKeyEntries[WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS - 1];
+        i = kShardSize - 1;
 
         // Clear replaced key cache entry.
-        Clear(retKeyEntryIndex);
+        Clear(mruList[i]);
     }
 
-    // Find key entry index in the most-recently used list of entries.
-    for (i = 0; i < WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS; i++)
-        if (mMostRecentlyUsedKeyEntries[i] == retKeyEntryIndex)
-            break;
+    retKeyEntryIndex = mruList[i];
 
     // Mark selected key entry as most-recently used by moving it to the top of the most-recently used key entries list.
-    memmove(&mMostRecentlyUsedKeyEntries[1], &mMostRecentlyUsedKeyEntries[0], i * sizeof(uint8_t));
-    mMostRecentlyUsedKeyEntries[0] = retKeyEntryIndex;
+    memmove(&mruList[1], &mruList[0], i * sizeof(uint8_t));
+    mruList[0] = retKeyEntryIndex;
 
     return &mKeyCache[retKeyEntryIndex];
 }
 
+// Returns whether the key is in the cache, without changing its position in the most-recently used list.
+bool WeaveMsgEncryptionKeyCache::IsKeyCached(uint16_t keyId, uint8_t encType) const
+{
+    const uint8_t * const mruList = mMostRecentlyUsedKeyEntries[GetShard(keyId)];
+
+    for (uint8_t i = 0; i < kShardSize; i++)
+    {
+        const WeaveMsgEncryptionKey *keyEntry = &mKeyCache[mruList[i]];
+
+        if (keyEntry->KeyId == keyId && keyEntry->EncType == encType)
+            return true;
+    }
+
+    return false;
+}
+
 
 #if WEAVE_CONFIG_SECURITY_TEST_MODE
 
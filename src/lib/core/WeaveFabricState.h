@@ -55,6 +55,7 @@ namespace Weave {
 class NL_DLL_EXPORT WeaveConnection;
 class NL_DLL_EXPORT WeaveMessageLayer;
 class NL_DLL_EXPORT WeaveExchangeManager;
+class WeaveFabricStateTestObject;
 struct WeaveMessageInfo;
 
 // Special node id values.
@@ -319,15 +320,24 @@ class WeaveSessionState
 {
 public:
 
+#if WEAVE_CONFIG_MSG_COUNTER_WINDOW_SIZE == 64
+    typedef uint64_t ReceiveFlagsType;
+#elif WEAVE_CONFIG_MSG_COUNTER_WINDOW_SIZE == 32
+    typedef uint32_t ReceiveFlagsType;
+#elif WEAVE_CONFIG_MSG_COUNTER_WINDOW_SIZE == 16
     typedef uint16_t ReceiveFlagsType;
+#else
+#error "Unsupported WEAVE_CONFIG_MSG_COUNTER_WINDOW_SIZE"
+#endif
 
     enum
     {
-        kReceiveFlags_NumMessageIdFlags                 = (sizeof(ReceiveFlagsType) * 8) - 1,
-        kReceiveFlags_MessageIdSynchronized             = (1 << kReceiveFlags_NumMessageIdFlags),
-        kReceiveFlags_MessageIdFlagsMask                = ~kReceiveFlags_MessageIdSynchronized
+        kReceiveFlags_NumMessageIdFlags                 = (sizeof(ReceiveFlagsType) * 8) - 1
     };
 
+    static const ReceiveFlagsType kReceiveFlags_MessageIdSynchronized = static_cast<ReceiveFlagsType>(1) << kReceiveFlags_NumMessageIdFlags;
+    static const ReceiveFlagsType kReceiveFlags_MessageIdFlagsMask    = static_cast<ReceiveFlagsType>(~kReceiveFlags_MessageIdSynchronized);
+
     WeaveSessionState(void);
     WeaveSessionState(WeaveMsgEncryptionKey *msgEncKey, WeaveAuthMode authMode,
                       MonotonicallyIncreasingCounter *nextMsgId, uint32_t *initialRcvdMsgId, uint32_t *maxRcvdMsgId, ReceiveFlagsType *rcvFlags);
@@ -419,16 +429,49 @@ public:
     void Shutdown(void);
 
     WeaveMsgEncryptionKey *FindOrAllocateKeyEntry(uint16_t keyId, uint8_t encType);
+    bool IsKeyCached(uint16_t keyId, uint8_t encType) const;
+
+    const WeaveMsgEncryptionKey *GetKeyEntry(uint8_t keyEntryIndex) const { return &mKeyCache[keyEntryIndex]; }
 
 private:
-    // Array of Weave message encryption keys.
+    enum
+    {
+        kShardSize = WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS / WEAVE_CONFIG_MSG_ENC_APP_KEY_CACHE_SHARDS
+    };
+
+    // Array of Weave message encryption keys, kShardSize consecutive entries per shard.
     WeaveMsgEncryptionKey mKeyCache[WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS];
-    // Array of key entry indexes in sorted order from most- to least- recently used.
-    uint8_t mMostRecentlyUsedKeyEntries[WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS];
+    // Arrays of key entry indexes in each shard in sorted order from most- to least- recently used.
+    uint8_t mMostRecentlyUsedKeyEntries[WEAVE_CONFIG_MSG_ENC_APP_KEY_CACHE_SHARDS][kShardSize];
 
+    static uint8_t GetShard(uint16_t keyId);
     void Clear(uint8_t keyEntryIndex);
 };
 
+/**
+ * @class WeaveSessionResumption
+ *
+ * @brief
+ *   Contains the secret from which a CASE session with a peer node can be resumed.
+ */
+class WeaveSessionResumption
+{
+public:
+    enum
+    {
+        kResumptionIdLength                     = 16,
+        kSecretLength                           = 32
+    };
+
+    uint64_t PeerNodeId;                                /**< The id of the node with which the secret is shared. */
+    uint8_t ResumptionId[kResumptionIdLength];          /**< The id by which the initiator names the secret to the responder. */
+    uint8_t Secret[kSecretLength];                      /**< The secret from which the keys of a resumed session are derived. */
+    WeaveAuthMode AuthMode;                             /**< The means by which the peer was authenticated when the secret was established. */
+
+    bool IsAllocated() const            { return PeerNodeId != kNodeIdNotSpecified; }
+    void Clear(void);
+};
+
 /**
  *  @brief
  *    Key diversifier used for Weave message encryption key derivation. This value
@@ -484,12 +527,24 @@ public:
 
 class NL_DLL_EXPORT WeaveFabricState
 {
+    friend class WeaveFabricStateTestObject;
+
 public:
 
-#if WEAVE_CONFIG_MAX_PEER_NODES <= UINT8_MAX
+#if WEAVE_CONFIG_MAX_PEER_NODES < UINT8_MAX
     typedef uint8_t PeerIndexType;
-#else
+#elif WEAVE_CONFIG_MAX_PEER_NODES < UINT16_MAX
     typedef uint16_t PeerIndexType;
+#else
+#error "WEAVE_CONFIG_MAX_PEER_NODES too large"
+#endif
+
+#if WEAVE_CONFIG_MAX_SESSION_KEYS < UINT8_MAX
+    typedef uint8_t SessionKeyIndexType;
+#elif WEAVE_CONFIG_MAX_SESSION_KEYS < UINT16_MAX
+    typedef uint16_t SessionKeyIndexType;
+#else
+#error "WEAVE_CONFIG_MAX_SESSION_KEYS too large"
 #endif
 
     enum State
@@ -523,7 +578,8 @@ public:
     WEAVE_ERROR Init(nl::Weave::Profiles::Security::AppKeys::GroupKeyStoreBase *groupKeyStore);
     WEAVE_ERROR Shutdown(void);
 
-    WEAVE_ERROR AllocSessionKey(uint64_t peerNodeId, uint16_t keyId, WeaveConnection *boundCon, WeaveSessionKey *& sessionKey);
+    WEAVE_ERROR AllocSessionKey(uint64_t peerNodeId, uint16_t keyId, WeaveConnection *boundCon, WeaveSessionKey *& sessionKey,
+                                bool evictIdle = false);
     WEAVE_ERROR SetSessionKey(uint16_t keyId, uint64_t peerNodeId, uint8_t encType, WeaveAuthMode authMode, const WeaveEncryptionKey *encKey);
     WEAVE_ERROR SetSessionKey(WeaveSessionKey *sessionKey, uint8_t encType, WeaveAuthMode authMode, const WeaveEncryptionKey *encKey);
     WEAVE_ERROR GetSessionKey(uint16_t keyId, uint64_t peerNodeId, WeaveSessionKey *& outSessionKey);
@@ -531,6 +587,8 @@ public:
     WEAVE_ERROR RemoveSessionKey(uint16_t keyId, uint64_t peerNodeId);
     void RemoveSessionKey(WeaveSessionKey *sessionKey, bool wasIdle = false);
     bool RemoveIdleSessionKeys();
+    void MarkSessionKeyIdle(WeaveSessionKey *sessionKey);
+    void ClearSessionKeyIdle(WeaveSessionKey *sessionKey);
 
     WeaveSessionKey *FindSharedSession(uint64_t terminatingNodeId, WeaveAuthMode authMode, uint8_t encType);
     bool IsSharedSession(uint16_t keyId, uint64_t peerNodeId);
@@ -540,6 +598,14 @@ public:
                                            uint8_t endNodeIdsBufSize, uint8_t& endNodeIdsCount);
     void RemoveSharedSessionEndNodes(const WeaveSessionKey *sessionKey);
 
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+    void SaveSessionResumption(uint64_t peerNodeId, WeaveAuthMode authMode, const uint8_t *resumptionId, const uint8_t *secret);
+    WeaveSessionResumption *FindSessionResumption(uint64_t peerNodeId);
+    WeaveSessionResumption *FindSessionResumption(uint64_t peerNodeId, const uint8_t *resumptionId);
+    void RemoveSessionResumption(WeaveSessionResumption *resumption);
+    void ClearSessionResumptions(void);
+#endif
+
     WEAVE_ERROR SuspendSession(uint16_t keyId, uint64_t peerNodeId, uint8_t * buf, uint16_t bufSize, uint16_t & serializedSessionLen);
     WEAVE_ERROR RestoreSession(uint8_t * serializedSession, uint16_t serializedSessionLen, WeaveConnection *con = NULL);
 
@@ -605,6 +671,27 @@ private:
     MonotonicallyIncreasingCounter NextUnencUDPMsgId;
     MonotonicallyIncreasingCounter NextUnencTCPMsgId;
     WeaveSessionKey SessionKeys[WEAVE_CONFIG_MAX_SESSION_KEYS];
+    struct
+    {
+        // Chains of allocated session key indexes hashed by key id.  Free entries are
+        // chained from FreeHead through the same array.
+        SessionKeyIndexType HashNext[WEAVE_CONFIG_MAX_SESSION_KEYS];
+        SessionKeyIndexType HashBuckets[WEAVE_CONFIG_SESSION_KEY_TABLE_HASH_SIZE];
+        SessionKeyIndexType FreeHead;
+        // List of idle session key indexes linked in order from most- to least- recently idle.
+        SessionKeyIndexType IdleNext[WEAVE_CONFIG_MAX_SESSION_KEYS];
+        SessionKeyIndexType IdlePrev[WEAVE_CONFIG_MAX_SESSION_KEYS];
+        SessionKeyIndexType IdleHead;
+        SessionKeyIndexType IdleTail;
+    } SessionKeyIndex;
+    static const SessionKeyIndexType kSessionKeyIndexNone = static_cast<SessionKeyIndexType>(~0);
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+    WeaveSessionResumption SessionResumptions[WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE];
+    // Array of resumption entry indexes in order from most- to least- recently used.
+    uint8_t MostRecentlyUsedResumptions[WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE];
+
+    void TouchSessionResumption(uint8_t index);
+#endif
 #if WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC
     PersistedCounter NextGroupKeyMsgId;
 
@@ -627,6 +714,10 @@ private:
     };
 
     WeaveMsgEncryptionKeyCache AppKeyCache;
+#if WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME > 0
+    // UTC time at which the application key prefetch timer expires, or UINT32_MAX if it is not running.
+    uint32_t AppKeyPrefetchTime;
+#endif
 #endif // WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC
     struct
     {
@@ -637,9 +728,16 @@ private:
         WeaveSessionState::ReceiveFlagsType GroupKeyRcvFlags[WEAVE_CONFIG_MAX_PEER_NODES];
 #endif
         WeaveSessionState::ReceiveFlagsType UnencRcvFlags[WEAVE_CONFIG_MAX_PEER_NODES];
-        // Array of peer indexes in sorted order from most- to least- recently used.
-        PeerIndexType MostRecentlyUsedIndexes[WEAVE_CONFIG_MAX_PEER_NODES];
+        // List of peer indexes linked in order from most- to least- recently used.
+        PeerIndexType MostRecentlyUsedNext[WEAVE_CONFIG_MAX_PEER_NODES];
+        PeerIndexType MostRecentlyUsedPrev[WEAVE_CONFIG_MAX_PEER_NODES];
+        PeerIndexType MostRecentlyUsedHead;
+        PeerIndexType MostRecentlyUsedTail;
+        // Chains of peer indexes hashed by node id.
+        PeerIndexType HashNext[WEAVE_CONFIG_MAX_PEER_NODES];
+        PeerIndexType HashBuckets[WEAVE_CONFIG_PEER_TABLE_HASH_SIZE];
     } PeerStates;
+    static const PeerIndexType kPeerIndexNone = static_cast<PeerIndexType>(~0);
     FabricStateDelegate *Delegate;
 
     // This structure contains information about shared session end node.
@@ -661,9 +759,20 @@ private:
 #if WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC
     void StartMsgCounterSyncTimer(void);
     static void OnMsgCounterSyncRespTimeout(System::Layer* aSystemLayer, void* aAppState, System::Error aError);
+#if WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME > 0
+    uint32_t GetAppKeyPrefetchClock(void);
+    void PrefetchMsgEncAppKey(uint16_t keyId, uint8_t encType, uint32_t now, uint32_t& nextPrefetchTime, bool deriveKey);
+    void PrefetchMsgEncAppKeys(void);
+    void StartAppKeyPrefetchTimer(uint32_t prefetchTime, uint32_t now);
+    static void HandleAppKeyPrefetchTimeout(System::Layer* aSystemLayer, void* aAppState, System::Error aError);
+#endif
 #endif
 
     bool FindOrAllocPeerEntry(uint64_t peerNodeId, bool allocEntry, PeerIndexType& retPeerIndex);
+    void UnlinkPeerEntry(PeerIndexType peerIndex, bool removeFromHash);
+    void IndexSessionKey(WeaveSessionKey *sessionKey);
+    void UnlinkSessionKeyIdle(SessionKeyIndexType keyIndex);
+    bool EvictIdleSessionKey(void);
     WEAVE_ERROR FindMsgEncAppKey(uint16_t keyId, uint8_t encType, WeaveMsgEncryptionKey *& retRec);
     WEAVE_ERROR DeriveMsgEncAppKey(uint32_t keyId, uint8_t encType, WeaveMsgEncryptionKey & appKey, uint32_t& appGroupGlobalId);
 };
@@ -148,6 +148,9 @@ WEAVE_ERROR WeaveMessageLayer::Init(InitContext *context)
     OnMessageLayerActivityChange = NULL;
     memset(mConPool, 0, sizeof(mConPool));
     memset(mTunnelPool, 0, sizeof(mTunnelPool));
+#if WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
+    ResetPeerTrafficStats();
+#endif
     AppState = NULL;
     ExchangeMgr = NULL;
     SecurityMgr = NULL;
@@ -321,6 +324,22 @@ WEAVE_ERROR WeaveMessageLayer::EncodeMessage(const IPAddress &destAddr, uint16_t
     if ((msgInfo->Flags & kWeaveMessageFlag_ReuseSourceId) == 0)
         msgInfo->SourceNodeId = FabricState->LocalNodeId;
 
+    // Force inclusion of the node identifiers that can't be inferred from the UDP addressing.
+    msgInfo->Flags |= GetUDPHeaderFlags(destAddr, msgInfo->DestNodeId);
+
+    // Encode the Weave message. NOTE that this results in the payload buffer containing the entire encoded message.
+    res = EncodeMessage(msgInfo, payload, NULL, UINT16_MAX, 0);
+
+    return res;
+}
+
+/**
+ *  Get the header flags that must be set when sending a Weave message to the given destination over UDP.
+ */
+uint32_t WeaveMessageLayer::GetUDPHeaderFlags(const IPAddress &destAddr, uint64_t destNodeId)
+{
+    uint32_t flags = 0;
+
     // Force inclusion of the source node identifier if the destination address is not a local fabric address.
     //
     // Technically it should be possible to omit the source node identifier in other situations beyond the
@@ -328,17 +347,69 @@ WEAVE_ERROR WeaveMessageLayer::EncodeMessage(const IPAddress &destAddr, uint16_t
     // address will be when sending a UDP packet, so we err on the side of correctness and only omit
     // the source identifier if we're part of a fabric and sending to another member of the same fabric.
     if (!FabricState->IsFabricAddress(destAddr))
-        msgInfo->Flags |= kWeaveMessageFlag_SourceNodeId;
+        flags |= kWeaveMessageFlag_SourceNodeId;
 
     // Force the destination node identifier to be included if it doesn't match the interface identifier in
     // the destination address.
-    if (!destAddr.IsIPv6ULA() || IPv6InterfaceIdToWeaveNodeId(destAddr.InterfaceId()) != msgInfo->DestNodeId)
-        msgInfo->Flags |= kWeaveMessageFlag_DestNodeId;
+    if (!destAddr.IsIPv6ULA() || IPv6InterfaceIdToWeaveNodeId(destAddr.InterfaceId()) != destNodeId)
+        flags |= kWeaveMessageFlag_DestNodeId;
 
-    // Encode the Weave message. NOTE that this results in the payload buffer containing the entire encoded message.
-    res = EncodeMessage(msgInfo, payload, NULL, UINT16_MAX, 0);
+    return flags;
+}
 
-    return res;
+/**
+ *  Get the length of the Weave message header that will be encoded for a message, given the header
+ *  flags and encryption type in its WeaveMessageInfo.
+ *
+ *  @param[in]    msgInfo       A pointer to a WeaveMessageInfo object describing the message.
+ *
+ *  @return  the length of the message header, excluding the frame length of messages sent over a
+ *           connection.
+ *
+ */
+uint16_t WeaveMessageLayer::GetMessageHeaderLength(const WeaveMessageInfo *msgInfo)
+{
+    // Header field and message id.
+    uint16_t headLen = 6;
+
+    if (msgInfo->Flags & kWeaveMessageFlag_SourceNodeId)
+        headLen += 8;
+    if (msgInfo->Flags & kWeaveMessageFlag_DestNodeId)
+        headLen += 8;
+    if (msgInfo->EncryptionType != kWeaveEncryptionType_None)
+        headLen += kKeyIdLen;
+
+    return headLen;
+}
+
+/**
+ *  Predict the length of the Weave message header that will be encoded when a message is sent
+ *  to the given destination over UDP.
+ *
+ *  Callers can reserve exactly this much space (plus the exchange header) ahead of the payload
+ *  when allocating the message buffer, so that encoding the headers never has to move the
+ *  payload.
+ *
+ *  @param[in]    destAddr      The destination IP address, or IPAddress::Any if it is to be derived
+ *                              from the destination node id.
+ *
+ *  @param[in]    msgInfo       A pointer to a WeaveMessageInfo object describing the message.
+ *
+ *  @return  the predicted length of the message header.
+ *
+ */
+uint16_t WeaveMessageLayer::PredictMessageHeaderLength(const IPAddress &destAddr, const WeaveMessageInfo *msgInfo)
+{
+    WeaveMessageInfo info = *msgInfo;
+    IPAddress addr = destAddr;
+
+    // If the destination can't be resolved the message will not be sent, so assume the largest header.
+    if (SelectDestNodeIdAndAddress(info.DestNodeId, addr) != WEAVE_NO_ERROR)
+        info.Flags |= kWeaveMessageFlag_SourceNodeId | kWeaveMessageFlag_DestNodeId;
+    else
+        info.Flags |= GetUDPHeaderFlags(addr, info.DestNodeId);
+
+    return GetMessageHeaderLength(&info);
 }
 
 /**
@@ -457,6 +528,178 @@ exit:
     return res;
 }
 
+/**
+ *  Encode and send one Weave message payload to a list of destinations.
+ *
+ *  The payload is copied into a new buffer for each destination, where it is encoded with the
+ *  node identifier and key of that destination, using the session state cached by the fabric
+ *  state object.  The encoded unicast messages are then handed to the UDP endpoints in batches
+ *  of up to #INET_CONFIG_UDP_SEND_BATCH_SIZE, which are sent with a single system call where the
+ *  platform supports it.  Multicast and broadcast destinations are sent individually.
+ *
+ *  @note
+ *    -The destination port used is #WEAVE_PORT.
+ *
+ *    -The messages bypass the exchange and reliable messaging layers, so the payload must
+ *     already include the exchange header.
+ *
+ *    -If a destination address is IPAddress::Any, it is determined from the destination node id.
+ *
+ *  @param[in]    msgInfo       A pointer to a WeaveMessageInfo object containing the information
+ *                              shared by all of the messages.  The destination node id and key id
+ *                              are taken from each destination.
+ *
+ *  @param[in]    payload       A pointer to the PacketBuffer object holding the message payload.
+ *                              The payload must be held in a single buffer, and is freed unless
+ *                              kWeaveMessageFlag_RetainBuffer is set in msgInfo.
+ *
+ *  @param[in]    dests         An array of destinations.  The outcome for each destination is
+ *                              stored in its Result field.
+ *
+ *  @param[in]    destCount     The number of destinations.
+ *
+ *  @retval  #WEAVE_NO_ERROR                    if the message was sent to all destinations.
+ *  @retval  #WEAVE_ERROR_INVALID_ARGUMENT      if the payload is chained, or if msgInfo requests
+ *                                              a delayed send or carries an encoded message.
+ *  @retval  other errors                       the first error stored in the Result field of a
+ *                                              destination.
+ *
+ */
+WEAVE_ERROR WeaveMessageLayer::SendMessageBatch(const WeaveMessageInfo *msgInfo, PacketBuffer *payload,
+                                                WeaveMessageDestination *dests, uint16_t destCount)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    IPPacketInfo pktInfos[INET_CONFIG_UDP_SEND_BATCH_SIZE];
+    PacketBuffer *msgs[INET_CONFIG_UDP_SEND_BATCH_SIZE];
+    WeaveMessageDestination *batchDests[INET_CONFIG_UDP_SEND_BATCH_SIZE];
+    UDPEndPoint *batchEP = NULL;
+    uint16_t batchCount = 0;
+    uint16_t payloadLen;
+
+    VerifyOrExit(payload != NULL && payload->Next() == NULL, err = WEAVE_ERROR_INVALID_ARGUMENT);
+    VerifyOrExit((msgInfo->Flags & (kWeaveMessageFlag_DelaySend | kWeaveMessageFlag_MessageEncoded)) == 0,
+                 err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    payloadLen = payload->DataLength();
+
+    for (uint16_t i = 0; i < destCount; i++)
+    {
+        WeaveMessageDestination &dest = dests[i];
+        WeaveMessageInfo info = *msgInfo;
+        IPAddress destAddr = dest.DestAddr;
+        PacketBuffer *msg = NULL;
+        UDPEndPoint *ep = NULL;
+        bool dropMsg = mDropMessage;
+
+        info.DestNodeId = dest.DestNodeId;
+        info.KeyId = dest.KeyId;
+        info.Flags &= ~kWeaveMessageFlag_RetainBuffer;
+
+        // Determine the message destination address based on the destination nodeId.
+        dest.Result = SelectDestNodeIdAndAddress(info.DestNodeId, destAddr);
+
+        // Copy the payload into a buffer of its own, with room for the message header.
+        if (dest.Result == WEAVE_NO_ERROR)
+        {
+            msg = PacketBuffer::New();
+            if (msg == NULL)
+                dest.Result = WEAVE_ERROR_NO_MEMORY;
+            else if (msg->AvailableDataLength() < payloadLen)
+                dest.Result = WEAVE_ERROR_BUFFER_TOO_SMALL;
+        }
+
+        if (dest.Result == WEAVE_NO_ERROR)
+        {
+            memcpy(msg->Start(), payload->Start(), payloadLen);
+            msg->SetDataLength(payloadLen);
+
+            dest.Result = EncodeMessage(destAddr, WEAVE_PORT, INET_NULL_INTERFACEID, &info, msg);
+        }
+
+        if (dest.Result == WEAVE_NO_ERROR)
+        {
+            if (destAddr.IsMulticast() || destAddr.IsIPv4Broadcast())
+            {
+                // Multicast messages may fan out over several interfaces, so send them on their own.
+                dest.Result = SendMessage(destAddr, WEAVE_PORT, INET_NULL_INTERFACEID, msg, info.Flags);
+                msg = NULL;
+            }
+            else
+            {
+                WEAVE_FAULT_INJECT(FaultInjection::kFault_DropOutgoingUDPMsg, dropMsg = true);
+
+                if (!dropMsg)
+                    dest.Result = SelectOutboundUDPEndPoint(destAddr, info.Flags, ep);
+            }
+        }
+
+        if (dest.Result == WEAVE_NO_ERROR && ep != NULL)
+        {
+            // Send the messages queued so far if this one goes out over a different endpoint.
+            if (batchCount > 0 && (ep != batchEP || batchCount == INET_CONFIG_UDP_SEND_BATCH_SIZE))
+            {
+                WEAVE_ERROR flushErr = FlushMessageBatch(batchEP, pktInfos, msgs, batchDests, batchCount);
+                if (err == WEAVE_NO_ERROR)
+                    err = flushErr;
+                batchCount = 0;
+            }
+
+            pktInfos[batchCount].Clear();
+            pktInfos[batchCount].DestAddress = destAddr;
+            pktInfos[batchCount].DestPort = WEAVE_PORT;
+            pktInfos[batchCount].Interface = INET_NULL_INTERFACEID;
+            msgs[batchCount] = msg;
+            batchDests[batchCount] = &dest;
+            batchCount++;
+            batchEP = ep;
+            msg = NULL;
+        }
+
+        if (msg != NULL)
+            PacketBuffer::Free(msg);
+
+        if (err == WEAVE_NO_ERROR)
+            err = dest.Result;
+    }
+
+    if (batchCount > 0)
+    {
+        WEAVE_ERROR flushErr = FlushMessageBatch(batchEP, pktInfos, msgs, batchDests, batchCount);
+        if (err == WEAVE_NO_ERROR)
+            err = flushErr;
+    }
+
+exit:
+    if (payload != NULL && (msgInfo->Flags & kWeaveMessageFlag_RetainBuffer) == 0)
+        PacketBuffer::Free(payload);
+
+    return err;
+}
+
+/**
+ *  Send a batch of encoded unicast Weave messages over a UDP endpoint, storing the outcome of
+ *  each send in the Result field of the corresponding destination.  The message buffers are
+ *  freed.
+ */
+WEAVE_ERROR WeaveMessageLayer::FlushMessageBatch(UDPEndPoint *ep, const IPPacketInfo *pktInfos, PacketBuffer * const *msgs,
+                                                 WeaveMessageDestination * const *dests, uint16_t count)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    INET_ERROR results[INET_CONFIG_UDP_SEND_BATCH_SIZE];
+
+    ep->SendMsgBatch(pktInfos, msgs, count, results);
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        CheckForceRefreshUDPEndPointsNeeded(results[i]);
+        dests[i]->Result = FilterUDPSendError(results[i], false);
+        if (err == WEAVE_NO_ERROR)
+            err = dests[i]->Result;
+    }
+
+    return err;
+}
+
 bool WeaveMessageLayer::IsIgnoredMulticastSendError(WEAVE_ERROR err)
 {
     return err == WEAVE_NO_ERROR ||
@@ -874,6 +1117,186 @@ void WeaveMessageLayer::GetConnectionPoolStats(nl::Weave::System::Stats::count_t
     }
 }
 
+#if WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
+
+/**
+ *  Get the traffic statistics for a peer node.
+ *
+ *  Like the rest of the message layer, the statistics table is not thread-safe; this method must
+ *  be called on the thread that drives the message layer.
+ *
+ *  @param[in]    peerNodeId    The node identifier of the peer.
+ *
+ *  @param[out]   stats         The statistics of the peer.
+ *
+ *  @return  true if statistics are held for the peer, false otherwise.
+ *
+ */
+bool WeaveMessageLayer::GetPeerTrafficStats(uint64_t peerNodeId, WeavePeerTrafficStats &stats) const
+{
+    for (int i = 0; i < WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE; i++)
+    {
+        if (mPeerStats[i].Stats.PeerNodeId == peerNodeId && peerNodeId != kNodeIdNotSpecified)
+        {
+            stats = mPeerStats[i].Stats;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ *  Get the traffic statistics of all peer nodes held in the statistics table.
+ *
+ *  The table holds at most #WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE peers, the least recently
+ *  active of which are evicted to make room for new ones.  The statistics are returned in table
+ *  order; callers looking for the busiest peers should sort them by the counter of interest.
+ *
+ *  Like the rest of the message layer, the statistics table is not thread-safe; this method must
+ *  be called on the thread that drives the message layer.
+ *
+ *  @param[out]   stats         An array to receive the statistics.
+ *
+ *  @param[in]    maxStats      The number of elements in the array.
+ *
+ *  @return  the number of elements filled in.
+ *
+ */
+size_t WeaveMessageLayer::GetPeerTrafficStats(WeavePeerTrafficStats *stats, size_t maxStats) const
+{
+    size_t count = 0;
+
+    for (int i = 0; i < WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE && count < maxStats; i++)
+    {
+        if (mPeerStats[i].Stats.PeerNodeId != kNodeIdNotSpecified)
+        {
+            stats[count++] = mPeerStats[i].Stats;
+        }
+    }
+
+    return count;
+}
+
+/**
+ *  Clear the traffic statistics of all peer nodes.
+ */
+void WeaveMessageLayer::ResetPeerTrafficStats(void)
+{
+    memset(mPeerStats, 0, sizeof(mPeerStats));
+    mPeerStatsClock = 0;
+}
+
+/**
+ *  Find the statistics table entry of a peer node.
+ *
+ *  If @a allocate is true, the peer is marked as the most recently active and, if it has no entry,
+ *  the entry of the least recently active peer is reassigned to it.  Otherwise, only an existing
+ *  entry is returned, and the table is left unchanged.  Only traffic whose source is known, i.e.
+ *  sent messages and authenticated received messages, may allocate entries, so that a sender
+ *  spoofing node identifiers cannot push real peers out of the table.
+ */
+WeaveMessageLayer::PeerTrafficStatsEntry *WeaveMessageLayer::GetPeerStatsEntry(uint64_t peerNodeId, bool allocate)
+{
+    PeerTrafficStatsEntry *entry = NULL;
+
+    // Broadcast and unknown peers are not tracked.
+    if (peerNodeId == kNodeIdNotSpecified || peerNodeId == kAnyNodeId)
+        return NULL;
+
+    if (allocate)
+        mPeerStatsClock++;
+
+    for (int i = 0; i < WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE; i++)
+    {
+        PeerTrafficStatsEntry *cur = &mPeerStats[i];
+
+        if (cur->Stats.PeerNodeId == peerNodeId)
+        {
+            if (allocate)
+                cur->LastActive = mPeerStatsClock;
+            return cur;
+        }
+
+        if (!allocate)
+            continue;
+
+        // Prefer an unused entry, otherwise the least recently active one.
+        if (entry == NULL ||
+            (entry->Stats.PeerNodeId != kNodeIdNotSpecified &&
+             (cur->Stats.PeerNodeId == kNodeIdNotSpecified ||
+              static_cast<int32_t>(cur->LastActive - entry->LastActive) < 0)))
+        {
+            entry = cur;
+        }
+    }
+
+    if (entry == NULL)
+        return NULL;
+
+    memset(&entry->Stats, 0, sizeof(entry->Stats));
+    entry->Stats.PeerNodeId = peerNodeId;
+    entry->LastActive = mPeerStatsClock;
+
+    return entry;
+}
+
+void WeaveMessageLayer::RecordPeerMessageSent(uint64_t peerNodeId, uint16_t msgLen)
+{
+    PeerTrafficStatsEntry *entry = GetPeerStatsEntry(peerNodeId, true);
+
+    if (entry != NULL)
+    {
+        entry->Stats.MessagesSent++;
+        entry->Stats.BytesSent += msgLen;
+    }
+}
+
+void WeaveMessageLayer::RecordPeerMessageReceived(uint64_t peerNodeId, uint16_t msgLen, bool isDuplicate, bool isAuthenticated)
+{
+    // The source of an unencrypted message is unauthenticated, so it may only update an existing entry.
+    PeerTrafficStatsEntry *entry = GetPeerStatsEntry(peerNodeId, isAuthenticated);
+
+    if (entry != NULL)
+    {
+        entry->Stats.MessagesReceived++;
+        entry->Stats.BytesReceived += msgLen;
+        if (isDuplicate)
+            entry->Stats.Duplicates++;
+    }
+}
+
+void WeaveMessageLayer::RecordPeerDecryptFailure(uint64_t peerNodeId)
+{
+    // The source of a message that failed decryption is unauthenticated, so it may only update an existing entry.
+    PeerTrafficStatsEntry *entry = GetPeerStatsEntry(peerNodeId, false);
+
+    if (entry != NULL)
+        entry->Stats.DecryptFailures++;
+}
+
+void WeaveMessageLayer::RecordPeerRetransmission(uint64_t peerNodeId, uint16_t msgLen)
+{
+    PeerTrafficStatsEntry *entry = GetPeerStatsEntry(peerNodeId, true);
+
+    if (entry != NULL)
+    {
+        entry->Stats.Retransmissions++;
+        entry->Stats.BytesSent += msgLen;
+    }
+}
+
+void WeaveMessageLayer::RecordPeerRTT(uint64_t peerNodeId, uint32_t rttMillis)
+{
+    // Round-trip times are sampled from acks, which need not be authenticated.
+    PeerTrafficStatsEntry *entry = GetPeerStatsEntry(peerNodeId, false);
+
+    if (entry != NULL)
+        entry->Stats.SmoothedRTT = rttMillis;
+}
+
+#endif // WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
+
 /**
  *  Create a new WeaveConnection object from a pool.
  *
@@ -1315,13 +1738,9 @@ WEAVE_ERROR WeaveMessageLayer::EncodeMessage(WeaveMessageInfo *msgInfo, PacketBu
 
     // Compute the number of bytes that will appear before and after the message payload
     // in the final encoded message.
-    uint16_t headLen = 6;
+    uint16_t headLen = GetMessageHeaderLength(msgInfo);
     uint16_t tailLen = 0;
     uint16_t payloadLen = msgBuf->DataLength();
-    if (msgInfo->Flags & kWeaveMessageFlag_SourceNodeId)
-        headLen += 8;
-    if (msgInfo->Flags & kWeaveMessageFlag_DestNodeId)
-        headLen += 8;
     switch (msgInfo->EncryptionType)
     {
     case kWeaveEncryptionType_None:
@@ -1330,7 +1749,6 @@ WEAVE_ERROR WeaveMessageLayer::EncodeMessage(WeaveMessageInfo *msgInfo, PacketBu
         // Can only encrypt non-zero length payloads.
         if (payloadLen == 0)
             return WEAVE_ERROR_INVALID_MESSAGE_LENGTH;
-        headLen += 2;
         tailLen += HMACSHA1::kDigestLength;
         break;
     default:
@@ -1446,6 +1864,10 @@ WEAVE_ERROR WeaveMessageLayer::EncodeMessage(WeaveMessageInfo *msgInfo, PacketBu
     // Update the buffer length to reflect the entire encoded message.
     msgBuf->SetDataLength(headLen + payloadLen + tailLen);
 
+#if WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
+    RecordPeerMessageSent(msgInfo->DestNodeId, msgBuf->DataLength());
+#endif
+
     // We update the cursor (p) out of good hygiene,
     // such that if the code is extended in the future such that the cursor is used,
     // it will be in the correct position for such code.
@@ -1474,7 +1896,13 @@ WEAVE_ERROR WeaveMessageLayer::DecodeMessage(PacketBuffer *msgBuf, uint64_t sour
 
     err = FabricState->GetSessionState(sourceNodeId, msgInfo->KeyId, msgInfo->EncryptionType, con, sessionState);
     if (err != WEAVE_NO_ERROR)
+    {
+#if WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
+        if (msgInfo->EncryptionType != kWeaveEncryptionType_None)
+            RecordPeerDecryptFailure(sourceNodeId);
+#endif
         return err;
+    }
 
     switch (msgInfo->EncryptionType)
     {
@@ -1508,7 +1936,12 @@ WEAVE_ERROR WeaveMessageLayer::DecodeMessage(PacketBuffer *msgBuf, uint64_t sour
                                             p, payloadLen, expectedIntegrityCheck);
         // Error if the expected integrity check doesn't match the integrity check in the message.
         if (!ConstantTimeCompare(p + payloadLen, expectedIntegrityCheck, HMACSHA1::kDigestLength))
+        {
+#if WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
+            RecordPeerDecryptFailure(sourceNodeId);
+#endif
             return WEAVE_ERROR_INTEGRITY_CHECK_FAILED;
+        }
         // Skip past the payload and the integrity check value.
         p += payloadLen + HMACSHA1::kDigestLength;
 
@@ -1534,6 +1967,11 @@ WEAVE_ERROR WeaveMessageLayer::DecodeMessage(PacketBuffer *msgBuf, uint64_t sour
     // Pass the peer authentication mode back to the application via the weave message header structure.
     msgInfo->PeerAuthMode = sessionState.AuthMode;
 
+#if WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
+    RecordPeerMessageReceived(sourceNodeId, msgLen, (msgInfo->Flags & kWeaveMessageFlag_DuplicateMessage) != 0,
+                              msgInfo->EncryptionType != kWeaveEncryptionType_None);
+#endif
+
     return err;
 }
 
@@ -45,6 +45,7 @@ using System::PacketBuffer;
 
 class WeaveMessageLayer;
 class WeaveMessageLayerTestObject;
+class WeaveConnectionTestObject;
 class WeaveExchangeManager;
 class WeaveSecurityManager;
 
@@ -115,6 +116,41 @@ struct WeaveMessageInfo
     void Clear() { memset(this, 0, sizeof(*this)); }
 };
 
+/**
+ *  @struct WeaveMessageDestination
+ *
+ *  @brief
+ *    One destination of a message sent with WeaveMessageLayer::SendMessageBatch().
+ *
+ */
+struct WeaveMessageDestination
+{
+    uint64_t DestNodeId;               /**< The destination node identifier of the message. */
+    IPAddress DestAddr;                /**< The destination IP address, or IPAddress::Any to derive it from DestNodeId. */
+    uint16_t KeyId;                    /**< The encryption key identifier with which the message is sent to this destination. */
+    WEAVE_ERROR Result;                /**< [OUT] The outcome of sending the message to this destination. */
+};
+
+/**
+ *  @struct WeavePeerTrafficStats
+ *
+ *  @brief
+ *    Traffic statistics kept by the message layer for a peer node.
+ *
+ */
+struct WeavePeerTrafficStats
+{
+    uint64_t PeerNodeId;               /**< The node identifier of the peer. */
+    uint32_t MessagesSent;             /**< The number of messages encoded for the peer. */
+    uint32_t MessagesReceived;         /**< The number of messages received from and decoded for the peer. */
+    uint32_t BytesSent;                /**< The number of bytes of encoded messages sent to the peer, including retransmissions. */
+    uint32_t BytesReceived;            /**< The number of bytes of messages received from the peer. */
+    uint32_t Retransmissions;          /**< The number of WRMP retransmissions to the peer. */
+    uint32_t Duplicates;               /**< The number of duplicate messages received from the peer. */
+    uint32_t DecryptFailures;          /**< The number of messages from the peer that failed decryption or integrity checks. */
+    uint32_t SmoothedRTT;              /**< The smoothed WRMP round-trip time to the peer in milliseconds, or 0 if not measured. */
+};
+
 // DEPRECATED alias for WeaveMessageInfo
 typedef struct WeaveMessageInfo WeaveMessageHeader;
 
@@ -199,6 +235,7 @@ typedef enum WeaveMessageVersion
 class WeaveConnection
 {
     friend class WeaveMessageLayer;
+    friend class WeaveConnectionTestObject;
 
 public:
     /**
@@ -276,6 +313,7 @@ public:
     void GetPeerDescription(char * buf, size_t bufSize) const;
 
     WEAVE_ERROR SendMessage(WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf);
+    uint16_t PredictMessageHeaderLength(const WeaveMessageInfo *msgInfo) const;
 #if WEAVE_CONFIG_ENABLE_TUNNELING
 /**
  * Function to send a Tunneled packet over a Weave connection.
@@ -412,6 +450,9 @@ private:
     static void HandleResolveComplete(void *appState, INET_ERROR err, uint8_t addrCount, IPAddress *addrArray);
     static void HandleConnectComplete(TCPEndPoint *endPoint, INET_ERROR conRes);
     static void HandleDataReceived(TCPEndPoint *endPoint, PacketBuffer *data);
+    static bool GetFrameLength(const PacketBuffer *data, uint32_t &frameLen);
+    static WEAVE_ERROR GatherFrame(PacketBuffer *&data, uint16_t frameLen);
+    static WEAVE_ERROR DetachPayload(PacketBuffer *&data, uint8_t *payload, uint16_t payloadLen, PacketBuffer *&payloadBuf);
     static void HandleTcpConnectionClosed(TCPEndPoint *endPoint, INET_ERROR err);
     static void HandleSecureSessionEstablished(WeaveSecurityManager *sm, WeaveConnection *con, void *reqState, uint16_t sessionKeyId, uint64_t peerNodeId, uint8_t encType);
     static void HandleSecureSessionError(WeaveSecurityManager *sm, WeaveConnection *con, void *reqState, WEAVE_ERROR localErr, uint64_t peerNodeId,
@@ -575,6 +616,9 @@ public:
     WEAVE_ERROR SendMessage(WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf);
     WEAVE_ERROR SendMessage(const IPAddress &destAddr, WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf);
     WEAVE_ERROR SendMessage(const IPAddress &destAddr, uint16_t destPort, InterfaceId sendIntfId, WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf);
+    WEAVE_ERROR SendMessageBatch(const WeaveMessageInfo *msgInfo, PacketBuffer *payload, WeaveMessageDestination *dests, uint16_t destCount);
+    uint16_t PredictMessageHeaderLength(const IPAddress &destAddr, const WeaveMessageInfo *msgInfo);
+    static uint16_t GetMessageHeaderLength(const WeaveMessageInfo *msgInfo);
     WEAVE_ERROR ResendMessage(WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf);
     WEAVE_ERROR ResendMessage(const IPAddress &destAddr, WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf);
     WEAVE_ERROR ResendMessage(const IPAddress &destAddr, uint16_t destPort, WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf);
@@ -590,6 +634,12 @@ public:
 
     void GetConnectionPoolStats(nl::Weave::System::Stats::count_t &aOutInUse) const;
 
+#if WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
+    bool GetPeerTrafficStats(uint64_t peerNodeId, WeavePeerTrafficStats &stats) const;
+    size_t GetPeerTrafficStats(WeavePeerTrafficStats *stats, size_t maxStats) const;
+    void ResetPeerTrafficStats(void);
+#endif
+
     WEAVE_ERROR CreateTunnel(WeaveConnectionTunnel **tunPtr, WeaveConnection &conOne, WeaveConnection &conTwo,
             uint32_t inactivityTimeoutMS);
 
@@ -732,6 +782,29 @@ private:
     WeaveConnectionTunnel mTunnelPool[WEAVE_CONFIG_MAX_TUNNELS];
     uint8_t mFlags;
 
+#if WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
+    /**
+     *  @brief
+     *    A peer traffic statistics table entry.  An entry with a PeerNodeId of
+     *    kNodeIdNotSpecified is unused.
+     */
+    struct PeerTrafficStatsEntry
+    {
+        WeavePeerTrafficStats Stats;
+        uint32_t LastActive;            /**< The value of mPeerStatsClock when the peer was last active. */
+    };
+
+    PeerTrafficStatsEntry mPeerStats[WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE];
+    uint32_t mPeerStatsClock;
+
+    PeerTrafficStatsEntry *GetPeerStatsEntry(uint64_t peerNodeId, bool allocate);
+    void RecordPeerMessageSent(uint64_t peerNodeId, uint16_t msgLen);
+    void RecordPeerMessageReceived(uint64_t peerNodeId, uint16_t msgLen, bool isDuplicate, bool isAuthenticated);
+    void RecordPeerDecryptFailure(uint64_t peerNodeId);
+    void RecordPeerRetransmission(uint64_t peerNodeId, uint16_t msgLen);
+    void RecordPeerRTT(uint64_t peerNodeId, uint32_t rttMillis);
+#endif // WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
+
 #if WEAVE_CONFIG_ENABLE_TARGETED_LISTEN
     UDPEndPoint *mIPv6UDPMulticastRcv;
 #if INET_CONFIG_ENABLE_IPV4
@@ -773,7 +846,10 @@ private:
 
     WEAVE_ERROR SendMessage(const IPAddress &destAddr, uint16_t destPort, InterfaceId sendIntfId, PacketBuffer *payload, uint32_t msgFlags);
     WEAVE_ERROR SelectOutboundUDPEndPoint(const IPAddress & destAddr, uint32_t msgFlags, UDPEndPoint *& ep);
+    WEAVE_ERROR FlushMessageBatch(UDPEndPoint *ep, const IPPacketInfo *pktInfos, PacketBuffer * const *msgs,
+            WeaveMessageDestination * const *dests, uint16_t count);
     WEAVE_ERROR SelectDestNodeIdAndAddress(uint64_t& destNodeId, IPAddress& destAddr);
+    uint32_t GetUDPHeaderFlags(const IPAddress &destAddr, uint64_t destNodeId);
     WEAVE_ERROR DecodeMessage(PacketBuffer *msgBuf, uint64_t sourceNodeId, WeaveConnection *con,
             WeaveMessageInfo *msgInfo, uint8_t **rPayload, uint16_t *rPayloadLen);
     WEAVE_ERROR EncodeMessageWithLength(WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf, WeaveConnection *con,
@@ -94,17 +94,24 @@ WEAVE_ERROR WeaveSecurityManager::Init(WeaveExchangeManager& aExchangeMgr, Syste
     OnSessionEstablished = NULL;
     OnSessionError = NULL;
     OnKeyErrorMsgRcvd = NULL;
-    mEC = NULL;
-    mCon = NULL;
-#if WEAVE_CONFIG_ENABLE_PASE_INITIATOR || WEAVE_CONFIG_ENABLE_PASE_RESPONDER
-    mPASEEngine = NULL;
+    memset(mHandshakePool, 0, sizeof(mHandshakePool));
+    for (int i = 0; i < WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES; i++)
+    {
+        mHandshakePool[i].SecMgr = this;
+        mHandshakePool[i].SessionKeyId = WeaveKeyId::kNone;
+        mHandshakePool[i].RequestedAuthMode = kWeaveAuthMode_NotSpecified;
+        mHandshakePool[i].EncType = kWeaveEncryptionType_None;
+        mHandshakePool[i].State = kState_Idle;
+    }
+#if WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE > 0
+    mAdmissionQueueHead = 0;
+    mAdmissionQueueCount = 0;
 #endif
 #if WEAVE_CONFIG_ENABLE_PASE_RESPONDER
     mPASERateLimiterTimeout = 0;
     mPASERateLimiterCount = 0;
 #endif
 #if WEAVE_CONFIG_ENABLE_CASE_INITIATOR || WEAVE_CONFIG_ENABLE_CASE_RESPONDER
-    mCASEEngine = NULL;
     mDefaultAuthDelegate = NULL;
 #endif
 #if WEAVE_CONFIG_ENABLE_CASE_INITIATOR
@@ -117,9 +124,6 @@ WEAVE_ERROR WeaveSecurityManager::Init(WeaveExchangeManager& aExchangeMgr, Syste
     ResponderAllowedCASEConfigs = CASE::kCASEAllowedConfig_Config2|CASE::kCASEAllowedConfig_Config1;
     ResponderAllowedCASECurves = WEAVE_CONFIG_DEFAULT_CASE_ALLOWED_CURVES;
 #endif
-#if WEAVE_CONFIG_ENABLE_TAKE_INITIATOR || WEAVE_CONFIG_ENABLE_TAKE_RESPONDER
-    mTAKEEngine = NULL;
-#endif
 #if WEAVE_CONFIG_ENABLE_TAKE_RESPONDER
     mDefaultTAKETokenAuthDelegate = NULL;
 #endif
@@ -127,7 +131,6 @@ WEAVE_ERROR WeaveSecurityManager::Init(WeaveExchangeManager& aExchangeMgr, Syste
     mDefaultTAKEChallengerAuthDelegate = NULL;
 #endif
 #if WEAVE_CONFIG_ENABLE_KEY_EXPORT_INITIATOR
-    mKeyExport = NULL;
     InitiatorKeyExportConfig = KeyExport::kKeyExportConfig_Config1;
     InitiatorAllowedKeyExportConfigs = KeyExport::kKeyExportSupportedConfig_All;
 #endif
@@ -140,15 +143,14 @@ WEAVE_ERROR WeaveSecurityManager::Init(WeaveExchangeManager& aExchangeMgr, Syste
 #if WEAVE_CONFIG_ENABLE_KEY_EXPORT_INITIATOR || WEAVE_CONFIG_ENABLE_KEY_EXPORT_RESPONDER
     mDefaultKeyExportDelegate = NULL;
 #endif
-    mStartSecureSession_OnComplete = NULL;
-    mStartSecureSession_OnError = NULL;
-    mStartSecureSession_ReqState = NULL;
-    mRequestedAuthMode = kWeaveAuthMode_NotSpecified;
-    mSessionKeyId = WeaveKeyId::kNone;
-    mEncType = kWeaveEncryptionType_None;
 
     mFlags = 0;
 
+#if WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
+    err = mCryptoWorkers.Init(aSystemLayer);
+    SuccessOrExit(err);
+#endif
+
     err = ExchangeManager->RegisterUnsolicitedMessageHandler(kWeaveProfile_Security, HandleUnsolicitedMessage, this);
     SuccessOrExit(err);
 
@@ -179,7 +181,18 @@ WEAVE_ERROR WeaveSecurityManager::Shutdown(void)
 
         // TODO: clean-up in-progress session establishment
 
-        Reset();
+#if WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE > 0
+        ClearAdmissionQueue();
+#endif
+
+        for (int i = 0; i < WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES; i++)
+        {
+            Reset(mHandshakePool[i]);
+        }
+
+#if WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
+        mCryptoWorkers.Shutdown();
+#endif
 
         State = kState_NotInitialized;
     }
@@ -192,6 +205,7 @@ void WeaveSecurityManager::HandleUnsolicitedMessage(ExchangeContext *ec, const I
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
     WeaveSecurityManager *secMgr = (WeaveSecurityManager *)ec->AppState;
+    Handshake *handshake;
 
     // Handle Key Error Messages.
     if (profileId == kWeaveProfile_Security && msgType == kMsgType_KeyError)
@@ -203,12 +217,62 @@ void WeaveSecurityManager::HandleUnsolicitedMessage(ExchangeContext *ec, const I
         ExitNow();
     }
 
-    // Verify that we don't already have a session establishment in progress.
-    VerifyOrExit(secMgr->State == kState_Idle, err = WEAVE_ERROR_SECURITY_MANAGER_BUSY);
+    // Reject all message types other than those that start a session establishment or a key export.
+    VerifyOrExit(profileId == kWeaveProfile_Security &&
+                 (msgType == kMsgType_PASEInitiatorStep1 || msgType == kMsgType_CASEBeginSessionRequest ||
+                  msgType == kMsgType_CASEResumeSessionRequest || msgType == kMsgType_TAKEIdentifyToken ||
+                  msgType == kMsgType_KeyExportRequest),
+                 err = WEAVE_ERROR_INVALID_MESSAGE_TYPE);
+
+    handshake = secMgr->AllocHandshake();
+
+#if WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE > 0
+    // If all handshake slots are taken, or other requests are already waiting for one, queue the
+    // request behind them.  Requests are admitted in the order they arrived as slots free up.
+    if (handshake == NULL || secMgr->mAdmissionQueueCount > 0)
+    {
+        err = secMgr->EnqueueHandshake(ec, pktInfo, msgInfo, profileId, msgType, msgBuf);
+        SuccessOrExit(err);
+
+        msgBuf = NULL;
+        ec = NULL;
+
+        ExitNow();
+    }
+#else
+    // Verify that there is room for another session establishment.
+    VerifyOrExit(handshake != NULL, err = WEAVE_ERROR_SECURITY_MANAGER_BUSY);
+#endif
+
+    secMgr->StartResponderHandshake(*handshake, ec, pktInfo, msgInfo, profileId, msgType, msgBuf);
+    msgBuf = NULL;
+    ec = NULL;
+
+exit:
+    if (msgBuf != NULL)
+        PacketBuffer::Free(msgBuf);
+    if (ec != NULL)
+    {
+        if (err != WEAVE_NO_ERROR)
+            SendStatusReport(err, ec);
+        ec->Release();
+    }
+}
+
+/**
+ * Start the responder side of a peer-initiated session establishment or key export
+ * on the given handshake.
+ *
+ * This method takes ownership of both the exchange context and the message buffer.
+ */
+void WeaveSecurityManager::StartResponderHandshake(Handshake &handshake, ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo,
+        uint32_t profileId, uint8_t msgType, PacketBuffer* msgBuf)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
 
     WEAVE_FAULT_INJECT(nl::Weave::FaultInjection::kFault_SecMgrBusy,
         {
-            secMgr->AsyncNotifySecurityManagerAvailable();
+            AsyncNotifySecurityManagerAvailable();
             ExitNow(err = WEAVE_ERROR_SECURITY_MANAGER_BUSY);
         });
 
@@ -221,7 +285,7 @@ void WeaveSecurityManager::HandleUnsolicitedMessage(ExchangeContext *ec, const I
     }
 
     // Handle messages that mark the beginning of a PASE interaction...
-    if (profileId == kWeaveProfile_Security && msgType == kMsgType_PASEInitiatorStep1)
+    if (msgType == kMsgType_PASEInitiatorStep1)
     {
 #if WEAVE_CONFIG_ENABLE_PASE_RESPONDER
         // Reject the request if it did not arrive over a connection.
@@ -232,11 +296,11 @@ void WeaveSecurityManager::HandleUnsolicitedMessage(ExchangeContext *ec, const I
 
         // PASE rate limiter.
         // Reject the request if too many PASE attempts in a given time period.
-        VerifyOrExit(secMgr->mPASERateLimiterCount < WEAVE_CONFIG_PASE_RATE_LIMITER_MAX_ATTEMPTS ||
-                     secMgr->mPASERateLimiterTimeout < nowTimeMS,
+        VerifyOrExit(mPASERateLimiterCount < WEAVE_CONFIG_PASE_RATE_LIMITER_MAX_ATTEMPTS ||
+                     mPASERateLimiterTimeout < nowTimeMS,
                      err = WEAVE_ERROR_RATE_LIMIT_EXCEEDED);
 
-        secMgr->HandlePASESessionStart(ec, pktInfo, msgInfo, msgBuf);
+        HandlePASESessionStart(handshake, ec, pktInfo, msgInfo, msgBuf);
         msgBuf = NULL;
 #else
         ExitNow(err = WEAVE_ERROR_NOT_IMPLEMENTED);
@@ -244,25 +308,37 @@ void WeaveSecurityManager::HandleUnsolicitedMessage(ExchangeContext *ec, const I
     }
 
     // Handle messages that mark the beginning of a CASE interaction...
-    else if (profileId == kWeaveProfile_Security && msgType == kMsgType_CASEBeginSessionRequest)
+    else if (msgType == kMsgType_CASEBeginSessionRequest)
     {
 #if WEAVE_CONFIG_ENABLE_CASE_RESPONDER
-        secMgr->HandleCASESessionStart(ec, pktInfo, msgInfo, msgBuf);
+        HandleCASESessionStart(handshake, ec, pktInfo, msgInfo, msgBuf);
+        msgBuf = NULL;
+#else
+        ExitNow(err = WEAVE_ERROR_NOT_IMPLEMENTED);
+#endif
+    }
+
+    // Handle requests to resume an earlier CASE session...
+    else if (msgType == kMsgType_CASEResumeSessionRequest)
+    {
+#if WEAVE_CONFIG_ENABLE_CASE_RESPONDER && WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+        HandleCASEResumeSessionStart(handshake, ec, msgBuf);
         msgBuf = NULL;
 #else
+        // The initiator falls back to a new CASE session on receiving the status report.
         ExitNow(err = WEAVE_ERROR_NOT_IMPLEMENTED);
 #endif
     }
 
     // Handle messages that mark the beginning of a TAKE interaction...
-    else if (profileId == kWeaveProfile_Security && msgType == kMsgType_TAKEIdentifyToken)
+    else if (msgType == kMsgType_TAKEIdentifyToken)
     {
 #if WEAVE_CONFIG_ENABLE_TAKE_RESPONDER
         // Reject the request if it did not arrive over a connection.
         // TAKE is not supported over WRMP.
         VerifyOrExit(ec->Con != NULL, err = WEAVE_ERROR_INVALID_ARGUMENT);
 
-        secMgr->HandleTAKESessionStart(ec, pktInfo, msgInfo, msgBuf);
+        HandleTAKESessionStart(handshake, ec, pktInfo, msgInfo, msgBuf);
         msgBuf = NULL;
 #else
         ExitNow(err = WEAVE_ERROR_NOT_IMPLEMENTED);
@@ -270,10 +346,10 @@ void WeaveSecurityManager::HandleUnsolicitedMessage(ExchangeContext *ec, const I
     }
 
     // Handle messages that requests the secret key export...
-    else if (profileId == kWeaveProfile_Security && msgType == kMsgType_KeyExportRequest)
+    else if (msgType == kMsgType_KeyExportRequest)
     {
 #if WEAVE_CONFIG_ENABLE_KEY_EXPORT_RESPONDER
-        secMgr->HandleKeyExportRequest(ec, pktInfo, msgInfo, msgBuf);
+        HandleKeyExportRequest(handshake, ec, pktInfo, msgInfo, msgBuf);
         msgBuf = NULL;
 #else
         ExitNow(err = WEAVE_ERROR_NOT_IMPLEMENTED);
@@ -319,14 +395,16 @@ WEAVE_ERROR WeaveSecurityManager::StartPASESession(WeaveConnection *con, WeaveAu
                                                    const uint8_t *pw, uint16_t pwLen)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
+    Handshake *handshake;
     WeaveSessionKey *sessionKey;
     bool clearStateOnError = false;
 
     // Verify security manager has been initialized.
     VerifyOrExit(State != kState_NotInitialized, err = WEAVE_ERROR_INCORRECT_STATE);
 
-    // Verify there is no session in process.
-    VerifyOrExit(State == kState_Idle, err = WEAVE_ERROR_SECURITY_MANAGER_BUSY);
+    // Verify there is room for another session establishment.
+    handshake = AllocHandshake();
+    VerifyOrExit(handshake != NULL, err = WEAVE_ERROR_SECURITY_MANAGER_BUSY);
 
     WEAVE_FAULT_INJECT(nl::Weave::FaultInjection::kFault_SecMgrBusy,
         {
@@ -341,27 +419,27 @@ WEAVE_ERROR WeaveSecurityManager::StartPASESession(WeaveConnection *con, WeaveAu
     // PASE is not yet supported over WRMP.
     VerifyOrExit(con != NULL, err = WEAVE_ERROR_INVALID_ARGUMENT);
 
-    State = kState_PASEInProgress;
-    mRequestedAuthMode = requestedAuthMode;
-    mEncType = kWeaveEncryptionType_AES128CTRSHA1;
-    mCon = con;
-    mStartSecureSession_OnComplete = onComplete;
-    mStartSecureSession_OnError = onError;
-    mStartSecureSession_ReqState = reqState;
-    mSessionKeyId = WeaveKeyId::kNone;
+    handshake->State = kState_PASEInProgress;
+    handshake->RequestedAuthMode = requestedAuthMode;
+    handshake->EncType = kWeaveEncryptionType_AES128CTRSHA1;
+    handshake->Con = con;
+    handshake->StartSecureSession_OnComplete = onComplete;
+    handshake->StartSecureSession_OnError = onError;
+    handshake->StartSecureSession_ReqState = reqState;
+    handshake->SessionKeyId = WeaveKeyId::kNone;
 
     // Any error after this point requires call to the Reset() function.
     clearStateOnError = true;
 
     // Allocate an entry in the session key table identified by a random key id. The actual
     // key itself will be set once the session is established.
-    err = FabricState->AllocSessionKey(con->PeerNodeId, WeaveKeyId::kNone, con, sessionKey);
+    err = FabricState->AllocSessionKey(con->PeerNodeId, WeaveKeyId::kNone, con, sessionKey, true);
     SuccessOrExit(err);
     sessionKey->SetLocallyInitiated(true);
-    mSessionKeyId = sessionKey->MsgEncKey.KeyId;
+    handshake->SessionKeyId = sessionKey->MsgEncKey.KeyId;
 
     // Create a new exchange context.
-    err = NewSessionExchange(mCon->PeerNodeId, mCon->PeerAddr, mCon->PeerPort);
+    err = NewSessionExchange(*handshake, handshake->Con->PeerNodeId, handshake->Con->PeerAddr, handshake->Con->PeerPort);
     SuccessOrExit(err);
 
     // Initialize Weave platform memory.
@@ -369,57 +447,63 @@ WEAVE_ERROR WeaveSecurityManager::StartPASESession(WeaveConnection *con, WeaveAu
     SuccessOrExit(err);
 
     // Allocate and initialize PASE engine object.
-    mPASEEngine = (WeavePASEEngine *)Platform::Security::MemoryAlloc(sizeof(WeavePASEEngine), true);
-    VerifyOrExit(mPASEEngine != NULL, err = WEAVE_ERROR_NO_MEMORY);
-    mPASEEngine->Init();
+    handshake->PASEEngine = (WeavePASEEngine *)Platform::Security::MemoryAlloc(sizeof(WeavePASEEngine), true);
+    VerifyOrExit(handshake->PASEEngine != NULL, err = WEAVE_ERROR_NO_MEMORY);
+    handshake->PASEEngine->Init();
 
     // Initialize PASE password if provided.
     if (pw != NULL)
     {
-        mPASEEngine->Pw = pw;
-        mPASEEngine->PwLen = pwLen;
+        handshake->PASEEngine->Pw = pw;
+        handshake->PASEEngine->PwLen = pwLen;
     }
 
     // Start PASE session.
-    StartPASESession();
+    StartPASESession(*handshake);
 
 exit:
     if (err != WEAVE_NO_ERROR && clearStateOnError)
     {
-        if (mSessionKeyId != WeaveKeyId::kNone)
-            FabricState->RemoveSessionKey(mSessionKeyId, con->PeerNodeId);
+        if (handshake->SessionKeyId != WeaveKeyId::kNone)
+            FabricState->RemoveSessionKey(handshake->SessionKeyId, con->PeerNodeId);
 
-        Reset();
+        Reset(*handshake);
     }
 
     return err;
 }
 
-void WeaveSecurityManager::StartPASESession(void)
+void WeaveSecurityManager::StartPASESession(Handshake &handshake)
 {
     WEAVE_ERROR err;
 
-    err = SendPASEInitiatorStep1(kPASEConfig_ConfigDefault);
-    SuccessOrExit(err);
-
-    mEC->OnMessageReceived = HandlePASEMessageInitiator;
-    mEC->OnConnectionClosed = HandleConnectionClosed;
+    handshake.EC->OnMessageReceived = HandlePASEMessageInitiator;
+    handshake.EC->OnConnectionClosed = HandleConnectionClosed;
 
     // Time limit overall PASE duration.
-    StartSessionTimer();
+    StartSessionTimer(handshake);
+
+    err = SendPASEInitiatorStep1(handshake, kPASEConfig_ConfigDefault);
+    SuccessOrExit(err);
 
 exit:
     if (err != WEAVE_NO_ERROR)
-        HandleSessionError(err, NULL);
+        HandleSessionError(handshake, err, NULL);
 }
 
 void WeaveSecurityManager::HandlePASEMessageInitiator(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo,
         uint32_t profileId, uint8_t msgType, PacketBuffer* msgBuf)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
-    WeaveSecurityManager *secMgr = (WeaveSecurityManager *)ec->AppState;
+    Handshake *handshake = (Handshake *)ec->AppState;
+    WeaveSecurityManager *secMgr = handshake->SecMgr;
+
+    VerifyOrDie(ec == handshake->EC);
 
-    VerifyOrDie(ec == secMgr->mEC);
+#if WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
+    if (secMgr->HoldMessage(*handshake, msgInfo, profileId, msgType, msgBuf))
+        return;
+#endif
 
     // Abort the PASE interaction immediately if we receive a status report message from the responder.
     // This is a signal that the responder does not want to continue.
@@ -436,7 +520,7 @@ void WeaveSecurityManager::HandlePASEMessageInitiator(ExchangeContext *ec, const
             PacketBuffer::Free(msgBuf);
             msgBuf = NULL;
 
-            err = secMgr->SendPASEInitiatorStep1(kPASEConfig_Config1);
+            err = secMgr->SendPASEInitiatorStep1(*handshake, kPASEConfig_Config1);
             ExitNow();
         }
         else
@@ -455,56 +539,44 @@ void WeaveSecurityManager::HandlePASEMessageInitiator(ExchangeContext *ec, const
     case kMsgType_PASEResponderReconfigure:
         uint32_t newConfig;
 
-        err = secMgr->ProcessPASEResponderReconfigure(msgBuf, newConfig);
+        err = secMgr->ProcessPASEResponderReconfigure(*handshake, msgBuf, newConfig);
         SuccessOrExit(err);
 
         // Free the received message buffer so that it can be reused to send the outgoing message.
         PacketBuffer::Free(msgBuf);
         msgBuf = NULL;
 
-        err = secMgr->SendPASEInitiatorStep1(newConfig);
+        err = secMgr->SendPASEInitiatorStep1(*handshake, newConfig);
         SuccessOrExit(err);
 
         break;
 
     case kMsgType_PASEResponderStep1:
 
-        err = secMgr->ProcessPASEResponderStep1(msgBuf);
+        err = secMgr->ProcessPASEResponderStep1(*handshake, msgBuf);
+        msgBuf = NULL;
         SuccessOrExit(err);
 
         break;
 
     case kMsgType_PASEResponderStep2:
 
-        err = secMgr->ProcessPASEResponderStep2(msgBuf);
-        SuccessOrExit(err);
-
-        // Free the received message buffer so that it can be reused to send the outgoing message.
-        PacketBuffer::Free(msgBuf);
+        // Once processed, the responder's step 2 message is answered with the initiator's step 2 message.
+        err = secMgr->ProcessPASEResponderStep2(*handshake, msgBuf);
         msgBuf = NULL;
-
-        err = secMgr->SendPASEInitiatorStep2();
         SuccessOrExit(err);
 
-        if (secMgr->mPASEEngine->State == WeavePASEEngine::kState_InitiatorDone)
-        {
-            err = secMgr->HandleSessionEstablished();
-            SuccessOrExit(err);
-
-            secMgr->HandleSessionComplete();
-        }
-
         break;
 
     case kMsgType_PASEResponderKeyConfirm:
 
-        err = secMgr->ProcessPASEResponderKeyConfirm(msgBuf);
+        err = secMgr->ProcessPASEResponderKeyConfirm(*handshake, msgBuf);
         SuccessOrExit(err);
 
-        err = secMgr->HandleSessionEstablished();
+        err = secMgr->HandleSessionEstablished(*handshake);
         SuccessOrExit(err);
 
-        secMgr->HandleSessionComplete();
+        secMgr->HandleSessionComplete(*handshake);
 
         break;
 
@@ -516,49 +588,56 @@ void WeaveSecurityManager::HandlePASEMessageInitiator(ExchangeContext *ec, const
 
 exit:
     if (err != WEAVE_NO_ERROR)
-        secMgr->HandleSessionError(err, (err == WEAVE_ERROR_STATUS_REPORT_RECEIVED) ? msgBuf : NULL);
+        secMgr->HandleSessionError(*handshake, err, (err == WEAVE_ERROR_STATUS_REPORT_RECEIVED) ? msgBuf : NULL);
     if (msgBuf != NULL)
         PacketBuffer::Free(msgBuf);
 }
 
 __attribute__((noinline))
-WEAVE_ERROR WeaveSecurityManager::SendPASEInitiatorStep1(uint32_t paseConfig)
+WEAVE_ERROR WeaveSecurityManager::SendPASEInitiatorStep1(Handshake &handshake, uint32_t paseConfig)
 {
     WEAVE_ERROR     err     = WEAVE_NO_ERROR;
-    PacketBuffer*   msgBuf  = NULL;
-    uint8_t         pwSource;
+    CryptoStep      step;
+
+    step.Init(kCryptoStep_SendPASEInitiatorStep1);
 
     // Allocate buffer.
-    msgBuf = PacketBuffer::New();
-    VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+    step.OutMsgBuf = PacketBuffer::New();
+    VerifyOrExit(step.OutMsgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
     // Extract the password source from the requested auth mode.
-    pwSource = PasswordSourceFromAuthMode(mRequestedAuthMode);
+    step.PwSource = PasswordSourceFromAuthMode(handshake.RequestedAuthMode);
+    step.Config = paseConfig;
+    step.PeerNodeId = handshake.EC->PeerNodeId;
 
     // Generate and encode PASE step 1 message.
-    Platform::Security::OnTimeConsumingCryptoStart();
-    err = mPASEEngine->GenerateInitiatorStep1(msgBuf, paseConfig, FabricState->LocalNodeId, mEC->PeerNodeId, mSessionKeyId, kWeaveEncryptionType_AES128CTRSHA1, pwSource, FabricState, true);
-    Platform::Security::OnTimeConsumingCryptoDone();
+    PerformCryptoStep(handshake, step);
+
+exit:
+    return err;
+}
+
+void WeaveSecurityManager::FinishSendPASEInitiatorStep1(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step)
+{
     SuccessOrExit(err);
 
     // Send PASE step 1 message.
-    err = mEC->SendMessage(kWeaveProfile_Security, kMsgType_PASEInitiatorStep1, msgBuf, 0);
-    msgBuf = NULL;
+    err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_PASEInitiatorStep1, step.OutMsgBuf, 0);
+    step.OutMsgBuf = NULL;
     SuccessOrExit(err);
 
 exit:
-    if (msgBuf != NULL)
-        PacketBuffer::Free(msgBuf);
-    return err;
+    if (err != WEAVE_NO_ERROR)
+        HandleSessionError(handshake, err, NULL);
 }
 
 __attribute__((noinline))
-WEAVE_ERROR WeaveSecurityManager::ProcessPASEResponderReconfigure(PacketBuffer* msgBuf, uint32_t &newConfig)
+WEAVE_ERROR WeaveSecurityManager::ProcessPASEResponderReconfigure(Handshake &handshake, PacketBuffer* msgBuf, uint32_t &newConfig)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
 
     // Decode and process the responder's reconfigure message.
-    err = mPASEEngine->ProcessResponderReconfigure(msgBuf, newConfig);
+    err = handshake.PASEEngine->ProcessResponderReconfigure(msgBuf, newConfig);
     SuccessOrExit(err);
 
 exit:
@@ -566,69 +645,103 @@ exit:
 }
 
 __attribute__((noinline))
-WEAVE_ERROR WeaveSecurityManager::ProcessPASEResponderStep1(PacketBuffer* msgBuf)
+WEAVE_ERROR WeaveSecurityManager::ProcessPASEResponderStep1(Handshake &handshake, PacketBuffer* msgBuf)
 {
-    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    CryptoStep step;
+
+    step.Init(kCryptoStep_ProcessPASEResponderStep1);
+    step.MsgBuf = msgBuf;
 
     // Decode and process the responder's step 1 message.
-    Platform::Security::OnTimeConsumingCryptoStart();
-    err = mPASEEngine->ProcessResponderStep1(msgBuf);
-    Platform::Security::OnTimeConsumingCryptoDone();
-    SuccessOrExit(err);
+    PerformCryptoStep(handshake, step);
 
-exit:
-    return err;
+    return WEAVE_NO_ERROR;
+}
+
+void WeaveSecurityManager::FinishProcessPASEResponderStep1(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step)
+{
+    if (err != WEAVE_NO_ERROR)
+        HandleSessionError(handshake, err, NULL);
 }
 
 __attribute__((noinline))
-WEAVE_ERROR WeaveSecurityManager::ProcessPASEResponderStep2(PacketBuffer* msgBuf)
+WEAVE_ERROR WeaveSecurityManager::ProcessPASEResponderStep2(Handshake &handshake, PacketBuffer* msgBuf)
 {
-    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    CryptoStep step;
+
+    step.Init(kCryptoStep_ProcessPASEResponderStep2);
+    step.MsgBuf = msgBuf;
 
     // Decode and process the responder's step 2 message.
-    Platform::Security::OnTimeConsumingCryptoStart();
-    err = mPASEEngine->ProcessResponderStep2(msgBuf);
-    Platform::Security::OnTimeConsumingCryptoDone();
+    PerformCryptoStep(handshake, step);
+
+    return WEAVE_NO_ERROR;
+}
+
+void WeaveSecurityManager::FinishProcessPASEResponderStep2(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step)
+{
+    SuccessOrExit(err);
+
+    // Free the received message buffer so that it can be reused to send the outgoing message.
+    PacketBuffer::Free(step.MsgBuf);
+    step.MsgBuf = NULL;
+
+    err = SendPASEInitiatorStep2(handshake);
     SuccessOrExit(err);
 
 exit:
-    return err;
+    if (err != WEAVE_NO_ERROR)
+        HandleSessionError(handshake, err, NULL);
 }
 
 __attribute__((noinline))
-WEAVE_ERROR WeaveSecurityManager::SendPASEInitiatorStep2(void)
+WEAVE_ERROR WeaveSecurityManager::SendPASEInitiatorStep2(Handshake &handshake)
 {
     WEAVE_ERROR     err     = WEAVE_NO_ERROR;
-    PacketBuffer*   msgBuf  = NULL;
+    CryptoStep      step;
+
+    step.Init(kCryptoStep_SendPASEInitiatorStep2);
 
     // Allocate buffer.
-    msgBuf = PacketBuffer::New();
-    VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+    step.OutMsgBuf = PacketBuffer::New();
+    VerifyOrExit(step.OutMsgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
-    // Generate and encode PASE step 1 message.
-    Platform::Security::OnTimeConsumingCryptoStart();
-    err = mPASEEngine->GenerateInitiatorStep2(msgBuf);
-    Platform::Security::OnTimeConsumingCryptoDone();
+    // Generate and encode PASE step 2 message.
+    PerformCryptoStep(handshake, step);
+
+exit:
+    return err;
+}
+
+void WeaveSecurityManager::FinishSendPASEInitiatorStep2(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step)
+{
     SuccessOrExit(err);
 
     // Send PASE step 2 message.
-    err = mEC->SendMessage(kWeaveProfile_Security, kMsgType_PASEInitiatorStep2, msgBuf, 0);
-    msgBuf = NULL;
+    err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_PASEInitiatorStep2, step.OutMsgBuf, 0);
+    step.OutMsgBuf = NULL;
     SuccessOrExit(err);
 
+    if (handshake.PASEEngine->State == WeavePASEEngine::kState_InitiatorDone)
+    {
+        err = HandleSessionEstablished(handshake);
+        SuccessOrExit(err);
+
+        HandleSessionComplete(handshake);
+    }
+
 exit:
-    if (msgBuf != NULL)
-        PacketBuffer::Free(msgBuf);
-    return err;
+    if (err != WEAVE_NO_ERROR)
+        HandleSessionError(handshake, err, NULL);
 }
 
 __attribute__((noinline))
-WEAVE_ERROR WeaveSecurityManager::ProcessPASEResponderKeyConfirm(PacketBuffer* msgBuf)
+WEAVE_ERROR WeaveSecurityManager::ProcessPASEResponderKeyConfirm(Handshake &handshake, PacketBuffer* msgBuf)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
 
     // Decode and process the responder's key confirmation message.
-    err = mPASEEngine->ProcessResponderKeyConfirm(msgBuf);
+    err = handshake.PASEEngine->ProcessResponderKeyConfirm(msgBuf);
     SuccessOrExit(err);
 
 exit:
@@ -648,14 +761,15 @@ WEAVE_ERROR WeaveSecurityManager::StartPASESession(WeaveConnection *con, WeaveAu
 
 #if WEAVE_CONFIG_ENABLE_PASE_RESPONDER
 
-void WeaveSecurityManager::HandlePASESessionStart(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo, PacketBuffer* msgBuf)
+void WeaveSecurityManager::HandlePASESessionStart(Handshake &handshake, ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo, PacketBuffer* msgBuf)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
 
     // Setup state for the new PASE exchange.
-    State = kState_PASEInProgress;
-    mEC = ec;
-    mCon = ec->Con;
+    handshake.State = kState_PASEInProgress;
+    handshake.EC = ec;
+    ec->AppState = &handshake;
+    handshake.Con = ec->Con;
     ec->OnMessageReceived = HandlePASEMessageResponder;
     ec->OnConnectionClosed = HandleConnectionClosed;
 
@@ -665,57 +779,43 @@ void WeaveSecurityManager::HandlePASESessionStart(ExchangeContext *ec, const IPP
     // TODO: rate limit unsuccessful PASE exchanges (WEAVE_ERROR_SECURITY_RATE_LIMIT_EXCEEDED)
 
     // Time limit overall PASE duration.
-    StartSessionTimer();
+    StartSessionTimer(handshake);
 
     // Initialize Weave Platform Memory.
     err = Platform::Security::MemoryInit();
     SuccessOrExit(err);
 
     // Prepare PASE engine and start session
-    mPASEEngine = (WeavePASEEngine *)Platform::Security::MemoryAlloc(sizeof(WeavePASEEngine), true);
-    VerifyOrExit(mPASEEngine != NULL, err = WEAVE_ERROR_NO_MEMORY);
-    mPASEEngine->Init();
-
-    err = ProcessPASEInitiatorStep1(ec, msgBuf);
+    handshake.PASEEngine = (WeavePASEEngine *)Platform::Security::MemoryAlloc(sizeof(WeavePASEEngine), true);
+    VerifyOrExit(handshake.PASEEngine != NULL, err = WEAVE_ERROR_NO_MEMORY);
+    handshake.PASEEngine->Init();
 
-    // Free the received message buffer so that it can be reused to send the outgoing messages.
-    PacketBuffer::Free(msgBuf);
+    // Once processed, the initiator's step 1 message is answered with the responder's step 1 and step 2
+    // messages, or with a reconfiguration request.
+    err = ProcessPASEInitiatorStep1(handshake, ec, msgBuf);
     msgBuf = NULL;
-
-    // Check if ProcessPASEInitiatorStep1 generated Reconfiguration Request
-    if (err == WEAVE_ERROR_PASE_RECONFIGURE_REQUIRED)
-    {
-        err = SendPASEResponderReconfigure();
-        SuccessOrExit(err);
-
-        // Reset state.
-        Reset();
-    }
-    else
-    {
-        SuccessOrExit(err);
-
-        err = SendPASEResponderStep1();
-        SuccessOrExit(err);
-
-        err = SendPASEResponderStep2();
-        SuccessOrExit(err);
-    }
+    SuccessOrExit(err);
 
 exit:
     if (msgBuf != NULL)
         PacketBuffer::Free(msgBuf);
     if (err != WEAVE_NO_ERROR)
-        HandleSessionError(err, NULL);
+        HandleSessionError(handshake, err, NULL);
 }
 
 void WeaveSecurityManager::HandlePASEMessageResponder(ExchangeContext *ec, const IPPacketInfo *pktInfo,
         const WeaveMessageInfo *msgInfo, uint32_t profileId, uint8_t msgType, PacketBuffer* msgBuf)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
-    WeaveSecurityManager *secMgr = (WeaveSecurityManager *)ec->AppState;
+    Handshake *handshake = (Handshake *)ec->AppState;
+    WeaveSecurityManager *secMgr = handshake->SecMgr;
+
+    VerifyOrDie(ec == handshake->EC);
 
-    VerifyOrDie(ec == secMgr->mEC);
+#if WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
+    if (secMgr->HoldMessage(*handshake, msgInfo, profileId, msgType, msgBuf))
+        return;
+#endif
 
     // Abort the PASE interaction immediately if we receive a status report message from the initiator.
     // This is a signal that the initiator does not want to continue.
@@ -726,46 +826,52 @@ void WeaveSecurityManager::HandlePASEMessageResponder(ExchangeContext *ec, const
     VerifyOrExit(profileId == kWeaveProfile_Security && msgType == kMsgType_PASEInitiatorStep2,
                  err = WEAVE_ERROR_INVALID_MESSAGE_TYPE);
 
-    err = secMgr->ProcessPASEInitiatorStep2(msgBuf);
-    SuccessOrExit(err);
-
-    // Free the received message buffer so that it can be reused to send the outgoing messages.
-    PacketBuffer::Free(msgBuf);
+    err = secMgr->ProcessPASEInitiatorStep2(*handshake, msgBuf);
     msgBuf = NULL;
-
-    // If performing key confirmation send a responder key confirmation message.
-    if (secMgr->mPASEEngine->PerformKeyConfirmation)
-    {
-        err = secMgr->SendPASEResponderKeyConfirm();
-        SuccessOrExit(err);
-    }
-
-    // If we've successfully establish a session, go perform the appropriate actions.
-    if (secMgr->mPASEEngine->State == WeavePASEEngine::kState_ResponderDone)
-    {
-        err = secMgr->HandleSessionEstablished();
-        SuccessOrExit(err);
-
-        secMgr->HandleSessionComplete();
-    }
+    SuccessOrExit(err);
 
 exit:
     if (err != WEAVE_NO_ERROR)
-        secMgr->HandleSessionError(err, (err == WEAVE_ERROR_STATUS_REPORT_RECEIVED) ? msgBuf : NULL);
+        secMgr->HandleSessionError(*handshake, err, (err == WEAVE_ERROR_STATUS_REPORT_RECEIVED) ? msgBuf : NULL);
     if (msgBuf != NULL)
         PacketBuffer::Free(msgBuf);
 }
 
 __attribute__((noinline))
-WEAVE_ERROR WeaveSecurityManager::ProcessPASEInitiatorStep1(ExchangeContext *ec, PacketBuffer* msgBuf)
+WEAVE_ERROR WeaveSecurityManager::ProcessPASEInitiatorStep1(Handshake &handshake, ExchangeContext *ec, PacketBuffer* msgBuf)
+{
+    CryptoStep step;
+
+    step.Init(kCryptoStep_ProcessPASEInitiatorStep1);
+    step.MsgBuf = msgBuf;
+    step.PeerNodeId = ec->PeerNodeId;
+
+    // Decode and process the initiator's step 1 message.
+    PerformCryptoStep(handshake, step);
+
+    return WEAVE_NO_ERROR;
+}
+
+void WeaveSecurityManager::FinishProcessPASEInitiatorStep1(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step)
 {
-    WEAVE_ERROR err = WEAVE_NO_ERROR;
     WeaveSessionKey *sessionKey;
 
-    // Generate and encode PASE step 1 message.
-    Platform::Security::OnTimeConsumingCryptoStart();
-    err = mPASEEngine->ProcessInitiatorStep1(msgBuf, FabricState->LocalNodeId, ec->PeerNodeId, FabricState);
-    Platform::Security::OnTimeConsumingCryptoDone();
+    // Free the received message buffer so that it can be reused to send the outgoing messages.
+    PacketBuffer::Free(step.MsgBuf);
+    step.MsgBuf = NULL;
+
+    // Check if ProcessInitiatorStep1 generated Reconfiguration Request
+    if (err == WEAVE_ERROR_PASE_RECONFIGURE_REQUIRED)
+    {
+        err = SendPASEResponderReconfigure(handshake);
+        SuccessOrExit(err);
+
+        // Reset state.
+        Reset(handshake);
+
+        ExitNow();
+    }
+
     SuccessOrExit(err);
 
     // Allocate an entry in the session key table using the key id proposed by the peer.
@@ -774,21 +880,26 @@ WEAVE_ERROR WeaveSecurityManager::ProcessPASEInitiatorStep1(ExchangeContext *ec,
     //
     // If the initiator has proposed a key id that already exists, make sure we don't remove the
     // existing key during the error clean-up process.
-    err = FabricState->AllocSessionKey(ec->PeerNodeId, mPASEEngine->SessionKeyId, ec->Con, sessionKey);
+    err = FabricState->AllocSessionKey(handshake.EC->PeerNodeId, handshake.PASEEngine->SessionKeyId, handshake.EC->Con, sessionKey);
     SuccessOrExit(err);
     sessionKey->SetLocallyInitiated(false);
     sessionKey->SetRemoveOnIdle(false); // TODO FUTURE: Set this to true when support for PASE over WRM is implemented.
 
     // Save the proposed session key id and encryption type.
-    mSessionKeyId = mPASEEngine->SessionKeyId;
-    mEncType = mPASEEngine->EncryptionType;
+    handshake.SessionKeyId = handshake.PASEEngine->SessionKeyId;
+    handshake.EncType = handshake.PASEEngine->EncryptionType;
+
+    // Once sent, the responder's step 1 message is followed by the responder's step 2 message.
+    err = SendPASEResponderStep1(handshake);
+    SuccessOrExit(err);
 
 exit:
-    return err;
+    if (err != WEAVE_NO_ERROR)
+        HandleSessionError(handshake, err, NULL);
 }
 
 __attribute__((noinline))
-WEAVE_ERROR WeaveSecurityManager::SendPASEResponderReconfigure(void)
+WEAVE_ERROR WeaveSecurityManager::SendPASEResponderReconfigure(Handshake &handshake)
 {
     WEAVE_ERROR     err     = WEAVE_NO_ERROR;
     PacketBuffer*   msgBuf  = NULL;
@@ -798,11 +909,11 @@ WEAVE_ERROR WeaveSecurityManager::SendPASEResponderReconfigure(void)
     VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
     // Generate PASE reconfigure message.
-    err = mPASEEngine->GenerateResponderReconfigure(msgBuf);
+    err = handshake.PASEEngine->GenerateResponderReconfigure(msgBuf);
     SuccessOrExit(err);
 
     // Send PASE reconfigure message.
-    err = mEC->SendMessage(kWeaveProfile_Security, kMsgType_PASEResponderReconfigure, msgBuf, 0);
+    err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_PASEResponderReconfigure, msgBuf, 0);
     msgBuf = NULL;
     SuccessOrExit(err);
 
@@ -813,91 +924,134 @@ exit:
 }
 
 __attribute__((noinline))
-WEAVE_ERROR WeaveSecurityManager::SendPASEResponderStep1(void)
+WEAVE_ERROR WeaveSecurityManager::SendPASEResponderStep1(Handshake &handshake)
 {
     WEAVE_ERROR     err     = WEAVE_NO_ERROR;
-    PacketBuffer*   msgBuf  = NULL;
+    CryptoStep      step;
+
+    step.Init(kCryptoStep_SendPASEResponderStep1);
 
     // Allocate buffer.
-    msgBuf = PacketBuffer::New();
-    VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+    step.OutMsgBuf = PacketBuffer::New();
+    VerifyOrExit(step.OutMsgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
     // Generate PASE step 1 message.
-    Platform::Security::OnTimeConsumingCryptoStart();
-    err = mPASEEngine->GenerateResponderStep1(msgBuf);
-    Platform::Security::OnTimeConsumingCryptoDone();
+    PerformCryptoStep(handshake, step);
+
+exit:
+    return err;
+}
+
+void WeaveSecurityManager::FinishSendPASEResponderStep1(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step)
+{
     SuccessOrExit(err);
 
     // Send PASE step 1 message.
-    err = mEC->SendMessage(kWeaveProfile_Security, kMsgType_PASEResponderStep1, msgBuf, 0);
-    msgBuf = NULL;
+    err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_PASEResponderStep1, step.OutMsgBuf, 0);
+    step.OutMsgBuf = NULL;
+    SuccessOrExit(err);
+
+    err = SendPASEResponderStep2(handshake);
     SuccessOrExit(err);
 
 exit:
-    if (msgBuf != NULL)
-        PacketBuffer::Free(msgBuf);
-    return err;
+    if (err != WEAVE_NO_ERROR)
+        HandleSessionError(handshake, err, NULL);
 }
 
 __attribute__((noinline))
-WEAVE_ERROR WeaveSecurityManager::SendPASEResponderStep2(void)
+WEAVE_ERROR WeaveSecurityManager::SendPASEResponderStep2(Handshake &handshake)
 {
     WEAVE_ERROR     err     = WEAVE_NO_ERROR;
-    PacketBuffer*   msgBuf  = NULL;
+    CryptoStep      step;
+
+    step.Init(kCryptoStep_SendPASEResponderStep2);
 
     // Allocate buffer.
-    msgBuf = PacketBuffer::New();
-    VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+    step.OutMsgBuf = PacketBuffer::New();
+    VerifyOrExit(step.OutMsgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
     // Generate PASE step 2 message.
-    Platform::Security::OnTimeConsumingCryptoStart();
-    err = mPASEEngine->GenerateResponderStep2(msgBuf);
-    Platform::Security::OnTimeConsumingCryptoDone();
-    SuccessOrExit(err);
-
-    // Send PASE step 2 message.
-    err = mEC->SendMessage(kWeaveProfile_Security, kMsgType_PASEResponderStep2, msgBuf, 0);
-    msgBuf = NULL;
-    SuccessOrExit(err);
+    PerformCryptoStep(handshake, step);
 
 exit:
-    if (msgBuf != NULL)
-        PacketBuffer::Free(msgBuf);
     return err;
 }
 
-__attribute__((noinline))
-WEAVE_ERROR WeaveSecurityManager::ProcessPASEInitiatorStep2(PacketBuffer* msgBuf)
+void WeaveSecurityManager::FinishSendPASEResponderStep2(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step)
 {
-    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    SuccessOrExit(err);
 
-    // Decode and process the initiator's step 2 message.
-    Platform::Security::OnTimeConsumingCryptoStart();
-    err = mPASEEngine->ProcessInitiatorStep2(msgBuf);
-    Platform::Security::OnTimeConsumingCryptoDone();
+    // Send PASE step 2 message.
+    err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_PASEResponderStep2, step.OutMsgBuf, 0);
+    step.OutMsgBuf = NULL;
     SuccessOrExit(err);
 
 exit:
-    return err;
+    if (err != WEAVE_NO_ERROR)
+        HandleSessionError(handshake, err, NULL);
 }
 
 __attribute__((noinline))
-WEAVE_ERROR WeaveSecurityManager::SendPASEResponderKeyConfirm(void)
+WEAVE_ERROR WeaveSecurityManager::ProcessPASEInitiatorStep2(Handshake &handshake, PacketBuffer* msgBuf)
 {
-    WEAVE_ERROR     err     = WEAVE_NO_ERROR;
-    PacketBuffer*   msgBuf  = NULL;
+    CryptoStep step;
 
-    // Allocate buffer.
-    msgBuf = PacketBuffer::New();
-    VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+    step.Init(kCryptoStep_ProcessPASEInitiatorStep2);
+    step.MsgBuf = msgBuf;
 
-    // Generate and encode a key confirmation message.
-    err = mPASEEngine->GenerateResponderKeyConfirm(msgBuf);
-    SuccessOrExit(err);
+    // Decode and process the initiator's step 2 message.
+    PerformCryptoStep(handshake, step);
 
-    // Send a key confirmation message.
-    err = mEC->SendMessage(kWeaveProfile_Security, kMsgType_PASEResponderKeyConfirm, msgBuf, 0);
-    msgBuf = NULL;
+    return WEAVE_NO_ERROR;
+}
+
+void WeaveSecurityManager::FinishProcessPASEInitiatorStep2(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step)
+{
+    SuccessOrExit(err);
+
+    // Free the received message buffer so that it can be reused to send the outgoing messages.
+    PacketBuffer::Free(step.MsgBuf);
+    step.MsgBuf = NULL;
+
+    // If performing key confirmation send a responder key confirmation message.
+    if (handshake.PASEEngine->PerformKeyConfirmation)
+    {
+        err = SendPASEResponderKeyConfirm(handshake);
+        SuccessOrExit(err);
+    }
+
+    // If we've successfully establish a session, go perform the appropriate actions.
+    if (handshake.PASEEngine->State == WeavePASEEngine::kState_ResponderDone)
+    {
+        err = HandleSessionEstablished(handshake);
+        SuccessOrExit(err);
+
+        HandleSessionComplete(handshake);
+    }
+
+exit:
+    if (err != WEAVE_NO_ERROR)
+        HandleSessionError(handshake, err, NULL);
+}
+
+__attribute__((noinline))
+WEAVE_ERROR WeaveSecurityManager::SendPASEResponderKeyConfirm(Handshake &handshake)
+{
+    WEAVE_ERROR     err     = WEAVE_NO_ERROR;
+    PacketBuffer*   msgBuf  = NULL;
+
+    // Allocate buffer.
+    msgBuf = PacketBuffer::New();
+    VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+    // Generate and encode a key confirmation message.
+    err = handshake.PASEEngine->GenerateResponderKeyConfirm(msgBuf);
+    SuccessOrExit(err);
+
+    // Send a key confirmation message.
+    err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_PASEResponderKeyConfirm, msgBuf, 0);
+    msgBuf = NULL;
     SuccessOrExit(err);
 
 exit:
@@ -938,6 +1092,7 @@ WEAVE_ERROR WeaveSecurityManager::StartCASESession(WeaveConnection *con, uint64_
                                                    WeaveCASEAuthDelegate *authDelegate, uint64_t terminatingNodeId)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
+    Handshake *handshake;
     WeaveSessionKey *sessionKey = NULL;
     bool clearStateOnError = false;
     bool isSharedSession = (terminatingNodeId != kNodeIdNotSpecified);
@@ -966,7 +1121,7 @@ WEAVE_ERROR WeaveSecurityManager::StartCASESession(WeaveConnection *con, uint64_
             // the concurrent request to wait until the session is fully established.
             //
             // If the located shared session is NOT in the process of being established...
-            if (State != kState_CASEInProgress || mEC->PeerNodeId != terminatingNodeId || mSessionKeyId != sessionKey->MsgEncKey.KeyId)
+            if (!IsSharedSessionInProgress(terminatingNodeId, sessionKey->MsgEncKey.KeyId))
             {
                 // Add a new end node to the list of end nodes associated with the session.
                 err = FabricState->AddSharedSessionEndNode(sessionKey, peerNodeId);
@@ -983,8 +1138,9 @@ WEAVE_ERROR WeaveSecurityManager::StartCASESession(WeaveConnection *con, uint64_
         }
     }
 
-    // Verify there is no session in process.
-    VerifyOrExit(State == kState_Idle, err = WEAVE_ERROR_SECURITY_MANAGER_BUSY);
+    // Verify there is room for another session establishment.
+    handshake = AllocHandshake();
+    VerifyOrExit(handshake != NULL, err = WEAVE_ERROR_SECURITY_MANAGER_BUSY);
 
     WEAVE_FAULT_INJECT(nl::Weave::FaultInjection::kFault_SecMgrBusy,
         {
@@ -992,14 +1148,14 @@ WEAVE_ERROR WeaveSecurityManager::StartCASESession(WeaveConnection *con, uint64_
             ExitNow(err = WEAVE_ERROR_SECURITY_MANAGER_BUSY);
         });
 
-    State = kState_CASEInProgress;
-    mRequestedAuthMode = requestedAuthMode;
-    mEncType = encType;
-    mCon = con;
-    mStartSecureSession_OnComplete = onComplete;
-    mStartSecureSession_OnError = onError;
-    mStartSecureSession_ReqState = reqState;
-    mSessionKeyId = WeaveKeyId::kNone;
+    handshake->State = kState_CASEInProgress;
+    handshake->RequestedAuthMode = requestedAuthMode;
+    handshake->EncType = encType;
+    handshake->Con = con;
+    handshake->StartSecureSession_OnComplete = onComplete;
+    handshake->StartSecureSession_OnError = onError;
+    handshake->StartSecureSession_ReqState = reqState;
+    handshake->SessionKeyId = WeaveKeyId::kNone;
 
     // Any error after that would require state clearing in case of error.
     clearStateOnError = true;
@@ -1007,11 +1163,11 @@ WEAVE_ERROR WeaveSecurityManager::StartCASESession(WeaveConnection *con, uint64_
     // Allocate an entry in the session key table identified by a random key id. The actual
     // key itself will be set once the session is established.
     err = FabricState->AllocSessionKey((isSharedSession ? terminatingNodeId : peerNodeId),
-                                       WeaveKeyId::kNone, con, sessionKey);
+                                       WeaveKeyId::kNone, con, sessionKey, true);
     SuccessOrExit(err);
     sessionKey->SetLocallyInitiated(true);
     sessionKey->SetSharedSession(isSharedSession);
-    mSessionKeyId = sessionKey->MsgEncKey.KeyId;
+    handshake->SessionKeyId = sessionKey->MsgEncKey.KeyId;
 
     // If requested session is shared.
     if (isSharedSession)
@@ -1022,7 +1178,7 @@ WEAVE_ERROR WeaveSecurityManager::StartCASESession(WeaveConnection *con, uint64_
     }
 
     // Create a new exchange context.
-    err = NewSessionExchange((isSharedSession ? terminatingNodeId : peerNodeId), peerAddr, peerPort);
+    err = NewSessionExchange(*handshake, (isSharedSession ? terminatingNodeId : peerNodeId), peerAddr, peerPort);
     SuccessOrExit(err);
 
     // Initialize Weave Platform Memory.
@@ -1030,29 +1186,35 @@ WEAVE_ERROR WeaveSecurityManager::StartCASESession(WeaveConnection *con, uint64_
     SuccessOrExit(err);
 
     // Allocate and Initialize CASE Engine object
-    mCASEEngine = (WeaveCASEEngine *)Platform::Security::MemoryAlloc(sizeof(WeaveCASEEngine), true);
-    VerifyOrExit(mCASEEngine != NULL, err = WEAVE_ERROR_NO_MEMORY);
-    mCASEEngine->Init();
+    handshake->CASEEngine = (WeaveCASEEngine *)Platform::Security::MemoryAlloc(sizeof(WeaveCASEEngine), true);
+    VerifyOrExit(handshake->CASEEngine != NULL, err = WEAVE_ERROR_NO_MEMORY);
+    handshake->CASEEngine->Init();
 
     // Initialize CASE Authentication Delegate
     if (authDelegate == NULL)
         authDelegate = mDefaultAuthDelegate;
     VerifyOrExit(authDelegate != NULL, err = WEAVE_ERROR_NO_CASE_AUTH_DELEGATE);
-    mCASEEngine->AuthDelegate = authDelegate;
+    handshake->CASEEngine->AuthDelegate = authDelegate;
 
     // Set the allowed CASE configs and ECDH curves.
-    mCASEEngine->SetAllowedConfigs(InitiatorAllowedCASEConfigs);
-    mCASEEngine->SetAllowedCurves(InitiatorAllowedCASECurves);
+    handshake->CASEEngine->SetAllowedConfigs(InitiatorAllowedCASEConfigs);
+    handshake->CASEEngine->SetAllowedCurves(InitiatorAllowedCASECurves);
 
     // Set the expected peer certificate type based on the requested authentication mode.
-    mCASEEngine->SetCertType(CertTypeFromAuthMode(requestedAuthMode));
+    handshake->CASEEngine->SetCertType(CertTypeFromAuthMode(requestedAuthMode));
 
 #if WEAVE_CONFIG_SECURITY_TEST_MODE
-    mCASEEngine->SetUseKnownECDHKey(CASEUseKnownECDHKey);
+    handshake->CASEEngine->SetUseKnownECDHKey(CASEUseKnownECDHKey);
+#endif
+
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+    // Resume an earlier session with the peer if possible.  Shared sessions are never resumed.
+    if (!isSharedSession && StartCASEResumeSession(*handshake))
+        ExitNow();
 #endif
 
     // Start CASE Session using specified initiator parameters.
-    StartCASESession(InitiatorCASEConfig, InitiatorCASECurveId);
+    StartCASESession(*handshake, InitiatorCASEConfig, InitiatorCASECurveId);
 
 exit:
     if (err != WEAVE_NO_ERROR && clearStateOnError)
@@ -1060,81 +1222,179 @@ exit:
         if (sessionKey != NULL)
             FabricState->RemoveSessionKey(sessionKey);
 
-        Reset();
+        Reset(*handshake);
     }
 
     return err;
 }
 
-void WeaveSecurityManager::StartCASESession(uint32_t config, uint32_t curveId)
+void WeaveSecurityManager::StartCASESession(Handshake &handshake, uint32_t config, uint32_t curveId)
 {
-    WEAVE_ERROR err;
-    PacketBuffer * msgBuf = NULL;
-    uint16_t sendFlags = 0;
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    CryptoStep step;
+
+    step.Init(kCryptoStep_SendCASEBeginSessionRequest);
 
     // Allocate a buffer to hold the Begin Session message.
-    msgBuf = PacketBuffer::New();
-    VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+    step.OutMsgBuf = PacketBuffer::New();
+    VerifyOrExit(step.OutMsgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+    // Set up the parameters of the CASE Begin Session message.
+    step.ReqCtx.Reset();
+    step.ReqCtx.SetIsInitiator(true);
+    step.ReqCtx.PeerNodeId = handshake.EC->PeerNodeId;
+    step.ReqCtx.ProtocolConfig = config;
+    handshake.CASEEngine->SetAlternateConfigs(step.ReqCtx);
+    step.ReqCtx.CurveId = curveId;
+    handshake.CASEEngine->SetAlternateCurves(step.ReqCtx);
+    step.ReqCtx.SetPerformKeyConfirm(true);
+    step.ReqCtx.SessionKeyId = handshake.SessionKeyId;
+    step.ReqCtx.EncryptionType = handshake.EncType;
 
-    // Generate the CASE Begin Session message.
+#if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+    if (handshake.Con == NULL)
     {
-        CASE::BeginSessionRequestContext reqCtx;
+        step.SendFlags = ExchangeContext::kSendFlag_RequestAck;
+    }
+#endif
 
-        reqCtx.Reset();
-        reqCtx.SetIsInitiator(true);
-        reqCtx.PeerNodeId = mEC->PeerNodeId;
-        reqCtx.ProtocolConfig = config;
-        mCASEEngine->SetAlternateConfigs(reqCtx);
-        reqCtx.CurveId = curveId;
-        mCASEEngine->SetAlternateCurves(reqCtx);
-        reqCtx.SetPerformKeyConfirm(true);
-        reqCtx.SessionKeyId = mSessionKeyId;
-        reqCtx.EncryptionType = mEncType;
+    // Generate the CASE Begin Session message.
+    PerformCryptoStep(handshake, step);
 
-        Platform::Security::OnTimeConsumingCryptoStart();
-        err = mCASEEngine->GenerateBeginSessionRequest(reqCtx, msgBuf);
-        Platform::Security::OnTimeConsumingCryptoDone();
-        SuccessOrExit(err);
-    }
+exit:
+    step.Release();
+    if (err != WEAVE_NO_ERROR)
+        HandleSessionError(handshake, err, NULL);
+}
+
+void WeaveSecurityManager::FinishSendCASEBeginSessionRequest(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step)
+{
+    SuccessOrExit(err);
+
+    // Send the message.
+    err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_CASEBeginSessionRequest, step.OutMsgBuf, step.SendFlags);
+    step.OutMsgBuf = NULL;
+    SuccessOrExit(err);
+
+    handshake.EC->OnMessageReceived = HandleCASEMessageInitiator;
+    handshake.EC->OnConnectionClosed = HandleConnectionClosed;
+
+    // Time limit overall CASE duration.
+    StartSessionTimer(handshake);
+
+exit:
+    if (err != WEAVE_NO_ERROR)
+        HandleSessionError(handshake, err, NULL);
+}
+
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+
+/**
+ * Send a CASE ResumeSessionRequest, if a resumption secret is held for the peer of the given handshake.
+ *
+ * Errors that occur once the request is under way are reported through HandleSessionError().
+ *
+ * @return false if no suitable resumption secret is held, in which case a new CASE session must be
+ *         established instead.
+ */
+bool WeaveSecurityManager::StartCASEResumeSession(Handshake &handshake)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    WeaveSessionResumption *resumption;
+    PacketBuffer *msgBuf = NULL;
+    uint16_t sendFlags = 0;
+
+    resumption = FabricState->FindSessionResumption(handshake.EC->PeerNodeId);
+    if (resumption == NULL)
+        return false;
+
+    // The peer must originally have been authenticated in the way requested by the application.
+    if (handshake.RequestedAuthMode != kWeaveAuthMode_CASE_AnyCert && handshake.RequestedAuthMode != resumption->AuthMode)
+        return false;
+
+    // A resumption secret is only ever offered once.  Should the peer decline it, the new session
+    // established in its place leaves a fresh one behind.
+    handshake.ResumeCtx.Reset();
+    handshake.ResumeCtx.SetResumption(*resumption);
+    FabricState->RemoveSessionResumption(resumption);
+
+    handshake.ResumeCtx.SessionKeyId = handshake.SessionKeyId;
+    handshake.ResumeCtx.EncryptionType = handshake.EncType;
+    handshake.ResumptionState = kResumptionState_RequestSent;
+
+    // Generate the ResumeSessionRequest message.
+    msgBuf = PacketBuffer::New();
+    VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+    err = handshake.ResumeCtx.GenerateRequest(msgBuf);
+    SuccessOrExit(err);
 
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
-    if (mCon == NULL)
+    if (handshake.Con == NULL)
     {
         sendFlags = ExchangeContext::kSendFlag_RequestAck;
     }
 #endif
 
     // Send the message.
-    err = mEC->SendMessage(kWeaveProfile_Security, kMsgType_CASEBeginSessionRequest, msgBuf, sendFlags);
+    err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_CASEResumeSessionRequest, msgBuf, sendFlags);
     msgBuf = NULL;
     SuccessOrExit(err);
 
-    mEC->OnMessageReceived = HandleCASEMessageInitiator;
-    mEC->OnConnectionClosed = HandleConnectionClosed;
+    handshake.EC->OnMessageReceived = HandleCASEMessageInitiator;
+    handshake.EC->OnConnectionClosed = HandleConnectionClosed;
 
-    // Time limit overall CASE duration.
-    StartSessionTimer();
+    // Time limit the resumption attempt.  A fall back to a new session restarts the timer.
+    StartSessionTimer(handshake);
 
 exit:
     if (msgBuf != NULL)
         PacketBuffer::Free(msgBuf);
     if (err != WEAVE_NO_ERROR)
-        HandleSessionError(err, NULL);
+        HandleSessionError(handshake, err, NULL);
+    return true;
 }
 
+#endif // WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+
 void WeaveSecurityManager::HandleCASEMessageInitiator(ExchangeContext *ec, const IPPacketInfo *pktInfo,
         const WeaveMessageInfo *msgInfo, uint32_t profileId, uint8_t msgType, PacketBuffer* msgBuf)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
-    WeaveSecurityManager *secMgr = (WeaveSecurityManager *)ec->AppState;
-    uint16_t sendFlags = 0;
+    Handshake *handshake = (Handshake *)ec->AppState;
+    WeaveSecurityManager *secMgr = handshake->SecMgr;
+
+    VerifyOrDie(ec == handshake->EC);
 
-    VerifyOrDie(ec == secMgr->mEC);
+#if WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
+    if (secMgr->HoldMessage(*handshake, msgInfo, profileId, msgType, msgBuf))
+        return;
+#endif
 
     // Abort the CASE interaction immediately if we receive a status report message from the responder.
     // This is a signal that the responder does not want to continue.
     if (profileId == kWeaveProfile_Common && msgType == kMsgType_StatusReport)
+    {
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+        // ...unless the responder merely declined to resume an earlier session, in which case
+        // fall back to establishing a new one.
+        if (handshake->ResumptionState == kResumptionState_RequestSent)
+        {
+            PacketBuffer::Free(msgBuf);
+            msgBuf = NULL;
+
+            handshake->ResumeCtx.Reset();
+            handshake->ResumptionState = kResumptionState_None;
+
+            // The responder considers the resumption exchange to be over, so continue on a new one.
+            err = secMgr->NewSessionExchange(*handshake, ec->PeerNodeId, ec->PeerAddr, ec->PeerPort);
+            SuccessOrExit(err);
+
+            secMgr->StartCASESession(*handshake, secMgr->InitiatorCASEConfig, secMgr->InitiatorCASECurveId);
+            ExitNow();
+        }
+#endif
         ExitNow(err = WEAVE_ERROR_STATUS_REPORT_RECEIVED);
+    }
 
     // All other messages must be part of the Security profile.
     VerifyOrExit(profileId == kWeaveProfile_Security, err = WEAVE_ERROR_INVALID_MESSAGE_TYPE);
@@ -1145,68 +1405,14 @@ void WeaveSecurityManager::HandleCASEMessageInitiator(ExchangeContext *ec, const
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
         // Flush any pending WRM ACKs before we begin the long crypto operation,
         // to prevent the peer from re-transmitting the Begin Session response.
-        err = secMgr->mEC->WRMPFlushAcks();
+        err = handshake->EC->WRMPFlushAcks();
         SuccessOrExit(err);
 #endif
 
         // Decode and process the BeginSessionResponse.
-        {
-            CASE::BeginSessionResponseContext respCtx;
-
-            respCtx.Reset();
-            respCtx.SetIsInitiator(true);
-            respCtx.PeerNodeId = ec->PeerNodeId;
-            respCtx.MsgInfo = msgInfo;
-
-            Platform::Security::OnTimeConsumingCryptoStart();
-            err = secMgr->mCASEEngine->ProcessBeginSessionResponse(msgBuf, respCtx);
-            Platform::Security::OnTimeConsumingCryptoDone();
-            SuccessOrExit(err);
-        }
-
-        // Release the buffer containing the response.
-        PacketBuffer::Free(msgBuf);
+        err = secMgr->ProcessCASEBeginSessionResponse(*handshake, msgInfo, msgBuf);
         msgBuf = NULL;
-
-        // If performing key confirmation...
-        if (secMgr->mCASEEngine->PerformingKeyConfirm())
-        {
-            // Generate and encode an InitiatorKeyConfirm message.
-            msgBuf = PacketBuffer::New();
-            VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
-            err = secMgr->mCASEEngine->GenerateInitiatorKeyConfirm(msgBuf);
-            SuccessOrExit(err);
-
-#if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
-            if (secMgr->mCon == NULL)
-            {
-                sendFlags = ExchangeContext::kSendFlag_RequestAck;
-            }
-#endif
-
-            // Send the InitiatorKeyConfirm message to the peer.
-            err = secMgr->mEC->SendMessage(kWeaveProfile_Security, kMsgType_CASEInitiatorKeyConfirm, msgBuf, sendFlags);
-            msgBuf = NULL;
-            SuccessOrExit(err);
-        }
-
-        // Initialize the newly established security session.
-        err = secMgr->HandleSessionEstablished();
         SuccessOrExit(err);
-
-#if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
-        // Complete the session when any of these is true:
-        //     - session establishment was done over a Weave connection
-        //     - key confirmation wasn't required
-        // For WRMP when key confirmation is required, the session will be completed
-        // on one of these events:
-        //     - Received Ack from the peer for the last message on this exchange (CASEInitiatorKeyConfirm)
-        //     - Received first message from the peer encrypted with established session key (mSessionKeyId)
-        if (secMgr->mCon || !secMgr->mCASEEngine->PerformingKeyConfirm())
-#endif
-        {
-            secMgr->HandleSessionComplete();
-        }
     }
 
     // Otherwise, if the message is a Reconfigure...
@@ -1215,7 +1421,7 @@ void WeaveSecurityManager::HandleCASEMessageInitiator(ExchangeContext *ec, const
         // Process the reconfigure message.  If this proposed alternate configuration is not acceptable,
         // the call will fail with an error.
         CASE::ReconfigureContext reconfCtx;
-        err = secMgr->mCASEEngine->ProcessReconfigure(msgBuf, reconfCtx);
+        err = handshake->CASEEngine->ProcessReconfigure(msgBuf, reconfCtx);
         SuccessOrExit(err);
 
         // Release the buffer containing the response.
@@ -1225,12 +1431,37 @@ void WeaveSecurityManager::HandleCASEMessageInitiator(ExchangeContext *ec, const
         // Create a new exchange context for the new CASE session.  This will result in the old exchange context
         // being closed. (NOTE: We cannot re-use the initial exchange for the new CASE session because the peer
         // believes the exchange ended when the Reconfigure message was sent).
-        err = secMgr->NewSessionExchange(ec->PeerNodeId, ec->PeerAddr, ec->PeerPort);
+        err = secMgr->NewSessionExchange(*handshake, ec->PeerNodeId, ec->PeerAddr, ec->PeerPort);
         SuccessOrExit(err);
 
         // Restart the CASE session using the peer's propose parameters.
-        secMgr->StartCASESession(reconfCtx.ProtocolConfig, reconfCtx.CurveId);
+        secMgr->StartCASESession(*handshake, reconfCtx.ProtocolConfig, reconfCtx.CurveId);
+    }
+
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+    // Otherwise, if the message is a ResumeSessionResponse...
+    else if (msgType == kMsgType_CASEResumeSessionResponse)
+    {
+        VerifyOrExit(handshake->ResumptionState == kResumptionState_RequestSent, err = WEAVE_ERROR_INVALID_MESSAGE_TYPE);
+
+        // Verify the response and derive the key of the resumed session.
+        err = handshake->ResumeCtx.ProcessResponse(msgBuf);
+        SuccessOrExit(err);
+
+#if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+        // Acknowledge the response before the exchange is closed.
+        err = handshake->EC->WRMPFlushAcks();
+        SuccessOrExit(err);
+#endif
+
+        // The response proves that the responder holds the resumption secret, so the session
+        // is complete without further key confirmation.
+        err = secMgr->HandleSessionEstablished(*handshake);
+        SuccessOrExit(err);
+
+        secMgr->HandleSessionComplete(*handshake);
     }
+#endif
 
     // Fail if the message is unrecognized.
     else
@@ -1238,9 +1469,81 @@ void WeaveSecurityManager::HandleCASEMessageInitiator(ExchangeContext *ec, const
 
 exit:
     if (err != WEAVE_NO_ERROR)
-        secMgr->HandleSessionError(err, (err == WEAVE_ERROR_STATUS_REPORT_RECEIVED) ? msgBuf : NULL);
+        secMgr->HandleSessionError(*handshake, err, (err == WEAVE_ERROR_STATUS_REPORT_RECEIVED) ? msgBuf : NULL);
+    if (msgBuf != NULL)
+        PacketBuffer::Free(msgBuf);
+}
+
+WEAVE_ERROR WeaveSecurityManager::ProcessCASEBeginSessionResponse(Handshake &handshake, const WeaveMessageInfo *msgInfo, PacketBuffer* msgBuf)
+{
+    CryptoStep step;
+
+    step.Init(kCryptoStep_ProcessCASEBeginSessionResponse);
+    step.MsgBuf = msgBuf;
+    step.MsgInfo = *msgInfo;
+    step.PeerNodeId = handshake.EC->PeerNodeId;
+
+    PerformCryptoStep(handshake, step);
+
+    return WEAVE_NO_ERROR;
+}
+
+void WeaveSecurityManager::FinishProcessCASEBeginSessionResponse(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step)
+{
+    PacketBuffer *msgBuf = NULL;
+    uint16_t sendFlags = 0;
+
+    SuccessOrExit(err);
+
+    // Release the buffer containing the response.
+    PacketBuffer::Free(step.MsgBuf);
+    step.MsgBuf = NULL;
+
+    // If performing key confirmation...
+    if (handshake.CASEEngine->PerformingKeyConfirm())
+    {
+        // Generate and encode an InitiatorKeyConfirm message.
+        msgBuf = PacketBuffer::New();
+        VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+        err = handshake.CASEEngine->GenerateInitiatorKeyConfirm(msgBuf);
+        SuccessOrExit(err);
+
+#if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+        if (handshake.Con == NULL)
+        {
+            sendFlags = ExchangeContext::kSendFlag_RequestAck;
+        }
+#endif
+
+        // Send the InitiatorKeyConfirm message to the peer.
+        err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_CASEInitiatorKeyConfirm, msgBuf, sendFlags);
+        msgBuf = NULL;
+        SuccessOrExit(err);
+    }
+
+    // Initialize the newly established security session.
+    err = HandleSessionEstablished(handshake);
+    SuccessOrExit(err);
+
+#if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+    // Complete the session when any of these is true:
+    //     - session establishment was done over a Weave connection
+    //     - key confirmation wasn't required
+    // For WRMP when key confirmation is required, the session will be completed
+    // on one of these events:
+    //     - Received Ack from the peer for the last message on this exchange (CASEInitiatorKeyConfirm)
+    //     - Received first message from the peer encrypted with established session key (SessionKeyId)
+    if (handshake.Con || !handshake.CASEEngine->PerformingKeyConfirm())
+#endif
+    {
+        HandleSessionComplete(handshake);
+    }
+
+exit:
     if (msgBuf != NULL)
         PacketBuffer::Free(msgBuf);
+    if (err != WEAVE_NO_ERROR)
+        HandleSessionError(handshake, err, NULL);
 }
 
 #else // !WEAVE_CONFIG_ENABLE_CASE_INITIATOR
@@ -1257,18 +1560,21 @@ WEAVE_ERROR WeaveSecurityManager::StartCASESession(WeaveConnection *con, uint64_
 
 #if WEAVE_CONFIG_ENABLE_CASE_RESPONDER
 
-void WeaveSecurityManager::HandleCASESessionStart(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo, PacketBuffer* msgBuf)
+void WeaveSecurityManager::HandleCASESessionStart(Handshake &handshake, ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo, PacketBuffer* msgBuf)
 {
     WEAVE_ERROR err;
-    WeaveSessionKey * sessionKey;
-    CASE::BeginSessionRequestContext reqCtx;
-    CASE::ReconfigureContext reconfCtx;
-    PacketBuffer * respMsgBuf = NULL;
-    uint16_t sendFlags = 0;
+    CryptoStep step;
+
+    step.Init(kCryptoStep_ProcessCASEBeginSessionRequest);
+    step.MsgBuf = msgBuf;
+    step.MsgInfo = *msgInfo;
+    step.PeerNodeId = ec->PeerNodeId;
+    msgBuf = NULL;
 
-    State = kState_CASEInProgress;
-    mEC = ec;
-    mCon = ec->Con;
+    handshake.State = kState_CASEInProgress;
+    handshake.EC = ec;
+    ec->AppState = &handshake;
+    handshake.Con = ec->Con;
     ec->OnMessageReceived = HandleCASEMessageResponder;
     ec->OnConnectionClosed = HandleConnectionClosed;
 
@@ -1276,17 +1582,17 @@ void WeaveSecurityManager::HandleCASESessionStart(ExchangeContext *ec, const IPP
     ec->AddRef();
 
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
-    if (mCon == NULL)
+    if (handshake.Con == NULL)
     {
-        mEC->OnAckRcvd = WRMPHandleAckRcvd;
-        mEC->OnSendError = WRMPHandleSendError;
+        handshake.EC->OnAckRcvd = WRMPHandleAckRcvd;
+        handshake.EC->OnSendError = WRMPHandleSendError;
 
         // Flush any pending WRM ACKs before we begin the long crypto operation,
         // to prevent the peer from re-transmitting the Begin Session request.
-        err = mEC->WRMPFlushAcks();
+        err = handshake.EC->WRMPFlushAcks();
         SuccessOrExit(err);
 
-        sendFlags |= ExchangeContext::kSendFlag_RequestAck;
+        step.SendFlags |= ExchangeContext::kSendFlag_RequestAck;
     }
 #endif
 
@@ -1295,140 +1601,153 @@ void WeaveSecurityManager::HandleCASESessionStart(ExchangeContext *ec, const IPP
     SuccessOrExit(err);
 
     // Allocate and initialize a CASE engine.
-    mCASEEngine = (WeaveCASEEngine *)Platform::Security::MemoryAlloc(sizeof(WeaveCASEEngine), true);
-    VerifyOrExit(mCASEEngine != NULL, err = WEAVE_ERROR_NO_MEMORY);
-    mCASEEngine->Init();
+    handshake.CASEEngine = (WeaveCASEEngine *)Platform::Security::MemoryAlloc(sizeof(WeaveCASEEngine), true);
+    VerifyOrExit(handshake.CASEEngine != NULL, err = WEAVE_ERROR_NO_MEMORY);
+    handshake.CASEEngine->Init();
 
     // Since this session is being initiated by a remote node, use the default auth delegate.
     // Reject the request if no auth delegate has been set.
     VerifyOrExit(mDefaultAuthDelegate != NULL, err = WEAVE_ERROR_NO_CASE_AUTH_DELEGATE);
-    mCASEEngine->AuthDelegate = mDefaultAuthDelegate;
+    handshake.CASEEngine->AuthDelegate = mDefaultAuthDelegate;
 
     // Set the allowed protocol options for a responder.
-    mCASEEngine->SetAllowedConfigs(ResponderAllowedCASEConfigs);
-    mCASEEngine->SetAllowedCurves(ResponderAllowedCASECurves);
-    mCASEEngine->SetResponderRequiresKeyConfirm(true);
+    handshake.CASEEngine->SetAllowedConfigs(ResponderAllowedCASEConfigs);
+    handshake.CASEEngine->SetAllowedCurves(ResponderAllowedCASECurves);
+    handshake.CASEEngine->SetResponderRequiresKeyConfirm(true);
 
 #if WEAVE_CONFIG_SECURITY_TEST_MODE
-    mCASEEngine->SetUseKnownECDHKey(CASEUseKnownECDHKey);
+    handshake.CASEEngine->SetUseKnownECDHKey(CASEUseKnownECDHKey);
 #endif
 
     // Process the BeginSessionRequest
-    reqCtx.Reset();
-    reqCtx.PeerNodeId = ec->PeerNodeId;
-    reqCtx.MsgInfo = msgInfo;
-    reconfCtx.Reset();
-    Platform::Security::OnTimeConsumingCryptoStart();
-    err = mCASEEngine->ProcessBeginSessionRequest(msgBuf, reqCtx, reconfCtx);
-    Platform::Security::OnTimeConsumingCryptoDone();
-    if (err != WEAVE_ERROR_CASE_RECONFIG_REQUIRED)
-        SuccessOrExit(err);
+    PerformCryptoStep(handshake, step);
+
+exit:
+    step.Release();
+    if (err != WEAVE_NO_ERROR)
+        HandleSessionError(handshake, err, NULL);
+}
+
+void WeaveSecurityManager::FinishProcessCASEBeginSessionRequest(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step)
+{
+    WeaveSessionKey * sessionKey;
+    PacketBuffer * respMsgBuf = NULL;
 
     // If a reconfigure is required...
     if (err == WEAVE_ERROR_CASE_RECONFIG_REQUIRED)
     {
         // Discard the request buffer.
-        PacketBuffer::Free(msgBuf);
-        msgBuf = NULL;
+        PacketBuffer::Free(step.MsgBuf);
+        step.MsgBuf = NULL;
 
         // Encode a CASE Reconfigure message into a new buffer.
         respMsgBuf = PacketBuffer::New();
         VerifyOrExit(respMsgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
-        err = reconfCtx.Encode(respMsgBuf);
+        err = step.ReconfCtx.Encode(respMsgBuf);
         SuccessOrExit(err);
 
         // Send the Reconfigure message to the peer.
-        err = ec->SendMessage(kWeaveProfile_Security, kMsgType_CASEReconfigure, respMsgBuf, sendFlags);
+        err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_CASEReconfigure, respMsgBuf, step.SendFlags);
         respMsgBuf = NULL;
         SuccessOrExit(err);
 
         // Reset the security manager.
-        Reset();
+        Reset(handshake);
+
+        ExitNow();
     }
 
+    SuccessOrExit(err);
+
     // Otherwise the proposed protocol parameters are acceptable, so...
-    else
-    {
-        // Allocate an entry in the session key table using the key id proposed by the peer.
-        // If the session is being established over a Weave connection, arrange for the session key to
-        // be bound to the connection, such that when the connection closes, the key is removed.
-        // Set the RemoveOnIdle flag so that the session will be automatically removed after a period of
-        // inactivity (note that this only applies to sessions that are NOT bound to connections).
-        err = FabricState->AllocSessionKey(ec->PeerNodeId, reqCtx.SessionKeyId, ec->Con, sessionKey);
-        SuccessOrExit(err);
-        sessionKey->SetLocallyInitiated(false);
-        sessionKey->SetRemoveOnIdle(true);
 
-        // Save the proposed session key id and encryption type.
-        mSessionKeyId = reqCtx.SessionKeyId;
-        mEncType = reqCtx.EncryptionType;
+    // Allocate an entry in the session key table using the key id proposed by the peer.
+    // If the session is being established over a Weave connection, arrange for the session key to
+    // be bound to the connection, such that when the connection closes, the key is removed.
+    // Set the RemoveOnIdle flag so that the session will be automatically removed after a period of
+    // inactivity (note that this only applies to sessions that are NOT bound to connections).
+    err = FabricState->AllocSessionKey(handshake.EC->PeerNodeId, step.ReqCtx.SessionKeyId, handshake.EC->Con, sessionKey);
+    SuccessOrExit(err);
+    sessionKey->SetLocallyInitiated(false);
+    sessionKey->SetRemoveOnIdle(true);
 
-        // Allocate a buffer to hold the encoded BeginSessionResponse message.
-        respMsgBuf = PacketBuffer::New();
-        VerifyOrExit(respMsgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+    // Save the proposed session key id and encryption type.
+    handshake.SessionKeyId = step.ReqCtx.SessionKeyId;
+    handshake.EncType = step.ReqCtx.EncryptionType;
 
-        // Generate the BeginSessionResponse message.
-        {
-            CASE::BeginSessionResponseContext respCtx;
+    // Generate the BeginSessionResponse message.  The request context refers to the request
+    // message, so the same step, and the request buffer it holds, is carried on to the next operation.
+    step.Id = kCryptoStep_SendCASEBeginSessionResponse;
 
-            respCtx.Reset();
-            respCtx.PeerNodeId = ec->PeerNodeId;
-            respCtx.MsgInfo = msgInfo;
-            respCtx.ProtocolConfig = reqCtx.ProtocolConfig;
-            respCtx.CurveId = reqCtx.CurveId;
-            respCtx.SetPerformKeyConfirm(true);
+    // Allocate a buffer to hold the encoded BeginSessionResponse message.
+    step.OutMsgBuf = PacketBuffer::New();
+    VerifyOrExit(step.OutMsgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
-            Platform::Security::OnTimeConsumingCryptoStart();
-            err = mCASEEngine->GenerateBeginSessionResponse(respCtx, respMsgBuf, reqCtx);
-            Platform::Security::OnTimeConsumingCryptoDone();
-            SuccessOrExit(err);
-        }
+    step.RespCtx.Reset();
+    step.RespCtx.PeerNodeId = step.PeerNodeId;
+    step.RespCtx.ProtocolConfig = step.ReqCtx.ProtocolConfig;
+    step.RespCtx.CurveId = step.ReqCtx.CurveId;
+    step.RespCtx.SetPerformKeyConfirm(true);
 
-        // Send the BeginSessionResponse message to the peer.
-        err = ec->SendMessage(kWeaveProfile_Security, kMsgType_CASEBeginSessionResponse, respMsgBuf, sendFlags);
-        respMsgBuf = NULL;
-        SuccessOrExit(err);
+    PerformCryptoStep(handshake, step);
 
-        // Start a timer to limit the overall duration of session establishment.
-        StartSessionTimer();
+exit:
+    if (respMsgBuf != NULL)
+        PacketBuffer::Free(respMsgBuf);
+    if (err != WEAVE_NO_ERROR)
+        HandleSessionError(handshake, err, NULL);
+}
 
-        // If the CASE interaction is complete...
-        // (NOTE: this will only be true if the initiator didn't request key confirmation).
-        if (mCASEEngine->State == CASE::WeaveCASEEngine::kState_Complete)
-        {
-            // Initialize the new session.
-            err = HandleSessionEstablished();
-            SuccessOrExit(err);
+void WeaveSecurityManager::FinishSendCASEBeginSessionResponse(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step)
+{
+    SuccessOrExit(err);
+
+    // Send the BeginSessionResponse message to the peer.
+    err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_CASEBeginSessionResponse, step.OutMsgBuf, step.SendFlags);
+    step.OutMsgBuf = NULL;
+    SuccessOrExit(err);
+
+    // Start a timer to limit the overall duration of session establishment.
+    StartSessionTimer(handshake);
+
+    // If the CASE interaction is complete...
+    // (NOTE: this will only be true if the initiator didn't request key confirmation).
+    if (handshake.CASEEngine->State == CASE::WeaveCASEEngine::kState_Complete)
+    {
+        // Initialize the new session.
+        err = HandleSessionEstablished(handshake);
+        SuccessOrExit(err);
 
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
-            // 1. Complete the session now if it was established over a connection.
-            // 2. For WRMP the session will be completed on one of these events:
-            //     - Received Ack from the peer for the last message on this exchange (CASEBeginSessionResponse)
-            //     - Received first message from the peer encrypted with established session key (mSessionKeyId)
-            if (mCon)
+        // 1. Complete the session now if it was established over a connection.
+        // 2. For WRMP the session will be completed on one of these events:
+        //     - Received Ack from the peer for the last message on this exchange (CASEBeginSessionResponse)
+        //     - Received first message from the peer encrypted with established session key (SessionKeyId)
+        if (handshake.Con)
 #endif
-            {
-                HandleSessionComplete();
-            }
+        {
+            HandleSessionComplete(handshake);
         }
     }
 
 exit:
     if (err != WEAVE_NO_ERROR)
-        HandleSessionError(err, NULL);
-    if (msgBuf != NULL)
-        PacketBuffer::Free(msgBuf);
-    if (respMsgBuf != NULL)
-        PacketBuffer::Free(respMsgBuf);
+        HandleSessionError(handshake, err, NULL);
 }
 
 void WeaveSecurityManager::HandleCASEMessageResponder(ExchangeContext *ec, const IPPacketInfo *pktInfo,
         const WeaveMessageInfo *msgInfo, uint32_t profileId, uint8_t msgType, PacketBuffer* msgBuf)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
-    WeaveSecurityManager *secMgr = (WeaveSecurityManager *)ec->AppState;
+    Handshake *handshake = (Handshake *)ec->AppState;
+    WeaveSecurityManager *secMgr = handshake->SecMgr;
 
-    VerifyOrDie(ec == secMgr->mEC);
+    VerifyOrDie(ec == handshake->EC);
+
+#if WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
+    if (secMgr->HoldMessage(*handshake, msgInfo, profileId, msgType, msgBuf))
+        return;
+#endif
 
     // Abort the CASE interaction immediately if we receive a status report message from the initiator.
     // This is a signal that the initiator does not want to continue.
@@ -1439,37 +1758,136 @@ void WeaveSecurityManager::HandleCASEMessageResponder(ExchangeContext *ec, const
     VerifyOrExit(profileId == kWeaveProfile_Security && msgType == kMsgType_CASEInitiatorKeyConfirm,
                  err = WEAVE_ERROR_INVALID_MESSAGE_TYPE);
 
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+    // A resumed session has no key confirmation step.
+    VerifyOrExit(handshake->ResumptionState == kResumptionState_None, err = WEAVE_ERROR_INVALID_MESSAGE_TYPE);
+#endif
+
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
     // Flush any pending WRM ACKs to give sooner notification to the peer that current
     // CASE session establishment can be finalized.
-    err = secMgr->mEC->WRMPFlushAcks();
+    err = handshake->EC->WRMPFlushAcks();
     SuccessOrExit(err);
 #endif
 
     // Process the initiator's key confirm message.
     // NOTE: No need to initialize crypto memory for this call.
-    err = secMgr->mCASEEngine->ProcessInitiatorKeyConfirm(msgBuf);
+    err = handshake->CASEEngine->ProcessInitiatorKeyConfirm(msgBuf);
     SuccessOrExit(err);
 
     // At this point the session is established.
-    err = secMgr->HandleSessionEstablished();
+    err = secMgr->HandleSessionEstablished(*handshake);
     SuccessOrExit(err);
 
     // Complete the session and notify the user.
-    secMgr->HandleSessionComplete();
+    secMgr->HandleSessionComplete(*handshake);
 
 exit:
     if (err != WEAVE_NO_ERROR)
-        secMgr->HandleSessionError(err, (err == WEAVE_ERROR_STATUS_REPORT_RECEIVED) ? msgBuf : NULL);
+        secMgr->HandleSessionError(*handshake, err, (err == WEAVE_ERROR_STATUS_REPORT_RECEIVED) ? msgBuf : NULL);
     if (msgBuf != NULL)
         PacketBuffer::Free(msgBuf);
 }
 
-#endif // WEAVE_CONFIG_ENABLE_CASE_RESPONDER
-
-#if WEAVE_CONFIG_ENABLE_TAKE_INITIATOR
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
 
-/**
+void WeaveSecurityManager::HandleCASEResumeSessionStart(Handshake &handshake, ExchangeContext *ec, PacketBuffer *msgBuf)
+{
+    WEAVE_ERROR err;
+    WeaveSessionResumption *resumption;
+    WeaveSessionKey *sessionKey;
+    PacketBuffer *respMsgBuf = NULL;
+    uint16_t sendFlags = 0;
+
+    handshake.State = kState_CASEInProgress;
+    handshake.EC = ec;
+    ec->AppState = &handshake;
+    handshake.Con = ec->Con;
+    ec->OnMessageReceived = HandleCASEMessageResponder;
+    ec->OnConnectionClosed = HandleConnectionClosed;
+
+    // Ensure the exchange context stays around until we're done with it.
+    ec->AddRef();
+
+#if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+    if (handshake.Con == NULL)
+    {
+        handshake.EC->OnAckRcvd = WRMPHandleAckRcvd;
+        handshake.EC->OnSendError = WRMPHandleSendError;
+
+        sendFlags = ExchangeContext::kSendFlag_RequestAck;
+    }
+#endif
+
+    // Decode the ResumeSessionRequest.
+    handshake.ResumeCtx.Reset();
+    err = handshake.ResumeCtx.DecodeRequest(msgBuf);
+    SuccessOrExit(err);
+
+    // Look up the resumption secret named by the request.  Resumption ids are only honored when
+    // presented by the node with which the earlier session was established.
+    resumption = FabricState->FindSessionResumption(ec->PeerNodeId, handshake.ResumeCtx.ResumptionId);
+    VerifyOrExit(resumption != NULL, err = WEAVE_ERROR_KEY_NOT_FOUND);
+    handshake.ResumeCtx.SetResumption(*resumption);
+
+    // Verify the request, derive the key of the resumed session and generate the ResumeSessionResponse.
+    respMsgBuf = PacketBuffer::New();
+    VerifyOrExit(respMsgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+    err = handshake.ResumeCtx.GenerateResponse(respMsgBuf);
+    SuccessOrExit(err);
+
+    // The initiator has proven it holds the secret, which may not be used again.
+    FabricState->RemoveSessionResumption(resumption);
+
+    // Allocate an entry in the session key table using the key id proposed by the peer, as is done for
+    // a new CASE session.  The peer has been authenticated, so an idle session may be evicted to make room.
+    err = FabricState->AllocSessionKey(ec->PeerNodeId, handshake.ResumeCtx.SessionKeyId, ec->Con, sessionKey, true);
+    SuccessOrExit(err);
+    sessionKey->SetLocallyInitiated(false);
+    sessionKey->SetRemoveOnIdle(true);
+
+    handshake.SessionKeyId = handshake.ResumeCtx.SessionKeyId;
+    handshake.EncType = handshake.ResumeCtx.EncryptionType;
+    handshake.ResumptionState = kResumptionState_ResponseSent;
+
+    // Send the ResumeSessionResponse message to the peer.
+    err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_CASEResumeSessionResponse, respMsgBuf, sendFlags);
+    respMsgBuf = NULL;
+    SuccessOrExit(err);
+
+    // Start a timer to limit the overall duration of session establishment.
+    StartSessionTimer(handshake);
+
+    // Initialize the new session.
+    err = HandleSessionEstablished(handshake);
+    SuccessOrExit(err);
+
+#if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
+    // 1. Complete the session now if it was established over a connection.
+    // 2. For WRMP the session will be completed on one of these events:
+    //     - Received Ack from the peer for the last message on this exchange (CASEResumeSessionResponse)
+    //     - Received first message from the peer encrypted with established session key (SessionKeyId)
+    if (handshake.Con)
+#endif
+    {
+        HandleSessionComplete(handshake);
+    }
+
+exit:
+    PacketBuffer::Free(msgBuf);
+    if (respMsgBuf != NULL)
+        PacketBuffer::Free(respMsgBuf);
+    if (err != WEAVE_NO_ERROR)
+        HandleSessionError(handshake, err, NULL);
+}
+
+#endif // WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+
+#endif // WEAVE_CONFIG_ENABLE_CASE_RESPONDER
+
+#if WEAVE_CONFIG_ENABLE_TAKE_INITIATOR
+
+/**
  * This method is called to establish secure TAKE session.
  *
  * @param[in] con                 A pointer to the WeaveConnection object.
@@ -1501,14 +1919,16 @@ WEAVE_ERROR WeaveSecurityManager::StartTAKESession(WeaveConnection *con, WeaveAu
                                                    WeaveTAKEChallengerAuthDelegate *authDelegate)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
+    Handshake *handshake;
     bool useSessionKeyID = encryptAuthPhase || encryptCommPhase;
     bool clearStateOnError = false;
 
     // Verify security manager has been initialized.
     VerifyOrExit(State != kState_NotInitialized, err = WEAVE_ERROR_INCORRECT_STATE);
 
-    // Verify there is no session in process.
-    VerifyOrExit(State == kState_Idle, err = WEAVE_ERROR_SECURITY_MANAGER_BUSY);
+    // Verify there is room for another session establishment.
+    handshake = AllocHandshake();
+    VerifyOrExit(handshake != NULL, err = WEAVE_ERROR_SECURITY_MANAGER_BUSY);
 
     WEAVE_FAULT_INJECT(nl::Weave::FaultInjection::kFault_SecMgrBusy,
         {
@@ -1522,14 +1942,14 @@ WEAVE_ERROR WeaveSecurityManager::StartTAKESession(WeaveConnection *con, WeaveAu
     // Reject the request if no connection has been specified.
     VerifyOrExit(con != NULL, err = WEAVE_ERROR_INVALID_ARGUMENT);
 
-    State = kState_TAKEInProgress;
-    mRequestedAuthMode = requestedAuthMode;
-    mEncType = kWeaveEncryptionType_AES128CTRSHA1;
-    mCon = con;
-    mStartSecureSession_OnComplete = onComplete;
-    mStartSecureSession_OnError = onError;
-    mStartSecureSession_ReqState = reqState;
-    mSessionKeyId = WeaveKeyId::kNone;
+    handshake->State = kState_TAKEInProgress;
+    handshake->RequestedAuthMode = requestedAuthMode;
+    handshake->EncType = kWeaveEncryptionType_AES128CTRSHA1;
+    handshake->Con = con;
+    handshake->StartSecureSession_OnComplete = onComplete;
+    handshake->StartSecureSession_OnError = onError;
+    handshake->StartSecureSession_ReqState = reqState;
+    handshake->SessionKeyId = WeaveKeyId::kNone;
 
     // Any error after this point requires call to the Reset() function.
     clearStateOnError = true;
@@ -1539,14 +1959,14 @@ WEAVE_ERROR WeaveSecurityManager::StartTAKESession(WeaveConnection *con, WeaveAu
     if (useSessionKeyID)
     {
         WeaveSessionKey *sessionKey;
-        err = FabricState->AllocSessionKey(con->PeerNodeId, WeaveKeyId::kNone, con, sessionKey);
+        err = FabricState->AllocSessionKey(con->PeerNodeId, WeaveKeyId::kNone, con, sessionKey, true);
         SuccessOrExit(err);
         sessionKey->SetLocallyInitiated(true);
-        mSessionKeyId = sessionKey->MsgEncKey.KeyId;
+        handshake->SessionKeyId = sessionKey->MsgEncKey.KeyId;
     }
 
     // Create a new exchange context.
-    err = NewSessionExchange(mCon->PeerNodeId, mCon->PeerAddr, mCon->PeerPort);
+    err = NewSessionExchange(*handshake, handshake->Con->PeerNodeId, handshake->Con->PeerAddr, handshake->Con->PeerPort);
     SuccessOrExit(err);
 
     // Initialize Weave platform memory.
@@ -1554,49 +1974,49 @@ WEAVE_ERROR WeaveSecurityManager::StartTAKESession(WeaveConnection *con, WeaveAu
     SuccessOrExit(err);
 
     // Allocate and initialize TAKE engine object.
-    mTAKEEngine = (WeaveTAKEEngine *)Platform::Security::MemoryAlloc(sizeof(WeaveTAKEEngine), true);
-    VerifyOrExit(mTAKEEngine != NULL, err = WEAVE_ERROR_NO_MEMORY);
-    mTAKEEngine->Init();
+    handshake->TAKEEngine = (WeaveTAKEEngine *)Platform::Security::MemoryAlloc(sizeof(WeaveTAKEEngine), true);
+    VerifyOrExit(handshake->TAKEEngine != NULL, err = WEAVE_ERROR_NO_MEMORY);
+    handshake->TAKEEngine->Init();
 
     if (authDelegate == NULL)
         authDelegate = mDefaultTAKEChallengerAuthDelegate;
     VerifyOrExit(authDelegate != NULL, err = WEAVE_ERROR_NO_TAKE_AUTH_DELEGATE);
-    mTAKEEngine->ChallengerAuthDelegate = authDelegate;
+    handshake->TAKEEngine->ChallengerAuthDelegate = authDelegate;
 
     // Start TAKE session.
-    StartTAKESession(encryptAuthPhase, encryptCommPhase, timeLimitedIK, sendChallengerId);
+    StartTAKESession(*handshake, encryptAuthPhase, encryptCommPhase, timeLimitedIK, sendChallengerId);
 
 exit:
     if (err != WEAVE_NO_ERROR && clearStateOnError)
     {
-        FabricState->RemoveSessionKey(mSessionKeyId, con->PeerNodeId);
+        FabricState->RemoveSessionKey(handshake->SessionKeyId, con->PeerNodeId);
 
-        Reset();
+        Reset(*handshake);
     }
 
     return err;
 }
 
-void WeaveSecurityManager::StartTAKESession(bool encryptAuthPhase, bool encryptCommPhase, bool timeLimitedIK, bool sendChallengerId)
+void WeaveSecurityManager::StartTAKESession(Handshake &handshake, bool encryptAuthPhase, bool encryptCommPhase, bool timeLimitedIK, bool sendChallengerId)
 {
     WEAVE_ERROR err;
 
-    err = SendTAKEIdentifyToken(TAKE::kTAKEConfig_Config1, encryptAuthPhase, encryptCommPhase, timeLimitedIK, sendChallengerId);
+    err = SendTAKEIdentifyToken(handshake, TAKE::kTAKEConfig_Config1, encryptAuthPhase, encryptCommPhase, timeLimitedIK, sendChallengerId);
     SuccessOrExit(err);
 
-    mEncType = mTAKEEngine->GetEncryptionType();
+    handshake.EncType = handshake.TAKEEngine->GetEncryptionType();
 
-    mEC->OnMessageReceived = HandleTAKEMessageInitiator;
-    mEC->OnConnectionClosed = HandleConnectionClosed;
+    handshake.EC->OnMessageReceived = HandleTAKEMessageInitiator;
+    handshake.EC->OnConnectionClosed = HandleConnectionClosed;
 
     // Using a smaller timeout may help prevent Relay Attack.
     // TODO: consider reducing the timeout, and using different values of timeout
     // for first and subsequent authentication.
-    StartSessionTimer();
+    StartSessionTimer(handshake);
 
 exit:
     if (err != WEAVE_NO_ERROR)
-        HandleSessionError(err, NULL);
+        HandleSessionError(handshake, err, NULL);
 }
 
 
@@ -1604,9 +2024,10 @@ void WeaveSecurityManager::HandleTAKEMessageInitiator(ExchangeContext *ec, const
         uint32_t profileId, uint8_t msgType, PacketBuffer* msgBuf)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
-    WeaveSecurityManager *secMgr = (WeaveSecurityManager *)ec->AppState;
+    Handshake *handshake = (Handshake *)ec->AppState;
+    WeaveSecurityManager *secMgr = handshake->SecMgr;
 
-    VerifyOrDie(ec == secMgr->mEC);
+    VerifyOrDie(ec == handshake->EC);
 
     // Abort the TAKE interaction immediately if we receive a status report message from the responder.
     // This is a signal that the responder does not want to continue.
@@ -1623,15 +2044,15 @@ void WeaveSecurityManager::HandleTAKEMessageInitiator(ExchangeContext *ec, const
     {
     case kMsgType_TAKEIdentifyTokenResponse:
     {
-        err = secMgr->ProcessTAKEIdentifyTokenResponse(msgBuf);
+        err = secMgr->ProcessTAKEIdentifyTokenResponse(*handshake, msgBuf);
         bool doReauth = err == WEAVE_ERROR_TAKE_REAUTH_POSSIBLE;
 
         if (!doReauth)
             SuccessOrExit(err);
 
-        if (secMgr->mTAKEEngine->IsEncryptAuthPhase())
+        if (handshake->TAKEEngine->IsEncryptAuthPhase())
         {
-            err = secMgr->CreateTAKESecureSession();
+            err = secMgr->CreateTAKESecureSession(*handshake);
             SuccessOrExit(err);
         }
 
@@ -1641,11 +2062,11 @@ void WeaveSecurityManager::HandleTAKEMessageInitiator(ExchangeContext *ec, const
 
         if (doReauth)
         {
-            err = secMgr->SendTAKEReAuthenticateToken();
+            err = secMgr->SendTAKEReAuthenticateToken(*handshake);
         }
         else
         {
-            err = secMgr->SendTAKEAuthenticateToken();
+            err = secMgr->SendTAKEAuthenticateToken(*handshake);
         }
         SuccessOrExit(err);
         break;
@@ -1653,44 +2074,44 @@ void WeaveSecurityManager::HandleTAKEMessageInitiator(ExchangeContext *ec, const
     case kMsgType_TAKETokenReconfigure:
         uint8_t newConfig;
 
-        err = secMgr->ProcessTAKETokenReconfigure(newConfig, msgBuf);
+        err = secMgr->ProcessTAKETokenReconfigure(*handshake, newConfig, msgBuf);
         SuccessOrExit(err);
 
         // Free the received message buffer so that it can be reused to send the outgoing message.
         PacketBuffer::Free(msgBuf);
         msgBuf = NULL;
 
-        err = secMgr->SendTAKEIdentifyToken(newConfig, secMgr->mTAKEEngine->IsEncryptAuthPhase(),
-                secMgr->mTAKEEngine->IsEncryptCommPhase(), secMgr->mTAKEEngine->IsTimeLimitedIK(), secMgr->mTAKEEngine->HasSentChallengerId());
+        err = secMgr->SendTAKEIdentifyToken(*handshake, newConfig, handshake->TAKEEngine->IsEncryptAuthPhase(),
+                handshake->TAKEEngine->IsEncryptCommPhase(), handshake->TAKEEngine->IsTimeLimitedIK(), handshake->TAKEEngine->HasSentChallengerId());
         SuccessOrExit(err);
         break;
 
     case kMsgType_TAKEAuthenticateTokenResponse:
-        err = secMgr->ProcessTAKEAuthenticateTokenResponse(msgBuf);
+        err = secMgr->ProcessTAKEAuthenticateTokenResponse(*handshake, msgBuf);
         SuccessOrExit(err);
 
         // Free the received message buffer so that it can be reused to send the outgoing message.
         PacketBuffer::Free(msgBuf);
         msgBuf = NULL;
 
-        err = secMgr->FinishTAKESetUp();
+        err = secMgr->FinishTAKESetUp(*handshake);
         SuccessOrExit(err);
 
-        secMgr->HandleSessionComplete();
+        secMgr->HandleSessionComplete(*handshake);
         break;
 
     case kMsgType_TAKEReAuthenticateTokenResponse:
-        err = secMgr->ProcessTAKEReAuthenticateTokenResponse(msgBuf);
+        err = secMgr->ProcessTAKEReAuthenticateTokenResponse(*handshake, msgBuf);
         SuccessOrExit(err);
 
         // Free the received message buffer so that it can be reused to send the outgoing message.
         PacketBuffer::Free(msgBuf);
         msgBuf = NULL;
 
-        err = secMgr->FinishTAKESetUp();
+        err = secMgr->FinishTAKESetUp(*handshake);
         SuccessOrExit(err);
 
-        secMgr->HandleSessionComplete();
+        secMgr->HandleSessionComplete(*handshake);
         break;
 
     default:
@@ -1700,12 +2121,12 @@ void WeaveSecurityManager::HandleTAKEMessageInitiator(ExchangeContext *ec, const
 
 exit:
     if (err != WEAVE_NO_ERROR)
-        secMgr->HandleSessionError(err, (err == WEAVE_ERROR_STATUS_REPORT_RECEIVED) ? msgBuf : NULL);
+        secMgr->HandleSessionError(*handshake, err, (err == WEAVE_ERROR_STATUS_REPORT_RECEIVED) ? msgBuf : NULL);
     if (msgBuf != NULL)
         PacketBuffer::Free(msgBuf);
 }
 
-WEAVE_ERROR WeaveSecurityManager::SendTAKEIdentifyToken(uint8_t takeConfig, bool encryptAuthPhase, bool encryptCommPhase, bool timeLimitedIK, bool sendChallengerId)
+WEAVE_ERROR WeaveSecurityManager::SendTAKEIdentifyToken(Handshake &handshake, uint8_t takeConfig, bool encryptAuthPhase, bool encryptCommPhase, bool timeLimitedIK, bool sendChallengerId)
 {
     WEAVE_ERROR     err;
     PacketBuffer*   msgBuf = NULL;
@@ -1714,11 +2135,11 @@ WEAVE_ERROR WeaveSecurityManager::SendTAKEIdentifyToken(uint8_t takeConfig, bool
     msgBuf = PacketBuffer::New();
     VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
-    err = mTAKEEngine->GenerateIdentifyTokenMessage(mSessionKeyId, takeConfig, encryptAuthPhase, encryptCommPhase, timeLimitedIK, sendChallengerId, kWeaveEncryptionType_AES128CTRSHA1, FabricState->LocalNodeId, msgBuf);
+    err = handshake.TAKEEngine->GenerateIdentifyTokenMessage(handshake.SessionKeyId, takeConfig, encryptAuthPhase, encryptCommPhase, timeLimitedIK, sendChallengerId, kWeaveEncryptionType_AES128CTRSHA1, FabricState->LocalNodeId, msgBuf);
     SuccessOrExit(err);
 
     // Send the message.
-    err = mEC->SendMessage(kWeaveProfile_Security, kMsgType_TAKEIdentifyToken, msgBuf, 0);
+    err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_TAKEIdentifyToken, msgBuf, 0);
     msgBuf = NULL;
     SuccessOrExit(err);
 
@@ -1729,29 +2150,29 @@ exit:
 }
 
 
-WEAVE_ERROR WeaveSecurityManager::ProcessTAKEIdentifyTokenResponse(const PacketBuffer* msgBuf)
+WEAVE_ERROR WeaveSecurityManager::ProcessTAKEIdentifyTokenResponse(Handshake &handshake, const PacketBuffer* msgBuf)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
 
-    err = mTAKEEngine->ProcessIdentifyTokenResponseMessage(msgBuf);
+    err = handshake.TAKEEngine->ProcessIdentifyTokenResponseMessage(msgBuf);
     SuccessOrExit(err);
 
 exit:
     return err;
 }
 
-WEAVE_ERROR WeaveSecurityManager::ProcessTAKETokenReconfigure(uint8_t& config, const PacketBuffer* msgBuf)
+WEAVE_ERROR WeaveSecurityManager::ProcessTAKETokenReconfigure(Handshake &handshake, uint8_t& config, const PacketBuffer* msgBuf)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
 
-    err = mTAKEEngine->ProcessTokenReconfigureMessage(config, msgBuf);
+    err = handshake.TAKEEngine->ProcessTokenReconfigureMessage(config, msgBuf);
     SuccessOrExit(err);
 
 exit:
     return err;
 }
 
-WEAVE_ERROR WeaveSecurityManager::SendTAKEAuthenticateToken(void)
+WEAVE_ERROR WeaveSecurityManager::SendTAKEAuthenticateToken(Handshake &handshake)
 {
     WEAVE_ERROR     err = WEAVE_NO_ERROR;
     PacketBuffer*   msgBuf = NULL;
@@ -1760,11 +2181,11 @@ WEAVE_ERROR WeaveSecurityManager::SendTAKEAuthenticateToken(void)
     VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
     Platform::Security::OnTimeConsumingCryptoStart();
-    err = mTAKEEngine->GenerateAuthenticateTokenMessage(msgBuf);
+    err = handshake.TAKEEngine->GenerateAuthenticateTokenMessage(msgBuf);
     Platform::Security::OnTimeConsumingCryptoDone();
     SuccessOrExit(err);
 
-    err = mEC->SendMessage(kWeaveProfile_Security, kMsgType_TAKEAuthenticateToken, msgBuf, 0);
+    err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_TAKEAuthenticateToken, msgBuf, 0);
     msgBuf = NULL;
     SuccessOrExit(err);
 
@@ -1772,12 +2193,12 @@ exit:
     return err;
 }
 
-WEAVE_ERROR WeaveSecurityManager::ProcessTAKEAuthenticateTokenResponse(const PacketBuffer* msgBuf)
+WEAVE_ERROR WeaveSecurityManager::ProcessTAKEAuthenticateTokenResponse(Handshake &handshake, const PacketBuffer* msgBuf)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
 
     Platform::Security::OnTimeConsumingCryptoStart();
-    err = mTAKEEngine->ProcessAuthenticateTokenResponseMessage(msgBuf);
+    err = handshake.TAKEEngine->ProcessAuthenticateTokenResponseMessage(msgBuf);
     Platform::Security::OnTimeConsumingCryptoDone();
     SuccessOrExit(err);
 
@@ -1785,7 +2206,7 @@ exit:
     return err;
 }
 
-WEAVE_ERROR WeaveSecurityManager::SendTAKEReAuthenticateToken(void)
+WEAVE_ERROR WeaveSecurityManager::SendTAKEReAuthenticateToken(Handshake &handshake)
 {
     WEAVE_ERROR     err = WEAVE_NO_ERROR;
     PacketBuffer*   msgBuf = NULL;
@@ -1793,10 +2214,10 @@ WEAVE_ERROR WeaveSecurityManager::SendTAKEReAuthenticateToken(void)
     msgBuf = PacketBuffer::New();
     VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
-    err = mTAKEEngine->GenerateReAuthenticateTokenMessage(msgBuf);
+    err = handshake.TAKEEngine->GenerateReAuthenticateTokenMessage(msgBuf);
     SuccessOrExit(err);
 
-    err = mEC->SendMessage(kWeaveProfile_Security, kMsgType_TAKEReAuthenticateToken, msgBuf, 0);
+    err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_TAKEReAuthenticateToken, msgBuf, 0);
     msgBuf = NULL;
     SuccessOrExit(err);
 
@@ -1804,11 +2225,11 @@ exit:
     return err;
 }
 
-WEAVE_ERROR WeaveSecurityManager::ProcessTAKEReAuthenticateTokenResponse(const PacketBuffer* msgBuf)
+WEAVE_ERROR WeaveSecurityManager::ProcessTAKEReAuthenticateTokenResponse(Handshake &handshake, const PacketBuffer* msgBuf)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
 
-    err = mTAKEEngine->ProcessReAuthenticateTokenResponseMessage(msgBuf);
+    err = handshake.TAKEEngine->ProcessReAuthenticateTokenResponseMessage(msgBuf);
     SuccessOrExit(err);
 
 exit:
@@ -1830,7 +2251,7 @@ WEAVE_ERROR WeaveSecurityManager::StartTAKESession(WeaveConnection *con, WeaveAu
 
 #if WEAVE_CONFIG_ENABLE_TAKE_RESPONDER
 
-void WeaveSecurityManager::HandleTAKESessionStart(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo, PacketBuffer* msgBuf)
+void WeaveSecurityManager::HandleTAKESessionStart(Handshake &handshake, ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo, PacketBuffer* msgBuf)
 {
     WEAVE_ERROR     err = WEAVE_NO_ERROR;
     PacketBuffer*   respMsgBuf = NULL;
@@ -1838,9 +2259,10 @@ void WeaveSecurityManager::HandleTAKESessionStart(ExchangeContext *ec, const IPP
     VerifyOrExit(mDefaultTAKETokenAuthDelegate != NULL, err = WEAVE_ERROR_NO_TAKE_AUTH_DELEGATE);
 
     // Setup state for the new TAKE exchange.
-    State = kState_TAKEInProgress;
-    mEC = ec;
-    mCon = ec->Con;
+    handshake.State = kState_TAKEInProgress;
+    handshake.EC = ec;
+    ec->AppState = &handshake;
+    handshake.Con = ec->Con;
 
     ec->OnMessageReceived = HandleTAKEMessageResponder;
     ec->OnConnectionClosed = HandleConnectionClosed;
@@ -1848,60 +2270,60 @@ void WeaveSecurityManager::HandleTAKESessionStart(ExchangeContext *ec, const IPP
     // Ensure the exchange context stays around until we're done with it.
     ec->AddRef();
 
-    StartSessionTimer();
+    StartSessionTimer(handshake);
 
     // Initialize Weave Platform Memory
     err = Platform::Security::MemoryInit();
     SuccessOrExit(err);
 
     // Prepare TAKE engine and start session
-    mTAKEEngine = (WeaveTAKEEngine *)Platform::Security::MemoryAlloc(sizeof(WeaveTAKEEngine), true);
-    VerifyOrExit(mTAKEEngine != NULL, err = WEAVE_ERROR_NO_MEMORY);
-    mTAKEEngine->Init();
+    handshake.TAKEEngine = (WeaveTAKEEngine *)Platform::Security::MemoryAlloc(sizeof(WeaveTAKEEngine), true);
+    VerifyOrExit(handshake.TAKEEngine != NULL, err = WEAVE_ERROR_NO_MEMORY);
+    handshake.TAKEEngine->Init();
 
-    mTAKEEngine->TokenAuthDelegate = mDefaultTAKETokenAuthDelegate;
+    handshake.TAKEEngine->TokenAuthDelegate = mDefaultTAKETokenAuthDelegate;
 
-    err = mTAKEEngine->ProcessIdentifyTokenMessage(ec->PeerNodeId, msgBuf);
+    err = handshake.TAKEEngine->ProcessIdentifyTokenMessage(ec->PeerNodeId, msgBuf);
     PacketBuffer::Free(msgBuf);
     msgBuf = NULL;
 
     if (err == WEAVE_ERROR_TAKE_RECONFIGURE_REQUIRED)
     {
-        err = SendTAKETokenReconfigure();
+        err = SendTAKETokenReconfigure(handshake);
         SuccessOrExit(err);
 
         // Reset state.
-        Reset();
+        Reset(handshake);
 
         ExitNow();
     }
 
     SuccessOrExit(err);
 
-    if (mTAKEEngine->UseSessionKey())
+    if (handshake.TAKEEngine->UseSessionKey())
     {
         WeaveSessionKey *sessionKey;
-        err = FabricState->AllocSessionKey(ec->PeerNodeId, mTAKEEngine->SessionKeyId, ec->Con, sessionKey);
+        err = FabricState->AllocSessionKey(ec->PeerNodeId, handshake.TAKEEngine->SessionKeyId, ec->Con, sessionKey);
         SuccessOrExit(err);
         sessionKey->SetLocallyInitiated(false);
         sessionKey->SetRemoveOnIdle(true);
-        mSessionKeyId = mTAKEEngine->SessionKeyId;
-        mEncType = mTAKEEngine->GetEncryptionType();
+        handshake.SessionKeyId = handshake.TAKEEngine->SessionKeyId;
+        handshake.EncType = handshake.TAKEEngine->GetEncryptionType();
     }
 
     respMsgBuf = PacketBuffer::New();
     VerifyOrExit(respMsgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
-    err = mTAKEEngine->GenerateIdentifyTokenResponseMessage(respMsgBuf);
+    err = handshake.TAKEEngine->GenerateIdentifyTokenResponseMessage(respMsgBuf);
     SuccessOrExit(err);
 
     err = ec->SendMessage(kWeaveProfile_Security, kMsgType_TAKEIdentifyTokenResponse, respMsgBuf);
     respMsgBuf = NULL;
     SuccessOrExit(err);
 
-    if (mTAKEEngine->IsEncryptAuthPhase())
+    if (handshake.TAKEEngine->IsEncryptAuthPhase())
     {
-        err = CreateTAKESecureSession();
+        err = CreateTAKESecureSession(handshake);
         SuccessOrExit(err);
     }
 
@@ -1911,16 +2333,17 @@ exit:
     if (respMsgBuf != NULL)
         PacketBuffer::Free(respMsgBuf);
     if (err != WEAVE_NO_ERROR)
-        HandleSessionError(err, NULL);
+        HandleSessionError(handshake, err, NULL);
 }
 
 void WeaveSecurityManager::HandleTAKEMessageResponder(ExchangeContext *ec, const IPPacketInfo *pktInfo,
         const WeaveMessageInfo *msgInfo, uint32_t profileId, uint8_t msgType, PacketBuffer* msgBuf)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
-    WeaveSecurityManager *secMgr = (WeaveSecurityManager *)ec->AppState;
+    Handshake *handshake = (Handshake *)ec->AppState;
+    WeaveSecurityManager *secMgr = handshake->SecMgr;
 
-    VerifyOrDie(ec == secMgr->mEC);
+    VerifyOrDie(ec == handshake->EC);
 
     // Abort the TAKE interaction immediately if we receive a status report message from the initiator.
     // This is a signal that the initiator does not want to continue.
@@ -1933,36 +2356,36 @@ void WeaveSecurityManager::HandleTAKEMessageResponder(ExchangeContext *ec, const
     switch (msgType)
     {
     case kMsgType_TAKEAuthenticateToken:
-        err = secMgr->ProcessTAKEAuthenticateToken(msgBuf);
+        err = secMgr->ProcessTAKEAuthenticateToken(*handshake, msgBuf);
         SuccessOrExit(err);
 
-        err = secMgr->SendTAKEAuthenticateTokenResponse();
+        err = secMgr->SendTAKEAuthenticateTokenResponse(*handshake);
         SuccessOrExit(err);
 
         // freeing the buffer after the generation of the next message in order to not copy the gx array
         PacketBuffer::Free(msgBuf);
         msgBuf = NULL;
 
-        err = secMgr->FinishTAKESetUp();
+        err = secMgr->FinishTAKESetUp(*handshake);
         SuccessOrExit(err);
 
-        secMgr->HandleSessionComplete();
+        secMgr->HandleSessionComplete(*handshake);
         break;
 
     case kMsgType_TAKEReAuthenticateToken:
-        err = secMgr->ProcessTAKEReAuthenticateToken(msgBuf);
+        err = secMgr->ProcessTAKEReAuthenticateToken(*handshake, msgBuf);
         SuccessOrExit(err);
 
         PacketBuffer::Free(msgBuf);
         msgBuf = NULL;
 
-        err = secMgr->SendTAKEReAuthenticateTokenResponse();
+        err = secMgr->SendTAKEReAuthenticateTokenResponse(*handshake);
         SuccessOrExit(err);
 
-        err = secMgr->FinishTAKESetUp();
+        err = secMgr->FinishTAKESetUp(*handshake);
         SuccessOrExit(err);
 
-        secMgr->HandleSessionComplete();
+        secMgr->HandleSessionComplete(*handshake);
         break;
 
     default:
@@ -1976,17 +2399,17 @@ void WeaveSecurityManager::HandleTAKEMessageResponder(ExchangeContext *ec, const
 
 exit:
     if (err != WEAVE_NO_ERROR)
-        secMgr->HandleSessionError(err, (err == WEAVE_ERROR_STATUS_REPORT_RECEIVED) ? msgBuf : NULL);
+        secMgr->HandleSessionError(*handshake, err, (err == WEAVE_ERROR_STATUS_REPORT_RECEIVED) ? msgBuf : NULL);
     if (msgBuf != NULL)
         PacketBuffer::Free(msgBuf);
 }
 
-WEAVE_ERROR WeaveSecurityManager::ProcessTAKEAuthenticateToken(const PacketBuffer* msgBuf)
+WEAVE_ERROR WeaveSecurityManager::ProcessTAKEAuthenticateToken(Handshake &handshake, const PacketBuffer* msgBuf)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
 
     Platform::Security::OnTimeConsumingCryptoStart();
-    err = mTAKEEngine->ProcessAuthenticateTokenMessage(msgBuf);
+    err = handshake.TAKEEngine->ProcessAuthenticateTokenMessage(msgBuf);
     Platform::Security::OnTimeConsumingCryptoDone();
     SuccessOrExit(err);
 
@@ -1994,7 +2417,7 @@ exit:
     return err;
 }
 
-WEAVE_ERROR WeaveSecurityManager::SendTAKETokenReconfigure(void)
+WEAVE_ERROR WeaveSecurityManager::SendTAKETokenReconfigure(Handshake &handshake)
 {
     WEAVE_ERROR     err     = WEAVE_NO_ERROR;
     PacketBuffer*   msgBuf  = NULL;
@@ -2003,10 +2426,10 @@ WEAVE_ERROR WeaveSecurityManager::SendTAKETokenReconfigure(void)
     msgBuf = PacketBuffer::New();
     VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
-    err = mTAKEEngine->GenerateTokenReconfigureMessage(msgBuf);
+    err = handshake.TAKEEngine->GenerateTokenReconfigureMessage(msgBuf);
     SuccessOrExit(err);
 
-    err = mEC->SendMessage(kWeaveProfile_Security, kMsgType_TAKETokenReconfigure, msgBuf, 0);
+    err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_TAKETokenReconfigure, msgBuf, 0);
     msgBuf = NULL;
     SuccessOrExit(err);
 
@@ -2016,7 +2439,7 @@ exit:
     return err;
 }
 
-WEAVE_ERROR WeaveSecurityManager::SendTAKEAuthenticateTokenResponse(void)
+WEAVE_ERROR WeaveSecurityManager::SendTAKEAuthenticateTokenResponse(Handshake &handshake)
 {
     WEAVE_ERROR     err     = WEAVE_NO_ERROR;
     PacketBuffer*   msgBuf  = NULL;
@@ -2025,11 +2448,11 @@ WEAVE_ERROR WeaveSecurityManager::SendTAKEAuthenticateTokenResponse(void)
     VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
     Platform::Security::OnTimeConsumingCryptoStart();
-    err = mTAKEEngine->GenerateAuthenticateTokenResponseMessage(msgBuf);
+    err = handshake.TAKEEngine->GenerateAuthenticateTokenResponseMessage(msgBuf);
     Platform::Security::OnTimeConsumingCryptoDone();
     SuccessOrExit(err);
 
-    err = mEC->SendMessage(kWeaveProfile_Security, kMsgType_TAKEAuthenticateTokenResponse, msgBuf, 0);
+    err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_TAKEAuthenticateTokenResponse, msgBuf, 0);
     msgBuf = NULL;
     SuccessOrExit(err);
 
@@ -2039,11 +2462,11 @@ exit:
     return err;
 }
 
-WEAVE_ERROR WeaveSecurityManager::ProcessTAKEReAuthenticateToken(const PacketBuffer* msgBuf)
+WEAVE_ERROR WeaveSecurityManager::ProcessTAKEReAuthenticateToken(Handshake &handshake, const PacketBuffer* msgBuf)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
 
-    err = mTAKEEngine->ProcessReAuthenticateTokenMessage(msgBuf);
+    err = handshake.TAKEEngine->ProcessReAuthenticateTokenMessage(msgBuf);
     SuccessOrExit(err);
 
 exit:
@@ -2051,7 +2474,7 @@ exit:
 }
 
 
-WEAVE_ERROR WeaveSecurityManager::SendTAKEReAuthenticateTokenResponse(void)
+WEAVE_ERROR WeaveSecurityManager::SendTAKEReAuthenticateTokenResponse(Handshake &handshake)
 {
     WEAVE_ERROR     err     = WEAVE_NO_ERROR;
     PacketBuffer*   msgBuf  = NULL;
@@ -2059,10 +2482,10 @@ WEAVE_ERROR WeaveSecurityManager::SendTAKEReAuthenticateTokenResponse(void)
     msgBuf = PacketBuffer::New();
     VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
-    err = mTAKEEngine->GenerateReAuthenticateTokenResponseMessage(msgBuf);
+    err = handshake.TAKEEngine->GenerateReAuthenticateTokenResponseMessage(msgBuf);
     SuccessOrExit(err);
 
-    err = mEC->SendMessage(kWeaveProfile_Security, kMsgType_TAKEReAuthenticateTokenResponse, msgBuf, 0);
+    err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_TAKEReAuthenticateTokenResponse, msgBuf, 0);
     msgBuf = NULL;
     SuccessOrExit(err);
 
@@ -2076,44 +2499,44 @@ exit:
 
 #if WEAVE_CONFIG_ENABLE_TAKE_INITIATOR || WEAVE_CONFIG_ENABLE_TAKE_RESPONDER
 
-WEAVE_ERROR WeaveSecurityManager::CreateTAKESecureSession(void)
+WEAVE_ERROR WeaveSecurityManager::CreateTAKESecureSession(Handshake &handshake)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
 
-    err = HandleSessionEstablished();
+    err = HandleSessionEstablished(handshake);
     SuccessOrExit(err);
 
-    mEC->KeyId = mSessionKeyId;
-    mEC->EncryptionType = mEncType;
+    handshake.EC->KeyId = handshake.SessionKeyId;
+    handshake.EC->EncryptionType = handshake.EncType;
 
     // Add a reservation for the new session key and configure the ExchangeContext to automatically release
     // the key when the context is freed.  This will ensure the key is not removed until rest of the TAKE
     // exchange completes.
-    ReserveKey(mEC->PeerNodeId, mEC->KeyId);
-    mEC->SetAutoReleaseKey(true);
+    ReserveKey(handshake.EC->PeerNodeId, handshake.EC->KeyId);
+    handshake.EC->SetAutoReleaseKey(true);
 
 exit:
     return err;
 }
 
-WEAVE_ERROR WeaveSecurityManager::FinishTAKESetUp(void)
+WEAVE_ERROR WeaveSecurityManager::FinishTAKESetUp(Handshake &handshake)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
 
-    if (mTAKEEngine->IsEncryptCommPhase())
+    if (handshake.TAKEEngine->IsEncryptCommPhase())
     {
-        err = HandleSessionEstablished();
+        err = HandleSessionEstablished(handshake);
         SuccessOrExit(err);
     }
     else
     {
-        if (mTAKEEngine->IsEncryptAuthPhase())
+        if (handshake.TAKEEngine->IsEncryptAuthPhase())
         {
-            err = FabricState->RemoveSessionKey(mSessionKeyId, mEC->PeerNodeId);
+            err = FabricState->RemoveSessionKey(handshake.SessionKeyId, handshake.EC->PeerNodeId);
             SuccessOrExit(err);
         }
-        mEncType = kWeaveEncryptionType_None;
-        mSessionKeyId = WeaveKeyId::kNone;
+        handshake.EncType = kWeaveEncryptionType_None;
+        handshake.SessionKeyId = WeaveKeyId::kNone;
     }
 
 exit:
@@ -2129,19 +2552,21 @@ WEAVE_ERROR WeaveSecurityManager::StartKeyExport(WeaveConnection *con, uint64_t
         KeyExportCompleteFunct onComplete, KeyExportErrorFunct onError, WeaveKeyExportDelegate *keyExportDelegate)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
+    Handshake *handshake;
 
-    // Verify we've been initialized and that we don't already have a session in process.
+    // Verify we've been initialized and that there is room for another key export.
     if (State == kState_NotInitialized)
         return WEAVE_ERROR_INCORRECT_STATE;
-    if (State != kState_Idle)
+    handshake = AllocHandshake();
+    if (handshake == NULL)
         return WEAVE_ERROR_SECURITY_MANAGER_BUSY;
 
-    State = kState_KeyExportInProgress;
+    handshake->State = kState_KeyExportInProgress;
 
-    mCon = con;
+    handshake->Con = con;
 
     // Create a new exchange context.
-    err = NewSessionExchange(peerNodeId, peerAddr, peerPort);
+    err = NewSessionExchange(*handshake, peerNodeId, peerAddr, peerPort);
     SuccessOrExit(err);
 
     // Initialize key export delegate.
@@ -2153,30 +2578,30 @@ WEAVE_ERROR WeaveSecurityManager::StartKeyExport(WeaveConnection *con, uint64_t
     SuccessOrExit(err);
 
     // Allocate and initialize KeyExport object.
-    mKeyExport = (WeaveKeyExport *)Platform::Security::MemoryAlloc(sizeof(WeaveKeyExport), true);
-    VerifyOrExit(mKeyExport != NULL, err = WEAVE_ERROR_NO_MEMORY);
-    mKeyExport->Init(keyExportDelegate);
+    handshake->KeyExport = (WeaveKeyExport *)Platform::Security::MemoryAlloc(sizeof(WeaveKeyExport), true);
+    VerifyOrExit(handshake->KeyExport != NULL, err = WEAVE_ERROR_NO_MEMORY);
+    handshake->KeyExport->Init(keyExportDelegate);
 
     // Set the allowed key export protocol configurations.
-    mKeyExport->SetAllowedConfigs(InitiatorAllowedKeyExportConfigs);
+    handshake->KeyExport->SetAllowedConfigs(InitiatorAllowedKeyExportConfigs);
 
     // Send key export request message.
-    err = SendKeyExportRequest(InitiatorKeyExportConfig, keyId, signMessage);
+    err = SendKeyExportRequest(*handshake, InitiatorKeyExportConfig, keyId, signMessage);
     SuccessOrExit(err);
 
-    mStartKeyExport_OnComplete = onComplete;
-    mStartKeyExport_OnError = onError;
-    mStartKeyExport_ReqState = reqState;
+    handshake->StartKeyExport_OnComplete = onComplete;
+    handshake->StartKeyExport_OnError = onError;
+    handshake->StartKeyExport_ReqState = reqState;
 
-    mEC->OnMessageReceived = HandleKeyExportMessageInitiator;
-    mEC->OnConnectionClosed = HandleConnectionClosed;
+    handshake->EC->OnMessageReceived = HandleKeyExportMessageInitiator;
+    handshake->EC->OnConnectionClosed = HandleConnectionClosed;
 
     // Time limit overall Key Export duration.
-    StartSessionTimer();
+    StartSessionTimer(*handshake);
 
 exit:
     if (err != WEAVE_NO_ERROR)
-        HandleKeyExportError(err, NULL);
+        HandleKeyExportError(*handshake, err, NULL);
 
     return err;
 }
@@ -2185,9 +2610,10 @@ void WeaveSecurityManager::HandleKeyExportMessageInitiator(ExchangeContext *ec,
         uint32_t profileId, uint8_t msgType, PacketBuffer *msgBuf)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
-    WeaveSecurityManager *secMgr = (WeaveSecurityManager *)ec->AppState;
+    Handshake *handshake = (Handshake *)ec->AppState;
+    WeaveSecurityManager *secMgr = handshake->SecMgr;
 
-    VerifyOrDie(ec == secMgr->mEC);
+    VerifyOrDie(ec == handshake->EC);
 
     // Abort the key export interaction immediately if we receive a status report message from the responder.
     // This is a signal that the responder does not want to continue.
@@ -2202,7 +2628,7 @@ void WeaveSecurityManager::HandleKeyExportMessageInitiator(ExchangeContext *ec,
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
     // Flush any pending WRM ACKs before we begin the long crypto operation,
     // to prevent the peer from re-transmitting message.
-    err = secMgr->mEC->WRMPFlushAcks();
+    err = handshake->EC->WRMPFlushAcks();
     SuccessOrExit(err);
 #endif
 
@@ -2212,14 +2638,14 @@ void WeaveSecurityManager::HandleKeyExportMessageInitiator(ExchangeContext *ec,
     case kMsgType_KeyExportReconfigure:
         uint8_t newConfig;
 
-        err = secMgr->mKeyExport->ProcessKeyExportReconfigure(msgBuf->Start(), msgBuf->DataLength(), newConfig);
+        err = handshake->KeyExport->ProcessKeyExportReconfigure(msgBuf->Start(), msgBuf->DataLength(), newConfig);
         SuccessOrExit(err);
 
         // Free the received message buffer so that it can be reused to send the outgoing message.
         PacketBuffer::Free(msgBuf);
         msgBuf = NULL;
 
-        err = secMgr->SendKeyExportRequest(newConfig, secMgr->mKeyExport->KeyId(), secMgr->mKeyExport->SignMessages());
+        err = secMgr->SendKeyExportRequest(*handshake, newConfig, handshake->KeyExport->KeyId(), handshake->KeyExport->SignMessages());
         SuccessOrExit(err);
 
         break;
@@ -2229,18 +2655,18 @@ void WeaveSecurityManager::HandleKeyExportMessageInitiator(ExchangeContext *ec,
         uint16_t exportedKeyLen;
         uint8_t exportedKey[kWeaveFabricSecretSize];
 
-        err = secMgr->mKeyExport->ProcessKeyExportResponse(msgBuf->Start(), msgBuf->DataLength(), msgInfo,
+        err = handshake->KeyExport->ProcessKeyExportResponse(msgBuf->Start(), msgBuf->DataLength(), msgInfo,
                                                            exportedKey, sizeof(exportedKey), exportedKeyLen, exportedKeyId);
         SuccessOrExit(err);
 
         // Call the user's completion function.
-        if (secMgr->mStartKeyExport_OnComplete != NULL)
+        if (handshake->StartKeyExport_OnComplete != NULL)
         {
-            secMgr->mStartKeyExport_OnComplete(secMgr, secMgr->mCon, secMgr->mStartKeyExport_ReqState, exportedKeyId, exportedKey, exportedKeyLen);
+            handshake->StartKeyExport_OnComplete(secMgr, handshake->Con, handshake->StartKeyExport_ReqState, exportedKeyId, exportedKey, exportedKeyLen);
         }
 
         // Reset state.
-        secMgr->Reset();
+        secMgr->Reset(*handshake);
 
         break;
 
@@ -2252,13 +2678,13 @@ void WeaveSecurityManager::HandleKeyExportMessageInitiator(ExchangeContext *ec,
 
 exit:
     if (err != WEAVE_NO_ERROR)
-        secMgr->HandleKeyExportError(err, (err == WEAVE_ERROR_STATUS_REPORT_RECEIVED) ? msgBuf : NULL);
+        secMgr->HandleKeyExportError(*handshake, err, (err == WEAVE_ERROR_STATUS_REPORT_RECEIVED) ? msgBuf : NULL);
 
     if (msgBuf != NULL)
         PacketBuffer::Free(msgBuf);
 }
 
-void WeaveSecurityManager::HandleKeyExportError(WEAVE_ERROR err, PacketBuffer *statusReportMsgBuf)
+void WeaveSecurityManager::HandleKeyExportError(Handshake &handshake, WEAVE_ERROR err, PacketBuffer *statusReportMsgBuf)
 {
     // If session establishment in progress...
     //
@@ -2269,11 +2695,11 @@ void WeaveSecurityManager::HandleKeyExportError(WEAVE_ERROR err, PacketBuffer *s
     // Then when SendMessage() returns, the function that called it will also call this
     // function with the error returned by SendMessage().
     //
-    if (State != kState_Idle)
+    if (handshake.State != kState_Idle)
     {
-        WeaveConnection *con = mCon;
-        KeyExportErrorFunct userOnError = mStartKeyExport_OnError;
-        void *reqState = mStartKeyExport_ReqState;
+        WeaveConnection *con = handshake.Con;
+        KeyExportErrorFunct userOnError = handshake.StartKeyExport_OnError;
+        void *reqState = handshake.StartKeyExport_ReqState;
         StatusReport rcvdStatusReport;
         StatusReport *statusReportPtr = NULL;
 
@@ -2289,7 +2715,7 @@ void WeaveSecurityManager::HandleKeyExportError(WEAVE_ERROR err, PacketBuffer *s
         }
 
         // Reset state.
-        Reset();
+        Reset(handshake);
 
         // Call the user's error handler.
         if (userOnError != NULL)
@@ -2298,7 +2724,7 @@ void WeaveSecurityManager::HandleKeyExportError(WEAVE_ERROR err, PacketBuffer *s
 }
 
 __attribute__((noinline))
-WEAVE_ERROR WeaveSecurityManager::SendKeyExportRequest(uint8_t keyExportConfig, uint32_t keyId, bool signMessage)
+WEAVE_ERROR WeaveSecurityManager::SendKeyExportRequest(Handshake &handshake, uint8_t keyExportConfig, uint32_t keyId, bool signMessage)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
     PacketBuffer *msgBuf = NULL;
@@ -2310,21 +2736,21 @@ WEAVE_ERROR WeaveSecurityManager::SendKeyExportRequest(uint8_t keyExportConfig,
     VerifyOrExit(msgBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
     // Generate key export request.
-    err = mKeyExport->GenerateKeyExportRequest(msgBuf->Start(), msgBuf->AvailableDataLength(), dataLen, keyExportConfig, keyId, signMessage);
+    err = handshake.KeyExport->GenerateKeyExportRequest(msgBuf->Start(), msgBuf->AvailableDataLength(), dataLen, keyExportConfig, keyId, signMessage);
     SuccessOrExit(err);
 
     // Set message length.
     msgBuf->SetDataLength(dataLen);
 
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
-    if (mCon == NULL)
+    if (handshake.Con == NULL)
     {
         sendFlags = ExchangeContext::kSendFlag_RequestAck;
     }
 #endif
 
     // Send key export request message.
-    err = mEC->SendMessage(kWeaveProfile_Security, kMsgType_KeyExportRequest, msgBuf, sendFlags);
+    err = handshake.EC->SendMessage(kWeaveProfile_Security, kMsgType_KeyExportRequest, msgBuf, sendFlags);
     msgBuf = NULL;
     SuccessOrExit(err);
 
@@ -2339,29 +2765,30 @@ exit:
 
 #if WEAVE_CONFIG_ENABLE_KEY_EXPORT_RESPONDER
 
-void WeaveSecurityManager::HandleKeyExportRequest(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf)
+void WeaveSecurityManager::HandleKeyExportRequest(Handshake &handshake, ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf)
 {
     WEAVE_ERROR err;
     WeaveKeyExport keyExport;
 
-    State = kState_KeyExportInProgress;
-    mEC = ec;
-    mCon = ec->Con;
+    handshake.State = kState_KeyExportInProgress;
+    handshake.EC = ec;
+    ec->AppState = &handshake;
+    handshake.Con = ec->Con;
 
     // Ensure the exchange context stays around until we're done with it.
     ec->AddRef();
 
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
-    if (mCon == NULL)
+    if (handshake.Con == NULL)
     {
         // Do nothing on the Ack received from the requestor.
-        // mEC->OnAckRcvd is not initialized.
+        // EC->OnAckRcvd is not initialized.
         // Do nothing on the message send error.
-        // mEC->OnSendError is not initialized.
+        // EC->OnSendError is not initialized.
 
         // Flush any pending WRM ACKs before we begin the long crypto operation,
         // to prevent the peer from re-transmitting the Key Export request.
-        err = mEC->WRMPFlushAcks();
+        err = handshake.EC->WRMPFlushAcks();
         SuccessOrExit(err);
     }
 #endif
@@ -2386,11 +2813,11 @@ void WeaveSecurityManager::HandleKeyExportRequest(ExchangeContext *ec, const IPP
     // Check if reconfiguration was requested.
     if (err == WEAVE_ERROR_KEY_EXPORT_RECONFIGURE_REQUIRED)
     {
-        err = SendKeyExportResponse(keyExport, kMsgType_KeyExportReconfigure, msgInfo);
+        err = SendKeyExportResponse(handshake, keyExport, kMsgType_KeyExportReconfigure, msgInfo);
     }
     else if (err == WEAVE_NO_ERROR)
     {
-        err = SendKeyExportResponse(keyExport, kMsgType_KeyExportResponse, msgInfo);
+        err = SendKeyExportResponse(handshake, keyExport, kMsgType_KeyExportResponse, msgInfo);
     }
     SuccessOrExit(err);
 
@@ -2406,11 +2833,11 @@ exit:
     keyExport.Shutdown();
 
     // Reset state.
-    Reset();
+    Reset(handshake);
 }
 
 __attribute__((noinline))
-WEAVE_ERROR WeaveSecurityManager::SendKeyExportResponse(WeaveKeyExport& keyExport, uint8_t msgType, const WeaveMessageInfo *msgInfo)
+WEAVE_ERROR WeaveSecurityManager::SendKeyExportResponse(Handshake &handshake, WeaveKeyExport& keyExport, uint8_t msgType, const WeaveMessageInfo *msgInfo)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
     PacketBuffer *msgBuf = NULL;
@@ -2434,14 +2861,14 @@ WEAVE_ERROR WeaveSecurityManager::SendKeyExportResponse(WeaveKeyExport& keyExpor
     msgBuf->SetDataLength(dataLen);
 
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
-    if (mCon == NULL)
+    if (handshake.Con == NULL)
     {
         sendFlags = ExchangeContext::kSendFlag_RequestAck;
     }
 #endif
 
     // Send key export response message.
-    err = mEC->SendMessage(kWeaveProfile_Security, msgType, msgBuf, sendFlags);
+    err = handshake.EC->SendMessage(kWeaveProfile_Security, msgType, msgBuf, sendFlags);
     msgBuf = NULL;
     SuccessOrExit(err);
 
@@ -2697,32 +3124,32 @@ exit:
     return;
 }
 
-WEAVE_ERROR WeaveSecurityManager::NewSessionExchange(uint64_t peerNodeId, IPAddress peerAddr, uint16_t peerPort)
+WEAVE_ERROR WeaveSecurityManager::NewSessionExchange(Handshake &handshake, uint64_t peerNodeId, IPAddress peerAddr, uint16_t peerPort)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
 
-    if (mEC != NULL)
+    if (handshake.EC != NULL)
     {
-        mEC->Close();
-        mEC = NULL;
+        handshake.EC->Close();
+        handshake.EC = NULL;
     }
 
     // Create a new exchange context.
-    if (mCon)
+    if (handshake.Con)
     {
-        mEC = ExchangeManager->NewContext(mCon, this);
-        VerifyOrExit(mEC != NULL, err = WEAVE_ERROR_NO_MEMORY);
+        handshake.EC = ExchangeManager->NewContext(handshake.Con, &handshake);
+        VerifyOrExit(handshake.EC != NULL, err = WEAVE_ERROR_NO_MEMORY);
     }
     else
     {
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
         VerifyOrExit(peerNodeId != kNodeIdNotSpecified && peerNodeId != kAnyNodeId, err = WEAVE_ERROR_INVALID_ARGUMENT);
 
-        mEC = ExchangeManager->NewContext(peerNodeId, peerAddr, peerPort, INET_NULL_INTERFACEID, this);
-        VerifyOrExit(mEC != NULL, err = WEAVE_ERROR_NO_MEMORY);
+        handshake.EC = ExchangeManager->NewContext(peerNodeId, peerAddr, peerPort, INET_NULL_INTERFACEID, &handshake);
+        VerifyOrExit(handshake.EC != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
-        mEC->OnAckRcvd = WRMPHandleAckRcvd;
-        mEC->OnSendError = WRMPHandleSendError;
+        handshake.EC->OnAckRcvd = WRMPHandleAckRcvd;
+        handshake.EC->OnSendError = WRMPHandleSendError;
 #else
         // Reject the request if no connection has been specified.
         ExitNow(err = WEAVE_ERROR_INVALID_ARGUMENT);
@@ -2874,14 +3301,14 @@ exit:
 #endif // WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC
 
 #if WEAVE_CONFIG_ENABLE_PASE_RESPONDER
-void WeaveSecurityManager::UpdatePASERateLimiter(WEAVE_ERROR err)
+void WeaveSecurityManager::UpdatePASERateLimiter(Handshake &handshake, WEAVE_ERROR err)
 {
     // Update PASE rate limiter parameters in the following cases:
     //   -- PASE with key confirmation: count only PASE attempts that fail with key confirmation error.
     //   -- PASE without key confirmation: every PASE attempt counts as failure.
-    if (State == kState_PASEInProgress && mPASEEngine->IsResponder() &&
-        ((mPASEEngine->PerformKeyConfirmation && err == WEAVE_ERROR_KEY_CONFIRMATION_FAILED) ||
-         (!mPASEEngine->PerformKeyConfirmation && err == WEAVE_NO_ERROR)))
+    if (handshake.State == kState_PASEInProgress && handshake.PASEEngine->IsResponder() &&
+        ((handshake.PASEEngine->PerformKeyConfirmation && err == WEAVE_ERROR_KEY_CONFIRMATION_FAILED) ||
+         (!handshake.PASEEngine->PerformKeyConfirmation && err == WEAVE_NO_ERROR)))
     {
         uint64_t nowTimeMS = System::Layer::GetClock_MonotonicMS();
 
@@ -2900,22 +3327,33 @@ void WeaveSecurityManager::UpdatePASERateLimiter(WEAVE_ERROR err)
 }
 #endif // WEAVE_CONFIG_ENABLE_PASE_RESPONDER
 
-WEAVE_ERROR WeaveSecurityManager::HandleSessionEstablished(void)
+WEAVE_ERROR WeaveSecurityManager::HandleSessionEstablished(Handshake &handshake)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
-    uint64_t peerNodeId = mEC->PeerNodeId;
-    uint16_t sessionKeyId = mSessionKeyId;
-    uint8_t encType = mEncType;
+    uint64_t peerNodeId = handshake.EC->PeerNodeId;
+    uint16_t sessionKeyId = handshake.SessionKeyId;
+    uint8_t encType = handshake.EncType;
     const WeaveEncryptionKey *sessionKey;
     WeaveAuthMode authMode;
 
-    switch (State)
+    switch (handshake.State)
     {
 #if WEAVE_CONFIG_ENABLE_CASE_INITIATOR || WEAVE_CONFIG_ENABLE_CASE_RESPONDER
     case kState_CASEInProgress:
 
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+        // A resumed session takes the key derived from the resumption secret, and the auth mode of
+        // the session from which the secret was saved.
+        if (handshake.ResumptionState != kResumptionState_None)
+        {
+            sessionKey = &handshake.ResumeCtx.EncryptionKey;
+            authMode = handshake.ResumeCtx.AuthMode;
+            break;
+        }
+#endif
+
         // Get the derived session key.
-        err = mCASEEngine->GetSessionKey(sessionKey);
+        err = handshake.CASEEngine->GetSessionKey(sessionKey);
         SuccessOrExit(err);
 
         // Form the key auth mode based on the type of certificate that was used by the peer.
@@ -2924,7 +3362,7 @@ WEAVE_ERROR WeaveSecurityManager::HandleSessionEstablished(void)
         // was requested by the application.  For example, if the app requested kWeaveAuthMode_CASE_AnyCert
         // then the final key auth mode will reflect the actual certificate type used by the peer.
         //
-        authMode = CASEAuthMode(mCASEEngine->CertType());
+        authMode = CASEAuthMode(handshake.CASEEngine->CertType());
 
         break;
 #endif
@@ -2933,14 +3371,14 @@ WEAVE_ERROR WeaveSecurityManager::HandleSessionEstablished(void)
     case kState_PASEInProgress:
 
         // Get the derived session key.
-        err = mPASEEngine->GetSessionKey(sessionKey);
+        err = handshake.PASEEngine->GetSessionKey(sessionKey);
         SuccessOrExit(err);
 
         // Form the key auth mode based on the password source.
-        authMode = PASEAuthMode(mPASEEngine->PwSource);
+        authMode = PASEAuthMode(handshake.PASEEngine->PwSource);
 
 #if WEAVE_CONFIG_ENABLE_PASE_RESPONDER
-        UpdatePASERateLimiter(WEAVE_NO_ERROR);
+        UpdatePASERateLimiter(handshake, WEAVE_NO_ERROR);
 #endif
 
         break;
@@ -2950,7 +3388,7 @@ WEAVE_ERROR WeaveSecurityManager::HandleSessionEstablished(void)
     case kState_TAKEInProgress:
 
         // Get the derived session key.
-        err = mTAKEEngine->GetSessionKey(sessionKey);
+        err = handshake.TAKEEngine->GetSessionKey(sessionKey);
         SuccessOrExit(err);
 
         // Currently only one key auth mode is supported for TAKE.
@@ -2967,21 +3405,37 @@ WEAVE_ERROR WeaveSecurityManager::HandleSessionEstablished(void)
     err = FabricState->SetSessionKey(sessionKeyId, peerNodeId, encType, authMode, sessionKey);
     SuccessOrExit(err);
 
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+    // Both parties derive a resumption secret from every CASE session, so that the next session
+    // between them can be resumed without public key operations.
+    if (handshake.State == kState_CASEInProgress)
+    {
+        uint8_t resumptionId[WeaveSessionResumption::kResumptionIdLength];
+        uint8_t secret[WeaveSessionResumption::kSecretLength];
+
+        err = CASE::ResumeSessionContext::DeriveResumptionSecret(*sessionKey, resumptionId, secret);
+        if (err == WEAVE_NO_ERROR)
+            FabricState->SaveSessionResumption(peerNodeId, authMode, resumptionId, secret);
+        ClearSecretData(secret, sizeof(secret));
+        SuccessOrExit(err);
+    }
+#endif
+
 exit:
     return err;
 }
 
-void WeaveSecurityManager::HandleSessionComplete(void)
+void WeaveSecurityManager::HandleSessionComplete(Handshake &handshake)
 {
-    WeaveConnection *con = mCon;
-    uint64_t peerNodeId = mEC->PeerNodeId;
-    uint16_t sessionKeyId = mSessionKeyId;
-    uint8_t encType = mEncType;
-    SessionEstablishedFunct userOnComplete = mStartSecureSession_OnComplete;
-    void *reqState = mStartSecureSession_ReqState;
+    WeaveConnection *con = handshake.Con;
+    uint64_t peerNodeId = handshake.EC->PeerNodeId;
+    uint16_t sessionKeyId = handshake.SessionKeyId;
+    uint8_t encType = handshake.EncType;
+    SessionEstablishedFunct userOnComplete = handshake.StartSecureSession_OnComplete;
+    void *reqState = handshake.StartSecureSession_ReqState;
 
     // Reset state.
-    Reset();
+    Reset(handshake);
 
     // Call the general session established handler.
     if (OnSessionEstablished != NULL)
@@ -3010,7 +3464,7 @@ void WeaveSecurityManager::HandleSessionComplete(void)
     AsyncNotifySecurityManagerAvailable();
 }
 
-void WeaveSecurityManager::HandleSessionError(WEAVE_ERROR err, PacketBuffer* statusReportMsgBuf)
+void WeaveSecurityManager::HandleSessionError(Handshake &handshake, WEAVE_ERROR err, PacketBuffer* statusReportMsgBuf)
 {
     // If session establishment in progress...
     //
@@ -3021,18 +3475,18 @@ void WeaveSecurityManager::HandleSessionError(WEAVE_ERROR err, PacketBuffer* sta
     // Then when SendMessage() returns, the function that called it will also call this
     // function with the error returned by SendMessage().
     //
-    if (State != kState_Idle)
+    if (handshake.State != kState_Idle)
     {
-        WeaveConnection *con = mCon;
-        uint64_t peerNodeId = mEC->PeerNodeId;
-        uint16_t sessionKeyId = mSessionKeyId;
-        SessionErrorFunct userOnError = mStartSecureSession_OnError;
-        void *reqState = mStartSecureSession_ReqState;
+        WeaveConnection *con = handshake.Con;
+        uint64_t peerNodeId = handshake.EC->PeerNodeId;
+        uint16_t sessionKeyId = handshake.SessionKeyId;
+        SessionErrorFunct userOnError = handshake.StartSecureSession_OnError;
+        void *reqState = handshake.StartSecureSession_ReqState;
         StatusReport rcvdStatusReport;
         StatusReport *statusReportPtr = NULL;
 
 #if WEAVE_CONFIG_ENABLE_PASE_RESPONDER
-        UpdatePASERateLimiter(err);
+        UpdatePASERateLimiter(handshake, err);
 #endif
 
         // If a status report was received from the peer, parse it and arrange to pass it
@@ -3048,13 +3502,13 @@ void WeaveSecurityManager::HandleSessionError(WEAVE_ERROR err, PacketBuffer* sta
 
         // Otherwise, send a status report to the peer with our reason for the failure.
         else
-            SendStatusReport(err, mEC);
+            SendStatusReport(err, handshake.EC);
 
         // Remove the session key from the key table.
         FabricState->RemoveSessionKey(sessionKeyId, peerNodeId);
 
         // Reset state.
-        Reset();
+        Reset(handshake);
 
         // Call the general session error handler.
         if (OnSessionError != NULL)
@@ -3072,18 +3526,19 @@ void WeaveSecurityManager::HandleSessionError(WEAVE_ERROR err, PacketBuffer* sta
 
 void WeaveSecurityManager::HandleConnectionClosed(ExchangeContext *ec, WeaveConnection *con, WEAVE_ERROR conErr)
 {
-    WeaveSecurityManager *secMgr = (WeaveSecurityManager *)ec->AppState;
+    Handshake *handshake = (Handshake *)ec->AppState;
+    WeaveSecurityManager *secMgr = handshake->SecMgr;
 
     if (conErr == WEAVE_NO_ERROR)
         conErr = WEAVE_ERROR_CONNECTION_CLOSED_UNEXPECTEDLY;
 
     // Clean-up the local state and invoke the appropriate callbacks.
 #if WEAVE_CONFIG_ENABLE_KEY_EXPORT_INITIATOR
-    if (secMgr->State == kState_KeyExportInProgress)
-        secMgr->HandleKeyExportError(conErr, NULL);
+    if (handshake->State == kState_KeyExportInProgress)
+        secMgr->HandleKeyExportError(*handshake, conErr, NULL);
     else
 #endif
-        secMgr->HandleSessionError(conErr, NULL);
+        secMgr->HandleSessionError(*handshake, conErr, NULL);
 }
 
 WEAVE_ERROR WeaveSecurityManager::SendStatusReport(WEAVE_ERROR localErr, ExchangeContext *ec)
@@ -3149,6 +3604,10 @@ WEAVE_ERROR WeaveSecurityManager::SendStatusReport(WEAVE_ERROR localErr, Exchang
         profileId = kWeaveProfile_Security;
         statusCode = kStatusCode_KeyConfirmationFailed;
         break;
+    case WEAVE_ERROR_KEY_NOT_FOUND:
+        profileId = kWeaveProfile_Security;
+        statusCode = kStatusCode_KeyNotFound;
+        break;
     case WEAVE_ERROR_INVALID_PASE_PARAMETER:
     case WEAVE_ERROR_CERT_USAGE_NOT_ALLOWED:
     case WEAVE_ERROR_CERT_PATH_LEN_CONSTRAINT_EXCEEDED:
@@ -3206,53 +3665,365 @@ exit:
     return err;
 }
 
-void WeaveSecurityManager::Reset(void)
+void WeaveSecurityManager::CryptoStep::Init(uint8_t id)
+{
+    memset(this, 0, sizeof(*this));
+    Id = id;
+}
+
+void WeaveSecurityManager::CryptoStep::Release(void)
+{
+    if (MsgBuf != NULL)
+    {
+        PacketBuffer::Free(MsgBuf);
+        MsgBuf = NULL;
+    }
+    if (OutMsgBuf != NULL)
+    {
+        PacketBuffer::Free(OutMsgBuf);
+        OutMsgBuf = NULL;
+    }
+}
+
+/**
+ * Perform a public key operation for the given handshake and then call the step's Finish function.
+ *
+ * When the crypto worker pool is running, the operation is handed to a worker thread and the Finish
+ * function is called later on the Weave thread.  Otherwise the operation is performed immediately.
+ * In either case the step's buffers are taken over, and are NULL on return.
+ */
+void WeaveSecurityManager::PerformCryptoStep(Handshake &handshake, CryptoStep &step)
 {
-    if (mEC != NULL)
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+#if WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
+    if (mCryptoWorkers.IsRunning())
     {
-        mEC->Abort();
-        mEC = NULL;
+        CryptoStep *pendingStep;
+
+        VerifyOrExit(handshake.PendingStep == NULL, err = WEAVE_ERROR_INCORRECT_STATE);
+
+        pendingStep = (CryptoStep *)Platform::Security::MemoryAlloc(sizeof(CryptoStep));
+        VerifyOrExit(pendingStep != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+        // Move the step, and the buffers it holds, to memory that outlives the caller.
+        memcpy(pendingStep, &step, sizeof(CryptoStep));
+        pendingStep->MsgInfo.InPacketInfo = NULL;
+        step.MsgBuf = NULL;
+        step.OutMsgBuf = NULL;
+
+        handshake.PendingStep = pendingStep;
+        handshake.Job.Run = RunCryptoJob;
+        handshake.Job.OnComplete = HandleCryptoJobComplete;
+        handshake.Job.AppState = &handshake;
+
+        Platform::Security::OnTimeConsumingCryptoStart();
+
+        err = mCryptoWorkers.Submit(&handshake.Job);
+        if (err != WEAVE_NO_ERROR)
+        {
+            Platform::Security::OnTimeConsumingCryptoDone();
+
+            handshake.PendingStep = NULL;
+            memcpy(&step, pendingStep, sizeof(CryptoStep));
+            Platform::Security::MemoryFree(pendingStep);
+        }
+
+    exit:
+        if (err != WEAVE_NO_ERROR)
+            FinishCryptoStep(handshake, err, step);
+        return;
+    }
+#endif // WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
+
+    Platform::Security::OnTimeConsumingCryptoStart();
+    err = RunCryptoStep(handshake, step);
+    Platform::Security::OnTimeConsumingCryptoDone();
+
+    FinishCryptoStep(handshake, err, step);
+}
+
+/**
+ * Perform the public key operation described by a step.
+ *
+ * This function may be called on a crypto worker thread, and must therefore only touch the step and the
+ * handshake's engine, which are not used by the Weave thread while the operation is pending.
+ */
+WEAVE_ERROR WeaveSecurityManager::RunCryptoStep(Handshake &handshake, CryptoStep &step)
+{
+    WEAVE_ERROR err = WEAVE_ERROR_INCORRECT_STATE;
+    WeaveFabricState *fabricState = handshake.SecMgr->FabricState;
+
+    switch (step.Id)
+    {
+#if WEAVE_CONFIG_ENABLE_PASE_INITIATOR
+    case kCryptoStep_SendPASEInitiatorStep1:
+        err = handshake.PASEEngine->GenerateInitiatorStep1(step.OutMsgBuf, step.Config, fabricState->LocalNodeId, step.PeerNodeId,
+                handshake.SessionKeyId, kWeaveEncryptionType_AES128CTRSHA1, step.PwSource, fabricState, true);
+        break;
+    case kCryptoStep_ProcessPASEResponderStep1:
+        err = handshake.PASEEngine->ProcessResponderStep1(step.MsgBuf);
+        break;
+    case kCryptoStep_ProcessPASEResponderStep2:
+        err = handshake.PASEEngine->ProcessResponderStep2(step.MsgBuf);
+        break;
+    case kCryptoStep_SendPASEInitiatorStep2:
+        err = handshake.PASEEngine->GenerateInitiatorStep2(step.OutMsgBuf);
+        break;
+#endif
+#if WEAVE_CONFIG_ENABLE_PASE_RESPONDER
+    case kCryptoStep_ProcessPASEInitiatorStep1:
+        err = handshake.PASEEngine->ProcessInitiatorStep1(step.MsgBuf, fabricState->LocalNodeId, step.PeerNodeId, fabricState);
+        break;
+    case kCryptoStep_SendPASEResponderStep1:
+        err = handshake.PASEEngine->GenerateResponderStep1(step.OutMsgBuf);
+        break;
+    case kCryptoStep_SendPASEResponderStep2:
+        err = handshake.PASEEngine->GenerateResponderStep2(step.OutMsgBuf);
+        break;
+    case kCryptoStep_ProcessPASEInitiatorStep2:
+        err = handshake.PASEEngine->ProcessInitiatorStep2(step.MsgBuf);
+        break;
+#endif
+#if WEAVE_CONFIG_ENABLE_CASE_INITIATOR
+    case kCryptoStep_SendCASEBeginSessionRequest:
+        err = handshake.CASEEngine->GenerateBeginSessionRequest(step.ReqCtx, step.OutMsgBuf);
+        break;
+    case kCryptoStep_ProcessCASEBeginSessionResponse:
+        step.RespCtx.Reset();
+        step.RespCtx.SetIsInitiator(true);
+        step.RespCtx.PeerNodeId = step.PeerNodeId;
+        step.RespCtx.MsgInfo = &step.MsgInfo;
+        err = handshake.CASEEngine->ProcessBeginSessionResponse(step.MsgBuf, step.RespCtx);
+        break;
+#endif
+#if WEAVE_CONFIG_ENABLE_CASE_RESPONDER
+    case kCryptoStep_ProcessCASEBeginSessionRequest:
+        step.ReqCtx.Reset();
+        step.ReqCtx.PeerNodeId = step.PeerNodeId;
+        step.ReqCtx.MsgInfo = &step.MsgInfo;
+        step.ReconfCtx.Reset();
+        err = handshake.CASEEngine->ProcessBeginSessionRequest(step.MsgBuf, step.ReqCtx, step.ReconfCtx);
+        break;
+    case kCryptoStep_SendCASEBeginSessionResponse:
+        step.ReqCtx.MsgInfo = &step.MsgInfo;
+        step.RespCtx.MsgInfo = &step.MsgInfo;
+        err = handshake.CASEEngine->GenerateBeginSessionResponse(step.RespCtx, step.OutMsgBuf, step.ReqCtx);
+        break;
+#endif
+    default:
+        break;
     }
 
-    switch (State)
+    return err;
+}
+
+/**
+ * Hand the outcome of a public key operation to the Finish function of its step, and then release the
+ * buffers the step still holds.
+ */
+void WeaveSecurityManager::FinishCryptoStep(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step)
+{
+    switch (step.Id)
+    {
+#if WEAVE_CONFIG_ENABLE_PASE_INITIATOR
+    case kCryptoStep_SendPASEInitiatorStep1:
+        FinishSendPASEInitiatorStep1(handshake, err, step);
+        break;
+    case kCryptoStep_ProcessPASEResponderStep1:
+        FinishProcessPASEResponderStep1(handshake, err, step);
+        break;
+    case kCryptoStep_ProcessPASEResponderStep2:
+        FinishProcessPASEResponderStep2(handshake, err, step);
+        break;
+    case kCryptoStep_SendPASEInitiatorStep2:
+        FinishSendPASEInitiatorStep2(handshake, err, step);
+        break;
+#endif
+#if WEAVE_CONFIG_ENABLE_PASE_RESPONDER
+    case kCryptoStep_ProcessPASEInitiatorStep1:
+        FinishProcessPASEInitiatorStep1(handshake, err, step);
+        break;
+    case kCryptoStep_SendPASEResponderStep1:
+        FinishSendPASEResponderStep1(handshake, err, step);
+        break;
+    case kCryptoStep_SendPASEResponderStep2:
+        FinishSendPASEResponderStep2(handshake, err, step);
+        break;
+    case kCryptoStep_ProcessPASEInitiatorStep2:
+        FinishProcessPASEInitiatorStep2(handshake, err, step);
+        break;
+#endif
+#if WEAVE_CONFIG_ENABLE_CASE_INITIATOR
+    case kCryptoStep_SendCASEBeginSessionRequest:
+        FinishSendCASEBeginSessionRequest(handshake, err, step);
+        break;
+    case kCryptoStep_ProcessCASEBeginSessionResponse:
+        FinishProcessCASEBeginSessionResponse(handshake, err, step);
+        break;
+#endif
+#if WEAVE_CONFIG_ENABLE_CASE_RESPONDER
+    case kCryptoStep_ProcessCASEBeginSessionRequest:
+        FinishProcessCASEBeginSessionRequest(handshake, err, step);
+        break;
+    case kCryptoStep_SendCASEBeginSessionResponse:
+        FinishSendCASEBeginSessionResponse(handshake, err, step);
+        break;
+#endif
+    default:
+        break;
+    }
+
+    step.Release();
+}
+
+#if WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
+
+WEAVE_ERROR WeaveSecurityManager::RunCryptoJob(CryptoJob *job)
+{
+    Handshake *handshake = (Handshake *)job->AppState;
+
+    return RunCryptoStep(*handshake, *handshake->PendingStep);
+}
+
+void WeaveSecurityManager::HandleCryptoJobComplete(CryptoJob *job)
+{
+    Handshake *handshake = (Handshake *)job->AppState;
+    WeaveSecurityManager *secMgr = handshake->SecMgr;
+    CryptoStep *step = handshake->PendingStep;
+
+    VerifyOrExit(step != NULL, );
+
+    handshake->PendingStep = NULL;
+
+    Platform::Security::OnTimeConsumingCryptoDone();
+
+    secMgr->FinishCryptoStep(*handshake, job->Result, *step);
+    Platform::Security::MemoryFree(step);
+
+    // Deliver a message that arrived while the operation was being performed, unless the handshake
+    // has since moved on to another operation or been reset.
+    if (handshake->HeldMsgBuf != NULL && handshake->PendingStep == NULL && handshake->EC != NULL)
+    {
+        PacketBuffer *msgBuf = handshake->HeldMsgBuf;
+        WeaveMessageInfo msgInfo = handshake->HeldMsgInfo;
+
+        handshake->HeldMsgBuf = NULL;
+        handshake->EC->OnMessageReceived(handshake->EC, NULL, &msgInfo, handshake->HeldProfileId, handshake->HeldMsgType, msgBuf);
+    }
+
+exit:
+    return;
+}
+
+/**
+ * Hold back a message received for a handshake while a public key operation is pending for it, so that
+ * the message can be delivered once the operation completes.
+ *
+ * @retval true     If the message was taken over, either to be held or because it had to be discarded.
+ * @retval false    If no operation is pending and the message should be handled now.
+ */
+bool WeaveSecurityManager::HoldMessage(Handshake &handshake, const WeaveMessageInfo *msgInfo, uint32_t profileId, uint8_t msgType,
+        PacketBuffer *msgBuf)
+{
+    if (handshake.PendingStep == NULL)
+        return false;
+
+    // A well-behaved peer never has more than one message outstanding while an operation is pending.
+    if (handshake.HeldMsgBuf != NULL)
+    {
+        PacketBuffer::Free(msgBuf);
+        HandleSessionError(handshake, WEAVE_ERROR_INCORRECT_STATE, NULL);
+        return true;
+    }
+
+    handshake.HeldMsgBuf = msgBuf;
+    handshake.HeldMsgInfo = *msgInfo;
+    handshake.HeldMsgInfo.InPacketInfo = NULL;
+    handshake.HeldProfileId = profileId;
+    handshake.HeldMsgType = msgType;
+
+    return true;
+}
+
+/**
+ * Withdraw the public key operation pending for the given handshake, if any, and discard any message
+ * held for it.  If a worker thread is performing the operation, this waits for it to finish.
+ */
+void WeaveSecurityManager::CancelCryptoStep(Handshake &handshake)
+{
+    if (handshake.PendingStep != NULL)
+    {
+        mCryptoWorkers.Cancel(&handshake.Job);
+
+        Platform::Security::OnTimeConsumingCryptoDone();
+
+        handshake.PendingStep->Release();
+        Platform::Security::MemoryFree(handshake.PendingStep);
+        handshake.PendingStep = NULL;
+    }
+
+    if (handshake.HeldMsgBuf != NULL)
+    {
+        PacketBuffer::Free(handshake.HeldMsgBuf);
+        handshake.HeldMsgBuf = NULL;
+    }
+}
+
+#endif // WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
+
+void WeaveSecurityManager::Reset(Handshake &handshake)
+{
+#if WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
+    // Make sure no worker thread is using the handshake's engine before it is released.
+    CancelCryptoStep(handshake);
+#endif
+
+    if (handshake.EC != NULL)
+    {
+        handshake.EC->Abort();
+        handshake.EC = NULL;
+    }
+
+    switch (handshake.State)
     {
 #if WEAVE_CONFIG_ENABLE_PASE_INITIATOR || WEAVE_CONFIG_ENABLE_PASE_RESPONDER
     case kState_PASEInProgress:
-        if (mPASEEngine != NULL)
+        if (handshake.PASEEngine != NULL)
         {
-            mPASEEngine->Shutdown();
-            Platform::Security::MemoryFree(mPASEEngine);
-            mPASEEngine = NULL;
+            handshake.PASEEngine->Shutdown();
+            Platform::Security::MemoryFree(handshake.PASEEngine);
+            handshake.PASEEngine = NULL;
         }
         break;
 #endif
 #if WEAVE_CONFIG_ENABLE_TAKE_INITIATOR || WEAVE_CONFIG_ENABLE_TAKE_RESPONDER
     case kState_TAKEInProgress:
-        if (mTAKEEngine != NULL)
+        if (handshake.TAKEEngine != NULL)
         {
-            mTAKEEngine->Shutdown();
-            Platform::Security::MemoryFree(mTAKEEngine);
-            mTAKEEngine = NULL;
+            handshake.TAKEEngine->Shutdown();
+            Platform::Security::MemoryFree(handshake.TAKEEngine);
+            handshake.TAKEEngine = NULL;
         }
         break;
 #endif
 #if WEAVE_CONFIG_ENABLE_CASE_INITIATOR || WEAVE_CONFIG_ENABLE_CASE_RESPONDER
     case kState_CASEInProgress:
-        if (mCASEEngine != NULL)
+        if (handshake.CASEEngine != NULL)
         {
-            mCASEEngine->Shutdown();
-            Platform::Security::MemoryFree(mCASEEngine);
-            mCASEEngine = NULL;
+            handshake.CASEEngine->Shutdown();
+            Platform::Security::MemoryFree(handshake.CASEEngine);
+            handshake.CASEEngine = NULL;
         }
         break;
 #endif
 #if WEAVE_CONFIG_ENABLE_KEY_EXPORT_INITIATOR
     case kState_KeyExportInProgress:
-        if (mKeyExport != NULL)
+        if (handshake.KeyExport != NULL)
         {
-            mKeyExport->Shutdown();
-            Platform::Security::MemoryFree(mKeyExport);
-            mKeyExport = NULL;
+            handshake.KeyExport->Shutdown();
+            Platform::Security::MemoryFree(handshake.KeyExport);
+            handshake.KeyExport = NULL;
         }
         break;
 #endif
@@ -3260,44 +4031,215 @@ void WeaveSecurityManager::Reset(void)
         break;
     }
 
-    Platform::Security::MemoryShutdown();
+    handshake.State = kState_Idle;
 
-    CancelSessionTimer();
+    // Release the security memory once the last in-progress session establishment is done with it.
+    if (!IsHandshakeInProgress())
+        Platform::Security::MemoryShutdown();
 
-    State = kState_Idle;
-    mCon = NULL;
-    mRequestedAuthMode = kWeaveAuthMode_NotSpecified;
-    mSessionKeyId = WeaveKeyId::kNone;
-    mEncType = kWeaveEncryptionType_None;
-    mStartSecureSession_OnComplete = NULL;
-    mStartSecureSession_OnError = NULL;
-    mStartSecureSession_ReqState = NULL;
+    CancelSessionTimer(handshake);
+
+    handshake.Con = NULL;
+    handshake.RequestedAuthMode = kWeaveAuthMode_NotSpecified;
+    handshake.SessionKeyId = WeaveKeyId::kNone;
+    handshake.EncType = kWeaveEncryptionType_None;
+    handshake.StartSecureSession_OnComplete = NULL;
+    handshake.StartSecureSession_OnError = NULL;
+    handshake.StartSecureSession_ReqState = NULL;
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+    handshake.ResumeCtx.Reset();
+    handshake.ResumptionState = kResumptionState_None;
+#endif
+
+#if WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE > 0
+    // Hand the freed slot to the oldest waiting peer request.
+    if (mAdmissionQueueCount > 0)
+        AsyncNotifySecurityManagerAvailable();
+#endif
+}
+
+WeaveSecurityManager::Handshake *WeaveSecurityManager::AllocHandshake(void)
+{
+    for (int i = 0; i < WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES; i++)
+    {
+        if (mHandshakePool[i].State == kState_Idle)
+            return &mHandshakePool[i];
+    }
+
+    return NULL;
+}
+
+bool WeaveSecurityManager::IsHandshakeAvailable(void) const
+{
+    for (int i = 0; i < WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES; i++)
+    {
+        if (mHandshakePool[i].State == kState_Idle)
+            return true;
+    }
+
+    return false;
 }
 
-void WeaveSecurityManager::StartSessionTimer(void)
+bool WeaveSecurityManager::IsHandshakeInProgress(void) const
+{
+    for (int i = 0; i < WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES; i++)
+    {
+        if (mHandshakePool[i].State != kState_Idle)
+            return true;
+    }
+
+    return false;
+}
+
+#if WEAVE_CONFIG_ENABLE_CASE_INITIATOR
+
+bool WeaveSecurityManager::IsSharedSessionInProgress(uint64_t terminatingNodeId, uint16_t sessionKeyId) const
+{
+    for (int i = 0; i < WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES; i++)
+    {
+        const Handshake &handshake = mHandshakePool[i];
+
+        if (handshake.State == kState_CASEInProgress && handshake.EC != NULL &&
+            handshake.EC->PeerNodeId == terminatingNodeId && handshake.SessionKeyId == sessionKeyId)
+            return true;
+    }
+
+    return false;
+}
+
+#endif // WEAVE_CONFIG_ENABLE_CASE_INITIATOR
+
+#if WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE > 0
+
+/**
+ * Queue a peer-initiated request until a session establishment slot becomes available.
+ *
+ * On success, the queue takes ownership of both the exchange context and the message buffer.
+ *
+ * @retval #WEAVE_NO_ERROR                        If the request was queued.
+ * @retval #WEAVE_ERROR_SECURITY_MANAGER_BUSY     If the queue is full, or the peer already has a
+ *                                                request waiting in the queue.
+ */
+WEAVE_ERROR WeaveSecurityManager::EnqueueHandshake(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo,
+        uint32_t profileId, uint8_t msgType, PacketBuffer *msgBuf)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    PendingHandshake *pending;
+
+    VerifyOrExit(mAdmissionQueueCount < WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE, err = WEAVE_ERROR_SECURITY_MANAGER_BUSY);
+
+    // Allow a single waiting request per peer, so that one peer cannot monopolize the queue.
+    for (uint8_t i = 0; i < mAdmissionQueueCount; i++)
+    {
+        pending = &mAdmissionQueue[(mAdmissionQueueHead + i) % WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE];
+        VerifyOrExit(pending->EC->PeerNodeId != ec->PeerNodeId, err = WEAVE_ERROR_SECURITY_MANAGER_BUSY);
+    }
+
+    pending = &mAdmissionQueue[(mAdmissionQueueHead + mAdmissionQueueCount) % WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE];
+    pending->EC = ec;
+    pending->MsgBuf = msgBuf;
+    pending->EnqueueTimeMS = System::Layer::GetClock_MonotonicMS();
+    pending->MsgInfo = *msgInfo;
+    pending->HasPktInfo = (pktInfo != NULL);
+    if (pktInfo != NULL)
+        pending->PktInfo = *pktInfo;
+    pending->ProfileId = profileId;
+    pending->MsgType = msgType;
+    mAdmissionQueueCount++;
+
+    // Ignore further messages on the exchange while the request waits.
+    ec->OnMessageReceived = NULL;
+
+    WeaveLogProgress(SecurityManager, "Session establishment request from node %016" PRIX64 " queued (%u waiting)",
+                     ec->PeerNodeId, mAdmissionQueueCount);
+
+exit:
+    return err;
+}
+
+/**
+ * Start queued peer requests, oldest first, for as long as session establishment slots are available.
+ *
+ * Requests that have waited longer than the session establishment timeout, or whose connection has
+ * closed in the meantime, are discarded.
+ */
+void WeaveSecurityManager::AdmitQueuedHandshakes(void)
+{
+    uint64_t nowTimeMS = System::Layer::GetClock_MonotonicMS();
+
+    while (mAdmissionQueueCount > 0)
+    {
+        PendingHandshake pending = mAdmissionQueue[mAdmissionQueueHead];
+        Handshake *handshake = NULL;
+
+        if ((SessionEstablishTimeout == 0 || nowTimeMS - pending.EnqueueTimeMS < SessionEstablishTimeout) &&
+            !pending.EC->IsConnectionClosed())
+        {
+            handshake = AllocHandshake();
+            if (handshake == NULL)
+                break;
+        }
+
+        mAdmissionQueueHead = (mAdmissionQueueHead + 1) % WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE;
+        mAdmissionQueueCount--;
+
+        if (handshake == NULL)
+        {
+            WeaveLogProgress(SecurityManager, "Queued session establishment request from node %016" PRIX64 " expired",
+                             pending.EC->PeerNodeId);
+            PacketBuffer::Free(pending.MsgBuf);
+            pending.EC->Release();
+            continue;
+        }
+
+        pending.MsgInfo.InCon = pending.EC->Con;
+        pending.MsgInfo.InPacketInfo = pending.HasPktInfo ? &pending.PktInfo : NULL;
+
+        StartResponderHandshake(*handshake, pending.EC, pending.MsgInfo.InPacketInfo, &pending.MsgInfo, pending.ProfileId, pending.MsgType,
+                                pending.MsgBuf);
+    }
+}
+
+void WeaveSecurityManager::ClearAdmissionQueue(void)
+{
+    while (mAdmissionQueueCount > 0)
+    {
+        PendingHandshake &pending = mAdmissionQueue[mAdmissionQueueHead];
+
+        PacketBuffer::Free(pending.MsgBuf);
+        pending.EC->Release();
+
+        mAdmissionQueueHead = (mAdmissionQueueHead + 1) % WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE;
+        mAdmissionQueueCount--;
+    }
+}
+
+#endif // WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE > 0
+
+void WeaveSecurityManager::StartSessionTimer(Handshake &handshake)
 {
     WeaveLogProgress(SecurityManager, "%s", __FUNCTION__);
 
     if (SessionEstablishTimeout != 0)
     {
-        mSystemLayer->StartTimer(SessionEstablishTimeout, HandleSessionTimeout, this);
+        mSystemLayer->StartTimer(SessionEstablishTimeout, HandleSessionTimeout, &handshake);
     }
 }
 
-void WeaveSecurityManager::CancelSessionTimer(void)
+void WeaveSecurityManager::CancelSessionTimer(Handshake &handshake)
 {
     WeaveLogProgress(SecurityManager, "%s", __FUNCTION__);
-    mSystemLayer->CancelTimer(HandleSessionTimeout, this);
+    mSystemLayer->CancelTimer(HandleSessionTimeout, &handshake);
 }
 
 void WeaveSecurityManager::HandleSessionTimeout(System::Layer* aSystemLayer, void* aAppState, System::Error aError)
 {
     WeaveLogProgress(SecurityManager, "%s", __FUNCTION__);
 
-    WeaveSecurityManager* securityMgr = reinterpret_cast<WeaveSecurityManager*>(aAppState);
-    if (securityMgr)
+    Handshake* handshake = reinterpret_cast<Handshake*>(aAppState);
+    if (handshake)
     {
-        securityMgr->HandleSessionError(WEAVE_ERROR_TIMEOUT, NULL);
+        handshake->SecMgr->HandleSessionError(*handshake, WEAVE_ERROR_TIMEOUT, NULL);
     }
 }
 
@@ -3338,6 +4280,25 @@ void WeaveSecurityManager::HandleIdleSessionTimeout(System::Layer* aLayer, void*
     }
 }
 
+#if WEAVE_CONFIG_ENABLE_CASE_INITIATOR || WEAVE_CONFIG_ENABLE_CASE_RESPONDER
+
+// Returns true if a CASE handshake has established its session but is waiting for the peer to
+// confirm receipt of the last message before completing.
+bool WeaveSecurityManager::IsCASEHandshakeComplete(const Handshake *handshake)
+{
+    if (handshake->State != kState_CASEInProgress || handshake->IsCryptoStepPending())
+        return false;
+
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+    if (handshake->ResumptionState != kResumptionState_None)
+        return handshake->ResumptionState == kResumptionState_ResponseSent;
+#endif
+
+    return handshake->CASEEngine != NULL && handshake->CASEEngine->State == WeaveCASEEngine::kState_Complete;
+}
+
+#endif // WEAVE_CONFIG_ENABLE_CASE_INITIATOR || WEAVE_CONFIG_ENABLE_CASE_RESPONDER
+
 void WeaveSecurityManager::OnEncryptedMsgRcvd(uint16_t sessionKeyId, uint64_t peerNodeId, uint8_t encType)
 {
     // Check if corresponding secure session is established but not completed - if true then complete this session.
@@ -3345,13 +4306,18 @@ void WeaveSecurityManager::OnEncryptedMsgRcvd(uint16_t sessionKeyId, uint64_t pe
     // is received before the Ack for the last message on the session establishment exchange.
     // In that case there is no need to wait for the Ack and the session can be completed.
 #if WEAVE_CONFIG_ENABLE_CASE_INITIATOR || WEAVE_CONFIG_ENABLE_CASE_RESPONDER
-    if (State == kState_CASEInProgress &&
-        mCASEEngine->State == WeaveCASEEngine::kState_Complete &&
-        mSessionKeyId == sessionKeyId &&
-        mEC->PeerNodeId == peerNodeId &&
-        mEncType == encType)
+    for (int i = 0; i < WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES; i++)
     {
-        HandleSessionComplete();
+        Handshake *handshake = &mHandshakePool[i];
+
+        if (IsCASEHandshakeComplete(handshake) &&
+            handshake->SessionKeyId == sessionKeyId &&
+            handshake->EC->PeerNodeId == peerNodeId &&
+            handshake->EncType == encType)
+        {
+            HandleSessionComplete(*handshake);
+            break;
+        }
     }
 #endif
 }
@@ -3361,29 +4327,30 @@ void WeaveSecurityManager::OnEncryptedMsgRcvd(uint16_t sessionKeyId, uint64_t pe
 void WeaveSecurityManager::WRMPHandleAckRcvd(ExchangeContext *ec, void *msgCtxt)
 {
     WeaveLogProgress(SecurityManager, "%s", __FUNCTION__);
-    WeaveSecurityManager *secMgr = (WeaveSecurityManager *)ec->AppState;
+    Handshake *handshake = (Handshake *)ec->AppState;
+    WeaveSecurityManager *secMgr = handshake->SecMgr;
 
-    if (secMgr->State == kState_CASEInProgress &&
-        secMgr->mCASEEngine->State == WeaveCASEEngine::kState_Complete)
+    if (IsCASEHandshakeComplete(handshake))
     {
-        secMgr->HandleSessionComplete();
+        secMgr->HandleSessionComplete(*handshake);
     }
 }
 
 void WeaveSecurityManager::WRMPHandleSendError(ExchangeContext *ec, WEAVE_ERROR err, void *msgCtxt)
 {
     WeaveLogProgress(SecurityManager, "%s", __FUNCTION__);
-    WeaveSecurityManager *secMgr = (WeaveSecurityManager *)ec->AppState;
+    Handshake *handshake = (Handshake *)ec->AppState;
+    WeaveSecurityManager *secMgr = handshake->SecMgr;
 
 #if WEAVE_CONFIG_ENABLE_KEY_EXPORT_INITIATOR
-    if (secMgr->State == kState_KeyExportInProgress)
+    if (handshake->State == kState_KeyExportInProgress)
     {
-        secMgr->HandleKeyExportError(err, NULL);
+        secMgr->HandleKeyExportError(*handshake, err, NULL);
     }
     else
 #endif
     {
-        secMgr->HandleSessionError(err, NULL);
+        secMgr->HandleSessionError(*handshake, err, NULL);
     }
 }
 
@@ -3399,7 +4366,13 @@ void WeaveSecurityManager::DoNotifySecurityManagerAvailable(System::Layer *syste
     WeaveSecurityManager *_this = (WeaveSecurityManager *)appState;
     if (_this->State == kState_Idle)
     {
-        _this->ExchangeManager->NotifySecurityManagerAvailable();
+#if WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE > 0
+        // Peer requests that have been waiting take precedence over new local requests.
+        _this->AdmitQueuedHandshakes();
+#endif
+
+        if (_this->IsHandshakeAvailable())
+            _this->ExchangeManager->NotifySecurityManagerAvailable();
     }
 }
 
@@ -3416,25 +4389,29 @@ void WeaveSecurityManager::DoNotifySecurityManagerAvailable(System::Layer *syste
  */
 WEAVE_ERROR WeaveSecurityManager::CancelSessionEstablishment(void *reqState)
 {
-    // If a session establishment is in progress and the supplied request state matches what was provided
-    // when the session was started...
-    if ((State == kState_CASEInProgress || State == kState_PASEInProgress || State == kState_TAKEInProgress) &&
-        reqState == mStartSecureSession_ReqState)
+    for (int i = 0; i < WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES; i++)
     {
-        // Clear the application's OnError handler to prevent a callback.
-        mStartSecureSession_OnError = NULL;
+        Handshake *handshake = &mHandshakePool[i];
+
+        // If a session establishment is in progress and the supplied request state matches what was provided
+        // when the session was started...
+        if ((handshake->State == kState_CASEInProgress || handshake->State == kState_PASEInProgress ||
+             handshake->State == kState_TAKEInProgress) &&
+            reqState == handshake->StartSecureSession_ReqState)
+        {
 
-        // Fail the session with a canceled error.
-        HandleSessionError(WEAVE_ERROR_TRANSACTION_CANCELED, NULL);
+            // Clear the application's OnError handler to prevent a callback.
+            handshake->StartSecureSession_OnError = NULL;
 
-        return WEAVE_NO_ERROR;
+            // Fail the session with a canceled error.
+            HandleSessionError(*handshake, WEAVE_ERROR_TRANSACTION_CANCELED, NULL);
+
+            return WEAVE_NO_ERROR;
+        }
     }
 
     // Otherwise, tell the caller there was no match.
-    else
-    {
-        return WEAVE_ERROR_INCORRECT_STATE;
-    }
+    return WEAVE_ERROR_INCORRECT_STATE;
 }
 
 /**
@@ -3506,6 +4483,7 @@ void WeaveSecurityManager::ReserveSessionKey(WeaveSessionKey *sessionKey)
     VerifyOrDie(sessionKey->ReserveCount < UINT8_MAX);
     sessionKey->ReserveCount++;
     sessionKey->MarkRecentlyActive();
+    FabricState->ClearSessionKeyIdle(sessionKey);
     WeaveLogDetail(SecurityManager, "Reserve session key: Id=%04" PRIX16 " Peer=%016" PRIX64 " Reserve=%" PRId8,
             sessionKey->MsgEncKey.KeyId, sessionKey->NodeId, sessionKey->ReserveCount);
 }
@@ -3525,6 +4503,9 @@ void WeaveSecurityManager::ReleaseSessionKey(WeaveSessionKey *sessionKey)
     WeaveLogDetail(SecurityManager, "Release session key: Id=%04" PRIX16 " Peer=%016" PRIX64 " Reserve=%" PRId8,
             sessionKey->MsgEncKey.KeyId, sessionKey->NodeId, sessionKey->ReserveCount);
 
+    if (sessionKey->ReserveCount == 0)
+        FabricState->MarkSessionKeyIdle(sessionKey);
+
     // If the session key is subject to automatic removal and its reserve count is now zero...
     if (sessionKey->BoundCon == NULL &&
         sessionKey->IsKeySet() &&
@@ -39,6 +39,7 @@
 #include <Weave/Profiles/security/WeaveKeyExport.h>
 #include <Weave/Profiles/common/WeaveMessage.h>
 #include <Weave/Profiles/status-report/StatusReportProfile.h>
+#include <Weave/Core/WeaveCryptoWorkerPool.h>
 
 /**
  *   @namespace nl::Weave::Platform::Security
@@ -194,7 +195,8 @@ public:
 
     WeaveFabricState *FabricState;                      // [READ ONLY] Associated Fabric State object.
     WeaveExchangeManager *ExchangeManager;              // [READ ONLY] Associated Exchange Manager object.
-    uint8_t State;                                      // [READ ONLY] State of the Weave Message Layer object
+    uint8_t State;                                      // [READ ONLY] State of the Weave Security Manager object (NotInitialized or Idle;
+                                                        // the progress of each session establishment is tracked separately)
 #if WEAVE_CONFIG_ENABLE_CASE_INITIATOR
     uint32_t InitiatorCASEConfig;                       // CASE configuration proposed when initiating a CASE session
     uint32_t InitiatorCASECurveId;                      // ECDH curve proposed when initiating a CASE session
@@ -363,52 +365,164 @@ private:
         kFlag_IdleSessionTimerRunning   = 0x01
     };
 
-    ExchangeContext *mEC;
-    WeaveConnection *mCon;
-    union
+    /**
+     * The inputs and outputs of a public key operation performed on behalf of a handshake.  The
+     * operation runs on a crypto worker thread when #WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS is
+     * non-zero, and on the Weave thread otherwise.
+     */
+    class CryptoStep
+    {
+    public:
+        PacketBuffer *MsgBuf;                           // The received message being processed, if any.
+        PacketBuffer *OutMsgBuf;                        // The buffer receiving a generated message, if any.
+        WeaveMessageInfo MsgInfo;                       // Information about the received message.
+        uint64_t PeerNodeId;
+        uint32_t Config;
+        uint16_t SendFlags;
+        uint8_t PwSource;
+        uint8_t Id;
+#if WEAVE_CONFIG_ENABLE_CASE_INITIATOR || WEAVE_CONFIG_ENABLE_CASE_RESPONDER
+        Profiles::Security::CASE::BeginSessionRequestContext ReqCtx;
+        Profiles::Security::CASE::BeginSessionResponseContext RespCtx;
+        Profiles::Security::CASE::ReconfigureContext ReconfCtx;
+#endif
+
+        void Init(uint8_t id);
+        void Release(void);
+    };
+
+    enum
+    {
+        kCryptoStep_SendPASEInitiatorStep1              = 1,
+        kCryptoStep_ProcessPASEResponderStep1           = 2,
+        kCryptoStep_ProcessPASEResponderStep2           = 3,
+        kCryptoStep_SendPASEInitiatorStep2              = 4,
+        kCryptoStep_ProcessPASEInitiatorStep1           = 5,
+        kCryptoStep_SendPASEResponderStep1              = 6,
+        kCryptoStep_SendPASEResponderStep2              = 7,
+        kCryptoStep_ProcessPASEInitiatorStep2           = 8,
+        kCryptoStep_SendCASEBeginSessionRequest         = 9,
+        kCryptoStep_ProcessCASEBeginSessionResponse     = 10,
+        kCryptoStep_ProcessCASEBeginSessionRequest      = 11,
+        kCryptoStep_SendCASEBeginSessionResponse        = 12,
+    };
+
+    enum
+    {
+        kResumptionState_None                           = 0,
+        kResumptionState_RequestSent                    = 1,
+        kResumptionState_ResponseSent                   = 2,
+    };
+
+    /**
+     * State of a single in-progress session establishment or key export.
+     */
+    class Handshake
     {
+    public:
+        WeaveSecurityManager *SecMgr;
+        ExchangeContext *EC;
+        WeaveConnection *Con;
+        union
+        {
 #if WEAVE_CONFIG_ENABLE_PASE_INITIATOR || WEAVE_CONFIG_ENABLE_PASE_RESPONDER
-        WeavePASEEngine *mPASEEngine;
+            WeavePASEEngine *PASEEngine;
 #endif
 #if WEAVE_CONFIG_ENABLE_CASE_INITIATOR || WEAVE_CONFIG_ENABLE_CASE_RESPONDER
-        WeaveCASEEngine *mCASEEngine;
+            WeaveCASEEngine *CASEEngine;
 #endif
 #if WEAVE_CONFIG_ENABLE_TAKE_INITIATOR || WEAVE_CONFIG_ENABLE_TAKE_RESPONDER
-        WeaveTAKEEngine *mTAKEEngine;
+            WeaveTAKEEngine *TAKEEngine;
 #endif
 #if WEAVE_CONFIG_ENABLE_KEY_EXPORT_INITIATOR
-        WeaveKeyExport *mKeyExport;
+            WeaveKeyExport *KeyExport;
+#endif
+        };
+        union
+        {
+            SessionEstablishedFunct StartSecureSession_OnComplete;
+
+            /**
+             * The key export protocol complete callback function. This function is
+             * called when the secret key export process is complete.
+             */
+            KeyExportCompleteFunct StartKeyExport_OnComplete;
+        };
+        union
+        {
+            SessionErrorFunct StartSecureSession_OnError;
+
+            /**
+             * The key export protocol error callback function. This function is
+             * called when an error is encountered during key export process.
+             */
+            KeyExportErrorFunct StartKeyExport_OnError;
+        };
+        union
+        {
+            void *StartSecureSession_ReqState;
+            void *StartKeyExport_ReqState;
+        };
+        uint16_t        SessionKeyId;
+        WeaveAuthMode   RequestedAuthMode;
+        uint8_t         EncType;
+        uint8_t         State;
+#if WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
+        CryptoJob       Job;
+        CryptoStep *    PendingStep;                    // The operation a worker is performing, if any.
+        PacketBuffer *  HeldMsgBuf;                     // A message received while the operation is performed.
+        WeaveMessageInfo HeldMsgInfo;
+        uint32_t        HeldProfileId;
+        uint8_t         HeldMsgType;
+#endif
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+        Profiles::Security::CASE::ResumeSessionContext ResumeCtx;
+        uint8_t         ResumptionState;                // Progress of a CASE session resumption, if one is underway.
 #endif
-    };
-    union
-    {
-        SessionEstablishedFunct mStartSecureSession_OnComplete;
 
-        /**
-         * The key export protocol complete callback function. This function is
-         * called when the secret key export process is complete.
-         */
-        KeyExportCompleteFunct mStartKeyExport_OnComplete;
+        bool IsCryptoStepPending(void) const
+        {
+#if WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
+            return PendingStep != NULL;
+#else
+            return false;
+#endif
+        }
     };
-    union
-    {
-        SessionErrorFunct mStartSecureSession_OnError;
 
-        /**
-         * The key export protocol error callback function. This function is
-         * called when an error is encountered during key export process.
-         */
-        KeyExportErrorFunct mStartKeyExport_OnError;
-    };
-    union
+    Handshake mHandshakePool[WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES];
+
+#if WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE > 0
+    /**
+     * A request to start a session establishment or key export, received from a peer while
+     * all handshakes were in use, and waiting to be admitted.
+     */
+    struct PendingHandshake
     {
-        void *mStartSecureSession_ReqState;
-        void *mStartKeyExport_ReqState;
+        ExchangeContext *EC;
+        PacketBuffer *MsgBuf;
+        uint64_t EnqueueTimeMS;
+        WeaveMessageInfo MsgInfo;
+        IPPacketInfo PktInfo;
+        uint32_t ProfileId;
+        uint8_t MsgType;
+        bool HasPktInfo;
     };
+
+    PendingHandshake mAdmissionQueue[WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE];
+    uint8_t mAdmissionQueueHead;
+    uint8_t mAdmissionQueueCount;
+
+    WEAVE_ERROR EnqueueHandshake(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo,
+            uint32_t profileId, uint8_t msgType, PacketBuffer *msgBuf);
+    void AdmitQueuedHandshakes(void);
+    void ClearAdmissionQueue(void);
+#endif // WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE > 0
+
 #if WEAVE_CONFIG_ENABLE_PASE_RESPONDER
     uint32_t mPASERateLimiterTimeout;
     uint8_t mPASERateLimiterCount;
-    void UpdatePASERateLimiter(WEAVE_ERROR err);
+    void UpdatePASERateLimiter(Handshake &handshake, WEAVE_ERROR err);
 #endif
 #if WEAVE_CONFIG_ENABLE_CASE_INITIATOR || WEAVE_CONFIG_ENABLE_CASE_RESPONDER
     WeaveCASEAuthDelegate *mDefaultAuthDelegate;
@@ -423,14 +537,25 @@ private:
     WeaveKeyExportDelegate *mDefaultKeyExportDelegate;
 #endif
 
-    uint16_t        mSessionKeyId;
-    WeaveAuthMode   mRequestedAuthMode;
-    uint8_t         mEncType;
     System::Layer*  mSystemLayer;
     uint8_t         mFlags;
 
-    void StartSessionTimer(void);
-    void CancelSessionTimer(void);
+#if WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
+    CryptoWorkerPool mCryptoWorkers;
+
+    static WEAVE_ERROR RunCryptoJob(CryptoJob *job);
+    static void HandleCryptoJobComplete(CryptoJob *job);
+    bool HoldMessage(Handshake &handshake, const WeaveMessageInfo *msgInfo, uint32_t profileId, uint8_t msgType,
+            PacketBuffer *msgBuf);
+    void CancelCryptoStep(Handshake &handshake);
+#endif
+
+    void PerformCryptoStep(Handshake &handshake, CryptoStep &step);
+    static WEAVE_ERROR RunCryptoStep(Handshake &handshake, CryptoStep &step);
+    void FinishCryptoStep(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step);
+
+    void StartSessionTimer(Handshake &handshake);
+    void CancelSessionTimer(Handshake &handshake);
     static void HandleSessionTimeout(System::Layer* aSystemLayer, void* aAppState, System::Error aError);
 
     void StartIdleSessionTimer(void);
@@ -439,80 +564,107 @@ private:
 
     static void HandleUnsolicitedMessage(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo,
             uint32_t profileId, uint8_t msgType, PacketBuffer *msgBuf);
+    void StartResponderHandshake(Handshake &handshake, ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo,
+            uint32_t profileId, uint8_t msgType, PacketBuffer *msgBuf);
 
-    void StartPASESession(void);
-    void HandlePASESessionStart(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf);
-    WEAVE_ERROR ProcessPASEInitiatorStep1(ExchangeContext *ec, PacketBuffer *msgBuf);
-    WEAVE_ERROR SendPASEResponderReconfigure(void);
-    WEAVE_ERROR SendPASEResponderStep1(void);
-    WEAVE_ERROR SendPASEResponderStep2(void);
-    WEAVE_ERROR SendPASEInitiatorStep1(uint32_t paseConfig);
-    WEAVE_ERROR ProcessPASEResponderReconfigure(PacketBuffer *msgBuf, uint32_t &newConfig);
-    WEAVE_ERROR ProcessPASEResponderStep1(PacketBuffer *msgBuf);
-    WEAVE_ERROR ProcessPASEResponderStep2(PacketBuffer *msgBuf);
-    WEAVE_ERROR SendPASEInitiatorStep2(void);
-    WEAVE_ERROR ProcessPASEInitiatorStep2(PacketBuffer *msgBuf);
-    WEAVE_ERROR SendPASEResponderKeyConfirm(void);
-    WEAVE_ERROR ProcessPASEResponderKeyConfirm(PacketBuffer *msgBuf);
+    Handshake *AllocHandshake(void);
+    bool IsHandshakeAvailable(void) const;
+    bool IsHandshakeInProgress(void) const;
+#if WEAVE_CONFIG_ENABLE_CASE_INITIATOR
+    bool IsSharedSessionInProgress(uint64_t terminatingNodeId, uint16_t sessionKeyId) const;
+#endif
+
+    void StartPASESession(Handshake &handshake);
+    void HandlePASESessionStart(Handshake &handshake, ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf);
+    WEAVE_ERROR ProcessPASEInitiatorStep1(Handshake &handshake, ExchangeContext *ec, PacketBuffer *msgBuf);
+    void FinishProcessPASEInitiatorStep1(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step);
+    WEAVE_ERROR SendPASEResponderReconfigure(Handshake &handshake);
+    WEAVE_ERROR SendPASEResponderStep1(Handshake &handshake);
+    void FinishSendPASEResponderStep1(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step);
+    WEAVE_ERROR SendPASEResponderStep2(Handshake &handshake);
+    void FinishSendPASEResponderStep2(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step);
+    WEAVE_ERROR SendPASEInitiatorStep1(Handshake &handshake, uint32_t paseConfig);
+    void FinishSendPASEInitiatorStep1(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step);
+    WEAVE_ERROR ProcessPASEResponderReconfigure(Handshake &handshake, PacketBuffer *msgBuf, uint32_t &newConfig);
+    WEAVE_ERROR ProcessPASEResponderStep1(Handshake &handshake, PacketBuffer *msgBuf);
+    void FinishProcessPASEResponderStep1(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step);
+    WEAVE_ERROR ProcessPASEResponderStep2(Handshake &handshake, PacketBuffer *msgBuf);
+    void FinishProcessPASEResponderStep2(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step);
+    WEAVE_ERROR SendPASEInitiatorStep2(Handshake &handshake);
+    void FinishSendPASEInitiatorStep2(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step);
+    WEAVE_ERROR ProcessPASEInitiatorStep2(Handshake &handshake, PacketBuffer *msgBuf);
+    void FinishProcessPASEInitiatorStep2(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step);
+    WEAVE_ERROR SendPASEResponderKeyConfirm(Handshake &handshake);
+    WEAVE_ERROR ProcessPASEResponderKeyConfirm(Handshake &handshake, PacketBuffer *msgBuf);
     static void HandlePASEMessageInitiator(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo,
             uint32_t profileId, uint8_t msgType, PacketBuffer *msgBuf);
     static void HandlePASEMessageResponder(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo,
             uint32_t profileId, uint8_t msgType, PacketBuffer *msgBuf);
 
-    void StartCASESession(uint32_t config, uint32_t curveId);
-    void HandleCASESessionStart(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf);
+    void StartCASESession(Handshake &handshake, uint32_t config, uint32_t curveId);
+    void FinishSendCASEBeginSessionRequest(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step);
+    WEAVE_ERROR ProcessCASEBeginSessionResponse(Handshake &handshake, const WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf);
+    void FinishProcessCASEBeginSessionResponse(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step);
+    void HandleCASESessionStart(Handshake &handshake, ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf);
+    void FinishProcessCASEBeginSessionRequest(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step);
+    void FinishSendCASEBeginSessionResponse(Handshake &handshake, WEAVE_ERROR err, CryptoStep &step);
     static void HandleCASEMessageInitiator(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo,
             uint32_t profileId, uint8_t msgType, PacketBuffer *msgBuf);
     static void HandleCASEMessageResponder(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo,
             uint32_t profileId, uint8_t msgType, PacketBuffer *msgBuf);
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+    bool StartCASEResumeSession(Handshake &handshake);
+    void HandleCASEResumeSessionStart(Handshake &handshake, ExchangeContext *ec, PacketBuffer *msgBuf);
+#endif
+    static bool IsCASEHandshakeComplete(const Handshake *handshake);
 
-    void StartTAKESession(bool encryptAuthPhase, bool encryptCommPhase, bool timeLimitedIK, bool sendChallengerId);
-    void HandleTAKESessionStart(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf);
-    WEAVE_ERROR SendTAKEIdentifyToken(uint8_t takeConfig, bool encryptAuthPhase, bool encryptCommPhase, bool timeLimitedIK, bool sendChallengerId);
+    void StartTAKESession(Handshake &handshake, bool encryptAuthPhase, bool encryptCommPhase, bool timeLimitedIK, bool sendChallengerId);
+    void HandleTAKESessionStart(Handshake &handshake, ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf);
+    WEAVE_ERROR SendTAKEIdentifyToken(Handshake &handshake, uint8_t takeConfig, bool encryptAuthPhase, bool encryptCommPhase, bool timeLimitedIK, bool sendChallengerId);
     static void HandleTAKEMessageInitiator(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo,
             uint32_t profileId, uint8_t msgType, PacketBuffer *msgBuf);
     static void HandleTAKEMessageResponder(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo,
             uint32_t profileId, uint8_t msgType, PacketBuffer *msgBuf);
-    WEAVE_ERROR ProcessTAKEIdentifyTokenResponse(const PacketBuffer *msgBuf);
-    WEAVE_ERROR CreateTAKESecureSession(void);
-    WEAVE_ERROR SendTAKEAuthenticateToken(void);
-    WEAVE_ERROR ProcessTAKEAuthenticateToken(const PacketBuffer *msgBuf);
-    WEAVE_ERROR SendTAKEAuthenticateTokenResponse(void);
-    WEAVE_ERROR ProcessTAKEAuthenticateTokenResponse(const PacketBuffer *msgBuf);
-    WEAVE_ERROR SendTAKEReAuthenticateToken(void);
-    WEAVE_ERROR ProcessTAKEReAuthenticateToken(const PacketBuffer *msgBuf);
-    WEAVE_ERROR SendTAKEReAuthenticateTokenResponse(void);
-    WEAVE_ERROR ProcessTAKEReAuthenticateTokenResponse(const PacketBuffer *msgBuf);
-    WEAVE_ERROR SendTAKETokenReconfigure(void);
-    WEAVE_ERROR ProcessTAKETokenReconfigure(uint8_t& config, const PacketBuffer *msgBuf);
-    WEAVE_ERROR FinishTAKESetUp(void);
+    WEAVE_ERROR ProcessTAKEIdentifyTokenResponse(Handshake &handshake, const PacketBuffer *msgBuf);
+    WEAVE_ERROR CreateTAKESecureSession(Handshake &handshake);
+    WEAVE_ERROR SendTAKEAuthenticateToken(Handshake &handshake);
+    WEAVE_ERROR ProcessTAKEAuthenticateToken(Handshake &handshake, const PacketBuffer *msgBuf);
+    WEAVE_ERROR SendTAKEAuthenticateTokenResponse(Handshake &handshake);
+    WEAVE_ERROR ProcessTAKEAuthenticateTokenResponse(Handshake &handshake, const PacketBuffer *msgBuf);
+    WEAVE_ERROR SendTAKEReAuthenticateToken(Handshake &handshake);
+    WEAVE_ERROR ProcessTAKEReAuthenticateToken(Handshake &handshake, const PacketBuffer *msgBuf);
+    WEAVE_ERROR SendTAKEReAuthenticateTokenResponse(Handshake &handshake);
+    WEAVE_ERROR ProcessTAKEReAuthenticateTokenResponse(Handshake &handshake, const PacketBuffer *msgBuf);
+    WEAVE_ERROR SendTAKETokenReconfigure(Handshake &handshake);
+    WEAVE_ERROR ProcessTAKETokenReconfigure(Handshake &handshake, uint8_t& config, const PacketBuffer *msgBuf);
+    WEAVE_ERROR FinishTAKESetUp(Handshake &handshake);
 
     void HandleKeyErrorMsg(ExchangeContext *ec, PacketBuffer *msgBuf);
 
 #if WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC
     WEAVE_ERROR NewMsgCounterSyncExchange(const WeaveMessageInfo *rcvdMsgInfo, const IPPacketInfo *rcvdMsgPacketInfo, ExchangeContext *& ec);
 #endif
-    WEAVE_ERROR NewSessionExchange(uint64_t peerNodeId, IPAddress peerAddr, uint16_t peerPort);
-    WEAVE_ERROR HandleSessionEstablished(void);
-    void HandleSessionComplete(void);
-    void HandleSessionError(WEAVE_ERROR err, PacketBuffer *statusReportMsgBuf);
+    WEAVE_ERROR NewSessionExchange(Handshake &handshake, uint64_t peerNodeId, IPAddress peerAddr, uint16_t peerPort);
+    WEAVE_ERROR HandleSessionEstablished(Handshake &handshake);
+    void HandleSessionComplete(Handshake &handshake);
+    void HandleSessionError(Handshake &handshake, WEAVE_ERROR err, PacketBuffer *statusReportMsgBuf);
     static void HandleConnectionClosed(ExchangeContext *ec, WeaveConnection *con, WEAVE_ERROR conErr);
 
     static WEAVE_ERROR SendStatusReport(WEAVE_ERROR localError, ExchangeContext *ec);
 
-    void HandleKeyExportRequest(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf);
-    WEAVE_ERROR SendKeyExportRequest(uint8_t keyExportConfig, uint32_t keyId, bool signMessage);
-    WEAVE_ERROR SendKeyExportResponse(WeaveKeyExport& keyExport, uint8_t msgType, const WeaveMessageInfo *msgInfo);
+    void HandleKeyExportRequest(Handshake &handshake, ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo, PacketBuffer *msgBuf);
+    WEAVE_ERROR SendKeyExportRequest(Handshake &handshake, uint8_t keyExportConfig, uint32_t keyId, bool signMessage);
+    WEAVE_ERROR SendKeyExportResponse(Handshake &handshake, WeaveKeyExport& keyExport, uint8_t msgType, const WeaveMessageInfo *msgInfo);
     static void HandleKeyExportMessageInitiator(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo,
                                                 uint32_t profileId, uint8_t msgType, PacketBuffer *msgBuf);
-    void HandleKeyExportError(WEAVE_ERROR err, PacketBuffer *statusReportMsgBuf);
+    void HandleKeyExportError(Handshake &handshake, WEAVE_ERROR err, PacketBuffer *statusReportMsgBuf);
 
 #if WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
     static void WRMPHandleAckRcvd(ExchangeContext *ec, void *msgCtxt);
     static void WRMPHandleSendError(ExchangeContext *ec, WEAVE_ERROR err, void *msgCtxt);
 #endif // WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
 
-    void Reset(void);
+    void Reset(Handshake &handshake);
 
     void AsyncNotifySecurityManagerAvailable();
     static void DoNotifySecurityManagerAvailable(System::Layer *systemLayer, void *appState, System::Error err);
@@ -153,9 +153,9 @@ WEAVE_ERROR WeaveServerBase::SendStatusReport(ExchangeContext *ec, uint32_t stat
     uint8_t*        p;
     uint8_t         respLen = 18; // sizeof(statusProfileId) + sizeof(statusCode) + StartContainer(1) + kTag_SystemErrorCode TLV Len (10), EndContainer (1)
 
-    respBuf = PacketBuffer::NewWithAvailableSize(respLen);
-    VerifyOrExit(respBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
     VerifyOrDie(ec != NULL);
+    respBuf = PacketBuffer::NewWithAvailableSize(ec->GetHeaderReserveSize(sendFlags), respLen);
+    VerifyOrExit(respBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
 
     p = respBuf->Start();
     LittleEndian::Write32(p, statusProfileId);
@@ -66,6 +66,51 @@ enum {
     kTLVControlByte_NotSpecified = 0xFFFF
 };
 
+/**
+ * Describes a contiguous run of the value bytes of a TLV byte or UTF8 string, in place within the
+ * buffer that holds it.
+ *
+ * A string value read from, or written to, a chain of buffers is represented as a sequence of
+ * segments, one for each buffer the value spans.
+ */
+struct TLVDataSegment
+{
+    const uint8_t *Data;            ///< A pointer to the first byte of the segment.
+    uint32_t Len;                   ///< The number of bytes in the segment.
+};
+
+/**
+ * A table of profile ids that a TLVWriter and a TLVReader can share in order to encode
+ * profile-specific tags compactly.
+ *
+ * Without a dictionary, only the tags of a single profile, the ImplicitProfileId, can be encoded in
+ * implicit form; the tags of every other profile carry their 4-byte profile id.  When a writer is
+ * given a dictionary, it encodes any tag whose profile is listed in the dictionary, and whose tag
+ * number is no greater than #kMaxTagNum, in the 4-byte implicit form, with the position of the
+ * profile within the dictionary in the top 8 bits of the tag field.  Such a tag occupies 5 bytes,
+ * including the control byte, rather than the 7 or 9 bytes of a fully-qualified tag.  Tags of the
+ * ImplicitProfileId profile with tag numbers below 65536 continue to use the 2-byte implicit form.
+ *
+ * A reader given the same dictionary expands these tags back to fully-qualified tags, so that they
+ * are indistinguishable to the application from tags encoded in any other form.
+ *
+ * @note Using a dictionary changes the meaning of 4-byte implicit tags, so an encoding written with a
+ * dictionary can only be read with the same dictionary.  The dictionary must be agreed between the
+ * parties by some other means, such as the setup of the session or exchange that carries the
+ * encodings, and must not change while encodings that use it remain to be read.
+ */
+struct TLVProfileDictionary
+{
+    enum
+    {
+        kMaxProfiles                    = 256,          ///< The maximum number of profiles in a dictionary.
+        kMaxTagNum                      = 0x00FFFFFF    ///< The largest tag number that can be encoded by dictionary.
+    };
+
+    const uint32_t *ProfileIds;     ///< The profile ids, in the order in which they are referenced.
+    uint16_t NumProfiles;           ///< The number of profile ids; no more than #kMaxProfiles.
+};
+
 /**
  * Provides a memory efficient parser for data encoded in Weave TLV format.
  *
@@ -96,6 +141,8 @@ class NL_DLL_EXPORT TLVReader
 {
 friend class TLVWriter;
 friend class TLVUpdater;
+friend class TLVIndex;
+friend class TLVPushParser;
 
 public:
     // *** See WeaveTLVReader.cpp file for API documentation ***
@@ -129,6 +176,8 @@ public:
     WEAVE_ERROR GetString(char *buf, uint32_t bufSize);
     WEAVE_ERROR DupString(char *& buf);
     WEAVE_ERROR GetDataPtr(const uint8_t *& data);
+    WEAVE_ERROR GetDataSegments(TLVDataSegment *segments, uint32_t maxSegments, uint32_t& numSegments);
+    WEAVE_ERROR GetNextDataSegment(TLVDataSegment& segment);
 
     WEAVE_ERROR EnterContainer(TLVType& outerContainerType);
     WEAVE_ERROR ExitContainer(TLVType outerContainerType);
@@ -146,6 +195,7 @@ public:
     WEAVE_ERROR Skip(void);
 
     uint32_t ImplicitProfileId;
+    const TLVProfileDictionary *ProfileDictionary;
     void *AppData;
 
     typedef WEAVE_ERROR (*GetNextBufferFunct)(TLVReader& reader, uintptr_t& bufHandle, const uint8_t *& bufStart,
@@ -171,11 +221,14 @@ protected:
     void SetContainerOpen(bool aContainerOpen) { mContainerOpen = aContainerOpen; }
 
     WEAVE_ERROR ReadElement(void);
+    WEAVE_ERROR ReadElementFast(void);
     void ClearElementState(void);
     WEAVE_ERROR SkipData(void);
     WEAVE_ERROR SkipToEndOfContainer(void);
     WEAVE_ERROR VerifyElement(void);
     uint64_t ReadTag(TLVTagControl tagControl, const uint8_t *& p);
+    uint64_t DecodeTag(TLVTagControl tagControl, uint64_t tagBits) const;
+    uint64_t DecodeImplicitTag32(uint32_t tagBits) const;
     WEAVE_ERROR EnsureData(WEAVE_ERROR noDataErr);
     WEAVE_ERROR ReadData(uint8_t *buf, uint32_t len);
     WEAVE_ERROR GetElementHeadLength(uint8_t& elemHeadBytes) const;
@@ -248,10 +301,12 @@ public:
     WEAVE_ERROR Put(uint64_t tag, double v);
     WEAVE_ERROR PutBoolean(uint64_t tag, bool v);
     WEAVE_ERROR PutBytes(uint64_t tag, const uint8_t *buf, uint32_t len);
+    WEAVE_ERROR PutBytes(uint64_t tag, const TLVDataSegment *segments, uint32_t numSegments);
     WEAVE_ERROR StartPutBytes(uint64_t tag, uint32_t totalLen);
     WEAVE_ERROR ContinuePutBytes(const uint8_t *buf, uint32_t len);
     WEAVE_ERROR PutString(uint64_t tag, const char *buf);
     WEAVE_ERROR PutString(uint64_t tag, const char *buf, uint32_t len);
+    WEAVE_ERROR PutString(uint64_t tag, const TLVDataSegment *segments, uint32_t numSegments);
     WEAVE_ERROR PutStringF(uint64_t tag, const char *fmt, ...);
     WEAVE_ERROR VPutStringF(uint64_t tag, const char *fmt, va_list ap);
     WEAVE_ERROR PutNull(uint64_t tag);
@@ -262,6 +317,8 @@ public:
     WEAVE_ERROR EndContainer(TLVType outerContainerType);
     WEAVE_ERROR OpenContainer(uint64_t tag, TLVType containerType, TLVWriter& containerWriter);
     WEAVE_ERROR CloseContainer(TLVWriter& containerWriter);
+    WEAVE_ERROR OpenScratch(TLVWriter& scratchWriter, uint8_t *scratchBuf, uint32_t scratchLen);
+    WEAVE_ERROR CommitScratch(TLVWriter& scratchWriter);
     WEAVE_ERROR PutPreEncodedContainer(uint64_t tag, TLVType containerType, const uint8_t *data, uint32_t dataLen);
     WEAVE_ERROR CopyContainer(TLVReader& container);
     WEAVE_ERROR CopyContainer(uint64_t tag, TLVReader& container);
@@ -271,6 +328,7 @@ public:
     uint32_t GetLengthWritten(void);
 
     uint32_t ImplicitProfileId;
+    const TLVProfileDictionary *ProfileDictionary;
     void *AppData;
 
     typedef WEAVE_ERROR (*GetNewBufferFunct)(TLVWriter& writer, uintptr_t& bufHandle, uint8_t *& bufStart,
@@ -335,10 +393,38 @@ protected:
     static void WeaveTLVWriterPutcharCB(uint8_t c, void *appState);
 #endif
     WEAVE_ERROR WriteElementHead(TLVElementType elemType, uint64_t tag, uint64_t lenOrVal);
+    int FindDictionaryProfile(uint32_t profileId) const;
     WEAVE_ERROR WriteElementWithData(TLVType type, uint64_t tag, const uint8_t *data, uint32_t dataLen);
+    WEAVE_ERROR WriteElementWithData(TLVType type, uint64_t tag, const TLVDataSegment *segments, uint32_t numSegments);
     WEAVE_ERROR WriteData(const uint8_t *p, uint32_t len);
 };
 
+/**
+ * A TLVWriter that measures an encoding without storing it.
+ *
+ * TLVSizer accepts the same calls as TLVWriter, including OpenContainer() and the other container
+ * methods, but discards the encoded bytes as they are produced.  After writing, GetLengthWritten()
+ * returns the exact number of bytes the same calls would have produced on a TLVWriter with the
+ * same ImplicitProfileId and ProfileDictionary, making it possible to size an element before committing to write it.
+ *
+ * Container writers opened on a TLVSizer share its discard buffer, so they must not outlive it.
+ */
+class NL_DLL_EXPORT TLVSizer : public TLVWriter
+{
+public:
+    void Init(uint32_t maxLen = 0xFFFFFFFFUL);
+
+private:
+    enum
+    {
+        kDiscardBufSize = 32
+    };
+
+    static WEAVE_ERROR GetDiscardBuffer(TLVWriter& writer, uintptr_t& bufHandle, uint8_t *& bufStart, uint32_t& bufLen);
+
+    uint8_t mDiscardBuf[kDiscardBufSize];
+};
+
 #if WEAVE_CONFIG_PROVIDE_OBSOLESCENT_INTERFACES
 inline WEAVE_ERROR TLVWriter::GetNewInetBuffer(TLVWriter& writer, uintptr_t& bufHandle, uint8_t *& bufStart, uint32_t& bufLen)
 {
@@ -351,6 +437,28 @@ inline WEAVE_ERROR TLVWriter::FinalizeInetBuffer(TLVWriter& writer, uintptr_t bu
 }
 #endif // WEAVE_CONFIG_PROVIDE_OBSOLESCENT_INTERFACES
 
+/**
+ * Describes a single edit to be applied by TLVUpdater::ApplyEdits().
+ *
+ * The element to be edited is identified by the sequence of tags leading to it from the container
+ * in which the edits are applied.  A replacement value is supplied as the TLV encoding of a single
+ * element; the tag of that element is ignored and the last tag of the path is used instead.
+ */
+struct TLVEdit
+{
+    enum
+    {
+        kOp_Replace                 = 0,    ///< Replace the element, or add it if not present.
+        kOp_Delete                  = 1     ///< Remove the element, if present.
+    };
+
+    const uint64_t *Path;           ///< The tags leading to the element.
+    uint8_t PathLen;                ///< The number of tags in Path.
+    uint8_t Op;                     ///< The operation to be performed.
+    const uint8_t *Value;           ///< For #kOp_Replace, the encoding of the new value.
+    uint32_t ValueLen;              ///< For #kOp_Replace, the length of the encoding at Value.
+};
+
 /**
  * Provides a unified Reader/Writer interface for editing/adding/deleting elements in TLV encoding.
  *
@@ -395,11 +503,14 @@ public:
     // Common methods
     void SetImplicitProfileId(uint32_t profileId);
     uint32_t GetImplicitProfileId(void) { return mUpdaterReader.ImplicitProfileId; }
+    void SetProfileDictionary(const TLVProfileDictionary *dict);
+    const TLVProfileDictionary *GetProfileDictionary(void) { return mUpdaterReader.ProfileDictionary; }
     WEAVE_ERROR Move(void);
     void MoveUntilEnd(void);
     WEAVE_ERROR EnterContainer(TLVType& outerContainerType);
     WEAVE_ERROR ExitContainer(TLVType outerContainerType);
     void GetReader(TLVReader& containerReader) { containerReader = mUpdaterReader; }
+    WEAVE_ERROR ApplyEdits(const TLVEdit *edits, size_t numEdits);
 
     // Reader methods
     WEAVE_ERROR Next(void);
@@ -451,8 +562,10 @@ public:
     WEAVE_ERROR PutBoolean(uint64_t tag, bool v) { return mUpdaterWriter.PutBoolean(tag, v); }
     WEAVE_ERROR PutNull(uint64_t tag) { return mUpdaterWriter.PutNull(tag); }
     WEAVE_ERROR PutBytes(uint64_t tag, const uint8_t *buf, uint32_t len) { return mUpdaterWriter.PutBytes(tag, buf, len); }
+    WEAVE_ERROR PutBytes(uint64_t tag, const TLVDataSegment *segments, uint32_t numSegments) { return mUpdaterWriter.PutBytes(tag, segments, numSegments); }
     WEAVE_ERROR PutString(uint64_t tag, const char *buf) { return mUpdaterWriter.PutString(tag, buf); }
     WEAVE_ERROR PutString(uint64_t tag, const char *buf, uint32_t len) { return mUpdaterWriter.PutString(tag, buf, len); }
+    WEAVE_ERROR PutString(uint64_t tag, const TLVDataSegment *segments, uint32_t numSegments) { return mUpdaterWriter.PutString(tag, segments, numSegments); }
     WEAVE_ERROR CopyElement(TLVReader& reader) { return mUpdaterWriter.CopyElement(reader); }
     WEAVE_ERROR CopyElement(uint64_t tag, TLVReader& reader) { return mUpdaterWriter.CopyElement(tag, reader); }
     WEAVE_ERROR StartContainer(uint64_t tag, TLVType containerType, TLVType& outerContainerType) { return mUpdaterWriter.StartContainer(tag, containerType, outerContainerType); }
@@ -460,8 +573,15 @@ public:
     uint32_t GetLengthWritten(void) { return mUpdaterWriter.GetLengthWritten(); }
     uint32_t GetRemainingFreeLength(void) { return mUpdaterWriter.mRemainingLen; }
 
+    enum
+    {
+        kMaxEdits                   = 32    ///< The maximum number of edits accepted by ApplyEdits().
+    };
+
 private:
     void AdjustInternalWriterFreeSpace(void);
+    WEAVE_ERROR ApplyEditsInContainer(const TLVEdit *edits, uint32_t active, uint8_t depth, uint32_t& pending);
+    WEAVE_ERROR PutEditValue(const TLVEdit& edit);
 
 private:
     TLVWriter       mUpdaterWriter;
@@ -0,0 +1,437 @@
+/*
+ *
+ *    Copyright (c) 2019 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements a structural index over a contiguous Weave
+ *      TLV (Tag-Length-Value) encoding.
+ *
+ */
+
+#include <Weave/Core/WeaveCore.h>
+#include <Weave/Core/WeaveTLV.h>
+#include <Weave/Core/WeaveTLVIndex.h>
+#include <Weave/Support/CodeUtils.h>
+
+namespace nl {
+namespace Weave {
+namespace TLV {
+
+/**
+ * Initialize a TLVIndex object with the storage for its entries.
+ *
+ * @param[in]   aEntries        A pointer to an array of @p aMaxEntries entries that
+ *                              will receive one entry per element of the encoding.
+ * @param[in]   aLookup         A pointer to an array of @p aMaxEntries values used to
+ *                              order the entries for tag lookups, or NULL if lookups
+ *                              should walk the index instead.
+ * @param[in]   aMaxEntries     The number of elements in @p aEntries (and @p aLookup).
+ *
+ */
+void TLVIndex::Init(Entry *aEntries, uint16_t *aLookup, uint16_t aMaxEntries)
+{
+    mData = NULL;
+    mDataLen = 0;
+    mEntries = aEntries;
+    mLookup = aLookup;
+    mMaxEntries = (aMaxEntries > kMaxEntries) ? static_cast<uint16_t>(kMaxEntries) : aMaxEntries;
+    mCount = 0;
+
+    ImplicitProfileId = kProfileIdNotSpecified;
+    ProfileDictionary = NULL;
+}
+
+/**
+ * Index a contiguous TLV encoding.
+ *
+ * Build() parses the encoding once, from start to end, recording an entry for every element,
+ * including those nested within containers.  Any implicitly-tagged elements are resolved using
+ * the values of the index's ImplicitProfileId and ProfileDictionary members.
+ *
+ * @param[in]   aData           A pointer to the TLV encoding to be indexed.  The encoding is
+ *                              referenced, not copied, by the index.
+ * @param[in]   aDataLen        The length of the TLV encoding.
+ *
+ * @retval #WEAVE_NO_ERROR                  If the encoding was indexed successfully.
+ * @retval #WEAVE_ERROR_INCORRECT_STATE     If the index was not initialized with storage.
+ * @retval #WEAVE_ERROR_INVALID_ARGUMENT    If @p aData is NULL.
+ * @retval #WEAVE_ERROR_BUFFER_TOO_SMALL    If the encoding contains more elements than the
+ *                                          index can hold.
+ * @retval #WEAVE_ERROR_INVALID_TLV_ELEMENT If the encoding is nested too deeply to be indexed.
+ * @retval other                            Other Weave or platform error codes returned by
+ *                                          TLVReader while parsing the encoding.
+ *
+ */
+WEAVE_ERROR TLVIndex::Build(const uint8_t *aData, uint32_t aDataLen)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    TLVReader reader;
+    TLVType outerContainerType;
+    uint16_t container = kNoEntry;
+    uint8_t depth = 0;
+
+    mCount = 0;
+
+    VerifyOrExit(mEntries != NULL, err = WEAVE_ERROR_INCORRECT_STATE);
+    VerifyOrExit(aData != NULL, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    mData = aData;
+    mDataLen = aDataLen;
+
+    reader.Init(aData, aDataLen);
+    reader.ImplicitProfileId = ImplicitProfileId;
+    reader.ProfileDictionary = ProfileDictionary;
+
+    while (true)
+    {
+        // Between elements the reader sits on the control byte of the next element.
+        const uint32_t offset = reader.GetLengthRead();
+
+        err = reader.Next();
+
+        if (err == WEAVE_END_OF_TLV)
+        {
+            if (container == kNoEntry)
+                break;
+
+            mEntries[container].End = mCount;
+
+            container = mEntries[container].Parent;
+            depth--;
+
+            outerContainerType = (container == kNoEntry) ? kTLVType_NotSpecified : static_cast<TLVType>(mEntries[container].Type);
+            // The reader also reports the end of the data as the end of the container, so an
+            // encoding that stops inside a container only shows up here.
+            err = reader.ExitContainer(outerContainerType);
+            VerifyOrExit(err != WEAVE_END_OF_TLV, err = WEAVE_ERROR_TLV_UNDERRUN);
+            SuccessOrExit(err);
+
+            continue;
+        }
+        SuccessOrExit(err);
+
+        VerifyOrExit(mCount < mMaxEntries, err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+        {
+            Entry & entry = mEntries[mCount];
+
+            entry.Tag = reader.GetTag();
+            entry.Offset = offset;
+            entry.Parent = container;
+            entry.End = mCount + 1;
+            entry.Type = static_cast<uint8_t>(reader.GetType());
+            entry.Depth = depth;
+        }
+
+        mCount++;
+
+        if (TLVTypeIsContainer(reader.GetType()))
+        {
+            VerifyOrExit(depth < 0xFF, err = WEAVE_ERROR_INVALID_TLV_ELEMENT);
+
+            err = reader.EnterContainer(outerContainerType);
+            SuccessOrExit(err);
+
+            container = mCount - 1;
+            depth++;
+        }
+        else
+        {
+            // Consume any string data so the next offset lands on the next control byte.
+            err = reader.Skip();
+            SuccessOrExit(err);
+        }
+    }
+
+    err = WEAVE_NO_ERROR;
+
+    if (mLookup != NULL)
+        SortLookup();
+
+exit:
+    if (err != WEAVE_NO_ERROR)
+        mCount = 0;
+
+    return err;
+}
+
+/**
+ * Position a TLVReader on an indexed element.
+ *
+ * The reader is initialized directly at the element's location within the encoding, in the
+ * context of the element's enclosing container.  Calling Next() on the returned reader visits the
+ * remaining elements of that container and returns #WEAVE_END_OF_TLV at its end.  Note that the
+ * reader's GetLengthRead() is relative to the element, not to the start of the encoding.
+ *
+ * @param[in]   aIndex          The index of the element, in encoding order.
+ * @param[out]  aReader         A reference to the TLVReader to position on the element.
+ *
+ * @retval #WEAVE_NO_ERROR                  If the reader was positioned on the element.
+ * @retval #WEAVE_ERROR_INVALID_ARGUMENT    If @p aIndex is not the index of an element.
+ * @retval other                            Other Weave or platform error codes returned by
+ *                                          TLVReader while reading the element.
+ *
+ */
+WEAVE_ERROR TLVIndex::GetReader(uint16_t aIndex, TLVReader &aReader) const
+{
+    WEAVE_ERROR err;
+
+    VerifyOrExit(aIndex < mCount, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    {
+        const Entry & entry = mEntries[aIndex];
+
+        aReader.Init(mData + entry.Offset, mDataLen - entry.Offset);
+        aReader.ImplicitProfileId = ImplicitProfileId;
+        aReader.ProfileDictionary = ProfileDictionary;
+        aReader.mContainerType = (entry.Parent == kNoEntry) ? kTLVType_NotSpecified : static_cast<TLVType>(mEntries[entry.Parent].Type);
+    }
+
+    err = aReader.Next();
+
+exit:
+    return err;
+}
+
+/**
+ * Find the first element with the specified tag within a container.
+ *
+ * When the index has a lookup array, this is a binary search over the index; otherwise the
+ * immediate children of the container are examined in encoding order.
+ *
+ * @param[in]   aContainer      The index of the container to search, or #kNoEntry to search the
+ *                              top-level elements of the encoding.
+ * @param[in]   aTag            The tag of the element to find.
+ * @param[out]  aIndex          The index of the element, on success.
+ *
+ * @retval #WEAVE_NO_ERROR                  If the element was found.
+ * @retval #WEAVE_ERROR_INVALID_ARGUMENT    If @p aContainer is not a valid index.
+ * @retval #WEAVE_ERROR_TLV_TAG_NOT_FOUND   If the container holds no element with the tag.
+ *
+ */
+WEAVE_ERROR TLVIndex::FindChild(uint16_t aContainer, uint64_t aTag, uint16_t &aIndex) const
+{
+    WEAVE_ERROR err = WEAVE_ERROR_TLV_TAG_NOT_FOUND;
+
+    VerifyOrExit(aContainer == kNoEntry || aContainer < mCount, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    if (mLookup != NULL)
+    {
+        const uint16_t pos = LowerBound(aContainer, aTag);
+
+        if (pos < mCount && Compare(mLookup[pos], aContainer, aTag) == 0)
+        {
+            aIndex = mLookup[pos];
+            err = WEAVE_NO_ERROR;
+        }
+    }
+    else
+    {
+        uint16_t i = (aContainer == kNoEntry) ? 0 : aContainer + 1;
+        const uint16_t end = (aContainer == kNoEntry) ? mCount : mEntries[aContainer].End;
+
+        for (; i < end; i = mEntries[i].End)
+        {
+            if (mEntries[i].Tag == aTag)
+            {
+                aIndex = i;
+                err = WEAVE_NO_ERROR;
+                break;
+            }
+        }
+    }
+
+exit:
+    return err;
+}
+
+/**
+ * Find an element by the path of tags leading to it from the top level of the encoding.
+ *
+ * @param[in]   aTagPath        An array of tags, the first naming a top-level element and each
+ *                              subsequent tag naming an element within the previous one.
+ * @param[in]   aPathLen        The number of tags in @p aTagPath.
+ * @param[out]  aIndex          The index of the element named by the last tag, on success.
+ *
+ * @retval #WEAVE_NO_ERROR                  If the element was found.
+ * @retval #WEAVE_ERROR_INVALID_ARGUMENT    If the path is empty.
+ * @retval #WEAVE_ERROR_TLV_TAG_NOT_FOUND   If any element along the path was not found.
+ *
+ */
+WEAVE_ERROR TLVIndex::FindPath(const uint64_t *aTagPath, size_t aPathLen, uint16_t &aIndex) const
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    uint16_t container = kNoEntry;
+
+    VerifyOrExit(aTagPath != NULL && aPathLen > 0, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    for (size_t i = 0; i < aPathLen; i++)
+    {
+        err = FindChild(container, aTagPath[i], container);
+        SuccessOrExit(err);
+    }
+
+    aIndex = container;
+
+exit:
+    return err;
+}
+
+/**
+ * Get the element at the specified position within a container.
+ *
+ * For arrays indexed with a lookup array the position is resolved with a binary search; for other
+ * containers the immediate children are counted in encoding order.
+ *
+ * @param[in]   aContainer      The index of the container, or #kNoEntry for the top-level elements
+ *                              of the encoding.
+ * @param[in]   aPosition       The zero-based position of the element within the container.
+ * @param[out]  aIndex          The index of the element, on success.
+ *
+ * @retval #WEAVE_NO_ERROR                  If the element was found.
+ * @retval #WEAVE_ERROR_INVALID_ARGUMENT    If @p aContainer is not a valid index.
+ * @retval #WEAVE_END_OF_TLV                If the container holds @p aPosition or fewer elements.
+ *
+ */
+WEAVE_ERROR TLVIndex::GetChild(uint16_t aContainer, uint16_t aPosition, uint16_t &aIndex) const
+{
+    WEAVE_ERROR err = WEAVE_END_OF_TLV;
+
+    VerifyOrExit(aContainer == kNoEntry || aContainer < mCount, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    if (mLookup != NULL && aContainer != kNoEntry && mEntries[aContainer].Type == kTLVType_Array)
+    {
+        // Array members are all anonymous, so they form a single run of the lookup array, in encoding order.
+        const uint32_t pos = static_cast<uint32_t>(LowerBound(aContainer, AnonymousTag)) + aPosition;
+
+        if (pos < mCount && Compare(mLookup[pos], aContainer, AnonymousTag) == 0)
+        {
+            aIndex = mLookup[pos];
+            err = WEAVE_NO_ERROR;
+        }
+    }
+    else
+    {
+        uint16_t i = (aContainer == kNoEntry) ? 0 : aContainer + 1;
+        const uint16_t end = (aContainer == kNoEntry) ? mCount : mEntries[aContainer].End;
+
+        for (; i < end; i = mEntries[i].End)
+        {
+            if (aPosition-- == 0)
+            {
+                aIndex = i;
+                err = WEAVE_NO_ERROR;
+                break;
+            }
+        }
+    }
+
+exit:
+    return err;
+}
+
+/**
+ * Order two entries by (container, tag, position in the encoding).
+ */
+bool TLVIndex::IsOrderedBefore(uint16_t aLeft, uint16_t aRight) const
+{
+    const int result = Compare(aLeft, mEntries[aRight].Parent, mEntries[aRight].Tag);
+
+    return (result < 0) || (result == 0 && aLeft < aRight);
+}
+
+/**
+ * Compare the (container, tag) key of an entry with the specified key.
+ */
+int TLVIndex::Compare(uint16_t aIndex, uint16_t aContainer, uint64_t aTag) const
+{
+    const Entry & entry = mEntries[aIndex];
+
+    if (entry.Parent != aContainer)
+        return (entry.Parent < aContainer) ? -1 : 1;
+    if (entry.Tag != aTag)
+        return (entry.Tag < aTag) ? -1 : 1;
+    return 0;
+}
+
+/**
+ * Return the position of the first lookup entry whose key is not less than (container, tag).
+ */
+uint16_t TLVIndex::LowerBound(uint16_t aContainer, uint64_t aTag) const
+{
+    uint16_t low = 0;
+    uint16_t high = mCount;
+
+    while (low < high)
+    {
+        const uint16_t mid = low + (high - low) / 2;
+
+        if (Compare(mLookup[mid], aContainer, aTag) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
+void TLVIndex::SiftDown(uint16_t aRoot, uint16_t aCount)
+{
+    uint32_t root = aRoot;
+    uint32_t child;
+
+    while ((child = 2 * root + 1) < aCount)
+    {
+        if (child + 1 < aCount && IsOrderedBefore(mLookup[child], mLookup[child + 1]))
+            child++;
+
+        if (!IsOrderedBefore(mLookup[root], mLookup[child]))
+            break;
+
+        const uint16_t tmp = mLookup[root];
+        mLookup[root] = mLookup[child];
+        mLookup[child] = tmp;
+
+        root = child;
+    }
+}
+
+/**
+ * Order the lookup array by (container, tag, position), in place and without allocation.
+ */
+void TLVIndex::SortLookup(void)
+{
+    for (uint16_t i = 0; i < mCount; i++)
+        mLookup[i] = i;
+
+    for (uint16_t i = mCount / 2; i > 0; i--)
+        SiftDown(i - 1, mCount);
+
+    for (uint16_t end = mCount; end > 1; end--)
+    {
+        const uint16_t tmp = mLookup[0];
+        mLookup[0] = mLookup[end - 1];
+        mLookup[end - 1] = tmp;
+
+        SiftDown(0, end - 1);
+    }
+}
+
+} // namespace TLV
+} // namespace Weave
+} // namespace nl
@@ -0,0 +1,119 @@
+/*
+ *
+ *    Copyright (c) 2019 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *  @file
+ *      This file defines a structural index over a contiguous Weave
+ *      TLV encoding.  The index is built in a single pass and records
+ *      the location of every element, allowing applications to
+ *      position a TLVReader on any element, or to look elements up by
+ *      tag path, without re-parsing the encoding.
+ */
+
+#ifndef WEAVE_TLV_INDEX_H_
+#define WEAVE_TLV_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Weave/Support/NLDLLUtil.h>
+#include <Weave/Core/WeaveError.h>
+#include "WeaveTLVTags.h"
+#include "WeaveTLVTypes.h"
+#include "WeaveTLV.h"
+
+namespace nl {
+namespace Weave {
+namespace TLV {
+
+/**
+ * @class TLVIndex
+ *
+ * @brief
+ *    TLVIndex records the offset, tag, type and nesting of every element
+ *    in a contiguous TLV encoding.
+ *
+ *    Entries are stored in encoding order in a caller-supplied array, so the
+ *    Nth element of the encoding can be reached in constant time.  When the
+ *    caller also supplies a lookup array, the index additionally keeps the
+ *    entries ordered by (container, tag), and child and tag path lookups
+ *    become binary searches.  Without the lookup array, lookups fall back to
+ *    walking the siblings recorded in the index, which is still done without
+ *    touching the encoding itself.
+ *
+ *    The index refers to, but does not copy, the encoded data; the data must
+ *    remain unchanged for as long as the index is in use.
+ */
+class NL_DLL_EXPORT TLVIndex
+{
+public:
+    enum
+    {
+        kNoEntry = 0xFFFF,      ///< Index of the (implicit) container holding the top-level elements.
+        kMaxEntries = 0xFFFE    ///< Largest number of entries an index can hold.
+    };
+
+    /**
+     * A single element of the indexed encoding.
+     */
+    struct Entry
+    {
+        uint64_t Tag;           ///< The fully-qualified tag of the element.
+        uint32_t Offset;        ///< The offset of the element's control byte from the start of the encoding.
+        uint16_t Parent;        ///< The index of the enclosing container, or #kNoEntry for top-level elements.
+        uint16_t End;           ///< One past the index of the last entry contained in the element.
+        uint8_t Type;           ///< The TLVType of the element.
+        uint8_t Depth;          ///< The number of containers enclosing the element.
+    };
+
+    void Init(Entry *aEntries, uint16_t *aLookup, uint16_t aMaxEntries);
+
+    WEAVE_ERROR Build(const uint8_t *aData, uint32_t aDataLen);
+
+    uint16_t GetCount(void) const { return mCount; }
+    const Entry & GetEntry(uint16_t aIndex) const { return mEntries[aIndex]; }
+
+    WEAVE_ERROR GetReader(uint16_t aIndex, TLVReader &aReader) const;
+
+    WEAVE_ERROR FindChild(uint16_t aContainer, uint64_t aTag, uint16_t &aIndex) const;
+    WEAVE_ERROR FindPath(const uint64_t *aTagPath, size_t aPathLen, uint16_t &aIndex) const;
+    WEAVE_ERROR GetChild(uint16_t aContainer, uint16_t aPosition, uint16_t &aIndex) const;
+
+    uint32_t ImplicitProfileId;
+    const TLVProfileDictionary *ProfileDictionary;
+
+private:
+    bool IsOrderedBefore(uint16_t aLeft, uint16_t aRight) const;
+    int Compare(uint16_t aIndex, uint16_t aContainer, uint64_t aTag) const;
+    void SiftDown(uint16_t aRoot, uint16_t aCount);
+    void SortLookup(void);
+    uint16_t LowerBound(uint16_t aContainer, uint64_t aTag) const;
+
+    const uint8_t *mData;
+    uint32_t mDataLen;
+    Entry *mEntries;
+    uint16_t *mLookup;
+    uint16_t mMaxEntries;
+    uint16_t mCount;
+};
+
+} // namespace TLV
+} // namespace Weave
+} // namespace nl
+
+#endif /* WEAVE_TLV_INDEX_H_ */
@@ -0,0 +1,1107 @@
+/*
+ *
+ *    Copyright (c) 2019 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements streaming converters between Weave TLV
+ *      (Tag-Length-Value) encodings and their JSON representation.
+ *
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Weave/Core/WeaveCore.h>
+#include <Weave/Core/WeaveTLV.h>
+#include <Weave/Core/WeaveTLVJson.h>
+#include <Weave/Support/Base64.h>
+#include <Weave/Support/CodeUtils.h>
+
+namespace nl {
+namespace Weave {
+namespace TLV {
+
+enum
+{
+    kJsonType_Int                   = 0,
+    kJsonType_UInt                  = 1,
+    kJsonType_Bool                  = 2,
+    kJsonType_Float                 = 3,
+    kJsonType_Double                = 4,
+    kJsonType_Null                  = 5,
+    kJsonType_String                = 6,
+    kJsonType_Bytes                 = 7,
+    kJsonType_Struct                = 8,
+    kJsonType_Array                 = 9,
+    kJsonType_Path                  = 10,
+
+    kJsonType_Count                 = 11
+};
+
+// Names of the JSON types, indexed by kJsonType_* value.
+static const char *const sJsonTypeNames[kJsonType_Count] =
+{
+    "INT", "UINT", "BOOL", "FLOAT", "DOUBLE", "NULL", "STRING", "BYTES", "STRUCT", "ARRAY", "PATH"
+};
+
+// Number of bytes base-64 encoded at a time; a multiple of 3.
+static const uint32_t kBase64ChunkSize = 192;
+
+static const char sHexDigits[] = "0123456789ABCDEF";
+
+static bool ParseNumber(const char *p, const char *end, uint32_t base, uint64_t max, uint64_t& v)
+{
+    v = 0;
+
+    if (p == end)
+        return false;
+
+    for (; p < end; p++)
+    {
+        uint32_t digit;
+
+        if (*p >= '0' && *p <= '9')
+            digit = *p - '0';
+        else if (base == 16 && *p >= 'a' && *p <= 'f')
+            digit = *p - 'a' + 10;
+        else if (base == 16 && *p >= 'A' && *p <= 'F')
+            digit = *p - 'A' + 10;
+        else
+            return false;
+
+        if (v > (max - digit) / base)
+            return false;
+
+        v = v * base + digit;
+    }
+
+    return true;
+}
+
+/**
+ * Initialize a TLVJsonEncoder object.
+ *
+ * @param[in]   buf             A pointer to a buffer that will accumulate JSON output.
+ * @param[in]   bufSize         The size of the buffer.
+ * @param[in]   flushFunct      The function to which the buffered output is passed whenever the
+ *                              buffer fills, or NULL if all output must fit in the buffer.
+ *
+ */
+void TLVJsonEncoder::Init(char *buf, uint32_t bufSize, FlushFunct flushFunct)
+{
+    mBuf = buf;
+    mBufSize = bufSize;
+    mBufLen = 0;
+    mFlushFunct = flushFunct;
+
+    GetProfileName = NULL;
+    AppData = NULL;
+}
+
+/**
+ * Convert a TLV element to JSON.
+ *
+ * Encode() writes the element on which the reader is positioned, including all members of a
+ * container, as a single-member JSON object followed by a newline.  On return, the reader is
+ * positioned such that Next() advances to the element that follows.
+ *
+ * Output may remain in the encoder's buffer after Encode() returns.  Applications should call
+ * Flush() once the last element has been encoded.
+ *
+ * @param[in]   reader          A reader positioned on the element to be converted.
+ *
+ * @retval #WEAVE_NO_ERROR                  If the element was converted.
+ * @retval #WEAVE_ERROR_BUFFER_TOO_SMALL    If the output does not fit in the buffer and no flush
+ *                                          function was given, or if containers are nested more
+ *                                          than #kMaxDepth deep.
+ * @retval #WEAVE_ERROR_INVALID_TLV_ELEMENT If the reader is not positioned on an element.
+ * @retval other                            Other Weave or platform error codes returned by the
+ *                                          reader or the flush function.
+ *
+ */
+WEAVE_ERROR TLVJsonEncoder::Encode(TLVReader& reader)
+{
+    WEAVE_ERROR err;
+
+    err = WriteChar('{');
+    SuccessOrExit(err);
+
+    err = EncodeMember(reader, 0);
+    SuccessOrExit(err);
+
+    err = WriteChars("}\n", 2);
+    SuccessOrExit(err);
+
+exit:
+    return err;
+}
+
+/**
+ * Pass any buffered output to the flush function.
+ *
+ * If the encoder has no flush function, the output remains in the buffer, where it can be
+ * accessed through GetBuffer() and GetBufferedLength().
+ *
+ * @retval #WEAVE_NO_ERROR      If the output was flushed.
+ * @retval other                Any error returned by the flush function.
+ *
+ */
+WEAVE_ERROR TLVJsonEncoder::Flush(void)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    if (mFlushFunct != NULL && mBufLen > 0)
+    {
+        err = mFlushFunct(*this, mBuf, mBufLen);
+        SuccessOrExit(err);
+
+        mBufLen = 0;
+    }
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TLVJsonEncoder::EncodeMember(TLVReader& reader, uint8_t depth)
+{
+    WEAVE_ERROR err;
+    const uint64_t tag = reader.GetTag();
+    uint8_t type;
+
+    switch (reader.GetType())
+    {
+    case kTLVType_SignedInteger:    type = kJsonType_Int; break;
+    case kTLVType_UnsignedInteger:  type = kJsonType_UInt; break;
+    case kTLVType_Boolean:          type = kJsonType_Bool; break;
+    case kTLVType_Null:             type = kJsonType_Null; break;
+    case kTLVType_UTF8String:       type = kJsonType_String; break;
+    case kTLVType_ByteString:       type = kJsonType_Bytes; break;
+    case kTLVType_Structure:        type = kJsonType_Struct; break;
+    case kTLVType_Array:            type = kJsonType_Array; break;
+    case kTLVType_Path:             type = kJsonType_Path; break;
+    case kTLVType_FloatingPointNumber:
+        type = ((reader.GetControlByte() & kTLVTypeMask) == kTLVElementType_FloatingPointNumber32) ? kJsonType_Float : kJsonType_Double;
+        break;
+    default:
+        ExitNow(err = WEAVE_ERROR_INVALID_TLV_ELEMENT);
+    }
+
+    // Member name
+    err = WriteChar('"');
+    SuccessOrExit(err);
+
+    if (tag != AnonymousTag)
+    {
+        err = WriteTag(tag);
+        SuccessOrExit(err);
+
+        err = WriteChar(':');
+        SuccessOrExit(err);
+    }
+
+    err = WriteChars(sJsonTypeNames[type], strlen(sJsonTypeNames[type]));
+    SuccessOrExit(err);
+
+    err = WriteChars("\":", 2);
+    SuccessOrExit(err);
+
+    // Value
+    switch (type)
+    {
+    case kJsonType_Int:
+    {
+        int64_t v;
+
+        err = reader.Get(v);
+        SuccessOrExit(err);
+
+        if (v < 0)
+        {
+            err = WriteChar('-');
+            SuccessOrExit(err);
+        }
+
+        err = WriteUnsigned((v < 0) ? (0 - static_cast<uint64_t>(v)) : static_cast<uint64_t>(v));
+        break;
+    }
+
+    case kJsonType_UInt:
+    {
+        uint64_t v;
+
+        err = reader.Get(v);
+        SuccessOrExit(err);
+
+        err = WriteUnsigned(v);
+        break;
+    }
+
+    case kJsonType_Bool:
+    {
+        bool v;
+
+        err = reader.Get(v);
+        SuccessOrExit(err);
+
+        err = v ? WriteChars("true", 4) : WriteChars("false", 5);
+        break;
+    }
+
+    case kJsonType_Float:
+    case kJsonType_Double:
+    {
+        double v;
+
+        err = reader.Get(v);
+        SuccessOrExit(err);
+
+        err = WriteDouble(v, type == kJsonType_Float);
+        break;
+    }
+
+    case kJsonType_Null:
+        err = WriteChars("null", 4);
+        break;
+
+    case kJsonType_String:
+    case kJsonType_Bytes:
+    {
+        TLVDataSegment segment;
+        uint8_t carry[3];
+        uint32_t carryLen = 0;
+
+        err = WriteChar('"');
+        SuccessOrExit(err);
+
+        // The value is converted one input buffer at a time, however many buffers it spans.
+        while ((err = reader.GetNextDataSegment(segment)) == WEAVE_NO_ERROR)
+        {
+            const uint8_t *data = segment.Data;
+            uint32_t dataLen = segment.Len;
+
+            if (type == kJsonType_String)
+            {
+                err = WriteString(data, dataLen);
+                SuccessOrExit(err);
+                continue;
+            }
+
+            // Base-64 encode in groups of 3 bytes, carrying any partial group into the next segment.
+            while (carryLen > 0 && carryLen < 3 && dataLen > 0)
+            {
+                carry[carryLen++] = *data++;
+                dataLen--;
+            }
+
+            if (carryLen == 3)
+            {
+                err = WriteBase64(carry, 3);
+                SuccessOrExit(err);
+
+                carryLen = 0;
+            }
+
+            err = WriteBase64(data, dataLen - (dataLen % 3));
+            SuccessOrExit(err);
+
+            data += dataLen - (dataLen % 3);
+            dataLen %= 3;
+
+            memcpy(carry + carryLen, data, dataLen);
+            carryLen += dataLen;
+        }
+
+        if (err != WEAVE_END_OF_TLV)
+            SuccessOrExit(err);
+
+        err = WriteBase64(carry, carryLen);
+        SuccessOrExit(err);
+
+        err = WriteChar('"');
+        break;
+    }
+
+    default:
+        err = EncodeContainer(reader, depth + 1);
+        break;
+    }
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TLVJsonEncoder::EncodeContainer(TLVReader& reader, uint8_t depth)
+{
+    WEAVE_ERROR err;
+    const bool isStruct = (reader.GetType() == kTLVType_Structure);
+    TLVType outerContainerType;
+    bool first = true;
+
+    VerifyOrExit(depth <= kMaxDepth, err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+    err = WriteChar(isStruct ? '{' : '[');
+    SuccessOrExit(err);
+
+    err = reader.EnterContainer(outerContainerType);
+    SuccessOrExit(err);
+
+    while ((err = reader.Next()) == WEAVE_NO_ERROR)
+    {
+        if (!first)
+        {
+            err = WriteChar(',');
+            SuccessOrExit(err);
+        }
+        first = false;
+
+        // Members of arrays and paths are wrapped in objects of their own, to preserve their order.
+        if (!isStruct)
+        {
+            err = WriteChar('{');
+            SuccessOrExit(err);
+        }
+
+        err = EncodeMember(reader, depth);
+        SuccessOrExit(err);
+
+        if (!isStruct)
+        {
+            err = WriteChar('}');
+            SuccessOrExit(err);
+        }
+    }
+
+    VerifyOrExit(err == WEAVE_END_OF_TLV, /* no-op */);
+
+    err = reader.ExitContainer(outerContainerType);
+    SuccessOrExit(err);
+
+    err = WriteChar(isStruct ? '}' : ']');
+    SuccessOrExit(err);
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TLVJsonEncoder::WriteTag(uint64_t tag)
+{
+    WEAVE_ERROR err;
+
+    if (IsContextTag(tag))
+    {
+        err = WriteUnsigned(TagNumFromTag(tag));
+        SuccessOrExit(err);
+    }
+    else
+    {
+        const uint32_t profileId = ProfileIdFromTag(tag);
+        const char *profileName = (GetProfileName != NULL) ? GetProfileName(profileId) : NULL;
+
+        if (profileName != NULL)
+        {
+            err = WriteString(reinterpret_cast<const uint8_t *>(profileName), strlen(profileName));
+            SuccessOrExit(err);
+        }
+        else
+        {
+            char hex[10] = { '0', 'x' };
+
+            for (int i = 0; i < 8; i++)
+                hex[2 + i] = sHexDigits[(profileId >> (28 - i * 4)) & 0xF];
+
+            err = WriteChars(hex, sizeof(hex));
+            SuccessOrExit(err);
+        }
+
+        err = WriteChar('.');
+        SuccessOrExit(err);
+
+        err = WriteUnsigned(TagNumFromTag(tag));
+        SuccessOrExit(err);
+    }
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TLVJsonEncoder::WriteUnsigned(uint64_t v)
+{
+    char digits[20];
+    char *p = digits + sizeof(digits);
+
+    do
+    {
+        *--p = static_cast<char>('0' + (v % 10));
+        v /= 10;
+    } while (v != 0);
+
+    return WriteChars(p, digits + sizeof(digits) - p);
+}
+
+WEAVE_ERROR TLVJsonEncoder::WriteDouble(double v, bool isFloat)
+{
+    char str[32];
+    int len;
+
+    // JSON has no representation for these values, so they are written as strings.
+    if (v != v)
+        return WriteChars("\"NaN\"", 5);
+    if (v > DBL_MAX)
+        return WriteChars("\"Infinity\"", 10);
+    if (v < -DBL_MAX)
+        return WriteChars("\"-Infinity\"", 11);
+
+    // Use enough significant digits for the value to be read back exactly.
+    len = snprintf(str, sizeof(str), isFloat ? "%.9g" : "%.17g", v);
+
+    return WriteChars(str, static_cast<uint32_t>(len));
+}
+
+WEAVE_ERROR TLVJsonEncoder::WriteString(const uint8_t *data, uint32_t dataLen)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    const uint8_t *end = data + dataLen;
+
+    while (data < end)
+    {
+        const uint8_t *run = data;
+
+        // Copy runs of characters that need no escaping in one go.
+        while (data < end && *data >= 0x20 && *data != '"' && *data != '\\')
+            data++;
+
+        if (data > run)
+        {
+            err = WriteChars(reinterpret_cast<const char *>(run), data - run);
+            SuccessOrExit(err);
+        }
+
+        if (data < end)
+        {
+            char escape[6] = { '\\', 'u', '0', '0', 0, 0 };
+            uint32_t escapeLen = 2;
+
+            switch (*data)
+            {
+            case '"':   escape[1] = '"'; break;
+            case '\\':  escape[1] = '\\'; break;
+            case '\b':  escape[1] = 'b'; break;
+            case '\f':  escape[1] = 'f'; break;
+            case '\n':  escape[1] = 'n'; break;
+            case '\r':  escape[1] = 'r'; break;
+            case '\t':  escape[1] = 't'; break;
+            default:
+                escape[4] = sHexDigits[*data >> 4];
+                escape[5] = sHexDigits[*data & 0xF];
+                escapeLen = 6;
+                break;
+            }
+
+            err = WriteChars(escape, escapeLen);
+            SuccessOrExit(err);
+
+            data++;
+        }
+    }
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TLVJsonEncoder::WriteBase64(const uint8_t *data, uint32_t dataLen)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    char chunk[BASE64_ENCODED_LEN(kBase64ChunkSize)];
+
+    while (dataLen > 0)
+    {
+        const uint16_t len = (dataLen > kBase64ChunkSize) ? kBase64ChunkSize : dataLen;
+
+        err = WriteChars(chunk, Base64Encode(data, len, chunk));
+        SuccessOrExit(err);
+
+        data += len;
+        dataLen -= len;
+    }
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TLVJsonEncoder::WriteChars(const char *data, uint32_t dataLen)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    while (dataLen > 0)
+    {
+        uint32_t len;
+
+        if (mBufLen == mBufSize)
+        {
+            VerifyOrExit(mFlushFunct != NULL, err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+            err = Flush();
+            SuccessOrExit(err);
+        }
+
+        len = mBufSize - mBufLen;
+        if (len > dataLen)
+            len = dataLen;
+
+        memcpy(mBuf + mBufLen, data, len);
+
+        mBufLen += len;
+        data += len;
+        dataLen -= len;
+    }
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TLVJsonEncoder::WriteChar(char c)
+{
+    if (mBufLen < mBufSize)
+    {
+        mBuf[mBufLen++] = c;
+        return WEAVE_NO_ERROR;
+    }
+
+    return WriteChars(&c, 1);
+}
+
+/**
+ * Initialize a TLVJsonDecoder object to decode the given JSON text.
+ *
+ * @param[in]   json            A pointer to the JSON text, which is modified during decoding.
+ * @param[in]   jsonLen         The length of the JSON text.
+ *
+ */
+void TLVJsonDecoder::Init(char *json, size_t jsonLen)
+{
+    mJsonStart = json;
+    mReadPoint = json;
+    mJsonEnd = json + jsonLen;
+
+    GetProfileId = NULL;
+}
+
+/**
+ * Convert the next top-level JSON object to a TLV element.
+ *
+ * @param[in]   writer          The writer to which the TLV element is written.
+ *
+ * @retval #WEAVE_NO_ERROR                  If an element was converted.
+ * @retval #WEAVE_END_OF_TLV                If only whitespace remains in the JSON text.
+ * @retval #WEAVE_ERROR_INVALID_ARGUMENT    If the JSON text is malformed, or does not follow the
+ *                                          representation described in WeaveTLVJson.h.
+ * @retval #WEAVE_ERROR_INVALID_TLV_ELEMENT If a member name contains an unknown type.
+ * @retval #WEAVE_ERROR_INVALID_TLV_TAG     If a member name contains a malformed tag, or a profile
+ *                                          name that could not be resolved.
+ * @retval #WEAVE_ERROR_INVALID_INTEGER_VALUE
+ *                                          If an integer value is out of range for its type.
+ * @retval #WEAVE_ERROR_BUFFER_TOO_SMALL    If containers are nested more than #kMaxDepth deep.
+ * @retval other                            Other Weave or platform error codes returned by the
+ *                                          writer.
+ *
+ */
+WEAVE_ERROR TLVJsonDecoder::Decode(TLVWriter& writer)
+{
+    WEAVE_ERROR err;
+
+    SkipWhitespace();
+    VerifyOrExit(mReadPoint < mJsonEnd, err = WEAVE_END_OF_TLV);
+
+    err = Expect('{');
+    SuccessOrExit(err);
+
+    err = DecodeMember(writer, 0);
+    SuccessOrExit(err);
+
+    err = Expect('}');
+    SuccessOrExit(err);
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TLVJsonDecoder::DecodeMember(TLVWriter& writer, uint8_t depth)
+{
+    WEAVE_ERROR err;
+    uint64_t tag;
+    uint8_t type;
+
+    err = ParseMemberName(tag, type);
+    SuccessOrExit(err);
+
+    err = Expect(':');
+    SuccessOrExit(err);
+
+    switch (type)
+    {
+    case kJsonType_Int:
+    case kJsonType_UInt:
+    {
+        uint64_t magnitude;
+        bool isNegative;
+
+        err = ParseInteger(magnitude, isNegative);
+        SuccessOrExit(err);
+
+        if (type == kJsonType_UInt)
+        {
+            VerifyOrExit(!isNegative || magnitude == 0, err = WEAVE_ERROR_INVALID_INTEGER_VALUE);
+
+            err = writer.Put(tag, magnitude);
+        }
+        else
+        {
+            VerifyOrExit(magnitude <= (isNegative ? 0x8000000000000000ULL : 0x7FFFFFFFFFFFFFFFULL),
+                         err = WEAVE_ERROR_INVALID_INTEGER_VALUE);
+
+            err = writer.Put(tag, isNegative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude));
+        }
+        break;
+    }
+
+    case kJsonType_Bool:
+    {
+        const bool v = Peek('t');
+
+        err = ParseLiteral(v ? "true" : "false");
+        SuccessOrExit(err);
+
+        err = writer.PutBoolean(tag, v);
+        break;
+    }
+
+    case kJsonType_Float:
+    case kJsonType_Double:
+    {
+        double v;
+
+        err = ParseDouble(v);
+        SuccessOrExit(err);
+
+        err = (type == kJsonType_Float) ? writer.Put(tag, static_cast<float>(v)) : writer.Put(tag, v);
+        break;
+    }
+
+    case kJsonType_Null:
+        err = ParseLiteral("null");
+        SuccessOrExit(err);
+
+        err = writer.PutNull(tag);
+        break;
+
+    case kJsonType_String:
+    {
+        char *str;
+        uint32_t strLen;
+
+        err = ParseString(str, strLen);
+        SuccessOrExit(err);
+
+        err = writer.PutString(tag, str, strLen);
+        break;
+    }
+
+    case kJsonType_Bytes:
+    {
+        char *str;
+        uint32_t strLen;
+
+        err = ParseString(str, strLen);
+        SuccessOrExit(err);
+
+        // Decode in place; the decoded value is never longer than its encoding.
+        strLen = Base64Decode32(str, strLen, reinterpret_cast<uint8_t *>(str));
+        VerifyOrExit(strLen != UINT32_MAX, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+        err = writer.PutBytes(tag, reinterpret_cast<uint8_t *>(str), strLen);
+        break;
+    }
+
+    case kJsonType_Struct:
+        err = DecodeContainer(writer, tag, kTLVType_Structure, depth + 1);
+        break;
+
+    case kJsonType_Array:
+        err = DecodeContainer(writer, tag, kTLVType_Array, depth + 1);
+        break;
+
+    default:
+        err = DecodeContainer(writer, tag, kTLVType_Path, depth + 1);
+        break;
+    }
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TLVJsonDecoder::DecodeContainer(TLVWriter& writer, uint64_t tag, TLVType type, uint8_t depth)
+{
+    WEAVE_ERROR err;
+    const bool isStruct = (type == kTLVType_Structure);
+    TLVType outerContainerType;
+
+    VerifyOrExit(depth <= kMaxDepth, err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+    err = writer.StartContainer(tag, type, outerContainerType);
+    SuccessOrExit(err);
+
+    err = Expect(isStruct ? '{' : '[');
+    SuccessOrExit(err);
+
+    if (!Peek(isStruct ? '}' : ']'))
+    {
+        while (true)
+        {
+            if (!isStruct)
+            {
+                err = Expect('{');
+                SuccessOrExit(err);
+            }
+
+            err = DecodeMember(writer, depth);
+            SuccessOrExit(err);
+
+            if (!isStruct)
+            {
+                err = Expect('}');
+                SuccessOrExit(err);
+            }
+
+            if (!Peek(','))
+                break;
+
+            mReadPoint++;
+        }
+    }
+
+    err = Expect(isStruct ? '}' : ']');
+    SuccessOrExit(err);
+
+    err = writer.EndContainer(outerContainerType);
+    SuccessOrExit(err);
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TLVJsonDecoder::ParseMemberName(uint64_t& tag, uint8_t& type)
+{
+    WEAVE_ERROR err;
+    char *name;
+    uint32_t nameLen;
+    const char *typeName;
+    uint32_t typeNameLen;
+
+    err = ParseString(name, nameLen);
+    SuccessOrExit(err);
+
+    // The type follows the last colon; profile names may contain colons of their own.
+    typeName = name + nameLen;
+    while (typeName > name && typeName[-1] != ':')
+        typeName--;
+    typeNameLen = name + nameLen - typeName;
+
+    for (type = 0; type < kJsonType_Count; type++)
+        if (strlen(sJsonTypeNames[type]) == typeNameLen && memcmp(sJsonTypeNames[type], typeName, typeNameLen) == 0)
+            break;
+
+    VerifyOrExit(type < kJsonType_Count, err = WEAVE_ERROR_INVALID_TLV_ELEMENT);
+
+    if (typeName == name)
+        tag = AnonymousTag;
+    else
+        err = ParseTag(name, typeName - 1, tag);
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TLVJsonDecoder::ParseTag(const char *p, const char *end, uint64_t& tag)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    const char *dot = end;
+    uint64_t tagNum;
+    uint64_t profileId;
+
+    while (dot > p && dot[-1] != '.')
+        dot--;
+
+    if (dot == p)
+    {
+        // Context-specific tag
+        VerifyOrExit(ParseNumber(p, end, 10, UINT8_MAX, tagNum), err = WEAVE_ERROR_INVALID_TLV_TAG);
+
+        tag = ContextTag(static_cast<uint8_t>(tagNum));
+    }
+    else
+    {
+        // Profile-specific tag
+        VerifyOrExit(ParseNumber(dot, end, 10, UINT32_MAX, tagNum), err = WEAVE_ERROR_INVALID_TLV_TAG);
+
+        dot--;
+
+        if (dot - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+        {
+            VerifyOrExit(ParseNumber(p + 2, dot, 16, UINT32_MAX, profileId), err = WEAVE_ERROR_INVALID_TLV_TAG);
+        }
+        else
+        {
+            uint32_t namedProfileId;
+
+            VerifyOrExit(GetProfileId != NULL && GetProfileId(p, dot - p, namedProfileId), err = WEAVE_ERROR_INVALID_TLV_TAG);
+
+            profileId = namedProfileId;
+        }
+
+        tag = ProfileTag(static_cast<uint32_t>(profileId), static_cast<uint32_t>(tagNum));
+    }
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TLVJsonDecoder::ParseString(char *& str, uint32_t& strLen)
+{
+    WEAVE_ERROR err;
+    char *in;
+    char *out;
+
+    err = Expect('"');
+    SuccessOrExit(err);
+
+    // Unescape the string in place.  Escape sequences are never shorter than the characters they
+    // represent, so the output never overtakes the input.
+    in = out = mReadPoint;
+
+    while (true)
+    {
+        VerifyOrExit(in < mJsonEnd, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+        if (*in == '"')
+            break;
+
+        if (*in != '\\')
+        {
+            VerifyOrExit(static_cast<uint8_t>(*in) >= 0x20, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+            // Until the first escape sequence, the string is already where it belongs.
+            if (out != in)
+                *out = *in;
+            out++;
+            in++;
+            continue;
+        }
+
+        VerifyOrExit(mJsonEnd - in >= 2, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+        switch (in[1])
+        {
+        case '"':   *out++ = '"'; break;
+        case '\\':  *out++ = '\\'; break;
+        case '/':   *out++ = '/'; break;
+        case 'b':   *out++ = '\b'; break;
+        case 'f':   *out++ = '\f'; break;
+        case 'n':   *out++ = '\n'; break;
+        case 'r':   *out++ = '\r'; break;
+        case 't':   *out++ = '\t'; break;
+        case 'u':
+        {
+            uint64_t codePoint, lowSurrogate;
+
+            VerifyOrExit(mJsonEnd - in >= 6 && ParseNumber(in + 2, in + 6, 16, 0xFFFF, codePoint),
+                         err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+            // Combine surrogate pairs
+            if (codePoint >= 0xD800 && codePoint <= 0xDBFF)
+            {
+                VerifyOrExit(mJsonEnd - in >= 12 && in[6] == '\\' && in[7] == 'u' &&
+                             ParseNumber(in + 8, in + 12, 16, 0xFFFF, lowSurrogate) &&
+                             lowSurrogate >= 0xDC00 && lowSurrogate <= 0xDFFF,
+                             err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                in += 6;
+            }
+            else
+            {
+                VerifyOrExit(codePoint < 0xDC00 || codePoint > 0xDFFF, err = WEAVE_ERROR_INVALID_ARGUMENT);
+            }
+
+            // Encode as UTF-8
+            if (codePoint < 0x80)
+                *out++ = static_cast<char>(codePoint);
+            else if (codePoint < 0x800)
+            {
+                *out++ = static_cast<char>(0xC0 | (codePoint >> 6));
+                *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else if (codePoint < 0x10000)
+            {
+                *out++ = static_cast<char>(0xE0 | (codePoint >> 12));
+                *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                *out++ = static_cast<char>(0xF0 | (codePoint >> 18));
+                *out++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+
+            in += 4;
+            break;
+        }
+        default:
+            ExitNow(err = WEAVE_ERROR_INVALID_ARGUMENT);
+        }
+
+        in += 2;
+    }
+
+    VerifyOrExit(static_cast<size_t>(out - mReadPoint) <= UINT32_MAX, err = WEAVE_ERROR_INVALID_STRING_LENGTH);
+
+    str = mReadPoint;
+    strLen = static_cast<uint32_t>(out - mReadPoint);
+    mReadPoint = in + 1;
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TLVJsonDecoder::ParseInteger(uint64_t& magnitude, bool& isNegative)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    const char *start;
+
+    SkipWhitespace();
+
+    isNegative = (mReadPoint < mJsonEnd && *mReadPoint == '-');
+    if (isNegative)
+        mReadPoint++;
+
+    start = mReadPoint;
+    while (mReadPoint < mJsonEnd && *mReadPoint >= '0' && *mReadPoint <= '9')
+        mReadPoint++;
+
+    VerifyOrExit(mReadPoint > start, err = WEAVE_ERROR_INVALID_ARGUMENT);
+    VerifyOrExit(ParseNumber(start, mReadPoint, 10, UINT64_MAX, magnitude), err = WEAVE_ERROR_INVALID_INTEGER_VALUE);
+
+    // Fractions and exponents have no place in an integer.
+    VerifyOrExit(mReadPoint == mJsonEnd || (*mReadPoint != '.' && *mReadPoint != 'e' && *mReadPoint != 'E'),
+                 err = WEAVE_ERROR_INVALID_INTEGER_VALUE);
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TLVJsonDecoder::ParseDouble(double& v)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    char number[64];
+    char *numberEnd;
+    size_t len = 0;
+
+    if (Peek('"'))
+    {
+        char *str;
+        uint32_t strLen;
+
+        err = ParseString(str, strLen);
+        SuccessOrExit(err);
+
+        if (strLen == 3 && memcmp(str, "NaN", 3) == 0)
+            v = NAN;
+        else if (strLen == 8 && memcmp(str, "Infinity", 8) == 0)
+            v = HUGE_VAL;
+        else if (strLen == 9 && memcmp(str, "-Infinity", 9) == 0)
+            v = -HUGE_VAL;
+        else
+            err = WEAVE_ERROR_INVALID_ARGUMENT;
+
+        ExitNow();
+    }
+
+    // strtod() needs a terminated string, which the JSON text may not provide.
+    while (mReadPoint + len < mJsonEnd && strchr("0123456789+-.eE", mReadPoint[len]) != NULL && mReadPoint[len] != 0)
+    {
+        VerifyOrExit(len < sizeof(number) - 1, err = WEAVE_ERROR_INVALID_ARGUMENT);
+        number[len] = mReadPoint[len];
+        len++;
+    }
+    number[len] = 0;
+
+    v = strtod(number, &numberEnd);
+    VerifyOrExit(len > 0 && numberEnd == number + len, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    mReadPoint += len;
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TLVJsonDecoder::ParseLiteral(const char *literal)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    const size_t len = strlen(literal);
+
+    SkipWhitespace();
+
+    VerifyOrExit(static_cast<size_t>(mJsonEnd - mReadPoint) >= len && memcmp(mReadPoint, literal, len) == 0,
+                 err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    mReadPoint += len;
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TLVJsonDecoder::Expect(char c)
+{
+    if (!Peek(c))
+        return WEAVE_ERROR_INVALID_ARGUMENT;
+
+    mReadPoint++;
+
+    return WEAVE_NO_ERROR;
+}
+
+bool TLVJsonDecoder::Peek(char c)
+{
+    SkipWhitespace();
+
+    return mReadPoint < mJsonEnd && *mReadPoint == c;
+}
+
+void TLVJsonDecoder::SkipWhitespace(void)
+{
+    while (mReadPoint < mJsonEnd && (*mReadPoint == ' ' || *mReadPoint == '\n' || *mReadPoint == '\r' || *mReadPoint == '\t'))
+        mReadPoint++;
+}
+
+} // namespace TLV
+} // namespace Weave
+} // namespace nl
@@ -0,0 +1,193 @@
+/*
+ *
+ *    Copyright (c) 2019 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *  @file
+ *      This file defines streaming converters between Weave TLV
+ *      encodings and a lossless JSON representation of them.
+ *
+ *      Each top-level TLV element is represented by a JSON object with a
+ *      single member, and successive top-level elements are separated by
+ *      newlines, so that long sequences of elements (such as event log
+ *      archives) can be converted one element at a time.
+ *
+ *      The name of every member identifies the tag and type of the TLV
+ *      element it represents, in the form "<tag>:<type>", or simply
+ *      "<type>" for anonymous elements.  The tag is written as a decimal
+ *      number for context-specific tags, and as "<profile>.<number>" for
+ *      profile-specific tags, where the profile is either a hexadecimal
+ *      profile id (e.g. "0x0000235A.1") or, optionally, a profile name.
+ *      The type is one of INT, UINT, BOOL, FLOAT, DOUBLE, NULL, STRING,
+ *      BYTES, STRUCT, ARRAY or PATH.
+ *
+ *      Integers, booleans and nulls map to the corresponding JSON values.
+ *      Floating point values map to JSON numbers, or to the strings "NaN",
+ *      "Infinity" and "-Infinity".  UTF-8 strings map to JSON strings, and
+ *      byte strings to base-64 encoded JSON strings.  Structures map to
+ *      JSON objects, while arrays and paths, whose members are ordered, map
+ *      to JSON arrays of single-member objects.  For example:
+ *
+ *      @code
+ *      {"0x0000235A.1:STRUCT":{"1:UINT":42,"2:STRING":"abc","3:ARRAY":[{"INT":-1},{"NULL":null}]}}
+ *      @endcode
+ */
+
+#ifndef WEAVE_TLV_JSON_H_
+#define WEAVE_TLV_JSON_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Weave/Support/NLDLLUtil.h>
+#include <Weave/Core/WeaveError.h>
+#include "WeaveTLVTags.h"
+#include "WeaveTLVTypes.h"
+#include "WeaveTLV.h"
+
+namespace nl {
+namespace Weave {
+namespace TLV {
+
+/**
+ * @class TLVJsonEncoder
+ *
+ * @brief
+ *    TLVJsonEncoder converts TLV elements to JSON.
+ *
+ *    Output is accumulated in a caller-supplied buffer and handed to a flush
+ *    function whenever the buffer fills, so elements of any size can be
+ *    converted with a fixed amount of memory.  Without a flush function, the
+ *    encoder fails once the buffer is full, which allows small conversions to
+ *    be made directly into memory.
+ */
+class NL_DLL_EXPORT TLVJsonEncoder
+{
+public:
+    enum
+    {
+        kMaxDepth                       = 32    ///< The maximum nesting depth of containers.
+    };
+
+    /**
+     * A function that consumes a block of JSON output.
+     *
+     * @param[in]   encoder     The encoder producing the output.
+     * @param[in]   data        A pointer to the output.
+     * @param[in]   dataLen     The number of characters of output.
+     *
+     * @retval #WEAVE_NO_ERROR  If the output was consumed.
+     * @retval other            To stop the conversion.  The error is returned to the caller.
+     */
+    typedef WEAVE_ERROR (*FlushFunct)(TLVJsonEncoder& encoder, const char *data, uint32_t dataLen);
+
+    /**
+     * A function that returns the name of a profile, or NULL if the profile has no name.
+     */
+    typedef const char *(*ProfileNameFunct)(uint32_t profileId);
+
+    void Init(char *buf, uint32_t bufSize, FlushFunct flushFunct);
+
+    WEAVE_ERROR Encode(TLVReader& reader);
+    WEAVE_ERROR Flush(void);
+
+    const char *GetBuffer(void) const { return mBuf; }
+    uint32_t GetBufferedLength(void) const { return mBufLen; }
+
+    ProfileNameFunct GetProfileName;    ///< Names profiles within tags, or NULL to write profile ids.
+    void *AppData;                      ///< A pointer to application-specific data.
+
+private:
+    WEAVE_ERROR EncodeMember(TLVReader& reader, uint8_t depth);
+    WEAVE_ERROR EncodeContainer(TLVReader& reader, uint8_t depth);
+    WEAVE_ERROR WriteTag(uint64_t tag);
+    WEAVE_ERROR WriteUnsigned(uint64_t v);
+    WEAVE_ERROR WriteDouble(double v, bool isFloat);
+    WEAVE_ERROR WriteString(const uint8_t *data, uint32_t dataLen);
+    WEAVE_ERROR WriteBase64(const uint8_t *data, uint32_t dataLen);
+    WEAVE_ERROR WriteChars(const char *data, uint32_t dataLen);
+    WEAVE_ERROR WriteChar(char c);
+
+    char *mBuf;
+    uint32_t mBufSize;
+    uint32_t mBufLen;
+    FlushFunct mFlushFunct;
+};
+
+/**
+ * @class TLVJsonDecoder
+ *
+ * @brief
+ *    TLVJsonDecoder converts the JSON representation produced by
+ *    TLVJsonEncoder back to TLV.
+ *
+ *    The decoder works directly on the supplied JSON text, which it modifies
+ *    in place: string and byte string values are unescaped or base-64 decoded
+ *    over the text they were read from, and then written to the TLVWriter
+ *    from there.  No other memory is needed, regardless of the size of the
+ *    values.
+ */
+class NL_DLL_EXPORT TLVJsonDecoder
+{
+public:
+    enum
+    {
+        kMaxDepth                       = 32    ///< The maximum nesting depth of containers.
+    };
+
+    /**
+     * A function that maps a profile name to its profile id.
+     *
+     * @param[in]   name        A pointer to the name, which is not NUL-terminated.
+     * @param[in]   nameLen     The length of the name.
+     * @param[out]  profileId   The id of the named profile.
+     *
+     * @return @p true if the name is known; otherwise @p false.
+     */
+    typedef bool (*ProfileIdFunct)(const char *name, uint32_t nameLen, uint32_t& profileId);
+
+    void Init(char *json, size_t jsonLen);
+
+    WEAVE_ERROR Decode(TLVWriter& writer);
+
+    size_t GetLengthRead(void) const { return mReadPoint - mJsonStart; }
+
+    ProfileIdFunct GetProfileId;        ///< Resolves profile names within tags, or NULL to accept only profile ids.
+
+private:
+    WEAVE_ERROR DecodeMember(TLVWriter& writer, uint8_t depth);
+    WEAVE_ERROR DecodeContainer(TLVWriter& writer, uint64_t tag, TLVType type, uint8_t depth);
+    WEAVE_ERROR ParseMemberName(uint64_t& tag, uint8_t& type);
+    WEAVE_ERROR ParseTag(const char *p, const char *end, uint64_t& tag);
+    WEAVE_ERROR ParseString(char *& str, uint32_t& strLen);
+    WEAVE_ERROR ParseInteger(uint64_t& magnitude, bool& isNegative);
+    WEAVE_ERROR ParseDouble(double& v);
+    WEAVE_ERROR ParseLiteral(const char *literal);
+    WEAVE_ERROR Expect(char c);
+    bool Peek(char c);
+    void SkipWhitespace(void);
+
+    char *mJsonStart;
+    char *mReadPoint;
+    char *mJsonEnd;
+};
+
+} // namespace TLV
+} // namespace Weave
+} // namespace nl
+
+#endif /* WEAVE_TLV_JSON_H_ */
@@ -0,0 +1,258 @@
+/*
+ *
+ *    Copyright (c) 2019 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements a resumable, push-style parser for Weave
+ *      TLV (Tag-Length-Value) encodings.
+ *
+ */
+
+#include <Weave/Core/WeaveCore.h>
+#include <Weave/Core/WeaveTLV.h>
+#include <Weave/Core/WeaveTLVPushParser.h>
+#include <Weave/Support/CodeUtils.h>
+
+namespace nl {
+namespace Weave {
+namespace TLV {
+
+// Size in bytes of the tag field for each tag control value.
+static const uint8_t sTagSizes[] = { 0, 1, 2, 4, 2, 4, 6, 8 };
+
+/**
+ * Initialize a TLVPushParser object to parse a new TLV encoding.
+ *
+ * @param[in]   aHandler        The function to be called for each event reported by the parser.
+ *
+ */
+void TLVPushParser::Init(EventHandler aHandler)
+{
+    mHandler = aHandler;
+    mStringRemaining = 0;
+    mLenParsed = 0;
+    mState = kState_Head;
+    mHeadLen = 0;
+    mHeadNeeded = 0;
+    mDepth = 0;
+
+    ImplicitProfileId = kProfileIdNotSpecified;
+    ProfileDictionary = NULL;
+    AppData = NULL;
+}
+
+/**
+ * Parse the next chunk of the TLV encoding.
+ *
+ * Feed() consumes the whole of the supplied chunk, reporting an event to the handler for every
+ * element head, string fragment and end of container it contains.  Any element head that is split
+ * across chunks is retained by the parser and completed from the following call.  The chunk itself
+ * is not retained, and may be released or reused by the caller as soon as Feed() returns.
+ *
+ * Any implicitly-tagged elements are resolved using the values of the parser's ImplicitProfileId
+ * and ProfileDictionary members.
+ *
+ * @param[in]   aData           A pointer to the next chunk of the encoding.
+ * @param[in]   aDataLen        The length of the chunk.
+ *
+ * @retval #WEAVE_NO_ERROR                  If the chunk was parsed successfully.
+ * @retval #WEAVE_ERROR_INCORRECT_STATE     If the parser has not been initialized, or has previously
+ *                                          stopped due to an error.
+ * @retval #WEAVE_ERROR_INVALID_ARGUMENT    If @p aData is NULL and @p aDataLen is not 0.
+ * @retval #WEAVE_ERROR_INVALID_TLV_ELEMENT If the encoding contains an invalid or unsupported TLV
+ *                                          element type, or an end of container outside of a
+ *                                          container.
+ * @retval #WEAVE_ERROR_INVALID_TLV_TAG     If the encoding contains a TLV tag in an invalid context.
+ * @retval #WEAVE_ERROR_UNKNOWN_IMPLICIT_TLV_TAG
+ *                                          If the encoding contains an implicitly-tagged element
+ *                                          that cannot be resolved using ImplicitProfileId or
+ *                                          ProfileDictionary.
+ * @retval #WEAVE_ERROR_BUFFER_TOO_SMALL    If containers are nested more deeply than
+ *                                          #WEAVE_CONFIG_TLV_PUSH_PARSER_MAX_DEPTH.
+ * @retval other                            Any error returned by the event handler.
+ *
+ */
+WEAVE_ERROR TLVPushParser::Feed(const uint8_t *aData, uint32_t aDataLen)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    VerifyOrExit(mHandler != NULL && mState != kState_Error, err = WEAVE_ERROR_INCORRECT_STATE);
+    VerifyOrExit(aData != NULL || aDataLen == 0, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    while (aDataLen > 0)
+    {
+        uint32_t len;
+
+        if (mState == kState_StringData)
+        {
+            // Pass as much of the string's value as is available straight through to the handler.
+            len = (aDataLen < mStringRemaining) ? aDataLen : mStringRemaining;
+
+            err = DeliverEvent(kEvent_StringData, NULL, aData, len);
+            SuccessOrExit(err);
+
+            aData += len;
+            aDataLen -= len;
+            mLenParsed += len;
+            mStringRemaining -= len;
+
+            if (mStringRemaining == 0)
+            {
+                mState = kState_Head;
+
+                err = DeliverEvent(kEvent_StringEnd, NULL, NULL, 0);
+                SuccessOrExit(err);
+            }
+
+            continue;
+        }
+
+        // On the first byte of a new element, work out the length of its head from the control byte.
+        if (mHeadLen == 0)
+        {
+            uint8_t elemType = aData[0] & kTLVTypeMask;
+
+            VerifyOrExit(IsValidTLVType(elemType), err = WEAVE_ERROR_INVALID_TLV_ELEMENT);
+
+            mHeadNeeded = 1 + sTagSizes[aData[0] >> kTLVTagControlShift] + TLVFieldSizeToBytes(GetTLVFieldSize(elemType));
+        }
+
+        // Accumulate the head, which may arrive over several chunks.
+        len = mHeadNeeded - mHeadLen;
+        if (len > aDataLen)
+            len = aDataLen;
+
+        memcpy(mHead + mHeadLen, aData, len);
+
+        aData += len;
+        aDataLen -= len;
+        mLenParsed += len;
+        mHeadLen += len;
+
+        if (mHeadLen == mHeadNeeded)
+        {
+            err = ProcessHead();
+            SuccessOrExit(err);
+        }
+    }
+
+exit:
+    if (err != WEAVE_NO_ERROR)
+        mState = kState_Error;
+    return err;
+}
+
+/**
+ * Signal the end of the TLV encoding.
+ *
+ * Finish() verifies that the data fed to the parser ended on an element boundary, outside of any
+ * container.  It does not report any events.
+ *
+ * @retval #WEAVE_NO_ERROR                  If the encoding was complete.
+ * @retval #WEAVE_ERROR_TLV_UNDERRUN        If the encoding ended in the middle of an element, or
+ *                                          before all open containers were closed.
+ * @retval #WEAVE_ERROR_INCORRECT_STATE     If the parser has not been initialized, or has previously
+ *                                          stopped due to an error.
+ *
+ */
+WEAVE_ERROR TLVPushParser::Finish(void)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    VerifyOrExit(mHandler != NULL && mState != kState_Error, err = WEAVE_ERROR_INCORRECT_STATE);
+    VerifyOrExit(mState == kState_Head && mHeadLen == 0 && mDepth == 0, err = WEAVE_ERROR_TLV_UNDERRUN);
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TLVPushParser::ProcessHead(void)
+{
+    WEAVE_ERROR err;
+    TLVReader reader;
+    TLVType elemType;
+
+    mHeadLen = 0;
+
+    // Decode and validate the head with a reader confined to the head itself.  The reader is told
+    // which container encloses the element, so that it applies the same tag checks as it would
+    // when parsing the whole encoding, and its length limit is lifted so that string lengths are
+    // accepted even though the strings' values lie beyond the head.
+    reader.Init(mHead, mHeadNeeded);
+    reader.mMaxLen = UINT32_MAX;
+    reader.mContainerType = (mDepth > 0) ? static_cast<TLVType>(mContainerTypes[mDepth - 1]) : kTLVType_NotSpecified;
+    reader.ImplicitProfileId = ImplicitProfileId;
+    reader.ProfileDictionary = ProfileDictionary;
+    reader.AppData = AppData;
+
+    err = reader.Next();
+    if (err == WEAVE_END_OF_TLV)
+    {
+        mDepth--;
+        return DeliverEvent(kEvent_ContainerEnd, NULL, NULL, 0);
+    }
+    SuccessOrExit(err);
+
+    elemType = reader.GetType();
+
+    if (TLVTypeIsContainer(elemType))
+    {
+        VerifyOrExit(mDepth < WEAVE_CONFIG_TLV_PUSH_PARSER_MAX_DEPTH, err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+        err = DeliverEvent(kEvent_ContainerStart, &reader, NULL, 0);
+        SuccessOrExit(err);
+
+        mContainerTypes[mDepth++] = static_cast<uint8_t>(elemType);
+    }
+    else if (elemType == kTLVType_UTF8String || elemType == kTLVType_ByteString)
+    {
+        mStringRemaining = reader.GetLength();
+
+        err = DeliverEvent(kEvent_StringStart, &reader, NULL, 0);
+        SuccessOrExit(err);
+
+        if (mStringRemaining > 0)
+            mState = kState_StringData;
+        else
+            err = DeliverEvent(kEvent_StringEnd, NULL, NULL, 0);
+    }
+    else
+    {
+        err = DeliverEvent(kEvent_Element, &reader, NULL, 0);
+    }
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR TLVPushParser::DeliverEvent(EventType aType, TLVReader *aElement, const uint8_t *aData, uint32_t aDataLen)
+{
+    Event event;
+
+    event.Type = aType;
+    event.Depth = mDepth;
+    event.Element = aElement;
+    event.Data = aData;
+    event.DataLen = aDataLen;
+
+    return mHandler(*this, event);
+}
+
+} // namespace TLV
+} // namespace Weave
+} // namespace nl
@@ -0,0 +1,167 @@
+/*
+ *
+ *    Copyright (c) 2019 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *  @file
+ *      This file defines a resumable, push-style parser for Weave TLV
+ *      encodings.  The parser is fed the encoding in arbitrarily sized
+ *      chunks as it arrives and reports the elements it finds through
+ *      a callback, keeping only a small, fixed amount of state between
+ *      chunks.
+ */
+
+#ifndef WEAVE_TLV_PUSH_PARSER_H_
+#define WEAVE_TLV_PUSH_PARSER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Weave/Support/NLDLLUtil.h>
+#include <Weave/Core/WeaveConfig.h>
+#include <Weave/Core/WeaveError.h>
+#include "WeaveTLVTags.h"
+#include "WeaveTLVTypes.h"
+#include "WeaveTLV.h"
+
+namespace nl {
+namespace Weave {
+namespace TLV {
+
+/**
+ * @class TLVPushParser
+ *
+ * @brief
+ *    TLVPushParser incrementally parses a TLV encoding that is delivered in
+ *    pieces, such as the payload of a BDX transfer or a message read from a
+ *    TCP stream.
+ *
+ *    Unlike TLVReader, which pulls data from its buffers on demand, the push
+ *    parser is handed each chunk of the encoding by the application via
+ *    Feed().  Chunks may be split at any byte boundary, including within an
+ *    element's control byte, tag, length or value.  For every element the
+ *    parser invokes an application-supplied event handler:
+ *
+ *    - Scalar elements (integers, booleans, floats and nulls) are reported by
+ *      a single #kEvent_Element event.
+ *    - Containers are reported by a #kEvent_ContainerStart event, followed by
+ *      the events for their members, followed by a #kEvent_ContainerEnd event.
+ *    - UTF-8 and byte strings are reported by a #kEvent_StringStart event,
+ *      zero or more #kEvent_StringData events carrying the string's bytes as
+ *      they arrive, and a #kEvent_StringEnd event.
+ *
+ *    String data is passed to the handler in place, straight out of the fed
+ *    chunk, so the parser never buffers more than the head of a single element
+ *    (at most 17 bytes) plus one byte per open container, regardless of the
+ *    size of the encoding.  Container nesting is limited to
+ *    #WEAVE_CONFIG_TLV_PUSH_PARSER_MAX_DEPTH levels.
+ *
+ *    Once an error has been returned by the parser or the event handler, the
+ *    parser refuses further input until it is re-initialized.
+ */
+class NL_DLL_EXPORT TLVPushParser
+{
+public:
+    /**
+     * The kinds of events reported by the parser.
+     */
+    enum EventType
+    {
+        kEvent_Element                  = 0,    ///< A complete scalar element.
+        kEvent_ContainerStart           = 1,    ///< The start of a structure, array or path.
+        kEvent_ContainerEnd             = 2,    ///< The end of the most recently started container.
+        kEvent_StringStart              = 3,    ///< The start of a UTF-8 or byte string.
+        kEvent_StringData               = 4,    ///< A portion of the value of the current string.
+        kEvent_StringEnd                = 5     ///< The end of the current string.
+    };
+
+    /**
+     * An event reported by the parser.
+     */
+    struct Event
+    {
+        EventType Type;                 ///< The kind of event.
+        uint8_t Depth;                  ///< The number of containers enclosing the element.
+
+        /**
+         * For #kEvent_Element, #kEvent_ContainerStart and #kEvent_StringStart events, a reader
+         * positioned on the element, from which its type, tag, length and (for scalars) value
+         * can be read.  NULL for all other events.  The reader is only valid for the duration
+         * of the event handler call and must not be used to read string values or to enter
+         * containers.
+         */
+        TLVReader *Element;
+
+        const uint8_t *Data;            ///< For #kEvent_StringData events, the string bytes.  NULL otherwise.
+        uint32_t DataLen;               ///< For #kEvent_StringData events, the number of bytes at Data.
+    };
+
+    /**
+     * A function that handles events reported by the parser.
+     *
+     * @param[in]   parser      The parser reporting the event.
+     * @param[in]   event       The event.
+     *
+     * @retval #WEAVE_NO_ERROR  To continue parsing.
+     * @retval other            To stop parsing.  The error is returned from Feed().
+     */
+    typedef WEAVE_ERROR (*EventHandler)(TLVPushParser& parser, const Event& event);
+
+    void Init(EventHandler aHandler);
+
+    WEAVE_ERROR Feed(const uint8_t *aData, uint32_t aDataLen);
+    WEAVE_ERROR Finish(void);
+
+    uint32_t GetLengthParsed(void) const { return mLenParsed; }
+    uint8_t GetDepth(void) const { return mDepth; }
+
+    uint32_t ImplicitProfileId;
+    const TLVProfileDictionary *ProfileDictionary;
+    void *AppData;
+
+private:
+    enum
+    {
+        kMaxHeadLen                     = 17    ///< Control byte, 8-byte tag and 8-byte length or value.
+    };
+
+    enum State
+    {
+        kState_Head                     = 0,    ///< Collecting the head of the next element.
+        kState_StringData               = 1,    ///< Passing through the value of a string.
+        kState_Error                    = 2     ///< A previous error has stopped the parser.
+    };
+
+    WEAVE_ERROR ProcessHead(void);
+    WEAVE_ERROR DeliverEvent(EventType aType, TLVReader *aElement, const uint8_t *aData, uint32_t aDataLen);
+
+    EventHandler mHandler;
+    uint32_t mStringRemaining;
+    uint32_t mLenParsed;
+    uint8_t mState;
+    uint8_t mHeadLen;
+    uint8_t mHeadNeeded;
+    uint8_t mDepth;
+    uint8_t mHead[kMaxHeadLen];
+    uint8_t mContainerTypes[WEAVE_CONFIG_TLV_PUSH_PARSER_MAX_DEPTH];
+};
+
+} // namespace TLV
+} // namespace Weave
+} // namespace nl
+
+#endif /* WEAVE_TLV_PUSH_PARSER_H_ */
@@ -37,6 +37,32 @@ using namespace nl::Weave::Encoding;
 
 static const uint8_t sTagSizes[] = { 0, 1, 2, 4, 2, 4, 6, 8 };
 
+// Size of the length/value field for each element type, indexed by the low 5 bits of the control
+// byte.  Entries for unassigned element types hold kInvalidFieldSize.
+enum { kInvalidFieldSize = 0xFF };
+static const uint8_t sLenOrValSizes[] =
+{
+    1, 2, 4, 8,                     // Int8 .. Int64
+    1, 2, 4, 8,                     // UInt8 .. UInt64
+    0, 0,                           // BooleanFalse, BooleanTrue
+    4, 8,                           // FloatingPointNumber32, FloatingPointNumber64
+    1, 2, 4, 8,                     // UTF8String_1ByteLength .. UTF8String_8ByteLength
+    1, 2, 4, 8,                     // ByteString_1ByteLength .. ByteString_8ByteLength
+    0, 0, 0, 0,                     // Null, Structure, Array, Path
+    0,                              // EndOfContainer
+    kInvalidFieldSize, kInvalidFieldSize, kInvalidFieldSize, kInvalidFieldSize,
+    kInvalidFieldSize, kInvalidFieldSize, kInvalidFieldSize
+};
+
+// Masks that reduce a 64-bit little-endian load to a field of the given byte size.
+static const uint64_t sFieldSizeMasks[] =
+{
+    0, 0xFFULL, 0xFFFFULL, 0, 0xFFFFFFFFULL, 0, 0, 0, 0xFFFFFFFFFFFFFFFFULL
+};
+
+// The largest possible element head: 1 control byte + 8 tag bytes + 8 length/value bytes.
+enum { kMaxElementHeadLength = 17 };
+
 /**
  * @fn uint32_t TLVReader::GetLengthRead() const
  *
@@ -86,6 +112,18 @@ static const uint8_t sTagSizes[] = { 0, 1, 2, 4, 2, 4, 6, 8 };
  * kProfileIdNotSpecified, the reader will return a #WEAVE_ERROR_UNKNOWN_IMPLICIT_TLV_TAG error.
  */
 
+/**
+ * @var const TLVProfileDictionary *TLVReader::ProfileDictionary
+ *
+ * The profile dictionary with which the encoding being read was written, if any.
+ *
+ * By default, the @p ProfileDictionary property is set to NULL.  When set, tags encoded in 4-byte
+ * implicit form are interpreted as references to the profiles in the dictionary, and are returned
+ * by GetTag() as fully-qualified profile tags.  A reference to a position beyond the end of the
+ * dictionary results in a #WEAVE_ERROR_UNKNOWN_IMPLICIT_TLV_TAG error.  See TLVProfileDictionary
+ * for details.
+ */
+
 /**
  * @var void *TLVReader::AppData
  *
@@ -155,6 +193,7 @@ void TLVReader::Init(const uint8_t *data, uint32_t dataLen)
     SetContainerOpen(false);
 
     ImplicitProfileId = kProfileIdNotSpecified;
+    ProfileDictionary = NULL;
     AppData = NULL;
     GetNextBuffer = NULL;
 }
@@ -181,6 +220,7 @@ void TLVReader::Init(PacketBuffer *buf, uint32_t maxLen)
     SetContainerOpen(false);
 
     ImplicitProfileId = kProfileIdNotSpecified;
+    ProfileDictionary = NULL;
     AppData = NULL;
     GetNextBuffer = NULL;
 }
@@ -213,6 +253,7 @@ void TLVReader::Init(PacketBuffer *buf, uint32_t maxLen, bool allowDiscontiguous
     SetContainerOpen(false);
 
     ImplicitProfileId = kProfileIdNotSpecified;
+    ProfileDictionary = NULL;
     AppData = NULL;
 
     if (allowDiscontiguousBuffers)
@@ -250,6 +291,7 @@ void TLVReader::Init(const TLVReader &aReader)
     // Initialize public data members
 
     ImplicitProfileId = aReader.ImplicitProfileId;
+    ProfileDictionary = aReader.ProfileDictionary;
     AppData           = aReader.AppData;
     GetNextBuffer     = aReader.GetNextBuffer;
 }
@@ -803,6 +845,138 @@ WEAVE_ERROR TLVReader::GetDataPtr(const uint8_t *& data)
     return WEAVE_NO_ERROR;
 }
 
+/**
+ * Get the value of the current byte or UTF8 string element as a list of segments within the
+ * underlying input buffers.
+ *
+ * Unlike GetDataPtr(), this method succeeds when the string value spans more than one input
+ * buffer, e.g. when reading from a chain of PacketBuffers or from a WeaveCircularTLVBuffer whose
+ * contents wrap around.  Each segment describes the portion of the value held in one buffer, in
+ * order.  No data is copied; the segments point directly into the input buffers and remain valid
+ * only for as long as those buffers do.
+ *
+ * On success the string value is consumed, as with GetBytes().  On failure the reader is left
+ * positioned on the element, and the value can still be read by other means.
+ *
+ * @param[out] segments                 A pointer to an array to receive the segments.
+ * @param[in]  maxSegments              The number of entries in the @p segments array.
+ * @param[out] numSegments              A reference to a value that will receive the number of
+ *                                      segments returned.  A zero-length string yields no segments.
+ *
+ * @retval #WEAVE_NO_ERROR              If the method succeeded.
+ * @retval #WEAVE_ERROR_WRONG_TLV_TYPE  If the current element is not a TLV byte or UTF8 string, or the
+ *                                      reader is not positioned on an element.
+ * @retval #WEAVE_ERROR_BUFFER_TOO_SMALL
+ *                                      If the value spans more than @p maxSegments input buffers.
+ * @retval #WEAVE_ERROR_TLV_UNDERRUN    If the underlying TLV encoding ended prematurely.
+ * @retval other                        Other Weave or platform error codes returned by the configured
+ *                                      GetNextBuffer() function. Only possible when GetNextBuffer is
+ *                                      non-NULL.
+ *
+ */
+WEAVE_ERROR TLVReader::GetDataSegments(TLVDataSegment *segments, uint32_t maxSegments, uint32_t& numSegments)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    TLVReader savedReader;
+    uint32_t len;
+
+    if (!TLVTypeIsString(ElementType()))
+        return WEAVE_ERROR_WRONG_TLV_TYPE;
+
+    // Remember where the value starts so the reader can be restored if the segments run out.
+    savedReader.Init(*this);
+
+    len = (uint32_t) mElemLenOrVal;
+    numSegments = 0;
+
+    while (len > 0)
+    {
+        err = EnsureData(WEAVE_ERROR_TLV_UNDERRUN);
+        if (err != WEAVE_NO_ERROR)
+            break;
+
+        if (numSegments == maxSegments)
+        {
+            err = WEAVE_ERROR_BUFFER_TOO_SMALL;
+            break;
+        }
+
+        uint32_t segmentLen = mBufEnd - mReadPoint;
+        if (segmentLen > len)
+            segmentLen = len;
+
+        segments[numSegments].Data = mReadPoint;
+        segments[numSegments].Len = segmentLen;
+        numSegments++;
+
+        mReadPoint += segmentLen;
+        mLenRead += segmentLen;
+        len -= segmentLen;
+    }
+
+    if (err != WEAVE_NO_ERROR)
+    {
+        Init(savedReader);
+        numSegments = 0;
+        return err;
+    }
+
+    mElemLenOrVal = 0;
+
+    return WEAVE_NO_ERROR;
+}
+
+/**
+ * Get the next segment of the value of the current byte or UTF8 string element.
+ *
+ * Each call returns the portion of the remaining string value held in the current input buffer,
+ * advancing to the next input buffer as needed, and consumes it.  Unlike GetDataSegments(), this
+ * method places no limit on the number of input buffers the value may span.  No data is copied;
+ * the segment points directly into the input buffer and remains valid only for as long as that
+ * buffer does.
+ *
+ * @param[out] segment                  A reference to a segment that will receive the next portion
+ *                                      of the value.
+ *
+ * @retval #WEAVE_NO_ERROR              If the method succeeded.
+ * @retval #WEAVE_END_OF_TLV            If the whole of the value has already been returned.
+ * @retval #WEAVE_ERROR_WRONG_TLV_TYPE  If the current element is not a TLV byte or UTF8 string, or the
+ *                                      reader is not positioned on an element.
+ * @retval #WEAVE_ERROR_TLV_UNDERRUN    If the underlying TLV encoding ended prematurely.
+ * @retval other                        Other Weave or platform error codes returned by the configured
+ *                                      GetNextBuffer() function. Only possible when GetNextBuffer is
+ *                                      non-NULL.
+ *
+ */
+WEAVE_ERROR TLVReader::GetNextDataSegment(TLVDataSegment& segment)
+{
+    WEAVE_ERROR err;
+    uint32_t segmentLen;
+
+    if (!TLVTypeIsString(ElementType()))
+        return WEAVE_ERROR_WRONG_TLV_TYPE;
+
+    if (mElemLenOrVal == 0)
+        return WEAVE_END_OF_TLV;
+
+    err = EnsureData(WEAVE_ERROR_TLV_UNDERRUN);
+    if (err != WEAVE_NO_ERROR)
+        return err;
+
+    segmentLen = mBufEnd - mReadPoint;
+    if (segmentLen > mElemLenOrVal)
+        segmentLen = (uint32_t) mElemLenOrVal;
+
+    segment.Data = mReadPoint;
+    segment.Len = segmentLen;
+
+    mReadPoint += segmentLen;
+    mLenRead += segmentLen;
+    mElemLenOrVal -= segmentLen;
+
+    return WEAVE_NO_ERROR;
+}
+
 /**
  * Initializes a new TLVReader object for reading the members of a TLV container element.
  *
@@ -827,6 +1001,7 @@ WEAVE_ERROR TLVReader::GetDataPtr(const uint8_t *& data)
  * The container reader inherits various configuration properties from the parent reader.  These are:
  *
  * @li The implicit profile id (ImplicitProfileId)
+ * @li The profile dictionary (ProfileDictionary)
  * @li The application data pointer (AppData)
  * @li The GetNextBuffer function pointer
  *
@@ -856,6 +1031,7 @@ WEAVE_ERROR TLVReader::OpenContainer(TLVReader& containerReader)
     containerReader.mContainerType = (TLVType) elemType;
     containerReader.SetContainerOpen(false);
     containerReader.ImplicitProfileId = ImplicitProfileId;
+    containerReader.ProfileDictionary = ProfileDictionary;
     containerReader.AppData = AppData;
     containerReader.GetNextBuffer = GetNextBuffer;
 
@@ -1284,10 +1460,19 @@ WEAVE_ERROR TLVReader::SkipToEndOfContainer()
 WEAVE_ERROR TLVReader::ReadElement()
 {
     WEAVE_ERROR err;
-    uint8_t stagingBuf[17]; // 17 = 1 control byte + 8 tag bytes + 8 length/value bytes
+    uint8_t stagingBuf[kMaxElementHeadLength];
     const uint8_t *p;
     TLVElementType elemType;
 
+    // Fast path: if the current input buffer holds at least the largest possible element head, the
+    // head can be decoded in place, regardless of its actual size, using whole-word loads.  This is
+    // the case for every element of a contiguous input other than those in its final few bytes, and
+    // for most elements of a buffer chain.
+    if (mBufEnd - mReadPoint >= kMaxElementHeadLength)
+    {
+        return ReadElementFast();
+    }
+
     // Make sure we have input data. Return WEAVE_END_OF_TLV if no more data is available.
     err = EnsureData(WEAVE_END_OF_TLV);
     if (err != WEAVE_NO_ERROR)
@@ -1362,6 +1547,36 @@ WEAVE_ERROR TLVReader::ReadElement()
     return VerifyElement();
 }
 
+/**
+ * This is a private method that decodes the head of the next element directly from the input
+ * buffer.  The caller must ensure that at least kMaxElementHeadLength bytes remain in the current
+ * buffer.
+ */
+WEAVE_ERROR TLVReader::ReadElementFast()
+{
+    const uint8_t *p = mReadPoint;
+    uint8_t controlByte = p[0];
+    uint8_t tagBytes = sTagSizes[controlByte >> kTLVTagControlShift];
+    uint8_t lenOrValBytes = sLenOrValSizes[controlByte & kTLVTypeMask];
+    uint8_t elemHeadBytes;
+
+    mControlByte = controlByte;
+
+    if (lenOrValBytes == kInvalidFieldSize)
+        return WEAVE_ERROR_INVALID_TLV_ELEMENT;
+
+    // Load the tag and the length/value fields as whole words, and mask off the bytes that
+    // belong to the following fields.
+    mElemTag = DecodeTag((TLVTagControl)(controlByte & kTLVTagControlMask), LittleEndian::Get64(p + 1));
+    mElemLenOrVal = LittleEndian::Get64(p + 1 + tagBytes) & sFieldSizeMasks[lenOrValBytes];
+
+    elemHeadBytes = 1 + tagBytes + lenOrValBytes;
+    mReadPoint += elemHeadBytes;
+    mLenRead += elemHeadBytes;
+
+    return VerifyElement();
+}
+
 WEAVE_ERROR TLVReader::VerifyElement()
 {
     if (ElementType() == kTLVElementType_EndOfContainer)
@@ -1433,9 +1648,7 @@ uint64_t TLVReader::ReadTag(TLVTagControl tagControl, const uint8_t *& p)
             return UnknownImplicitTag;
         return ProfileTag(ImplicitProfileId, LittleEndian::Read16(p));
     case kTLVTagControl_ImplicitProfile_4Bytes:
-        if (ImplicitProfileId == kProfileIdNotSpecified)
-            return UnknownImplicitTag;
-        return ProfileTag(ImplicitProfileId, LittleEndian::Read32(p));
+        return DecodeImplicitTag32(LittleEndian::Read32(p));
     case kTLVTagControl_FullyQualified_6Bytes:
         vendorId = LittleEndian::Read16(p);
         profileNum = LittleEndian::Read16(p);
@@ -1450,6 +1663,58 @@ uint64_t TLVReader::ReadTag(TLVTagControl tagControl, const uint8_t *& p)
     }
 }
 
+/**
+ * This is a private method that decodes a tag from the (little-endian) 64-bit word that
+ * immediately follows an element's control byte.
+ */
+uint64_t TLVReader::DecodeTag(TLVTagControl tagControl, uint64_t tagBits) const
+{
+    switch (tagControl)
+    {
+    case kTLVTagControl_ContextSpecific:
+        return ContextTag((uint8_t) tagBits);
+    case kTLVTagControl_CommonProfile_2Bytes:
+        return CommonTag((uint16_t) tagBits);
+    case kTLVTagControl_CommonProfile_4Bytes:
+        return CommonTag((uint32_t) tagBits);
+    case kTLVTagControl_ImplicitProfile_2Bytes:
+        if (ImplicitProfileId == kProfileIdNotSpecified)
+            return UnknownImplicitTag;
+        return ProfileTag(ImplicitProfileId, (uint16_t) tagBits);
+    case kTLVTagControl_ImplicitProfile_4Bytes:
+        return DecodeImplicitTag32((uint32_t) tagBits);
+    case kTLVTagControl_FullyQualified_6Bytes:
+        return ProfileTag((uint16_t) tagBits, (uint16_t) (tagBits >> 16), (uint16_t) (tagBits >> 32));
+    case kTLVTagControl_FullyQualified_8Bytes:
+        return ProfileTag((uint16_t) tagBits, (uint16_t) (tagBits >> 16), (uint32_t) (tagBits >> 32));
+    case kTLVTagControl_Anonymous:
+    default:
+        return AnonymousTag;
+    }
+}
+
+/**
+ * This is a private method that expands a tag encoded in the 4-byte implicit form, which refers
+ * to the ImplicitProfileId or, if the reader has a profile dictionary, to a profile within it.
+ */
+uint64_t TLVReader::DecodeImplicitTag32(uint32_t tagBits) const
+{
+    if (ProfileDictionary != NULL)
+    {
+        const uint32_t index = tagBits >> 24;
+
+        if (index >= ProfileDictionary->NumProfiles)
+            return UnknownImplicitTag;
+
+        return ProfileTag(ProfileDictionary->ProfileIds[index], tagBits & TLVProfileDictionary::kMaxTagNum);
+    }
+
+    if (ImplicitProfileId == kProfileIdNotSpecified)
+        return UnknownImplicitTag;
+
+    return ProfileTag(ImplicitProfileId, tagBits);
+}
+
 WEAVE_ERROR TLVReader::ReadData(uint8_t *buf, uint32_t len)
 {
     WEAVE_ERROR err;
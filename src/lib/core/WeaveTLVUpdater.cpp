@@ -150,6 +150,7 @@ WEAVE_ERROR TLVUpdater::Init(TLVReader& aReader, uint32_t freeLen)
     mUpdaterReader.SetContainerOpen(false);
 
     mUpdaterReader.ImplicitProfileId = aReader.ImplicitProfileId;
+    mUpdaterReader.ProfileDictionary = aReader.ProfileDictionary;
     mUpdaterReader.AppData = aReader.AppData;
     mUpdaterReader.GetNextBuffer = NULL;
 
@@ -165,6 +166,7 @@ WEAVE_ERROR TLVUpdater::Init(TLVReader& aReader, uint32_t freeLen)
     mUpdaterWriter.SetCloseContainerReserved(false);
 
     mUpdaterWriter.ImplicitProfileId = aReader.ImplicitProfileId;
+    mUpdaterWriter.ProfileDictionary = aReader.ProfileDictionary;
     mUpdaterWriter.GetNewBuffer = NULL;
     mUpdaterWriter.FinalizeBuffer = NULL;
 
@@ -197,6 +199,22 @@ void TLVUpdater::SetImplicitProfileId(uint32_t profileId)
     mUpdaterWriter.ImplicitProfileId = profileId;
 }
 
+/**
+ * Set the profile dictionary for the TLVUpdater object.
+ *
+ * This method sets the profile dictionary used both to read the existing
+ * elements and to encode new ones.  Because the updater copies unmodified
+ * elements verbatim, the dictionary must be the one with which the existing
+ * encoding was written.  See TLVProfileDictionary for details.
+ *
+ * @param[in]   dict        The profile dictionary, or NULL for none.
+ */
+void TLVUpdater::SetProfileDictionary(const TLVProfileDictionary *dict)
+{
+    mUpdaterReader.ProfileDictionary = dict;
+    mUpdaterWriter.ProfileDictionary = dict;
+}
+
 /**
  * Skip the current element and advance the TLVUpdater object to the next
  * element in the input TLV.
@@ -304,8 +322,10 @@ WEAVE_ERROR TLVUpdater::Move()
 
     copyLen = elementEnd - mElementStartAddr;
 
-    // Move the element to output TLV
-    memmove(mUpdaterWriter.mWritePoint, mElementStartAddr, copyLen);
+    // Move the element to output TLV, unless it is already in place (as is the case when no free
+    // space precedes it)
+    if (mUpdaterWriter.mWritePoint != mElementStartAddr)
+        memmove(mUpdaterWriter.mWritePoint, mElementStartAddr, copyLen);
 
     // Adjust the updater state
     mElementStartAddr += copyLen;
@@ -340,8 +360,9 @@ void TLVUpdater::MoveUntilEnd()
 
     uint32_t copyLen = buffEnd - mElementStartAddr;
 
-    // Move all elements till end to output TLV
-    memmove(mUpdaterWriter.mWritePoint, mElementStartAddr, copyLen);
+    // Move all elements till end to output TLV, unless they are already in place
+    if (mUpdaterWriter.mWritePoint != mElementStartAddr)
+        memmove(mUpdaterWriter.mWritePoint, mElementStartAddr, copyLen);
 
     // Adjust the updater state
     mElementStartAddr += copyLen;
@@ -481,6 +502,85 @@ exit:
     return err;
 }
 
+/**
+ * Apply a batch of edits to the remaining elements of the current container in a single pass.
+ *
+ * The ApplyEdits() method walks the input TLV from the updater's current position to the end of
+ * the current container (or, at the outermost level, to the end of the encoding), applying each
+ * edit to the element named by its tag path.  Containers are only entered when some edit names an
+ * element within them; all other elements are moved to the output untouched.  When ApplyEdits()
+ * returns, the updater is positioned at the end of the container, from where the application may
+ * call ExitContainer() or, at the outermost level, Finalize().
+ *
+ * A #TLVEdit::kOp_Replace edit replaces the first element matching its path with the supplied
+ * value.  If no such element exists, but the container named by the rest of the path does, the new
+ * element is added at the end of that container.  A #TLVEdit::kOp_Delete edit removes the first
+ * element matching its path, and has no effect if there is none.  Paths are matched against
+ * element tags, so members of arrays cannot be addressed individually.
+ *
+ * Edits that preserve the size of the encoding need no free space, and are applied in place: when
+ * the updater has no free space ahead of the element being examined, unchanged elements are left
+ * where they are rather than copied.  Edits that grow the encoding need enough free space to hold
+ * the growth up to the point at which each is applied.
+ *
+ * The updater must be positioned before an element when ApplyEdits() is called, i.e. immediately
+ * after Init(), EnterContainer(), ExitContainer() or Move().
+ *
+ * @param[in]   edits       A pointer to an array of @p numEdits edits.
+ * @param[in]   numEdits    The number of edits, which may not exceed #kMaxEdits.
+ *
+ * @retval #WEAVE_NO_ERROR              If all edits were applied.
+ * @retval #WEAVE_ERROR_INVALID_ARGUMENT
+ *                                      If there are too many edits, an edit has an empty path,
+ *                                      an unknown operation or no replacement value, or two edits
+ *                                      have the same path.
+ * @retval #WEAVE_ERROR_INCORRECT_STATE If the updater is positioned on an element.
+ * @retval #WEAVE_ERROR_TLV_TAG_NOT_FOUND
+ *                                      If the container named by the path of an edit could not be
+ *                                      found.  All other edits have been applied.
+ * @retval #WEAVE_ERROR_BUFFER_TOO_SMALL
+ *                                      If there is not enough free space to apply an edit.
+ * @retval other                        Any other Weave or platform error code returned while reading
+ *                                      the input TLV or writing a replacement value.
+ *
+ */
+WEAVE_ERROR TLVUpdater::ApplyEdits(const TLVEdit *edits, size_t numEdits)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    uint32_t pending;
+
+    VerifyOrExit(edits != NULL || numEdits == 0, err = WEAVE_ERROR_INVALID_ARGUMENT);
+    VerifyOrExit(numEdits <= kMaxEdits, err = WEAVE_ERROR_INVALID_ARGUMENT);
+    VerifyOrExit(mUpdaterReader.ElementType() == kTLVElementType_NotSpecified, err = WEAVE_ERROR_INCORRECT_STATE);
+
+    for (size_t i = 0; i < numEdits; i++)
+    {
+        VerifyOrExit(edits[i].Path != NULL && edits[i].PathLen > 0, err = WEAVE_ERROR_INVALID_ARGUMENT);
+        VerifyOrExit(edits[i].Op == TLVEdit::kOp_Delete ||
+                     (edits[i].Op == TLVEdit::kOp_Replace && edits[i].Value != NULL),
+                     err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+        // Only one edit may be applied to each element.
+        for (size_t j = 0; j < i; j++)
+        {
+            VerifyOrExit(edits[j].PathLen != edits[i].PathLen ||
+                         memcmp(edits[j].Path, edits[i].Path, edits[i].PathLen * sizeof(uint64_t)) != 0,
+                         err = WEAVE_ERROR_INVALID_ARGUMENT);
+        }
+    }
+
+    // One bit per edit that has yet to be applied.
+    pending = (numEdits == kMaxEdits) ? 0xFFFFFFFFUL : ((1UL << numEdits) - 1);
+
+    err = ApplyEditsInContainer(edits, pending, 0, pending);
+    SuccessOrExit(err);
+
+    VerifyOrExit(pending == 0, err = WEAVE_ERROR_TLV_TAG_NOT_FOUND);
+
+exit:
+    return err;
+}
+
 /**
  * This is a private method that adjusts the TLVUpdater's free space count by
  * accounting for the freespace from mElementStartAddr to current read point.
@@ -500,6 +600,120 @@ void TLVUpdater::AdjustInternalWriterFreeSpace()
     }
 }
 
+/**
+ * This is a private method that applies the pending edits in the set @p active, all of whose
+ * paths lead through the current container, to the members of that container.  @p depth is the
+ * index, within the edits' paths, of the tags of the container's members.
+ */
+WEAVE_ERROR TLVUpdater::ApplyEditsInContainer(const TLVEdit *edits, uint32_t active, uint8_t depth, uint32_t& pending)
+{
+    WEAVE_ERROR err;
+
+    while ((err = mUpdaterReader.Next()) == WEAVE_NO_ERROR)
+    {
+        const uint64_t tag = mUpdaterReader.GetTag();
+        const TLVEdit *edit = NULL;
+        uint32_t nested = 0;
+
+        // Find the edit naming this element, and any edits naming elements within it.
+        for (uint8_t i = 0; i < kMaxEdits; i++)
+        {
+            const uint32_t bit = 1UL << i;
+
+            if ((active & pending & bit) == 0 || edits[i].Path[depth] != tag)
+                continue;
+
+            if (edits[i].PathLen > depth + 1)
+                nested |= bit;
+            else if (edit == NULL)
+            {
+                edit = &edits[i];
+                pending &= ~bit;
+            }
+        }
+
+        if (edit != NULL)
+        {
+            // Drop the existing element, making its space available to the writer.
+            err = mUpdaterReader.Skip();
+            SuccessOrExit(err);
+
+            AdjustInternalWriterFreeSpace();
+
+            if (edit->Op == TLVEdit::kOp_Replace)
+            {
+                err = PutEditValue(*edit);
+                SuccessOrExit(err);
+            }
+        }
+        else if (nested != 0 && TLVTypeIsContainer(mUpdaterReader.ElementType()))
+        {
+            TLVType outerContainerType;
+
+            err = EnterContainer(outerContainerType);
+            SuccessOrExit(err);
+
+            err = ApplyEditsInContainer(edits, nested, depth + 1, pending);
+            SuccessOrExit(err);
+
+            err = ExitContainer(outerContainerType);
+            SuccessOrExit(err);
+        }
+        else
+        {
+            err = Move();
+            SuccessOrExit(err);
+        }
+    }
+
+    VerifyOrExit(err == WEAVE_END_OF_TLV, /* no-op */);
+
+    // Add any replacement values that did not match an existing member to the end of the container.
+    for (uint8_t i = 0; i < kMaxEdits; i++)
+    {
+        const uint32_t bit = 1UL << i;
+
+        if ((active & pending & bit) == 0 || edits[i].PathLen != depth + 1)
+            continue;
+
+        pending &= ~bit;
+
+        if (edits[i].Op == TLVEdit::kOp_Replace)
+        {
+            err = PutEditValue(edits[i]);
+            SuccessOrExit(err);
+        }
+    }
+
+    err = WEAVE_NO_ERROR;
+
+exit:
+    return err;
+}
+
+/**
+ * This is a private method that writes the replacement value of an edit to the output TLV, using
+ * the last tag of the edit's path.
+ */
+WEAVE_ERROR TLVUpdater::PutEditValue(const TLVEdit& edit)
+{
+    WEAVE_ERROR err;
+    TLVReader valueReader;
+
+    valueReader.Init(edit.Value, edit.ValueLen);
+    valueReader.ImplicitProfileId = mUpdaterReader.ImplicitProfileId;
+    valueReader.ProfileDictionary = mUpdaterReader.ProfileDictionary;
+
+    err = valueReader.Next();
+    SuccessOrExit(err);
+
+    err = mUpdaterWriter.CopyElement(edit.Path[edit.PathLen - 1], valueReader);
+    SuccessOrExit(err);
+
+exit:
+    return err;
+}
+
 } // namespace TLV
 } // namespace Weave
 } // namespace nl
@@ -443,6 +443,295 @@ WEAVE_ERROR Find(const TLVReader &aReader, IterateHandler aPredicate, void *aCon
     return retval;
 }
 
+// Multipliers and offsets of the xxHash64 algorithm.
+static const uint64_t kHashPrime1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t kHashPrime2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t kHashPrime3 = 0x165667B19E3779F9ULL;
+static const uint64_t kHashPrime4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t kHashPrime5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t RotateLeft(uint64_t v, uint8_t n)
+{
+    return (v << n) | (v >> (64 - n));
+}
+
+/**
+ *  Incrementally computes a 64-bit, non-cryptographic hash of a sequence of
+ *  64-bit words and bytes, using the lane and avalanche functions of xxHash64.
+ *  Bytes are gathered, little-endian, into words, so the result is independent
+ *  of how a byte sequence is split between calls, and of the host byte order.
+ */
+class HashState
+{
+public:
+    HashState(void) : mAcc(kHashPrime5), mLen(0), mPending(0), mPendingLen(0) { }
+
+    void AddWord(uint64_t aWord)
+    {
+        uint64_t lane = aWord * kHashPrime2;
+
+        lane = RotateLeft(lane, 31) * kHashPrime1;
+
+        mAcc ^= lane;
+        mAcc = RotateLeft(mAcc, 27) * kHashPrime1 + kHashPrime4;
+        mLen += 8;
+    }
+
+    void AddBytes(const uint8_t *aData, uint32_t aDataLen)
+    {
+        for (uint32_t i = 0; i < aDataLen; i++)
+        {
+            mPending |= static_cast<uint64_t>(aData[i]) << (8 * mPendingLen);
+
+            if (++mPendingLen == 8)
+            {
+                AddWord(mPending);
+                mPending = 0;
+                mPendingLen = 0;
+            }
+        }
+    }
+
+    uint64_t Finish(void)
+    {
+        uint64_t h;
+
+        if (mPendingLen > 0)
+        {
+            AddWord(mPending);
+            mLen -= 8 - mPendingLen;
+            mPending = 0;
+            mPendingLen = 0;
+        }
+
+        h = mAcc + mLen;
+
+        h ^= h >> 33;
+        h *= kHashPrime2;
+        h ^= h >> 29;
+        h *= kHashPrime3;
+        h ^= h >> 32;
+
+        return h;
+    }
+
+private:
+    uint64_t mAcc;
+    uint64_t mLen;
+    uint64_t mPending;
+    uint8_t mPendingLen;
+};
+
+/**
+ *  Compute the canonical hash of the TLV element on which @a aReader is
+ *  positioned, including, for containers, all of their members.  On return,
+ *  the reader is positioned on the same element, with any container having
+ *  been exited.
+ *
+ *  @param[in]     aReader      A reference to a TLV reader positioned on the
+ *                              element to be hashed.
+ *  @param[in]     aDepth       The number of containers enclosing the element.
+ *  @param[out]    aHash        The hash of the element.
+ *
+ *  @retval  #WEAVE_NO_ERROR    On success.
+ *
+ *  @retval  #WEAVE_ERROR_INVALID_TLV_ELEMENT
+ *                              If containers are nested more than
+ *                              #kMaxHashDepth deep.
+ *
+ *  @retval  other              Any error returned by the reader.
+ */
+static WEAVE_ERROR HashElement(TLVReader &aReader, size_t aDepth, uint64_t &aHash)
+{
+    WEAVE_ERROR  retval = WEAVE_NO_ERROR;
+    HashState    state;
+    const TLVType theType = aReader.GetType();
+
+    state.AddWord(static_cast<uint64_t>(theType));
+    state.AddWord(aReader.GetTag());
+
+    switch (theType)
+    {
+    case kTLVType_SignedInteger:
+    {
+        int64_t v;
+
+        retval = aReader.Get(v);
+        SuccessOrExit(retval);
+
+        state.AddWord(static_cast<uint64_t>(v));
+        break;
+    }
+
+    case kTLVType_UnsignedInteger:
+    {
+        uint64_t v;
+
+        retval = aReader.Get(v);
+        SuccessOrExit(retval);
+
+        state.AddWord(v);
+        break;
+    }
+
+    case kTLVType_Boolean:
+    {
+        bool v;
+
+        retval = aReader.Get(v);
+        SuccessOrExit(retval);
+
+        state.AddWord(v ? 1 : 0);
+        break;
+    }
+
+    case kTLVType_FloatingPointNumber:
+    {
+        union
+        {
+            double d;
+            uint64_t u64;
+        } cvt;
+
+        // Single and double precision values are hashed alike, as the double they represent,
+        // with all NaNs treated as one value.
+        retval = aReader.Get(cvt.d);
+        SuccessOrExit(retval);
+
+        if (cvt.d != cvt.d)
+            cvt.u64 = 0x7FF8000000000000ULL;
+
+        state.AddWord(cvt.u64);
+        break;
+    }
+
+    case kTLVType_UTF8String:
+    case kTLVType_ByteString:
+    {
+        TLVDataSegment segment;
+
+        state.AddWord(aReader.GetLength());
+
+        // The value is hashed one input buffer at a time, however many buffers it spans.
+        while ((retval = aReader.GetNextDataSegment(segment)) == WEAVE_NO_ERROR)
+            state.AddBytes(segment.Data, segment.Len);
+
+        if (retval != WEAVE_END_OF_TLV)
+            SuccessOrExit(retval);
+
+        retval = WEAVE_NO_ERROR;
+        break;
+    }
+
+    case kTLVType_Structure:
+    case kTLVType_Array:
+    case kTLVType_Path:
+    {
+        TLVType containerType;
+        uint64_t memberHash;
+        uint64_t memberHashSum = 0;
+        uint64_t memberCount = 0;
+
+        // Bound the recursion, so that hostile input cannot exhaust the stack.
+        VerifyOrExit(aDepth < kMaxHashDepth, retval = WEAVE_ERROR_INVALID_TLV_ELEMENT);
+
+        retval = aReader.EnterContainer(containerType);
+        SuccessOrExit(retval);
+
+        while ((retval = aReader.Next()) == WEAVE_NO_ERROR)
+        {
+            retval = HashElement(aReader, aDepth + 1, memberHash);
+            SuccessOrExit(retval);
+
+            // The members of a structure are unordered, so their hashes are combined by addition,
+            // which gives the same result for any order of the same members.  The members of
+            // arrays and paths are ordered, and are hashed in sequence.
+            if (theType == kTLVType_Structure)
+                memberHashSum += memberHash;
+            else
+                state.AddWord(memberHash);
+
+            memberCount++;
+        }
+
+        if (retval != WEAVE_END_OF_TLV)
+            SuccessOrExit(retval);
+
+        retval = aReader.ExitContainer(containerType);
+        SuccessOrExit(retval);
+
+        if (theType == kTLVType_Structure)
+            state.AddWord(memberHashSum);
+
+        state.AddWord(memberCount);
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    aHash = state.Finish();
+
+exit:
+    return retval;
+}
+
+/**
+ *  Compute a canonical fingerprint of the TLV element referenced by @a aReader.
+ *
+ *  The hash covers the element's type, tag and value, and, for containers,
+ *  every member they contain, nested up to #kMaxHashDepth deep.  It is
+ *  canonical in that it depends only on the content of the element, not on
+ *  the details of its encoding:
+ *
+ *    - Members of structures may appear in any order.
+ *    - Integers hash alike regardless of the width with which they are encoded,
+ *      as do single and double precision encodings of the same value.
+ *    - Implicitly tagged elements hash as their fully-qualified tags.
+ *    - String values hash alike however they are split across input buffers.
+ *
+ *  Applications can therefore compare the fingerprints of two encodings to
+ *  decide cheaply whether their content differs, for example to avoid
+ *  publishing or persisting data that has not changed.  The hash is not
+ *  cryptographic, and must not be relied on where collisions could be
+ *  engineered by an adversary.
+ *
+ *  @param[in]     aReader      A reference to a TLV reader positioned on the
+ *                              element to be hashed.  If the reader is not yet
+ *                              positioned on an element, the next element is
+ *                              hashed.  The reader itself is not advanced.
+ *  @param[out]    aHash        A reference to storage for the 64-bit hash.
+ *
+ *  @retval  #WEAVE_NO_ERROR                On success.
+ *
+ *  @retval  #WEAVE_END_OF_TLV              If there is no element to hash.
+ *
+ *  @retval  #WEAVE_ERROR_INVALID_TLV_ELEMENT
+ *                                          If containers are nested more than
+ *                                          #kMaxHashDepth deep.
+ *
+ *  @retval  other                          Any other error returned by the reader.
+ */
+WEAVE_ERROR Hash(const TLVReader &aReader, uint64_t &aHash)
+{
+    TLVReader    temp;
+    WEAVE_ERROR  retval = WEAVE_NO_ERROR;
+
+    temp.Init(aReader);
+
+    if (temp.GetType() == kTLVType_NotSpecified)
+    {
+        retval = temp.Next();
+        SuccessOrExit(retval);
+    }
+
+    retval = HashElement(temp, 0, aHash);
+
+ exit:
+    return retval;
+}
+
 } // namespace Utilities
 
 } // namespace TLV
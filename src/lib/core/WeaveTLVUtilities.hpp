@@ -61,6 +61,13 @@ extern WEAVE_ERROR Find(const TLVReader &aReader, const uint64_t &aTag, TLVReade
 
 extern WEAVE_ERROR Find(const TLVReader &aReader, IterateHandler aHandler, void *aContext, TLVReader &aResult);
 extern WEAVE_ERROR Find(const TLVReader &aReader, IterateHandler aHandler, void *aContext, TLVReader &aResult, const bool aRecurse);
+
+enum
+{
+    kMaxHashDepth                       = 32    ///< The maximum nesting depth of containers that Hash() accepts.
+};
+
+extern WEAVE_ERROR Hash(const TLVReader &aReader, uint64_t &aHash);
 } // namespace Utilities
 
 } // namespace TLV
@@ -60,6 +60,18 @@ using namespace nl::Weave::Encoding;
  * tags only; the encoding of context-specific tags is unchanged.
  */
 
+/**
+ * @var const TLVProfileDictionary *TLVWriter::ProfileDictionary
+ *
+ * An optional table of profiles whose tags should be encoded in compact, implicit form.
+ *
+ * By default, the @p ProfileDictionary property is set to NULL, and only the tags of the
+ * ImplicitProfileId profile are encoded in implicit form.  When set, tags of any profile listed in
+ * the dictionary are encoded in 4-byte implicit form by reference to the dictionary.  Encodings
+ * written in this way can only be read by a TLVReader with the same dictionary.  See
+ * TLVProfileDictionary for details.
+ */
+
 /**
  * @var void *TLVWriter::AppData
  *
@@ -174,6 +186,7 @@ void TLVWriter::Init(uint8_t *buf, uint32_t maxLen)
     SetCloseContainerReserved(true);
 
     ImplicitProfileId = kProfileIdNotSpecified;
+    ProfileDictionary = NULL;
     GetNewBuffer = NULL;
     FinalizeBuffer = NULL;
 }
@@ -198,6 +211,7 @@ void TLVWriter::InitMalloced(uint8_t *& outBuf, uint32_t initialBufSize, uint32_
     SetCloseContainerReserved(true);
 
     ImplicitProfileId = kProfileIdNotSpecified;
+    ProfileDictionary = NULL;
     FinalizeBuffer = NULL;
     GetNewBuffer = GetNewBuffer_Malloced;
 }
@@ -229,6 +243,7 @@ void TLVWriter::Init(PacketBuffer *buf, uint32_t maxLen)
     SetCloseContainerReserved(true);
 
     ImplicitProfileId = kProfileIdNotSpecified;
+    ProfileDictionary = NULL;
     GetNewBuffer = NULL;
     FinalizeBuffer = FinalizePacketBuffer;
 }
@@ -687,6 +702,44 @@ WEAVE_ERROR TLVWriter::PutBytes(uint64_t tag, const uint8_t *buf, uint32_t len)
     return WriteElementWithData(kTLVType_ByteString, tag, (const uint8_t *) buf, len);
 }
 
+/**
+ * Encodes a TLV byte string value from a list of segments.
+ *
+ * The segments are written, in order, as the value of a single byte string element.  This allows
+ * a value held in several discontiguous buffers, such as one returned by
+ * TLVReader::GetDataSegments(), to be encoded without first gathering it into a single buffer.
+ *
+ * @param[in]   tag             The TLV tag to be encoded with the value, or @p AnonymousTag if the
+ *                              value should be encoded without a tag.  Tag values should be
+ *                              constructed with one of the tag definition functions ProfileTag(),
+ *                              ContextTag() or CommonTag().
+ * @param[in]   segments        A pointer to an array of segments holding the value to be encoded.
+ * @param[in]   numSegments     The number of segments in @p segments.
+ *
+ * @retval #WEAVE_NO_ERROR      If the method succeeded.
+ * @retval #WEAVE_ERROR_INVALID_ARGUMENT
+ *                              If the total length of the segments cannot be encoded.
+ * @retval #WEAVE_ERROR_TLV_CONTAINER_OPEN
+ *                              If a container writer has been opened on the current writer and not
+ *                              yet closed.
+ * @retval #WEAVE_ERROR_INVALID_TLV_TAG
+ *                              If the specified tag value is invalid or inappropriate in the context
+ *                              in which the value is being written.
+ * @retval #WEAVE_ERROR_BUFFER_TOO_SMALL
+ *                              If writing the value would exceed the limit on the maximum number of
+ *                              bytes specified when the writer was initialized.
+ * @retval #WEAVE_ERROR_NO_MEMORY
+ *                              If an attempt to allocate an output buffer failed due to lack of
+ *                              memory.
+ * @retval other                Other Weave or platform-specific errors returned by the configured
+ *                              GetNewBuffer() or FinalizeBuffer() functions.
+ *
+ */
+WEAVE_ERROR TLVWriter::PutBytes(uint64_t tag, const TLVDataSegment *segments, uint32_t numSegments)
+{
+    return WriteElementWithData(kTLVType_ByteString, tag, segments, numSegments);
+}
+
 /**
  * Encodes a TLV byte string in multiple chunks. This should be used with ContinuePutBytes.
  *
@@ -821,6 +874,43 @@ WEAVE_ERROR TLVWriter::PutString(uint64_t tag, const char *buf, uint32_t len)
     return WriteElementWithData(kTLVType_UTF8String, tag, (const uint8_t *) buf, len);
 }
 
+/**
+ * Encodes a TLV UTF8 string value from a list of segments.
+ *
+ * The segments are written, in order, as the value of a single UTF8 string element.  See
+ * PutBytes(uint64_t, const TLVDataSegment *, uint32_t).
+ *
+ * @param[in]   tag             The TLV tag to be encoded with the value, or @p AnonymousTag if the
+ *                              value should be encoded without a tag.  Tag values should be
+ *                              constructed with one of the tag definition functions ProfileTag(),
+ *                              ContextTag() or CommonTag().
+ * @param[in]   segments        A pointer to an array of segments holding the UTF-8 string to be encoded.
+ * @param[in]   numSegments     The number of segments in @p segments.
+ *
+ * @retval #WEAVE_NO_ERROR      If the method succeeded.
+ * @retval #WEAVE_ERROR_INVALID_ARGUMENT
+ *                              If the total length of the segments cannot be encoded.
+ * @retval #WEAVE_ERROR_TLV_CONTAINER_OPEN
+ *                              If a container writer has been opened on the current writer and not
+ *                              yet closed.
+ * @retval #WEAVE_ERROR_INVALID_TLV_TAG
+ *                              If the specified tag value is invalid or inappropriate in the context
+ *                              in which the value is being written.
+ * @retval #WEAVE_ERROR_BUFFER_TOO_SMALL
+ *                              If writing the value would exceed the limit on the maximum number of
+ *                              bytes specified when the writer was initialized.
+ * @retval #WEAVE_ERROR_NO_MEMORY
+ *                              If an attempt to allocate an output buffer failed due to lack of
+ *                              memory.
+ * @retval other                Other Weave or platform-specific errors returned by the configured
+ *                              GetNewBuffer() or FinalizeBuffer() functions.
+ *
+ */
+WEAVE_ERROR TLVWriter::PutString(uint64_t tag, const TLVDataSegment *segments, uint32_t numSegments)
+{
+    return WriteElementWithData(kTLVType_UTF8String, tag, segments, numSegments);
+}
+
 /**
  * @brief
  *   Encode the string output formatted according to the format in the TLV element.
@@ -1253,6 +1343,7 @@ exit:
  * The container writer inherits various configuration properties from the parent writer.  These are:
  *
  * @li The implicit profile id (ImplicitProfileId)
+ * @li The profile dictionary (ProfileDictionary)
  * @li The application data pointer (AppData)
  * @li The GetNewBuffer and FinalizeBuffer function pointers
  *
@@ -1320,6 +1411,7 @@ WEAVE_ERROR TLVWriter::OpenContainer(uint64_t tag, TLVType containerType, TLVWri
     containerWriter.SetContainerOpen(false);
     containerWriter.SetCloseContainerReserved(IsCloseContainerReserved());
     containerWriter.ImplicitProfileId = ImplicitProfileId;
+    containerWriter.ProfileDictionary = ProfileDictionary;
     containerWriter.GetNewBuffer = GetNewBuffer;
     containerWriter.FinalizeBuffer = FinalizeBuffer;
 
@@ -1386,6 +1478,104 @@ WEAVE_ERROR TLVWriter::CloseContainer(TLVWriter& containerWriter)
     return WriteElementHead(kTLVElementType_EndOfContainer, AnonymousTag, 0);
 }
 
+/**
+ * Initializes a scratch writer for encoding elements that may later be added to the current
+ * writer.
+ *
+ * The OpenScratch() method initializes a TLVWriter that encodes into a separate, caller-supplied
+ * scratch buffer, as if writing at the current position of this writer.  The scratch writer
+ * inherits the container type, implicit profile id, profile dictionary and application data
+ * pointer of this writer, so any element that is valid at the current position can be written to
+ * it, and is encoded exactly as this writer would encode it.
+ *
+ * Once the elements have been written, the scratch writer's GetLengthWritten() method reports
+ * the exact number of bytes they occupy.  The application can then either add them to this writer
+ * with CommitScratch(), or discard them by simply abandoning the scratch writer.  Unlike a
+ * checkpoint of this writer, the scratch writer never modifies this writer's output, so
+ * discarding an element that does not fit requires no rollback.
+ *
+ * This writer may continue to be used while the scratch writer is in use.
+ *
+ * @param[in] scratchWriter     A reference to a TLVWriter object that will be initialized to
+ *                              write into the scratch buffer.
+ * @param[in] scratchBuf        A pointer to the scratch buffer.
+ * @param[in] scratchLen        The size of the scratch buffer.
+ *
+ * @retval #WEAVE_NO_ERROR      If the method succeeded.
+ * @retval #WEAVE_ERROR_TLV_CONTAINER_OPEN
+ *                              If a container writer has been opened on the current writer and not
+ *                              yet closed.
+ *
+ */
+WEAVE_ERROR TLVWriter::OpenScratch(TLVWriter& scratchWriter, uint8_t *scratchBuf, uint32_t scratchLen)
+{
+    if (IsContainerOpen())
+        return WEAVE_ERROR_TLV_CONTAINER_OPEN;
+
+    scratchWriter.Init(scratchBuf, scratchLen);
+    scratchWriter.mContainerType = mContainerType;
+    scratchWriter.SetCloseContainerReserved(IsCloseContainerReserved());
+    scratchWriter.ImplicitProfileId = ImplicitProfileId;
+    scratchWriter.ProfileDictionary = ProfileDictionary;
+    scratchWriter.AppData = AppData;
+
+    return WEAVE_NO_ERROR;
+}
+
+/**
+ * Adds the elements encoded by a scratch writer to the current writer.
+ *
+ * The CommitScratch() method copies the encoding produced by a scratch writer initialized with
+ * OpenScratch() to the current position of this writer.  If the encoding does not fit within the
+ * remaining space of this writer, nothing is written and #WEAVE_ERROR_BUFFER_TOO_SMALL is returned.
+ * When this writer has a GetNewBuffer function, the remaining space is only known as the limit
+ * given when the writer was initialized, and an allocation failure while copying can leave a
+ * partial encoding, just as with any other write.
+ *
+ * After a successful commit, the scratch writer may continue to be used; its contents are not
+ * changed.
+ *
+ * @param[in] scratchWriter     A reference to the TLVWriter object that was supplied to the
+ *                              OpenScratch() method.
+ *
+ * @retval #WEAVE_NO_ERROR      If the method succeeded.
+ * @retval #WEAVE_ERROR_INCORRECT_STATE
+ *                              If the scratch writer does not hold a single contiguous encoding
+ *                              written at the same container level as this writer.
+ * @retval #WEAVE_ERROR_TLV_CONTAINER_OPEN
+ *                              If a container writer has been opened on either writer and not
+ *                              yet closed.
+ * @retval #WEAVE_ERROR_BUFFER_TOO_SMALL
+ *                              If the encoding would not fit within the remaining space of this
+ *                              writer.
+ * @retval #WEAVE_ERROR_NO_MEMORY
+ *                              If an attempt to allocate an output buffer failed due to lack of
+ *                              memory.
+ * @retval other                Other Weave or platform-specific errors returned by the configured
+ *                              GetNewBuffer() or FinalizeBuffer() functions.
+ *
+ */
+WEAVE_ERROR TLVWriter::CommitScratch(TLVWriter& scratchWriter)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    const uint32_t len = scratchWriter.mLenWritten;
+
+    VerifyOrExit(!IsContainerOpen() && !scratchWriter.IsContainerOpen(), err = WEAVE_ERROR_TLV_CONTAINER_OPEN);
+
+    // The scratch encoding must still be in the single buffer given to OpenScratch().
+    VerifyOrExit(scratchWriter.mContainerType == mContainerType, err = WEAVE_ERROR_INCORRECT_STATE);
+    VerifyOrExit(scratchWriter.mBufHandle == 0 && (uint32_t) (scratchWriter.mWritePoint - scratchWriter.mBufStart) == len,
+                 err = WEAVE_ERROR_INCORRECT_STATE);
+
+    VerifyOrExit(len <= mMaxLen - mLenWritten, err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+    VerifyOrExit(GetNewBuffer != NULL || len <= mRemainingLen, err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+    err = WriteData(scratchWriter.mBufStart, len);
+
+exit:
+    return err;
+}
+
 /**
  * Begins encoding a new TLV container element.
  *
@@ -1751,6 +1941,24 @@ TLVType TLVWriter::GetContainerType() const
     return mContainerType;
 }
 
+/**
+ * This is a private method that returns the position of a profile within the writer's profile
+ * dictionary, or -1 if the writer has no dictionary or the profile is not listed in it.
+ */
+int TLVWriter::FindDictionaryProfile(uint32_t profileId) const
+{
+    if (ProfileDictionary != NULL)
+    {
+        for (uint16_t i = 0; i < ProfileDictionary->NumProfiles && i < TLVProfileDictionary::kMaxProfiles; i++)
+        {
+            if (ProfileDictionary->ProfileIds[i] == profileId)
+                return i;
+        }
+    }
+
+    return -1;
+}
+
 WEAVE_ERROR TLVWriter::WriteElementHead(TLVElementType elemType, uint64_t tag, uint64_t lenOrVal)
 {
     uint8_t *p;
@@ -1788,6 +1996,7 @@ WEAVE_ERROR TLVWriter::WriteElementHead(TLVElementType elemType, uint64_t tag, u
     else
     {
         uint32_t profileId = ProfileIdFromTag(tag);
+        int dictIndex;
 
         if (mContainerType != kTLVType_NotSpecified && mContainerType != kTLVType_Structure
                 && mContainerType != kTLVType_Path)
@@ -1806,7 +2015,7 @@ WEAVE_ERROR TLVWriter::WriteElementHead(TLVElementType elemType, uint64_t tag, u
                 LittleEndian::Write32(p, tagNum);
             }
         }
-        else if (profileId == ImplicitProfileId)
+        else if (profileId == ImplicitProfileId && (tagNum < 65536 || ProfileDictionary == NULL))
         {
             if (tagNum < 65536)
             {
@@ -1819,6 +2028,12 @@ WEAVE_ERROR TLVWriter::WriteElementHead(TLVElementType elemType, uint64_t tag, u
                 LittleEndian::Write32(p, tagNum);
             }
         }
+        else if ((dictIndex = FindDictionaryProfile(profileId)) >= 0 && tagNum <= TLVProfileDictionary::kMaxTagNum)
+        {
+            // With a profile dictionary, the 4-byte implicit form refers to a dictionary entry.
+            Write8(p, kTLVTagControl_ImplicitProfile_4Bytes | elemType);
+            LittleEndian::Write32(p, ((uint32_t) dictIndex << 24) | tagNum);
+        }
         else
         {
             uint16_t vendorId = (uint16_t) (profileId >> 16);
@@ -1889,6 +2104,37 @@ WEAVE_ERROR TLVWriter::WriteElementWithData(TLVType type, uint64_t tag, const ui
     return WriteData(data, dataLen);
 }
 
+WEAVE_ERROR TLVWriter::WriteElementWithData(TLVType type, uint64_t tag, const TLVDataSegment *segments, uint32_t numSegments)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    TLVFieldSize lenFieldSize;
+    uint64_t dataLen = 0;
+
+    for (uint32_t i = 0; i < numSegments; i++)
+        dataLen += segments[i].Len;
+
+    VerifyOrExit(dataLen <= UINT32_MAX, err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    if (dataLen <= UINT8_MAX)
+        lenFieldSize = kTLVFieldSize_1Byte;
+    else if (dataLen <= UINT16_MAX)
+        lenFieldSize = kTLVFieldSize_2Byte;
+    else
+        lenFieldSize = kTLVFieldSize_4Byte;
+
+    err = WriteElementHead((TLVElementType) (type | lenFieldSize), tag, dataLen);
+    SuccessOrExit(err);
+
+    for (uint32_t i = 0; i < numSegments; i++)
+    {
+        err = WriteData(segments[i].Data, segments[i].Len);
+        SuccessOrExit(err);
+    }
+
+exit:
+    return err;
+}
+
 WEAVE_ERROR TLVWriter::WriteData(const uint8_t *p, uint32_t len)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
@@ -2018,6 +2264,37 @@ WEAVE_ERROR TLVWriter::FinalizePacketBuffer(TLVWriter& writer, uintptr_t bufHand
     return WEAVE_NO_ERROR;
 }
 
+/**
+ * Initializes a TLVSizer object to measure an encoding.
+ *
+ * @param[in]   maxLen  The maximum number of bytes that may be measured.  Writes that would take
+ *                      the encoding beyond this length fail with #WEAVE_ERROR_BUFFER_TOO_SMALL,
+ *                      exactly as they would on a TLVWriter initialized with the same limit.
+ *
+ */
+void TLVSizer::Init(uint32_t maxLen)
+{
+    TLVWriter::Init(mDiscardBuf, maxLen);
+
+    mBufHandle = (uintptr_t) mDiscardBuf;
+    if (mRemainingLen > kDiscardBufSize)
+        mRemainingLen = kDiscardBufSize;
+
+    GetNewBuffer = GetDiscardBuffer;
+}
+
+/**
+ * A TLVWriter GetNewBuffer function that hands the sizer's discard buffer back to the writer each
+ * time it fills, so that the encoding is counted but never stored.
+ */
+WEAVE_ERROR TLVSizer::GetDiscardBuffer(TLVWriter& writer, uintptr_t& bufHandle, uint8_t *& bufStart, uint32_t& bufLen)
+{
+    bufStart = (uint8_t *) bufHandle;
+    bufLen = kDiscardBufSize;
+
+    return WEAVE_NO_ERROR;
+}
+
 } // namespace TLV
 } // namespace Weave
 } // namespace nl
@@ -102,6 +102,127 @@ namespace Weave {
 #endif // PBUF_POOL_SIZE
 #endif // WEAVE_CONFIG_WRMP_RETRANS_TABLE_SIZE
 
+/**
+ *  @def WEAVE_CONFIG_WRMP_RETRANS_WHEEL_SIZE
+ *
+ *  @brief
+ *    The number of slots in the WRMP retransmission timer wheel.
+ *
+ *  Retransmission table entries are hashed into wheel slots by the
+ *  WRMP tick at which they are next due, so that each timer tick only
+ *  visits the entries that are due on that tick.  Entries due further
+ *  out than the wheel span share slots with nearer entries and are
+ *  skipped until their tick comes around.  The value must be a power
+ *  of two.
+ *
+ */
+#ifndef WEAVE_CONFIG_WRMP_RETRANS_WHEEL_SIZE
+#define WEAVE_CONFIG_WRMP_RETRANS_WHEEL_SIZE                (64)
+#endif // WEAVE_CONFIG_WRMP_RETRANS_WHEEL_SIZE
+
+#if (WEAVE_CONFIG_WRMP_RETRANS_WHEEL_SIZE & (WEAVE_CONFIG_WRMP_RETRANS_WHEEL_SIZE - 1)) != 0
+#error "WEAVE_CONFIG_WRMP_RETRANS_WHEEL_SIZE must be a power of two"
+#endif
+
+/**
+ *  @def WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE
+ *
+ *  @brief
+ *    The number of peer nodes for which WRMP keeps round-trip time
+ *    estimates.
+ *
+ *  Round-trip times are sampled from acknowledgments of messages that
+ *  were not retransmitted (Karn's algorithm) and smoothed per peer node.
+ *  Estimates are keyed by node identifier alone, and so are shared by all
+ *  paths to a peer, whatever their transport or interface.
+ *  When the table is full, the least recently updated peer is evicted.
+ *  A value of (0) disables round-trip time estimation.
+ *
+ */
+#ifndef WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE
+#define WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE                    (16)
+#endif // WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE
+
+/**
+ *  @def WEAVE_CONFIG_WRMP_MIN_RETRANS_TIMEOUT
+ *
+ *  @brief
+ *    The lower bound, in milliseconds, of a retransmission timeout
+ *    derived from measured round-trip times.
+ *
+ */
+#ifndef WEAVE_CONFIG_WRMP_MIN_RETRANS_TIMEOUT
+#define WEAVE_CONFIG_WRMP_MIN_RETRANS_TIMEOUT               (2 * WEAVE_CONFIG_WRMP_TIMER_DEFAULT_PERIOD)
+#endif // WEAVE_CONFIG_WRMP_MIN_RETRANS_TIMEOUT
+
+/**
+ *  @def WEAVE_CONFIG_WRMP_MAX_RETRANS_TIMEOUT
+ *
+ *  @brief
+ *    The upper bound, in milliseconds, of a retransmission timeout
+ *    derived from measured round-trip times, including exponential
+ *    backoff.
+ *
+ */
+#ifndef WEAVE_CONFIG_WRMP_MAX_RETRANS_TIMEOUT
+#define WEAVE_CONFIG_WRMP_MAX_RETRANS_TIMEOUT               (30000)
+#endif // WEAVE_CONFIG_WRMP_MAX_RETRANS_TIMEOUT
+
+/**
+ *  @def WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW
+ *
+ *  @brief
+ *    The largest WRMP send window, in messages, that may be configured on
+ *    an exchange.
+ *
+ *  The value also bounds the number of acknowledgments an exchange
+ *  accumulates before they are sent together in a Selective Ack message,
+ *  and how far ahead of the next expected message a sequenced message
+ *  may arrive and still be held for in-order delivery.
+ *
+ */
+#ifndef WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW
+#define WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW                   (8)
+#endif // WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW
+
+/**
+ *  @def WEAVE_CONFIG_WRMP_REORDER_POOL_SIZE
+ *
+ *  @brief
+ *    The number of out-of-order messages, across all exchanges, that WRMP
+ *    holds back until the messages preceding them have been received.
+ *
+ *  A sequenced message that arrives while the pool is full is dropped
+ *  without being acknowledged, so that the sender retransmits it later.
+ *
+ */
+#ifndef WEAVE_CONFIG_WRMP_REORDER_POOL_SIZE
+#define WEAVE_CONFIG_WRMP_REORDER_POOL_SIZE                 (8)
+#endif // WEAVE_CONFIG_WRMP_REORDER_POOL_SIZE
+
+/**
+ *  @def WEAVE_CONFIG_WRMP_MAX_ACK_LIST_ENTRIES
+ *
+ *  @brief
+ *    The maximum number of acknowledgments carried in the payload of a WRMP
+ *    Ack List message.
+ *
+ *  When the acknowledgment timeout of an exchange expires, the pending
+ *  acknowledgments of other exchanges with the same peer, transport and
+ *  key are sent along with its own in a single Ack List message rather
+ *  than in one solitary ack message per exchange.  A value of (0), the
+ *  default, disables this coalescing.
+ *
+ *  Nodes that predate the Ack List message ignore it, and so retransmit
+ *  the messages it acknowledges until they give up.  Coalescing should
+ *  only be enabled where every peer is known to process Ack List messages;
+ *  received Ack List messages are processed regardless of this setting.
+ *
+ */
+#ifndef WEAVE_CONFIG_WRMP_MAX_ACK_LIST_ENTRIES
+#define WEAVE_CONFIG_WRMP_MAX_ACK_LIST_ENTRIES              (0)
+#endif // WEAVE_CONFIG_WRMP_MAX_ACK_LIST_ENTRIES
+
 /**
  *  @def WEAVE_CONFIG_WRMP_DEFAULT_MAX_RETRANS
  *
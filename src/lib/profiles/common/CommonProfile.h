@@ -51,7 +51,9 @@ enum
 
     //Reliable Messaging Protocol Message Types
     kMsgType_WRMP_Delayed_Delivery    = 3,
-    kMsgType_WRMP_Throttle_Flow       = 4
+    kMsgType_WRMP_Throttle_Flow       = 4,
+    kMsgType_WRMP_Selective_Ack       = 5,
+    kMsgType_WRMP_Ack_List            = 6
 };
 
 /**
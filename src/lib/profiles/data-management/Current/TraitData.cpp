@@ -1159,8 +1159,12 @@ WEAVE_ERROR TraitDataSink::StoreDataElement(PropertyPathHandle aHandle, TLVReade
             err = parser.GetData(&aReader);
             SuccessOrExit(err);
 
-            UpdateDirtyPathFilter pathFilter(GetSubscriptionClient(), aDatahandle, mSchemaEngine);
-            err = mSchemaEngine->StoreData(aHandle, aReader, this, &pathFilter);
+            err = StoreStructData(aHandle, aReader);
+            if (err == WEAVE_ERROR_NOT_IMPLEMENTED)
+            {
+                UpdateDirtyPathFilter pathFilter(GetSubscriptionClient(), aDatahandle, mSchemaEngine);
+                err = mSchemaEngine->StoreData(aHandle, aReader, this, &pathFilter);
+            }
         }
 
         OnEvent(kEventDataElementEnd, NULL);
@@ -1353,7 +1357,11 @@ WEAVE_ERROR TraitDataSource::ReadData(PropertyPathHandle aHandle, uint64_t aTagT
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
     Lock();
-    err = mSchemaEngine->RetrieveData(aHandle, aTagToWrite, aWriter, this);
+    err = ReadStructData(aHandle, aTagToWrite, aWriter);
+    if (err == WEAVE_ERROR_NOT_IMPLEMENTED)
+    {
+        err = mSchemaEngine->RetrieveData(aHandle, aTagToWrite, aWriter, this);
+    }
     Unlock();
 
     return err;
@@ -749,6 +749,16 @@ protected: // ISetDataDelegate
      */
     virtual WEAVE_ERROR SetData(PropertyPathHandle aHandle, nl::Weave::TLV::TLVReader & aReader, bool aIsNull) __OVERRIDE;
 
+    /*
+     * Invoked by StoreDataElement with a reader positioned on the data for aHandle. Sinks that can decode that data directly
+     * (e.g. TraitStructDataSink) override this to bypass the schema walk and the per-leaf SetLeafData calls. Returning
+     * WEAVE_ERROR_NOT_IMPLEMENTED, without having consumed anything from the reader, falls back to TraitSchemaEngine::StoreData.
+     */
+    virtual WEAVE_ERROR StoreStructData(PropertyPathHandle aHandle, nl::Weave::TLV::TLVReader & aReader)
+    {
+        return WEAVE_ERROR_NOT_IMPLEMENTED;
+    }
+
     /* Subclass can invoke this if they desire to reject a particular data change */
     void RejectChange(uint16_t aRejectionStatusCode);
 
@@ -957,6 +967,16 @@ protected: // IGetDataDelegate
     }
 #endif
 
+    /*
+     * Invoked by ReadData with the source locked. Sources that can encode the data for aHandle directly (e.g.
+     * TraitStructDataSource) override this to bypass the schema walk and the per-leaf GetLeafData calls. Returning
+     * WEAVE_ERROR_NOT_IMPLEMENTED, without having written anything, falls back to TraitSchemaEngine::RetrieveData.
+     */
+    virtual WEAVE_ERROR ReadStructData(PropertyPathHandle aHandle, uint64_t aTagToWrite, nl::Weave::TLV::TLVWriter & aWriter)
+    {
+        return WEAVE_ERROR_NOT_IMPLEMENTED;
+    }
+
     // Increment current version of the data in this source.
     void IncrementVersion(void);
     // Controls whether mVersion is incremented automatically or not.
@@ -0,0 +1,403 @@
+/*
+ *
+ *    Copyright (c) 2019 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file defines compile-time TLV codecs for traits whose schema is a flat structure of scalar leaf properties,
+ *      along with data source and data sink base classes that use them.
+ *
+ *      A codec is described by a list of fields, each of which binds a member of an application struct to a property
+ *      handle and context tag of the trait schema:
+ *
+ *      @code
+ *      struct VolumeState
+ *      {
+ *          uint8_t volume;
+ *          bool mute;
+ *      };
+ *
+ *      typedef TraitStructCodec<VolumeState,
+ *          TraitStructFields<TraitStructField<VolumeState, uint8_t, &VolumeState::volume, BasicVolumeTrait::kPropertyHandle_Volume, 1>,
+ *          TraitStructFields<TraitStructField<VolumeState, bool, &VolumeState::mute, BasicVolumeTrait::kPropertyHandle_Mute, 2> > > >
+ *          VolumeCodec;
+ *
+ *      class VolumeSource : public TraitStructDataSource<VolumeCodec> { ... };
+ *      @endcode
+ *
+ *      Since the field list is a type, the compiler expands encoding and decoding of the whole struct into straight-line
+ *      code, with no per-leaf virtual calls and no walks of the schema handle tables.  Anything the codec cannot
+ *      express (paths below the root, or a schema with nested structures, dictionaries, or nullable, optional or
+ *      ephemeral properties) is handled by the generic TraitSchemaEngine.
+ *
+ */
+
+#ifndef _WEAVE_DATA_MANAGEMENT_TRAIT_STRUCT_CODEC_CURRENT_H
+#define _WEAVE_DATA_MANAGEMENT_TRAIT_STRUCT_CODEC_CURRENT_H
+
+#include <Weave/Profiles/data-management/Current/WdmManagedNamespace.h>
+
+#include <Weave/Core/WeaveCore.h>
+#include <Weave/Core/WeaveTLV.h>
+#include <Weave/Support/CodeUtils.h>
+#include <Weave/Profiles/data-management/TraitData.h>
+
+namespace nl {
+namespace Weave {
+namespace Profiles {
+namespace WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current) {
+
+/**
+ *  TLV accessors for the C++ type backing a leaf property.  The generic version covers the integer and floating point
+ *  types supported by TLVReader::Get() and TLVWriter::Put().
+ */
+template <typename ValueType>
+struct TraitLeafTLV
+{
+    static WEAVE_ERROR Put(nl::Weave::TLV::TLVWriter & aWriter, uint64_t aTag, ValueType aValue) { return aWriter.Put(aTag, aValue); }
+    static WEAVE_ERROR Get(nl::Weave::TLV::TLVReader & aReader, ValueType & aValue) { return aReader.Get(aValue); }
+};
+
+template <>
+struct TraitLeafTLV<bool>
+{
+    static WEAVE_ERROR Put(nl::Weave::TLV::TLVWriter & aWriter, uint64_t aTag, bool aValue) { return aWriter.PutBoolean(aTag, aValue); }
+    static WEAVE_ERROR Get(nl::Weave::TLV::TLVReader & aReader, bool & aValue) { return aReader.Get(aValue); }
+};
+
+template <>
+struct TraitLeafTLV<float>
+{
+    static WEAVE_ERROR Put(nl::Weave::TLV::TLVWriter & aWriter, uint64_t aTag, float aValue) { return aWriter.Put(aTag, aValue); }
+
+    // TLVReader only provides Get(double&), which accepts both floating point encodings.
+    static WEAVE_ERROR Get(nl::Weave::TLV::TLVReader & aReader, float & aValue)
+    {
+        double value;
+        WEAVE_ERROR err = aReader.Get(value);
+
+        if (err == WEAVE_NO_ERROR)
+        {
+            aValue = static_cast<float>(value);
+        }
+
+        return err;
+    }
+};
+
+/**
+ *  Binds the member @p Member of @p StructType to the leaf property with handle @p Handle and context tag @p Tag.
+ */
+template <typename StructType, typename FieldType, FieldType StructType::*Member, PropertySchemaHandle Handle, uint8_t Tag>
+struct TraitStructField
+{
+    enum
+    {
+        kHandle     = Handle,
+        kContextTag = Tag
+    };
+
+    static WEAVE_ERROR Encode(nl::Weave::TLV::TLVWriter & aWriter, uint64_t aTagToWrite, const StructType & aStruct)
+    {
+        return TraitLeafTLV<FieldType>::Put(aWriter, aTagToWrite, aStruct.*Member);
+    }
+
+    static WEAVE_ERROR Decode(nl::Weave::TLV::TLVReader & aReader, StructType & aStruct)
+    {
+        return TraitLeafTLV<FieldType>::Get(aReader, aStruct.*Member);
+    }
+
+    static bool IsCompatible(const TraitSchemaEngine & aEngine)
+    {
+        return (Handle >= TraitSchemaEngine::kHandleTableOffset) &&
+            (Handle < TraitSchemaEngine::kHandleTableOffset + aEngine.mSchema.mNumSchemaHandleEntries) &&
+            aEngine.GetParent(Handle) == kRootPropertyPathHandle && aEngine.GetMap(Handle)->mContextTag == Tag &&
+            aEngine.IsLeaf(Handle) && !aEngine.IsNullable(Handle) && !aEngine.IsOptional(Handle) && !aEngine.IsEphemeral(Handle);
+    }
+};
+
+/**
+ *  Terminates a TraitStructFields list.
+ */
+struct TraitStructFieldsEnd
+{
+    enum
+    {
+        kFieldCount = 0
+    };
+
+    template <typename StructType>
+    static WEAVE_ERROR EncodeFields(nl::Weave::TLV::TLVWriter & aWriter, const StructType & aStruct)
+    {
+        return WEAVE_NO_ERROR;
+    }
+
+    template <typename StructType>
+    static WEAVE_ERROR EncodeField(PropertyPathHandle aHandle, uint64_t aTagToWrite, nl::Weave::TLV::TLVWriter & aWriter,
+                                   const StructType & aStruct)
+    {
+        return WEAVE_ERROR_TLV_TAG_NOT_FOUND;
+    }
+
+    template <typename StructType>
+    static WEAVE_ERROR DecodeFieldByTag(uint8_t aContextTag, nl::Weave::TLV::TLVReader & aReader, StructType & aStruct)
+    {
+        return WEAVE_ERROR_TLV_TAG_NOT_FOUND;
+    }
+
+    template <typename StructType>
+    static WEAVE_ERROR DecodeFieldByHandle(PropertyPathHandle aHandle, nl::Weave::TLV::TLVReader & aReader, StructType & aStruct)
+    {
+        return WEAVE_ERROR_TLV_TAG_NOT_FOUND;
+    }
+
+    static bool IsCompatible(const TraitSchemaEngine & aEngine) { return true; }
+};
+
+/**
+ *  A compile-time list of TraitStructField types, built as a chain of TraitStructFields<Field, Next>
+ *  ending in TraitStructFieldsEnd.
+ */
+template <typename Field, typename Next = TraitStructFieldsEnd>
+struct TraitStructFields
+{
+    enum
+    {
+        kFieldCount = 1 + Next::kFieldCount
+    };
+
+    template <typename StructType>
+    static WEAVE_ERROR EncodeFields(nl::Weave::TLV::TLVWriter & aWriter, const StructType & aStruct)
+    {
+        WEAVE_ERROR err = Field::Encode(aWriter, nl::Weave::TLV::ContextTag(Field::kContextTag), aStruct);
+        if (err != WEAVE_NO_ERROR)
+            return err;
+        return Next::EncodeFields(aWriter, aStruct);
+    }
+
+    template <typename StructType>
+    static WEAVE_ERROR EncodeField(PropertyPathHandle aHandle, uint64_t aTagToWrite, nl::Weave::TLV::TLVWriter & aWriter,
+                                   const StructType & aStruct)
+    {
+        if (aHandle == static_cast<PropertyPathHandle>(Field::kHandle))
+            return Field::Encode(aWriter, aTagToWrite, aStruct);
+        return Next::EncodeField(aHandle, aTagToWrite, aWriter, aStruct);
+    }
+
+    template <typename StructType>
+    static WEAVE_ERROR DecodeFieldByTag(uint8_t aContextTag, nl::Weave::TLV::TLVReader & aReader, StructType & aStruct)
+    {
+        if (aContextTag == Field::kContextTag)
+            return Field::Decode(aReader, aStruct);
+        return Next::DecodeFieldByTag(aContextTag, aReader, aStruct);
+    }
+
+    template <typename StructType>
+    static WEAVE_ERROR DecodeFieldByHandle(PropertyPathHandle aHandle, nl::Weave::TLV::TLVReader & aReader, StructType & aStruct)
+    {
+        if (aHandle == static_cast<PropertyPathHandle>(Field::kHandle))
+            return Field::Decode(aReader, aStruct);
+        return Next::DecodeFieldByHandle(aHandle, aReader, aStruct);
+    }
+
+    static bool IsCompatible(const TraitSchemaEngine & aEngine) { return Field::IsCompatible(aEngine) && Next::IsCompatible(aEngine); }
+};
+
+/**
+ *  Encodes and decodes a @p StructType as the root structure of a trait instance, using the fields in @p FieldList.
+ */
+template <typename StructType_, typename FieldList>
+struct TraitStructCodec
+{
+    typedef StructType_ StructType;
+
+    /**
+     * Returns true if @p aEngine describes exactly the fields of this codec: every schema handle is one of the codec's
+     * fields, a direct child of the root with the expected context tag, and neither nullable, optional nor ephemeral.
+     */
+    static bool IsCompatible(const TraitSchemaEngine & aEngine)
+    {
+        return aEngine.mSchema.mNumSchemaHandleEntries == static_cast<uint32_t>(FieldList::kFieldCount) &&
+            FieldList::IsCompatible(aEngine);
+    }
+
+    /**
+     * Writes @p aStruct as a structure with tag @p aTagToWrite.
+     */
+    static WEAVE_ERROR Encode(uint64_t aTagToWrite, nl::Weave::TLV::TLVWriter & aWriter, const StructType & aStruct)
+    {
+        WEAVE_ERROR err;
+        nl::Weave::TLV::TLVType containerType;
+
+        err = aWriter.StartContainer(aTagToWrite, nl::Weave::TLV::kTLVType_Structure, containerType);
+        SuccessOrExit(err);
+
+        err = FieldList::EncodeFields(aWriter, aStruct);
+        SuccessOrExit(err);
+
+        err = aWriter.EndContainer(containerType);
+
+    exit:
+        return err;
+    }
+
+    /**
+     * Reads the structure the reader is positioned on into @p aStruct.  Members whose tags are absent from the
+     * encoding are left unchanged.
+     */
+    static WEAVE_ERROR Decode(nl::Weave::TLV::TLVReader & aReader, StructType & aStruct)
+    {
+        WEAVE_ERROR err;
+        nl::Weave::TLV::TLVType containerType;
+
+        err = aReader.EnterContainer(containerType);
+        SuccessOrExit(err);
+
+        while ((err = aReader.Next()) == WEAVE_NO_ERROR)
+        {
+            const uint64_t tag = aReader.GetTag();
+
+            VerifyOrExit(nl::Weave::TLV::IsContextTag(tag), err = WEAVE_ERROR_INVALID_TLV_TAG);
+
+            err = FieldList::DecodeFieldByTag(static_cast<uint8_t>(nl::Weave::TLV::TagNumFromTag(tag)), aReader, aStruct);
+#if TDM_DISABLE_STRICT_SCHEMA_COMPLIANCE
+            if (err == WEAVE_ERROR_TLV_TAG_NOT_FOUND)
+            {
+                err = WEAVE_NO_ERROR;
+            }
+#endif
+            SuccessOrExit(err);
+        }
+
+        VerifyOrExit(err == WEAVE_END_OF_TLV, );
+
+        err = aReader.ExitContainer(containerType);
+
+    exit:
+        return err;
+    }
+
+    /**
+     * Writes the leaf member with property handle @p aHandle.
+     */
+    static WEAVE_ERROR EncodeLeaf(PropertyPathHandle aHandle, uint64_t aTagToWrite, nl::Weave::TLV::TLVWriter & aWriter,
+                                  const StructType & aStruct)
+    {
+        return FieldList::EncodeField(aHandle, aTagToWrite, aWriter, aStruct);
+    }
+
+    /**
+     * Reads the leaf member with property handle @p aHandle.
+     */
+    static WEAVE_ERROR DecodeLeaf(PropertyPathHandle aHandle, nl::Weave::TLV::TLVReader & aReader, StructType & aStruct)
+    {
+        return FieldList::DecodeFieldByHandle(aHandle, aReader, aStruct);
+    }
+};
+
+/*
+ * @class  TraitStructDataSource
+ *
+ * @brief  A data source that publishes a trait instance held in a struct described by @p CodecType.  Reads of the whole
+ *         instance are encoded by the codec; reads of individual leaves go through the schema engine and are answered
+ *         from the same struct.  If the schema turns out not to match the codec, everything goes through the schema engine.
+ */
+template <typename CodecType>
+class TraitStructDataSource : public TraitDataSource
+{
+public:
+    typedef typename CodecType::StructType StructType;
+
+    TraitStructDataSource(const TraitSchemaEngine * aEngine) :
+        TraitDataSource(aEngine), mData(), mUseCodec(CodecType::IsCompatible(*aEngine))
+    { }
+
+protected:
+    virtual WEAVE_ERROR ReadStructData(PropertyPathHandle aHandle, uint64_t aTagToWrite, nl::Weave::TLV::TLVWriter & aWriter) __OVERRIDE
+    {
+        if (!mUseCodec || aHandle != kRootPropertyPathHandle)
+        {
+            return WEAVE_ERROR_NOT_IMPLEMENTED;
+        }
+
+        return CodecType::Encode(aTagToWrite, aWriter, mData);
+    }
+
+    virtual WEAVE_ERROR GetLeafData(PropertyPathHandle aLeafHandle, uint64_t aTagToWrite, nl::Weave::TLV::TLVWriter & aWriter) __OVERRIDE
+    {
+        return CodecType::EncodeLeaf(aLeafHandle, aTagToWrite, aWriter, mData);
+    }
+
+    StructType mData;
+
+private:
+    bool mUseCodec;
+};
+
+/*
+ * @class  TraitStructDataSink
+ *
+ * @brief  A data sink that stores a trait instance into a struct described by @p CodecType.  Data elements that replace
+ *         the whole instance are decoded by the codec, after which the sink sees only the usual data element events;
+ *         anything else goes through the schema engine, with SetLeafData writing into the same struct.
+ */
+template <typename CodecType>
+class TraitStructDataSink : public TraitDataSink
+{
+public:
+    typedef typename CodecType::StructType StructType;
+
+    TraitStructDataSink(const TraitSchemaEngine * aEngine) :
+        TraitDataSink(aEngine), mData(), mUseCodec(CodecType::IsCompatible(*aEngine))
+    { }
+
+protected:
+    virtual WEAVE_ERROR StoreStructData(PropertyPathHandle aHandle, nl::Weave::TLV::TLVReader & aReader) __OVERRIDE
+    {
+        // Sinks with pending updates filter incoming paths against their dirty set, which only the schema engine does.
+        if (!mUseCodec || aHandle != kRootPropertyPathHandle || GetSubscriptionClient() != NULL)
+        {
+            return WEAVE_ERROR_NOT_IMPLEMENTED;
+        }
+
+        return CodecType::Decode(aReader, mData);
+    }
+
+    virtual WEAVE_ERROR SetLeafData(PropertyPathHandle aLeafHandle, nl::Weave::TLV::TLVReader & aReader) __OVERRIDE
+    {
+        WEAVE_ERROR err = CodecType::DecodeLeaf(aLeafHandle, aReader, mData);
+
+        if (err == WEAVE_ERROR_TLV_TAG_NOT_FOUND)
+        {
+            err = HandleUnknownLeafHandle();
+        }
+
+        return err;
+    }
+
+    StructType mData;
+
+private:
+    bool mUseCodec;
+};
+
+} // namespace WeaveMakeManagedNamespaceIdentifier(DataManagement, kWeaveManagedNamespaceDesignation_Current)
+} // namespace Profiles
+} // namespace Weave
+} // namespace nl
+
+#endif // _WEAVE_DATA_MANAGEMENT_TRAIT_STRUCT_CODEC_CURRENT_H
@@ -340,6 +340,63 @@ exit:
     return err;
 }
 
+/**
+ * Returns the ID of the epoch key that follows the specified epoch key.
+ * The next epoch key is the key with the earliest start time that is later than the start
+ * time of the specified epoch key.
+ *
+ * @param[in]    epochKeyId      The epoch key ID, or an application key ID that incorporates
+ *                               an epoch key.
+ * @param[out]   nextEpochKeyId  The ID of the next epoch key.
+ * @param[out]   nextStartTime   The start time of the next epoch key.
+ *
+ * @retval #WEAVE_NO_ERROR       On success.
+ * @retval #WEAVE_ERROR_KEY_NOT_FOUND
+ *                               If the specified epoch key is not in the platform key store,
+ *                               or if no epoch key follows it.
+ * @retval other                 Other platform-specific errors returned by the platform
+ *                               key store APIs.
+ *
+ */
+WEAVE_ERROR GroupKeyStoreBase::GetNextEpochKeyId(uint32_t epochKeyId, uint32_t& nextEpochKeyId, uint32_t& nextStartTime)
+{
+    WEAVE_ERROR err;
+    uint32_t epochKeyIds[WEAVE_CONFIG_MAX_APPLICATION_EPOCH_KEYS];
+    uint8_t epochKeyCount;
+    uint32_t startTime;
+    WeaveGroupKey epochKey;
+
+    epochKeyId = WeaveKeyId::GetEpochKeyId(epochKeyId);
+    nextEpochKeyId = WeaveKeyId::kNone;
+    nextStartTime = UINT32_MAX;
+
+    err = RetrieveGroupKey(epochKeyId, epochKey);
+    SuccessOrExit(err);
+    startTime = epochKey.StartTime;
+
+    err = EnumerateGroupKeys(WeaveKeyId::kType_AppEpochKey, epochKeyIds, sizeof(epochKeyIds) / sizeof(uint32_t), epochKeyCount);
+    SuccessOrExit(err);
+
+    for (int i = 0; i < epochKeyCount; i++)
+    {
+        err = RetrieveGroupKey(epochKeyIds[i], epochKey);
+        SuccessOrExit(err);
+
+        if (epochKey.StartTime > startTime && (nextEpochKeyId == WeaveKeyId::kNone || epochKey.StartTime < nextStartTime))
+        {
+            nextEpochKeyId = epochKeyIds[i];
+            nextStartTime = epochKey.StartTime;
+        }
+    }
+
+    VerifyOrExit(nextEpochKeyId != WeaveKeyId::kNone, err = WEAVE_ERROR_KEY_NOT_FOUND);
+
+exit:
+    ClearSecretData(epochKey.Key, epochKey.MaxKeySize);
+
+    return err;
+}
+
 /**
  * Get application group key.
  * This function derives or retrieves application group keys. Key types supported by
@@ -137,6 +137,9 @@ public:
     // Get current application key Id.
     WEAVE_ERROR GetCurrentAppKeyId(uint32_t keyId, uint32_t& curKeyId);
 
+    // Get the epoch key that follows a given epoch key.
+    WEAVE_ERROR GetNextEpochKeyId(uint32_t epochKeyId, uint32_t& nextEpochKeyId, uint32_t& nextStartTime);
+
     // Get/Derive group key.
     WEAVE_ERROR GetGroupKey(uint32_t keyId, WeaveGroupKey& groupKey);
 
@@ -209,6 +209,53 @@ public:
 };
 
 
+/**
+ * Holds context information related to the generation or processing of the CASE ResumeSessionRequest
+ * and ResumeSessionResponse messages, which establish a new session from the resumption secret of an
+ * earlier one.
+ *
+ * The initiator proves possession of the secret with a MAC over its request, and the responder with a
+ * MAC over the request MAC and its own random value.  The keys of the new session are derived from the
+ * secret and the random values of both parties.
+ */
+class ResumeSessionContext
+{
+public:
+    enum
+    {
+        kRandomLength                           = 16,
+        kMACLength                              = SHA256::kHashLength,
+        kRequestLength                          = WeaveSessionResumption::kResumptionIdLength + 3 + kRandomLength + kMACLength,
+        kResponseLength                         = kRandomLength + kMACLength
+    };
+
+    uint8_t ResumptionId[WeaveSessionResumption::kResumptionIdLength];
+    uint8_t Secret[WeaveSessionResumption::kSecretLength];
+    uint8_t InitiatorRandom[kRandomLength];
+    uint8_t ResponderRandom[kRandomLength];
+    uint8_t RequestMAC[kMACLength];
+    WeaveEncryptionKey EncryptionKey;                   // [READ-ONLY] The key of the resumed session.
+    WeaveAuthMode AuthMode;                             // The means by which the peer was originally authenticated.
+    uint16_t SessionKeyId;
+    uint8_t EncryptionType;
+
+    void Reset(void);
+    void SetResumption(const WeaveSessionResumption & resumption);
+
+    WEAVE_ERROR GenerateRequest(PacketBuffer * msgBuf);
+    WEAVE_ERROR DecodeRequest(PacketBuffer * msgBuf);
+    WEAVE_ERROR GenerateResponse(PacketBuffer * msgBuf);
+    WEAVE_ERROR ProcessResponse(PacketBuffer * msgBuf);
+
+    static WEAVE_ERROR DeriveResumptionSecret(const WeaveEncryptionKey & sessionKey, uint8_t * resumptionId, uint8_t * secret);
+
+private:
+    void ComputeRequestMAC(uint8_t * mac);
+    void ComputeResponseMAC(uint8_t * mac);
+    WEAVE_ERROR DeriveSessionKey(void);
+};
+
+
 /**
  * Abstract interface to which authentication actions are delegated during CASE
  * session establishment.
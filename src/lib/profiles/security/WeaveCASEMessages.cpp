@@ -38,6 +38,9 @@
 #include <Weave/Profiles/security/WeavePrivateKey.h>
 #include <Weave/Support/crypto/HashAlgos.h>
 #include <Weave/Support/crypto/EllipticCurve.h>
+#include <Weave/Support/crypto/HKDF.h>
+#include <Weave/Support/crypto/HMAC.h>
+#include <Weave/Support/crypto/WeaveCrypto.h>
 #include <Weave/Support/CodeUtils.h>
 
 
@@ -338,6 +341,212 @@ exit:
     return err;
 }
 
+// Key diversifiers for the keys derived during session resumption.
+static const uint8_t kResumptionSecretInfo[] = { 'C', 'A', 'S', 'E', ' ', 'R', 'e', 's', 'u', 'm', 'p', 't', 'i', 'o', 'n' };
+static const uint8_t kResumedSessionKeyInfo[] = { 'C', 'A', 'S', 'E', ' ', 'R', 'e', 's', 'u', 'm', 'e', 'd', ' ', 'K', 'e', 'y' };
+
+void ResumeSessionContext::Reset(void)
+{
+    ClearSecretData((uint8_t *)this, sizeof(*this));
+    AuthMode = kWeaveAuthMode_NotSpecified;
+    SessionKeyId = WeaveKeyId::kNone;
+    EncryptionType = kWeaveEncryptionType_None;
+}
+
+// Take the resumption id, secret and peer auth mode from a cache entry.
+void ResumeSessionContext::SetResumption(const WeaveSessionResumption & resumption)
+{
+    memcpy(ResumptionId, resumption.ResumptionId, sizeof(ResumptionId));
+    memcpy(Secret, resumption.Secret, sizeof(Secret));
+    AuthMode = resumption.AuthMode;
+}
+
+// Encode a ResumeSessionRequest message.  The resumption, SessionKeyId and EncryptionType must have been set.
+WEAVE_ERROR ResumeSessionContext::GenerateRequest(PacketBuffer *msgBuf)
+{
+    WEAVE_ERROR err;
+    uint8_t *p = msgBuf->Start();
+
+    VerifyOrExit(msgBuf->AvailableDataLength() >= kRequestLength, err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+    err = Platform::Security::GetSecureRandomData(InitiatorRandom, kRandomLength);
+    SuccessOrExit(err);
+
+    ComputeRequestMAC(RequestMAC);
+
+    memcpy(p, ResumptionId, sizeof(ResumptionId));
+    p += sizeof(ResumptionId);
+    LittleEndian::Write16(p, SessionKeyId);
+    *p++ = EncryptionType;
+    memcpy(p, InitiatorRandom, kRandomLength);
+    p += kRandomLength;
+    memcpy(p, RequestMAC, kMACLength);
+
+    msgBuf->SetDataLength(kRequestLength);
+
+exit:
+    return err;
+}
+
+// Decode a ResumeSessionRequest message.  The request MAC is verified later, by GenerateResponse(), once
+// the secret named by the resumption id has been set.
+WEAVE_ERROR ResumeSessionContext::DecodeRequest(PacketBuffer *msgBuf)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    const uint8_t *p = msgBuf->Start();
+    uint16_t msgLen = msgBuf->DataLength();
+
+    VerifyOrExit(msgLen >= kRequestLength, err = WEAVE_ERROR_MESSAGE_INCOMPLETE);
+    VerifyOrExit(msgLen == kRequestLength, err = WEAVE_ERROR_MESSAGE_TOO_LONG);
+
+    memcpy(ResumptionId, p, sizeof(ResumptionId));
+    p += sizeof(ResumptionId);
+    SessionKeyId = LittleEndian::Read16(p);
+    EncryptionType = *p++;
+    memcpy(InitiatorRandom, p, kRandomLength);
+    p += kRandomLength;
+    memcpy(RequestMAC, p, kMACLength);
+
+exit:
+    return err;
+}
+
+// Verify the decoded request, derive the session key and encode a ResumeSessionResponse message.
+WEAVE_ERROR ResumeSessionContext::GenerateResponse(PacketBuffer *msgBuf)
+{
+    WEAVE_ERROR err;
+    uint8_t mac[kMACLength];
+    uint8_t *p = msgBuf->Start();
+
+    VerifyOrExit(msgBuf->AvailableDataLength() >= kResponseLength, err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+    // Verify that the initiator holds the resumption secret.
+    ComputeRequestMAC(mac);
+    VerifyOrExit(ConstantTimeCompare(mac, RequestMAC, kMACLength), err = WEAVE_ERROR_KEY_CONFIRMATION_FAILED);
+
+    // Only AES128CTRSHA1 keys supported for now.
+    VerifyOrExit(EncryptionType == kWeaveEncryptionType_AES128CTRSHA1, err = WEAVE_ERROR_UNSUPPORTED_ENCRYPTION_TYPE);
+
+    err = Platform::Security::GetSecureRandomData(ResponderRandom, kRandomLength);
+    SuccessOrExit(err);
+
+    err = DeriveSessionKey();
+    SuccessOrExit(err);
+
+    memcpy(p, ResponderRandom, kRandomLength);
+    p += kRandomLength;
+    ComputeResponseMAC(p);
+
+    msgBuf->SetDataLength(kResponseLength);
+
+exit:
+    return err;
+}
+
+// Decode and verify a ResumeSessionResponse message, and derive the session key.
+WEAVE_ERROR ResumeSessionContext::ProcessResponse(PacketBuffer *msgBuf)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    const uint8_t *p = msgBuf->Start();
+    uint16_t msgLen = msgBuf->DataLength();
+    uint8_t mac[kMACLength];
+
+    VerifyOrExit(msgLen >= kResponseLength, err = WEAVE_ERROR_MESSAGE_INCOMPLETE);
+    VerifyOrExit(msgLen == kResponseLength, err = WEAVE_ERROR_MESSAGE_TOO_LONG);
+
+    memcpy(ResponderRandom, p, kRandomLength);
+    p += kRandomLength;
+
+    // Verify that the responder holds the resumption secret.
+    ComputeResponseMAC(mac);
+    VerifyOrExit(ConstantTimeCompare(mac, p, kMACLength), err = WEAVE_ERROR_KEY_CONFIRMATION_FAILED);
+
+    err = DeriveSessionKey();
+    SuccessOrExit(err);
+
+exit:
+    return err;
+}
+
+/**
+ * Derive the resumption id and secret that allow a session to be resumed later.
+ *
+ * Both parties derive the same values from the key of the session once it is established.
+ *
+ * @param[in] sessionKey        The key of the established session.
+ * @param[out] resumptionId     A buffer of WeaveSessionResumption::kResumptionIdLength bytes.
+ * @param[out] secret           A buffer of WeaveSessionResumption::kSecretLength bytes.
+ */
+WEAVE_ERROR ResumeSessionContext::DeriveResumptionSecret(const WeaveEncryptionKey & sessionKey, uint8_t * resumptionId, uint8_t * secret)
+{
+    WEAVE_ERROR err;
+    uint8_t keyData[WeaveSessionResumption::kResumptionIdLength + WeaveSessionResumption::kSecretLength];
+
+    err = HKDFSHA256::DeriveKey(NULL, 0,
+                                sessionKey.AES128CTRSHA1.DataKey, WeaveEncryptionKey_AES128CTRSHA1::DataKeySize,
+                                sessionKey.AES128CTRSHA1.IntegrityKey, WeaveEncryptionKey_AES128CTRSHA1::IntegrityKeySize,
+                                kResumptionSecretInfo, sizeof(kResumptionSecretInfo),
+                                keyData, sizeof(keyData), sizeof(keyData));
+    SuccessOrExit(err);
+
+    memcpy(resumptionId, keyData, WeaveSessionResumption::kResumptionIdLength);
+    memcpy(secret, keyData + WeaveSessionResumption::kResumptionIdLength, WeaveSessionResumption::kSecretLength);
+
+exit:
+    ClearSecretData(keyData, sizeof(keyData));
+    return err;
+}
+
+void ResumeSessionContext::ComputeRequestMAC(uint8_t * mac)
+{
+    HMACSHA256 hmac;
+    uint8_t head[3];
+    uint8_t *p = head;
+
+    LittleEndian::Write16(p, SessionKeyId);
+    *p = EncryptionType;
+
+    hmac.Begin(Secret, sizeof(Secret));
+    hmac.AddData(ResumptionId, sizeof(ResumptionId));
+    hmac.AddData(head, sizeof(head));
+    hmac.AddData(InitiatorRandom, kRandomLength);
+    hmac.Finish(mac);
+}
+
+void ResumeSessionContext::ComputeResponseMAC(uint8_t * mac)
+{
+    HMACSHA256 hmac;
+
+    hmac.Begin(Secret, sizeof(Secret));
+    hmac.AddData(RequestMAC, kMACLength);
+    hmac.AddData(ResponderRandom, kRandomLength);
+    hmac.Finish(mac);
+}
+
+// Derive the key of the resumed session from the resumption secret and the random values of both parties.
+WEAVE_ERROR ResumeSessionContext::DeriveSessionKey(void)
+{
+    WEAVE_ERROR err;
+    uint8_t keySalt[2 * kRandomLength];
+    uint8_t keyData[WeaveEncryptionKey_AES128CTRSHA1::KeySize];
+
+    memcpy(keySalt, InitiatorRandom, kRandomLength);
+    memcpy(keySalt + kRandomLength, ResponderRandom, kRandomLength);
+
+    err = HKDFSHA256::DeriveKey(keySalt, sizeof(keySalt), Secret, sizeof(Secret), NULL, 0,
+                                kResumedSessionKeyInfo, sizeof(kResumedSessionKeyInfo),
+                                keyData, sizeof(keyData), sizeof(keyData));
+    SuccessOrExit(err);
+
+    memcpy(EncryptionKey.AES128CTRSHA1.DataKey, keyData, WeaveEncryptionKey_AES128CTRSHA1::DataKeySize);
+    memcpy(EncryptionKey.AES128CTRSHA1.IntegrityKey, keyData + WeaveEncryptionKey_AES128CTRSHA1::DataKeySize,
+           WeaveEncryptionKey_AES128CTRSHA1::IntegrityKeySize);
+
+exit:
+    ClearSecretData(keyData, sizeof(keyData));
+    return err;
+}
+
 
 } // namespace CASE
 } // namespace Security
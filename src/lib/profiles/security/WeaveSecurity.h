@@ -61,6 +61,8 @@ enum
     kMsgType_CASEBeginSessionResponse           = 11,
     kMsgType_CASEInitiatorKeyConfirm            = 12,
     kMsgType_CASEReconfigure                    = 13,
+    kMsgType_CASEResumeSessionRequest           = 14,
+    kMsgType_CASEResumeSessionResponse          = 15,
 
     // ---- TAKE Protocol Messages ----
     kMsgType_TAKEIdentifyToken                  = 20,
@@ -348,6 +350,10 @@ enum
     kTag_SerializedSession_ResumptionRecvMessageId      = 15, // [ UNSIGNED INT, range 32bits ] Next expected receive message id
                                                               //    for a session resumed after persistence.
     kTag_SerializedSession_IsUsedOverConnection         = 16, // [ BOOLEAN ] Is session used over a connection
+    kTag_SerializedSession_ExtendedMessageRcvdFlags     = 17, // [ UNSIGNED INT, range 64bits ] For a receive window wider than
+                                                              //    16 messages, the received flags of the messages prior to
+                                                              //    the max received message id (bit 0 for the one immediately
+                                                              //    prior).
 };
 
 // Weave-defined elliptic curve ids
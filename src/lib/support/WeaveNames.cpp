@@ -152,6 +152,8 @@ const char *GetMessageName(uint32_t profileId, uint8_t msgType)
         case Common::kMsgType_Null                                          : return "Null";
         case Common::kMsgType_WRMP_Delayed_Delivery                         : return "DelayedDelivery";
         case Common::kMsgType_WRMP_Throttle_Flow                            : return "ThrottleFlow";
+        case Common::kMsgType_WRMP_Selective_Ack                            : return "SelectiveAck";
+        case Common::kMsgType_WRMP_Ack_List                                 : return "AckList";
         }
         break;
     case kWeaveProfile_Echo:
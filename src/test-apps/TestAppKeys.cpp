@@ -408,6 +408,31 @@ void GetAppGroupMasterKeyId_Test(nlTestSuite *inSuite, void *inContext)
 }
 
 
+void GetNextEpochKeyId_Test(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err;
+    TestGroupKeyStore keyStore;
+    uint32_t nextEpochKeyId;
+    uint32_t nextStartTime;
+
+    // The next epoch key follows in order of start time.
+    err = keyStore.GetNextEpochKeyId(sEpochKey1_KeyId, nextEpochKeyId, nextStartTime);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, nextEpochKeyId == sEpochKey2_KeyId);
+    NL_TEST_ASSERT(inSuite, nextStartTime == sEpochKey2_StartTime);
+
+    // The epoch key of an application rotating key can be given.
+    err = keyStore.GetNextEpochKeyId(WeaveKeyId::UpdateEpochKeyId(sAppRotatingKeyId_SRK_E3_G54, sEpochKey2_KeyId),
+                                     nextEpochKeyId, nextStartTime);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, nextEpochKeyId == sEpochKey3_KeyId);
+    NL_TEST_ASSERT(inSuite, nextStartTime == sEpochKey3_StartTime);
+
+    // No epoch key follows the newest one.
+    err = keyStore.GetNextEpochKeyId(sEpochKey3_KeyId, nextEpochKeyId, nextStartTime);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_KEY_NOT_FOUND);
+}
+
 int main(int argc, char *argv[])
 {
     static const nlTest tests[] = {
@@ -417,6 +442,7 @@ int main(int argc, char *argv[])
         NL_TEST_DEF("DeriveAppRotatingKey",             DeriveAppRotatingKey_Test),
         NL_TEST_DEF("DerivePasscodeKeys",               DerivePasscodeKeys_Test),
         NL_TEST_DEF("GetAppGroupMasterKeyId",           GetAppGroupMasterKeyId_Test),
+        NL_TEST_DEF("GetNextEpochKeyId",                GetNextEpochKeyId_Test),
         NL_TEST_SENTINEL()
     };
 
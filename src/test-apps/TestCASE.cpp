@@ -1028,6 +1028,267 @@ void CASEEngineTests_FuzzTests()
 
 }
 
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+
+static const uint64_t sTestInitiatorNodeId = 0x18B4300000000001ULL;
+static const uint64_t sTestResponderNodeId = 0x18B4300000000002ULL;
+static const uint16_t sTestResumedSessionKeyId = WeaveKeyId::MakeSessionKeyId(43);
+
+// Leave both nodes with the resumption secret of a CASE session established between them.
+static void SetupResumption(WeaveFabricState& initiatorFS, WeaveFabricState& responderFS)
+{
+    WEAVE_ERROR err;
+    WeaveEncryptionKey sessionKey;
+    uint8_t resumptionId[WeaveSessionResumption::kResumptionIdLength];
+    uint8_t secret[WeaveSessionResumption::kSecretLength];
+
+    err = initiatorFS.Init();
+    SuccessOrQuit(err, "WeaveFabricState::Init() failed");
+    err = responderFS.Init();
+    SuccessOrQuit(err, "WeaveFabricState::Init() failed");
+
+    err = nl::Weave::Platform::Security::GetSecureRandomData((uint8_t *)&sessionKey, sizeof(sessionKey));
+    SuccessOrQuit(err, "GetSecureRandomData() failed");
+
+    err = ResumeSessionContext::DeriveResumptionSecret(sessionKey, resumptionId, secret);
+    SuccessOrQuit(err, "ResumeSessionContext::DeriveResumptionSecret() failed");
+
+    initiatorFS.SaveSessionResumption(sTestResponderNodeId, kWeaveAuthMode_CASE_Device, resumptionId, secret);
+    responderFS.SaveSessionResumption(sTestInitiatorNodeId, kWeaveAuthMode_CASE_Device, resumptionId, secret);
+}
+
+// Form a ResumeSessionRequest from the resumption secret held by the initiator, consuming the secret
+// as the security manager does.
+static void GenerateResumeRequest(WeaveFabricState& initiatorFS, ResumeSessionContext& initiatorCtx, PacketBuffer *& msgBuf)
+{
+    WEAVE_ERROR err;
+    WeaveSessionResumption *resumption;
+
+    printf("Initiator: Calling GenerateRequest\n");
+
+    resumption = initiatorFS.FindSessionResumption(sTestResponderNodeId);
+    VerifyOrQuit(resumption != NULL, "Initiator resumption secret not found");
+
+    initiatorCtx.Reset();
+    initiatorCtx.SetResumption(*resumption);
+    initiatorFS.RemoveSessionResumption(resumption);
+    initiatorCtx.SessionKeyId = sTestResumedSessionKeyId;
+    initiatorCtx.EncryptionType = kWeaveEncryptionType_AES128CTRSHA1;
+
+    msgBuf = PacketBuffer::New();
+    VerifyOrQuit(msgBuf != NULL, "PacketBuffer::New() failed");
+
+    err = initiatorCtx.GenerateRequest(msgBuf);
+    SuccessOrQuit(err, "ResumeSessionContext::GenerateRequest() failed");
+}
+
+// Process a ResumeSessionRequest from the given peer and form the ResumeSessionResponse, as the
+// security manager does.  The responder's resumption secret is only consumed if the request is valid.
+static WEAVE_ERROR GenerateResumeResponse(WeaveFabricState& responderFS, uint64_t peerNodeId, ResumeSessionContext& responderCtx,
+                                          PacketBuffer *reqMsgBuf, PacketBuffer *& respMsgBuf)
+{
+    WEAVE_ERROR err;
+    WeaveSessionResumption *resumption;
+
+    printf("Responder: Calling GenerateResponse\n");
+
+    responderCtx.Reset();
+    err = responderCtx.DecodeRequest(reqMsgBuf);
+    SuccessOrQuit(err, "ResumeSessionContext::DecodeRequest() failed");
+
+    resumption = responderFS.FindSessionResumption(peerNodeId, responderCtx.ResumptionId);
+    if (resumption == NULL)
+        return WEAVE_ERROR_KEY_NOT_FOUND;
+    responderCtx.SetResumption(*resumption);
+
+    respMsgBuf = PacketBuffer::New();
+    VerifyOrQuit(respMsgBuf != NULL, "PacketBuffer::New() failed");
+
+    err = responderCtx.GenerateResponse(respMsgBuf);
+    if (err == WEAVE_NO_ERROR)
+        responderFS.RemoveSessionResumption(resumption);
+
+    return err;
+}
+
+void CASEResumptionTests_Success()
+{
+    WEAVE_ERROR err;
+    WeaveFabricState initiatorFS;
+    WeaveFabricState responderFS;
+    ResumeSessionContext initiatorCtx;
+    ResumeSessionContext responderCtx;
+    PacketBuffer *reqMsgBuf = NULL;
+    PacketBuffer *respMsgBuf = NULL;
+
+    gCurTest = "Resumption success";
+    printf("========== Starting Test: %s\n", gCurTest);
+
+    SetupResumption(initiatorFS, responderFS);
+
+    GenerateResumeRequest(initiatorFS, initiatorCtx, reqMsgBuf);
+
+    err = GenerateResumeResponse(responderFS, sTestInitiatorNodeId, responderCtx, reqMsgBuf, respMsgBuf);
+    SuccessOrQuit(err, "ResumeSessionContext::GenerateResponse() failed");
+
+    VerifyOrQuit(responderCtx.SessionKeyId == sTestResumedSessionKeyId, "Session key id mismatch");
+    VerifyOrQuit(responderCtx.EncryptionType == kWeaveEncryptionType_AES128CTRSHA1, "Encryption type mismatch");
+    VerifyOrQuit(responderCtx.AuthMode == kWeaveAuthMode_CASE_Device, "Auth mode mismatch");
+
+    printf("Initiator: Calling ProcessResponse\n");
+
+    err = initiatorCtx.ProcessResponse(respMsgBuf);
+    SuccessOrQuit(err, "ResumeSessionContext::ProcessResponse() failed");
+
+    VerifyOrQuit(initiatorCtx.AuthMode == kWeaveAuthMode_CASE_Device, "Auth mode mismatch");
+
+    VerifyOrQuit(memcmp(initiatorCtx.EncryptionKey.AES128CTRSHA1.DataKey, responderCtx.EncryptionKey.AES128CTRSHA1.DataKey,
+                        WeaveEncryptionKey_AES128CTRSHA1::DataKeySize) == 0,
+                 "Data key mismatch");
+
+    VerifyOrQuit(memcmp(initiatorCtx.EncryptionKey.AES128CTRSHA1.IntegrityKey, responderCtx.EncryptionKey.AES128CTRSHA1.IntegrityKey,
+                        WeaveEncryptionKey_AES128CTRSHA1::IntegrityKeySize) == 0,
+                 "Integrity key mismatch");
+
+    PacketBuffer::Free(reqMsgBuf);
+    PacketBuffer::Free(respMsgBuf);
+
+    printf("Test Complete: %s\n", gCurTest);
+    gCurTest = NULL;
+}
+
+void CASEResumptionTests_TamperedMAC()
+{
+    WEAVE_ERROR err;
+    WeaveFabricState initiatorFS;
+    WeaveFabricState responderFS;
+    ResumeSessionContext initiatorCtx;
+    ResumeSessionContext responderCtx;
+    PacketBuffer *reqMsgBuf = NULL;
+    PacketBuffer *respMsgBuf = NULL;
+
+    gCurTest = "Resumption with tampered MAC";
+    printf("========== Starting Test: %s\n", gCurTest);
+
+    // A request whose MAC does not verify is rejected, and leaves the responder's secret in place.
+    SetupResumption(initiatorFS, responderFS);
+    GenerateResumeRequest(initiatorFS, initiatorCtx, reqMsgBuf);
+
+    reqMsgBuf->Start()[ResumeSessionContext::kRequestLength - 1] ^= 0x01;
+
+    err = GenerateResumeResponse(responderFS, sTestInitiatorNodeId, responderCtx, reqMsgBuf, respMsgBuf);
+    VerifyOrQuit(err == WEAVE_ERROR_KEY_CONFIRMATION_FAILED, "Tampered request MAC accepted");
+    VerifyOrQuit(responderFS.FindSessionResumption(sTestInitiatorNodeId) != NULL, "Responder resumption secret consumed");
+
+    PacketBuffer::Free(respMsgBuf);
+    respMsgBuf = NULL;
+
+    // Neither may the fields covered by the MAC be altered.
+    reqMsgBuf->Start()[ResumeSessionContext::kRequestLength - 1] ^= 0x01;
+    reqMsgBuf->Start()[WeaveSessionResumption::kResumptionIdLength + 3] ^= 0x01;
+
+    err = GenerateResumeResponse(responderFS, sTestInitiatorNodeId, responderCtx, reqMsgBuf, respMsgBuf);
+    VerifyOrQuit(err == WEAVE_ERROR_KEY_CONFIRMATION_FAILED, "Tampered initiator random accepted");
+
+    PacketBuffer::Free(respMsgBuf);
+    respMsgBuf = NULL;
+
+    // A response whose MAC does not verify is rejected by the initiator.
+    reqMsgBuf->Start()[WeaveSessionResumption::kResumptionIdLength + 3] ^= 0x01;
+
+    err = GenerateResumeResponse(responderFS, sTestInitiatorNodeId, responderCtx, reqMsgBuf, respMsgBuf);
+    SuccessOrQuit(err, "ResumeSessionContext::GenerateResponse() failed");
+
+    respMsgBuf->Start()[ResumeSessionContext::kResponseLength - 1] ^= 0x01;
+
+    printf("Initiator: Calling ProcessResponse\n");
+
+    err = initiatorCtx.ProcessResponse(respMsgBuf);
+    VerifyOrQuit(err == WEAVE_ERROR_KEY_CONFIRMATION_FAILED, "Tampered response MAC accepted");
+
+    PacketBuffer::Free(reqMsgBuf);
+    PacketBuffer::Free(respMsgBuf);
+
+    printf("Test Complete: %s\n", gCurTest);
+    gCurTest = NULL;
+}
+
+void CASEResumptionTests_UnknownResumptionId()
+{
+    WEAVE_ERROR err;
+    WeaveFabricState initiatorFS;
+    WeaveFabricState responderFS;
+    ResumeSessionContext initiatorCtx;
+    ResumeSessionContext responderCtx;
+    PacketBuffer *reqMsgBuf = NULL;
+    PacketBuffer *respMsgBuf = NULL;
+
+    gCurTest = "Resumption with unknown resumption id";
+    printf("========== Starting Test: %s\n", gCurTest);
+
+    SetupResumption(initiatorFS, responderFS);
+    GenerateResumeRequest(initiatorFS, initiatorCtx, reqMsgBuf);
+
+    // An id the responder does not hold is declined.
+    reqMsgBuf->Start()[0] ^= 0x01;
+
+    err = GenerateResumeResponse(responderFS, sTestInitiatorNodeId, responderCtx, reqMsgBuf, respMsgBuf);
+    VerifyOrQuit(err == WEAVE_ERROR_KEY_NOT_FOUND, "Unknown resumption id accepted");
+
+    // So is a valid id presented by a node other than the one that holds it.
+    reqMsgBuf->Start()[0] ^= 0x01;
+
+    err = GenerateResumeResponse(responderFS, sTestResponderNodeId, responderCtx, reqMsgBuf, respMsgBuf);
+    VerifyOrQuit(err == WEAVE_ERROR_KEY_NOT_FOUND, "Resumption id accepted from the wrong peer");
+
+    VerifyOrQuit(respMsgBuf == NULL, "Response generated for a declined request");
+    VerifyOrQuit(responderFS.FindSessionResumption(sTestInitiatorNodeId) != NULL, "Responder resumption secret consumed");
+
+    PacketBuffer::Free(reqMsgBuf);
+
+    printf("Test Complete: %s\n", gCurTest);
+    gCurTest = NULL;
+}
+
+void CASEResumptionTests_SingleUse()
+{
+    WEAVE_ERROR err;
+    WeaveFabricState initiatorFS;
+    WeaveFabricState responderFS;
+    ResumeSessionContext initiatorCtx;
+    ResumeSessionContext responderCtx;
+    PacketBuffer *reqMsgBuf = NULL;
+    PacketBuffer *respMsgBuf = NULL;
+
+    gCurTest = "Resumption secret single use";
+    printf("========== Starting Test: %s\n", gCurTest);
+
+    SetupResumption(initiatorFS, responderFS);
+    GenerateResumeRequest(initiatorFS, initiatorCtx, reqMsgBuf);
+
+    // The initiator offers a secret only once.
+    VerifyOrQuit(initiatorFS.FindSessionResumption(sTestResponderNodeId) == NULL, "Initiator resumption secret not consumed");
+
+    err = GenerateResumeResponse(responderFS, sTestInitiatorNodeId, responderCtx, reqMsgBuf, respMsgBuf);
+    SuccessOrQuit(err, "ResumeSessionContext::GenerateResponse() failed");
+
+    // The responder accepts it only once, so a replayed request is declined.
+    VerifyOrQuit(responderFS.FindSessionResumption(sTestInitiatorNodeId) == NULL, "Responder resumption secret not consumed");
+
+    PacketBuffer::Free(respMsgBuf);
+    respMsgBuf = NULL;
+
+    err = GenerateResumeResponse(responderFS, sTestInitiatorNodeId, responderCtx, reqMsgBuf, respMsgBuf);
+    VerifyOrQuit(err == WEAVE_ERROR_KEY_NOT_FOUND, "Replayed resumption request accepted");
+
+    PacketBuffer::Free(reqMsgBuf);
+
+    printf("Test Complete: %s\n", gCurTest);
+    gCurTest = NULL;
+}
+
+#endif // WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+
 static OptionDef gToolOptionDefs[] =
 {
     { "fuzz-duration", kArgumentRequired, 'f' },
@@ -1083,6 +1344,12 @@ int main(int argc, char *argv[])
     CASEEngineTests_CurveNegotiationTests();
     CASEEngineTests_KeyConfirmationTests();
     CASEEngineTests_FuzzTests();
+#if WEAVE_CONFIG_CASE_RESUMPTION_CACHE_SIZE > 0
+    CASEResumptionTests_Success();
+    CASEResumptionTests_TamperedMAC();
+    CASEResumptionTests_UnknownResumptionId();
+    CASEResumptionTests_SingleUse();
+#endif
 
     printf("All tests succeeded\n");
 
@@ -0,0 +1,438 @@
+/*
+ *
+ *    Copyright (c) 2019 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This is a unit test suite for <tt>nl::Weave::CryptoWorkerPool</tt>,
+ *      the pool of threads on which the Weave Security Manager runs
+ *      public key operations.
+ *
+ */
+
+#ifndef __STDC_LIMIT_MACROS
+#define __STDC_LIMIT_MACROS
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <Weave/Core/WeaveCore.h>
+#include <Weave/Core/WeaveCryptoWorkerPool.h>
+#include <Weave/Support/ErrorStr.h>
+
+#include <nlunit-test.h>
+
+#if WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0
+
+#include <sys/select.h>
+
+using nl::ErrorStr;
+using namespace nl::Weave;
+
+enum
+{
+    kNumTestJobs                = WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS + 4,
+    kServiceTimeoutMs           = 5000,
+};
+
+struct TestJob
+{
+    CryptoJob Job;
+    volatile bool Ran;
+    volatile bool Running;
+    volatile bool Completed;
+    pthread_t RunThread;
+};
+
+static System::Layer sSystemLayer;
+static CryptoWorkerPool sPool;
+static TestJob sJobs[kNumTestJobs];
+static pthread_t sWeaveThread;
+
+// Jobs submitted with RunGatedJob block until the gate is opened.
+static pthread_mutex_t sGateLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sGateCond = PTHREAD_COND_INITIALIZER;
+static bool sGateOpen;
+
+static void ServiceEvents(uint32_t aSleepMs)
+{
+    fd_set readFDs, writeFDs, exceptFDs;
+    int numFDs = 0;
+    struct timeval sleepTime;
+
+    sleepTime.tv_sec = 0;
+    sleepTime.tv_usec = aSleepMs * 1000;
+
+    FD_ZERO(&readFDs);
+    FD_ZERO(&writeFDs);
+    FD_ZERO(&exceptFDs);
+
+    sSystemLayer.PrepareSelect(numFDs, &readFDs, &writeFDs, &exceptFDs, sleepTime);
+
+    int selectRes = select(numFDs, &readFDs, &writeFDs, &exceptFDs, &sleepTime);
+    if (selectRes < 0)
+    {
+        printf("select failed: %s\n", ErrorStr(System::MapErrorPOSIX(errno)));
+        return;
+    }
+
+    sSystemLayer.HandleSelectResult(selectRes, &readFDs, &writeFDs, &exceptFDs);
+}
+
+static bool ServiceUntil(volatile bool &aDone)
+{
+    uint64_t deadline = System::Layer::GetClock_Monotonic() + kServiceTimeoutMs * 1000ULL;
+
+    while (!aDone && System::Layer::GetClock_Monotonic() < deadline)
+        ServiceEvents(1);
+
+    return aDone;
+}
+
+static void ServiceFor(uint32_t aMs)
+{
+    uint64_t deadline = System::Layer::GetClock_Monotonic() + aMs * 1000ULL;
+
+    while (System::Layer::GetClock_Monotonic() < deadline)
+        ServiceEvents(1);
+}
+
+static void SetGate(bool aOpen)
+{
+    pthread_mutex_lock(&sGateLock);
+    sGateOpen = aOpen;
+    pthread_cond_broadcast(&sGateCond);
+    pthread_mutex_unlock(&sGateLock);
+}
+
+static WEAVE_ERROR RunJob(CryptoJob *job)
+{
+    TestJob *testJob = static_cast<TestJob *>(job->AppState);
+
+    testJob->RunThread = pthread_self();
+    testJob->Ran = true;
+
+    return static_cast<WEAVE_ERROR>(WEAVE_ERROR_INVALID_ARGUMENT + (testJob - sJobs));
+}
+
+static WEAVE_ERROR RunGatedJob(CryptoJob *job)
+{
+    TestJob *testJob = static_cast<TestJob *>(job->AppState);
+
+    testJob->Running = true;
+
+    pthread_mutex_lock(&sGateLock);
+    while (!sGateOpen)
+        pthread_cond_wait(&sGateCond, &sGateLock);
+    pthread_mutex_unlock(&sGateLock);
+
+    return RunJob(job);
+}
+
+static WEAVE_ERROR RunSlowJob(CryptoJob *job)
+{
+    TestJob *testJob = static_cast<TestJob *>(job->AppState);
+
+    testJob->Running = true;
+    usleep(50 * 1000);
+
+    return RunJob(job);
+}
+
+static void HandleJobComplete(CryptoJob *job)
+{
+    TestJob *testJob = static_cast<TestJob *>(job->AppState);
+
+    testJob->Completed = true;
+}
+
+static void InitJobs(CryptoJob::RunFunct aRun)
+{
+    memset(sJobs, 0, sizeof(sJobs));
+
+    for (int i = 0; i < kNumTestJobs; i++)
+    {
+        sJobs[i].Job.Run = aRun;
+        sJobs[i].Job.OnComplete = HandleJobComplete;
+        sJobs[i].Job.AppState = &sJobs[i];
+    }
+}
+
+static void CheckSubmitComplete(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err;
+
+    InitJobs(RunJob);
+
+    for (int i = 0; i < kNumTestJobs; i++)
+    {
+        err = sPool.Submit(&sJobs[i].Job);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    }
+
+    for (int i = 0; i < kNumTestJobs; i++)
+    {
+        NL_TEST_ASSERT(inSuite, ServiceUntil(sJobs[i].Completed));
+        NL_TEST_ASSERT(inSuite, sJobs[i].Ran);
+        NL_TEST_ASSERT(inSuite, !pthread_equal(sJobs[i].RunThread, sWeaveThread));
+        NL_TEST_ASSERT(inSuite, sJobs[i].Job.Result == WEAVE_ERROR_INVALID_ARGUMENT + i);
+    }
+
+    // A job without a Run or OnComplete function is rejected.
+    sJobs[0].Job.Run = NULL;
+    err = sPool.Submit(&sJobs[0].Job);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_ARGUMENT);
+}
+
+static void CheckCancelQueued(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err;
+
+    // Occupy every worker, so that the remaining jobs stay queued.
+    InitJobs(RunGatedJob);
+    SetGate(false);
+
+    for (int i = 0; i < kNumTestJobs; i++)
+    {
+        err = sPool.Submit(&sJobs[i].Job);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    }
+
+    for (int i = 0; i < WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS; i++)
+        while (!sJobs[i].Running)
+            usleep(1000);
+
+    sPool.Cancel(&sJobs[kNumTestJobs - 1].Job);
+
+    SetGate(true);
+
+    for (int i = 0; i < kNumTestJobs - 1; i++)
+        NL_TEST_ASSERT(inSuite, ServiceUntil(sJobs[i].Completed));
+
+    ServiceFor(50);
+
+    NL_TEST_ASSERT(inSuite, !sJobs[kNumTestJobs - 1].Ran);
+    NL_TEST_ASSERT(inSuite, !sJobs[kNumTestJobs - 1].Completed);
+
+    // A canceled job may be submitted again.
+    err = sPool.Submit(&sJobs[kNumTestJobs - 1].Job);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, ServiceUntil(sJobs[kNumTestJobs - 1].Completed));
+}
+
+static void CheckCancelRunning(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err;
+
+    InitJobs(RunSlowJob);
+
+    err = sPool.Submit(&sJobs[0].Job);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    while (!sJobs[0].Running)
+        usleep(1000);
+
+    // Cancel waits for the running job to return.
+    sPool.Cancel(&sJobs[0].Job);
+    NL_TEST_ASSERT(inSuite, sJobs[0].Ran);
+
+    ServiceFor(50);
+    NL_TEST_ASSERT(inSuite, !sJobs[0].Completed);
+}
+
+static void CheckCancelDone(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err;
+
+    InitJobs(RunJob);
+
+    err = sPool.Submit(&sJobs[0].Job);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    // Let the job finish without servicing the completion.
+    while (!sJobs[0].Ran)
+        usleep(1000);
+    usleep(10 * 1000);
+
+    sPool.Cancel(&sJobs[0].Job);
+
+    ServiceFor(50);
+    NL_TEST_ASSERT(inSuite, !sJobs[0].Completed);
+}
+
+static void HandleFillerTimer(System::Layer *aLayer, void *aAppState, System::Error aError)
+{
+}
+
+static void CheckCompletionScheduleRetry(nlTestSuite *inSuite, void *inContext)
+{
+    static char sFillers[WEAVE_SYSTEM_CONFIG_NUM_TIMERS];
+    WEAVE_ERROR err;
+    size_t numFillers = 0;
+
+    // Use up every system timer, so that the worker cannot schedule the completion.
+    while (numFillers < sizeof(sFillers) &&
+           sSystemLayer.StartTimer(3600 * 1000, HandleFillerTimer, &sFillers[numFillers]) == WEAVE_SYSTEM_NO_ERROR)
+        numFillers++;
+    NL_TEST_ASSERT(inSuite, numFillers > 0);
+
+    InitJobs(RunJob);
+
+    err = sPool.Submit(&sJobs[0].Job);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    while (!sJobs[0].Ran)
+        usleep(1000);
+
+    ServiceFor(50);
+    NL_TEST_ASSERT(inSuite, !sJobs[0].Completed);
+
+    // Once a timer is free again, the job is handed back.
+    sSystemLayer.CancelTimer(HandleFillerTimer, &sFillers[0]);
+    NL_TEST_ASSERT(inSuite, ServiceUntil(sJobs[0].Completed));
+    NL_TEST_ASSERT(inSuite, sJobs[0].Job.Result == WEAVE_ERROR_INVALID_ARGUMENT);
+
+    for (size_t i = 1; i < numFillers; i++)
+        sSystemLayer.CancelTimer(HandleFillerTimer, &sFillers[i]);
+}
+
+static void *OpenGateLater(void *arg)
+{
+    usleep(20 * 1000);
+    SetGate(true);
+    return NULL;
+}
+
+static void CheckShutdown(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err;
+    pthread_t opener;
+
+    InitJobs(RunGatedJob);
+    SetGate(false);
+
+    for (int i = 0; i < kNumTestJobs; i++)
+    {
+        err = sPool.Submit(&sJobs[i].Job);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    }
+
+    for (int i = 0; i < WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS; i++)
+        while (!sJobs[i].Running)
+            usleep(1000);
+
+    // Release the running jobs shortly after Shutdown() starts waiting for them.
+    NL_TEST_ASSERT(inSuite, pthread_create(&opener, NULL, OpenGateLater, NULL) == 0);
+    err = sPool.Shutdown();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    pthread_join(opener, NULL);
+    NL_TEST_ASSERT(inSuite, !sPool.IsRunning());
+
+    ServiceFor(50);
+
+    // Neither the jobs that were running nor the ones still queued are completed.
+    for (int i = 0; i < kNumTestJobs; i++)
+        NL_TEST_ASSERT(inSuite, !sJobs[i].Completed);
+    for (int i = WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS; i < kNumTestJobs; i++)
+        NL_TEST_ASSERT(inSuite, !sJobs[i].Ran);
+
+    err = sPool.Submit(&sJobs[0].Job);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INCORRECT_STATE);
+
+    // The pool can be started again.
+    err = sPool.Init(sSystemLayer);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = sPool.Init(sSystemLayer);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INCORRECT_STATE);
+
+    InitJobs(RunJob);
+    err = sPool.Submit(&sJobs[0].Job);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, ServiceUntil(sJobs[0].Completed));
+}
+
+/**
+ *   Test Suite. It lists all the test functions.
+ */
+static const nlTest sTests[] = {
+    NL_TEST_DEF("CryptoWorkerPool::SubmitComplete",            CheckSubmitComplete),
+    NL_TEST_DEF("CryptoWorkerPool::CancelQueued",              CheckCancelQueued),
+    NL_TEST_DEF("CryptoWorkerPool::CancelRunning",             CheckCancelRunning),
+    NL_TEST_DEF("CryptoWorkerPool::CancelDone",                CheckCancelDone),
+    NL_TEST_DEF("CryptoWorkerPool::CompletionScheduleRetry",   CheckCompletionScheduleRetry),
+    NL_TEST_DEF("CryptoWorkerPool::Shutdown",                  CheckShutdown),
+    NL_TEST_SENTINEL()
+};
+
+/**
+ *  Set up the test suite.
+ */
+static int TestSetup(void *inContext)
+{
+    if (sSystemLayer.Init(NULL) != WEAVE_SYSTEM_NO_ERROR)
+        return FAILURE;
+
+    if (sPool.Init(sSystemLayer) != WEAVE_NO_ERROR)
+        return FAILURE;
+
+    sWeaveThread = pthread_self();
+
+    return SUCCESS;
+}
+
+/**
+ *  Tear down the test suite.
+ */
+static int TestTeardown(void *inContext)
+{
+    sPool.Shutdown();
+    sSystemLayer.Shutdown();
+
+    return SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    nlTestSuite theSuite = {
+        "crypto-worker-pool",
+        &sTests[0],
+        TestSetup,
+        TestTeardown
+    };
+
+    // Generate machine-readable, comma-separated value (CSV) output.
+    nl_test_set_output_style(OUTPUT_CSV);
+
+    // Run test suit against one context.
+    nlTestRunner(&theSuite, NULL);
+
+    return nlTestRunnerStats(&theSuite);
+}
+
+#else // !(WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0)
+
+int main(int argc, char *argv[])
+{
+    return 0;
+}
+
+#endif // !(WEAVE_CONFIG_SECURITY_MGR_CRYPTO_WORKERS > 0)
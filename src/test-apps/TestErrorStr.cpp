@@ -294,6 +294,7 @@ static int32_t sContext[] =
       WEAVE_ERROR_SESSION_KEY_SUSPENDED,
       WEAVE_ERROR_UNSUPPORTED_WIRELESS_REGULATORY_DOMAIN,
       WEAVE_ERROR_UNSUPPORTED_WIRELESS_OPERATING_LOCATION,
+      WEAVE_ERROR_WRMP_SEND_WINDOW_FULL,
 
       WEAVE_ERROR_TUNNEL_ROUTING_RESTRICTED,
 
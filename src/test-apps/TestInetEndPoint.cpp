@@ -511,6 +511,114 @@ static void TestInetEndPoint(nlTestSuite *inSuite, void *inContext)
     testTCPEP1->Shutdown();
 }
 
+#if INET_CONFIG_ENABLE_IPV4
+enum { kBatchMsgCount = 2 * INET_CONFIG_UDP_SEND_BATCH_SIZE + 1 };
+static uint16_t sBatchRcvdCount = 0;
+static bool sBatchRcvd[kBatchMsgCount];
+
+static void HandleBatchMessageReceived(IPEndPointBasis *endPoint, PacketBuffer *msg, const IPPacketInfo *pktInfo)
+{
+    if (msg->DataLength() == 1 && msg->Start()[0] < kBatchMsgCount)
+        sBatchRcvd[msg->Start()[0]] = true;
+    sBatchRcvdCount++;
+
+    PacketBuffer::Free(msg);
+}
+
+// Test sending a batch of UDP messages, larger than INET_CONFIG_UDP_SEND_BATCH_SIZE, in which some
+// of the messages cannot be sent.
+static void TestInetUDPSendMsgBatch(nlTestSuite *inSuite, void *inContext)
+{
+    const uint8_t kMsgCount = kBatchMsgCount;
+    const uint16_t kRcvPort = 3100;
+    const uint8_t kBadTypeMsg = 3;
+    const uint8_t kChainedMsg = INET_CONFIG_UDP_SEND_BATCH_SIZE;
+    INET_ERROR err;
+    IPAddress loopbackAddr;
+    IPAddress v6Addr;
+    UDPEndPoint *rcvEP = NULL;
+    UDPEndPoint *sendEP = NULL;
+    IPPacketInfo pktInfos[kMsgCount];
+    PacketBuffer *msgs[kMsgCount];
+    INET_ERROR results[kMsgCount];
+    uint64_t deadline;
+
+    NL_TEST_ASSERT(inSuite, IPAddress::FromString("127.0.0.1", loopbackAddr));
+    NL_TEST_ASSERT(inSuite, IPAddress::FromString("::1", v6Addr));
+
+    err = Inet.NewUDPEndPoint(&rcvEP);
+    NL_TEST_ASSERT(inSuite, err == INET_NO_ERROR);
+    err = rcvEP->Bind(kIPAddressType_IPv4, loopbackAddr, kRcvPort);
+    NL_TEST_ASSERT(inSuite, err == INET_NO_ERROR);
+    rcvEP->OnMessageReceived = HandleBatchMessageReceived;
+    err = rcvEP->Listen();
+    NL_TEST_ASSERT(inSuite, err == INET_NO_ERROR);
+
+    err = Inet.NewUDPEndPoint(&sendEP);
+    NL_TEST_ASSERT(inSuite, err == INET_NO_ERROR);
+    err = sendEP->Bind(kIPAddressType_IPv4, loopbackAddr, 0);
+    NL_TEST_ASSERT(inSuite, err == INET_NO_ERROR);
+
+    // Each message holds its index.  One message goes to a destination of the wrong address type,
+    // and one is held in a chain of buffers; both fail without holding up the other messages.
+    for (uint8_t i = 0; i < kMsgCount; i++)
+    {
+        pktInfos[i].Clear();
+        pktInfos[i].DestAddress = (i == kBadTypeMsg) ? v6Addr : loopbackAddr;
+        pktInfos[i].DestPort = kRcvPort;
+        pktInfos[i].Interface = INET_NULL_INTERFACEID;
+
+        msgs[i] = PacketBuffer::New();
+        msgs[i]->Start()[0] = i;
+        msgs[i]->SetDataLength(1);
+
+        if (i == kChainedMsg)
+        {
+            PacketBuffer *tail = PacketBuffer::New();
+            tail->SetDataLength(1);
+            msgs[i]->AddToEnd(tail);
+        }
+    }
+
+    sBatchRcvdCount = 0;
+    memset(sBatchRcvd, 0, sizeof(sBatchRcvd));
+
+    err = sendEP->SendMsgBatch(pktInfos, msgs, kMsgCount, results);
+    NL_TEST_ASSERT(inSuite, err == INET_ERROR_BAD_ARGS);
+
+    for (uint8_t i = 0; i < kMsgCount; i++)
+    {
+        if (i == kBadTypeMsg)
+            NL_TEST_ASSERT(inSuite, results[i] == INET_ERROR_BAD_ARGS);
+        else if (i == kChainedMsg)
+            NL_TEST_ASSERT(inSuite, results[i] == INET_ERROR_MESSAGE_TOO_LONG);
+        else
+            NL_TEST_ASSERT(inSuite, results[i] == INET_NO_ERROR);
+    }
+
+    deadline = System::Timer::GetCurrentEpoch() + 2000;
+    while (sBatchRcvdCount < kMsgCount - 2 && System::Timer::GetCurrentEpoch() < deadline)
+    {
+        struct timeval sleepTime;
+        sleepTime.tv_sec = 0;
+        sleepTime.tv_usec = 10000;
+
+        ServiceNetwork(sleepTime);
+    }
+
+    NL_TEST_ASSERT(inSuite, sBatchRcvdCount == kMsgCount - 2);
+    for (uint8_t i = 0; i < kMsgCount; i++)
+        NL_TEST_ASSERT(inSuite, sBatchRcvd[i] == (i != kBadTypeMsg && i != kChainedMsg));
+
+    // Sending an empty batch is a no-op.
+    err = sendEP->SendMsgBatch(pktInfos, msgs, 0, results);
+    NL_TEST_ASSERT(inSuite, err == INET_NO_ERROR);
+
+    sendEP->Free();
+    rcvEP->Free();
+}
+#endif // INET_CONFIG_ENABLE_IPV4
+
 // Test the InetLayer resource limitation
 static void TestInetEndPointLimit(nlTestSuite *inSuite, void *inContext)
 {
@@ -571,6 +679,9 @@ static const nlTest sTests[] = {
     NL_TEST_DEF("InetEndPoint::TestInetError",       TestInetError),
     NL_TEST_DEF("InetEndPoint::TestInetInterface",   TestInetInterface),
     NL_TEST_DEF("InetEndPoint::TestInetEndPoint",    TestInetEndPoint),
+#if INET_CONFIG_ENABLE_IPV4
+    NL_TEST_DEF("InetEndPoint::TestUDPSendMsgBatch", TestInetUDPSendMsgBatch),
+#endif // INET_CONFIG_ENABLE_IPV4
     NL_TEST_DEF("InetEndPoint::TestEndPointLimit",   TestInetEndPointLimit),
     NL_TEST_SENTINEL()
 };
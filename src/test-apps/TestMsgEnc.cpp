@@ -60,6 +60,42 @@ public:
     {
         return msgLayer->DecodeMessage(msgBuf, sourceNodeId, con, msgInfo, rPayload, rPayloadLen);
     }
+
+#if WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
+    void RecordPeerMessageSent(uint64_t peerNodeId, uint16_t msgLen)
+    {
+        msgLayer->RecordPeerMessageSent(peerNodeId, msgLen);
+    }
+
+    void RecordPeerMessageReceived(uint64_t peerNodeId, uint16_t msgLen, bool isDuplicate, bool isAuthenticated)
+    {
+        msgLayer->RecordPeerMessageReceived(peerNodeId, msgLen, isDuplicate, isAuthenticated);
+    }
+
+    void RecordPeerDecryptFailure(uint64_t peerNodeId)
+    {
+        msgLayer->RecordPeerDecryptFailure(peerNodeId);
+    }
+#endif // WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
+};
+
+class NL_DLL_EXPORT WeaveConnectionTestObject
+{
+public:
+    static bool GetFrameLength(const PacketBuffer *data, uint32_t &frameLen)
+    {
+        return WeaveConnection::GetFrameLength(data, frameLen);
+    }
+
+    static WEAVE_ERROR GatherFrame(PacketBuffer *&data, uint16_t frameLen)
+    {
+        return WeaveConnection::GatherFrame(data, frameLen);
+    }
+
+    static WEAVE_ERROR DetachPayload(PacketBuffer *&data, uint8_t *payload, uint16_t payloadLen, PacketBuffer *&payloadBuf)
+    {
+        return WeaveConnection::DetachPayload(data, payload, payloadLen, payloadBuf);
+    }
 };
 
 } // namespace nl
@@ -144,6 +180,9 @@ void WeaveMessageEncryption_Test1(nlTestSuite *inSuite, void *inContext)
     uint8_t encType = kWeaveEncryptionType_AES128CTRSHA1;
     uint16_t sessionKeyId = sTestDefaultSessionKeyId;
     uint8_t *p;
+    uint8_t *payloadStart;
+    uint32_t encodeCount = 0;
+    uint32_t decodeCount = 0;
 
     const char localAddrStr[] = "fd00:0:1:1:18B4:3000::2";
     IPAddress localIPv6Addr;
@@ -179,6 +218,9 @@ void WeaveMessageEncryption_Test1(nlTestSuite *inSuite, void *inContext)
 
     // Initialize the MessageLayer object.
     messageLayer.FabricState = &fabricState;
+#if WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
+    messageLayer.ResetPeerTrafficStats();
+#endif
 
     struct TestContext *theContext = (struct TestContext *)(inContext);
 
@@ -219,6 +261,9 @@ void WeaveMessageEncryption_Test1(nlTestSuite *inSuite, void *inContext)
         msgInfo.MessageVersion = msgVersion;
         msgInfo.EncryptionType = encType;
 
+        // Remember where the payload starts, to verify that the header is encoded in front of it in place.
+        payloadStart = msgBuf->Start();
+
         // =====================================================================================================
         // Encode message using EncodeMessage() function.
         // =====================================================================================================
@@ -233,6 +278,11 @@ void WeaveMessageEncryption_Test1(nlTestSuite *inSuite, void *inContext)
             continue;
         }
 
+        encodeCount++;
+
+        // The predicted header length must match the header that was encoded.
+        NL_TEST_ASSERT(inSuite, msgBuf->Start() + WeaveMessageLayer::GetMessageHeaderLength(&msgInfo) == payloadStart);
+
 #if DEBUG_PRINT_ENABLE
         printf("Encoded message generated by EncodeMessage():\n");
         DumpMemoryCStyle(msgBuf->Start(), msgBuf->DataLength(), "    ", 16);
@@ -323,6 +373,8 @@ void WeaveMessageEncryption_Test1(nlTestSuite *inSuite, void *inContext)
 
         if (err == WEAVE_NO_ERROR)
         {
+            decodeCount++;
+
 #if DEBUG_PRINT_ENABLE
             printf("Decoded Payload generated by DecodeMessage():\n");
             DumpMemoryCStyle(payload, payloadLen, "    ", 16);
@@ -337,13 +389,347 @@ void WeaveMessageEncryption_Test1(nlTestSuite *inSuite, void *inContext)
         PacketBuffer::Free(msgBuf);
         msgBuf = NULL;
     }
+
+#if WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
+    // Verify that the peer traffic statistics reflect the messages encoded and decoded above.
+    {
+        WeavePeerTrafficStats stats;
+
+        NL_TEST_ASSERT(inSuite, messageLayer.GetPeerTrafficStats(destNodeId, stats));
+        NL_TEST_ASSERT(inSuite, stats.MessagesSent == encodeCount);
+
+        NL_TEST_ASSERT(inSuite, messageLayer.GetPeerTrafficStats(srcNodeId, stats));
+        NL_TEST_ASSERT(inSuite, stats.MessagesReceived == decodeCount);
+        NL_TEST_ASSERT(inSuite, stats.Retransmissions == 0);
+    }
+#endif
+}
+
+
+// Fill a buffer with a recognizable byte sequence, starting with a message length field.
+static void MakeFrameData(uint8_t *buf, uint16_t len, uint16_t msgLen)
+{
+    for (uint16_t i = 0; i < len; i++)
+        buf[i] = static_cast<uint8_t>(i * 7 + 1);
+    if (len >= 2)
+        LittleEndian::Put16(buf, msgLen);
 }
 
+// Build a queue of received data from consecutive segments of the given data.  Segments may be empty.
+static PacketBuffer *MakeDataQueue(const uint8_t *data, const uint16_t *segLens, size_t segCount)
+{
+    PacketBuffer *queue = NULL;
+
+    for (size_t i = 0; i < segCount; i++)
+    {
+        PacketBuffer *buf = PacketBuffer::NewWithAvailableSize(0, segLens[i]);
+        if (buf == NULL)
+            break;
+
+        memcpy(buf->Start(), data, segLens[i]);
+        buf->SetDataLength(segLens[i]);
+        data += segLens[i];
+
+        if (queue == NULL)
+            queue = buf;
+        else
+            queue->AddToEnd(buf);
+    }
+
+    return queue;
+}
+
+static size_t CountBuffers(const PacketBuffer *buf)
+{
+    size_t count = 0;
+
+    for (; buf != NULL; buf = buf->Next())
+        count++;
+
+    return count;
+}
+
+void WeaveConnection_GetFrameLength(nlTestSuite *inSuite, void *inContext)
+{
+    uint8_t data[4];
+    uint32_t frameLen;
+    PacketBuffer *queue;
+
+    MakeFrameData(data, sizeof(data), 0x1234);
+
+    // Length field in the head buffer.
+    {
+        const uint16_t segLens[] = { 4 };
+        queue = MakeDataQueue(data, segLens, 1);
+        NL_TEST_ASSERT(inSuite, WeaveConnectionTestObject::GetFrameLength(queue, frameLen));
+        NL_TEST_ASSERT(inSuite, frameLen == 0x1234 + 2);
+        PacketBuffer::Free(queue);
+    }
+
+    // Length field split across buffers, with empty buffers in between.
+    {
+        const uint16_t segLens[] = { 0, 1, 0, 0, 1, 2 };
+        queue = MakeDataQueue(data, segLens, 6);
+        NL_TEST_ASSERT(inSuite, WeaveConnectionTestObject::GetFrameLength(queue, frameLen));
+        NL_TEST_ASSERT(inSuite, frameLen == 0x1234 + 2);
+        PacketBuffer::Free(queue);
+    }
+
+    // Only part of the length field received.
+    {
+        const uint16_t segLens[] = { 1, 0 };
+        queue = MakeDataQueue(data, segLens, 2);
+        NL_TEST_ASSERT(inSuite, !WeaveConnectionTestObject::GetFrameLength(queue, frameLen));
+        NL_TEST_ASSERT(inSuite, frameLen == 8);
+        PacketBuffer::Free(queue);
+    }
+
+    // The largest frame length that can be encoded, which exceeds the size of any buffer.
+    {
+        const uint16_t segLens[] = { 2 };
+        MakeFrameData(data, sizeof(data), UINT16_MAX);
+        queue = MakeDataQueue(data, segLens, 1);
+        NL_TEST_ASSERT(inSuite, WeaveConnectionTestObject::GetFrameLength(queue, frameLen));
+        NL_TEST_ASSERT(inSuite, frameLen == UINT16_MAX + 2);
+        NL_TEST_ASSERT(inSuite, frameLen > WEAVE_SYSTEM_CONFIG_PACKETBUFFER_CAPACITY_MAX);
+        PacketBuffer::Free(queue);
+    }
+}
+
+void WeaveConnection_GatherFrame(nlTestSuite *inSuite, void *inContext)
+{
+    enum { kFrameLen = 300, kDataLen = kFrameLen + 50 };
+    uint8_t data[kDataLen];
+    PacketBuffer *queue;
+    WEAVE_ERROR err;
+
+    MakeFrameData(data, sizeof(data), kFrameLen - 2);
+
+    // Frame spread over many buffers, including empty ones, and followed by the start of the next
+    // frame.  The head buffer is too small to hold the frame, so it is gathered into a new one.
+    {
+        uint16_t segLens[2 * (kDataLen / 10)];
+        size_t segCount = 0;
+
+        for (uint16_t len = 0; len < kDataLen; len += 10)
+        {
+            segLens[segCount++] = 10;
+            segLens[segCount++] = 0;
+        }
+
+        queue = MakeDataQueue(data, segLens, segCount);
+        NL_TEST_ASSERT(inSuite, queue != NULL && queue->TotalLength() == kDataLen);
+
+        err = WeaveConnectionTestObject::GatherFrame(queue, kFrameLen);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, queue->DataLength() == kFrameLen);
+        NL_TEST_ASSERT(inSuite, memcmp(queue->Start(), data, kFrameLen) == 0);
+        NL_TEST_ASSERT(inSuite, queue->TotalLength() == kDataLen);
+        NL_TEST_ASSERT(inSuite, queue->Next() != NULL && memcmp(queue->Next()->Start(), data + kFrameLen, queue->Next()->DataLength()) == 0);
+
+        PacketBuffer::Free(queue);
+    }
+
+    // Frame split between a head buffer with room for the rest and a second buffer.  The remainder
+    // is moved into the head buffer in place.
+    {
+        PacketBuffer *head = PacketBuffer::NewWithAvailableSize(0, kFrameLen);
+        PacketBuffer *tail = PacketBuffer::NewWithAvailableSize(0, kDataLen);
+
+        NL_TEST_ASSERT(inSuite, head != NULL && tail != NULL);
+
+        memcpy(head->Start(), data, 1);
+        head->SetDataLength(1);
+        memcpy(tail->Start(), data + 1, kDataLen - 1);
+        tail->SetDataLength(kDataLen - 1);
+        head->AddToEnd(tail);
+
+        queue = head;
+        err = WeaveConnectionTestObject::GatherFrame(queue, kFrameLen);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, queue == head);
+        NL_TEST_ASSERT(inSuite, queue->DataLength() == kFrameLen);
+        NL_TEST_ASSERT(inSuite, memcmp(queue->Start(), data, kFrameLen) == 0);
+        NL_TEST_ASSERT(inSuite, CountBuffers(queue) == 2 && queue->TotalLength() == kDataLen);
+
+        PacketBuffer::Free(queue);
+    }
+
+    // Frame exactly filling the queue, leaving a single buffer.
+    {
+        const uint16_t segLens[] = { 0, 100, 100, 100 };
+        queue = MakeDataQueue(data, segLens, 4);
+
+        err = WeaveConnectionTestObject::GatherFrame(queue, kFrameLen);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, CountBuffers(queue) == 1);
+        NL_TEST_ASSERT(inSuite, queue->DataLength() == kFrameLen);
+        NL_TEST_ASSERT(inSuite, memcmp(queue->Start(), data, kFrameLen) == 0);
+
+        PacketBuffer::Free(queue);
+    }
+
+    // A frame too big for any buffer cannot be gathered, and the received data is left intact.
+    {
+        const uint16_t segLens[] = { 100, 100, 100 };
+        queue = MakeDataQueue(data, segLens, 3);
+
+        err = WeaveConnectionTestObject::GatherFrame(queue, WEAVE_SYSTEM_CONFIG_PACKETBUFFER_CAPACITY_MAX + 1);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_NO_MEMORY);
+        NL_TEST_ASSERT(inSuite, CountBuffers(queue) == 3 && queue->TotalLength() == kFrameLen);
+
+        PacketBuffer::Free(queue);
+    }
+}
+
+void WeaveConnection_DetachPayload(nlTestSuite *inSuite, void *inContext)
+{
+    enum { kMsgLen = 200, kPayloadOffset = 20, kPayloadLen = kMsgLen - kPayloadOffset };
+    uint8_t data[kMsgLen + kMsgLen];
+    PacketBuffer *queue;
+    PacketBuffer *payloadBuf;
+    PacketBuffer *origHead;
+    WEAVE_ERROR err;
+
+    MakeFrameData(data, sizeof(data), kMsgLen - 2);
+
+    // No data follows the message, so the head buffer is handed over as is.
+    {
+        const uint16_t segLens[] = { kMsgLen, 10 };
+        queue = origHead = MakeDataQueue(data, segLens, 2);
+        queue->ConsumeHead(kMsgLen);
+
+        err = WeaveConnectionTestObject::DetachPayload(queue, origHead->Start() - kPayloadLen, kPayloadLen, payloadBuf);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, payloadBuf == origHead && payloadBuf->Next() == NULL);
+        NL_TEST_ASSERT(inSuite, payloadBuf->DataLength() == kPayloadLen);
+        NL_TEST_ASSERT(inSuite, memcmp(payloadBuf->Start(), data + kPayloadOffset, kPayloadLen) == 0);
+        NL_TEST_ASSERT(inSuite, queue != NULL && queue->TotalLength() == 10);
+        NL_TEST_ASSERT(inSuite, memcmp(queue->Start(), data + kMsgLen, 10) == 0);
+
+        PacketBuffer::Free(payloadBuf);
+        PacketBuffer::Free(queue);
+    }
+
+    // Less data follows the message than its payload, so the following data is copied out and the
+    // head buffer handed over.
+    {
+        const uint16_t segLens[] = { kMsgLen + 10, 10 };
+        queue = origHead = MakeDataQueue(data, segLens, 2);
+        queue->ConsumeHead(kMsgLen);
+
+        err = WeaveConnectionTestObject::DetachPayload(queue, origHead->Start() - kPayloadLen, kPayloadLen, payloadBuf);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, payloadBuf == origHead && payloadBuf->Next() == NULL);
+        NL_TEST_ASSERT(inSuite, payloadBuf->DataLength() == kPayloadLen);
+        NL_TEST_ASSERT(inSuite, memcmp(payloadBuf->Start(), data + kPayloadOffset, kPayloadLen) == 0);
+        NL_TEST_ASSERT(inSuite, queue != origHead && CountBuffers(queue) == 2 && queue->TotalLength() == 20);
+        NL_TEST_ASSERT(inSuite, queue->DataLength() == 10 && memcmp(queue->Start(), data + kMsgLen, 10) == 0);
+        NL_TEST_ASSERT(inSuite, memcmp(queue->Next()->Start(), data + kMsgLen + 10, 10) == 0);
+
+        PacketBuffer::Free(payloadBuf);
+        PacketBuffer::Free(queue);
+    }
+
+    // More data follows the message than its payload, so the payload is copied out.
+    {
+        const uint16_t segLens[] = { kMsgLen + kMsgLen };
+        queue = origHead = MakeDataQueue(data, segLens, 1);
+        queue->ConsumeHead(kMsgLen);
+
+        err = WeaveConnectionTestObject::DetachPayload(queue, origHead->Start() - kPayloadLen, kPayloadLen, payloadBuf);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, payloadBuf != origHead && payloadBuf->Next() == NULL);
+        NL_TEST_ASSERT(inSuite, payloadBuf->DataLength() == kPayloadLen);
+        NL_TEST_ASSERT(inSuite, memcmp(payloadBuf->Start(), data + kPayloadOffset, kPayloadLen) == 0);
+        NL_TEST_ASSERT(inSuite, queue == origHead && queue->TotalLength() == kMsgLen);
+        NL_TEST_ASSERT(inSuite, memcmp(queue->Start(), data + kMsgLen, kMsgLen) == 0);
+
+        PacketBuffer::Free(payloadBuf);
+        PacketBuffer::Free(queue);
+    }
+}
+
+#if WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
+void WeaveMessageLayer_PeerTrafficStats(nlTestSuite *inSuite, void *inContext)
+{
+    enum { kTableSize = WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE, kFirstPeer = 0x18B4300000000001ULL };
+    static WeaveMessageLayer messageLayer;
+    WeaveMessageLayerTestObject msgLayerTestObject;
+    WeavePeerTrafficStats stats;
+    WeavePeerTrafficStats allStats[kTableSize + 1];
+    size_t count;
+
+    msgLayerTestObject.msgLayer = &messageLayer;
+    messageLayer.ResetPeerTrafficStats();
+
+    // Fill the table, sending one message to each peer.
+    for (uint64_t i = 0; i < kTableSize; i++)
+        msgLayerTestObject.RecordPeerMessageSent(kFirstPeer + i, 100);
+
+    // Broadcast and unspecified destinations are not tracked.
+    msgLayerTestObject.RecordPeerMessageSent(kAnyNodeId, 100);
+    msgLayerTestObject.RecordPeerMessageSent(kNodeIdNotSpecified, 100);
+
+    // Every peer is returned, however large the array...
+    count = messageLayer.GetPeerTrafficStats(allStats, kTableSize + 1);
+    NL_TEST_ASSERT(inSuite, count == kTableSize);
+    for (size_t i = 0; i < count; i++)
+    {
+        NL_TEST_ASSERT(inSuite, allStats[i].PeerNodeId >= kFirstPeer && allStats[i].PeerNodeId < kFirstPeer + kTableSize);
+        NL_TEST_ASSERT(inSuite, allStats[i].MessagesSent == 1 && allStats[i].BytesSent == 100);
+    }
+
+    // ...and no more peers than fit in a smaller one.
+    count = messageLayer.GetPeerTrafficStats(allStats, kTableSize - 1);
+    NL_TEST_ASSERT(inSuite, count == kTableSize - 1);
+
+    // Messages that fail decryption, or are unencrypted, come from unauthenticated sources, so
+    // count only against peers already in the table, and neither evict peers nor keep them active.
+    msgLayerTestObject.RecordPeerDecryptFailure(kFirstPeer + kTableSize);
+    msgLayerTestObject.RecordPeerMessageReceived(kFirstPeer + kTableSize, 100, false, false);
+    NL_TEST_ASSERT(inSuite, !messageLayer.GetPeerTrafficStats(kFirstPeer + kTableSize, stats));
+    NL_TEST_ASSERT(inSuite, messageLayer.GetPeerTrafficStats(allStats, kTableSize + 1) == kTableSize);
+
+    msgLayerTestObject.RecordPeerDecryptFailure(kFirstPeer);
+    msgLayerTestObject.RecordPeerMessageReceived(kFirstPeer, 50, false, false);
+    NL_TEST_ASSERT(inSuite, messageLayer.GetPeerTrafficStats(kFirstPeer, stats));
+    NL_TEST_ASSERT(inSuite, stats.DecryptFailures == 1);
+    NL_TEST_ASSERT(inSuite, stats.MessagesReceived == 1 && stats.BytesReceived == 50);
+
+    // Keep the second peer active, so that the first is now the least recently active.
+    msgLayerTestObject.RecordPeerMessageReceived(kFirstPeer + 1, 50, true, true);
+
+    // An authenticated message from a new peer evicts the least recently active peer.
+    msgLayerTestObject.RecordPeerMessageReceived(kFirstPeer + kTableSize, 75, false, true);
+    NL_TEST_ASSERT(inSuite, !messageLayer.GetPeerTrafficStats(kFirstPeer, stats));
+    NL_TEST_ASSERT(inSuite, messageLayer.GetPeerTrafficStats(kFirstPeer + kTableSize, stats));
+    NL_TEST_ASSERT(inSuite, stats.MessagesReceived == 1 && stats.BytesReceived == 75 && stats.MessagesSent == 0);
+
+    NL_TEST_ASSERT(inSuite, messageLayer.GetPeerTrafficStats(kFirstPeer + 1, stats));
+    NL_TEST_ASSERT(inSuite, stats.MessagesSent == 1 && stats.MessagesReceived == 1 && stats.Duplicates == 1);
+
+    // Sending to a new peer then evicts the next least recently active one.
+    msgLayerTestObject.RecordPeerMessageSent(kFirstPeer + kTableSize + 1, 100);
+    NL_TEST_ASSERT(inSuite, !messageLayer.GetPeerTrafficStats(kFirstPeer + 2, stats));
+    NL_TEST_ASSERT(inSuite, messageLayer.GetPeerTrafficStats(kFirstPeer + 1, stats));
+    NL_TEST_ASSERT(inSuite, messageLayer.GetPeerTrafficStats(allStats, kTableSize + 1) == kTableSize);
+
+    messageLayer.ResetPeerTrafficStats();
+    NL_TEST_ASSERT(inSuite, messageLayer.GetPeerTrafficStats(allStats, kTableSize + 1) == 0);
+}
+#endif // WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
 
 int main(int argc, char *argv[])
 {
     static const nlTest tests[] = {
         NL_TEST_DEF("WeaveMessageEncryption",           WeaveMessageEncryption_Test1),
+        NL_TEST_DEF("WeaveConnection::GetFrameLength",  WeaveConnection_GetFrameLength),
+        NL_TEST_DEF("WeaveConnection::GatherFrame",     WeaveConnection_GatherFrame),
+        NL_TEST_DEF("WeaveConnection::DetachPayload",   WeaveConnection_DetachPayload),
+#if WEAVE_CONFIG_PEER_TRAFFIC_STATS_TABLE_SIZE > 0
+        NL_TEST_DEF("WeaveMessageLayer::PeerTrafficStats", WeaveMessageLayer_PeerTrafficStats),
+#endif
         NL_TEST_SENTINEL()
     };
 
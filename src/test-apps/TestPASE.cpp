@@ -31,6 +31,7 @@
 #include "PASEEngineTest.h"
 #include <Weave/Support/ErrorStr.h>
 #include <Weave/Support/RandUtils.h>
+#include <Weave/Profiles/common/CommonProfile.h>
 
 #if WEAVE_SYSTEM_CONFIG_USE_LWIP
 #include "lwip/tcpip.h"
@@ -144,6 +145,252 @@ void PASEEngineTest_MixedConfigs()
             .Run();
 }
 
+#if WEAVE_CONFIG_ENABLE_TARGETED_LISTEN && INET_CONFIG_ENABLE_IPV4
+
+// A Weave node with its own fabric state, message layer, exchange manager and security manager, so that
+// several nodes can establish PASE sessions with each other within the test process.  Each node listens
+// on its own loopback address.
+class PASETestNode
+{
+public:
+    WeaveFabricState FabricState;
+    WeaveMessageLayer MessageLayer;
+    WeaveExchangeManager ExchangeMgr;
+    WeaveSecurityManager SecurityMgr;
+
+    void Init(uint64_t nodeId, const char *addr, bool listen)
+    {
+        WEAVE_ERROR err;
+        WeaveMessageLayer::InitContext initContext;
+
+        err = FabricState.Init();
+        FAIL_ERROR(err, "WeaveFabricState.Init failed");
+        FabricState.FabricId = kPASETestFabricId;
+        FabricState.LocalNodeId = nodeId;
+        FabricState.PairingCode = kPASETestPairingCode;
+        IPAddress::FromString(addr, FabricState.ListenIPv4Addr);
+
+        initContext.systemLayer = &::SystemLayer;
+        initContext.inet = &::Inet;
+        initContext.fabricState = &FabricState;
+        initContext.listenTCP = listen;
+        initContext.listenUDP = true;
+        err = MessageLayer.Init(&initContext);
+        FAIL_ERROR(err, "WeaveMessageLayer.Init failed");
+
+        err = ExchangeMgr.Init(&MessageLayer);
+        FAIL_ERROR(err, "WeaveExchangeManager.Init failed");
+
+        err = SecurityMgr.Init(ExchangeMgr, ::SystemLayer);
+        FAIL_ERROR(err, "WeaveSecurityManager.Init failed");
+    }
+
+    void Shutdown(void)
+    {
+        SecurityMgr.Shutdown();
+        ExchangeMgr.Shutdown();
+        MessageLayer.Shutdown();
+        FabricState.Shutdown();
+    }
+
+    static const uint64_t kPASETestFabricId = 0x1234;
+    static const char *const kPASETestPairingCode;
+};
+
+const char *const PASETestNode::kPASETestPairingCode = "TESTPW";
+
+// The state of a PASE session being established by a client node.
+struct PASETestSession
+{
+    PASETestNode *Node;
+    WeaveConnection *Con;
+    bool Done;
+    WEAVE_ERROR Err;
+    uint16_t SessionKeyId;
+    uint32_t BusyCount;
+    uint64_t RetryTime;
+};
+
+static const uint64_t kPASETestServerNodeId = 0x18B4300000000001ULL;
+static const char *const kPASETestServerAddr = "127.0.0.2";
+
+static void HandlePASETestSessionEstablished(WeaveSecurityManager *sm, WeaveConnection *con, void *reqState,
+                                             uint16_t sessionKeyId, uint64_t peerNodeId, uint8_t encType)
+{
+    PASETestSession *session = static_cast<PASETestSession *>(reqState);
+
+    session->Done = true;
+    session->Err = WEAVE_NO_ERROR;
+    session->SessionKeyId = sessionKeyId;
+}
+
+static void HandlePASETestSessionError(WeaveSecurityManager *sm, WeaveConnection *con, void *reqState,
+                                       WEAVE_ERROR localErr, uint64_t peerNodeId, StatusReport *statusReport)
+{
+    PASETestSession *session = static_cast<PASETestSession *>(reqState);
+
+    session->Done = true;
+    session->Err = localErr;
+
+    if (localErr == WEAVE_ERROR_STATUS_REPORT_RECEIVED && statusReport != NULL &&
+        statusReport->mProfileId == kWeaveProfile_Common && statusReport->mStatusCode == nl::Weave::Profiles::Common::kStatus_Busy)
+    {
+        // Retry once the server has had time to tear down the old connection.
+        session->BusyCount++;
+        session->RetryTime = System::Timer::GetCurrentEpoch() + 100;
+    }
+}
+
+static void HandlePASETestConnectionComplete(WeaveConnection *con, WEAVE_ERROR conErr)
+{
+    PASETestSession *session = static_cast<PASETestSession *>(con->AppState);
+    const uint8_t *pw = reinterpret_cast<const uint8_t *>(PASETestNode::kPASETestPairingCode);
+
+    if (conErr == WEAVE_NO_ERROR)
+    {
+        conErr = session->Node->SecurityMgr.StartPASESession(con, kWeaveAuthMode_PASE_PairingCode, session,
+                                                             HandlePASETestSessionEstablished, HandlePASETestSessionError,
+                                                             pw, strlen(PASETestNode::kPASETestPairingCode));
+    }
+
+    if (conErr != WEAVE_NO_ERROR)
+    {
+        session->Done = true;
+        session->Err = conErr;
+    }
+}
+
+static void StartPASETestSession(PASETestSession &session)
+{
+    WEAVE_ERROR err;
+    IPAddress serverAddr;
+
+    IPAddress::FromString(kPASETestServerAddr, serverAddr);
+
+    if (session.Con != NULL)
+        session.Con->Close();
+
+    session.Done = false;
+    session.Err = WEAVE_NO_ERROR;
+    session.Con = session.Node->MessageLayer.NewConnection();
+    if (session.Con == NULL)
+    {
+        printf("NewConnection failed\n");
+        exit(-1);
+    }
+    session.Con->AppState = &session;
+    session.Con->OnConnectionComplete = HandlePASETestConnectionComplete;
+
+    err = session.Con->Connect(kPASETestServerNodeId, kWeaveAuthMode_Unauthenticated, serverAddr);
+    FAIL_ERROR(err, "WeaveConnection.Connect failed");
+}
+
+void PASESessionTest_ConcurrentInitiators()
+{
+    // The server accepts at most WEAVE_CONFIG_MAX_INCOMING_TCP_CON_FROM_SINGLE_IP connections from the
+    // loopback address that all of the clients connect from.
+    enum { kNumClients = 2 };
+    static PASETestNode server;
+    static PASETestNode clients[kNumClients];
+    PASETestSession sessions[kNumClients];
+    uint64_t deadline;
+    uint32_t busyCount = 0;
+    bool allDone;
+
+    printf("PASE Concurrent Initiators\n");
+
+    InitSystemLayer();
+    InitNetwork();
+
+    server.Init(kPASETestServerNodeId, kPASETestServerAddr, true);
+
+    // Each client starts a session at the same time.  The server runs up to
+    // WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES of them at once, admits others as handshakes
+    // finish if it has an admission queue, and answers any that do not fit with a busy status report, after
+    // which the client tries again.  The standalone configuration allows two, so that both run at once.
+    for (int i = 0; i < kNumClients; i++)
+    {
+        char addr[16];
+
+        snprintf(addr, sizeof(addr), "127.0.0.%d", i + 3);
+        clients[i].Init(kPASETestServerNodeId + i + 1, addr, false);
+
+        memset(&sessions[i], 0, sizeof(sessions[i]));
+        sessions[i].Node = &clients[i];
+        StartPASETestSession(sessions[i]);
+    }
+
+    deadline = System::Timer::GetCurrentEpoch() + 60000;
+    do
+    {
+        struct timeval sleepTime;
+        sleepTime.tv_sec = 0;
+        sleepTime.tv_usec = 10000;
+
+        ServiceEvents(sleepTime);
+
+        allDone = true;
+        for (int i = 0; i < kNumClients; i++)
+        {
+            if (sessions[i].Done && sessions[i].RetryTime != 0 && sessions[i].Con != NULL)
+            {
+                sessions[i].Con->Close();
+                sessions[i].Con = NULL;
+            }
+
+            if (sessions[i].Done && sessions[i].RetryTime != 0 && System::Timer::GetCurrentEpoch() >= sessions[i].RetryTime)
+            {
+                sessions[i].RetryTime = 0;
+                StartPASETestSession(sessions[i]);
+            }
+            allDone = allDone && sessions[i].Done && sessions[i].RetryTime == 0;
+        }
+    } while (!allDone && System::Timer::GetCurrentEpoch() < deadline);
+
+    for (int i = 0; i < kNumClients; i++)
+    {
+        WeaveSessionKey *sessionKey;
+
+        if (!sessions[i].Done || sessions[i].Err != WEAVE_NO_ERROR)
+        {
+            printf("Client %d failed to establish a PASE session: %s\n", i,
+                   sessions[i].Done ? ErrorStr(sessions[i].Err) : "timeout");
+            exit(-1);
+        }
+
+        // The session is known to the server under the same key id.
+        if (server.FabricState.GetSessionKey(sessions[i].SessionKeyId, clients[i].FabricState.LocalNodeId, sessionKey) != WEAVE_NO_ERROR)
+        {
+            printf("Server has no session key for client %d\n", i);
+            exit(-1);
+        }
+
+        busyCount += sessions[i].BusyCount;
+    }
+
+    // With room for every handshake, either running or waiting, no client is turned away.
+    if ((WEAVE_CONFIG_SECURITY_MGR_MAX_CONCURRENT_HANDSHAKES + WEAVE_CONFIG_SECURITY_MGR_ADMISSION_QUEUE_SIZE >= kNumClients) &&
+        busyCount != 0)
+    {
+        printf("Server answered busy %" PRIu32 " times\n", busyCount);
+        exit(-1);
+    }
+
+    for (int i = 0; i < kNumClients; i++)
+    {
+        sessions[i].Con->Close();
+        clients[i].Shutdown();
+    }
+    server.Shutdown();
+
+    ShutdownNetwork();
+    ShutdownSystemLayer();
+
+    printf("PASE Concurrent Initiators: %" PRIu32 " busy responses\n", busyCount);
+}
+
+#endif // WEAVE_CONFIG_ENABLE_TARGETED_LISTEN && INET_CONFIG_ENABLE_IPV4
+
 void PASEEngine_ExternalFuzzingEngine(const char *fuzzLocation, const uint8_t *fuzzInput, size_t fuzzInputSize)
 {
     MessageExternalFuzzer fuzzer = MessageExternalFuzzer(fuzzLocation)
@@ -175,5 +422,8 @@ int main(int argc, char *argv[])
     PASEEngine_ConfigTest1();
     PASEEngine_ConfigTest4();
     PASEEngineTest_MixedConfigs();
+#if WEAVE_CONFIG_ENABLE_TARGETED_LISTEN && INET_CONFIG_ENABLE_IPV4
+    PASESessionTest_ConcurrentInitiators();
+#endif
     printf("All tests succeeded\n");
 }
@@ -116,6 +116,7 @@ SubscriptionEngine * SubscriptionEngine::GetInstance()
 
 static void CheckDataSourceEmptySchema(nlTestSuite *inSuite, void *inContext);
 static void CheckDataSinkEmptySchema(nlTestSuite *inSuite, void *inContext);
+static void CheckTraitStructCodec(nlTestSuite *inSuite, void *inContext);
 
 static void TestTdmStatic_SingleLeafHandle(nlTestSuite *inSuite, void *inContext);
 static void TestTdmStatic_SingleLevelMerge(nlTestSuite *inSuite, void *inContext);
@@ -172,6 +173,7 @@ static void CheckSynchronizedTraitState(nlTestSuite *inSuite, void *inContext);
 static const nlTest sTests[] = {
     NL_TEST_DEF("Test TraitDataSource + schema with no properties",  CheckDataSourceEmptySchema),
     NL_TEST_DEF("Test TraitDataSink + schema with no properties",    CheckDataSinkEmptySchema),
+    NL_TEST_DEF("Test TraitStructCodec source + sink",                CheckTraitStructCodec),
 
     // Tests the static schema portions of TDM
     NL_TEST_DEF("Test Tdm (Static schema): Single leaf handle", TestTdmStatic_SingleLeafHandle),
@@ -391,6 +393,198 @@ exit:
     return;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Testing TraitStructCodec
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+enum
+{
+    kStructPropertyHandle_Root = 1,
+    kStructPropertyHandle_A    = 2,
+    kStructPropertyHandle_B    = 3,
+    kStructPropertyHandle_C    = 4
+};
+
+const TraitSchemaEngine::PropertyInfo gStructPropertyMap[] = {
+    { kStructPropertyHandle_Root, 1 }, // a
+    { kStructPropertyHandle_Root, 2 }, // b
+    { kStructPropertyHandle_Root, 3 }, // c
+};
+
+const TraitSchemaEngine gStructTraitSchema = {
+    {
+        0x0,
+        gStructPropertyMap,
+        sizeof(gStructPropertyMap) / sizeof(gStructPropertyMap[0]),
+        1,
+#if (TDM_EXTENSION_SUPPORT) || (TDM_VERSIONING_SUPPORT)
+        4,
+#endif
+#if (TDM_DICTIONARY_SUPPORT)
+        NULL,
+#endif
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+#if (TDM_EXTENSION_SUPPORT)
+        NULL,
+#endif
+#if (TDM_VERSIONING_SUPPORT)
+        NULL,
+#endif
+    }
+};
+
+struct TestStructTraitState
+{
+    uint32_t a;
+    bool b;
+    int16_t c;
+};
+
+typedef TraitStructCodec<TestStructTraitState,
+    TraitStructFields<TraitStructField<TestStructTraitState, uint32_t, &TestStructTraitState::a, kStructPropertyHandle_A, 1>,
+    TraitStructFields<TraitStructField<TestStructTraitState, bool, &TestStructTraitState::b, kStructPropertyHandle_B, 2>,
+    TraitStructFields<TraitStructField<TestStructTraitState, int16_t, &TestStructTraitState::c, kStructPropertyHandle_C, 3> > > > >
+    TestStructCodec;
+
+class TestStructDataSource : public TraitStructDataSource<TestStructCodec> {
+public:
+    TestStructDataSource(const TraitSchemaEngine *aSchema) : TraitStructDataSource<TestStructCodec>(aSchema) { }
+
+    using TraitStructDataSource<TestStructCodec>::mData;
+};
+
+class TestStructDataSink : public TraitStructDataSink<TestStructCodec> {
+public:
+    TestStructDataSink(const TraitSchemaEngine *aSchema) : TraitStructDataSink<TestStructCodec>(aSchema) { }
+
+    using TraitStructDataSink<TestStructCodec>::mData;
+};
+
+// Publishes the same values as TestStructDataSource through the schema engine.
+class TestGenericStructDataSource : public TraitDataSource {
+public:
+    TestGenericStructDataSource(const TraitSchemaEngine *aSchema) : TraitDataSource(aSchema) { }
+
+    WEAVE_ERROR GetLeafData(PropertyPathHandle aLeafHandle, uint64_t aTagToWrite, TLVWriter &aWriter)
+    {
+        switch (aLeafHandle)
+        {
+        case kStructPropertyHandle_A:
+            return aWriter.Put(aTagToWrite, mData.a);
+        case kStructPropertyHandle_B:
+            return aWriter.PutBoolean(aTagToWrite, mData.b);
+        case kStructPropertyHandle_C:
+            return aWriter.Put(aTagToWrite, mData.c);
+        default:
+            return WEAVE_ERROR_TLV_TAG_NOT_FOUND;
+        }
+    }
+
+    TestStructTraitState mData;
+};
+
+static WEAVE_ERROR EncodeStructDataElement(TraitDataSource &aSource, PropertyPathHandle aHandle, uint8_t *aBuf, uint32_t aBufSize, uint32_t &aLen)
+{
+    WEAVE_ERROR err;
+    TLVWriter writer;
+    TLVType dummyContainerType;
+
+    writer.Init(aBuf, aBufSize);
+
+    err = writer.StartContainer(AnonymousTag, kTLVType_Structure, dummyContainerType);
+    SuccessOrExit(err);
+
+    err = writer.Put(ContextTag(DataElement::kCsTag_Version), (uint64_t)1);
+    SuccessOrExit(err);
+
+    err = aSource.ReadData(aHandle, ContextTag(DataElement::kCsTag_Data), writer);
+    SuccessOrExit(err);
+
+    err = writer.EndContainer(dummyContainerType);
+    SuccessOrExit(err);
+
+    err = writer.Finalize();
+    SuccessOrExit(err);
+
+    aLen = writer.GetLengthWritten();
+
+exit:
+    return err;
+}
+
+static void CheckTraitStructCodec(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err;
+    TestStructDataSource source(&gStructTraitSchema);
+    TestGenericStructDataSource genericSource(&gStructTraitSchema);
+    TestStructDataSink sink(&gStructTraitSchema);
+    TestStructDataSource emptySource(&gEmptyTraitSchema);
+    uint8_t buf[128];
+    uint8_t genericBuf[128];
+    uint32_t len, genericLen;
+    TLVReader reader;
+
+    NL_TEST_ASSERT(inSuite, TestStructCodec::IsCompatible(gStructTraitSchema));
+    NL_TEST_ASSERT(inSuite, !TestStructCodec::IsCompatible(gEmptyTraitSchema));
+
+    source.mData.a = 0x12345678;
+    source.mData.b = true;
+    source.mData.c = -300;
+    genericSource.mData = source.mData;
+
+    // The codec must produce exactly what the schema engine produces.
+    err = EncodeStructDataElement(source, kRootPropertyPathHandle, buf, sizeof(buf), len);
+    SuccessOrExit(err);
+
+    err = EncodeStructDataElement(genericSource, kRootPropertyPathHandle, genericBuf, sizeof(genericBuf), genericLen);
+    SuccessOrExit(err);
+
+    NL_TEST_ASSERT(inSuite, len == genericLen && memcmp(buf, genericBuf, len) == 0);
+
+    // Store the whole instance.
+    reader.Init(buf, len);
+
+    err = reader.Next();
+    SuccessOrExit(err);
+
+    err = sink.StoreDataElement(kRootPropertyPathHandle, reader, TraitDataSink::kFirstElementInChange | TraitDataSink::kLastElementInChange, NULL, NULL);
+    SuccessOrExit(err);
+
+    NL_TEST_ASSERT(inSuite, sink.mData.a == 0x12345678);
+    NL_TEST_ASSERT(inSuite, sink.mData.b == true);
+    NL_TEST_ASSERT(inSuite, sink.mData.c == -300);
+
+    // A single leaf goes through the schema engine, and is read from and stored into the same struct.
+    source.mData.b = false;
+
+    err = EncodeStructDataElement(source, kStructPropertyHandle_B, buf, sizeof(buf), len);
+    SuccessOrExit(err);
+
+    reader.Init(buf, len);
+
+    err = reader.Next();
+    SuccessOrExit(err);
+
+    err = sink.StoreDataElement(kStructPropertyHandle_B, reader, TraitDataSink::kFirstElementInChange | TraitDataSink::kLastElementInChange, NULL, NULL);
+    SuccessOrExit(err);
+
+    NL_TEST_ASSERT(inSuite, sink.mData.b == false);
+    NL_TEST_ASSERT(inSuite, sink.mData.a == 0x12345678);
+
+    // A schema that doesn't match the codec falls back to the schema engine.
+    err = EncodeStructDataElement(emptySource, kRootPropertyPathHandle, buf, sizeof(buf), len);
+    SuccessOrExit(err);
+
+exit:
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    return;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Testing NotificationEngine + TraitData
@@ -24,12 +24,17 @@
 
 #include "ToolCommon.h"
 
+#include <math.h>
+
 #include <nlbyteorder.h>
 #include <nlunit-test.h>
 
 #include <Weave/Core/WeaveCore.h>
 #include <Weave/Core/WeaveTLV.h>
 #include <Weave/Core/WeaveTLVDebug.hpp>
+#include <Weave/Core/WeaveTLVIndex.h>
+#include <Weave/Core/WeaveTLVJson.h>
+#include <Weave/Core/WeaveTLVPushParser.h>
 #include <Weave/Core/WeaveTLVUtilities.hpp>
 #include <Weave/Core/WeaveTLVData.hpp>
 #include <Weave/Core/WeaveCircularTLVBuffer.h>
@@ -1565,270 +1570,1635 @@ void CheckWeaveTLVUtilities(nlTestSuite *inSuite, void *inContext)
 }
 
 /**
- *  Test Weave TLV Empty Find
+ *  Test Weave TLV Sizer
  */
-void CheckWeaveTLVEmptyFind(nlTestSuite *inSuite, void *inContext)
+void CheckWeaveTLVSizer(nlTestSuite *inSuite, void *inContext)
 {
-    uint8_t buf[30];
-    TLVWriter writer;
-    TLVReader reader;
-    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    TLVSizer sizer;
+    WEAVE_ERROR err;
 
-    writer.Init(buf, sizeof(buf));
-    writer.ImplicitProfileId = TestProfile_2;
+    // Measure an encoding that spans many discard buffers
+    sizer.Init();
+    sizer.ImplicitProfileId = TestProfile_2;
 
-    WriteEmptyEncoding(inSuite, writer);
+    WriteEncoding1(inSuite, sizer);
 
-    uint32_t encodedLen = writer.GetLengthWritten();
+    NL_TEST_ASSERT(inSuite, sizer.GetLengthWritten() == sizeof(Encoding1));
 
-    reader.Init(buf, encodedLen);
-    reader.ImplicitProfileId = TestProfile_2;
+    // A limit is enforced just as it would be by a writer
+    sizer.Init(sizeof(sLargeString) - 1);
 
-    // Find the empty container
-    TLVReader tagReader;
-    err = nl::Weave::TLV::Utilities::Find(reader, ProfileTag(TestProfile_1, 256), tagReader);
-    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = sizer.PutString(AnonymousTag, sLargeString);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_BUFFER_TOO_SMALL);
 }
 
-uint8_t Encoding2[] =
-{
-    // Container 1
-    0xD5, 0xBB, 0xAA, 0xDD, 0xCC, 0x01, 0x00,
-        0xC9, 0xBB, 0xAA, 0xDD, 0xCC, 0x02, 0x00,
-        0x88, 0x02, 0x00,
-    0x18,
-    // Container 2
-    0x95, 0x01, 0x00,
-        0x88, 0x02, 0x00,
-        0xC9, 0xBB, 0xAA, 0xDD, 0xCC, 0x02, 0x00,
-    0x18
-};
-
-uint8_t AppendedEncoding2[] =
-{
-    // Container 1
-    0xD5, 0xBB, 0xAA, 0xDD, 0xCC, 0x01, 0x00,
-        0xC9, 0xBB, 0xAA, 0xDD, 0xCC, 0x02, 0x00,
-        0x88, 0x02, 0x00,
-        0xC8, 0xBB, 0xAA, 0xDD, 0xCC, 0x02, 0x00,
-        0x89, 0x02, 0x00,
-        0xD5, 0xBB, 0xAA, 0xDD, 0xCC, 0x01, 0x00,
-            0xC9, 0xBB, 0xAA, 0xDD, 0xCC, 0x02, 0x00,
-            0x88, 0x02, 0x00,
-        0x18,
-        0x95, 0x01, 0x00,
-            0x88, 0x02, 0x00,
-            0xC9, 0xBB, 0xAA, 0xDD, 0xCC, 0x02, 0x00,
-        0x18,
-    0x18,
-    // Container 2
-    0x95, 0x01, 0x00,
-        0x88, 0x02, 0x00,
-        0xC9, 0xBB, 0xAA, 0xDD, 0xCC, 0x02, 0x00,
-    0x18
-};
-
-void WriteAppendReadTest0(nlTestSuite *inSuite)
+/**
+ *  Test Weave TLV Updater Batch Edits
+ */
+void CheckWeaveUpdaterApplyEdits(nlTestSuite *inSuite, void *inContext)
 {
-    uint8_t buf[74];
-    uint32_t updatedLen;
-
+    uint8_t buf[2048];
+    uint8_t falseVal[8], intVal[8], strVal[16];
+    uint32_t falseValLen, intValLen, strValLen;
+    uint32_t encodedLen;
     TLVWriter writer;
-    TLVReader reader;
-
-    writer.Init(buf, sizeof(buf));
-    writer.ImplicitProfileId = TestProfile_2;
-
-    WriteEncoding2(inSuite, writer);
+    TLVReader reader, result;
+    TLVUpdater updater;
+    WEAVE_ERROR err;
 
-    uint32_t encodedLen = writer.GetLengthWritten();
+    const uint64_t boolPath[] = { ProfileTag(TestProfile_1, 1), ProfileTag(TestProfile_1, 2) };
+    const uint64_t stringPath[] = { ProfileTag(TestProfile_1, 1), ProfileTag(TestProfile_1, 5) };
+    const uint64_t floatPath[] = { ProfileTag(TestProfile_1, 1), ProfileTag(TestProfile_2, 65535) };
+    const uint64_t newMemberPath[] = { ProfileTag(TestProfile_1, 1), ProfileTag(TestProfile_1, 100) };
+    const uint64_t newTopLevelPath[] = { ProfileTag(TestProfile_1, 3) };
+    const uint64_t missingPath[] = { ProfileTag(TestProfile_1, 1), ProfileTag(TestProfile_1, 77), ContextTag(1) };
 
-#ifdef DUMP_ENCODING
-    printf("Initial encoding:\n");
-    for (uint32_t i = 0; i < encodedLen; i++)
-    {
-        if (i != 0 && i % 16 == 0)
-            printf("\n");
-        printf("0x%02X, ", buf[i]);
-    }
-    printf("\n");
-#endif
+    // Encode the replacement values
+    writer.Init(falseVal, sizeof(falseVal));
+    err = writer.PutBoolean(AnonymousTag, false);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    falseValLen = writer.GetLengthWritten();
 
-    NL_TEST_ASSERT(inSuite, encodedLen == sizeof(Encoding2));
-    NL_TEST_ASSERT(inSuite, memcmp(buf, Encoding2, encodedLen) == 0);
+    writer.Init(intVal, sizeof(intVal));
+    err = writer.Put(AnonymousTag, static_cast<uint32_t>(7));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    intValLen = writer.GetLengthWritten();
 
-    // Append new data into encoding
-    AppendEncoding2(inSuite, buf, encodedLen, sizeof(buf), updatedLen);
+    writer.Init(strVal, sizeof(strVal));
+    err = writer.PutString(AnonymousTag, "new");
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    strValLen = writer.GetLengthWritten();
 
-#ifdef DUMP_ENCODING
-    printf("Updated encoding:\n");
-    for (uint32_t i = 0; i < updatedLen; i++)
+    // A size-preserving edit needs no free space and changes only the edited bytes
     {
-        if (i != 0 && i % 16 == 0)
-            printf("\n");
-        printf("0x%02X, ", buf[i]);
-    }
-    printf("\n");
-#endif
+        const TLVEdit edits[] = {
+            { boolPath, 2, TLVEdit::kOp_Replace, falseVal, falseValLen },
+        };
+        uint32_t diffs = 0;
+        bool val = true;
 
-    NL_TEST_ASSERT(inSuite, updatedLen == sizeof(AppendedEncoding2));
-    NL_TEST_ASSERT(inSuite, memcmp(buf, AppendedEncoding2, updatedLen) == 0);
+        memcpy(buf, Encoding1, sizeof(Encoding1));
 
-    reader.Init(buf, updatedLen);
-    reader.ImplicitProfileId = TestProfile_2;
+        err = updater.Init(buf, sizeof(Encoding1), sizeof(Encoding1));
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        updater.SetImplicitProfileId(TestProfile_2);
 
-    ReadAppendedEncoding2(inSuite, reader);
-}
+        err = updater.ApplyEdits(edits, sizeof(edits) / sizeof(edits[0]));
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
 
-void WriteFindAppendReadTest(nlTestSuite *inSuite, bool findContainer)
-{
-    uint8_t buf[74];
-    uint32_t updatedLen;
+        err = updater.Finalize();
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, updater.GetLengthWritten() == sizeof(Encoding1));
 
-    TLVWriter writer;
-    TLVReader reader;
+        for (size_t i = 0; i < sizeof(Encoding1); i++)
+            if (buf[i] != Encoding1[i])
+                diffs++;
+        NL_TEST_ASSERT(inSuite, diffs == 1);
 
-    writer.Init(buf, sizeof(buf));
-    writer.ImplicitProfileId = TestProfile_2;
+        reader.Init(buf, sizeof(Encoding1));
+        reader.ImplicitProfileId = TestProfile_2;
 
-    WriteEncoding2(inSuite, writer);
+        err = nl::Weave::TLV::Utilities::Find(reader, ProfileTag(TestProfile_1, 2), result);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
 
-    uint32_t encodedLen = writer.GetLengthWritten();
+        err = result.Get(val);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, val == false);
+    }
 
-#ifdef DUMP_ENCODING
-    printf("Initial encoding:\n");
-    for (uint32_t i = 0; i < encodedLen; i++)
+    // Edits that delete, resize and add elements, applied in one pass
     {
-        if (i != 0 && i % 16 == 0)
-            printf("\n");
-        printf("0x%02X, ", buf[i]);
-    }
-    printf("\n");
-#endif
+        const TLVEdit edits[] = {
+            { stringPath, 2, TLVEdit::kOp_Delete, NULL, 0 },
+            { floatPath, 2, TLVEdit::kOp_Replace, intVal, intValLen },
+            { newMemberPath, 2, TLVEdit::kOp_Replace, strVal, strValLen },
+            { newTopLevelPath, 1, TLVEdit::kOp_Replace, intVal, intValLen },
+        };
+        uint32_t intResult;
+        char strResult[8];
+        size_t count;
+
+        memcpy(buf, Encoding1, sizeof(Encoding1));
+
+        err = updater.Init(buf, sizeof(Encoding1), sizeof(buf));
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        updater.SetImplicitProfileId(TestProfile_2);
 
-    NL_TEST_ASSERT(inSuite, encodedLen == sizeof(Encoding2));
-    NL_TEST_ASSERT(inSuite, memcmp(buf, Encoding2, encodedLen) == 0);
+        err = updater.ApplyEdits(edits, sizeof(edits) / sizeof(edits[0]));
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
 
-    // Append new data into encoding
-    FindAppendEncoding2(inSuite, buf, encodedLen, sizeof(buf), updatedLen, findContainer);
+        err = updater.Finalize();
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
 
-#ifdef DUMP_ENCODING
-    printf("Updated encoding:\n");
-    for (uint32_t i = 0; i < updatedLen; i++)
-    {
-        if (i != 0 && i % 16 == 0)
-            printf("\n");
-        printf("0x%02X, ", buf[i]);
-    }
-    printf("\n");
-#endif
+        encodedLen = updater.GetLengthWritten();
 
-    NL_TEST_ASSERT(inSuite, updatedLen == sizeof(AppendedEncoding2));
-    NL_TEST_ASSERT(inSuite, memcmp(buf, AppendedEncoding2, updatedLen) == 0);
+        reader.Init(buf, encodedLen);
+        reader.ImplicitProfileId = TestProfile_2;
 
-    reader.Init(buf, updatedLen);
-    reader.ImplicitProfileId = TestProfile_2;
+        err = nl::Weave::TLV::Utilities::Find(reader, ProfileTag(TestProfile_1, 5), result);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_TLV_TAG_NOT_FOUND);
 
-    ReadAppendedEncoding2(inSuite, reader);
-}
+        err = nl::Weave::TLV::Utilities::Find(reader, ProfileTag(TestProfile_2, 65535), result);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        err = result.Get(intResult);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, intResult == 7);
 
-uint8_t Encoding3[] =
-{
-    // Container 1
-    0xD5, 0xBB, 0xAA, 0xDD, 0xCC, 0x01, 0x00,
-        0x88, 0x02, 0x00,
-    0x18,
-};
+        err = nl::Weave::TLV::Utilities::Find(reader, ProfileTag(TestProfile_1, 100), result);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        err = result.GetString(strResult, sizeof(strResult));
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, strcmp(strResult, "new") == 0);
 
-uint8_t AppendedEncoding3[] =
-{
-    // Container 1
-    0xD5, 0xBB, 0xAA, 0xDD, 0xCC, 0x01, 0x00,
-        0x88, 0x02, 0x00,
-        0x89, 0x02, 0x00,
-    0x18
-};
+        err = nl::Weave::TLV::Utilities::Find(reader, ProfileTag(TestProfile_1, 3), result);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, result.GetContainerType() == kTLVType_NotSpecified);
 
-void WriteAppendReadTest1(nlTestSuite *inSuite)
-{
-    uint8_t buf[14];
-    uint32_t updatedLen;
+        // 18 elements, less the deleted string, plus the two new elements
+        err = nl::Weave::TLV::Utilities::Count(reader, count);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, count == 19);
+    }
 
-    TLVWriter writer;
-    TLVReader reader;
+    // An edit within a container that doesn't exist
+    {
+        const TLVEdit edits[] = {
+            { missingPath, 3, TLVEdit::kOp_Replace, intVal, intValLen },
+            { boolPath, 2, TLVEdit::kOp_Replace, falseVal, falseValLen },
+        };
 
-    writer.Init(buf, sizeof(buf));
-    writer.ImplicitProfileId = TestProfile_2;
+        memcpy(buf, Encoding1, sizeof(Encoding1));
 
-    WriteEncoding3(inSuite, writer);
+        err = updater.Init(buf, sizeof(Encoding1), sizeof(buf));
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        updater.SetImplicitProfileId(TestProfile_2);
 
-    uint32_t encodedLen = writer.GetLengthWritten();
+        err = updater.ApplyEdits(edits, sizeof(edits) / sizeof(edits[0]));
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_TLV_TAG_NOT_FOUND);
+    }
 
-#ifdef DUMP_ENCODING
-    printf("Initial encoding:\n");
-    for (uint32_t i = 0; i < encodedLen; i++)
+    // Two edits with the same path are rejected before either is applied
     {
-        if (i != 0 && i % 16 == 0)
-            printf("\n");
-        printf("0x%02X, ", buf[i]);
-    }
-    printf("\n");
-#endif
+        const uint64_t sameBoolPath[] = { ProfileTag(TestProfile_1, 1), ProfileTag(TestProfile_1, 2) };
+        const TLVEdit edits[] = {
+            { boolPath, 2, TLVEdit::kOp_Replace, falseVal, falseValLen },
+            { stringPath, 2, TLVEdit::kOp_Delete, NULL, 0 },
+            { sameBoolPath, 2, TLVEdit::kOp_Delete, NULL, 0 },
+        };
 
-    NL_TEST_ASSERT(inSuite, encodedLen == sizeof(Encoding3));
-    NL_TEST_ASSERT(inSuite, memcmp(buf, Encoding3, encodedLen) == 0);
+        memcpy(buf, Encoding1, sizeof(Encoding1));
 
-    // Append new data into encoding
-    AppendEncoding3(inSuite, buf, encodedLen, sizeof(buf), updatedLen);
+        err = updater.Init(buf, sizeof(Encoding1), sizeof(buf));
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        updater.SetImplicitProfileId(TestProfile_2);
 
-#ifdef DUMP_ENCODING
-    printf("Updated encoding:\n");
-    for (uint32_t i = 0; i < updatedLen; i++)
-    {
-        if (i != 0 && i % 16 == 0)
-            printf("\n");
-        printf("0x%02X, ", buf[i]);
+        err = updater.ApplyEdits(edits, sizeof(edits) / sizeof(edits[0]));
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_ARGUMENT);
+        NL_TEST_ASSERT(inSuite, memcmp(buf, Encoding1, sizeof(Encoding1)) == 0);
     }
-    printf("\n");
-#endif
 
-    NL_TEST_ASSERT(inSuite, updatedLen == sizeof(AppendedEncoding3));
-    NL_TEST_ASSERT(inSuite, memcmp(buf, AppendedEncoding3, updatedLen) == 0);
+    // Invalid edits
+    {
+        const TLVEdit edits[] = {
+            { boolPath, 0, TLVEdit::kOp_Delete, NULL, 0 },
+        };
 
-    reader.Init(buf, updatedLen);
-    reader.ImplicitProfileId = TestProfile_2;
+        memcpy(buf, Encoding1, sizeof(Encoding1));
 
-    ReadAppendedEncoding3(inSuite, reader);
+        err = updater.Init(buf, sizeof(Encoding1), sizeof(buf));
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        err = updater.ApplyEdits(edits, sizeof(edits) / sizeof(edits[0]));
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_ARGUMENT);
+
+        err = updater.Next();
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        err = updater.ApplyEdits(NULL, 0);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INCORRECT_STATE);
+    }
 }
 
-uint8_t AppendedEncoding4[] =
+/**
+ *  Test Weave TLV Scratch Writer
+ */
+void CheckWeaveTLVScratch(nlTestSuite *inSuite, void *inContext)
 {
-    // Container 1
-    0xD5, 0xBB, 0xAA, 0xDD, 0xCC, 0x01, 0x00,
-        0x88, 0x02, 0x00,
-    0x18,
-};
+    uint8_t buf[64];
+    uint8_t expected[64];
+    uint8_t scratchBuf[64];
+    TLVWriter writer, containerWriter, scratchWriter;
+    uint32_t expectedLen;
+    WEAVE_ERROR err;
 
-void AppendReadTest(nlTestSuite *inSuite)
-{
-    uint8_t buf[11];
-    uint32_t updatedLen;
+    // The expected encoding, written directly
+    writer.Init(expected, sizeof(expected));
 
-    memset(buf, 0, sizeof(buf));
+    err = writer.OpenContainer(AnonymousTag, kTLVType_Structure, containerWriter);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
 
-#ifdef DUMP_ENCODING
-    printf("Initial encoding:\n");
-    for (uint32_t i = 0; i < sizeof(buf); i++)
-    {
-        if (i != 0 && i % 16 == 0)
-            printf("\n");
-        printf("0x%02X, ", buf[i]);
-    }
-    printf("\n");
-#endif
+    err = containerWriter.Put(ContextTag(1), static_cast<uint32_t>(42));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
 
-    // Append new data to encoding
-    AppendEncoding4(inSuite, buf, 0, sizeof(buf), updatedLen);
+    err = containerWriter.PutString(ContextTag(2), "This is a test");
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = writer.CloseContainer(containerWriter);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = writer.Finalize();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    expectedLen = writer.GetLengthWritten();
+
+    // The same encoding, with the members written through scratch writers
+    writer.Init(buf, expectedLen);
+
+    err = writer.OpenContainer(AnonymousTag, kTLVType_Structure, containerWriter);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = containerWriter.OpenScratch(scratchWriter, scratchBuf, sizeof(scratchBuf));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    // Context tags are accepted, as the scratch writer is within the structure
+    err = scratchWriter.Put(ContextTag(1), static_cast<uint32_t>(42));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = containerWriter.CommitScratch(scratchWriter);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    // An element too large for the remaining space is rejected without touching the output
+    err = containerWriter.OpenScratch(scratchWriter, scratchBuf, sizeof(scratchBuf));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = scratchWriter.PutString(ContextTag(2), "This is a longer test");
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = containerWriter.CommitScratch(scratchWriter);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+    // A smaller element fits
+    err = containerWriter.OpenScratch(scratchWriter, scratchBuf, sizeof(scratchBuf));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = scratchWriter.PutString(ContextTag(2), "This is a test");
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = containerWriter.CommitScratch(scratchWriter);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = writer.CloseContainer(containerWriter);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = writer.Finalize();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    NL_TEST_ASSERT(inSuite, writer.GetLengthWritten() == expectedLen);
+    NL_TEST_ASSERT(inSuite, memcmp(buf, expected, expectedLen) == 0);
+
+    // A scratch writer left inside a container cannot be committed
+    writer.Init(buf, sizeof(buf));
+
+    err = writer.OpenScratch(scratchWriter, scratchBuf, sizeof(scratchBuf));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = scratchWriter.OpenContainer(AnonymousTag, kTLVType_Array, containerWriter);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = writer.CommitScratch(scratchWriter);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_TLV_CONTAINER_OPEN);
+    NL_TEST_ASSERT(inSuite, writer.GetLengthWritten() == 0);
+}
+
+/**
+ *  Hash the first element of a TLV encoding.
+ */
+static uint64_t HashEncoding(nlTestSuite *inSuite, const uint8_t *aEncoding, uint32_t aEncodingLen, uint32_t aImplicitProfileId)
+{
+    WEAVE_ERROR err;
+    TLVReader reader;
+    uint64_t hash = 0;
+
+    reader.Init(aEncoding, aEncodingLen);
+    reader.ImplicitProfileId = aImplicitProfileId;
+
+    err = nl::Weave::TLV::Utilities::Hash(reader, hash);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    return hash;
+}
+
+struct SmallBufferContext
+{
+    const uint8_t *mReadPoint;
+    const uint8_t *mEnd;
+    uint32_t mBufLen;
+};
+
+/**
+ *  Feed a TLVReader the rest of an encoding a few bytes at a time.
+ */
+static WEAVE_ERROR GetNextSmallBuffer(TLVReader &aReader, uintptr_t &aBufHandle, const uint8_t *&aBufStart, uint32_t &aBufLen)
+{
+    SmallBufferContext *context = static_cast<SmallBufferContext *>(aReader.AppData);
+
+    aBufStart = context->mReadPoint;
+    aBufLen = context->mEnd - context->mReadPoint;
+    if (aBufLen > context->mBufLen)
+        aBufLen = context->mBufLen;
+
+    context->mReadPoint += aBufLen;
+
+    return WEAVE_NO_ERROR;
+}
+
+/**
+ *  Test Weave TLV Utilities Hash
+ */
+void CheckWeaveTLVHash(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err;
+    uint8_t buf[2 * sizeof(Encoding1)];
+    uint8_t buf2[2 * sizeof(Encoding1)];
+    TLVWriter writer;
+    TLVReader reader;
+    TLVType outerContainerType, arrayContainerType;
+    uint64_t hash, hash2;
+
+    // The same integer value, encoded with 1 and 8 bytes.
+    static const uint8_t int8Encoding[] = { 0x00, 0x2A };
+    static const uint8_t int64Encoding[] = { 0x03, 0x2A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    static const uint8_t uint8Encoding[] = { 0x04, 0x2A };
+    static const uint8_t int8Encoding2[] = { 0x00, 0x2B };
+
+    // Hashing does not move the reader, and a reader not yet positioned on an element hashes the next one.
+    reader.Init(Encoding1, sizeof(Encoding1));
+    reader.ImplicitProfileId = TestProfile_2;
+
+    err = nl::Weave::TLV::Utilities::Hash(reader, hash);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = reader.Next();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = nl::Weave::TLV::Utilities::Hash(reader, hash2);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, hash == hash2);
+    NL_TEST_ASSERT(inSuite, reader.GetType() == kTLVType_Structure);
+    NL_TEST_ASSERT(inSuite, reader.GetTag() == ProfileTag(TestProfile_1, 1));
+
+    err = reader.Next();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_END_OF_TLV);
+
+    err = nl::Weave::TLV::Utilities::Hash(reader, hash2);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_END_OF_TLV);
+
+    // Implicit tags hash as the tags they stand for.
+    writer.Init(buf, sizeof(buf));
+    WriteEncoding1(inSuite, writer);
+    NL_TEST_ASSERT(inSuite, HashEncoding(inSuite, buf, writer.GetLengthWritten(), kProfileIdNotSpecified) == hash);
+
+    // Encodings that straddle input buffers hash as contiguous ones do.
+    {
+        PacketBuffer *pktBuf = PacketBuffer::New(0);
+
+        pktBuf->SetStart(pktBuf->Start() + pktBuf->MaxDataLength() - 10);
+
+        writer.Init(pktBuf);
+        writer.GetNewBuffer = TLVWriter::GetNewPacketBuffer;
+        writer.ImplicitProfileId = TestProfile_2;
+
+        WriteEncoding1(inSuite, writer);
+
+        reader.Init(pktBuf, 0xFFFFFFFFUL, true);
+        reader.ImplicitProfileId = TestProfile_2;
+
+        err = nl::Weave::TLV::Utilities::Hash(reader, hash2);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, hash2 == hash);
+
+        PacketBuffer::Free(pktBuf);
+    }
+
+    // String values that span any number of input buffers hash as contiguous ones do.
+    {
+        PacketBuffer *pktBuf = PacketBuffer::New(0);
+        SmallBufferContext context;
+        const uint32_t headLen = 2;
+
+        writer.Init(buf, sizeof(buf));
+
+        err = writer.PutString(AnonymousTag, "!123456789ABCDEF@123456789ABCDEF#123456789ABCDEF$123456789ABCDEF");
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        err = writer.Finalize();
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        hash = HashEncoding(inSuite, buf, writer.GetLengthWritten(), kProfileIdNotSpecified);
+
+        // Only the 2-byte element head is held in the first buffer; the value follows in 32 2-byte ones.
+        memcpy(pktBuf->Start(), buf, headLen);
+        pktBuf->SetDataLength(headLen);
+
+        context.mReadPoint = buf + headLen;
+        context.mEnd = buf + writer.GetLengthWritten();
+        context.mBufLen = 2;
+
+        reader.Init(pktBuf);
+        reader.GetNextBuffer = GetNextSmallBuffer;
+        reader.AppData = &context;
+
+        err = nl::Weave::TLV::Utilities::Hash(reader, hash2);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, hash2 == hash);
+
+        PacketBuffer::Free(pktBuf);
+    }
+
+    // Integer and floating point encodings of different sizes hash alike; types and values do not.
+    NL_TEST_ASSERT(inSuite, HashEncoding(inSuite, int8Encoding, sizeof(int8Encoding), kProfileIdNotSpecified) ==
+                            HashEncoding(inSuite, int64Encoding, sizeof(int64Encoding), kProfileIdNotSpecified));
+    NL_TEST_ASSERT(inSuite, HashEncoding(inSuite, int8Encoding, sizeof(int8Encoding), kProfileIdNotSpecified) !=
+                            HashEncoding(inSuite, uint8Encoding, sizeof(uint8Encoding), kProfileIdNotSpecified));
+    NL_TEST_ASSERT(inSuite, HashEncoding(inSuite, int8Encoding, sizeof(int8Encoding), kProfileIdNotSpecified) !=
+                            HashEncoding(inSuite, int8Encoding2, sizeof(int8Encoding2), kProfileIdNotSpecified));
+
+    writer.Init(buf, sizeof(buf));
+    err = writer.Put(AnonymousTag, 1.5f);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    hash = HashEncoding(inSuite, buf, writer.GetLengthWritten(), kProfileIdNotSpecified);
+
+    writer.Init(buf, sizeof(buf));
+    err = writer.Put(AnonymousTag, 1.5);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, HashEncoding(inSuite, buf, writer.GetLengthWritten(), kProfileIdNotSpecified) == hash);
+
+    // Structure members hash alike in any order, while array members do not.
+    for (int pass = 0; pass < 2; pass++)
+    {
+        uint8_t *passBuf = (pass == 0) ? buf : buf2;
+
+        writer.Init(passBuf, sizeof(buf));
+
+        err = writer.StartContainer(AnonymousTag, kTLVType_Structure, outerContainerType);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        for (int i = 0; i < 3; i++)
+        {
+            switch ((pass == 0) ? i : 2 - i)
+            {
+            case 0:
+                err = writer.Put(ContextTag(1), static_cast<uint8_t>(7));
+                break;
+            case 1:
+                err = writer.PutString(ContextTag(2), "abc");
+                break;
+            default:
+                err = writer.StartContainer(ContextTag(3), kTLVType_Array, arrayContainerType);
+                NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+                err = writer.Put(AnonymousTag, static_cast<uint8_t>(pass));
+                NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+                err = writer.Put(AnonymousTag, static_cast<uint8_t>(1 - pass));
+                NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+                err = writer.EndContainer(arrayContainerType);
+                break;
+            }
+            NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        }
+
+        err = writer.EndContainer(outerContainerType);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        err = writer.Finalize();
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        if (pass == 0)
+            hash = HashEncoding(inSuite, buf, writer.GetLengthWritten(), kProfileIdNotSpecified);
+        else
+            hash2 = HashEncoding(inSuite, buf2, writer.GetLengthWritten(), kProfileIdNotSpecified);
+    }
+
+    // The two structures differ only in the order of the array members.
+    NL_TEST_ASSERT(inSuite, hash != hash2);
+
+    // Swap the array members, which follow the array's control byte and tag at the start of the
+    // second structure, back, leaving only the structure members reordered.
+    NL_TEST_ASSERT(inSuite, buf2[1] == 0x36 && buf2[3] == 0x04 && buf2[5] == 0x04);
+    buf2[4] = 0;
+    buf2[6] = 1;
+
+    NL_TEST_ASSERT(inSuite, HashEncoding(inSuite, buf2, writer.GetLengthWritten(), kProfileIdNotSpecified) == hash);
+
+    // Containers nested too deeply are rejected rather than exhausting the stack.
+    {
+        const uint32_t deepCount = 100000;
+        const uint32_t maxDepth = nl::Weave::TLV::Utilities::kMaxHashDepth;
+        uint8_t *deepArrays = (uint8_t *)malloc(2 * deepCount);
+
+        NL_TEST_ASSERT(inSuite, deepArrays != NULL);
+
+        memset(deepArrays, 0x16, deepCount);
+        memset(deepArrays + deepCount, 0x18, deepCount);
+
+        // The deepest nesting accepted...
+        reader.Init(deepArrays + deepCount - maxDepth, 2 * maxDepth);
+        err = nl::Weave::TLV::Utilities::Hash(reader, hash);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        // ...one level deeper...
+        reader.Init(deepArrays + deepCount - maxDepth - 1, 2 * (maxDepth + 1));
+        err = nl::Weave::TLV::Utilities::Hash(reader, hash);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_TLV_ELEMENT);
+
+        // ...and far deeper.
+        reader.Init(deepArrays, 2 * deepCount);
+        err = nl::Weave::TLV::Utilities::Hash(reader, hash);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_TLV_ELEMENT);
+
+        free(deepArrays);
+    }
+}
+
+/**
+ *  Test Weave TLV Profile Dictionary
+ */
+void CheckWeaveTLVProfileDictionary(nlTestSuite *inSuite, void *inContext)
+{
+    WEAVE_ERROR err;
+    uint8_t buf[2 * sizeof(Encoding1)];
+    TLVWriter writer;
+    TLVReader reader;
+    uint32_t plainLen, implicitLen, dictLen;
+
+    static const uint32_t profileIds[] = { TestProfile_1, TestProfile_2 };
+    static const TLVProfileDictionary dict = { profileIds, 2 };
+    static const TLVProfileDictionary shortDict = { profileIds, 1 };
+
+    // With a dictionary, tags of both test profiles are encoded in implicit form.
+    writer.Init(buf, sizeof(buf));
+    WriteEncoding1(inSuite, writer);
+    plainLen = writer.GetLengthWritten();
+
+    writer.Init(buf, sizeof(buf));
+    writer.ImplicitProfileId = TestProfile_2;
+    WriteEncoding1(inSuite, writer);
+    implicitLen = writer.GetLengthWritten();
+
+    writer.Init(buf, sizeof(buf));
+    writer.ImplicitProfileId = TestProfile_2;
+    writer.ProfileDictionary = &dict;
+    WriteEncoding1(inSuite, writer);
+    dictLen = writer.GetLengthWritten();
+
+    NL_TEST_ASSERT(inSuite, dictLen < implicitLen);
+
+    reader.Init(buf, dictLen);
+    reader.ImplicitProfileId = TestProfile_2;
+    reader.ProfileDictionary = &dict;
+    ReadEncoding1(inSuite, reader);
+
+    // The dictionary can be used without an implicit profile.
+    writer.Init(buf, sizeof(buf));
+    writer.ProfileDictionary = &dict;
+    WriteEncoding1(inSuite, writer);
+    NL_TEST_ASSERT(inSuite, writer.GetLengthWritten() < plainLen);
+
+    reader.Init(buf, writer.GetLengthWritten());
+    reader.ProfileDictionary = &dict;
+    ReadEncoding1(inSuite, reader);
+
+    // A dictionary tag holds the position of the profile in its top 8 bits, and tag numbers too large
+    // for the remaining 24 bits are fully qualified.
+    {
+        static const uint8_t expectedEncoding[] =
+        {
+            0xA4, 0x05, 0x00, 0x00, 0x00, 0x01,
+            0xA4, 0x10, 0x00, 0x00, 0x01, 0x02,
+            0xE4, 0x22, 0x11, 0x44, 0x33, 0x00, 0x00, 0x00, 0x01, 0x03
+        };
+
+        writer.Init(buf, sizeof(buf));
+        writer.ProfileDictionary = &dict;
+
+        err = writer.Put(ProfileTag(TestProfile_1, 5), static_cast<uint8_t>(1));
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        err = writer.Put(ProfileTag(TestProfile_2, 16), static_cast<uint8_t>(2));
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        err = writer.Put(ProfileTag(TestProfile_2, TLVProfileDictionary::kMaxTagNum + 1), static_cast<uint8_t>(3));
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        err = writer.Finalize();
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        NL_TEST_ASSERT(inSuite, writer.GetLengthWritten() == sizeof(expectedEncoding));
+        NL_TEST_ASSERT(inSuite, memcmp(buf, expectedEncoding, sizeof(expectedEncoding)) == 0);
+    }
+
+    // Dictionary tags cannot be read without the dictionary, or with a dictionary that is too short.
+    reader.Init(buf, writer.GetLengthWritten());
+    err = reader.Next();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_UNKNOWN_IMPLICIT_TLV_TAG);
+
+    reader.Init(buf, writer.GetLengthWritten());
+    reader.ProfileDictionary = &shortDict;
+
+    err = reader.Next();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, reader.GetTag() == ProfileTag(TestProfile_1, 5));
+
+    err = reader.Next();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_UNKNOWN_IMPLICIT_TLV_TAG);
+}
+
+/**
+ *  Test Weave TLV Empty Find
+ */
+void CheckWeaveTLVEmptyFind(nlTestSuite *inSuite, void *inContext)
+{
+    uint8_t buf[30];
+    TLVWriter writer;
+    TLVReader reader;
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    writer.Init(buf, sizeof(buf));
+    writer.ImplicitProfileId = TestProfile_2;
+
+    WriteEmptyEncoding(inSuite, writer);
+
+    uint32_t encodedLen = writer.GetLengthWritten();
+
+    reader.Init(buf, encodedLen);
+    reader.ImplicitProfileId = TestProfile_2;
+
+    // Find the empty container
+    TLVReader tagReader;
+    err = nl::Weave::TLV::Utilities::Find(reader, ProfileTag(TestProfile_1, 256), tagReader);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+}
+
+struct IndexCheckContext
+{
+    nlTestSuite *mSuite;
+    const TLVIndex *mIndex;
+    uint16_t mNext;
+};
+
+static WEAVE_ERROR IndexCheckHandler(const TLVReader &aReader, size_t aDepth, void *aContext)
+{
+    IndexCheckContext *context = static_cast<IndexCheckContext *>(aContext);
+    nlTestSuite *inSuite = context->mSuite;
+    TLVReader indexReader;
+    WEAVE_ERROR err;
+
+    NL_TEST_ASSERT(inSuite, context->mNext < context->mIndex->GetCount());
+
+    const TLVIndex::Entry & entry = context->mIndex->GetEntry(context->mNext);
+
+    NL_TEST_ASSERT(inSuite, entry.Tag == aReader.GetTag());
+    NL_TEST_ASSERT(inSuite, entry.Type == aReader.GetType());
+    NL_TEST_ASSERT(inSuite, entry.Depth == aDepth);
+
+    err = context->mIndex->GetReader(context->mNext, indexReader);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, indexReader.GetTag() == aReader.GetTag());
+    NL_TEST_ASSERT(inSuite, indexReader.GetType() == aReader.GetType());
+    NL_TEST_ASSERT(inSuite, indexReader.GetLength() == aReader.GetLength());
+
+    context->mNext++;
+
+    return WEAVE_NO_ERROR;
+}
+
+static void TestWeaveTLVIndex(nlTestSuite *inSuite, TLVIndex &index, const uint8_t *buf, uint32_t encodedLen)
+{
+    WEAVE_ERROR err;
+    TLVReader reader;
+    uint16_t entry, array;
+
+    index.ImplicitProfileId = TestProfile_2;
+
+    err = index.Build(buf, encodedLen);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, index.GetCount() == 18);
+
+    // Every element, in encoding order, matches a full walk of the encoding
+    {
+        IndexCheckContext context = { inSuite, &index, 0 };
+
+        reader.Init(buf, encodedLen);
+        reader.ImplicitProfileId = TestProfile_2;
+
+        err = nl::Weave::TLV::Utilities::Iterate(reader, IndexCheckHandler, &context);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_END_OF_TLV);
+        NL_TEST_ASSERT(inSuite, context.mNext == index.GetCount());
+    }
+
+    // Look up a nested element by tag path
+    {
+        const uint64_t path[] = { ProfileTag(TestProfile_1, 1), ProfileTag(TestProfile_2, 65536) };
+        double val;
+
+        err = index.FindPath(path, sizeof(path) / sizeof(path[0]), entry);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        err = index.GetReader(entry, reader);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        err = reader.Get(val);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, val == 17.9);
+
+        // The reader is scoped to the enclosing structure
+        err = reader.Next();
+        NL_TEST_ASSERT(inSuite, err == WEAVE_END_OF_TLV);
+    }
+
+    // Look up a tag that's not present
+    {
+        const uint64_t path[] = { ProfileTag(TestProfile_1, 1), ProfileTag(TestProfile_2, 1024) };
+
+        err = index.FindPath(path, sizeof(path) / sizeof(path[0]), entry);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_TLV_TAG_NOT_FOUND);
+
+        err = index.FindChild(TLVIndex::kNoEntry, ProfileTag(TestProfile_1, 2), entry);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_TLV_TAG_NOT_FOUND);
+    }
+
+    // Jump to array members by position
+    {
+        const uint64_t path[] = { ProfileTag(TestProfile_1, 1), ContextTag(0) };
+        uint64_t val;
+
+        err = index.FindPath(path, sizeof(path) / sizeof(path[0]), array);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        err = index.GetChild(array, 3, entry);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        err = index.GetReader(entry, reader);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        err = reader.Get(val);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, val == 40000000000ULL);
+
+        err = index.GetChild(array, 6, entry);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_END_OF_TLV);
+    }
+
+    // Descend through the path container to the string
+    {
+        err = index.GetChild(array, 5, entry);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, index.GetEntry(entry).Type == kTLVType_Path);
+
+        err = index.FindChild(entry, ProfileTag(TestProfile_2, 4000000000ULL), entry);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        err = index.FindChild(entry, CommonTag(70000), entry);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        err = index.GetReader(entry, reader);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        TestString(inSuite, reader, CommonTag(70000), sLargeString);
+    }
+}
+
+/**
+ *  Test Weave TLV Index
+ */
+void CheckWeaveTLVIndex(nlTestSuite *inSuite, void *inContext)
+{
+    uint8_t buf[2048];
+    TLVWriter writer;
+    TLVIndex index;
+    TLVIndex::Entry entries[18];
+    uint16_t lookup[18];
+    WEAVE_ERROR err;
+
+    writer.Init(buf, sizeof(buf));
+    writer.ImplicitProfileId = TestProfile_2;
+
+    WriteEncoding1(inSuite, writer);
+
+    uint32_t encodedLen = writer.GetLengthWritten();
+
+    // Binary search lookups
+    index.Init(entries, lookup, 18);
+    TestWeaveTLVIndex(inSuite, index, buf, encodedLen);
+
+    // Lookups that walk the index
+    index.Init(entries, NULL, 18);
+    TestWeaveTLVIndex(inSuite, index, buf, encodedLen);
+
+    // Not enough entries
+    index.Init(entries, lookup, 17);
+    index.ImplicitProfileId = TestProfile_2;
+    err = index.Build(buf, encodedLen);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_BUFFER_TOO_SMALL);
+    NL_TEST_ASSERT(inSuite, index.GetCount() == 0);
+
+    // Truncated encoding
+    index.Init(entries, lookup, 18);
+    index.ImplicitProfileId = TestProfile_2;
+    err = index.Build(buf, encodedLen - 1);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_TLV_UNDERRUN);
+}
+
+struct PushParserCheckContext
+{
+    nlTestSuite *mSuite;
+    const TLVIndex *mIndex;
+    const uint8_t *mEncoding;
+    uint16_t mNext;
+    uint16_t mContainerEnds;
+    uint32_t mStringLen;
+    uint8_t mString[1024];
+};
+
+static WEAVE_ERROR PushParserCheckHandler(TLVPushParser &aParser, const TLVPushParser::Event &aEvent)
+{
+    PushParserCheckContext *context = static_cast<PushParserCheckContext *>(aParser.AppData);
+    nlTestSuite *inSuite = context->mSuite;
+    TLVReader indexReader;
+    WEAVE_ERROR err;
+
+    switch (aEvent.Type)
+    {
+    case TLVPushParser::kEvent_Element:
+    case TLVPushParser::kEvent_ContainerStart:
+    case TLVPushParser::kEvent_StringStart:
+    {
+        NL_TEST_ASSERT(inSuite, aEvent.Element != NULL);
+        NL_TEST_ASSERT(inSuite, context->mNext < context->mIndex->GetCount());
+
+        const TLVIndex::Entry & entry = context->mIndex->GetEntry(context->mNext);
+
+        NL_TEST_ASSERT(inSuite, entry.Tag == aEvent.Element->GetTag());
+        NL_TEST_ASSERT(inSuite, entry.Type == aEvent.Element->GetType());
+        NL_TEST_ASSERT(inSuite, entry.Depth == aEvent.Depth);
+        NL_TEST_ASSERT(inSuite, aParser.GetDepth() == aEvent.Depth);
+
+        err = context->mIndex->GetReader(context->mNext, indexReader);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, indexReader.GetLength() == aEvent.Element->GetLength());
+
+        if (aEvent.Type == TLVPushParser::kEvent_Element)
+        {
+            uint64_t val, expectedVal;
+
+            NL_TEST_ASSERT(inSuite, !TLVTypeIsContainer(entry.Type));
+            if (entry.Type == kTLVType_UnsignedInteger || entry.Type == kTLVType_SignedInteger)
+            {
+                NL_TEST_ASSERT(inSuite, aEvent.Element->Get(val) == WEAVE_NO_ERROR);
+                NL_TEST_ASSERT(inSuite, indexReader.Get(expectedVal) == WEAVE_NO_ERROR);
+                NL_TEST_ASSERT(inSuite, val == expectedVal);
+            }
+        }
+        else if (aEvent.Type == TLVPushParser::kEvent_StringStart)
+        {
+            context->mStringLen = 0;
+        }
+
+        context->mNext++;
+        break;
+    }
+
+    case TLVPushParser::kEvent_StringData:
+        NL_TEST_ASSERT(inSuite, aEvent.Element == NULL);
+        NL_TEST_ASSERT(inSuite, aEvent.DataLen > 0);
+        NL_TEST_ASSERT(inSuite, context->mStringLen + aEvent.DataLen <= sizeof(context->mString));
+
+        // String data is delivered in place
+        NL_TEST_ASSERT(inSuite, aEvent.Data >= context->mEncoding);
+
+        memcpy(context->mString + context->mStringLen, aEvent.Data, aEvent.DataLen);
+        context->mStringLen += aEvent.DataLen;
+        break;
+
+    case TLVPushParser::kEvent_StringEnd:
+    {
+        const uint8_t *expectedData;
+
+        err = context->mIndex->GetReader(context->mNext - 1, indexReader);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, indexReader.GetLength() == context->mStringLen);
+
+        err = indexReader.GetDataPtr(expectedData);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, memcmp(expectedData, context->mString, context->mStringLen) == 0);
+        break;
+    }
+
+    case TLVPushParser::kEvent_ContainerEnd:
+        NL_TEST_ASSERT(inSuite, aEvent.Element == NULL);
+        context->mContainerEnds++;
+        break;
+    }
+
+    return WEAVE_NO_ERROR;
+}
+
+static WEAVE_ERROR PushParserStopHandler(TLVPushParser &aParser, const TLVPushParser::Event &aEvent)
+{
+    return (aEvent.Type == TLVPushParser::kEvent_StringData) ? WEAVE_ERROR_NO_MEMORY : WEAVE_NO_ERROR;
+}
+
+/**
+ *  Test Weave TLV Push Parser
+ */
+void CheckWeaveTLVPushParser(nlTestSuite *inSuite, void *inContext)
+{
+    uint8_t buf[2048];
+    TLVWriter writer;
+    TLVIndex index;
+    TLVIndex::Entry entries[18];
+    TLVPushParser parser;
+    PushParserCheckContext context;
+    const uint32_t chunkSizes[] = { 1, 2, 3, 7, 16, 17, 64, 2048 };
+    WEAVE_ERROR err;
+
+    writer.Init(buf, sizeof(buf));
+    writer.ImplicitProfileId = TestProfile_2;
+
+    WriteEncoding1(inSuite, writer);
+
+    uint32_t encodedLen = writer.GetLengthWritten();
+
+    index.Init(entries, NULL, 18);
+    index.ImplicitProfileId = TestProfile_2;
+    err = index.Build(buf, encodedLen);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    // Feed the encoding in chunks of various sizes; the events must match the encoding regardless of
+    // where the chunk boundaries fall.
+    for (size_t i = 0; i < sizeof(chunkSizes) / sizeof(chunkSizes[0]); i++)
+    {
+        context.mSuite = inSuite;
+        context.mIndex = &index;
+        context.mEncoding = buf;
+        context.mNext = 0;
+        context.mContainerEnds = 0;
+        context.mStringLen = 0;
+
+        parser.Init(PushParserCheckHandler);
+        parser.ImplicitProfileId = TestProfile_2;
+        parser.AppData = &context;
+
+        for (uint32_t offset = 0; offset < encodedLen; offset += chunkSizes[i])
+        {
+            uint32_t len = (encodedLen - offset < chunkSizes[i]) ? encodedLen - offset : chunkSizes[i];
+
+            err = parser.Feed(buf + offset, len);
+            NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        }
+
+        err = parser.Finish();
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, parser.GetLengthParsed() == encodedLen);
+        NL_TEST_ASSERT(inSuite, context.mNext == index.GetCount());
+        NL_TEST_ASSERT(inSuite, context.mContainerEnds == 5);
+    }
+
+    // Incomplete encoding
+    parser.Init(PushParserCheckHandler);
+    parser.ImplicitProfileId = TestProfile_2;
+    context.mNext = 0;
+    parser.AppData = &context;
+    err = parser.Feed(buf, encodedLen - 1);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = parser.Finish();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_TLV_UNDERRUN);
+
+    // Implicit tags without an implicit profile id
+    parser.Init(PushParserCheckHandler);
+    context.mNext = 0;
+    parser.AppData = &context;
+    err = parser.Feed(buf, encodedLen);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_UNKNOWN_IMPLICIT_TLV_TAG);
+
+    // An error from the handler stops the parser
+    parser.Init(PushParserStopHandler);
+    parser.ImplicitProfileId = TestProfile_2;
+    err = parser.Feed(buf, encodedLen);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_NO_MEMORY);
+    err = parser.Feed(buf, encodedLen);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INCORRECT_STATE);
+    err = parser.Finish();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INCORRECT_STATE);
+
+    // End of container outside of any container
+    {
+        const uint8_t endOfContainer[] = { 0x18 };
+
+        parser.Init(PushParserStopHandler);
+        err = parser.Feed(endOfContainer, sizeof(endOfContainer));
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_TLV_ELEMENT);
+    }
+
+    // Containers nested too deeply
+    {
+        uint8_t arrays[WEAVE_CONFIG_TLV_PUSH_PARSER_MAX_DEPTH + 1];
+
+        memset(arrays, 0x16, sizeof(arrays));
+
+        parser.Init(PushParserStopHandler);
+        err = parser.Feed(arrays, sizeof(arrays) - 1);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, parser.GetDepth() == WEAVE_CONFIG_TLV_PUSH_PARSER_MAX_DEPTH);
+        err = parser.Feed(arrays, 1);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_BUFFER_TOO_SMALL);
+    }
+}
+
+struct JsonFlushContext
+{
+    char mOutput[2048];
+    uint32_t mOutputLen;
+};
+
+static WEAVE_ERROR JsonFlushHandler(TLVJsonEncoder &aEncoder, const char *aData, uint32_t aDataLen)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    JsonFlushContext *context = static_cast<JsonFlushContext *>(aEncoder.AppData);
+
+    VerifyOrExit(context->mOutputLen + aDataLen <= sizeof(context->mOutput), err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+    memcpy(context->mOutput + context->mOutputLen, aData, aDataLen);
+    context->mOutputLen += aDataLen;
+
+exit:
+    return err;
+}
+
+static bool JsonProfileIdHandler(const char *aName, uint32_t aNameLen, uint32_t &aProfileId)
+{
+    if (aNameLen != 5 || memcmp(aName, "Test1", 5) != 0)
+        return false;
+
+    aProfileId = TestProfile_1;
+    return true;
+}
+
+static const char *JsonProfileNameHandler(uint32_t aProfileId)
+{
+    return (aProfileId == TestProfile_1) ? "Test1" : NULL;
+}
+
+/**
+ *  Convert a TLV encoding to JSON and back, checking that the result matches the original.
+ */
+static void TestWeaveTLVJsonRoundTrip(nlTestSuite *inSuite, const uint8_t *aEncoding, uint32_t aEncodingLen, const char *aExpectedJson)
+{
+    char json[2048];
+    uint8_t buf[2048];
+    TLVReader reader;
+    TLVWriter writer;
+    TLVJsonEncoder encoder;
+    TLVJsonDecoder decoder;
+    JsonFlushContext context;
+    uint32_t jsonLen;
+    WEAVE_ERROR err;
+
+    // TLV to JSON, in memory
+    encoder.Init(json, sizeof(json), NULL);
+
+    reader.Init(aEncoding, aEncodingLen);
+    reader.ImplicitProfileId = TestProfile_2;
+
+    while ((err = reader.Next()) == WEAVE_NO_ERROR)
+    {
+        err = encoder.Encode(reader);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    }
+    NL_TEST_ASSERT(inSuite, err == WEAVE_END_OF_TLV);
+
+    jsonLen = encoder.GetBufferedLength();
+
+    if (aExpectedJson != NULL)
+    {
+        NL_TEST_ASSERT(inSuite, jsonLen == strlen(aExpectedJson));
+        NL_TEST_ASSERT(inSuite, memcmp(json, aExpectedJson, jsonLen) == 0);
+    }
+
+    // TLV to JSON, flushed through a small buffer
+    {
+        char smallBuf[7];
+
+        context.mOutputLen = 0;
+
+        encoder.Init(smallBuf, sizeof(smallBuf), JsonFlushHandler);
+        encoder.AppData = &context;
+
+        reader.Init(aEncoding, aEncodingLen);
+        reader.ImplicitProfileId = TestProfile_2;
+
+        while ((err = reader.Next()) == WEAVE_NO_ERROR)
+        {
+            err = encoder.Encode(reader);
+            NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        }
+        NL_TEST_ASSERT(inSuite, err == WEAVE_END_OF_TLV);
+
+        err = encoder.Flush();
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        NL_TEST_ASSERT(inSuite, context.mOutputLen == jsonLen);
+        NL_TEST_ASSERT(inSuite, memcmp(context.mOutput, json, jsonLen) == 0);
+    }
+
+    // JSON back to TLV
+    decoder.Init(json, jsonLen);
+
+    writer.Init(buf, sizeof(buf));
+    writer.ImplicitProfileId = TestProfile_2;
+
+    while ((err = decoder.Decode(writer)) == WEAVE_NO_ERROR)
+        ;
+    NL_TEST_ASSERT(inSuite, err == WEAVE_END_OF_TLV);
+    NL_TEST_ASSERT(inSuite, decoder.GetLengthRead() == jsonLen);
+
+    err = writer.Finalize();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    NL_TEST_ASSERT(inSuite, writer.GetLengthWritten() == aEncodingLen);
+    NL_TEST_ASSERT(inSuite, memcmp(buf, aEncoding, aEncodingLen) == 0);
+}
+
+/**
+ *  Test Weave TLV JSON Conversion
+ */
+void CheckWeaveTLVJson(nlTestSuite *inSuite, void *inContext)
+{
+    uint8_t buf[256];
+    char json[256];
+    TLVWriter writer;
+    TLVType outerContainerType;
+    TLVJsonEncoder encoder;
+    TLVJsonDecoder decoder;
+    WEAVE_ERROR err;
+
+    static const uint8_t bytes[] = { 0x00, 0x01, 0xFE, 0xFF };
+    static const char expectedJson[] =
+        "{\"0xAABBCCDD.1:STRUCT\":{\"1:INT\":-9223372036854775808,\"2:STRING\":\"a\\\"b\\\\c\\n\\u0001\","
+        "\"3:BYTES\":\"AAH+/w==\",\"4:DOUBLE\":\"NaN\",\"5:FLOAT\":-1.5,\"0x11223344.6:PATH\":[]}}\n"
+        "{\"ARRAY\":[{\"UINT\":18446744073709551615},{\"BOOL\":true},{\"NULL\":null}]}\n";
+
+    // A complete encoding
+    TestWeaveTLVJsonRoundTrip(inSuite, Encoding1, sizeof(Encoding1), NULL);
+
+    // Values that need special handling in JSON
+    writer.Init(buf, sizeof(buf));
+    writer.ImplicitProfileId = TestProfile_2;
+
+    err = writer.StartContainer(ProfileTag(TestProfile_1, 1), kTLVType_Structure, outerContainerType);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = writer.Put(ContextTag(1), static_cast<int64_t>(INT64_MIN));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = writer.PutString(ContextTag(2), "a\"b\\c\n\x01");
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = writer.PutBytes(ContextTag(3), bytes, sizeof(bytes));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = writer.Put(ContextTag(4), static_cast<double>(NAN));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = writer.Put(ContextTag(5), -1.5f);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    {
+        TLVType pathContainerType;
+
+        err = writer.StartContainer(ProfileTag(TestProfile_2, 6), kTLVType_Path, pathContainerType);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        err = writer.EndContainer(pathContainerType);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    }
+    err = writer.EndContainer(outerContainerType);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = writer.StartContainer(AnonymousTag, kTLVType_Array, outerContainerType);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = writer.Put(AnonymousTag, static_cast<uint64_t>(UINT64_MAX));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = writer.PutBoolean(AnonymousTag, true);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = writer.PutNull(AnonymousTag);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = writer.EndContainer(outerContainerType);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = writer.Finalize();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    TestWeaveTLVJsonRoundTrip(inSuite, buf, writer.GetLengthWritten(), expectedJson);
+
+    // Profile names
+    {
+        static const char expectedNamedJson[] = "{\"Test1.1:UINT\":7}\n";
+        TLVReader reader;
+
+        writer.Init(buf, sizeof(buf));
+        err = writer.Put(ProfileTag(TestProfile_1, 1), static_cast<uint8_t>(7));
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        reader.Init(buf, writer.GetLengthWritten());
+        err = reader.Next();
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        encoder.Init(json, sizeof(json), NULL);
+        encoder.GetProfileName = JsonProfileNameHandler;
+
+        err = encoder.Encode(reader);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, encoder.GetBufferedLength() == strlen(expectedNamedJson));
+        NL_TEST_ASSERT(inSuite, memcmp(json, expectedNamedJson, strlen(expectedNamedJson)) == 0);
+
+        // Names can't be resolved without a lookup function
+        decoder.Init(json, encoder.GetBufferedLength());
+        writer.Init(buf, sizeof(buf));
+        err = decoder.Decode(writer);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_TLV_TAG);
+
+        decoder.Init(json, encoder.GetBufferedLength());
+        decoder.GetProfileId = JsonProfileIdHandler;
+        writer.Init(buf, sizeof(buf));
+        err = decoder.Decode(writer);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        reader.Init(buf, writer.GetLengthWritten());
+        err = reader.Next();
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, reader.GetTag() == ProfileTag(TestProfile_1, 1));
+    }
+
+    // Unicode escapes, including a surrogate pair
+    {
+        char unicodeJson[] = "{ \"STRING\" : \"\\u00e9\\u20AC\\ud83d\\ude00\" }";
+        TLVReader reader;
+        char str[16];
+
+        decoder.Init(unicodeJson, strlen(unicodeJson));
+        writer.Init(buf, sizeof(buf));
+
+        err = decoder.Decode(writer);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        reader.Init(buf, writer.GetLengthWritten());
+        err = reader.Next();
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        err = reader.GetString(str, sizeof(str));
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, strcmp(str, "\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80") == 0);
+    }
+
+    // Malformed input
+    {
+        char truncatedJson[] = "{\"STRUCT\":{\"2:UINT\":1";
+        char unknownTypeJson[] = "{\"WORD\":1}";
+        char rangeJson[] = "{\"INT\":9223372036854775808}";
+        char tagJson[] = "{\"256:NULL\":null}";
+
+        decoder.Init(truncatedJson, strlen(truncatedJson));
+        writer.Init(buf, sizeof(buf));
+        err = decoder.Decode(writer);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_ARGUMENT);
+
+        decoder.Init(unknownTypeJson, strlen(unknownTypeJson));
+        writer.Init(buf, sizeof(buf));
+        err = decoder.Decode(writer);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_TLV_ELEMENT);
+
+        decoder.Init(rangeJson, strlen(rangeJson));
+        writer.Init(buf, sizeof(buf));
+        err = decoder.Decode(writer);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_INTEGER_VALUE);
+
+        decoder.Init(tagJson, strlen(tagJson));
+        writer.Init(buf, sizeof(buf));
+        err = decoder.Decode(writer);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_INVALID_TLV_TAG);
+    }
+
+    // Containers nested too deeply
+    {
+        uint8_t arrays[2 * (TLVJsonEncoder::kMaxDepth + 1)];
+        char deepJson[1024];
+        TLVReader reader;
+
+        memset(arrays, 0x16, TLVJsonEncoder::kMaxDepth + 1);
+        memset(arrays + TLVJsonEncoder::kMaxDepth + 1, 0x18, TLVJsonEncoder::kMaxDepth + 1);
+
+        reader.Init(arrays + 1, sizeof(arrays) - 2);
+        err = reader.Next();
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        encoder.Init(deepJson, sizeof(deepJson), NULL);
+        err = encoder.Encode(reader);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        decoder.Init(deepJson, encoder.GetBufferedLength());
+        writer.Init(buf, sizeof(buf));
+        err = decoder.Decode(writer);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+        reader.Init(arrays, sizeof(arrays));
+        err = reader.Next();
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        encoder.Init(deepJson, sizeof(deepJson), NULL);
+        err = encoder.Encode(reader);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_BUFFER_TOO_SMALL);
+    }
+
+    // Strings that span any number of input buffers convert as contiguous ones do
+    {
+        static const char testString[] = "!123456789ABCDEF@123456789ABCDEF#123456789ABCDEF$123456789ABCDEF";
+        char contiguousJson[256];
+        uint32_t contiguousJsonLen;
+        const uint32_t headLen = 2;
+
+        for (int i = 0; i < 2; i++)
+        {
+            PacketBuffer *pktBuf = PacketBuffer::New(0);
+            SmallBufferContext context;
+            TLVReader reader;
+
+            writer.Init(buf, sizeof(buf));
+            if (i == 0)
+                err = writer.PutString(AnonymousTag, testString);
+            else
+                err = writer.PutBytes(AnonymousTag, reinterpret_cast<const uint8_t *>(testString), strlen(testString));
+            NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+            reader.Init(buf, writer.GetLengthWritten());
+            err = reader.Next();
+            NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+            encoder.Init(contiguousJson, sizeof(contiguousJson), NULL);
+            err = encoder.Encode(reader);
+            NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+            contiguousJsonLen = encoder.GetBufferedLength();
+
+            // Only the 2-byte element head is held in the first buffer; the value follows in 32 2-byte ones.
+            memcpy(pktBuf->Start(), buf, headLen);
+            pktBuf->SetDataLength(headLen);
+
+            context.mReadPoint = buf + headLen;
+            context.mEnd = buf + writer.GetLengthWritten();
+            context.mBufLen = 2;
+
+            reader.Init(pktBuf);
+            reader.GetNextBuffer = GetNextSmallBuffer;
+            reader.AppData = &context;
+
+            err = reader.Next();
+            NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+            encoder.Init(json, sizeof(json), NULL);
+            err = encoder.Encode(reader);
+            NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+            NL_TEST_ASSERT(inSuite, encoder.GetBufferedLength() == contiguousJsonLen);
+            NL_TEST_ASSERT(inSuite, memcmp(json, contiguousJson, contiguousJsonLen) == 0);
+
+            PacketBuffer::Free(pktBuf);
+        }
+    }
+}
+
+uint8_t Encoding2[] =
+{
+    // Container 1
+    0xD5, 0xBB, 0xAA, 0xDD, 0xCC, 0x01, 0x00,
+        0xC9, 0xBB, 0xAA, 0xDD, 0xCC, 0x02, 0x00,
+        0x88, 0x02, 0x00,
+    0x18,
+    // Container 2
+    0x95, 0x01, 0x00,
+        0x88, 0x02, 0x00,
+        0xC9, 0xBB, 0xAA, 0xDD, 0xCC, 0x02, 0x00,
+    0x18
+};
+
+uint8_t AppendedEncoding2[] =
+{
+    // Container 1
+    0xD5, 0xBB, 0xAA, 0xDD, 0xCC, 0x01, 0x00,
+        0xC9, 0xBB, 0xAA, 0xDD, 0xCC, 0x02, 0x00,
+        0x88, 0x02, 0x00,
+        0xC8, 0xBB, 0xAA, 0xDD, 0xCC, 0x02, 0x00,
+        0x89, 0x02, 0x00,
+        0xD5, 0xBB, 0xAA, 0xDD, 0xCC, 0x01, 0x00,
+            0xC9, 0xBB, 0xAA, 0xDD, 0xCC, 0x02, 0x00,
+            0x88, 0x02, 0x00,
+        0x18,
+        0x95, 0x01, 0x00,
+            0x88, 0x02, 0x00,
+            0xC9, 0xBB, 0xAA, 0xDD, 0xCC, 0x02, 0x00,
+        0x18,
+    0x18,
+    // Container 2
+    0x95, 0x01, 0x00,
+        0x88, 0x02, 0x00,
+        0xC9, 0xBB, 0xAA, 0xDD, 0xCC, 0x02, 0x00,
+    0x18
+};
+
+void WriteAppendReadTest0(nlTestSuite *inSuite)
+{
+    uint8_t buf[74];
+    uint32_t updatedLen;
+
+    TLVWriter writer;
+    TLVReader reader;
+
+    writer.Init(buf, sizeof(buf));
+    writer.ImplicitProfileId = TestProfile_2;
+
+    WriteEncoding2(inSuite, writer);
+
+    uint32_t encodedLen = writer.GetLengthWritten();
+
+#ifdef DUMP_ENCODING
+    printf("Initial encoding:\n");
+    for (uint32_t i = 0; i < encodedLen; i++)
+    {
+        if (i != 0 && i % 16 == 0)
+            printf("\n");
+        printf("0x%02X, ", buf[i]);
+    }
+    printf("\n");
+#endif
+
+    NL_TEST_ASSERT(inSuite, encodedLen == sizeof(Encoding2));
+    NL_TEST_ASSERT(inSuite, memcmp(buf, Encoding2, encodedLen) == 0);
+
+    // Append new data into encoding
+    AppendEncoding2(inSuite, buf, encodedLen, sizeof(buf), updatedLen);
+
+#ifdef DUMP_ENCODING
+    printf("Updated encoding:\n");
+    for (uint32_t i = 0; i < updatedLen; i++)
+    {
+        if (i != 0 && i % 16 == 0)
+            printf("\n");
+        printf("0x%02X, ", buf[i]);
+    }
+    printf("\n");
+#endif
+
+    NL_TEST_ASSERT(inSuite, updatedLen == sizeof(AppendedEncoding2));
+    NL_TEST_ASSERT(inSuite, memcmp(buf, AppendedEncoding2, updatedLen) == 0);
+
+    reader.Init(buf, updatedLen);
+    reader.ImplicitProfileId = TestProfile_2;
+
+    ReadAppendedEncoding2(inSuite, reader);
+}
+
+void WriteFindAppendReadTest(nlTestSuite *inSuite, bool findContainer)
+{
+    uint8_t buf[74];
+    uint32_t updatedLen;
+
+    TLVWriter writer;
+    TLVReader reader;
+
+    writer.Init(buf, sizeof(buf));
+    writer.ImplicitProfileId = TestProfile_2;
+
+    WriteEncoding2(inSuite, writer);
+
+    uint32_t encodedLen = writer.GetLengthWritten();
+
+#ifdef DUMP_ENCODING
+    printf("Initial encoding:\n");
+    for (uint32_t i = 0; i < encodedLen; i++)
+    {
+        if (i != 0 && i % 16 == 0)
+            printf("\n");
+        printf("0x%02X, ", buf[i]);
+    }
+    printf("\n");
+#endif
+
+    NL_TEST_ASSERT(inSuite, encodedLen == sizeof(Encoding2));
+    NL_TEST_ASSERT(inSuite, memcmp(buf, Encoding2, encodedLen) == 0);
+
+    // Append new data into encoding
+    FindAppendEncoding2(inSuite, buf, encodedLen, sizeof(buf), updatedLen, findContainer);
+
+#ifdef DUMP_ENCODING
+    printf("Updated encoding:\n");
+    for (uint32_t i = 0; i < updatedLen; i++)
+    {
+        if (i != 0 && i % 16 == 0)
+            printf("\n");
+        printf("0x%02X, ", buf[i]);
+    }
+    printf("\n");
+#endif
+
+    NL_TEST_ASSERT(inSuite, updatedLen == sizeof(AppendedEncoding2));
+    NL_TEST_ASSERT(inSuite, memcmp(buf, AppendedEncoding2, updatedLen) == 0);
+
+    reader.Init(buf, updatedLen);
+    reader.ImplicitProfileId = TestProfile_2;
+
+    ReadAppendedEncoding2(inSuite, reader);
+}
+
+uint8_t Encoding3[] =
+{
+    // Container 1
+    0xD5, 0xBB, 0xAA, 0xDD, 0xCC, 0x01, 0x00,
+        0x88, 0x02, 0x00,
+    0x18,
+};
+
+uint8_t AppendedEncoding3[] =
+{
+    // Container 1
+    0xD5, 0xBB, 0xAA, 0xDD, 0xCC, 0x01, 0x00,
+        0x88, 0x02, 0x00,
+        0x89, 0x02, 0x00,
+    0x18
+};
+
+void WriteAppendReadTest1(nlTestSuite *inSuite)
+{
+    uint8_t buf[14];
+    uint32_t updatedLen;
+
+    TLVWriter writer;
+    TLVReader reader;
+
+    writer.Init(buf, sizeof(buf));
+    writer.ImplicitProfileId = TestProfile_2;
+
+    WriteEncoding3(inSuite, writer);
+
+    uint32_t encodedLen = writer.GetLengthWritten();
+
+#ifdef DUMP_ENCODING
+    printf("Initial encoding:\n");
+    for (uint32_t i = 0; i < encodedLen; i++)
+    {
+        if (i != 0 && i % 16 == 0)
+            printf("\n");
+        printf("0x%02X, ", buf[i]);
+    }
+    printf("\n");
+#endif
+
+    NL_TEST_ASSERT(inSuite, encodedLen == sizeof(Encoding3));
+    NL_TEST_ASSERT(inSuite, memcmp(buf, Encoding3, encodedLen) == 0);
+
+    // Append new data into encoding
+    AppendEncoding3(inSuite, buf, encodedLen, sizeof(buf), updatedLen);
+
+#ifdef DUMP_ENCODING
+    printf("Updated encoding:\n");
+    for (uint32_t i = 0; i < updatedLen; i++)
+    {
+        if (i != 0 && i % 16 == 0)
+            printf("\n");
+        printf("0x%02X, ", buf[i]);
+    }
+    printf("\n");
+#endif
+
+    NL_TEST_ASSERT(inSuite, updatedLen == sizeof(AppendedEncoding3));
+    NL_TEST_ASSERT(inSuite, memcmp(buf, AppendedEncoding3, updatedLen) == 0);
+
+    reader.Init(buf, updatedLen);
+    reader.ImplicitProfileId = TestProfile_2;
+
+    ReadAppendedEncoding3(inSuite, reader);
+}
+
+uint8_t AppendedEncoding4[] =
+{
+    // Container 1
+    0xD5, 0xBB, 0xAA, 0xDD, 0xCC, 0x01, 0x00,
+        0x88, 0x02, 0x00,
+    0x18,
+};
+
+void AppendReadTest(nlTestSuite *inSuite)
+{
+    uint8_t buf[11];
+    uint32_t updatedLen;
+
+    memset(buf, 0, sizeof(buf));
+
+#ifdef DUMP_ENCODING
+    printf("Initial encoding:\n");
+    for (uint32_t i = 0; i < sizeof(buf); i++)
+    {
+        if (i != 0 && i % 16 == 0)
+            printf("\n");
+        printf("0x%02X, ", buf[i]);
+    }
+    printf("\n");
+#endif
+
+    // Append new data to encoding
+    AppendEncoding4(inSuite, buf, 0, sizeof(buf), updatedLen);
 
 #ifdef DUMP_ENCODING
     printf("Updated encoding:\n");
@@ -2429,6 +3799,97 @@ void CheckWeaveTLVSkipCircular(nlTestSuite *inSuite, void * inContext)
 
 }
 
+/**
+ *  Test reading and writing string values as segments of non-contiguous buffers
+ */
+void CheckWeaveTLVDataSegmentsCircular(nlTestSuite *inSuite, void * inContext)
+{
+    const size_t bufsize = 40; // large enough s.t. 2 elements fit, 3rd causes eviction
+    uint8_t backingStore[bufsize];
+    char testString[] = "Sample string";
+    CircularTLVWriter writer;
+    CircularTLVReader reader;
+    WeaveCircularTLVBuffer buffer(backingStore, bufsize);
+    TLVDataSegment segments[2];
+    uint32_t numSegments;
+    uint8_t outBuf[64];
+    char strBuf[sizeof(testString)];
+    TLVWriter outWriter;
+    TLVReader outReader;
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    writer.Init(&buffer);
+
+    for (int i = 0; i < 4; i++)
+    {
+        err = writer.PutString(AnonymousTag, testString); // The third element straddles the boundary
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    }
+
+    err = writer.Finalize();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    reader.Init(&buffer);
+
+    err = reader.Next(); // position the reader at the straddling element
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    // GetDataPtr() cannot return the value, and too few segments leave the reader untouched
+    {
+        const uint8_t *data;
+
+        err = reader.GetDataPtr(data);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_TLV_UNDERRUN);
+
+        err = reader.GetDataSegments(segments, 1, numSegments);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_BUFFER_TOO_SMALL);
+        NL_TEST_ASSERT(inSuite, numSegments == 0);
+        NL_TEST_ASSERT(inSuite, reader.GetLength() == strlen(testString));
+    }
+
+    err = reader.GetDataSegments(segments, 2, numSegments);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, numSegments == 2);
+    NL_TEST_ASSERT(inSuite, segments[0].Len + segments[1].Len == strlen(testString));
+    NL_TEST_ASSERT(inSuite, memcmp(segments[0].Data, testString, segments[0].Len) == 0);
+    NL_TEST_ASSERT(inSuite, memcmp(segments[1].Data, testString + segments[0].Len, segments[1].Len) == 0);
+
+    // Write the segments back out as a single string
+    outWriter.Init(outBuf, sizeof(outBuf));
+
+    err = outWriter.PutString(CommonTag(1), segments, numSegments);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = outWriter.PutBytes(CommonTag(2), segments, numSegments);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = outWriter.Finalize();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    outReader.Init(outBuf, outWriter.GetLengthWritten());
+
+    TestNext<TLVReader>(inSuite, outReader);
+    TestString(inSuite, outReader, CommonTag(1), testString);
+
+    TestNext<TLVReader>(inSuite, outReader);
+    NL_TEST_ASSERT(inSuite, outReader.GetType() == kTLVType_ByteString);
+    err = outReader.GetBytes((uint8_t *)strBuf, sizeof(strBuf));
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, memcmp(strBuf, testString, strlen(testString)) == 0);
+
+    // The consumed value is skipped, and the next element is read as usual
+    err = reader.Next();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    err = reader.GetDataSegments(segments, 2, numSegments);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, numSegments == 1);
+    NL_TEST_ASSERT(inSuite, segments[0].Len == strlen(testString));
+
+    err = reader.Next();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_END_OF_TLV);
+}
+
 /**
  *  Test Buffer Overflow
  */
@@ -3019,6 +4480,12 @@ void TestWeaveTLVReaderErrorHandling(nlTestSuite *inSuite)
     err = reader.GetDataPtr(data);
     NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_WRONG_TLV_TYPE);
     free((void *)data);
+
+    // GetDataSegments()
+    TLVDataSegment segments[2];
+    uint32_t numSegments;
+    err = reader.GetDataSegments(segments, 2, numSegments);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_WRONG_TLV_TYPE);
 }
 /**
  *  Test Weave TLV Reader in a use case
@@ -3774,8 +5241,16 @@ static const nlTest sTests[] = {
     NL_TEST_DEF("Weave TLV Writer",                    CheckWeaveTLVWriter),
     NL_TEST_DEF("Weave TLV Reader",                    CheckWeaveTLVReader),
     NL_TEST_DEF("Weave TLV Utilities",                 CheckWeaveTLVUtilities),
+    NL_TEST_DEF("Weave TLV Utilities Hash",            CheckWeaveTLVHash),
     NL_TEST_DEF("Weave TLV Updater",                   CheckWeaveUpdater),
+    NL_TEST_DEF("Weave TLV Updater Batch Edits",       CheckWeaveUpdaterApplyEdits),
+    NL_TEST_DEF("Weave TLV Sizer",                     CheckWeaveTLVSizer),
+    NL_TEST_DEF("Weave TLV Scratch Writer",            CheckWeaveTLVScratch),
+    NL_TEST_DEF("Weave TLV Profile Dictionary",        CheckWeaveTLVProfileDictionary),
     NL_TEST_DEF("Weave TLV Empty Find",                CheckWeaveTLVEmptyFind),
+    NL_TEST_DEF("Weave TLV Index",                     CheckWeaveTLVIndex),
+    NL_TEST_DEF("Weave TLV Push Parser",               CheckWeaveTLVPushParser),
+    NL_TEST_DEF("Weave TLV JSON Conversion",           CheckWeaveTLVJson),
     NL_TEST_DEF("Weave Circular TLV buffer, simple",   CheckCircularTLVBufferSimple),
     NL_TEST_DEF("Weave Circular TLV buffer, mid-buffer start", CheckCircularTLVBufferStartMidway),
     NL_TEST_DEF("Weave Circular TLV buffer, straddle", CheckCircularTLVBufferEvictStraddlingEvent),
@@ -3783,6 +5258,7 @@ static const nlTest sTests[] = {
     NL_TEST_DEF("Weave TLV Printf",                    CheckWeaveTLVPutStringF),
     NL_TEST_DEF("Weave TLV Printf, Circular TLV buf",  CheckWeaveTLVPutStringFCircular),
     NL_TEST_DEF("Weave TLV Skip non-contiguous",       CheckWeaveTLVSkipCircular),
+    NL_TEST_DEF("Weave TLV Data Segments, Circular TLV buf", CheckWeaveTLVDataSegmentsCircular),
     NL_TEST_DEF("Weave TLV Check reserve",             CheckCloseContainerReserve),
     NL_TEST_DEF("Weave TLV Reader Fuzz Test",          TLVReaderFuzzTest),
     NL_TEST_SENTINEL()
@@ -0,0 +1,514 @@
+/*
+ *
+ *    Copyright (c) 2019 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements microbenchmarks for the decode throughput of
+ *      the Weave TLV reader.
+ *
+ */
+
+#include "ToolCommon.h"
+
+#include <nlunit-test.h>
+
+#include <Weave/Core/WeaveCore.h>
+#include <Weave/Core/WeaveTLV.h>
+#include <Weave/Core/WeaveTLVJson.h>
+#include <SystemLayer/SystemClock.h>
+
+#if WEAVE_SYSTEM_CONFIG_USE_LWIP
+#include <lwip/init.h>
+#endif // WEAVE_SYSTEM_CONFIG_USE_LWIP
+
+using namespace nl;
+using namespace nl::Weave::TLV;
+
+#define TOOL_NAME "TestTLVPerf"
+
+static bool HandleOption(const char *progName, OptionSet *optSet, int id, const char *name, const char *arg);
+
+enum
+{
+    TestProfile_1               = 0xAABBCCDD,
+    TestProfile_2               = 0x11223344,
+
+    kEncodingBufSize            = 4096,
+    kRecordCount                = 48,
+    kChainedBufSize             = 128,
+    kJsonBufSize                = 32768
+};
+
+static uint32_t gIterations = 20000;
+
+struct TestTLVPerfContext
+{
+    uint8_t mEncoding[kEncodingBufSize];
+    uint32_t mEncodingLen;
+    uint32_t mElementCount;
+    char mJson[kJsonBufSize];
+    uint32_t mJsonLen;
+};
+
+/**
+ *  Encode a payload whose mix of tags, scalars, strings and nested containers resembles a
+ *  typical WDM notification.
+ */
+static WEAVE_ERROR EncodePayload(TestTLVPerfContext *context)
+{
+    WEAVE_ERROR err;
+    TLVWriter writer;
+    TLVType outerContainer, arrayContainer, recordContainer, listContainer;
+
+    writer.Init(context->mEncoding, sizeof(context->mEncoding));
+    writer.ImplicitProfileId = TestProfile_2;
+
+    err = writer.StartContainer(ProfileTag(TestProfile_1, 1), kTLVType_Structure, outerContainer);
+    SuccessOrExit(err);
+
+    err = writer.StartContainer(ContextTag(1), kTLVType_Array, arrayContainer);
+    SuccessOrExit(err);
+
+    context->mElementCount = 2;
+
+    for (uint32_t i = 0; i < kRecordCount; i++)
+    {
+        err = writer.StartContainer(AnonymousTag, kTLVType_Structure, recordContainer);
+        SuccessOrExit(err);
+
+        err = writer.Put(ContextTag(1), (uint8_t) i);
+        SuccessOrExit(err);
+        err = writer.Put(ContextTag(2), (int32_t) (i * -100003));
+        SuccessOrExit(err);
+        err = writer.Put(ContextTag(3), (uint64_t) 0x0123456789ABCDEFULL + i);
+        SuccessOrExit(err);
+        err = writer.PutBoolean(ContextTag(4), (i & 1) != 0);
+        SuccessOrExit(err);
+        err = writer.Put(ProfileTag(TestProfile_2, 5), 25.5f);
+        SuccessOrExit(err);
+        err = writer.Put(ProfileTag(TestProfile_1, 70000 + i), (int16_t) i);
+        SuccessOrExit(err);
+        err = writer.PutString(ContextTag(6), "weave-tlv-perf");
+        SuccessOrExit(err);
+
+        err = writer.StartContainer(ContextTag(7), kTLVType_Array, listContainer);
+        SuccessOrExit(err);
+        err = writer.Put(AnonymousTag, (uint32_t) i);
+        SuccessOrExit(err);
+        err = writer.PutNull(AnonymousTag);
+        SuccessOrExit(err);
+        err = writer.EndContainer(listContainer);
+        SuccessOrExit(err);
+
+        err = writer.EndContainer(recordContainer);
+        SuccessOrExit(err);
+
+        // 1 record + 7 members + 1 array + 2 array members
+        context->mElementCount += 11;
+    }
+
+    err = writer.EndContainer(arrayContainer);
+    SuccessOrExit(err);
+
+    err = writer.EndContainer(outerContainer);
+    SuccessOrExit(err);
+
+    err = writer.Finalize();
+    SuccessOrExit(err);
+
+    context->mEncodingLen = writer.GetLengthWritten();
+
+exit:
+    return err;
+}
+
+/**
+ *  Convert the encoded payload to JSON.
+ */
+static WEAVE_ERROR EncodePayloadJson(TestTLVPerfContext *context)
+{
+    WEAVE_ERROR err;
+    TLVReader reader;
+    TLVJsonEncoder encoder;
+
+    encoder.Init(context->mJson, sizeof(context->mJson), NULL);
+
+    reader.Init(context->mEncoding, context->mEncodingLen);
+    reader.ImplicitProfileId = TestProfile_2;
+
+    err = reader.Next();
+    SuccessOrExit(err);
+
+    err = encoder.Encode(reader);
+    SuccessOrExit(err);
+
+    context->mJsonLen = encoder.GetBufferedLength();
+
+exit:
+    return err;
+}
+
+/**
+ *  Visit every element of the encoding, descending into containers, and count the elements seen.
+ */
+static WEAVE_ERROR WalkElements(TLVReader& reader, uint32_t& count)
+{
+    WEAVE_ERROR err;
+
+    while ((err = reader.Next()) == WEAVE_NO_ERROR)
+    {
+        count++;
+
+        if (TLVTypeIsContainer(reader.GetType()))
+        {
+            TLVType outerContainer;
+
+            err = reader.EnterContainer(outerContainer);
+            SuccessOrExit(err);
+
+            err = WalkElements(reader, count);
+            SuccessOrExit(err);
+
+            err = reader.ExitContainer(outerContainer);
+            SuccessOrExit(err);
+        }
+    }
+
+    if (err == WEAVE_END_OF_TLV)
+        err = WEAVE_NO_ERROR;
+
+exit:
+    return err;
+}
+
+static void PrintThroughput(const char *name, uint64_t startTime, uint32_t bytesPerIteration)
+{
+    uint64_t elapsedUS = System::Platform::Layer::GetClock_Monotonic() - startTime;
+    uint64_t totalBytes = (uint64_t) bytesPerIteration * gIterations;
+
+    if (elapsedUS == 0)
+        elapsedUS = 1;
+
+    printf("%s: %" PRIu32 " iterations, %" PRIu64 " bytes in %" PRIu64 " us (%" PRIu64 " KB/s)\n",
+           name, gIterations, totalBytes, elapsedUS, (totalBytes * 1000000 / elapsedUS) / 1024);
+}
+
+/**
+ *  Benchmark decoding from a single contiguous buffer.
+ */
+static void CheckDecodeContiguous(nlTestSuite *inSuite, void *inContext)
+{
+    TestTLVPerfContext *context = static_cast<TestTLVPerfContext *>(inContext);
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    uint64_t startTime = System::Platform::Layer::GetClock_Monotonic();
+
+    for (uint32_t i = 0; i < gIterations && err == WEAVE_NO_ERROR; i++)
+    {
+        TLVReader reader;
+        uint32_t count = 0;
+
+        reader.Init(context->mEncoding, context->mEncodingLen);
+        reader.ImplicitProfileId = TestProfile_2;
+
+        err = WalkElements(reader, count);
+        NL_TEST_ASSERT(inSuite, count == context->mElementCount);
+    }
+
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    PrintThroughput("contiguous", startTime, context->mEncodingLen);
+}
+
+/**
+ *  Benchmark skipping over the top-level container without visiting its members.
+ */
+static void CheckSkipContiguous(nlTestSuite *inSuite, void *inContext)
+{
+    TestTLVPerfContext *context = static_cast<TestTLVPerfContext *>(inContext);
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    uint64_t startTime = System::Platform::Layer::GetClock_Monotonic();
+
+    for (uint32_t i = 0; i < gIterations && err == WEAVE_NO_ERROR; i++)
+    {
+        TLVReader reader;
+
+        reader.Init(context->mEncoding, context->mEncodingLen);
+        reader.ImplicitProfileId = TestProfile_2;
+
+        err = reader.Next();
+        SuccessOrExit(err);
+
+        err = reader.Next();
+        NL_TEST_ASSERT(inSuite, err == WEAVE_END_OF_TLV);
+        err = (err == WEAVE_END_OF_TLV) ? WEAVE_NO_ERROR : err;
+    }
+
+exit:
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    PrintThroughput("skip", startTime, context->mEncodingLen);
+}
+
+/**
+ *  Benchmark decoding from a chain of small PacketBuffers, which exercises the reader's handling of
+ *  element heads that straddle buffer boundaries.
+ */
+static void CheckDecodeChained(nlTestSuite *inSuite, void *inContext)
+{
+    TestTLVPerfContext *context = static_cast<TestTLVPerfContext *>(inContext);
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    PacketBuffer *chain = NULL;
+    uint64_t startTime;
+
+    for (uint32_t offset = 0; offset < context->mEncodingLen; offset += kChainedBufSize)
+    {
+        PacketBuffer *buf = PacketBuffer::New(0);
+        uint32_t len = context->mEncodingLen - offset;
+
+        VerifyOrExit(buf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+        if (len > kChainedBufSize)
+            len = kChainedBufSize;
+
+        memcpy(buf->Start(), context->mEncoding + offset, len);
+        buf->SetDataLength((uint16_t) len);
+
+        if (chain == NULL)
+            chain = buf;
+        else
+            chain->AddToEnd(buf);
+    }
+
+    startTime = System::Platform::Layer::GetClock_Monotonic();
+
+    for (uint32_t i = 0; i < gIterations && err == WEAVE_NO_ERROR; i++)
+    {
+        TLVReader reader;
+        uint32_t count = 0;
+
+        reader.Init(chain, 0xFFFFFFFFUL, true);
+        reader.ImplicitProfileId = TestProfile_2;
+
+        err = WalkElements(reader, count);
+        NL_TEST_ASSERT(inSuite, count == context->mElementCount);
+    }
+
+    PrintThroughput("chained", startTime, context->mEncodingLen);
+
+exit:
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    if (chain != NULL)
+        PacketBuffer::Free(chain);
+}
+
+/**
+ *  Benchmark converting the payload to JSON, measured in bytes of TLV consumed.
+ */
+static void CheckEncodeJson(nlTestSuite *inSuite, void *inContext)
+{
+    TestTLVPerfContext *context = static_cast<TestTLVPerfContext *>(inContext);
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    static char json[kJsonBufSize];
+    uint64_t startTime = System::Platform::Layer::GetClock_Monotonic();
+
+    for (uint32_t i = 0; i < gIterations && err == WEAVE_NO_ERROR; i++)
+    {
+        TLVReader reader;
+        TLVJsonEncoder encoder;
+
+        encoder.Init(json, sizeof(json), NULL);
+
+        reader.Init(context->mEncoding, context->mEncodingLen);
+        reader.ImplicitProfileId = TestProfile_2;
+
+        err = reader.Next();
+        SuccessOrExit(err);
+
+        err = encoder.Encode(reader);
+        SuccessOrExit(err);
+
+        NL_TEST_ASSERT(inSuite, encoder.GetBufferedLength() == context->mJsonLen);
+    }
+
+exit:
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    PrintThroughput("json encode", startTime, context->mEncodingLen);
+}
+
+/**
+ *  Benchmark converting the JSON form of the payload back to TLV, measured in bytes of JSON
+ *  consumed.  Since the decoder works in place, each iteration first restores the JSON text, and
+ *  the cost of that copy is included.
+ */
+static void CheckDecodeJson(nlTestSuite *inSuite, void *inContext)
+{
+    TestTLVPerfContext *context = static_cast<TestTLVPerfContext *>(inContext);
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    static char json[kJsonBufSize];
+    static uint8_t encoding[kEncodingBufSize];
+    uint64_t startTime = System::Platform::Layer::GetClock_Monotonic();
+
+    for (uint32_t i = 0; i < gIterations && err == WEAVE_NO_ERROR; i++)
+    {
+        TLVWriter writer;
+        TLVJsonDecoder decoder;
+
+        memcpy(json, context->mJson, context->mJsonLen);
+        decoder.Init(json, context->mJsonLen);
+
+        writer.Init(encoding, sizeof(encoding));
+        writer.ImplicitProfileId = TestProfile_2;
+
+        err = decoder.Decode(writer);
+        SuccessOrExit(err);
+
+        err = writer.Finalize();
+        SuccessOrExit(err);
+
+        NL_TEST_ASSERT(inSuite, writer.GetLengthWritten() == context->mEncodingLen);
+    }
+
+exit:
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, memcmp(encoding, context->mEncoding, context->mEncodingLen) == 0);
+
+    PrintThroughput("json decode", startTime, context->mJsonLen);
+}
+
+// Test Suite
+
+/**
+ *  Test Suite that lists all the test functions.
+ */
+static const nlTest sTests[] = {
+    NL_TEST_DEF("Weave TLV Decode, contiguous",        CheckDecodeContiguous),
+    NL_TEST_DEF("Weave TLV Skip, contiguous",          CheckSkipContiguous),
+    NL_TEST_DEF("Weave TLV Decode, PacketBuffer chain", CheckDecodeChained),
+    NL_TEST_DEF("Weave TLV to JSON",                   CheckEncodeJson),
+    NL_TEST_DEF("Weave TLV from JSON",                 CheckDecodeJson),
+    NL_TEST_SENTINEL()
+};
+
+/**
+ *  Set up the test suite.
+ */
+static int TestSetup(void *inContext)
+{
+    TestTLVPerfContext *context = static_cast<TestTLVPerfContext *>(inContext);
+
+    if (EncodePayload(context) != WEAVE_NO_ERROR)
+        return FAILURE;
+
+    if (EncodePayloadJson(context) != WEAVE_NO_ERROR)
+        return FAILURE;
+
+    return (SUCCESS);
+}
+
+/**
+ *  Tear down the test suite.
+ */
+static int TestTeardown(void *inContext)
+{
+    return (SUCCESS);
+}
+
+static OptionDef gToolOptionDefs[] =
+{
+    { "iterations", kArgumentRequired, 'i' },
+    { }
+};
+
+static const char *const gToolOptionHelp =
+    "  -i, --iterations <count>\n"
+    "       Number of times each benchmark decodes the test payload. Defaults to 20000.\n"
+    "\n"
+    ;
+
+static OptionSet gToolOptions =
+{
+    HandleOption,
+    gToolOptionDefs,
+    "GENERAL OPTIONS",
+    gToolOptionHelp
+};
+
+static HelpOptions gHelpOptions(
+    TOOL_NAME,
+    "Usage: " TOOL_NAME " [<options...>]\n",
+    WEAVE_VERSION_STRING "\n" WEAVE_TOOL_COPYRIGHT,
+    "Decode throughput microbenchmarks for the Weave TLV reader.\n"
+);
+
+static OptionSet *gToolOptionSets[] =
+{
+    &gToolOptions,
+    &gHelpOptions,
+    NULL
+};
+
+static bool HandleOption(const char *progName, OptionSet *optSet, int id, const char *name, const char *arg)
+{
+    switch (id)
+    {
+    case 'i':
+        if (!ParseInt(arg, gIterations) || gIterations == 0)
+        {
+            PrintArgError("%s: Invalid value specified for iteration count: %s\n", progName, arg);
+            return false;
+        }
+        break;
+    default:
+        PrintArgError("%s: INTERNAL ERROR: Unhandled option: %s\n", progName, name);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ *  Main
+ */
+int main(int argc, char *argv[])
+{
+#if WEAVE_SYSTEM_CONFIG_USE_LWIP
+    tcpip_init(NULL, NULL);
+#endif // WEAVE_SYSTEM_CONFIG_USE_LWIP
+
+    nlTestSuite theSuite = {
+        "weave-tlv-perf",
+        &sTests[0],
+        TestSetup,
+        TestTeardown
+    };
+    TestTLVPerfContext context;
+
+    if (!ParseArgs(TOOL_NAME, argc, argv, gToolOptionSets))
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    // Generate machine-readable, comma-separated value (CSV) output.
+    nl_test_set_output_style(OUTPUT_CSV);
+
+    nlTestRunner(&theSuite, &context);
+
+    return nlTestRunnerStats(&theSuite);
+}
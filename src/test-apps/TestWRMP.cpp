@@ -182,6 +182,19 @@ static const char *gToolOptionHelp =
     "       TestWRMPDuplicateMsgAckOnClosedExResponder------------[14]\n"
     "       TestWRMPDuplicateMsgAckOnClosedExInitiator------------[15]\n"
     "       TestWRMPDuplicateMsgDetection-------------------------[16]\n"
+    "       TestWRMPRetransWheelExpiryOrder-----------------------[17]\n"
+    "       TestWRMPSequencedDeliveryOrder------------------------[18]\n"
+    "       TestWRMPSequencedReorderPoolFull----------------------[19]\n"
+    "       TestWRMPSequencedOutOfWindowRetransmit----------------[20]\n"
+    "       TestWRMPSequencedBehindWindow-------------------------[21]\n"
+    "       TestWRMPAckListApply----------------------------------[22]\n"
+    "       TestWRMPUnsolicitedHandlerDispatch--------------------[23]\n"
+#if WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE > 0
+    "       TestWRMPAdaptiveRetransTimeout------------------------[24]\n"
+#endif
+#if WEAVE_CONFIG_WRMP_MAX_ACK_LIST_ENTRIES > 0
+    "       TestWRMPAckListCoalescing-----------------------------[25]\n"
+#endif
     "\n"
     "  -W, --wait <TestWaitTime>\n"
     "\n"
@@ -1423,6 +1436,968 @@ testStatus_t TestWRMPDuplicateMsgDetection(void)
     return TEST_FAIL;
 }
 
+// Retransmit timeouts used by TestWRMPRetransWheelExpiryOrder; the first one spans more
+// than a full turn of the retransmission timer wheel.
+static const uint32_t WheelTestRetransTimeouts[] = { 13000, 1000, 5000 };
+static const size_t WheelTestNumExchanges = sizeof(WheelTestRetransTimeouts) / sizeof(WheelTestRetransTimeouts[0]);
+static uint64_t WheelTestAckTimes[WheelTestNumExchanges];
+static size_t WheelTestAckOrder[WheelTestNumExchanges];
+static size_t WheelTestAckCount = 0;
+
+static void HandleWheelTestAckRcvd(ExchangeContext *ec, void *msgCtxt)
+{
+    size_t index = static_cast<const uint32_t *>(msgCtxt) - WheelTestRetransTimeouts;
+
+    printf("Received Ack for message with retransmit timeout %" PRIu32 " ms\n", WheelTestRetransTimeouts[index]);
+
+    WheelTestAckTimes[index] = Now();
+    if (WheelTestAckCount < WheelTestNumExchanges)
+    {
+        WheelTestAckOrder[WheelTestAckCount++] = index;
+    }
+}
+
+static void HandleWheelTestMessage(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo,
+                                   uint32_t profileId, uint8_t msgType, PacketBuffer *payload)
+{
+    PacketBuffer::Free(payload);
+}
+
+//Drop the first transmission of messages sent on several exchanges with different
+//retransmit timeouts, and verify that the retransmissions, and hence the acks, happen
+//in the order of the timeouts and at the expected times, including for a timeout that
+//wraps around the retransmission timer wheel.
+testStatus_t TestWRMPRetransWheelExpiryOrder(void)
+{
+    testStatus_t testStatus = TEST_FAIL;
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    ExchangeContext *ecs[WheelTestNumExchanges] = { NULL };
+    uint32_t maxRetransTimeout = 0;
+    uint64_t firstTransmitTime;
+    PacketBuffer *payloadBuf = NULL;
+
+    Done = false;
+    WheelTestAckCount = 0;
+
+    WRMPClient.ExchangeMgr->MessageLayer->mDropMessage = true;
+
+    firstTransmitTime = Now();
+
+    for (size_t i = 0; i < WheelTestNumExchanges; i++)
+    {
+        ecs[i] = WRMPClient.ExchangeMgr->NewContext(DestNodeId, DestIPAddr, WEAVE_PORT, DestIntf, NULL);
+        VerifyOrFail(ecs[i] != NULL, "NewContext failed\n");
+
+        ecs[i]->EncryptionType = EncryptionType;
+        ecs[i]->KeyId = KeyId;
+        ecs[i]->OnAckRcvd = HandleWheelTestAckRcvd;
+        ecs[i]->OnMessageReceived = HandleWheelTestMessage;
+        ecs[i]->mWRMPConfig.mInitialRetransTimeout = WheelTestRetransTimeouts[i];
+        ecs[i]->mWRMPConfig.mActiveRetransTimeout = WheelTestRetransTimeouts[i];
+
+        if (WheelTestRetransTimeouts[i] > maxRetransTimeout)
+            maxRetransTimeout = WheelTestRetransTimeouts[i];
+
+        PrepareNewBuf(&payloadBuf);
+        err = ecs[i]->SendMessage(kWeaveProfile_Test, kWeaveTestMessageType_Generate_Response, payloadBuf,
+                                  ExchangeContext::kSendFlag_RequestAck, const_cast<uint32_t *>(&WheelTestRetransTimeouts[i]));
+        SuccessOrFail(err, "SendMessage failed to send Generate_Response message\n");
+    }
+
+    WRMPClient.ExchangeMgr->MessageLayer->mDropMessage = false;
+
+    while (WheelTestAckCount < WheelTestNumExchanges &&
+           Now() < firstTransmitTime + (maxRetransTimeout + 2000) * System::kTimerFactor_micro_per_milli)
+    {
+        struct timeval sleepTime;
+        sleepTime.tv_sec = 0;
+        sleepTime.tv_usec = 100000;
+
+        ServiceNetwork(sleepTime);
+    }
+
+    if (WheelTestAckCount != WheelTestNumExchanges)
+    {
+        printf("Received %zu of %zu Acks\n", WheelTestAckCount, WheelTestNumExchanges);
+        goto exit;
+    }
+
+    for (size_t i = 0; i < WheelTestNumExchanges; i++)
+    {
+        size_t index = WheelTestAckOrder[i];
+
+        if (i > 0 && WheelTestRetransTimeouts[index] < WheelTestRetransTimeouts[WheelTestAckOrder[i - 1]])
+        {
+            printf("Ack for retransmit timeout %" PRIu32 " ms received out of order\n", WheelTestRetransTimeouts[index]);
+            goto exit;
+        }
+
+        // The ack is expected soon after the retransmission.
+        if (WheelTestAckTimes[index] < firstTransmitTime + (WheelTestRetransTimeouts[index] - 600) * System::kTimerFactor_micro_per_milli ||
+            WheelTestAckTimes[index] > firstTransmitTime + (WheelTestRetransTimeouts[index] + 600) * System::kTimerFactor_micro_per_milli)
+        {
+            printf("Ack for retransmit timeout %" PRIu32 " ms received after %" PRIu64 " ms\n", WheelTestRetransTimeouts[index],
+                   (WheelTestAckTimes[index] - firstTransmitTime) / System::kTimerFactor_micro_per_milli);
+            goto exit;
+        }
+    }
+
+    testStatus = TEST_PASS;
+
+exit:
+    for (size_t i = 0; i < WheelTestNumExchanges; i++)
+    {
+        if (ecs[i] != NULL)
+            ecs[i]->Close();
+    }
+    return testStatus;
+}
+
+#if WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE > 0
+static bool RTTTestAckRcvd = false;
+static uint64_t RTTTestAckTime = 0;
+
+static void HandleRTTTestAckRcvd(ExchangeContext *ec, void *msgCtxt)
+{
+    RTTTestAckRcvd = true;
+    RTTTestAckTime = Now();
+}
+
+// Send a message requesting an ack on the exchange and wait for the ack. If dropDuration
+// is non-zero, the message layer drops all outgoing messages for that many milliseconds
+// after the message is first sent. Returns the time from the send to the ack, in
+// microseconds, or 0 if no ack was received.
+static uint64_t SendAndWaitForAck(ExchangeContext *ec, uint32_t profileId, uint8_t msgType, uint32_t dropDuration)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    PacketBuffer *payloadBuf = NULL;
+    uint64_t sendTime;
+
+    RTTTestAckRcvd = false;
+
+    PrepareNewBuf(&payloadBuf);
+
+    WRMPClient.ExchangeMgr->MessageLayer->mDropMessage = (dropDuration != 0);
+    sendTime = Now();
+    err = ec->SendMessage(profileId, msgType, payloadBuf, ExchangeContext::kSendFlag_RequestAck, &appContext);
+    SuccessOrFail(err, "SendMessage failed\n");
+
+    while (!RTTTestAckRcvd && Now() < sendTime + MaxAckReceiptInterval + 10 * System::kTimerFactor_micro_per_unit)
+    {
+        struct timeval sleepTime;
+        sleepTime.tv_sec = 0;
+        sleepTime.tv_usec = 10000;
+
+        ServiceNetwork(sleepTime);
+
+        if (Now() >= sendTime + dropDuration * System::kTimerFactor_micro_per_milli)
+        {
+            WRMPClient.ExchangeMgr->MessageLayer->mDropMessage = false;
+        }
+    }
+
+    WRMPClient.ExchangeMgr->MessageLayer->mDropMessage = false;
+
+    return RTTTestAckRcvd ? RTTTestAckTime - sendTime : 0;
+}
+
+//Verify that the round-trip time to the peer is sampled from both standalone and
+//piggybacked acks of messages that were not retransmitted, that the derived retransmit
+//timeout is clamped, and that it is used, with exponential backoff, for the
+//retransmissions of an adaptive exchange.
+testStatus_t TestWRMPAdaptiveRetransTimeout(void)
+{
+    testStatus_t testStatus = TEST_FAIL;
+    ExchangeContext *ec = NULL;
+    WRMPPeerRTTStats stats;
+    uint64_t rtt = 0;
+    uint64_t maxRTT = 0;
+    uint32_t expectedTimeout;
+    const uint32_t kNumStandaloneAcks = 2;
+    const uint32_t kNumEchoRequests = 8;
+
+    ec = WRMPClient.ExchangeMgr->NewContext(DestNodeId, DestIPAddr, WEAVE_PORT, DestIntf, NULL);
+    VerifyOrFail(ec != NULL, "NewContext failed\n");
+
+    ec->EncryptionType = EncryptionType;
+    ec->KeyId = KeyId;
+    ec->OnAckRcvd = HandleRTTTestAckRcvd;
+    ec->OnMessageReceived = HandleWheelTestMessage;
+    ec->mWRMPConfig.mInitialRetransTimeout = TEST_INITIAL_RETRANS_TIMEOUT;
+    ec->mWRMPConfig.mActiveRetransTimeout = TEST_INITIAL_RETRANS_TIMEOUT;
+    ec->SetAdaptiveRetransEnabled(true);
+
+    // Generate_Response messages are acked by standalone acks, each of which yields a sample.
+    for (uint32_t i = 0; i < kNumStandaloneAcks; i++)
+    {
+        rtt = SendAndWaitForAck(ec, kWeaveProfile_Test, kWeaveTestMessageType_Generate_Response, 0);
+        VerifyOrFail(rtt != 0, "No ack received for Generate_Response message\n");
+        if (rtt > maxRTT)
+            maxRTT = rtt;
+    }
+    VerifyOrFail(WRMPClient.ExchangeMgr->GetPeerRTTStats(DestNodeId, stats), "Round-trip time not sampled from standalone acks\n");
+    if (stats.SampleCount != kNumStandaloneAcks)
+    {
+        printf("Expected %" PRIu32 " samples from standalone acks\n", kNumStandaloneAcks);
+        goto exit;
+    }
+
+    // Echo Requests are acked on the Echo Response.
+    for (uint32_t i = 0; i < kNumEchoRequests; i++)
+    {
+        rtt = SendAndWaitForAck(ec, kWeaveProfile_Echo, kEchoMessageType_EchoRequest, 0);
+        VerifyOrFail(rtt != 0, "No ack received for Echo Request\n");
+        if (rtt > maxRTT)
+            maxRTT = rtt;
+    }
+
+    VerifyOrFail(WRMPClient.ExchangeMgr->GetPeerRTTStats(DestNodeId, stats), "No round-trip time estimate for peer\n");
+    printf("SRTT %" PRIu32 " ms, RTTVAR %" PRIu32 " ms, RTO %" PRIu32 " ms after %" PRIu32 " samples (max RTT %" PRIu64 " us)\n",
+           stats.SmoothedRTT, stats.RTTVariation, stats.RetransTimeout, stats.SampleCount, maxRTT);
+
+    if (stats.SampleCount != kNumStandaloneAcks + kNumEchoRequests)
+    {
+        printf("Expected %" PRIu32 " samples\n", kNumStandaloneAcks + kNumEchoRequests);
+        goto exit;
+    }
+
+    // The smoothed estimate cannot exceed the largest sample.
+    if (stats.SmoothedRTT > maxRTT / System::kTimerFactor_micro_per_milli + 1)
+    {
+        printf("Smoothed round-trip time exceeds the largest sample\n");
+        goto exit;
+    }
+
+    // RTO = SRTT + max(G, 4 * RTTVAR), clamped; allow for the truncation of the reported values.
+    expectedTimeout = stats.SmoothedRTT + ((4 * stats.RTTVariation > WEAVE_CONFIG_WRMP_TIMER_DEFAULT_PERIOD) ?
+                                           4 * stats.RTTVariation : WEAVE_CONFIG_WRMP_TIMER_DEFAULT_PERIOD);
+    if (expectedTimeout + 4 < WEAVE_CONFIG_WRMP_MIN_RETRANS_TIMEOUT)
+    {
+        expectedTimeout = WEAVE_CONFIG_WRMP_MIN_RETRANS_TIMEOUT;
+    }
+    if (stats.RetransTimeout < WEAVE_CONFIG_WRMP_MIN_RETRANS_TIMEOUT || stats.RetransTimeout > WEAVE_CONFIG_WRMP_MAX_RETRANS_TIMEOUT ||
+        stats.RetransTimeout < expectedTimeout || stats.RetransTimeout > expectedTimeout + 4)
+    {
+        printf("Retransmit timeout %" PRIu32 " ms, expected %" PRIu32 " ms\n", stats.RetransTimeout, expectedTimeout);
+        goto exit;
+    }
+    if (ec->GetCurrentRetransmitTimeout() != stats.RetransTimeout)
+    {
+        printf("Adaptive exchange does not use the estimated retransmit timeout\n");
+        goto exit;
+    }
+
+    // Drop the first transmission and the first retransmission, which happens after one
+    // RTO; the second follows after a further two RTOs. The ack of a retransmitted message
+    // yields no sample.
+    expectedTimeout = 3 * stats.RetransTimeout;
+    rtt = SendAndWaitForAck(ec, kWeaveProfile_Echo, kEchoMessageType_EchoRequest, 2 * stats.RetransTimeout);
+    VerifyOrFail(rtt != 0, "No ack received for retransmitted Echo Request\n");
+    printf("Retransmitted Echo Request acked after %" PRIu64 " ms\n", rtt / System::kTimerFactor_micro_per_milli);
+
+    if (rtt < (expectedTimeout - 2 * WEAVE_CONFIG_WRMP_TIMER_DEFAULT_PERIOD) * System::kTimerFactor_micro_per_milli ||
+        rtt > (expectedTimeout + 2 * WEAVE_CONFIG_WRMP_TIMER_DEFAULT_PERIOD) * System::kTimerFactor_micro_per_milli)
+    {
+        printf("Expected ack after %" PRIu32 " ms\n", expectedTimeout);
+        goto exit;
+    }
+
+    VerifyOrFail(WRMPClient.ExchangeMgr->GetPeerRTTStats(DestNodeId, stats), "No round-trip time estimate for peer\n");
+    if (stats.SampleCount != kNumStandaloneAcks + kNumEchoRequests)
+    {
+        printf("Round-trip time sampled from the ack of a retransmitted message\n");
+        goto exit;
+    }
+
+    testStatus = TEST_PASS;
+
+exit:
+    ec->Close();
+    return testStatus;
+}
+#endif // WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE > 0
+
+// Echo Requests sent by the sequenced delivery tests carry a tag, which the peer echoes
+// back in its Echo Responses in the order it delivers the requests.
+static const size_t SeqTestMaxTags = 64;
+static uint16_t SeqTestRcvdTags[SeqTestMaxTags];
+static size_t SeqTestRcvdTagCount = 0;
+
+static void HandleSeqTestMessage(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo,
+                                 uint32_t profileId, uint8_t msgType, PacketBuffer *payload)
+{
+    if (profileId == kWeaveProfile_Echo && msgType == kEchoMessageType_EchoResponse && payload->DataLength() >= 2 &&
+        SeqTestRcvdTagCount < SeqTestMaxTags)
+    {
+        SeqTestRcvdTags[SeqTestRcvdTagCount++] = nl::Weave::Encoding::LittleEndian::Get16(payload->Start());
+    }
+    PacketBuffer::Free(payload);
+}
+
+static ExchangeContext *NewSeqTestContext(uint32_t retransTimeout)
+{
+    ExchangeContext *ec = WRMPClient.ExchangeMgr->NewContext(DestNodeId, DestIPAddr, WEAVE_PORT, DestIntf, NULL);
+
+    if (ec != NULL)
+    {
+        ec->EncryptionType = EncryptionType;
+        ec->KeyId = KeyId;
+        ec->OnMessageReceived = HandleSeqTestMessage;
+        ec->mWRMPConfig.mInitialRetransTimeout = retransTimeout;
+        ec->mWRMPConfig.mActiveRetransTimeout = retransTimeout;
+        ec->SetWRMPSendWindow(WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW);
+    }
+
+    return ec;
+}
+
+// Send a tagged Echo Request requesting an ack. If drop is true, the first transmission
+// is dropped by the message layer, so that the message only arrives when retransmitted.
+static WEAVE_ERROR SendSeqTestEcho(ExchangeContext *ec, uint16_t tag, bool drop)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    PacketBuffer *payloadBuf = PacketBuffer::New();
+
+    VerifyOrExit(payloadBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+    nl::Weave::Encoding::LittleEndian::Put16(payloadBuf->Start(), tag);
+    payloadBuf->SetDataLength(2);
+
+    WRMPClient.ExchangeMgr->MessageLayer->mDropMessage = drop;
+    err = ec->SendMessage(kWeaveProfile_Echo, kEchoMessageType_EchoRequest, payloadBuf, ExchangeContext::kSendFlag_RequestAck);
+    WRMPClient.ExchangeMgr->MessageLayer->mDropMessage = false;
+
+exit:
+    return err;
+}
+
+// Service the network until the given number of Echo Responses has been received, or
+// the timeout (in milliseconds) expires.
+static void WaitForSeqTestTags(size_t count, uint32_t timeout)
+{
+    uint64_t deadline = Now() + timeout * System::kTimerFactor_micro_per_milli;
+
+    while (SeqTestRcvdTagCount < count && Now() < deadline)
+    {
+        struct timeval sleepTime;
+        sleepTime.tv_sec = 0;
+        sleepTime.tv_usec = 10000;
+
+        ServiceNetwork(sleepTime);
+    }
+}
+
+// Check that the Echo Requests tagged firstTag to firstTag + numTags - 1 were each
+// delivered once, in order.
+static bool CheckSeqTestDelivery(uint16_t firstTag, uint16_t numTags)
+{
+    uint16_t nextTag = firstTag;
+
+    for (size_t i = 0; i < SeqTestRcvdTagCount; i++)
+    {
+        uint16_t tag = SeqTestRcvdTags[i];
+
+        if (tag < firstTag || tag >= firstTag + numTags)
+            continue;
+
+        if (tag != nextTag)
+        {
+            printf("Echo Request %" PRIu16 " delivered when %" PRIu16 " was expected\n", tag, nextTag);
+            return false;
+        }
+        nextTag++;
+    }
+
+    if (nextTag != firstTag + numTags)
+    {
+        printf("Echo Requests %" PRIu16 " to %d not delivered\n", nextTag, firstTag + numTags - 1);
+        return false;
+    }
+
+    return true;
+}
+
+//Drop the first transmission of a message in the middle of a window of sequenced
+//messages, and verify that the peer holds back the messages that follow it and delivers
+//all of them in order once the dropped one is retransmitted.
+testStatus_t TestWRMPSequencedDeliveryOrder(void)
+{
+    testStatus_t testStatus = TEST_FAIL;
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    ExchangeContext *ec = NULL;
+    const uint16_t kNumMessages = 5;
+
+    SeqTestRcvdTagCount = 0;
+
+    ec = NewSeqTestContext(1000);
+    VerifyOrFail(ec != NULL, "NewContext failed\n");
+
+    // The first message creates the exchange on the peer.
+    err = SendSeqTestEcho(ec, 0, false);
+    SuccessOrFail(err, "SendMessage failed\n");
+    WaitForSeqTestTags(1, 2000);
+    VerifyOrFail(SeqTestRcvdTagCount == 1, "No Echo Response received\n");
+
+    for (uint16_t tag = 1; tag < kNumMessages; tag++)
+    {
+        err = SendSeqTestEcho(ec, tag, tag == 1);
+        SuccessOrFail(err, "SendMessage failed\n");
+    }
+
+    WaitForSeqTestTags(kNumMessages, 5000);
+
+    if (!CheckSeqTestDelivery(0, kNumMessages))
+        goto exit;
+
+    testStatus = TEST_PASS;
+
+exit:
+    if (ec != NULL)
+        ec->Close();
+    return testStatus;
+}
+
+//Fill the peer's reorder pool with messages held back on one exchange and then on a
+//second, so that a further message on the second exchange is dropped without an ack,
+//and verify that its retransmission is delivered rather than discarded as a duplicate.
+testStatus_t TestWRMPSequencedReorderPoolFull(void)
+{
+    testStatus_t testStatus = TEST_FAIL;
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    ExchangeContext *ecA = NULL;
+    ExchangeContext *ecB = NULL;
+    const uint16_t kNumHeldA = ((WEAVE_CONFIG_WRMP_REORDER_POOL_SIZE < WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW) ?
+                                WEAVE_CONFIG_WRMP_REORDER_POOL_SIZE : WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW) - 1;
+    const uint16_t kNumHeldB = WEAVE_CONFIG_WRMP_REORDER_POOL_SIZE - kNumHeldA;
+    const uint16_t kFirstTagB = 100;
+
+    SeqTestRcvdTagCount = 0;
+
+    // The second exchange needs room in its window for a lost message, the messages it
+    // holds back and the one that does not fit in the pool.
+    VerifyOrFail(kNumHeldB + 2 <= WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW, "Reorder pool too large for this test\n");
+
+    // The lost message of the second exchange is retransmitted after that of the first
+    // exchange has freed the pool.
+    ecA = NewSeqTestContext(1000);
+    VerifyOrFail(ecA != NULL, "NewContext failed\n");
+    ecB = NewSeqTestContext(2000);
+    VerifyOrFail(ecB != NULL, "NewContext failed\n");
+
+    err = SendSeqTestEcho(ecA, 0, false);
+    SuccessOrFail(err, "SendMessage failed\n");
+    err = SendSeqTestEcho(ecB, kFirstTagB, false);
+    SuccessOrFail(err, "SendMessage failed\n");
+    WaitForSeqTestTags(2, 2000);
+    VerifyOrFail(SeqTestRcvdTagCount == 2, "No Echo Response received\n");
+
+    for (uint16_t tag = 1; tag <= kNumHeldA + 1; tag++)
+    {
+        err = SendSeqTestEcho(ecA, tag, tag == 1);
+        SuccessOrFail(err, "SendMessage failed\n");
+    }
+
+    for (uint16_t tag = kFirstTagB + 1; tag <= kFirstTagB + kNumHeldB + 2; tag++)
+    {
+        err = SendSeqTestEcho(ecB, tag, tag == kFirstTagB + 1);
+        SuccessOrFail(err, "SendMessage failed\n");
+    }
+
+    WaitForSeqTestTags(kNumHeldA + kNumHeldB + 5, 6000);
+
+    if (!CheckSeqTestDelivery(0, kNumHeldA + 2) || !CheckSeqTestDelivery(kFirstTagB, kNumHeldB + 3))
+        goto exit;
+
+    testStatus = TEST_PASS;
+
+exit:
+    if (ecA != NULL)
+        ecA->Close();
+    if (ecB != NULL)
+        ecB->Close();
+    return testStatus;
+}
+
+//Send a message that is a full window ahead of the next one the peer expects, which the
+//peer drops without an ack, then send the messages in between, and verify that the
+//retransmission of the first message is delivered rather than discarded as a duplicate.
+//The message that is too far ahead is sent on a second exchange context that takes over
+//the exchange id of the first one once its sequence number has been advanced.
+testStatus_t TestWRMPSequencedOutOfWindowRetransmit(void)
+{
+    testStatus_t testStatus = TEST_FAIL;
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    ExchangeContext *ec = NULL;
+    ExchangeContext *aheadEc = NULL;
+    const uint16_t kFirstTagAhead = 100;
+    const uint16_t kTagOutOfWindow = 200;
+
+    SeqTestRcvdTagCount = 0;
+
+    // Allocate the exchange context used for the in-window messages first, so that
+    // messages received on the shared exchange are dispatched to it while it is open.
+    ec = NewSeqTestContext(1000);
+    VerifyOrFail(ec != NULL, "NewContext failed\n");
+    aheadEc = NewSeqTestContext(2000);
+    VerifyOrFail(aheadEc != NULL, "NewContext failed\n");
+
+    for (uint16_t tag = kFirstTagAhead; tag <= kFirstTagAhead + WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW; tag++)
+    {
+        err = SendSeqTestEcho(aheadEc, tag, false);
+        SuccessOrFail(err, "SendMessage failed\n");
+        WaitForSeqTestTags(SeqTestRcvdTagCount + 1, 2000);
+    }
+    VerifyOrFail(CheckSeqTestDelivery(kFirstTagAhead, WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW + 1), "Failed to advance sequence number\n");
+
+    err = SendSeqTestEcho(ec, 0, false);
+    SuccessOrFail(err, "SendMessage failed\n");
+    WaitForSeqTestTags(SeqTestRcvdTagCount + 1, 2000);
+
+    // The peer expects sequence number 1 on the exchange, and receives a full window more.
+    aheadEc->ExchangeId = ec->ExchangeId;
+    err = SendSeqTestEcho(aheadEc, kTagOutOfWindow, false);
+    SuccessOrFail(err, "SendMessage failed\n");
+
+    for (uint16_t tag = 1; tag <= WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW; tag++)
+    {
+        err = SendSeqTestEcho(ec, tag, false);
+        SuccessOrFail(err, "SendMessage failed\n");
+    }
+
+    WaitForSeqTestTags(2 * WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW + 2, 1500);
+    VerifyOrFail(CheckSeqTestDelivery(0, WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW + 1), "In-window messages not delivered\n");
+    VerifyOrFail(SeqTestRcvdTagCount == 2 * WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW + 2, "Out-of-window message delivered early\n");
+
+    ec->Close();
+    ec = NULL;
+
+    WaitForSeqTestTags(2 * WEAVE_CONFIG_WRMP_MAX_SEND_WINDOW + 3, 5000);
+
+    if (!CheckSeqTestDelivery(kTagOutOfWindow, 1))
+        goto exit;
+
+    testStatus = TEST_PASS;
+
+exit:
+    if (ec != NULL)
+        ec->Close();
+    if (aheadEc != NULL)
+        aheadEc->Close();
+    return testStatus;
+}
+
+static uint32_t SeqTestAckCount = 0;
+
+static void HandleSeqTestAckRcvd(ExchangeContext *ec, void *msgCtxt)
+{
+    SeqTestAckCount++;
+}
+
+//Advance the peer's sequence number on an exchange, then send messages with sequence
+//numbers behind it that the peer's message layer has not seen before, and verify that
+//the peer acknowledges them without delivering them, and then delivers the next message
+//in sequence. The messages behind the window are sent on a second exchange context that
+//takes over the exchange id of the first one, so that its sequence numbers restart at 0.
+testStatus_t TestWRMPSequencedBehindWindow(void)
+{
+    testStatus_t testStatus = TEST_FAIL;
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    ExchangeContext *ec = NULL;
+    ExchangeContext *behindEc = NULL;
+    const uint16_t kNumMessages = 3;
+    const uint16_t kFirstTagBehind = 100;
+    uint64_t deadline;
+
+    SeqTestRcvdTagCount = 0;
+    SeqTestAckCount = 0;
+
+    ec = NewSeqTestContext(1000);
+    VerifyOrFail(ec != NULL, "NewContext failed\n");
+    behindEc = NewSeqTestContext(1000);
+    VerifyOrFail(behindEc != NULL, "NewContext failed\n");
+    behindEc->OnAckRcvd = HandleSeqTestAckRcvd;
+
+    for (uint16_t tag = 0; tag < kNumMessages; tag++)
+    {
+        err = SendSeqTestEcho(ec, tag, false);
+        SuccessOrFail(err, "SendMessage failed\n");
+        WaitForSeqTestTags(SeqTestRcvdTagCount + 1, 2000);
+    }
+    VerifyOrFail(CheckSeqTestDelivery(0, kNumMessages), "Failed to advance sequence number\n");
+
+    // Messages received on the shared exchange are dispatched to the first exchange
+    // context while it is open.
+    behindEc->ExchangeId = ec->ExchangeId;
+    ec->Close();
+    ec = NULL;
+
+    for (uint16_t tag = kFirstTagBehind; tag < kFirstTagBehind + kNumMessages; tag++)
+    {
+        err = SendSeqTestEcho(behindEc, tag, false);
+        SuccessOrFail(err, "SendMessage failed\n");
+    }
+
+    deadline = Now() + 2000 * System::kTimerFactor_micro_per_milli;
+    while (SeqTestAckCount < kNumMessages && Now() < deadline)
+    {
+        struct timeval sleepTime;
+        sleepTime.tv_sec = 0;
+        sleepTime.tv_usec = 10000;
+
+        ServiceNetwork(sleepTime);
+    }
+    VerifyOrFail(SeqTestAckCount == kNumMessages, "Messages behind the window not acknowledged\n");
+
+    // The next message in sequence is delivered, and those behind the window are not.
+    err = SendSeqTestEcho(behindEc, kNumMessages, false);
+    SuccessOrFail(err, "SendMessage failed\n");
+    WaitForSeqTestTags(kNumMessages + 2, 1500);
+
+    if (!CheckSeqTestDelivery(0, kNumMessages + 1))
+        goto exit;
+    VerifyOrFail(SeqTestRcvdTagCount == kNumMessages + 1, "Message behind the window delivered\n");
+
+    testStatus = TEST_PASS;
+
+exit:
+    if (ec != NULL)
+        ec->Close();
+    if (behindEc != NULL)
+        behindEc->Close();
+    return testStatus;
+}
+
+// Messages received by the client's message layer, counted by a handler interposed in
+// front of that of the exchange manager.
+static WeaveMessageLayer::MessageReceiveFunct AckListTestPrevMsgHandler = NULL;
+static uint32_t AckListTestMsgCount = 0;
+static const size_t AckListTestNumExchanges = 3;
+static uint32_t AckListTestMsgIds[AckListTestNumExchanges];
+static size_t AckListTestMsgIdCount = 0;
+static size_t AckListTestAckCount = 0;
+
+static void HandleAckListTestMsgReceived(WeaveMessageLayer *msgLayer, WeaveMessageInfo *msgInfo, PacketBuffer *payload)
+{
+    AckListTestMsgCount++;
+    AckListTestPrevMsgHandler(msgLayer, msgInfo, payload);
+}
+
+static void HandleAckListTestMessage(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo,
+                                     uint32_t profileId, uint8_t msgType, PacketBuffer *payload)
+{
+    if (AckListTestMsgIdCount < AckListTestNumExchanges)
+    {
+        AckListTestMsgIds[AckListTestMsgIdCount++] = msgInfo->MessageId;
+    }
+    PacketBuffer::Free(payload);
+}
+
+static void HandleAckListTestAckRcvd(ExchangeContext *ec, void *msgCtxt)
+{
+    AckListTestAckCount++;
+}
+
+static ExchangeContext *NewAckListTestContext(void)
+{
+    ExchangeContext *ec = WRMPClient.ExchangeMgr->NewContext(DestNodeId, DestIPAddr, WEAVE_PORT, DestIntf, NULL);
+
+    if (ec != NULL)
+    {
+        ec->EncryptionType = EncryptionType;
+        ec->KeyId = KeyId;
+        ec->OnMessageReceived = HandleAckListTestMessage;
+        ec->OnAckRcvd = HandleAckListTestAckRcvd;
+    }
+
+    return ec;
+}
+
+static void WaitForAckListTest(size_t *count, size_t expected, uint32_t timeout)
+{
+    uint64_t deadline = Now() + timeout * System::kTimerFactor_micro_per_milli;
+
+    while ((count == NULL || *count < expected) && Now() < deadline)
+    {
+        struct timeval sleepTime;
+        sleepTime.tv_sec = 0;
+        sleepTime.tv_usec = 10000;
+
+        ServiceNetwork(sleepTime);
+    }
+}
+
+//Receive a DD_Test message, which the peer sends requesting an ack, on each of several
+//exchanges without acknowledging it, then acknowledge all of them in a single Ack List
+//message sent on one of the exchanges, and verify that the peer applies each ack to its
+//exchange and so does not retransmit any of the messages.
+testStatus_t TestWRMPAckListApply(void)
+{
+    testStatus_t testStatus = TEST_FAIL;
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    ExchangeContext *ecs[AckListTestNumExchanges] = { NULL };
+    PacketBuffer *payloadBuf = NULL;
+    uint8_t *p;
+
+    AckListTestMsgIdCount = 0;
+    AckListTestPrevMsgHandler = WRMPClient.ExchangeMgr->MessageLayer->OnMessageReceived;
+    WRMPClient.ExchangeMgr->MessageLayer->OnMessageReceived = HandleAckListTestMsgReceived;
+
+    for (size_t i = 0; i < AckListTestNumExchanges; i++)
+    {
+        ecs[i] = NewAckListTestContext();
+        VerifyOrFail(ecs[i] != NULL, "NewContext failed\n");
+        ecs[i]->SetDropAck(true);
+
+        PrepareNewBuf(&payloadBuf);
+        err = ecs[i]->SendMessage(kWeaveProfile_Test, kWeaveTestMessageType_DD_Test, payloadBuf, ExchangeContext::kSendFlag_RequestAck);
+        SuccessOrFail(err, "SendMessage failed to send DD_Test message\n");
+
+        WaitForAckListTest(&AckListTestMsgIdCount, i + 1, 2000);
+        VerifyOrFail(AckListTestMsgIdCount == i + 1, "No DD_Test message received\n");
+    }
+
+    // Each entry holds the exchange id, the exchange header flags of the acknowledging
+    // side and the id of the acknowledged message.
+    payloadBuf = PacketBuffer::New();
+    VerifyOrFail(payloadBuf != NULL, "PacketBuffer::New failed\n");
+    p = payloadBuf->Start();
+    for (size_t i = 0; i < AckListTestNumExchanges; i++)
+    {
+        nl::Weave::Encoding::LittleEndian::Write16(p, ecs[i]->ExchangeId);
+        nl::Weave::Encoding::Write8(p, kWeaveExchangeFlag_Initiator);
+        nl::Weave::Encoding::LittleEndian::Write32(p, AckListTestMsgIds[i]);
+    }
+    payloadBuf->SetDataLength(p - payloadBuf->Start());
+
+    err = ecs[0]->SendMessage(kWeaveProfile_Common, Common::kMsgType_WRMP_Ack_List, payloadBuf,
+                              ExchangeContext::kSendFlag_NoAutoRequestAck);
+    SuccessOrFail(err, "SendMessage failed to send Ack List message\n");
+
+    // Messages that are not acknowledged are retransmitted after the peer's default
+    // retransmit timeout.
+    AckListTestMsgCount = 0;
+    WaitForAckListTest(NULL, 0, 2 * WEAVE_CONFIG_WRMP_DEFAULT_INITIAL_RETRANS_TIMEOUT + 1000);
+
+    if (AckListTestMsgCount != 0)
+    {
+        printf("Received %" PRIu32 " retransmitted DD_Test messages\n", AckListTestMsgCount);
+        goto exit;
+    }
+
+    testStatus = TEST_PASS;
+
+exit:
+    WRMPClient.ExchangeMgr->MessageLayer->OnMessageReceived = AckListTestPrevMsgHandler;
+    for (size_t i = 0; i < AckListTestNumExchanges; i++)
+    {
+        if (ecs[i] != NULL)
+            ecs[i]->Close();
+    }
+    return testStatus;
+}
+
+static const uint32_t UMHTestProfileBase = 0x0000FF00;
+static intptr_t UMHTestHandlerId = 0;
+
+static void HandleUMHTestMessage(ExchangeContext *ec, const IPPacketInfo *pktInfo, const WeaveMessageInfo *msgInfo,
+                                 uint32_t profileId, uint8_t msgType, PacketBuffer *payload)
+{
+    UMHTestHandlerId = reinterpret_cast<intptr_t>(ec->AppState);
+    PacketBuffer::Free(payload);
+    ec->Close();
+}
+
+static WEAVE_ERROR RegisterUMHTestHandler(uint32_t profileId, int16_t msgType, WeaveConnection *con, bool allowDups,
+                                          intptr_t handlerId)
+{
+    void *appState = reinterpret_cast<void *>(handlerId);
+
+    if (msgType == -1)
+        return WRMPClient.ExchangeMgr->RegisterUnsolicitedMessageHandler(profileId, HandleUMHTestMessage, allowDups, appState);
+
+    return WRMPClient.ExchangeMgr->RegisterUnsolicitedMessageHandler(profileId, static_cast<uint8_t>(msgType), con,
+                                                                     HandleUMHTestMessage, allowDups, appState);
+}
+
+//Hand an unsolicited message directly to the exchange manager, as if it had been received
+//from the peer, and return the id of the handler that received it, or 0 if none did.
+static intptr_t DispatchUMHTestMessage(uint32_t profileId, uint8_t msgType, WeaveConnection *con, bool isDup)
+{
+    static uint16_t sExchangeId = 0x7000;
+    PacketBuffer *msgBuf = PacketBuffer::New();
+    WeaveMessageInfo msgInfo;
+    IPPacketInfo pktInfo;
+    uint8_t *p;
+
+    VerifyOrFail(msgBuf != NULL, "PacketBuffer::New failed\n");
+
+    p = msgBuf->Start();
+    nl::Weave::Encoding::Write8(p, (kWeaveExchangeVersion_V1 << 4) | kWeaveExchangeFlag_Initiator);
+    nl::Weave::Encoding::Write8(p, msgType);
+    nl::Weave::Encoding::LittleEndian::Write16(p, sExchangeId++);
+    nl::Weave::Encoding::LittleEndian::Write32(p, profileId);
+    msgBuf->SetDataLength(p - msgBuf->Start());
+
+    pktInfo.Clear();
+    pktInfo.SrcAddress = DestIPAddr;
+    pktInfo.SrcPort = WEAVE_PORT;
+
+    msgInfo.Clear();
+    msgInfo.MessageVersion = kWeaveMessageVersion_V1;
+    msgInfo.SourceNodeId = DestNodeId;
+    msgInfo.DestNodeId = FabricState.LocalNodeId;
+    msgInfo.EncryptionType = kWeaveEncryptionType_None;
+    msgInfo.KeyId = WeaveKeyId::kNone;
+    msgInfo.Flags = isDup ? kWeaveMessageFlag_DuplicateMessage : 0;
+    msgInfo.InPacketInfo = &pktInfo;
+    msgInfo.InCon = con;
+
+    UMHTestHandlerId = 0;
+    WRMPClient.ExchangeMgr->MessageLayer->OnMessageReceived(WRMPClient.ExchangeMgr->MessageLayer, &msgInfo, msgBuf);
+
+    return UMHTestHandlerId;
+}
+
+//Register unsolicited message handlers for specific message types, for all messages of a
+//profile and for specific connections, and verify that each unsolicited message goes to
+//the most specific handler, including when the handler pool is full and entries are
+//reused after being unregistered.
+testStatus_t TestWRMPUnsolicitedHandlerDispatch(void)
+{
+    const uint32_t profileA = UMHTestProfileBase;
+    const uint32_t profileB = UMHTestProfileBase + 1;
+    const uint32_t profileC = UMHTestProfileBase + 2;
+    const uint32_t fillProfileBase = UMHTestProfileBase + 0x10;
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    WeaveConnection *con = NULL;
+    uint32_t fillCount = 0;
+
+    // A handler for a message type is preferred over one for the whole profile.
+    err = RegisterUMHTestHandler(profileA, -1, NULL, false, 1);
+    SuccessOrFail(err, "RegisterUnsolicitedMessageHandler failed\n");
+    err = RegisterUMHTestHandler(profileA, 5, NULL, false, 2);
+    SuccessOrFail(err, "RegisterUnsolicitedMessageHandler failed\n");
+    VerifyOrFail(DispatchUMHTestMessage(profileA, 5, NULL, false) == 2, "Message not delivered to message type handler\n");
+    VerifyOrFail(DispatchUMHTestMessage(profileA, 6, NULL, false) == 1, "Message not delivered to profile handler\n");
+    VerifyOrFail(DispatchUMHTestMessage(profileB, 5, NULL, false) == 0, "Message delivered to handler of other profile\n");
+
+    // Registering the same profile and message type again replaces the handler.
+    err = RegisterUMHTestHandler(profileA, 5, NULL, false, 3);
+    SuccessOrFail(err, "RegisterUnsolicitedMessageHandler failed\n");
+    VerifyOrFail(DispatchUMHTestMessage(profileA, 5, NULL, false) == 3, "Message not delivered to replacement handler\n");
+
+    // Duplicate messages skip handlers that do not accept them.
+    err = RegisterUMHTestHandler(profileB, 1, NULL, false, 4);
+    SuccessOrFail(err, "RegisterUnsolicitedMessageHandler failed\n");
+    err = RegisterUMHTestHandler(profileB, -1, NULL, true, 5);
+    SuccessOrFail(err, "RegisterUnsolicitedMessageHandler failed\n");
+    VerifyOrFail(DispatchUMHTestMessage(profileB, 1, NULL, false) == 4, "Message not delivered to message type handler\n");
+    VerifyOrFail(DispatchUMHTestMessage(profileB, 1, NULL, true) == 5, "Duplicate message not delivered to profile handler\n");
+
+    // A handler for the connection over which a message arrives is preferred over one for any
+    // connection, even when registered after it.
+    con = WRMPClient.ExchangeMgr->MessageLayer->NewConnection();
+    VerifyOrFail(con != NULL, "NewConnection failed\n");
+    err = RegisterUMHTestHandler(profileC, 1, NULL, false, 6);
+    SuccessOrFail(err, "RegisterUnsolicitedMessageHandler failed\n");
+    err = RegisterUMHTestHandler(profileC, 1, con, false, 7);
+    SuccessOrFail(err, "RegisterUnsolicitedMessageHandler failed\n");
+    VerifyOrFail(DispatchUMHTestMessage(profileC, 1, con, false) == 7, "Message not delivered to connection handler\n");
+    VerifyOrFail(DispatchUMHTestMessage(profileC, 1, NULL, false) == 6, "Message not delivered to handler for any connection\n");
+
+    // Fill the rest of the pool, with handlers that share hash chains with the others.
+    while ((err = RegisterUMHTestHandler(fillProfileBase + fillCount, fillCount & 0xFF, NULL, false, 100 + fillCount)) == WEAVE_NO_ERROR)
+        fillCount++;
+    VerifyOrFail(err == WEAVE_ERROR_TOO_MANY_UNSOLICITED_MESSAGE_HANDLERS, "Unexpected error when handler pool is full\n");
+    VerifyOrFail(fillCount > 1, "Handler pool too small\n");
+
+    for (uint32_t i = 0; i < fillCount; i++)
+        VerifyOrFail(DispatchUMHTestMessage(fillProfileBase + i, i & 0xFF, NULL, false) == static_cast<intptr_t>(100 + i),
+                     "Message not delivered to its handler\n");
+
+    // An unregistered entry is free for a new registration.
+    err = WRMPClient.ExchangeMgr->UnregisterUnsolicitedMessageHandler(fillProfileBase, 0);
+    SuccessOrFail(err, "UnregisterUnsolicitedMessageHandler failed\n");
+    VerifyOrFail(DispatchUMHTestMessage(fillProfileBase, 0, NULL, false) == 0, "Message delivered to unregistered handler\n");
+    err = RegisterUMHTestHandler(fillProfileBase + fillCount, 0, NULL, false, 8);
+    SuccessOrFail(err, "RegisterUnsolicitedMessageHandler failed after unregistering a handler\n");
+    VerifyOrFail(DispatchUMHTestMessage(fillProfileBase + fillCount, 0, NULL, false) == 8, "Message not delivered to its handler\n");
+    VerifyOrFail(DispatchUMHTestMessage(fillProfileBase + 1, 1, NULL, false) == 101, "Message not delivered to its handler\n");
+
+    // Unregistering the message type handler exposes the profile handler.
+    err = WRMPClient.ExchangeMgr->UnregisterUnsolicitedMessageHandler(profileA, 5);
+    SuccessOrFail(err, "UnregisterUnsolicitedMessageHandler failed\n");
+    VerifyOrFail(DispatchUMHTestMessage(profileA, 5, NULL, false) == 1, "Message not delivered to profile handler\n");
+    err = WRMPClient.ExchangeMgr->UnregisterUnsolicitedMessageHandler(profileA);
+    SuccessOrFail(err, "UnregisterUnsolicitedMessageHandler failed\n");
+    VerifyOrFail(DispatchUMHTestMessage(profileA, 5, NULL, false) == 0, "Message delivered to unregistered handler\n");
+    err = WRMPClient.ExchangeMgr->UnregisterUnsolicitedMessageHandler(profileA);
+    VerifyOrFail(err == WEAVE_ERROR_NO_UNSOLICITED_MESSAGE_HANDLER, "Unregistered a handler twice\n");
+
+    // Release the remaining handlers.
+    WRMPClient.ExchangeMgr->UnregisterUnsolicitedMessageHandler(profileB, 1);
+    WRMPClient.ExchangeMgr->UnregisterUnsolicitedMessageHandler(profileB);
+    WRMPClient.ExchangeMgr->UnregisterUnsolicitedMessageHandler(profileC, 1);
+    WRMPClient.ExchangeMgr->UnregisterUnsolicitedMessageHandler(profileC, 1, con);
+    for (uint32_t i = 1; i <= fillCount; i++)
+        WRMPClient.ExchangeMgr->UnregisterUnsolicitedMessageHandler(fillProfileBase + i, (i == fillCount) ? 0 : (i & 0xFF));
+    con->Close();
+
+    return TEST_PASS;
+}
+
+#if WEAVE_CONFIG_WRMP_MAX_ACK_LIST_ENTRIES > 0
+//Send messages that are acknowledged by standalone acks on several exchanges at once,
+//and verify that the peer coalesces the acks into a single Ack List message, which is
+//applied to each of the exchanges.
+testStatus_t TestWRMPAckListCoalescing(void)
+{
+    testStatus_t testStatus = TEST_FAIL;
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    ExchangeContext *ecs[AckListTestNumExchanges] = { NULL };
+    PacketBuffer *payloadBuf = NULL;
+
+    AckListTestAckCount = 0;
+    AckListTestMsgCount = 0;
+    AckListTestPrevMsgHandler = WRMPClient.ExchangeMgr->MessageLayer->OnMessageReceived;
+    WRMPClient.ExchangeMgr->MessageLayer->OnMessageReceived = HandleAckListTestMsgReceived;
+
+    for (size_t i = 0; i < AckListTestNumExchanges; i++)
+    {
+        ecs[i] = NewAckListTestContext();
+        VerifyOrFail(ecs[i] != NULL, "NewContext failed\n");
+
+        PrepareNewBuf(&payloadBuf);
+        err = ecs[i]->SendMessage(kWeaveProfile_Test, kWeaveTestMessageType_No_Response, payloadBuf,
+                                  ExchangeContext::kSendFlag_RequestAck);
+        SuccessOrFail(err, "SendMessage failed to send No_Response message\n");
+    }
+
+    WaitForAckListTest(&AckListTestAckCount, AckListTestNumExchanges, 2000);
+
+    if (AckListTestAckCount != AckListTestNumExchanges)
+    {
+        printf("Received %zu of %zu Acks\n", AckListTestAckCount, AckListTestNumExchanges);
+        goto exit;
+    }
+
+    printf("Received %zu Acks in %" PRIu32 " messages\n", AckListTestAckCount, AckListTestMsgCount);
+    if (AckListTestMsgCount != 1)
+        goto exit;
+
+    testStatus = TEST_PASS;
+
+exit:
+    WRMPClient.ExchangeMgr->MessageLayer->OnMessageReceived = AckListTestPrevMsgHandler;
+    for (size_t i = 0; i < AckListTestNumExchanges; i++)
+    {
+        if (ecs[i] != NULL)
+            ecs[i]->Close();
+    }
+    return testStatus;
+}
+#endif // WEAVE_CONFIG_WRMP_MAX_ACK_LIST_ENTRIES > 0
+
 struct Tests {
     testStatus_t (*mTest)(void);
     const char * mTestName;
@@ -1445,7 +2420,20 @@ Tests gTests[] =
     { .mTest = TestWRMPDuplicateMsgLostAck, .mTestName = "TestWRMPDuplicateMsgLostAck" },
     { .mTest = TestWRMPDuplicateMsgAckOnClosedExResponder, .mTestName = "TestWRMPDuplicateMsgAckOnClosedExResponder" },
     { .mTest = TestWRMPDuplicateMsgAckOnClosedExInitiator, .mTestName = "TestWRMPDuplicateMsgAckOnClosedExInitiator" },
-    { .mTest = TestWRMPDuplicateMsgDetection, .mTestName = "TestWRMPDuplicateMsgDetection" }
+    { .mTest = TestWRMPDuplicateMsgDetection, .mTestName = "TestWRMPDuplicateMsgDetection" },
+    { .mTest = TestWRMPRetransWheelExpiryOrder, .mTestName = "TestWRMPRetransWheelExpiryOrder" },
+    { .mTest = TestWRMPSequencedDeliveryOrder, .mTestName = "TestWRMPSequencedDeliveryOrder" },
+    { .mTest = TestWRMPSequencedReorderPoolFull, .mTestName = "TestWRMPSequencedReorderPoolFull" },
+    { .mTest = TestWRMPSequencedOutOfWindowRetransmit, .mTestName = "TestWRMPSequencedOutOfWindowRetransmit" },
+    { .mTest = TestWRMPSequencedBehindWindow, .mTestName = "TestWRMPSequencedBehindWindow" },
+    { .mTest = TestWRMPAckListApply, .mTestName = "TestWRMPAckListApply" },
+    { .mTest = TestWRMPUnsolicitedHandlerDispatch, .mTestName = "TestWRMPUnsolicitedHandlerDispatch" },
+#if WEAVE_CONFIG_WRMP_RTT_TABLE_SIZE > 0
+    { .mTest = TestWRMPAdaptiveRetransTimeout, .mTestName = "TestWRMPAdaptiveRetransTimeout" },
+#endif
+#if WEAVE_CONFIG_WRMP_MAX_ACK_LIST_ENTRIES > 0
+    { .mTest = TestWRMPAckListCoalescing, .mTestName = "TestWRMPAckListCoalescing" },
+#endif
 };
 
 #endif // WEAVE_CONFIG_ENABLE_RELIABLE_MESSAGING
@@ -30,6 +30,24 @@
 #include <Weave/Core/WeaveCore.h>
 
 #include "ToolCommon.h"
+#include "TestGroupKeyStore.h"
+
+namespace nl {
+namespace Weave {
+
+class WeaveFabricStateTestObject
+{
+public:
+#if WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC
+    static bool IsAppKeyCached(WeaveFabricState &fabricState, uint16_t keyId, uint8_t encType)
+    {
+        return fabricState.AppKeyCache.IsKeyCached(keyId, encType);
+    }
+#endif
+};
+
+} // namespace Weave
+} // namespace nl
 
 static const uint64_t kTestNodeId = 0x18B43000002DCF71ULL;
 static const uint64_t kTestFabricId = 0xFEEDBEEFULL;
@@ -101,6 +119,385 @@ static void CheckSelectNodeAddressWithSubnet(nlTestSuite *inSuite, void *inConte
     }
 }
 
+/**
+ * Test duplicate message detection for messages received out of order.
+ */
+static void CheckDuplicateMessageWindow(nlTestSuite *inSuite, void *inContext)
+{
+    const uint32_t kWindow = WeaveSessionState::kReceiveFlags_NumMessageIdFlags;
+    const uint32_t kFirstMsgId = 1000;
+    uint32_t initialMsgIdRcvd = 0;
+    uint32_t maxMsgIdRcvd = 0;
+    WeaveSessionState::ReceiveFlagsType rcvFlags = 0;
+    WeaveSessionState sessionState(NULL, kWeaveAuthMode_Unauthenticated, NULL, &initialMsgIdRcvd, &maxMsgIdRcvd, &rcvFlags);
+
+    NL_TEST_ASSERT(inSuite, sessionState.MessageIdNotSynchronized() == true);
+    NL_TEST_ASSERT(inSuite, sessionState.IsDuplicateMessage(kFirstMsgId) == false);
+    NL_TEST_ASSERT(inSuite, sessionState.MessageIdNotSynchronized() == false);
+    NL_TEST_ASSERT(inSuite, sessionState.IsDuplicateMessage(kFirstMsgId) == true);
+
+    // Receive the last message of the window first, then the ones before it in reverse order.
+    NL_TEST_ASSERT(inSuite, sessionState.IsDuplicateMessage(kFirstMsgId + kWindow) == false);
+    for (uint32_t msgId = kFirstMsgId + kWindow - 1; msgId > kFirstMsgId; msgId--)
+    {
+        NL_TEST_ASSERT(inSuite, sessionState.IsDuplicateMessage(msgId) == false);
+    }
+
+    // Every message in the window has now been received exactly once.
+    for (uint32_t msgId = kFirstMsgId; msgId <= kFirstMsgId + kWindow; msgId++)
+    {
+        NL_TEST_ASSERT(inSuite, sessionState.IsDuplicateMessage(msgId) == true);
+    }
+
+    // Sliding the window past the first message forgets it; being unencrypted, it is accepted again.
+    NL_TEST_ASSERT(inSuite, sessionState.IsDuplicateMessage(kFirstMsgId + kWindow + 1) == false);
+    NL_TEST_ASSERT(inSuite, sessionState.IsDuplicateMessage(kFirstMsgId + 1) == true);
+    NL_TEST_ASSERT(inSuite, sessionState.IsDuplicateMessage(kFirstMsgId) == false);
+}
+
+/**
+ * Test lookup and least recently used replacement of entries in the peer state table.
+ */
+static void CheckPeerTable(nlTestSuite *inSuite, void *inContext)
+{
+    const uint64_t kFirstPeerNodeId = 0x18B4300000000001ULL;
+    const uint32_t kNumPeers = 2 * WEAVE_CONFIG_MAX_PEER_NODES;
+    const uint32_t kMsgId = 100;
+    WeaveSessionState sessionState;
+    WEAVE_ERROR err;
+
+    // Receive a message from more peers than the table holds.
+    for (uint32_t i = 0; i < kNumPeers; i++)
+    {
+        err = sFabricState.GetSessionState(kFirstPeerNodeId + i, WeaveKeyId::kNone, kWeaveEncryptionType_None, NULL, sessionState);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, sessionState.IsDuplicateMessage(kMsgId) == false);
+    }
+
+    // The most recently used peers are still known, so the message is recognized as a duplicate.
+    for (uint32_t i = kNumPeers - WEAVE_CONFIG_MAX_PEER_NODES; i < kNumPeers; i++)
+    {
+        err = sFabricState.GetSessionState(kFirstPeerNodeId + i, WeaveKeyId::kNone, kWeaveEncryptionType_None, NULL, sessionState);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, sessionState.IsDuplicateMessage(kMsgId) == true);
+    }
+
+    // The least recently used peers were replaced.
+    err = sFabricState.GetSessionState(kFirstPeerNodeId, WeaveKeyId::kNone, kWeaveEncryptionType_None, NULL, sessionState);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, sessionState.MessageIdNotSynchronized() == true);
+}
+
+/**
+ * Test lookup, removal and idle eviction of entries in the session key table.
+ */
+static void CheckSessionKeyTable(nlTestSuite *inSuite, void *inContext)
+{
+    const uint64_t kFirstPeerNodeId = 0x18B4300000000101ULL;
+    const uint16_t kFirstKeyId = WeaveKeyId::MakeSessionKeyId(0x100);
+    WeaveEncryptionKey encKey;
+    WeaveSessionKey *sessionKey;
+    WEAVE_ERROR err;
+
+    memset(&encKey, 0, sizeof(encKey));
+
+    // Fill the table with established, unreserved, remove-on-idle sessions.
+    for (uint16_t i = 0; i < WEAVE_CONFIG_MAX_SESSION_KEYS; i++)
+    {
+        err = sFabricState.AllocSessionKey(kFirstPeerNodeId + i, kFirstKeyId + i, NULL, sessionKey);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        err = sFabricState.SetSessionKey(sessionKey, kWeaveEncryptionType_AES128CTRSHA1, kWeaveAuthMode_CASE_AnyCert, &encKey);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        sessionKey->SetRemoveOnIdle(true);
+        sessionKey->ReserveCount = 0;
+        sFabricState.MarkSessionKeyIdle(sessionKey);
+    }
+
+    // Every session is found by key id and peer, and only by the right pair.
+    for (uint16_t i = 0; i < WEAVE_CONFIG_MAX_SESSION_KEYS; i++)
+    {
+        err = sFabricState.GetSessionKey(kFirstKeyId + i, kFirstPeerNodeId + i, sessionKey);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, sessionKey->MsgEncKey.KeyId == kFirstKeyId + i);
+        err = sFabricState.GetSessionKey(kFirstKeyId + i, kFirstPeerNodeId + i + 1, sessionKey);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_KEY_NOT_FOUND);
+    }
+
+    // An allocation on behalf of an unauthenticated peer does not evict any session.
+    err = sFabricState.AllocSessionKey(kFirstPeerNodeId, kFirstKeyId + WEAVE_CONFIG_MAX_SESSION_KEYS, NULL, sessionKey);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_TOO_MANY_KEYS);
+    for (uint16_t i = 0; i < WEAVE_CONFIG_MAX_SESSION_KEYS; i++)
+    {
+        err = sFabricState.GetSessionKey(kFirstKeyId + i, kFirstPeerNodeId + i, sessionKey);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    }
+
+    // An allocation that is allowed to evict removes the least recently released session.
+    err = sFabricState.AllocSessionKey(kFirstPeerNodeId, kFirstKeyId + WEAVE_CONFIG_MAX_SESSION_KEYS, NULL, sessionKey, true);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = sFabricState.GetSessionKey(kFirstKeyId, kFirstPeerNodeId, sessionKey);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_KEY_NOT_FOUND);
+
+    // With the new session still reserved and being established, and the others reserved too,
+    // there is nothing left to evict.
+    for (uint16_t i = 1; i < WEAVE_CONFIG_MAX_SESSION_KEYS; i++)
+    {
+        err = sFabricState.GetSessionKey(kFirstKeyId + i, kFirstPeerNodeId + i, sessionKey);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        sessionKey->ReserveCount++;
+        sFabricState.ClearSessionKeyIdle(sessionKey);
+    }
+    err = sFabricState.AllocSessionKey(kFirstPeerNodeId, kFirstKeyId, NULL, sessionKey, true);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_TOO_MANY_KEYS);
+
+    // Release the sessions again; they are removed after two idle periods.
+    for (uint16_t i = 1; i < WEAVE_CONFIG_MAX_SESSION_KEYS; i++)
+    {
+        err = sFabricState.GetSessionKey(kFirstKeyId + i, kFirstPeerNodeId + i, sessionKey);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        sessionKey->ReserveCount--;
+        sessionKey->MarkRecentlyActive();
+        sFabricState.MarkSessionKeyIdle(sessionKey);
+    }
+    NL_TEST_ASSERT(inSuite, sFabricState.RemoveIdleSessionKeys() == true);
+    NL_TEST_ASSERT(inSuite, sFabricState.RemoveIdleSessionKeys() == false);
+    for (uint16_t i = 1; i < WEAVE_CONFIG_MAX_SESSION_KEYS; i++)
+    {
+        err = sFabricState.GetSessionKey(kFirstKeyId + i, kFirstPeerNodeId + i, sessionKey);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_ERROR_KEY_NOT_FOUND);
+    }
+
+    // The session that was never released is still there.
+    err = sFabricState.RemoveSessionKey(kFirstKeyId + WEAVE_CONFIG_MAX_SESSION_KEYS, kFirstPeerNodeId);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+}
+
+/**
+ * Test the encoding of the message received flags of a suspended session, and their restoration.
+ */
+static void CheckSerializedSessionRcvFlags(nlTestSuite *inSuite, void *inContext)
+{
+    const uint64_t kPeerNodeId = 0x18B4300000000201ULL;
+    const uint16_t kKeyId = WeaveKeyId::MakeSessionKeyId(0x200);
+    const uint32_t kMaxRcvdMsgId = 5000;
+    // Messages 1, 2 and 15 prior to the max received message id, and message 31 for a wider window.
+#if WEAVE_CONFIG_MSG_COUNTER_WINDOW_SIZE > 16
+    const WeaveSessionState::ReceiveFlagsType kWindowFlags = 0x40004003;
+#else
+    const WeaveSessionState::ReceiveFlagsType kWindowFlags = 0x4003;
+#endif
+    WeaveEncryptionKey encKey;
+    WeaveSessionKey *sessionKey;
+    uint8_t buf[256];
+    uint8_t legacyBuf[256];
+    uint16_t len;
+    uint16_t legacyLen;
+    uint16_t legacyRcvFlags = 0;
+    uint64_t extendedRcvFlags = 0;
+    bool extendedFound = false;
+    TLV::TLVReader reader;
+    TLV::TLVWriter writer;
+    TLV::TLVType container;
+    TLV::TLVType outerContainer;
+    WEAVE_ERROR err;
+
+    memset(&encKey, 0, sizeof(encKey));
+
+    err = sFabricState.AllocSessionKey(kPeerNodeId, kKeyId, NULL, sessionKey);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = sFabricState.SetSessionKey(sessionKey, kWeaveEncryptionType_AES128CTRSHA1, kWeaveAuthMode_CASE_AnyCert, &encKey);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    sessionKey->MaxRcvdMsgId = kMaxRcvdMsgId;
+    sessionKey->RcvFlags = WeaveSessionState::kReceiveFlags_MessageIdSynchronized | kWindowFlags;
+
+    err = sFabricState.SuspendSession(kKeyId, kPeerNodeId, buf, sizeof(buf), len);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+
+    // The flags are encoded in the 16-bit format under the original tag, and in full under their own tag
+    // if the window is wider and holds flags beyond the first 15.
+    reader.Init(buf, len);
+    err = reader.Next();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = reader.EnterContainer(container);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    while (reader.Next() == WEAVE_NO_ERROR)
+    {
+        if (reader.GetTag() == TLV::ContextTag(Security::kTag_SerializedSession_MessageRcvdFlags))
+        {
+            err = reader.Get(legacyRcvFlags);
+            NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        }
+        else if (reader.GetTag() == TLV::ContextTag(Security::kTag_SerializedSession_ExtendedMessageRcvdFlags))
+        {
+            err = reader.Get(extendedRcvFlags);
+            NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+            extendedFound = true;
+        }
+    }
+    NL_TEST_ASSERT(inSuite, legacyRcvFlags == 0xC003);
+    NL_TEST_ASSERT(inSuite, extendedFound == (WEAVE_CONFIG_MSG_COUNTER_WINDOW_SIZE > 16));
+    NL_TEST_ASSERT(inSuite, !extendedFound || extendedRcvFlags == kWindowFlags);
+
+    // Restoring the session restores the full window.
+    err = sFabricState.RestoreSession(buf, len);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = sFabricState.GetSessionKey(kKeyId, kPeerNodeId, sessionKey);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, sessionKey->MaxRcvdMsgId == kMaxRcvdMsgId);
+    NL_TEST_ASSERT(inSuite, sessionKey->RcvFlags == (WeaveSessionState::kReceiveFlags_MessageIdSynchronized | kWindowFlags));
+
+    // A session serialized without the extended flags, as by an older implementation, is restored with
+    // the 16-bit window.
+    err = sFabricState.SuspendSession(kKeyId, kPeerNodeId, buf, sizeof(buf), len);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    reader.Init(buf, len);
+    writer.Init(legacyBuf, sizeof(legacyBuf));
+    err = reader.Next();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = writer.StartContainer(reader.GetTag(), TLV::kTLVType_Structure, outerContainer);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = reader.EnterContainer(container);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    while (reader.Next() == WEAVE_NO_ERROR)
+    {
+        if (reader.GetTag() != TLV::ContextTag(Security::kTag_SerializedSession_ExtendedMessageRcvdFlags))
+        {
+            err = writer.CopyElement(reader);
+            NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        }
+    }
+    err = writer.EndContainer(outerContainer);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = writer.Finalize();
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    legacyLen = static_cast<uint16_t>(writer.GetLengthWritten());
+
+    err = sFabricState.RestoreSession(legacyBuf, legacyLen);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = sFabricState.GetSessionKey(kKeyId, kPeerNodeId, sessionKey);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    NL_TEST_ASSERT(inSuite, sessionKey->RcvFlags == (WeaveSessionState::kReceiveFlags_MessageIdSynchronized | (kWindowFlags & 0x7FFF)));
+
+    err = sFabricState.RemoveSessionKey(kKeyId, kPeerNodeId);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+}
+
+#if WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC
+
+/**
+ * Test lookup and least recently used replacement of entries in the message encryption application key cache.
+ */
+static void CheckAppKeyCache(nlTestSuite *inSuite, void *inContext)
+{
+    const uint16_t kFirstKeyId = WeaveKeyId::kType_AppStaticKey | 0x100;
+    const uint8_t kEncType = kWeaveEncryptionType_AES128CTRSHA1;
+    static WeaveMsgEncryptionKeyCache keyCache;
+    WeaveMsgEncryptionKey *firstKeyEntry;
+
+    keyCache.Init();
+
+    // A key that is not cached is given an empty entry, which is found again once it has been filled in.
+    firstKeyEntry = keyCache.FindOrAllocateKeyEntry(kFirstKeyId, kEncType);
+    NL_TEST_ASSERT(inSuite, firstKeyEntry->KeyId == WeaveKeyId::kNone);
+    NL_TEST_ASSERT(inSuite, keyCache.IsKeyCached(kFirstKeyId, kEncType) == false);
+    firstKeyEntry->KeyId = kFirstKeyId;
+    firstKeyEntry->EncType = kEncType;
+    NL_TEST_ASSERT(inSuite, keyCache.IsKeyCached(kFirstKeyId, kEncType) == true);
+    NL_TEST_ASSERT(inSuite, keyCache.FindOrAllocateKeyEntry(kFirstKeyId, kEncType) == firstKeyEntry);
+
+#if WEAVE_CONFIG_MSG_ENC_APP_KEY_CACHE_SHARDS == 1
+    // Fill the cache, using the first key after adding each of the others.
+    for (uint16_t i = 1; i < WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS; i++)
+    {
+        WeaveMsgEncryptionKey *keyEntry = keyCache.FindOrAllocateKeyEntry(kFirstKeyId + i, kEncType);
+        NL_TEST_ASSERT(inSuite, keyEntry->KeyId == WeaveKeyId::kNone);
+        keyEntry->KeyId = kFirstKeyId + i;
+        keyEntry->EncType = kEncType;
+        NL_TEST_ASSERT(inSuite, keyCache.FindOrAllocateKeyEntry(kFirstKeyId, kEncType) == firstKeyEntry);
+    }
+
+    // Another key replaces the least recently used one, which is the second key.
+    NL_TEST_ASSERT(inSuite, keyCache.FindOrAllocateKeyEntry(kFirstKeyId + WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS, kEncType)->KeyId == WeaveKeyId::kNone);
+    NL_TEST_ASSERT(inSuite, keyCache.IsKeyCached(kFirstKeyId + 1, kEncType) == false);
+    NL_TEST_ASSERT(inSuite, keyCache.IsKeyCached(kFirstKeyId, kEncType) == true);
+    for (uint16_t i = 2; i < WEAVE_CONFIG_MAX_CACHED_MSG_ENC_APP_KEYS; i++)
+    {
+        NL_TEST_ASSERT(inSuite, keyCache.IsKeyCached(kFirstKeyId + i, kEncType) == true);
+    }
+#endif // WEAVE_CONFIG_MSG_ENC_APP_KEY_CACHE_SHARDS == 1
+
+    keyCache.Shutdown();
+}
+
+#if WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME > 0
+
+/**
+ * Test that the prefetch timer derives the rotating application keys of the next epoch shortly before it starts.
+ */
+static void CheckAppKeyPrefetch(nlTestSuite *inSuite, void *inContext)
+{
+    const uint64_t kPeerNodeId = 0x18B4300000000301ULL;
+    const uint8_t kEncType = kWeaveEncryptionType_AES128CTRSHA1;
+    const uint16_t kCurKeyId = static_cast<uint16_t>(WeaveKeyId::UpdateEpochKeyId(sAppRotatingKeyId_SRK_E3_G54, sEpochKey2_KeyId));
+    const uint16_t kNextKeyId = static_cast<uint16_t>(sAppRotatingKeyId_SRK_E3_G54);
+    const uint32_t kPrefetchTimes[] =
+    {
+        0,
+        sEpochKey3_StartTime - 2 * WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME,
+        sEpochKey3_StartTime - WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME / 2
+    };
+    static WeaveFabricState fabricState;
+    static WeaveMessageLayer messageLayer;
+    TestGroupKeyStore keyStore;
+    WeaveSessionState sessionState;
+    struct timeval sleepTime = { 0, 10000 };
+    WEAVE_ERROR err;
+
+    InitSystemLayer();
+    messageLayer.SystemLayer = &SystemLayer;
+
+    // Look up a key of the current epoch without a clock, long before the next epoch starts, and
+    // shortly before it starts.  Only in the last case is the next-epoch key prefetched, and then
+    // only once the timer has run.
+    for (size_t i = 0; i < sizeof(kPrefetchTimes) / sizeof(kPrefetchTimes[0]); i++)
+    {
+        sCurrentUTCTime = kPrefetchTimes[i];
+
+        err = fabricState.Init(&keyStore);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        fabricState.MessageLayer = &messageLayer;
+
+        err = fabricState.GetSessionState(kPeerNodeId, kCurKeyId, kEncType, NULL, sessionState);
+        NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+        NL_TEST_ASSERT(inSuite, WeaveFabricStateTestObject::IsAppKeyCached(fabricState, kCurKeyId, kEncType) == true);
+        NL_TEST_ASSERT(inSuite, WeaveFabricStateTestObject::IsAppKeyCached(fabricState, kNextKeyId, kEncType) == false);
+
+        ServiceNetwork(sleepTime);
+        NL_TEST_ASSERT(inSuite, WeaveFabricStateTestObject::IsAppKeyCached(fabricState, kNextKeyId, kEncType) == (i == 2));
+
+        fabricState.Shutdown();
+    }
+
+    // The prefetched key is used without deriving it again.
+    err = fabricState.Init(&keyStore);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    fabricState.MessageLayer = &messageLayer;
+    err = fabricState.GetSessionState(kPeerNodeId, kCurKeyId, kEncType, NULL, sessionState);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    ServiceNetwork(sleepTime);
+    err = keyStore.DeleteGroupKey(sEpochKey3_KeyId);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    err = fabricState.GetSessionState(kPeerNodeId, kNextKeyId, kEncType, NULL, sessionState);
+    NL_TEST_ASSERT(inSuite, err == WEAVE_NO_ERROR);
+    fabricState.Shutdown();
+
+    sCurrentUTCTime = 0;
+    ShutdownSystemLayer();
+}
+
+#endif // WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME > 0
+#endif // WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC
+
 /**
  *  Set up the test suite.
  */
@@ -131,6 +528,16 @@ static const nlTest sTests[] =
     // more thorough collection of tests should be written.
     NL_TEST_DEF("WeaveFabricState::SelectNodeAddress", CheckSelectNodeAddress),
     NL_TEST_DEF("WeaveFabricState::SelectNodeAddress", CheckSelectNodeAddressWithSubnet),
+    NL_TEST_DEF("WeaveSessionState::IsDuplicateMessage", CheckDuplicateMessageWindow),
+    NL_TEST_DEF("WeaveFabricState::GetSessionState", CheckPeerTable),
+    NL_TEST_DEF("WeaveFabricState::FindSessionKey", CheckSessionKeyTable),
+    NL_TEST_DEF("WeaveFabricState::SuspendSession", CheckSerializedSessionRcvFlags),
+#if WEAVE_CONFIG_USE_APP_GROUP_KEYS_FOR_MSG_ENC
+    NL_TEST_DEF("WeaveMsgEncryptionKeyCache::FindOrAllocateKeyEntry", CheckAppKeyCache),
+#if WEAVE_CONFIG_MSG_ENC_APP_KEY_PREFETCH_LEAD_TIME > 0
+    NL_TEST_DEF("WeaveFabricState::PrefetchMsgEncAppKeys", CheckAppKeyPrefetch),
+#endif
+#endif
     NL_TEST_SENTINEL()
 };
 
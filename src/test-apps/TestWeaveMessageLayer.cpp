@@ -55,6 +55,9 @@ int32_t SendInterval = 1000000;
 int32_t SendLength = -1;
 bool UseTCP = false;
 bool UseSessionKey = false;
+int32_t BatchSize = 0;
+
+enum { kMaxBatchSize = 64 };
 
 static OptionDef gToolOptionDefs[] =
 {
@@ -63,6 +66,7 @@ static OptionDef gToolOptionDefs[] =
     { "length",             kArgumentRequired,  'l' },
     { "interval",           kArgumentRequired,  'i' },
     { "tcp",                kNoArgument,        't' },
+    { "batch",              kArgumentRequired,  'b' },
 #if WEAVE_CONFIG_SECURITY_TEST_MODE
     { "use-session-key",    kNoArgument,        'S' },
 #endif
@@ -86,6 +90,11 @@ static const char *gToolOptionHelp =
     "  -t, --tcp\n"
     "       Use TCP to send weave messages. Defaults to using UDP.\n"
     "\n"
+    "  -b, --batch <num>\n"
+    "       Send each weave message to the destination node the specified number of\n"
+    "       times (up to 64) in a single batch, using WeaveMessageLayer::SendMessageBatch().\n"
+    "       Only supported over UDP.\n"
+    "\n"
 #if WEAVE_CONFIG_SECURITY_TEST_MODE
     "  -S, --use-session-key\n"
     "       Use a session key when encrypting weave messages.\n"
@@ -177,6 +186,13 @@ bool HandleOption(const char *progName, OptionSet *optSet, int id, const char *n
     case 't':
         UseTCP = true;
         break;
+    case 'b':
+        if (!ParseInt(arg, BatchSize) || BatchSize < 1 || BatchSize > kMaxBatchSize)
+        {
+            PrintArgError("%s: Invalid value specified for batch size: %s\n", progName, arg);
+            return false;
+        }
+        break;
     case 'c':
         if (!ParseInt(arg, MaxSendCount) || MaxSendCount < 0)
         {
@@ -233,6 +249,12 @@ bool HandleNonOptionArgs(const char *progName, int argc, char *argv[])
         SendMsgs = true;
     }
 
+    if (UseTCP && BatchSize > 0)
+    {
+        PrintArgError("%s: Batch sending is not supported over TCP\n", progName);
+        return false;
+    }
+
     return true;
 }
 
@@ -327,12 +349,47 @@ void DriveSending()
         sendCount++;
         LastSendTime = Now();
 
-        res = MessageLayer.SendMessage(DestAddr, &msgInfo, msgBuf);
-        if (res != WEAVE_NO_ERROR)
+        if (BatchSize > 0)
         {
-            printf("WeaveMessageLayer.SendMessage failed: %d\n", (int) res);
+            WeaveMessageDestination dests[kMaxBatchSize];
 
-            return;
+            for (int32_t i = 0; i < BatchSize; i++)
+            {
+                dests[i].DestNodeId = DestNodeId;
+                dests[i].DestAddr = DestAddr;
+                dests[i].KeyId = msgInfo.KeyId;
+                dests[i].Result = WEAVE_ERROR_INCORRECT_STATE;
+            }
+
+            res = MessageLayer.SendMessageBatch(&msgInfo, msgBuf, dests, (uint16_t) BatchSize);
+
+            // The overall result must be the first failure, if any, of the individual sends.
+            for (int32_t i = 0; i < BatchSize; i++)
+            {
+                if (dests[i].Result != WEAVE_NO_ERROR)
+                {
+                    printf("WeaveMessageLayer.SendMessageBatch failed for message %d: %s\n", (int) i, ErrorStr(dests[i].Result));
+                    if (res != dests[i].Result)
+                    {
+                        printf("WeaveMessageLayer.SendMessageBatch returned %s\n", ErrorStr(res));
+                        exit(EXIT_FAILURE);
+                    }
+                    break;
+                }
+            }
+
+            if (res != WEAVE_NO_ERROR)
+                return;
+        }
+        else
+        {
+            res = MessageLayer.SendMessage(DestAddr, &msgInfo, msgBuf);
+            if (res != WEAVE_NO_ERROR)
+            {
+                printf("WeaveMessageLayer.SendMessage failed: %d\n", (int) res);
+
+                return;
+            }
         }
     }
 
@@ -340,7 +397,10 @@ void DriveSending()
         char nodeAddrStr[64];
         DestAddr.ToString(nodeAddrStr, sizeof(nodeAddrStr));
 
-        printf("Weave message sent to node %" PRIX64 " (%s)\n", DestNodeId, nodeAddrStr);
+        if (BatchSize > 0)
+            printf("Weave message sent %d times to node %" PRIX64 " (%s)\n", (int) BatchSize, DestNodeId, nodeAddrStr);
+        else
+            printf("Weave message sent to node %" PRIX64 " (%s)\n", DestNodeId, nodeAddrStr);
     }
 }
 
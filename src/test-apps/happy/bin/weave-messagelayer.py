@@ -38,8 +38,8 @@ if __name__ == "__main__":
 	options = WeaveMessageLayer.option()
 
 	try:
-		opts, args = getopt.getopt(sys.argv[1:], "hc:s:n:tqp:",
-			["help", "client=", "server=", "count=", "tcp", "quiet", "tap="])
+		opts, args = getopt.getopt(sys.argv[1:], "hc:s:n:tb:qp:",
+			["help", "client=", "server=", "count=", "tcp", "batch=", "quiet", "tap="])
 	except getopt.GetoptError as err:
 		print(WeaveMessageLayer.WeaveMessageLayer.__doc__)
 		print(hred(str(err)))
@@ -56,6 +56,9 @@ if __name__ == "__main__":
 		elif o in ("-t", "--tcp"):
 			options["tcp"] = True
 
+		elif o in ("-b", "--batch"):
+			options["batch"] = a
+
 		elif o in ("-c", "--client"):
 			options["client"] = a
 
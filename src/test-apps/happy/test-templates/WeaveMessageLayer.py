@@ -43,6 +43,7 @@ options["server"] = None
 options["count"] = None
 options["quiet"] = False
 options["tcp"] = False
+options["batch"] = None
 options["tap"] = None
 options["use_persistent_storage"] = True
 
@@ -54,7 +55,8 @@ def option():
 class WeaveMessageLayer(HappyNode, HappyNetwork, WeaveTest):
     """
     weave-messagelayer [-h --help] [-q --quiet] [-c --client <NAME>] [-s --server <NAME>]
-                        [-n -count <NUMBER>] [-t --tcp] [-p --tap <TAP_INTERFACE>]
+                        [-n -count <NUMBER>] [-t --tcp] [-b --batch <NUMBER>]
+                        [-p --tap <TAP_INTERFACE>]
 
     commands:
          $ weave-messagelayer -c node01 -s node02 -n 10
@@ -63,6 +65,10 @@ class WeaveMessageLayer(HappyNode, HappyNetwork, WeaveTest):
          $ weave-messagelayer -c node01 -s node02 -n 10 -t
               test weave message send from node01 to node02 via tcp
 
+         $ weave-messagelayer -c node01 -s node02 -n 10 -b 8
+              test weave message send from node01 to node02 via udp, sending
+              each message 8 times in a single batch
+
     return:
         0   success
         1   failure
@@ -78,6 +84,7 @@ class WeaveMessageLayer(HappyNode, HappyNetwork, WeaveTest):
         self.client = opts["client"]
         self.server = opts["server"]
         self.tcp = opts["tcp"]
+        self.batch = opts["batch"]
         self.tap = opts["tap"]
 
         self.server_process_tag = "WEAVE-MESSAGELAYER-SERVER"
@@ -141,25 +148,39 @@ class WeaveMessageLayer(HappyNode, HappyNetwork, WeaveTest):
         else:
             self.count = 5
 
+        if self.batch != None and str(self.batch).isdigit():
+            self.batch = int(self.batch)
+        else:
+            self.batch = None
+
 
     def __process_results(self, output):
+        total_count = None
+        received = 0
+
         for line in output.split("\n"):
             if not "This is weave message " in line:
                 continue
 
             total_count = line.split("message ")[1]
+            received += 1
 
         if self.quiet == False:
             print("weave-messagelayer test from node %s (%s) to node %s (%s) : " % \
                 (self.client_node_id, self.client_ip,
                  self.server_node_id, self.server_ip), end=' ')
 
-            if total_count == str(self.count):
+        result = total_count == str(self.count)
+
+        # Each message is sent once per batch destination.
+        if self.batch != None:
+            result = result and received == self.count * self.batch
+
+        if self.quiet == False:
+            if result:
                 print(hgreen("succeed!"))
-                result = True
             else:
-                print(hred("failed!")) 
-                result = False
+                print(hred("failed!"))
         return (result, output)
 
 
@@ -185,6 +206,9 @@ class WeaveMessageLayer(HappyNode, HappyNetwork, WeaveTest):
         if self.tcp:
             cmd += " --tcp"
 
+        if self.batch != None:
+            cmd += " --batch " + str(self.batch)
+
         if self.tap:
             cmd += " --tap-device " + self.tap
 
@@ -78,12 +78,16 @@ class test_weave_messagelayer_01(unittest.TestCase):
         self.__process_result("node01", "node02", value, data, True)
         value, data = self.__run_messagelayer_test_between("node01", "node02", False)
         self.__process_result("node01", "node02", value, data, False)
+        value, data = self.__run_messagelayer_test_between("node01", "node02", False, 8)
+        self.__process_result("node01", "node02", value, data, False, 8)
 
 
-    def __process_result(self, nodeA, nodeB, value, data, isTCP):
+    def __process_result(self, nodeA, nodeB, value, data, isTCP, batch=None):
         print("messagelayer test between " + nodeA + " and " + nodeB + " ", end=' ')
         if isTCP:
             print("via TCP")
+        elif batch != None:
+            print("via UDP in batches of " + str(batch))
         else:
             print("via UDP")
 
@@ -94,13 +98,14 @@ class test_weave_messagelayer_01(unittest.TestCase):
             raise ValueError("Weave MessageLayer Test Failed")
 
 
-    def __run_messagelayer_test_between(self, nodeA, nodeB, isTCP):
+    def __run_messagelayer_test_between(self, nodeA, nodeB, isTCP, batch=None):
         options = WeaveMessageLayer.option()
         options["quiet"] = False
         options["client"] = nodeA
         options["server"] = nodeB
         options["count"] = "5"
         options["tcp"] = isTCP
+        options["batch"] = batch
         options["tap"] = self.tap
 
         weave_messagelayer = WeaveMessageLayer.WeaveMessageLayer(options)
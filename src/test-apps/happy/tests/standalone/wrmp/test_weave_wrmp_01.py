@@ -98,7 +98,7 @@ class test_weave_wrmp(unittest.TestCase):
                 print("Skip WRMP test on client and server running on the same node.")
                 continue
 
-            for t in range(1,17):
+            for t in range(1,26):
                 value, data = self.__run_wrmp_test_between(pair[0], pair[1], t)
                 self.__process_result(pair[0], pair[1], value, data, t)
 
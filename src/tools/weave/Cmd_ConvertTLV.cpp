@@ -0,0 +1,503 @@
+/*
+ *
+ *    Copyright (c) 2019 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements the weave command of convert-tlv.
+ *
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <Weave/Core/WeaveTLVJson.h>
+#include <Weave/Profiles/WeaveProfiles.h>
+#include <Weave/Support/WeaveNames.h>
+
+#include "weave-tool.h"
+
+using namespace nl::Weave::Profiles;
+using namespace nl::Weave::TLV;
+
+#define CMD_NAME "weave convert-tlv"
+
+static bool HandleNonOptionArgs(const char *progName, int argc, char *argv[]);
+static bool HandleOption(const char *progName, OptionSet *optSet, int id, const char *name, const char *arg);
+static bool ConvertToJson(const uint8_t *in, size_t inLen, FILE *outFile);
+static bool ConvertToTLV(char *in, size_t inLen, FILE *outFile);
+static void ReleaseDecodedInput(char *in, size_t decodedLen, size_t& releasedLen);
+static WEAVE_ERROR FlushJson(TLVJsonEncoder& encoder, const char *data, uint32_t dataLen);
+static WEAVE_ERROR GetTLVOutputBuffer(TLVWriter& writer, uintptr_t& bufHandle, uint8_t *& bufStart, uint32_t& bufLen);
+static WEAVE_ERROR FlushTLVOutputBuffer(TLVWriter& writer, uintptr_t bufHandle, uint8_t *bufStart, uint32_t bufLen);
+static bool LookupProfileId(const char *name, uint32_t nameLen, uint32_t& profileId);
+
+static OptionDef gCmdOptionDefs[] =
+{
+    { "json",               kNoArgument,       'j' },
+    { "tlv",                kNoArgument,       't' },
+    { "profile-names",      kNoArgument,       'n' },
+    { "implicit-profile",   kArgumentRequired, 'i' },
+    { }
+};
+
+static const char *const gCmdOptionHelp =
+    "   -j, --json\n"
+    "\n"
+    "       Convert a raw TLV file to JSON. This is the default.\n"
+    "\n"
+    "   -t, --tlv\n"
+    "\n"
+    "       Convert a JSON file to raw TLV.\n"
+    "\n"
+    "   -n, --profile-names\n"
+    "\n"
+    "       When converting to JSON, write the names of known profiles\n"
+    "       within tags, rather than profile ids. Profile names are always\n"
+    "       accepted when converting to TLV.\n"
+    "\n"
+    "   -i, --implicit-profile <profile-id>\n"
+    "\n"
+    "       The profile id of implicitly-tagged elements in the TLV.\n"
+    "\n"
+    ;
+
+static OptionSet gCmdOptions =
+{
+    HandleOption,
+    gCmdOptionDefs,
+    "COMMAND OPTIONS",
+    gCmdOptionHelp
+};
+
+static HelpOptions gHelpOptions(
+    CMD_NAME,
+    "Usage: " CMD_NAME " [<options...>] <in-file> <out-file>\n",
+    WEAVE_VERSION_STRING "\n" COPYRIGHT_STRING,
+    "Convert a sequence of Weave TLV elements to or from JSON.\n"
+    "\n"
+    "Each top-level TLV element is converted to a JSON object on a line of\n"
+    "its own, so files containing large numbers of elements, such as event\n"
+    "log archives, can be converted in bulk.\n"
+    "\n"
+    "ARGUMENTS\n"
+    "\n"
+    "  <in-file>\n"
+    "\n"
+    "       The file to be converted.\n"
+    "\n"
+    "  <out-file>\n"
+    "\n"
+    "       The output file name, or - to write to stdout.\n"
+    "\n"
+);
+
+static OptionSet *gCmdOptionSets[] =
+{
+    &gCmdOptions,
+    &gHelpOptions,
+    NULL
+};
+
+enum
+{
+    kOutputBufferSize           = 65536,
+    kMaxTLVWindowLen            = 0x80000000,   // The most input given to a TLVReader at one time.
+    kMaxTLVOutputLen            = 0x80000000,   // The most output written by a TLVWriter before it is restarted.
+    kInputReleaseLen            = 0x100000      // The least decoded JSON input discarded at one time.
+};
+
+// Profiles whose names are recognized when converting JSON to TLV.
+static const uint32_t sNamedProfiles[] =
+{
+    kWeaveProfile_Common,
+    kWeaveProfile_Echo,
+    kWeaveProfile_NetworkProvisioning,
+    kWeaveProfile_Security,
+    kWeaveProfile_FabricProvisioning,
+    kWeaveProfile_DeviceControl,
+    kWeaveProfile_Time,
+    kWeaveProfile_WDM,
+    kWeaveProfile_SWU,
+    kWeaveProfile_BDX,
+    kWeaveProfile_DeviceDescription,
+    kWeaveProfile_ServiceProvisioning,
+    kWeaveProfile_ServiceDirectory,
+    kWeaveProfile_Locale,
+    kWeaveProfile_Tunneling,
+    kWeaveProfile_Heartbeat,
+    kWeaveProfile_TokenPairing,
+    kWeaveProfile_DictionaryKey,
+    kWeaveProfile_Occupancy,
+    kWeaveProfile_Structure,
+    kWeaveProfile_NestProtect,
+    kWeaveProfile_TimeVariantData,
+    kWeaveProfile_HeatLink,
+    kWeaveProfile_Safety,
+    kWeaveProfile_SafetySummary,
+    kWeaveProfile_NestThermostat,
+    kWeaveProfile_NestBoiler,
+    kWeaveProfile_NestHvacEquipmentControl,
+    kWeaveProfile_NestDomesticHotWater,
+    kWeaveProfile_TopazHistory,
+    kWeaveProfile_NestNetworkManager
+};
+
+static const char *gInFileName = NULL;
+static const char *gOutFileName = NULL;
+static bool gToJson = true;
+static bool gUseProfileNames = false;
+static uint32_t gImplicitProfileId = kProfileIdNotSpecified;
+static FILE *gOutFile = NULL;
+
+bool Cmd_ConvertTLV(int argc, char *argv[])
+{
+    bool res = true;
+    uint8_t *map = NULL;
+    int fd = -1;
+    struct stat st;
+    FILE *outFile = NULL;
+    bool outFileCreated = false;
+
+    if (argc == 1)
+    {
+        gHelpOptions.PrintBriefUsage(stderr);
+        ExitNow(res = true);
+    }
+
+    if (!ParseArgs(CMD_NAME, argc, argv, gCmdOptionSets, HandleNonOptionArgs))
+    {
+        ExitNow(res = false);
+    }
+
+    fd = open(gInFileName, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        fprintf(stderr, "weave: Error reading %s\n%s\n", gInFileName, strerror(errno));
+        ExitNow(res = false);
+    }
+
+    if (fstat(fd, &st) < 0)
+    {
+        fprintf(stderr, "weave: Error reading %s\n%s\n", gInFileName, strerror(errno));
+        ExitNow(res = false);
+    }
+
+    if (st.st_size > 0)
+    {
+        // TLV input is only read.  The JSON decoder unescapes strings and decodes byte strings in
+        // place, so JSON input is mapped privately: the file is never modified, and the pages the
+        // decoder writes to are copies, which ConvertToTLV() discards once they have been decoded.
+        if (gToJson)
+            map = static_cast<uint8_t *>(mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0));
+        else
+            map = static_cast<uint8_t *>(mmap(0, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0));
+
+        if (map == MAP_FAILED)
+        {
+            map = NULL;
+            fprintf(stderr, "weave: Error reading %s\n%s\n", gInFileName, strerror(errno));
+            ExitNow(res = false);
+        }
+
+        madvise(map, st.st_size, MADV_SEQUENTIAL);
+    }
+
+    if (strcmp(gOutFileName, "-") != 0)
+    {
+        outFile = fopen(gOutFileName, "w+b");
+        if (outFile == NULL)
+        {
+            fprintf(stderr, "weave: ERROR: Unable to create %s\n%s\n", gOutFileName, strerror(errno));
+            ExitNow(res = false);
+        }
+        outFileCreated = true;
+    }
+    else
+        outFile = stdout;
+
+    if (gToJson)
+        res = ConvertToJson(map, st.st_size, outFile);
+    else
+        res = ConvertToTLV(reinterpret_cast<char *>(map), st.st_size, outFile);
+
+    if (res && fflush(outFile) != 0)
+    {
+        fprintf(stderr, "weave: ERROR: Unable to write to %s\n%s\n", gOutFileName, strerror(errno));
+        res = false;
+    }
+
+exit:
+    if (outFile != NULL && outFile != stdout)
+        fclose(outFile);
+
+    if (gOutFileName != NULL && outFileCreated && !res)
+        unlink(gOutFileName);
+
+    if (map != NULL)
+        munmap(map, st.st_size);
+
+    if (fd >= 0)
+        close(fd);
+
+    return res;
+}
+
+static bool ConvertToJson(const uint8_t *in, size_t inLen, FILE *outFile)
+{
+    static char outBuf[kOutputBufferSize];
+
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    TLVReader reader;
+    TLVJsonEncoder encoder;
+    size_t offset = 0;
+
+    encoder.Init(outBuf, sizeof(outBuf), FlushJson);
+    encoder.AppData = outFile;
+    if (gUseProfileNames)
+        encoder.GetProfileName = nl::Weave::GetProfileName;
+
+    // A TLVReader addresses at most 4GB, so larger files are read through a window, which is moved
+    // along to the start of any element that extends beyond it.  Each element is measured, using a
+    // copy of the reader, before it is converted, so no element is ever converted twice.
+    while (offset < inLen)
+    {
+        const size_t windowLen = (inLen - offset > kMaxTLVWindowLen) ? static_cast<size_t>(kMaxTLVWindowLen) : inLen - offset;
+        const bool isLastWindow = (offset + windowLen == inLen);
+        const size_t windowStart = offset;
+
+        reader.Init(in + offset, static_cast<uint32_t>(windowLen));
+        reader.ImplicitProfileId = gImplicitProfileId;
+
+        while ((err = reader.Next()) == WEAVE_NO_ERROR)
+        {
+            TLVReader elemEnd;
+
+            elemEnd.Init(reader);
+
+            err = elemEnd.Skip();
+            if (err != WEAVE_NO_ERROR)
+                break;
+
+            err = encoder.Encode(reader);
+            SuccessOrExit(err);
+
+            offset = elemEnd.GetReadPoint() - in;
+        }
+
+        if (err == WEAVE_END_OF_TLV)
+            err = WEAVE_NO_ERROR;
+
+        // An element cut off by the end of a window is read again from the start of the next one,
+        // unless it is too big to fit in any window.
+        else if (err == WEAVE_ERROR_TLV_UNDERRUN && !isLastWindow && offset != windowStart)
+            err = WEAVE_NO_ERROR;
+
+        SuccessOrExit(err);
+
+        if (isLastWindow)
+            break;
+    }
+
+    err = encoder.Flush();
+    SuccessOrExit(err);
+
+exit:
+    if (err != WEAVE_NO_ERROR)
+    {
+        fprintf(stderr, "weave: Error converting TLV at offset %lu: %s\n", (unsigned long) offset, nl::ErrorStr(err));
+        return false;
+    }
+
+    return true;
+}
+
+static bool ConvertToTLV(char *in, size_t inLen, FILE *outFile)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    TLVJsonDecoder decoder;
+    TLVWriter writer;
+    uint8_t *outBuf = NULL;
+    size_t releasedLen = 0;
+
+    gOutFile = outFile;
+
+    decoder.Init(in, inLen);
+    decoder.GetProfileId = LookupProfileId;
+
+    while (err == WEAVE_NO_ERROR)
+    {
+        // The output is streamed to the file through a single buffer, which the writer hands to
+        // FlushTLVOutputBuffer() each time it fills.  Since a TLVWriter also counts at most 4GB of
+        // output, it is restarted, between elements, after every 2GB.
+        writer.InitMalloced(outBuf, kOutputBufferSize, UINT32_MAX);
+        VerifyOrExit(outBuf != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+        writer.ImplicitProfileId = gImplicitProfileId;
+        writer.GetNewBuffer = GetTLVOutputBuffer;
+        writer.FinalizeBuffer = FlushTLVOutputBuffer;
+
+        while (writer.GetLengthWritten() < kMaxTLVOutputLen && (err = decoder.Decode(writer)) == WEAVE_NO_ERROR)
+            ReleaseDecodedInput(in, decoder.GetLengthRead(), releasedLen);
+
+        if (err == WEAVE_NO_ERROR || err == WEAVE_END_OF_TLV)
+        {
+            WEAVE_ERROR finalizeErr = writer.Finalize();
+            if (finalizeErr != WEAVE_NO_ERROR)
+                err = finalizeErr;
+        }
+
+        free(outBuf);
+        outBuf = NULL;
+    }
+
+    if (err == WEAVE_END_OF_TLV)
+        err = WEAVE_NO_ERROR;
+
+exit:
+    if (err != WEAVE_NO_ERROR)
+    {
+        fprintf(stderr, "weave: Error converting JSON at offset %lu: %s\n", (unsigned long) decoder.GetLengthRead(), nl::ErrorStr(err));
+        return false;
+    }
+
+    return true;
+}
+
+// Discard the pages of the mapped JSON input that have been decoded.  Private copies made by the
+// decoder's in-place changes are dropped with them, so memory use stays bounded however large the
+// input is.  Input is released in steps of at least kInputReleaseLen, to limit system calls.
+static void ReleaseDecodedInput(char *in, size_t decodedLen, size_t& releasedLen)
+{
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t releaseEnd = decodedLen - (decodedLen % pageSize);
+
+    if (releaseEnd >= releasedLen + kInputReleaseLen)
+    {
+        madvise(in + releasedLen, releaseEnd - releasedLen, MADV_DONTNEED);
+        releasedLen = releaseEnd;
+    }
+}
+
+static WEAVE_ERROR FlushJson(TLVJsonEncoder& encoder, const char *data, uint32_t dataLen)
+{
+    FILE *outFile = static_cast<FILE *>(encoder.AppData);
+
+    if (fwrite(data, 1, dataLen, outFile) != dataLen)
+        return nl::Weave::System::MapErrorPOSIX(errno);
+
+    return WEAVE_NO_ERROR;
+}
+
+// The writer's buffer handle is the address of the pointer to the malloced buffer, as set up by
+// InitMalloced().  Once flushed, the same buffer is handed back to the writer to be filled again.
+static WEAVE_ERROR GetTLVOutputBuffer(TLVWriter& writer, uintptr_t& bufHandle, uint8_t *& bufStart, uint32_t& bufLen)
+{
+    bufStart = *reinterpret_cast<uint8_t **>(bufHandle);
+    bufLen = kOutputBufferSize;
+
+    return WEAVE_NO_ERROR;
+}
+
+static WEAVE_ERROR FlushTLVOutputBuffer(TLVWriter& writer, uintptr_t bufHandle, uint8_t *bufStart, uint32_t bufLen)
+{
+    if (fwrite(bufStart, 1, bufLen, gOutFile) != bufLen)
+        return nl::Weave::System::MapErrorPOSIX(errno);
+
+    return WEAVE_NO_ERROR;
+}
+
+static bool LookupProfileId(const char *name, uint32_t nameLen, uint32_t& profileId)
+{
+    for (size_t i = 0; i < sizeof(sNamedProfiles) / sizeof(sNamedProfiles[0]); i++)
+    {
+        const char *profileName = nl::Weave::GetProfileName(sNamedProfiles[i]);
+
+        if (profileName != NULL && strlen(profileName) == nameLen && memcmp(profileName, name, nameLen) == 0)
+        {
+            profileId = sNamedProfiles[i];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool HandleNonOptionArgs(const char *progName, int argc, char *argv[])
+{
+    if (argc == 0)
+    {
+        PrintArgError("%s: Please specify the name of the file to be converted.\n", progName);
+        return false;
+    }
+
+    if (argc == 1)
+    {
+        PrintArgError("%s: Please specify the name of the output file, or - for stdout.\n", progName);
+        return false;
+    }
+
+    if (argc > 2)
+    {
+        PrintArgError("%s: Unexpected argument: %s\n", progName, argv[2]);
+        return false;
+    }
+
+    gInFileName = argv[0];
+    gOutFileName = argv[1];
+
+    return true;
+}
+
+bool HandleOption(const char *progName, OptionSet *optSet, int id, const char *name, const char *arg)
+{
+    switch (id)
+    {
+    case 'j':
+        gToJson = true;
+        break;
+
+    case 't':
+        gToJson = false;
+        break;
+
+    case 'n':
+        gUseProfileNames = true;
+        break;
+
+    case 'i':
+        if (!ParseInt(arg, gImplicitProfileId, 0))
+        {
+            PrintArgError("%s: Invalid value specified for implicit profile id: %s\n", progName, arg);
+            return false;
+        }
+        break;
+
+    default:
+        PrintArgError("%s: INTERNAL ERROR: Unhandled option: %s\n", progName, name);
+        return false;
+    }
+
+    return true;
+}
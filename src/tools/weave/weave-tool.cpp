@@ -55,6 +55,8 @@ static const char *const sHelp =
         "\n"
         "    convert-provisioning-data -- Perform various conversions on a device provisioning data file.\n"
         "\n"
+        "    convert-tlv -- Convert a sequence of Weave TLV elements to or from JSON.\n"
+        "\n"
         "    resign-cert -- Resign a weave certificate using a new CA key.\n"
         "\n"
         "    make-service-config -- Make a service config object.\n"
@@ -122,6 +124,9 @@ int main(int argc, char *argv[])
     else if (strcasecmp(argv[1], "convert-provisioning-data") == 0 || strcasecmp(argv[1], "convertprovisioningdata") == 0)
         res = Cmd_ConvertProvisioningData(argc - 1, argv + 1);
 
+    else if (strcasecmp(argv[1], "convert-tlv") == 0 || strcasecmp(argv[1], "converttlv") == 0)
+        res = Cmd_ConvertTLV(argc - 1, argv + 1);
+
     else if (strcasecmp(argv[1], "resign-cert") == 0 || strcasecmp(argv[1], "resigncert") == 0)
         res = Cmd_ResignCert(argc - 1, argv + 1);
 
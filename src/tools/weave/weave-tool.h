@@ -87,6 +87,7 @@ extern bool Cmd_GenGeneralCert(int argc, char *argv[]);
 extern bool Cmd_ConvertCert(int argc, char *argv[]);
 extern bool Cmd_ConvertKey(int argc, char *argv[]);
 extern bool Cmd_ConvertProvisioningData(int argc, char *argv[]);
+extern bool Cmd_ConvertTLV(int argc, char *argv[]);
 extern bool Cmd_ResignCert(int argc, char *argv[]);
 extern bool Cmd_MakeServiceConfig(int argc, char *argv[]);
 extern bool Cmd_MakeAccessToken(int argc, char *argv[]);